@@ -0,0 +1,106 @@
+// Copyright 2008, Google Inc. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//  3. Neither the name of Google Inc. nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// This program measures how kmlengine::KmlFileLoader scales with the number
+// of threads.  The given KML and KMZ files are each listed the given number
+// of times and loaded with 1, 2, 4 and so on threads up to the number of
+// processors.  For example to load the testdata tree replicated 50 times:
+//   batchloadbench 50 $(find testdata -name '*.km[lz]')
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "kml/base/parallel.h"
+#include "kml/base/time_util.h"
+#include "kml/engine.h"
+
+using kmlbase::GetMicroTime;
+using kmlengine::KmlFileLoadObserver;
+using kmlengine::KmlFileLoader;
+using kmlengine::KmlFilePtr;
+using std::cerr;
+using std::cout;
+using std::endl;
+
+// This counts the files which loaded.  Each file is released once counted.
+class CountingLoadObserver : public KmlFileLoadObserver {
+ public:
+  CountingLoadObserver() : loaded_(0) {}
+  virtual bool FileLoaded(size_t index, const std::string& path,
+                          const KmlFilePtr& kml_file,
+                          const std::string& errors) {
+    if (kml_file) {
+      ++loaded_;
+    }
+    return true;
+  }
+  int get_loaded() const {
+    return loaded_;
+  }
+
+ private:
+  int loaded_;
+};
+
+int main(int argc, char** argv) {
+  if (argc < 3 || atoi(argv[1]) <= 0) {
+    cerr << "usage: " << argv[0] << " copies file..." << endl;
+    return 1;
+  }
+  const int copies = atoi(argv[1]);
+  std::vector<std::string> paths;
+  for (int i = 0; i < copies; ++i) {
+    for (int j = 2; j < argc; ++j) {
+      paths.push_back(argv[j]);
+    }
+  }
+  const unsigned int processors = kmlbase::GetProcessorCount();
+  cout << paths.size() << " files, " << processors << " processors" << endl;
+
+  double one_thread_seconds = 0;
+  for (unsigned int threads = 1; ; threads *= 2) {
+    if (threads > processors) {
+      threads = processors;
+    }
+    KmlFileLoader kml_file_loader;
+    kml_file_loader.set_num_threads(threads);
+    CountingLoadObserver counting_load_observer;
+    const double start = GetMicroTime();
+    kml_file_loader.Load(paths, &counting_load_observer);
+    const double seconds = GetMicroTime() - start;
+    if (threads == 1) {
+      one_thread_seconds = seconds;
+    }
+    cout << threads << " threads: " << seconds << " sec, "
+         << paths.size() / seconds << " files/sec, speedup "
+         << one_thread_seconds / seconds << " ("
+         << counting_load_observer.get_loaded() << " loaded)" << endl;
+    if (threads == processors) {
+      break;
+    }
+  }
+  return 0;
+}
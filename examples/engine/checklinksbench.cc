@@ -0,0 +1,132 @@
+// Copyright 2008, Google Inc. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//  3. Neither the name of Google Inc. nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// This program compares checking the links of KMZ files by a full parse and
+// reading of each linked file with kmlconvenience::KmzCheckLinks(), which
+// scans the KML as it inflates it and looks each link up in the table of
+// contents, and with kmlconvenience::KmzCheckLinksInFiles() on 1, 2, 4 and so
+// on threads up to the number of processors.  The given KMZ files are each
+// listed the given number of times.  For example:
+//   checklinksbench 200 $(find testdata -name '*.kmz')
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "boost/scoped_ptr.hpp"
+#include "kml/base/parallel.h"
+#include "kml/base/time_util.h"
+#include "kml/convenience/kmz_check_links.h"
+#include "kml/dom.h"
+#include "kml/engine.h"
+
+using kmlbase::GetMicroTime;
+using kmlengine::KmzFile;
+using std::cerr;
+using std::cout;
+using std::endl;
+
+// This is how links were checked before KmzCheckLinks() scanned the KML.
+static bool CheckLinksWithParser(const KmzFile& kmz_file) {
+  std::string kml;
+  if (!kmz_file.ReadKml(&kml)) {
+    return false;
+  }
+  kmlengine::href_vector_t href_vector;
+  kmlengine::GetLinksParserObserver get_links(&href_vector);
+  kmldom::Parser parser;
+  parser.AddObserver(&get_links);
+  if (!parser.Parse(kml, NULL)) {
+    return false;
+  }
+  bool ret = true;
+  for (size_t i = 0; i < href_vector.size(); ++i) {
+    kmlengine::Href href(href_vector[i]);
+    std::string content;
+    if (href.IsRelative() &&
+        !kmz_file.ReadFile(href.get_path().c_str(), &content)) {
+      ret = false;
+    }
+  }
+  return ret;
+}
+
+static void Report(const std::string& name, double seconds, size_t count,
+                   size_t passed) {
+  cout << name << ": " << seconds << " sec, " << count / seconds
+       << " files/sec (" << passed << " passed)" << endl;
+}
+
+int main(int argc, char** argv) {
+  if (argc < 3 || atoi(argv[1]) <= 0) {
+    cerr << "usage: " << argv[0] << " copies file.kmz..." << endl;
+    return 1;
+  }
+  const int copies = atoi(argv[1]);
+  std::vector<std::string> paths;
+  for (int i = 0; i < copies; ++i) {
+    for (int j = 2; j < argc; ++j) {
+      paths.push_back(argv[j]);
+    }
+  }
+
+  size_t passed = 0;
+  double start = GetMicroTime();
+  for (size_t i = 0; i < paths.size(); ++i) {
+    boost::scoped_ptr<KmzFile> kmz_file(
+        KmzFile::OpenFromFile(paths[i].c_str()));
+    if (kmz_file.get() && CheckLinksWithParser(*kmz_file)) {
+      ++passed;
+    }
+  }
+  Report("parse and read", GetMicroTime() - start, paths.size(), passed);
+
+  passed = 0;
+  start = GetMicroTime();
+  for (size_t i = 0; i < paths.size(); ++i) {
+    boost::scoped_ptr<KmzFile> kmz_file(
+        KmzFile::OpenFromFile(paths[i].c_str()));
+    if (kmz_file.get() && kmlconvenience::KmzCheckLinks(*kmz_file, NULL)) {
+      ++passed;
+    }
+  }
+  Report("KmzCheckLinks", GetMicroTime() - start, paths.size(), passed);
+
+  const unsigned int processors = kmlbase::GetProcessorCount();
+  for (unsigned int threads = 1; ; threads *= 2) {
+    if (threads > processors) {
+      threads = processors;
+    }
+    start = GetMicroTime();
+    passed = kmlconvenience::KmzCheckLinksInFiles(paths, threads, NULL);
+    cout << threads << " thread(s) ";
+    Report("KmzCheckLinksInFiles", GetMicroTime() - start, paths.size(),
+           passed);
+    if (threads == processors) {
+      break;
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,106 @@
+// Copyright 2008, Google Inc. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//  3. Neither the name of Google Inc. nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// This program compares kmlbase::DateTime's parse and format with the
+// strptime/timegm and gmtime/strftime C library path DateTime used to use.
+// Each runs over the given number of distinct xsd:dateTime strings.
+
+#include <time.h>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "kml/base/date_time.h"
+#include "kml/base/time_util.h"
+
+using kmlbase::DateTime;
+using kmlbase::GetMicroTime;
+using std::cerr;
+using std::cout;
+using std::endl;
+
+// One time every 997 seconds from 2008-10-03T09:25:42Z.
+static const time_t kStart = 1223025942;
+static const time_t kStep = 997;
+
+static void Report(const char* name, double seconds, int count,
+                   int64_t check) {
+  cout << name << ": " << seconds << " sec, "
+       << 1e9 * seconds / count << " ns each (check " << check << ")"
+       << endl;
+}
+
+int main(int argc, char** argv) {
+  if (argc != 2 || atoi(argv[1]) <= 0) {
+    cerr << "usage: " << argv[0] << " count" << endl;
+    return 1;
+  }
+  const int count = atoi(argv[1]);
+
+  std::vector<std::string> times(count);
+  char buf[DateTime::kXsdDateTimeSize];
+  for (int i = 0; i < count; ++i) {
+    const size_t size = DateTime::FormatXsdDateTime(kStart + i * kStep, buf);
+    times[i].assign(buf, size);
+  }
+
+  int64_t check = 0;
+  double start = GetMicroTime();
+  for (int i = 0; i < count; ++i) {
+    struct tm tm;
+    if (strptime(times[i].c_str(), "%Y-%m-%dT%H:%M:%SZ", &tm)) {
+      check += timegm(&tm);
+    }
+  }
+  Report("strptime+timegm", GetMicroTime() - start, count, check);
+
+  check = 0;
+  start = GetMicroTime();
+  for (int i = 0; i < count; ++i) {
+    DateTime date_time;
+    if (DateTime::Parse(times[i].data(), times[i].size(), &date_time)) {
+      check += date_time.get_seconds();
+    }
+  }
+  Report("DateTime::Parse", GetMicroTime() - start, count, check);
+
+  check = 0;
+  start = GetMicroTime();
+  for (int i = 0; i < count; ++i) {
+    const time_t seconds = kStart + i * kStep;
+    struct tm tm;
+    gmtime_r(&seconds, &tm);
+    check += strftime(buf, sizeof(buf), "%Y-%m-%dT%H:%M:%SZ", &tm);
+  }
+  Report("gmtime+strftime", GetMicroTime() - start, count, check);
+
+  check = 0;
+  start = GetMicroTime();
+  for (int i = 0; i < count; ++i) {
+    check += DateTime::FormatXsdDateTime(kStart + i * kStep, buf);
+  }
+  Report("DateTime::FormatXsdDateTime", GetMicroTime() - start, count, check);
+  return 0;
+}
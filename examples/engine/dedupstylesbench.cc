@@ -0,0 +1,138 @@
+// Copyright 2008, Google Inc. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//  3. Neither the name of Google Inc. nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// This program reports what kmlengine::DeduplicateStyles() does for each of
+// the given KML files: the size of the KML and the number of distinct
+// StyleSelectors before and after, the time taken to deduplicate, and the
+// time taken to resolve the normal style of every Feature with
+// kmlengine::CreateResolvedStyle() before and after.  For example:
+//   dedupstylesbench $(find testdata -name '*.kml')
+
+#include <iostream>
+#include <set>
+#include <string>
+#include "kml/base/file.h"
+#include "kml/base/time_util.h"
+#include "kml/dom.h"
+#include "kml/engine.h"
+
+using kmlbase::GetMicroTime;
+using kmldom::FeaturePtr;
+using kmlengine::KmlFile;
+using kmlengine::KmlFilePtr;
+using std::cerr;
+using std::cout;
+using std::endl;
+
+// The number of times each Feature's style is resolved.
+static const int kResolvePasses = 10;
+
+// This FeatureVisitor resolves the style of each Feature and counts the
+// distinct StyleSelectors.
+class StyleResolvingVisitor : public kmlengine::FeatureVisitor {
+ public:
+  StyleResolvingVisitor(const KmlFilePtr& kml_file)
+    : kml_file_(kml_file), feature_count_(0) {
+  }
+
+  virtual void VisitFeature(const FeaturePtr& feature) {
+    ++feature_count_;
+    kmlengine::CreateResolvedStyle(feature, kml_file_,
+                                   kmldom::STYLESTATE_NORMAL);
+    if (feature->has_styleselector()) {
+      styles_.insert(kmldom::SerializeRaw(feature->get_styleselector()));
+    }
+    if (kmldom::DocumentPtr document = kmldom::AsDocument(feature)) {
+      for (size_t i = 0; i < document->get_styleselector_array_size(); ++i) {
+        styles_.insert(
+            kmldom::SerializeRaw(document->get_styleselector_array_at(i)));
+      }
+    }
+  }
+
+  size_t get_feature_count() const {
+    return feature_count_;
+  }
+  size_t get_style_count() const {
+    return styles_.size();
+  }
+
+ private:
+  const KmlFilePtr kml_file_;
+  size_t feature_count_;
+  std::set<std::string> styles_;
+};
+
+// Resolves every Feature's style kResolvePasses times and reports the time.
+static void ResolveStyles(const std::string& name, const std::string& kml) {
+  KmlFilePtr kml_file = KmlFile::CreateFromParse(kml, NULL);
+  if (!kml_file) {
+    cerr << name << ": parse failed" << endl;
+    return;
+  }
+  const FeaturePtr root = kmlengine::GetRootFeature(kml_file->get_root());
+  size_t feature_count = 0;
+  size_t style_count = 0;
+  const double start = GetMicroTime();
+  for (int i = 0; i < kResolvePasses; ++i) {
+    StyleResolvingVisitor visitor(kml_file);
+    kmlengine::VisitFeatureHierarchy(root, visitor);
+    feature_count = visitor.get_feature_count();
+    style_count = visitor.get_style_count();
+  }
+  const double seconds = GetMicroTime() - start;
+  cout << "  " << name << ": " << kml.size() << " bytes, " << style_count
+       << " styles, " << feature_count << " features resolved in "
+       << seconds * 1000 / kResolvePasses << " ms" << endl;
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    cerr << "usage: " << argv[0] << " file.kml..." << endl;
+    return 1;
+  }
+  for (int i = 1; i < argc; ++i) {
+    std::string kml;
+    if (!kmlbase::File::ReadFileToString(argv[i], &kml)) {
+      cerr << argv[i] << ": read failed" << endl;
+      continue;
+    }
+    kmldom::ElementPtr root = kmldom::Parse(kml, NULL);
+    if (!root) {
+      cerr << argv[i] << ": parse failed" << endl;
+      continue;
+    }
+    const std::string before = kmldom::SerializePretty(root);
+    const double start = GetMicroTime();
+    const int replaced = kmlengine::DeduplicateStyles(root);
+    const double seconds = GetMicroTime() - start;
+    const std::string after = kmldom::SerializePretty(root);
+    cout << argv[i] << ": " << replaced << " inline styles replaced in "
+         << seconds * 1000 << " ms" << endl;
+    ResolveStyles("before", before);
+    ResolveStyles("after", after);
+  }
+  return 0;
+}
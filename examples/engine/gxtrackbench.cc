@@ -0,0 +1,203 @@
+// Copyright 2008, Google Inc. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//  3. Neither the name of Google Inc. nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// This program reports the heap memory and time taken to parse, scan and
+// serialize a large <gx:Track>.  The input is either the given KML or KMZ
+// file or a generated track of one point per second with the given number
+// of points.  The heap is measured by counting the bytes passed to operator
+// new less those freed.
+
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <sstream>
+#include <string>
+#include "kml/base/date_time.h"
+#include "kml/base/file.h"
+#include "kml/base/time_util.h"
+#include "kml/dom.h"
+#include "kml/engine.h"
+
+using kmlbase::GetMicroTime;
+using kmldom::GxTrackPtr;
+using kmlengine::KmlFile;
+using kmlengine::KmlFilePtr;
+using std::cerr;
+using std::cout;
+using std::endl;
+
+// Each allocation is prefixed with its size.  The prefix is large enough to
+// keep the returned memory suitably aligned.
+static const size_t kHeaderSize = 16;
+static size_t live_bytes = 0;
+
+static void* CountedAlloc(size_t size) {
+  char* p = static_cast<char*>(malloc(size + kHeaderSize));
+  if (!p) {
+    return NULL;
+  }
+  *reinterpret_cast<size_t*>(p) = size;
+  live_bytes += size;
+  return p + kHeaderSize;
+}
+
+static void CountedFree(void* ptr) {
+  if (ptr) {
+    char* p = static_cast<char*>(ptr) - kHeaderSize;
+    live_bytes -= *reinterpret_cast<size_t*>(p);
+    free(p);
+  }
+}
+
+void* operator new(size_t size) throw(std::bad_alloc) {
+  if (void* p = CountedAlloc(size)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+void* operator new(size_t size, const std::nothrow_t&) throw() {
+  return CountedAlloc(size);
+}
+
+void operator delete(void* ptr) throw() {
+  CountedFree(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) throw() {
+  CountedFree(ptr);
+}
+
+// A track such as a GPS logger records: one point per second from
+// 2010-02-07T19:57:44Z with a small drift in each value.
+static std::string GenerateKml(int point_count) {
+  const time_t kStart = 1265572664;
+  std::stringstream kml;
+  kml.precision(15);
+  kml << "<kml xmlns=\"http://www.opengis.net/kml/2.2\""
+      << " xmlns:gx=\"http://www.google.com/kml/ext/2.2\">"
+      << "<Placemark><gx:Track>";
+  char buf[kmlbase::DateTime::kXsdDateTimeSize];
+  for (int i = 0; i < point_count; ++i) {
+    kmlbase::DateTime::FormatXsdDateTime(kStart + i, buf);
+    kml << "<when>" << buf << "</when>";
+  }
+  for (int i = 0; i < point_count; ++i) {
+    kml << "<gx:coord>" << -122.0 + i * 1e-5 << " " << 37.0 + i * 2e-5
+        << " " << 100 + i % 50 << "</gx:coord>";
+  }
+  for (int i = 0; i < point_count; ++i) {
+    kml << "<gx:angles>" << i % 360 << " " << i % 10 << " 0</gx:angles>";
+  }
+  kml << "</gx:Track></Placemark></kml>";
+  return kml.str();
+}
+
+// This finds the first <gx:Track> in the file.
+static GxTrackPtr FindTrack(const kmldom::ElementPtr& element) {
+  if (const kmldom::PlacemarkPtr placemark = kmldom::AsPlacemark(element)) {
+    if (const GxTrackPtr gx_track =
+            kmldom::AsGxTrack(placemark->get_geometry())) {
+      return gx_track;
+    }
+    if (const kmldom::GxMultiTrackPtr gx_multitrack =
+            kmldom::AsGxMultiTrack(placemark->get_geometry())) {
+      if (gx_multitrack->get_gx_track_array_size() > 0) {
+        return gx_multitrack->get_gx_track_array_at(0);
+      }
+    }
+  }
+  if (const kmldom::ContainerPtr container = kmldom::AsContainer(element)) {
+    for (size_t i = 0; i < container->get_feature_array_size(); ++i) {
+      if (GxTrackPtr gx_track = FindTrack(container->get_feature_array_at(i))) {
+        return gx_track;
+      }
+    }
+  }
+  return NULL;
+}
+
+int main(int argc, char** argv) {
+  if (argc != 2) {
+    cerr << "usage: " << argv[0] << " point_count|input.kml" << endl;
+    return 1;
+  }
+  std::string kml;
+  if (!kmlbase::File::ReadFileToString(argv[1], &kml)) {
+    const int point_count = atoi(argv[1]);
+    if (point_count <= 0) {
+      cerr << "read failed: " << argv[1] << endl;
+      return 1;
+    }
+    kml = GenerateKml(point_count);
+  }
+
+  const size_t before = live_bytes;
+  std::string errors;
+  double start = GetMicroTime();
+  KmlFilePtr kml_file = KmlFile::CreateFromParse(kml, &errors);
+  const double parse_time = GetMicroTime() - start;
+  if (!kml_file) {
+    cerr << "parse failed: " << errors << endl;
+    return 1;
+  }
+  const size_t bytes = live_bytes - before;
+  const GxTrackPtr gx_track = FindTrack(kmlengine::GetRootFeature(
+      kml_file->get_root()));
+  const size_t point_count = gx_track ? gx_track->get_when_array_size() : 0;
+  if (point_count == 0) {
+    cerr << "no gx:Track with points" << endl;
+    return 1;
+  }
+  cout << "points: " << point_count << endl;
+  cout << "parse: " << parse_time << " sec, " << bytes << " bytes, "
+       << static_cast<double>(bytes) / point_count << " bytes/point" << endl;
+
+  // The sort of scan analytics does: duration and extent of the track.
+  start = GetMicroTime();
+  const std::vector<int64_t>& whens = gx_track->get_when_times();
+  const std::vector<double>& longitudes = gx_track->get_gx_coord_longitudes();
+  int64_t first = 0;
+  int64_t last = 0;
+  double west = 180;
+  double east = -180;
+  for (size_t i = 0; i < whens.size(); ++i) {
+    first = i == 0 || whens[i] < first ? whens[i] : first;
+    last = i == 0 || whens[i] > last ? whens[i] : last;
+  }
+  for (size_t i = 0; i < longitudes.size(); ++i) {
+    west = longitudes[i] < west ? longitudes[i] : west;
+    east = longitudes[i] > east ? longitudes[i] : east;
+  }
+  cout << "scan: " << GetMicroTime() - start << " sec, "
+       << last - first << " sec long, " << east - west << " deg wide"
+       << endl;
+
+  start = GetMicroTime();
+  const std::string xml = kmldom::SerializeRaw(kml_file->get_root());
+  cout << "serialize: " << GetMicroTime() - start << " sec, " << xml.size()
+       << " bytes" << endl;
+  return 0;
+}
@@ -0,0 +1,123 @@
+// Copyright 2008, Google Inc. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//  3. Neither the name of Google Inc. nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// This program compares the hash-based ObjectIdMap against std::map for
+// inserting and looking up a given number of ids, and if a KML or KMZ file
+// is given, times KmlFile::CreateFromParse() and GetObjectById() on every
+// id in the file.
+
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "kml/base/file.h"
+#include "kml/base/time_util.h"
+#include "kml/dom.h"
+#include "kml/engine.h"
+
+using kmlbase::GetMicroTime;
+using kmldom::ObjectPtr;
+using kmlengine::KmlFile;
+using kmlengine::KmlFilePtr;
+using kmlengine::ObjectIdMap;
+using std::cerr;
+using std::cout;
+using std::endl;
+
+// Inserts each id mapped to the given object, then looks each up.
+template <typename Map>
+static void TimeMap(const char* name, const std::vector<std::string>& ids,
+                    const ObjectPtr& object) {
+  Map map;
+  double start = GetMicroTime();
+  for (size_t i = 0; i < ids.size(); ++i) {
+    map[ids[i]] = object;
+  }
+  const double insert_time = GetMicroTime() - start;
+  start = GetMicroTime();
+  size_t found = 0;
+  for (size_t i = 0; i < ids.size(); ++i) {
+    found += map.find(ids[i]) != map.end();
+  }
+  const double find_time = GetMicroTime() - start;
+  cout << name << ": insert " << insert_time << " sec, find "
+       << find_time << " sec (" << found << " found)" << endl;
+}
+
+int main(int argc, char** argv) {
+  if (argc > 3) {
+    cerr << "usage: " << argv[0] << " [id_count] [input.kml]" << endl;
+    return 1;
+  }
+  const int id_count = argc > 1 ? atoi(argv[1]) : 1000000;
+  std::vector<std::string> ids;
+  for (int i = 0; i < id_count; ++i) {
+    std::stringstream id;
+    id << "placemark-" << i;
+    ids.push_back(id.str());
+  }
+  ObjectPtr object = kmldom::KmlFactory::GetFactory()->CreatePlacemark();
+  TimeMap<std::map<std::string, ObjectPtr> >("std::map", ids, object);
+  TimeMap<ObjectIdMap>("ObjectIdMap", ids, object);
+
+  if (argc < 3) {
+    return 0;
+  }
+  std::string file_data;
+  if (!kmlbase::File::ReadFileToString(argv[2], &file_data)) {
+    cerr << "read failed: " << argv[2] << endl;
+    return 1;
+  }
+  std::string errors;
+  double start = GetMicroTime();
+  KmlFilePtr kml_file = KmlFile::CreateFromParse(file_data, &errors);
+  const double parse_time = GetMicroTime() - start;
+  if (!kml_file) {
+    cerr << "parse failed: " << errors << endl;
+    return 1;
+  }
+  // Gather the ids first so only GetObjectById() is timed.
+  std::vector<std::string> file_ids;
+  kmlengine::ElementVector objects;
+  kmlengine::GetElementsById(kml_file->get_root(), kmldom::Type_Object,
+                             &objects);
+  for (size_t i = 0; i < objects.size(); ++i) {
+    if (kmldom::AsObject(objects[i])->has_id()) {
+      file_ids.push_back(kmldom::AsObject(objects[i])->get_id());
+    }
+  }
+  start = GetMicroTime();
+  size_t found = 0;
+  for (size_t i = 0; i < file_ids.size(); ++i) {
+    found += kml_file->GetObjectById(file_ids[i]) != NULL;
+  }
+  const double lookup_time = GetMicroTime() - start;
+  cout << "CreateFromParse: " << parse_time << " sec" << endl;
+  cout << "GetObjectById: " << lookup_time << " sec (" << found << " of "
+       << file_ids.size() << " ids)" << endl;
+  return 0;
+}
@@ -0,0 +1,180 @@
+// Copyright 2008, Google Inc. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//  3. Neither the name of Google Inc. nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// This program reports the heap memory held by a KmlFile created with
+// KmlFile::CreateFromParse() with and without KmlFileOptions::intern_strings.
+// The input is either the given KML or KMZ file or generated ExtendedData
+// heavy KML with the given number of Placemarks.  The heap is measured by
+// counting the bytes passed to operator new less those freed.
+
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <sstream>
+#include <string>
+#include "kml/base/file.h"
+#include "kml/base/time_util.h"
+#include "kml/dom.h"
+#include "kml/engine.h"
+
+using kmlbase::GetMicroTime;
+using kmlengine::KmlFile;
+using kmlengine::KmlFileOptions;
+using kmlengine::KmlFilePtr;
+using std::cerr;
+using std::cout;
+using std::endl;
+
+// Each allocation is prefixed with its size.  The prefix is large enough to
+// keep the returned memory suitably aligned.
+static const size_t kHeaderSize = 16;
+static size_t live_bytes = 0;
+
+static void* CountedAlloc(size_t size) {
+  char* p = static_cast<char*>(malloc(size + kHeaderSize));
+  if (!p) {
+    return NULL;
+  }
+  *reinterpret_cast<size_t*>(p) = size;
+  live_bytes += size;
+  return p + kHeaderSize;
+}
+
+static void CountedFree(void* ptr) {
+  if (ptr) {
+    char* p = static_cast<char*>(ptr) - kHeaderSize;
+    live_bytes -= *reinterpret_cast<size_t*>(p);
+    free(p);
+  }
+}
+
+void* operator new(size_t size) throw(std::bad_alloc) {
+  if (void* p = CountedAlloc(size)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+void* operator new(size_t size, const std::nothrow_t&) throw() {
+  return CountedAlloc(size);
+}
+
+void operator delete(void* ptr) throw() {
+  CountedFree(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) throw() {
+  CountedFree(ptr);
+}
+
+// Placemarks as found in exports of tabular data: a few shared styles and
+// the same typed fields on each.
+static const char* const kStyleUrls[] = {
+  "#style-residential", "#style-commercial", "#style-industrial"
+};
+static const char* const kSimpleDataNames[] = {
+  "parcel_identifier", "assessed_land_value", "assessed_building_value",
+  "zoning_classification", "year_built", "owner_occupied"
+};
+static const char* const kDataNames[] = {
+  "survey_date", "surveyor_name"
+};
+
+static std::string GenerateKml(int placemark_count) {
+  std::stringstream kml;
+  kml << "<kml xmlns=\"http://www.opengis.net/kml/2.2\"><Document>"
+      << "<Schema id=\"parcel-schema\">";
+  for (size_t i = 0; i < sizeof(kSimpleDataNames) / sizeof(char*); ++i) {
+    kml << "<SimpleField type=\"string\" name=\"" << kSimpleDataNames[i]
+        << "\"/>";
+  }
+  kml << "</Schema>";
+  for (int i = 0; i < placemark_count; ++i) {
+    kml << "<Placemark><name>" << i << "</name>"
+        << "<styleUrl>" << kStyleUrls[i % 3] << "</styleUrl>"
+        << "<ExtendedData>";
+    for (size_t j = 0; j < sizeof(kDataNames) / sizeof(char*); ++j) {
+      kml << "<Data name=\"" << kDataNames[j] << "\"><value>" << i + j
+          << "</value></Data>";
+    }
+    kml << "<SchemaData schemaUrl=\"#parcel-schema\">";
+    for (size_t j = 0; j < sizeof(kSimpleDataNames) / sizeof(char*); ++j) {
+      kml << "<SimpleData name=\"" << kSimpleDataNames[j] << "\">" << i * j
+          << "</SimpleData>";
+    }
+    kml << "</SchemaData></ExtendedData>"
+        << "<Point><coordinates>" << i % 360 - 180 << ",45</coordinates>"
+        << "</Point></Placemark>";
+  }
+  kml << "</Document></kml>";
+  return kml.str();
+}
+
+// Parses the KML and reports the heap held by the resulting KmlFile.
+static size_t Measure(const char* name, const std::string& kml,
+                      bool interned) {
+  const size_t before = live_bytes;
+  std::string errors;
+  KmlFileOptions options;
+  options.intern_strings = interned;
+  double start = GetMicroTime();
+  KmlFilePtr kml_file = KmlFile::CreateFromParse(kml, options, &errors);
+  const double parse_time = GetMicroTime() - start;
+  if (!kml_file) {
+    cerr << "parse failed: " << errors << endl;
+    exit(1);
+  }
+  const size_t bytes = live_bytes - before;
+  cout << name << ": " << bytes << " bytes, " << parse_time << " sec";
+  if (kmlbase::StringPool* string_pool = kml_file->get_string_pool()) {
+    cout << ", " << string_pool->size() << " distinct values, "
+         << string_pool->get_hit_count() << " shared";
+  }
+  cout << endl;
+  return bytes;
+}
+
+int main(int argc, char** argv) {
+  if (argc != 2) {
+    cerr << "usage: " << argv[0] << " placemark_count|input.kml" << endl;
+    return 1;
+  }
+  std::string kml;
+  if (!kmlbase::File::ReadFileToString(argv[1], &kml)) {
+    const int placemark_count = atoi(argv[1]);
+    if (placemark_count <= 0) {
+      cerr << "read failed: " << argv[1] << endl;
+      return 1;
+    }
+    kml = GenerateKml(placemark_count);
+  }
+  const size_t plain_bytes = Measure("CreateFromParse", kml, false);
+  const size_t interned_bytes = Measure("intern_strings", kml, true);
+  cout << "saved: " << static_cast<long>(plain_bytes - interned_bytes)
+       << " bytes (" << 100.0 * (1.0 - static_cast<double>(interned_bytes) /
+                                 plain_bytes)
+       << "%)" << endl;
+  return 0;
+}
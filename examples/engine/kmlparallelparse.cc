@@ -0,0 +1,89 @@
+// Copyright 2008, Google Inc. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//  3. Neither the name of Google Inc. nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// This program times a parallel KmlFile::CreateFromParse() on the given KML
+// or KMZ file for a range of thread counts against a serial one.
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include "kml/base/file.h"
+#include "kml/base/parallel.h"
+#include "kml/base/time_util.h"
+#include "kml/dom.h"
+#include "kml/engine.h"
+
+using kmlbase::GetMicroTime;
+using kmlengine::KmlFile;
+using kmlengine::KmlFileOptions;
+using kmlengine::KmlFilePtr;
+using std::cerr;
+using std::cout;
+using std::endl;
+
+int main(int argc, char** argv) {
+  if (argc != 2 && argc != 3) {
+    cerr << "usage: " << argv[0] << " input.kml [max_threads]" << endl;
+    return 1;
+  }
+  std::string file_data;
+  if (!kmlbase::File::ReadFileToString(argv[1], &file_data)) {
+    cerr << "read failed: " << argv[1] << endl;
+    return 1;
+  }
+  const unsigned int max_threads = argc == 3 ?
+      static_cast<unsigned int>(atoi(argv[2])) :
+      kmlbase::GetProcessorCount();
+
+  std::string errors;
+  double start = GetMicroTime();
+  KmlFilePtr kml_file = KmlFile::CreateFromParse(file_data, &errors);
+  const double serial_time = GetMicroTime() - start;
+  if (!kml_file) {
+    cerr << "parse failed: " << errors << endl;
+    return 1;
+  }
+  std::string serial_kml;
+  kml_file->SerializeToString(&serial_kml);
+  cout << "CreateFromParse: " << serial_time << " sec" << endl;
+
+  for (unsigned int threads = 1; threads <= max_threads; threads *= 2) {
+    KmlFileOptions options;
+    options.parse_threads = threads;
+    start = GetMicroTime();
+    kml_file = KmlFile::CreateFromParse(file_data, options, &errors);
+    const double parallel_time = GetMicroTime() - start;
+    if (!kml_file) {
+      cerr << "parallel parse failed: " << errors << endl;
+      return 1;
+    }
+    std::string parallel_kml;
+    kml_file->SerializeToString(&parallel_kml);
+    cout << "CreateFromParse parse_threads=" << threads << ": "
+         << parallel_time << " sec, speedup " << serial_time / parallel_time
+         << (parallel_kml == serial_kml ? "" : " MISMATCH") << endl;
+  }
+  return 0;
+}
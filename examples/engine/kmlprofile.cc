@@ -0,0 +1,145 @@
+// Copyright 2008, Google Inc. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//  3. Neither the name of Google Inc. nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// This program parses the given KML or KMZ file with the same
+// ParserObservers as KmlFile and writes a kmldom::ParseProfile report in CSV
+// to the standard output.  Each row gives the count, character data size,
+// time in microseconds per phase of the parse, and allocations of one type
+// of element.  The overall parse time is written to the standard error.
+
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+#include "boost/scoped_ptr.hpp"
+#include "kml/base/file.h"
+#include "kml/base/time_util.h"
+#include "kml/dom.h"
+#include "kml/engine.h"
+
+using kmlbase::GetMicroTime;
+using kmldom::ParseProfile;
+using kmlengine::KmzFile;
+using std::cerr;
+using std::cout;
+using std::endl;
+
+// Every allocation is counted for ParseProfile::set_allocation_counter().
+static size_t allocation_count = 0;
+
+static size_t GetAllocationCount() {
+  return allocation_count;
+}
+
+// The memory is handed out past a prefix of this size which is large enough
+// to keep it suitably aligned.  The prefix is otherwise unused.
+static const size_t kHeaderSize = 16;
+
+static void* CountedAlloc(size_t size) {
+  ++allocation_count;
+  char* p = static_cast<char*>(malloc(size + kHeaderSize));
+  return p ? p + kHeaderSize : NULL;
+}
+
+static void CountedFree(void* ptr) {
+  if (ptr) {
+    free(static_cast<char*>(ptr) - kHeaderSize);
+  }
+}
+
+void* operator new(size_t size) throw(std::bad_alloc) {
+  if (void* p = CountedAlloc(size)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+void* operator new(size_t size, const std::nothrow_t&) throw() {
+  return CountedAlloc(size);
+}
+
+void operator delete(void* ptr) throw() {
+  CountedFree(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) throw() {
+  CountedFree(ptr);
+}
+
+int main(int argc, char** argv) {
+  if (argc != 2) {
+    cerr << "usage: " << argv[0] << " input.kml|input.kmz" << endl;
+    return 1;
+  }
+  std::string file_data;
+  if (!kmlbase::File::ReadFileToString(argv[1], &file_data)) {
+    cerr << "read failed: " << argv[1] << endl;
+    return 1;
+  }
+  std::string kml;
+  if (KmzFile::IsKmz(file_data)) {
+    boost::scoped_ptr<KmzFile> kmz_file(KmzFile::OpenFromString(file_data));
+    if (!kmz_file.get() || !kmz_file->ReadKml(&kml)) {
+      cerr << "failed reading KML from KMZ: " << argv[1] << endl;
+      return 1;
+    }
+  } else {
+    kml.swap(file_data);
+  }
+
+  // These are the ParserObservers KmlFile uses.
+  kmlengine::ObjectIdMap object_id_map;
+  kmlengine::ObjectIdParserObserver object_id_parser_observer(&object_id_map,
+                                                               false);
+  kmlengine::SharedStyleMap shared_style_map;
+  kmlengine::SharedStyleParserObserver shared_style_parser_observer(
+      &shared_style_map, false);
+  kmlengine::ElementVector link_parent_vector;
+  kmlengine::GetLinkParentsParserObserver get_link_parents(
+      &link_parent_vector);
+
+  ParseProfile parse_profile;
+  parse_profile.set_allocation_counter(GetAllocationCount);
+  kmldom::Parser parser;
+  parser.AddObserver(&object_id_parser_observer);
+  parser.AddObserver(&shared_style_parser_observer);
+  parser.AddObserver(&get_link_parents);
+  parser.set_parse_profile(&parse_profile);
+
+  std::string errors;
+  const double start = GetMicroTime();
+  kmldom::ElementPtr root = parser.Parse(kml, &errors);
+  const double parse_time = GetMicroTime() - start;
+  if (!root) {
+    cerr << "parse failed: " << errors << endl;
+    return 1;
+  }
+  std::string report;
+  parse_profile.Serialize(&report);
+  cout << report;
+  cerr << "parse: " << parse_time << " sec, " << kml.size() << " bytes"
+       << endl;
+  return 0;
+}
@@ -0,0 +1,92 @@
+// Copyright 2008, Google Inc. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//  3. Neither the name of Google Inc. nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// This program writes a KML snapshot of the given KML or KMZ file and
+// compares the time to load it against that of KmlFile::CreateFromParse().
+// See kml/engine/kml_snapshot.h.
+
+#include <iostream>
+#include <string>
+#include "boost/scoped_ptr.hpp"
+#include "kml/base/file.h"
+#include "kml/base/time_util.h"
+#include "kml/dom.h"
+#include "kml/engine.h"
+
+using kmlbase::GetMicroTime;
+using kmlengine::KmlFile;
+using kmlengine::KmlFilePtr;
+using kmlengine::KmlSnapshot;
+using std::cerr;
+using std::cout;
+using std::endl;
+
+int main(int argc, char** argv) {
+  if (argc != 3) {
+    cerr << "usage: " << argv[0] << " input.kml output.kmlsnap" << endl;
+    return 1;
+  }
+  std::string file_data;
+  if (!kmlbase::File::ReadFileToString(argv[1], &file_data)) {
+    cerr << "read failed: " << argv[1] << endl;
+    return 1;
+  }
+
+  std::string errors;
+  double start = GetMicroTime();
+  KmlFilePtr kml_file = KmlFile::CreateFromParse(file_data, &errors);
+  const double parse_time = GetMicroTime() - start;
+  if (!kml_file) {
+    cerr << "parse failed: " << errors << endl;
+    return 1;
+  }
+
+  start = GetMicroTime();
+  if (!kmlengine::WriteKmlSnapshotToFile(*kml_file, argv[2])) {
+    cerr << "write failed: " << argv[2] << endl;
+    return 1;
+  }
+  const double write_time = GetMicroTime() - start;
+
+  start = GetMicroTime();
+  boost::scoped_ptr<KmlSnapshot> snapshot(
+      KmlSnapshot::OpenFromFile(argv[2], &errors));
+  if (!snapshot.get()) {
+    cerr << "open failed: " << errors << endl;
+    return 1;
+  }
+  KmlFilePtr loaded = KmlFile::CreateFromSnapshot(*snapshot, &errors);
+  const double load_time = GetMicroTime() - start;
+  if (!loaded) {
+    cerr << "load failed: " << errors << endl;
+    return 1;
+  }
+
+  cout << "CreateFromParse:    " << parse_time << " sec" << endl;
+  cout << "WriteKmlSnapshot:   " << write_time << " sec" << endl;
+  cout << "CreateFromSnapshot: " << load_time << " sec" << endl;
+  cout << "ids in snapshot:    " << snapshot->get_id_count() << endl;
+  return 0;
+}
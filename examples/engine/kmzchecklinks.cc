@@ -59,14 +59,13 @@ int PrintAndCheckLinks(const char* kmz_filename) {
   // TODO if Model/Link/href="dir/model.kml" then textures/foo.jpg is
   // TODO access with Model/ResourceMap/Alias/targetHref="../textures/foo.jpg"
 
-  // Try to access each relative link within the KMZ.
+  // Look up each relative link in the KMZ.
   int ret = 0;
   for (size_t i = 0; i < href_vector.size(); ++i) {
     std::cout << href_vector[i] << " ... ";
     Href href(href_vector[i]);
     if (href.IsRelativePath()) {
-      std::string content;
-      if (!kmz_file->ReadFile(href.get_path().c_str(), &content)) {
+      if (!kmz_file->HasFile(href.get_path().c_str())) {
         std::cout << "NO";
         ret = -1;
       } else {
@@ -0,0 +1,112 @@
+// Copyright 2008, Google Inc. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//  3. Neither the name of Google Inc. nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// This program reports the time taken to write the given files into a KMZ
+// archive and the size of the archive for several ZipWriter settings: one
+// thread deflating every file as KmzFile used to, storing images, using one
+// thread per processor and a fast compression level. The intended input is
+// the output of a regionator: many small KML files and image tiles.
+//   kmzwritebench output.kmz file...
+// Each file is archived at the path given on the command line.
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include "boost/scoped_ptr.hpp"
+#include "kml/base/file.h"
+#include "kml/base/mimetypes.h"
+#include "kml/base/parallel.h"
+#include "kml/base/time_util.h"
+#include "kml/base/zip_writer.h"
+
+using kmlbase::ZipWriter;
+using std::cerr;
+using std::cout;
+using std::endl;
+
+struct Setting {
+  const char* name;
+  unsigned int num_threads;
+  int default_level;
+  bool store_images;
+};
+
+static bool WriteKmz(const std::string& kmz_path,
+                     const std::vector<std::string>& files,
+                     const Setting& setting) {
+  boost::scoped_ptr<ZipWriter> zip_writer(
+      ZipWriter::Create(kmz_path.c_str()));
+  if (!zip_writer.get()) {
+    return false;
+  }
+  zip_writer->set_num_threads(setting.num_threads);
+  zip_writer->set_default_level(setting.default_level);
+  if (!setting.store_images) {
+    zip_writer->set_mimetype_level(kmlbase::kGifMimeType,
+                                   setting.default_level);
+    zip_writer->set_mimetype_level(kmlbase::kJpegMimeType,
+                                   setting.default_level);
+    zip_writer->set_mimetype_level(kmlbase::kPngMimeType,
+                                   setting.default_level);
+  }
+  for (size_t i = 0; i < files.size(); ++i) {
+    if (!zip_writer->AddFileEntry(files[i], files[i])) {
+      cerr << "cannot archive " << files[i] << endl;
+      return false;
+    }
+  }
+  return zip_writer->Close();
+}
+
+int main(int argc, char** argv) {
+  if (argc < 3) {
+    cerr << "usage: " << argv[0] << " output.kmz file..." << endl;
+    return 1;
+  }
+  const std::string kmz_path(argv[1]);
+  std::vector<std::string> files(argv + 2, argv + argc);
+
+  const Setting kSettings[] = {
+    { "1 thread, deflate all", 1, ZipWriter::kDefaultLevel, false },
+    { "1 thread, store images", 1, ZipWriter::kDefaultLevel, true },
+    { "all threads, store images", 0, ZipWriter::kDefaultLevel, true },
+    { "all threads, level 1", 0, 1, true }
+  };
+  cout << files.size() << " files, " << kmlbase::GetProcessorCount()
+       << " processors" << endl;
+  for (size_t i = 0; i < sizeof(kSettings) / sizeof(kSettings[0]); ++i) {
+    double start = kmlbase::GetMicroTime();
+    if (!WriteKmz(kmz_path, files, kSettings[i])) {
+      cerr << "cannot write " << kmz_path << endl;
+      return 1;
+    }
+    double elapsed = kmlbase::GetMicroTime() - start;
+    std::string kmz_data;
+    kmlbase::File::ReadFileToString(kmz_path, &kmz_data);
+    cout << kSettings[i].name << ": " << elapsed * 1000 << " ms, "
+         << kmz_data.size() << " bytes" << endl;
+  }
+  return 0;
+}
@@ -0,0 +1,118 @@
+// Copyright 2008, Google Inc. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//  3. Neither the name of Google Inc. nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// This program compares the throughput of parsing many small KML documents
+// with a new kmldom::Parser for each document and with a reused
+// kmldom::ParserSession.  Each document is a NetworkLinkControl of about
+// 1 KB as returned by a NetworkLink refresh.
+
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "kml/base/time_util.h"
+#include "kml/dom.h"
+
+using kmlbase::GetMicroTime;
+using std::cerr;
+using std::cout;
+using std::endl;
+
+// The number of distinct documents parsed in turn.
+static const int kDocumentCount = 16;
+
+static std::string GenerateKml(int n) {
+  std::stringstream kml;
+  kml << "<kml xmlns=\"http://www.opengis.net/kml/2.2\">"
+      << "<NetworkLinkControl><minRefreshPeriod>" << n
+      << "</minRefreshPeriod><cookie>session=" << n << "</cookie>"
+      << "<Update><targetHref>http://example.com/live.kml</targetHref>"
+      << "<Change>";
+  for (int i = 0; i < 6; ++i) {
+    kml << "<Placemark targetId=\"vehicle-" << n * 6 + i << "\">"
+        << "<name>Vehicle " << n * 6 + i << "</name>"
+        << "<Point><coordinates>" << -122.0 - 0.01 * i << ","
+        << 37.0 + 0.01 * n << ",0</coordinates></Point></Placemark>";
+  }
+  kml << "</Change></Update></NetworkLinkControl></kml>";
+  return kml.str();
+}
+
+static void Report(const char* name, double seconds, int count,
+                   size_t bytes, int check) {
+  cout << name << ": " << seconds << " sec, "
+       << count / seconds << " docs/sec, "
+       << bytes / seconds / (1024 * 1024) << " MB/sec (check " << check
+       << ")" << endl;
+}
+
+int main(int argc, char** argv) {
+  if (argc != 2 || atoi(argv[1]) <= 0) {
+    cerr << "usage: " << argv[0] << " count" << endl;
+    return 1;
+  }
+  const int count = atoi(argv[1]);
+
+  std::vector<std::string> documents(kDocumentCount);
+  size_t bytes = 0;
+  for (int i = 0; i < kDocumentCount; ++i) {
+    documents[i] = GenerateKml(i);
+  }
+  for (int i = 0; i < count; ++i) {
+    bytes += documents[i % kDocumentCount].size();
+  }
+  cout << "average document size: " << bytes / count << " bytes" << endl;
+
+  int check = 0;
+  double start = GetMicroTime();
+  for (int i = 0; i < count; ++i) {
+    kmldom::Parser parser;
+    if (parser.Parse(documents[i % kDocumentCount], NULL)) {
+      ++check;
+    }
+  }
+  Report("Parser per document", GetMicroTime() - start, count, bytes, check);
+
+  check = 0;
+  start = GetMicroTime();
+  kmldom::ParserSession parser_session;
+  for (int i = 0; i < count; ++i) {
+    if (parser_session.Parse(documents[i % kDocumentCount], NULL)) {
+      ++check;
+    }
+  }
+  Report("ParserSession", GetMicroTime() - start, count, bytes, check);
+
+  check = 0;
+  start = GetMicroTime();
+  for (int i = 0; i < count; ++i) {
+    if (kmldom::Parse(documents[i % kDocumentCount], NULL)) {
+      ++check;
+    }
+  }
+  Report("kmldom::Parse", GetMicroTime() - start, count, bytes, check);
+  return 0;
+}
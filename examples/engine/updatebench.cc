@@ -0,0 +1,109 @@
+// Copyright 2008, Google Inc. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//  3. Neither the name of Google Inc. nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// This program times <Update>s such as a vehicle tracking feed sends: each
+// moves one of the given number of Placemarks and changes its name and time.
+// The KmlFile's TimeIndex is built first and so is kept current throughout.
+
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "kml/base/time_util.h"
+#include "kml/dom.h"
+#include "kml/engine.h"
+
+using kmlbase::GetMicroTime;
+using kmlengine::KmlFile;
+using kmlengine::KmlFilePtr;
+using std::cerr;
+using std::cout;
+using std::endl;
+
+static std::string GenerateKml(int placemark_count) {
+  std::stringstream kml;
+  kml << "<kml xmlns=\"http://www.opengis.net/kml/2.2\"><Document>";
+  for (int i = 0; i < placemark_count; ++i) {
+    kml << "<Placemark id=\"p" << i << "\"><name>vehicle " << i << "</name>"
+        << "<TimeStamp id=\"t" << i << "\"><when>2010-02-07T19:57:44Z</when>"
+        << "</TimeStamp><Point id=\"pt" << i << "\">"
+        << "<coordinates>-122,37</coordinates></Point></Placemark>";
+  }
+  kml << "</Document></kml>";
+  return kml.str();
+}
+
+// The i'th update of the Placemark of the given index.
+static kmldom::UpdatePtr GenerateUpdate(int index, int i) {
+  std::stringstream kml;
+  kml << "<Update><Change>"
+      << "<Placemark targetId=\"p" << index << "\"><name>vehicle " << index
+      << " update " << i << "</name></Placemark>"
+      << "<TimeStamp targetId=\"t" << index << "\"><when>2010-02-07T20:"
+      << 10 + i % 50 << ":00Z</when></TimeStamp>"
+      << "<Point targetId=\"pt" << index << "\"><coordinates>"
+      << -122.0 + i * 1e-5 << "," << 37.0 + i * 1e-5
+      << "</coordinates></Point>"
+      << "</Change></Update>";
+  return kmldom::AsUpdate(kmldom::ParseKml(kml.str()));
+}
+
+int main(int argc, char** argv) {
+  if (argc > 3) {
+    cerr << "usage: " << argv[0] << " [placemark_count] [update_count]"
+         << endl;
+    return 1;
+  }
+  const int placemark_count = argc > 1 ? atoi(argv[1]) : 10000;
+  const int update_count = argc > 2 ? atoi(argv[2]) : 100000;
+  if (placemark_count <= 0 || update_count <= 0) {
+    cerr << "counts must be positive" << endl;
+    return 1;
+  }
+  KmlFilePtr kml_file = KmlFile::CreateFromParse(GenerateKml(placemark_count),
+                                                 NULL);
+  if (!kml_file) {
+    cerr << "parse failed" << endl;
+    return 1;
+  }
+  kml_file->GetTimeIndex();
+
+  std::vector<kmldom::UpdatePtr> updates;
+  for (int i = 0; i < update_count; ++i) {
+    updates.push_back(GenerateUpdate(i % placemark_count, i));
+  }
+
+  double start = GetMicroTime();
+  for (int i = 0; i < update_count; ++i) {
+    kmlengine::ProcessUpdate(updates[i], kml_file);
+  }
+  const double elapsed = GetMicroTime() - start;
+  cout << "updates: " << update_count << " of " << placemark_count
+       << " Placemarks" << endl;
+  cout << "process: " << elapsed << " sec, " << update_count / elapsed
+       << " updates/sec" << endl;
+  return 0;
+}
@@ -0,0 +1,95 @@
+// Copyright 2008, Google Inc. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//  3. Neither the name of Google Inc. nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// This program converts each given GPX file to a KML file of the same name
+// ending in .kml instead of .gpx.  Each GPX <trkseg> becomes a <Placemark>
+// with a <gx:Track>.  The files are converted in parallel, one per processor
+// or as many at once as given with -j.  A very long <trkseg> may be split
+// into tracks of at most the number of points given with -n.
+
+#include <stdlib.h>
+#include <string.h>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "kml/base/time_util.h"
+#include "kml/convenience/gpx_track_reader.h"
+
+using std::cerr;
+using std::cout;
+using std::endl;
+
+static void Usage(const char* program) {
+  cerr << "usage: " << program << " [-j threads] [-n max_track_size]"
+       << " input.gpx..." << endl;
+}
+
+int main(int argc, char** argv) {
+  unsigned int num_threads = 0;
+  size_t max_track_size = 0;
+  int arg = 1;
+  for (; arg + 1 < argc && argv[arg][0] == '-'; arg += 2) {
+    if (strcmp(argv[arg], "-j") == 0) {
+      num_threads = static_cast<unsigned int>(atoi(argv[arg + 1]));
+    } else if (strcmp(argv[arg], "-n") == 0) {
+      max_track_size = static_cast<size_t>(atoi(argv[arg + 1]));
+    } else {
+      Usage(argv[0]);
+      return 1;
+    }
+  }
+  if (arg == argc) {
+    Usage(argv[0]);
+    return 1;
+  }
+
+  std::vector<std::string> gpx_filenames;
+  std::vector<std::string> kml_filenames;
+  for (; arg < argc; ++arg) {
+    std::string gpx_filename(argv[arg]);
+    std::string kml_filename(gpx_filename);
+    const size_t dot = kml_filename.rfind('.');
+    if (dot != std::string::npos &&
+        kml_filename.find('/', dot) == std::string::npos) {
+      kml_filename.erase(dot);
+    }
+    kml_filenames.push_back(kml_filename + ".kml");
+    gpx_filenames.push_back(gpx_filename);
+  }
+
+  std::vector<std::string> errors;
+  const double start = kmlbase::GetMicroTime();
+  const size_t converted_count = kmlconvenience::ConvertGpxFilesToKml(
+      gpx_filenames, kml_filenames, max_track_size, num_threads, &errors);
+  const double elapsed = kmlbase::GetMicroTime() - start;
+  for (size_t i = 0; i < errors.size(); ++i) {
+    if (!errors[i].empty()) {
+      cerr << gpx_filenames[i] << ": " << errors[i] << endl;
+    }
+  }
+  cout << "converted " << converted_count << " of " << gpx_filenames.size()
+       << " files in " << elapsed << " sec" << endl;
+  return converted_count == gpx_filenames.size() ? 0 : 1;
+}
@@ -26,9 +26,11 @@
 // Build a Region-based NetworkLink hierarchy from a KML file.  Shared styles
 // are preserved in the case of relative references within the input file.
 
+#include <algorithm>
 #include <fstream>
 #include <iostream>
 #include <string>
+#include <vector>
 #include "kml/base/file.h"
 #include "kml/dom.h"
 #include "kml/convenience/convenience.h"
@@ -91,13 +93,19 @@ int main(int argc, char** argv) {
     return 1;
   }
 
-  // Gather up the shared styles and write them to $output_dir/style.kml.
+  // Gather up the shared styles and write them to $output_dir/style.kml in
+  // order of id as the SharedStyleMap itself is in no particular order.
   // TODO: move this into a KmlFile::CreateFromSharedStyleMap.
   kmldom::KmlFactory* kml_factory = kmldom::KmlFactory::GetFactory();
   kmldom::DocumentPtr document = kml_factory->CreateDocument();
+  std::vector<string> style_ids;
   SharedStyleMap::const_iterator iter = shared_style_map.begin();
   for (; iter != shared_style_map.end(); ++iter) {
-    document->add_styleselector(iter->second);
+    style_ids.push_back(iter->first);
+  }
+  std::sort(style_ids.begin(), style_ids.end());
+  for (size_t i = 0; i < style_ids.size(); ++i) {
+    document->add_styleselector(shared_style_map[style_ids[i]]);
   }
   kmldom::KmlPtr kml = kml_factory->CreateKml();
   kml->set_feature(document);
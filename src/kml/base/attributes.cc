@@ -26,11 +26,27 @@
 // This file contains the implementation of the Attributes class.
 
 #include "kml/base/attributes.h"
-#include <map>
+#include <algorithm>
 #include <vector>
+#include "kml/base/string_pool.h"
 
 namespace kmlbase {
 
+const size_t Attributes::kInlineSize;
+
+// Orders entries by name as in a StringMap.
+static bool EntryNameLess(const StringPairVector::value_type& entry,
+                          const string& key) {
+  return entry.first < key;
+}
+
+// Exchanges two entries without copying their strings.
+static void SwapEntries(StringPairVector::value_type* a,
+                        StringPairVector::value_type* b) {
+  a->first.swap(b->first);
+  a->second.swap(b->second);
+}
+
 // static
 Attributes* Attributes::Create(const char** attrs) {
   Attributes* attributes = new Attributes;
@@ -50,35 +66,100 @@ Attributes* Attributes::Create(const kmlbase::StringVector& attrs) {
   return NULL;
 }
 
+bool Attributes::CutValue(const string& attr_name, InternedString* attr_val) {
+  Entry* entry = Find(attr_name);
+  if (!entry) {
+    return false;
+  }
+  if (attr_val) {
+    *attr_val = string_pool_ ? string_pool_->Intern(entry->second)
+                             : InternedString(entry->second);
+  }
+  Erase(entry);
+  return true;
+}
+
+// private
+Attributes::Entry* Attributes::Find(const string& key) {
+  Entry* entry = std::lower_bound(begin(), end(), key, EntryNameLess);
+  return entry != end() && entry->first == key ? entry : NULL;
+}
+
+// private
+const Attributes::Entry* Attributes::Find(const string& key) const {
+  const Entry* entry = std::lower_bound(begin(), end(), key, EntryNameLess);
+  return entry != end() && entry->first == key ? entry : NULL;
+}
+
+// private
+void Attributes::Assign(const string& key, const string& value) {
+  Entry* entry = std::lower_bound(begin(), end(), key, EntryNameLess);
+  if (entry != end() && entry->first == key) {
+    entry->second = value;
+    return;
+  }
+  size_t index = entry - begin();
+  if (overflow_.empty() && inline_size_ < kInlineSize) {
+    // Open a slot at index by shifting the later entries up one.
+    for (size_t i = inline_size_; i > index; --i) {
+      SwapEntries(&inline_entries_[i], &inline_entries_[i - 1]);
+    }
+    inline_entries_[index].first = key;
+    inline_entries_[index].second = value;
+    ++inline_size_;
+    return;
+  }
+  if (overflow_.empty()) {
+    // The inline entries are full so they all move to the heap.
+    overflow_.reserve(kInlineSize * 2);
+    overflow_.resize(inline_size_);
+    for (size_t i = 0; i < inline_size_; ++i) {
+      SwapEntries(&overflow_[i], &inline_entries_[i]);
+    }
+    inline_size_ = 0;
+  }
+  overflow_.insert(overflow_.begin() + index, Entry(key, value));
+}
+
+// private
+void Attributes::Erase(Entry* entry) {
+  size_t index = entry - begin();
+  if (!overflow_.empty()) {
+    overflow_.erase(overflow_.begin() + index);
+    return;
+  }
+  for (size_t i = index + 1; i < inline_size_; ++i) {
+    SwapEntries(&inline_entries_[i - 1], &inline_entries_[i]);
+  }
+  --inline_size_;
+  inline_entries_[inline_size_].first.clear();
+  inline_entries_[inline_size_].second.clear();
+}
+
 // private
 bool Attributes::Parse(const char** attrs) {
   while (*attrs && *(attrs+1)) {  // Quietly ignore unpaired last item.
     const char* attr_name = *attrs++;
     const char* attr_val = *attrs++;
-    attributes_map_[attr_name] = attr_val;
+    Assign(attr_name, attr_val);
   }
   return true;
 }
 
 bool Attributes::Parse(const kmlbase::StringVector& attrs) {
-  for (unsigned int i = 0; i < attrs.size() ; i += 2) {
-    if (attrs.size() - i < 1)
-      break;
-    string attr_name = attrs.at(i);
-    string attr_val = attrs.at(i+1);
-    attributes_map_[attr_name] = attr_val;
+  for (size_t i = 0; i + 1 < attrs.size(); i += 2) {
+    Assign(attrs[i], attrs[i + 1]);
   }
   return true;
 }
 
 void Attributes::Serialize(string* output) const {
   if (output) {
-    StringMapIterator iter = CreateIterator();
-    for (; !iter.AtEnd(); iter.Advance()) {
+    for (const Entry* entry = begin(); entry != end(); ++entry) {
       *output += " ";
-      *output += iter.Data().first;
+      *output += entry->first;
       *output += "=\"";
-      *output += iter.Data().second;
+      *output += entry->second;
       *output += "\"";
     }
   }
@@ -86,20 +167,21 @@ void Attributes::Serialize(string* output) const {
 
 Attributes* Attributes::Clone() const { 
   Attributes* clone = new Attributes();
-  clone->attributes_map_ = attributes_map_;
+  for (const Entry* entry = begin(); entry != end(); ++entry) {
+    clone->Assign(entry->first, entry->second);
+  }
   return clone;
 }
 
 void Attributes::MergeAttributes(const Attributes& input) {
-  StringMapIterator iter = input.CreateIterator();
-  for (; !iter.AtEnd(); iter.Advance()) {
-    attributes_map_[iter.Data().first] = iter.Data().second;
+  for (const Entry* entry = input.begin(); entry != input.end(); ++entry) {
+    Assign(entry->first, entry->second);
   }
 }
 
 bool Attributes::FindValue(const string& key, string* value) const {
-  StringMap::const_iterator entry = attributes_map_.find(key); 
-  if (entry != attributes_map_.end()) {
+  const Entry* entry = Find(key);
+  if (entry) {
     if (value) {
       *value = entry->second;
     } 
@@ -109,11 +191,10 @@ bool Attributes::FindValue(const string& key, string* value) const {
 } 
 
 bool Attributes::FindKey(const string& value, string* key) const {
-  StringMapIterator iter = CreateIterator();
-  for (; !iter.AtEnd(); iter.Advance()) {
-    if (value == iter.Data().second) {
+  for (const Entry* entry = begin(); entry != end(); ++entry) {
+    if (value == entry->second) {
       if (key) {
-        *key = iter.Data().first;
+        *key = entry->first;
       }
       return true;
     }
@@ -123,34 +204,38 @@ bool Attributes::FindKey(const string& value, string* key) const {
 
 void Attributes::GetAttrNames(std::vector<string>* string_vector) const {
   if (string_vector) {
-    StringMapIterator iter = CreateIterator();
-    for (; !iter.AtEnd(); iter.Advance()) {
-      string_vector->push_back(iter.Data().first);
+    for (const Entry* entry = begin(); entry != end(); ++entry) {
+      string_vector->push_back(entry->first);
     }
   }
 }
 
 Attributes* Attributes::SplitByPrefix(const string& prefix) {
-  size_t prefix_size = prefix.size() + 1;  // +1 for the ":"
-  Attributes* split = new Attributes();
-  std::vector<string> keys_to_erase;
-  for (StringMapIterator iter = CreateIterator();
-       !iter.AtEnd(); iter.Advance()) {
-    const string& key = iter.Data().first;
-    if (key.compare(0, prefix_size, prefix + ":") == 0) {
-      split->SetValue(key.substr(prefix_size), iter.Data().second);
-      // Can't erase() while iterating so save the key.
-      keys_to_erase.push_back(key);
+  const string prefix_colon = prefix + ":";
+  const size_t prefix_size = prefix_colon.size();
+  Attributes* split = NULL;
+  // Entries not split out are compacted down in place.
+  Entry* kept = begin();
+  for (Entry* entry = begin(); entry != end(); ++entry) {
+    if (entry->first.compare(0, prefix_size, prefix_colon) == 0) {
+      if (!split) {
+        split = new Attributes();
+      }
+      split->Assign(entry->first.substr(prefix_size), entry->second);
+    } else {
+      if (kept != entry) {
+        SwapEntries(kept, entry);
+      }
+      ++kept;
     }
   }
   // Nothing was split out so just return now.
-  if (split->attributes_map_.empty()) {
-    delete split;
+  if (!split) {
     return NULL;
   }
-  // Go back and remove all entries added to the split map.
-  for (size_t i = 0; i < keys_to_erase.size(); ++i) {
-    attributes_map_.erase(keys_to_erase[i]);
+  // Drop the entries left past the kept ones.
+  while (end() != kept) {
+    Erase(end() - 1);
   }
   return split;
 }
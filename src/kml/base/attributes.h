@@ -29,14 +29,17 @@
 #define KML_BASE_ATTRIBUTES_H__
 
 #include <stdlib.h>
-#include <map>
 #include <sstream>
+#include <vector>
 #include "boost/scoped_ptr.hpp"
 #include "kml/base/string_util.h"
 #include "kml/base/util.h"
 
 namespace kmlbase {
 
+class InternedString;
+class StringPool;
+
 class Attributes {
  public:
   // Construct the Attributes instance from a list of name-value pairs
@@ -45,7 +48,7 @@ class Attributes {
   static Attributes* Create(const kmlbase::StringVector& attrs);
 
   // Construct the Attributes instance with no initial name-value pairs.
-  Attributes() {}
+  Attributes() : inline_size_(0), string_pool_(NULL) {}
 
   // Creates an exact copy of the Attributes object.
   Attributes* Clone() const;
@@ -53,14 +56,14 @@ class Attributes {
   bool FindValue(const string& key, string* value) const;
   bool FindKey(const string& value, string* key) const;
   size_t GetSize() const {
-    return attributes_map_.size();
+    return overflow_.empty() ? inline_size_ : overflow_.size();
   }
 
   // Split prefixed attributes out to a new Attributes.
   Attributes* SplitByPrefix(const string& prefix);
 
   StringMapIterator CreateIterator() const {
-    return StringMapIterator(attributes_map_);
+    return StringMapIterator(begin(), end());
   }
 
   // Get the value of the given attribute as the templated type.  Returns true
@@ -83,18 +86,28 @@ class Attributes {
   template<typename T>
   bool CutValue(const string& attr_name, T* attr_val) {
     if (GetValue(attr_name, attr_val)) {
-      attributes_map_.erase(attr_name);
+      Erase(Find(attr_name));
       return true;
     }
     return false;
   }
 
+  // As CutValue() for a string value, but the value is interned in the
+  // StringPool set with set_string_pool() if there is one.
+  bool CutValue(const string& attr_name, InternedString* attr_val);
+
+  // The StringPool used by CutValue() for InternedString values.  The pool
+  // is not owned by this Attributes.  The default is no pool.
+  void set_string_pool(StringPool* string_pool) {
+    string_pool_ = string_pool;
+  }
+
   // Set the value of the given attribute.  Any previous value for this
   // attribute is overwritten.  T can be one of string, int, double or
   // bool.
   template<typename T>
   void SetValue(const string& attr_name, const T& attr_val) {
-    attributes_map_[attr_name] = ToString(attr_val);
+    Assign(attr_name, ToString(attr_val));
   }
 
   // These are deprecated.  Use Get() and Set().
@@ -129,9 +142,40 @@ class Attributes {
   bool Parse(const char** attrs);
   bool Parse(const kmlbase::StringVector& attrs);
 
+  typedef StringPairVector::value_type Entry;
+
+  // The entries are held in the order of a StringMap.  Anything from
+  // begin() to end() is contiguous.
+  const Entry* begin() const {
+    return overflow_.empty() ? inline_entries_ : &overflow_[0];
+  }
+  const Entry* end() const {
+    return begin() + GetSize();
+  }
+  Entry* begin() {
+    return overflow_.empty() ? inline_entries_ : &overflow_[0];
+  }
+  Entry* end() {
+    return begin() + GetSize();
+  }
+
+  // Returns the entry for this key or NULL if there is none.
+  Entry* Find(const string& key);
+  const Entry* Find(const string& key) const;
+  // Sets the value for this key, adding an entry if there is none.
+  void Assign(const string& key, const string& value);
+  // Removes the given entry, which must be one of this Attributes.
+  void Erase(Entry* entry);
+
   // XML attributes have no order and are unique.  The attribute name is
-  // preserved to properly save unknown attributes.
-  StringMap attributes_map_;
+  // preserved to properly save unknown attributes.  Nearly every element
+  // has at most a couple of attributes, so these live in place and only
+  // move to the heap (all together) once there are more.
+  static const size_t kInlineSize = 2;
+  Entry inline_entries_[kInlineSize];
+  size_t inline_size_;
+  std::vector<Entry> overflow_;
+  StringPool* string_pool_;
   LIBKML_DISALLOW_EVIL_CONSTRUCTORS(Attributes);
 };
 
@@ -28,6 +28,7 @@
 #include "kml/base/attributes.h"
 #include <algorithm>
 #include "boost/scoped_ptr.hpp"
+#include "kml/base/string_pool.h"
 #include "gtest/gtest.h"
 
 namespace kmlbase {
@@ -96,6 +97,30 @@ TEST_F(AttributesTest, TestGetStringDesctructive) {
   ASSERT_FALSE(attributes_->GetValue(atts[0], &got_val_again));
 }
 
+TEST_F(AttributesTest, TestCutInternedString) {
+  const char* atts[] = { "name", "population", "other", "x", 0 };
+  attributes_.reset(Attributes::Create(atts));
+  // Without a StringPool the value is simply copied.
+  InternedString got_val;
+  ASSERT_TRUE(attributes_->CutValue("name", &got_val));
+  ASSERT_EQ(string(atts[1]), got_val.get());
+  ASSERT_FALSE(attributes_->GetValue("name", static_cast<string*>(NULL)));
+  ASSERT_FALSE(attributes_->CutValue("name", &got_val));
+  ASSERT_EQ(string(atts[1]), got_val.get());
+
+  // With a StringPool equal values share storage.
+  StringPool string_pool;
+  InternedString expected = string_pool.Intern(atts[1]);
+  attributes_.reset(Attributes::Create(atts));
+  attributes_->set_string_pool(&string_pool);
+  ASSERT_TRUE(attributes_->CutValue("name", &got_val));
+  ASSERT_TRUE(expected.shares_storage_with(got_val));
+  ASSERT_EQ(static_cast<size_t>(1), string_pool.size());
+  ASSERT_TRUE(attributes_->CutValue("other",
+                                    static_cast<InternedString*>(NULL)));
+  ASSERT_EQ(static_cast<size_t>(0), attributes_->GetSize());
+}
+
 TEST_F(AttributesTest, TestSetGetString) {
   const string kVal0 = "val0";
   const string kVal1 = "val1";
@@ -269,4 +294,48 @@ TEST_F(AttributesTest, TestIterator) {
   ASSERT_TRUE(iter.AtEnd());
 }
 
+// Verify that more attributes than are held in place keep map order and
+// survive a CutValue() back down to none.
+TEST_F(AttributesTest, TestManyInOrder) {
+  const char* atts[] = { "e", "5", "c", "3", "a", "1", "d", "4", "b", "2",
+                         NULL };
+  attributes_.reset(Attributes::Create(atts));
+  ASSERT_TRUE(attributes_.get());
+  ASSERT_EQ(static_cast<size_t>(5), attributes_->GetSize());
+  string serialized;
+  attributes_->Serialize(&serialized);
+  ASSERT_EQ(string(" a=\"1\" b=\"2\" c=\"3\" d=\"4\" e=\"5\""),
+            serialized);
+  const char* cut_order[] = { "c", "a", "e", "b", "d" };
+  for (size_t i = 0; i < 5; ++i) {
+    string val;
+    ASSERT_TRUE(attributes_->CutValue(cut_order[i], &val));
+    ASSERT_EQ(string(1, cut_order[i][0] - 'a' + '1'), val);
+    ASSERT_FALSE(attributes_->FindValue(cut_order[i], NULL));
+    ASSERT_EQ(static_cast<size_t>(4 - i), attributes_->GetSize());
+  }
+  ASSERT_TRUE(attributes_->CreateIterator().AtEnd());
+}
+
+// Verify that SplitByPrefix() leaves the unprefixed attributes in order.
+TEST_F(AttributesTest, TestSplitKeepsRest) {
+  const char* atts[] = {
+    "xmlns:a", "A", "id", "i", "xmlns:b", "B", "targetId", "t", "z", "Z",
+    NULL
+  };
+  attributes_.reset(Attributes::Create(atts));
+  ASSERT_TRUE(attributes_.get());
+  boost::scoped_ptr<Attributes> xmlns_(attributes_->SplitByPrefix("xmlns"));
+  ASSERT_TRUE(xmlns_.get());
+  string serialized;
+  xmlns_->Serialize(&serialized);
+  ASSERT_EQ(string(" a=\"A\" b=\"B\""), serialized);
+  serialized.clear();
+  attributes_->Serialize(&serialized);
+  ASSERT_EQ(string(" id=\"i\" targetId=\"t\" z=\"Z\""), serialized);
+  // Nothing further to split.
+  ASSERT_FALSE(attributes_->SplitByPrefix("xmlns"));
+  ASSERT_EQ(static_cast<size_t>(3), attributes_->GetSize());
+}
+
 }  // end namespace kmlbase
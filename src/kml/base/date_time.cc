@@ -1,9 +1,9 @@
 // Copyright 2008, Google Inc. All rights reserved.
 //
-// Redistribution and use in source and binary forms, with or without 
+// Redistribution and use in source and binary forms, with or without
 // modification, are permitted provided that the following conditions are met:
 //
-//  1. Redistributions of source code must retain the above copyright notice, 
+//  1. Redistributions of source code must retain the above copyright notice,
 //     this list of conditions and the following disclaimer.
 //  2. Redistributions in binary form must reproduce the above copyright notice,
 //     this list of conditions and the following disclaimer in the documentation
@@ -13,84 +13,286 @@
 //     specific prior written permission.
 //
 // THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
-// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF 
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
 // MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
-// EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+// EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
 // SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
 // PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
 // OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
-// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR 
-// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF 
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
 // ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 // This file contains the implementation of the DateTime class.
 
 #include "kml/base/date_time.h"
-#include "boost/scoped_ptr.hpp"
-#include <stdlib.h>
 
-// TODO: fix this for real.
-#ifdef _WIN32
-time_t timegm(struct tm* tm) {
-  // Not yet implemented on this platform.
-  time_t not_implemented;
-  return not_implemented;
+namespace kmlbase {
+
+const size_t DateTime::kXsdDateTimeSize;
+
+static const int64_t kSecondsPerDay = 86400;
+
+// Days since 1970-01-01 of the given proleptic Gregorian date.  This counts
+// in 400 year eras of 146097 days with each year starting on March 1 such
+// that the leap day is the last day of the year.
+static int64_t DaysFromCivil(int year, int month, int day) {
+  const int64_t y = year - (month <= 2 ? 1 : 0);
+  const int64_t era = (y >= 0 ? y : y - 399) / 400;
+  const int64_t year_of_era = y - era * 400;
+  const int64_t day_of_year =
+      (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+  const int64_t day_of_era = year_of_era * 365 + year_of_era / 4 -
+                             year_of_era / 100 + day_of_year;
+  return era * 146097 + day_of_era - 719468;
 }
-char* strptime(const char* buf, const char* format, struct tm* tm) {
-  // Not yet implemented on this platform.
-  return NULL;
+
+// The inverse of DaysFromCivil().
+static void CivilFromDays(int64_t days, int* year, int* month, int* day) {
+  days += 719468;
+  const int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+  const int64_t day_of_era = days - era * 146097;
+  const int64_t year_of_era = (day_of_era - day_of_era / 1460 +
+                               day_of_era / 36524 - day_of_era / 146096) / 365;
+  const int64_t day_of_year =
+      day_of_era - (365 * year_of_era + year_of_era / 4 - year_of_era / 100);
+  const int64_t shifted_month = (5 * day_of_year + 2) / 153;
+  *day = static_cast<int>(day_of_year - (153 * shifted_month + 2) / 5 + 1);
+  *month = static_cast<int>(shifted_month < 10 ? shifted_month + 3
+                                               : shifted_month - 9);
+  *year = static_cast<int>(year_of_era + era * 400 + (*month <= 2 ? 1 : 0));
 }
-#endif
 
-namespace kmlbase {
+static int DaysInMonth(int year, int month) {
+  static const int kDaysInMonth[] =
+      { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+  if (month == 2 && year % 4 == 0 && (year % 100 != 0 || year % 400 == 0)) {
+    return 29;
+  }
+  return kDaysInMonth[month - 1];
+}
+
+static bool IsXmlSpace(char c) {
+  return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+// This reads exactly count decimal digits at *p and advances *p past them.
+static bool ReadDigits(const char** p, const char* end, int count,
+                       int* value) {
+  if (end - *p < count) {
+    return false;
+  }
+  int v = 0;
+  for (int i = 0; i < count; ++i) {
+    const char c = (*p)[i];
+    if (c < '0' || c > '9') {
+      return false;
+    }
+    v = v * 10 + (c - '0');
+  }
+  *p += count;
+  *value = v;
+  return true;
+}
+
+// This reads the given separator char at *p and advances *p past it.
+static bool ReadChar(const char** p, const char* end, char c) {
+  if (*p == end || **p != c) {
+    return false;
+  }
+  ++*p;
+  return true;
+}
+
+// A time zone offset is the last 6 chars of the text.  This tells a
+// "-hh:mm" offset apart from a "-MM" or "-DD" date field.
+static bool IsOffsetNext(const char* p, const char* end) {
+  return end - p == 6 && (p[0] == '+' || p[0] == '-') && p[3] == ':';
+}
+
+// This writes value as exactly count decimal digits and returns the char
+// after the last digit.
+static char* WriteDigits(int value, int count, char* p) {
+  for (int i = count - 1; i >= 0; --i) {
+    p[i] = static_cast<char>('0' + value % 10);
+    value /= 10;
+  }
+  return p + count;
+}
+
+// This splits a POSIX time into its date and its seconds within the day.
+static void SplitSeconds(int64_t seconds, int* year, int* month, int* day,
+                         int* second_of_day) {
+  int64_t days = seconds / kSecondsPerDay;
+  int64_t remainder = seconds % kSecondsPerDay;
+  if (remainder < 0) {
+    remainder += kSecondsPerDay;
+    --days;
+  }
+  CivilFromDays(days, year, month, day);
+  *second_of_day = static_cast<int>(remainder);
+}
+
+static char* WriteDate(int year, int month, int day, char* p) {
+  p = WriteDigits(year, 4, p);
+  *p++ = '-';
+  p = WriteDigits(month, 2, p);
+  *p++ = '-';
+  return WriteDigits(day, 2, p);
+}
+
+static char* WriteTime(int second_of_day, char* p) {
+  p = WriteDigits(second_of_day / 3600, 2, p);
+  *p++ = ':';
+  p = WriteDigits(second_of_day / 60 % 60, 2, p);
+  *p++ = ':';
+  return WriteDigits(second_of_day % 60, 2, p);
+}
+
+DateTime::DateTime()
+  : seconds_(0),
+    nanoseconds_(0),
+    offset_minutes_(0),
+    has_offset_(true),
+    precision_(PRECISION_SECOND) {
+}
 
 // static
 DateTime* DateTime::Create(const string& str) {
-  DateTime* date_time = new DateTime;
-  if (date_time->ParseXsdDateTime(str)) {
-    return date_time;
+  DateTime date_time;
+  if (!Parse(str.data(), str.size(), &date_time)) {
+    return NULL;
   }
-  delete date_time;
-  return NULL;
+  return new DateTime(date_time);
 }
 
 // static
-time_t DateTime::ToTimeT(const string& str) {
-  boost::scoped_ptr<DateTime> date_time(DateTime::Create(str));
-  return date_time.get() ? date_time->GetTimeT() : 0;
+bool DateTime::Parse(const char* data, size_t size, DateTime* date_time) {
+  if (!data || !date_time) {
+    return false;
+  }
+  const char* p = data;
+  const char* end = data + size;
+  while (p < end && IsXmlSpace(*p)) {
+    ++p;
+  }
+  while (end > p && IsXmlSpace(end[-1])) {
+    --end;
+  }
+
+  int year;
+  int month = 1;
+  int day = 1;
+  int hour = 0;
+  int minute = 0;
+  int second = 0;
+  int nanoseconds = 0;
+  Precision precision = PRECISION_YEAR;
+  if (!ReadDigits(&p, end, 4, &year)) {
+    return false;
+  }
+  if (!IsOffsetNext(p, end) && ReadChar(&p, end, '-')) {
+    if (!ReadDigits(&p, end, 2, &month) || month < 1 || month > 12) {
+      return false;
+    }
+    precision = PRECISION_MONTH;
+    if (!IsOffsetNext(p, end) && ReadChar(&p, end, '-')) {
+      if (!ReadDigits(&p, end, 2, &day) || day < 1 ||
+          day > DaysInMonth(year, month)) {
+        return false;
+      }
+      precision = PRECISION_DAY;
+      if (ReadChar(&p, end, 'T')) {
+        // A leap second of 60 is accepted and runs into the next minute.
+        if (!ReadDigits(&p, end, 2, &hour) || hour > 23 ||
+            !ReadChar(&p, end, ':') ||
+            !ReadDigits(&p, end, 2, &minute) || minute > 59 ||
+            !ReadChar(&p, end, ':') ||
+            !ReadDigits(&p, end, 2, &second) || second > 60) {
+          return false;
+        }
+        precision = PRECISION_SECOND;
+        if (ReadChar(&p, end, '.')) {
+          // Digits past nanoseconds are read and dropped.
+          const char* fraction = p;
+          int scale = 100000000;
+          for (; p < end && *p >= '0' && *p <= '9'; ++p) {
+            nanoseconds += (*p - '0') * scale;
+            scale /= 10;
+          }
+          if (p == fraction) {
+            return false;
+          }
+        }
+      }
+    }
+  }
+
+  int offset_minutes = 0;
+  bool has_offset = false;
+  if (ReadChar(&p, end, 'Z')) {
+    has_offset = true;
+  } else if (p < end && (*p == '+' || *p == '-')) {
+    const int sign = *p++ == '-' ? -1 : 1;
+    int offset_hours;
+    if (!ReadDigits(&p, end, 2, &offset_hours) || offset_hours > 14 ||
+        !ReadChar(&p, end, ':') ||
+        !ReadDigits(&p, end, 2, &offset_minutes) || offset_minutes > 59) {
+      return false;
+    }
+    offset_minutes = sign * (offset_hours * 60 + offset_minutes);
+    has_offset = true;
+  }
+  if (p != end) {
+    return false;
+  }
+
+  date_time->seconds_ = DaysFromCivil(year, month, day) * kSecondsPerDay +
+                        hour * 3600 + minute * 60 + second -
+                        offset_minutes * 60;
+  date_time->nanoseconds_ = nanoseconds;
+  date_time->offset_minutes_ = offset_minutes;
+  date_time->has_offset_ = has_offset;
+  date_time->precision_ = precision;
+  return true;
 }
 
-time_t DateTime::GetTimeT() /* const */ {
-  return timegm(&tm_);
+// static
+time_t DateTime::ToTimeT(const string& str) {
+  DateTime date_time;
+  return Parse(str.data(), str.size(), &date_time) ?
+      date_time.GetTimeT() : 0;
 }
 
-template<int N>
-string DateTime::DoStrftime(const char* format) const {
-  char buf[N];
-  strftime(buf, N, format, &tm_);
-  return buf;
+// static
+size_t DateTime::FormatXsdDateTime(int64_t seconds, char* buffer) {
+  int year, month, day, second_of_day;
+  SplitSeconds(seconds, &year, &month, &day, &second_of_day);
+  char* p = WriteDate(year, month, day, buffer);
+  *p++ = 'T';
+  p = WriteTime(second_of_day, p);
+  *p++ = 'Z';
+  *p = '\0';
+  return p - buffer;
 }
 
 string DateTime::GetXsdTime() const {
-  return DoStrftime<9>("%H:%M:%S");
+  int year, month, day, second_of_day;
+  SplitSeconds(seconds_, &year, &month, &day, &second_of_day);
+  char buf[8];
+  return string(buf, WriteTime(second_of_day, buf));
 }
 
 string DateTime::GetXsdDate() const {
-  return DoStrftime<11>("%Y-%m-%d");
+  int year, month, day, second_of_day;
+  SplitSeconds(seconds_, &year, &month, &day, &second_of_day);
+  char buf[10];
+  return string(buf, WriteDate(year, month, day, buf));
 }
 
 string DateTime::GetXsdDateTime() const {
-  return GetXsdDate() + "T" + GetXsdTime() + "Z";
-}
-
-// private
-DateTime::DateTime() {
-}
-
-// private
-bool DateTime::ParseXsdDateTime(const string& xsd_date_time) {
-  // TODO: strptime on win32?
-  return strptime(xsd_date_time.c_str(), "%Y-%m-%dT%H:%M:%SZ", &tm_) != NULL;
+  char buf[kXsdDateTimeSize];
+  return string(buf, FormatXsdDateTime(seconds_, buf));
 }
 
 }  // end namespace kmlbase
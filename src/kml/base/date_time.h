@@ -31,41 +31,103 @@
 #include <time.h>
 #include "kml/base/util.h"
 
-// TODO: fix this for real.
-#ifdef _WIN32
-time_t timegm(struct tm* tm);
-char* strptime(const char* buf, const char* format, struct tm* tm);
-#endif
-
 namespace kmlbase {
 
+// A DateTime is a point in time as given in a KML <when>, <begin> or <end>.
+// The parse and the formatters are hand-written: neither allocates, neither
+// depends on the C library's locale or time zone, and both behave the same on
+// all platforms.  The time is held as seconds since the POSIX epoch in UTC
+// plus the fraction of the second, the time zone offset of the source text
+// and the precision of the source text.
 class DateTime {
  public:
-  // xsd:datetime: 2008-10-03T09:25:42Z
-  // TODO: date, gYearMonth, gYear
+  // The size of the buffer FormatXsdDateTime() needs, including the
+  // terminating NUL: "2008-10-03T09:25:42Z".
+  static const size_t kXsdDateTimeSize = 21;
+
+  // The XML Schema type of the text a DateTime was parsed from.
+  enum Precision {
+    PRECISION_YEAR,  // gYear: 2008
+    PRECISION_MONTH,  // gYearMonth: 2008-10
+    PRECISION_DAY,  // date: 2008-10-03
+    PRECISION_SECOND  // dateTime: 2008-10-03T09:25:42Z
+  };
+
+  // This is the POSIX epoch, 1970-01-01T00:00:00Z.
+  DateTime();
+
+  // xsd:dateTime, xsd:date, xsd:gYearMonth or xsd:gYear as described in
+  // Parse().  NULL is returned if the string is not one of these.
   static DateTime* Create(const string& str);
 
-  // A convenience utility: Create() + GetTimeT().
+  // This parses size chars of data into the given DateTime.  These forms are
+  // accepted, each with an optional time zone of "Z", "+hh:mm" or "-hh:mm":
+  //   2008
+  //   2008-10
+  //   2008-10-03
+  //   2008-10-03T09:25:42
+  //   2008-10-03T09:25:42.125
+  // A time with no time zone is taken to be UTC.  A date with no time is
+  // taken to be the start of that year, month or day.  Leading and trailing
+  // whitespace is ignored.  The year must have 4 digits.  False is returned
+  // and the DateTime is left unchanged if the text is not one of these forms
+  // or if any field is out of range.
+  static bool Parse(const char* data, size_t size, DateTime* date_time);
+
+  // A convenience utility: Parse() + GetTimeT().  0 is returned if the string
+  // does not parse.
   static time_t ToTimeT(const string& str);
 
+  // This writes the given POSIX time as an xsd:dateTime in UTC to the given
+  // buffer which must hold at least kXsdDateTimeSize chars.  The return value
+  // is the number of chars written not counting the terminating NUL.  The
+  // time must be within the years 0000 through 9999.
+  static size_t FormatXsdDateTime(int64_t seconds, char* buffer);
+
   // POSIX time
-  time_t GetTimeT() /* const */;
+  time_t GetTimeT() const {
+    return static_cast<time_t>(seconds_);
+  }
 
-  // XML Schema 3.2.8 time
+  // Seconds since the POSIX epoch in UTC.
+  int64_t get_seconds() const {
+    return seconds_;
+  }
+
+  // The fraction of the second in nanoseconds: 0 <= nanoseconds < 1e9.
+  int get_nanoseconds() const {
+    return nanoseconds_;
+  }
+
+  // True if the source text had a time zone.
+  bool has_offset() const {
+    return has_offset_;
+  }
+
+  // The time zone offset of the source text in minutes east of UTC.
+  int get_offset_minutes() const {
+    return offset_minutes_;
+  }
+
+  Precision get_precision() const {
+    return precision_;
+  }
+
+  // XML Schema 3.2.8 time in UTC
   string GetXsdTime() const;
 
-  // XML Schema 3.2.9 date
+  // XML Schema 3.2.9 date in UTC
   string GetXsdDate() const;
 
-  // XML Schema 3.2.7 dateTime.
+  // XML Schema 3.2.7 dateTime in UTC.
   string GetXsdDateTime() const;
 
  private:
-  DateTime();
-  template<int N>
-  string DoStrftime(const char* format) const;
-  bool ParseXsdDateTime(const string& xsd_date_time);
-  struct tm tm_;
+  int64_t seconds_;
+  int nanoseconds_;
+  int offset_minutes_;
+  bool has_offset_;
+  Precision precision_;
 };
 
 time_t DateTimeToTimeT(const string& date_time_str);
@@ -60,5 +60,121 @@ TEST_F(DateTimeTest, TestToTimeT) {
   ASSERT_EQ(0, DateTime::ToTimeT("complete invalid input"));
 }
 
+// Parse() into a stack DateTime.
+static bool ParseString(const string& str, DateTime* date_time) {
+  return DateTime::Parse(str.data(), str.size(), date_time);
+}
+
+// Verify each of the forms of time in KML.
+TEST_F(DateTimeTest, TestParseForms) {
+  DateTime date_time;
+  ASSERT_TRUE(ParseString("2008", &date_time));
+  ASSERT_EQ(1199145600, date_time.get_seconds());
+  ASSERT_EQ(DateTime::PRECISION_YEAR, date_time.get_precision());
+  ASSERT_FALSE(date_time.has_offset());
+
+  ASSERT_TRUE(ParseString("2008-10", &date_time));
+  ASSERT_EQ(1222819200, date_time.get_seconds());
+  ASSERT_EQ(DateTime::PRECISION_MONTH, date_time.get_precision());
+
+  ASSERT_TRUE(ParseString("2008-10-03", &date_time));
+  ASSERT_EQ(1222992000, date_time.get_seconds());
+  ASSERT_EQ(DateTime::PRECISION_DAY, date_time.get_precision());
+
+  ASSERT_TRUE(ParseString("2008-10-03T09:25:42", &date_time));
+  ASSERT_EQ(1223025942, date_time.get_seconds());
+  ASSERT_EQ(DateTime::PRECISION_SECOND, date_time.get_precision());
+  ASSERT_FALSE(date_time.has_offset());
+  ASSERT_EQ(0, date_time.get_nanoseconds());
+
+  ASSERT_TRUE(ParseString("2008-10-03T09:25:42Z", &date_time));
+  ASSERT_EQ(1223025942, date_time.get_seconds());
+  ASSERT_TRUE(date_time.has_offset());
+  ASSERT_EQ(0, date_time.get_offset_minutes());
+
+  ASSERT_TRUE(ParseString("  2007-01-14T22:57:31.000Z\n", &date_time));
+  ASSERT_EQ(1168815451, date_time.get_seconds());
+  ASSERT_EQ(0, date_time.get_nanoseconds());
+  ASSERT_TRUE(ParseString("2007-01-14T22:57:31.125Z", &date_time));
+  ASSERT_EQ(125000000, date_time.get_nanoseconds());
+  ASSERT_TRUE(ParseString("2007-01-14T22:57:31.1234567891Z", &date_time));
+  ASSERT_EQ(123456789, date_time.get_nanoseconds());
+}
+
+// Verify that a time zone offset is applied to the UTC time.
+TEST_F(DateTimeTest, TestParseOffset) {
+  DateTime date_time;
+  ASSERT_TRUE(ParseString("2008-10-03T02:25:42-07:00", &date_time));
+  ASSERT_EQ(1223025942, date_time.get_seconds());
+  ASSERT_EQ(-420, date_time.get_offset_minutes());
+  ASSERT_TRUE(ParseString("2008-10-03T14:55:42+05:30", &date_time));
+  ASSERT_EQ(1223025942, date_time.get_seconds());
+  ASSERT_EQ(330, date_time.get_offset_minutes());
+  // An offset on a date is not mistaken for a month or a day.
+  ASSERT_TRUE(ParseString("2008-05:00", &date_time));
+  ASSERT_EQ(DateTime::PRECISION_YEAR, date_time.get_precision());
+  ASSERT_EQ(1199145600 + 5 * 3600, date_time.get_seconds());
+  ASSERT_TRUE(ParseString("2008-10+01:00", &date_time));
+  ASSERT_EQ(DateTime::PRECISION_MONTH, date_time.get_precision());
+  ASSERT_EQ(1222819200 - 3600, date_time.get_seconds());
+  ASSERT_TRUE(ParseString("2008-10-03Z", &date_time));
+  ASSERT_EQ(DateTime::PRECISION_DAY, date_time.get_precision());
+  ASSERT_EQ(1222992000, date_time.get_seconds());
+}
+
+// Verify that malformed and out of range input fails and changes nothing.
+TEST_F(DateTimeTest, TestParseBad) {
+  const char* kBad[] = {
+    "", " ", "200", "20080", "2008-", "2008-1", "2008-13", "2008-00",
+    "2008-10-3", "2008-10-32", "2007-02-29", "2008-10-03T", "2008-10-03T9",
+    "2008-10-03T24:00:00Z", "2008-10-03T09:60:00Z", "2008-10-03T09:25:61Z",
+    "2008-10-03T09:25Z", "2008-10-03T09:25:42.Z", "2008-10-03T09:25:42ZZ",
+    "2008-10-03T09:25:42+1:00", "2008-10-03T09:25:42+15:00",
+    "2008-10-03 09:25:42", "2008/10/03", "x2008", "2008-10-03T09:25:42Zx"
+  };
+  DateTime date_time;
+  ASSERT_TRUE(ParseString("2008-10-03T09:25:42Z", &date_time));
+  for (size_t i = 0; i < sizeof(kBad) / sizeof(kBad[0]); ++i) {
+    ASSERT_FALSE(ParseString(kBad[i], &date_time)) << kBad[i];
+    ASSERT_EQ(1223025942, date_time.get_seconds());
+  }
+  ASSERT_FALSE(DateTime::Parse(NULL, 0, &date_time));
+  ASSERT_TRUE(ParseString("2008-02-29", &date_time));
+  ASSERT_TRUE(ParseString("2000-02-29", &date_time));
+  ASSERT_FALSE(ParseString("1900-02-29", &date_time));
+}
+
+// Verify the formatter against known times and the parser over a range.
+TEST_F(DateTimeTest, TestFormatXsdDateTime) {
+  char buf[DateTime::kXsdDateTimeSize];
+  ASSERT_EQ(static_cast<size_t>(20), DateTime::FormatXsdDateTime(0, buf));
+  ASSERT_EQ(string("1970-01-01T00:00:00Z"), buf);
+  DateTime::FormatXsdDateTime(1223025942, buf);
+  ASSERT_EQ(string("2008-10-03T09:25:42Z"), buf);
+  DateTime::FormatXsdDateTime(-1, buf);
+  ASSERT_EQ(string("1969-12-31T23:59:59Z"), buf);
+  DateTime::FormatXsdDateTime(951782400, buf);
+  ASSERT_EQ(string("2000-02-29T00:00:00Z"), buf);
+
+  // Step through 0001 to 9999 by a little over 3 days at a time.
+  DateTime date_time;
+  const int64_t kFirst = static_cast<int64_t>(-719162) * 86400;
+  const int64_t kLast = static_cast<int64_t>(2932897) * 86400;
+  for (int64_t seconds = kFirst; seconds < kLast; seconds += 273601) {
+    const size_t size = DateTime::FormatXsdDateTime(seconds, buf);
+    ASSERT_TRUE(DateTime::Parse(buf, size, &date_time)) << buf;
+    ASSERT_EQ(seconds, date_time.get_seconds()) << buf;
+  }
+}
+
+// Verify the string accessors of a time with an offset are in UTC.
+TEST_F(DateTimeTest, TestXsdAccessorsAreUtc) {
+  date_time_.reset(DateTime::Create("2008-10-03T23:30:00-02:00"));
+  ASSERT_TRUE(date_time_.get());
+  ASSERT_EQ(string("01:30:00"), date_time_->GetXsdTime());
+  ASSERT_EQ(string("2008-10-04"), date_time_->GetXsdDate());
+  ASSERT_EQ(string("2008-10-04T01:30:00Z"), date_time_->GetXsdDateTime());
+}
+
 
 }  // end namespace kmlbase
@@ -54,8 +54,21 @@ public:
     return parser_;
   }
 
+  // ExpatParser reuses these for the name and attributes of each element
+  // such that (in particular) a long namespace-qualified name is not
+  // allocated anew for every tag.  A handler must not hold on to the name
+  // or attributes passed to StartElement() or EndElement().
+  string* get_name_buffer() {
+    return &name_buffer_;
+  }
+  StringVector* get_atts_buffer() {
+    return &atts_buffer_;
+  }
+
 private:
   XML_Parser parser_;
+  string name_buffer_;
+  StringVector atts_buffer_;
 };
 
 const int kBitMask = 0x3f;
@@ -91,12 +104,27 @@ inline void xmlchar_to_utf8(const XML_Char *input, string* buffer) {
   }
 }
 
-inline string xml_char_to_string(const XML_Char *input) {
-  string output;
-
+// This sets output to the UTF-8 of the input reusing the output's storage.
+inline void xml_char_to_string(const XML_Char *input, string* output) {
+  // When not built with XML_UNICODE the input already is UTF-8 and is copied
+  // in one go rather than grown a char at a time.
+  if (sizeof(XML_Char) == 1) {
+    if (input) {
+      output->assign(reinterpret_cast<const char*>(input));
+    } else {
+      output->clear();
+    }
+    return;
+  }
+  output->clear();
   for (const XML_Char *p = input; input && *p; p++) {
-    xmlchar_to_utf8(p, &output);
+    xmlchar_to_utf8(p, output);
   }
+}
+
+inline string xml_char_to_string(const XML_Char *input) {
+  string output;
+  xml_char_to_string(input, &output);
   return output;
 }
 
@@ -112,6 +140,10 @@ inline void xml_char_to_string_vec(const XML_Char **input,
 
 inline string xml_char_to_string_n(const XML_Char *input, size_t length) {
   string output;
+  if (sizeof(XML_Char) == 1) {
+    output.assign(reinterpret_cast<const char*>(input), length);
+    return output;
+  }
   while (length--) {
     xmlchar_to_utf8(input++, &output);
   }
@@ -34,17 +34,22 @@ namespace kmlbase {
 
 static void XMLCALL
 startElement(void *userData, const XML_Char *name, const XML_Char **atts) {
-  string flatname = xml_char_to_string(name);
+  ExpatHandler* expat_handler = static_cast<ExpatHandler*>(userData);
+  string* flatname = expat_handler->get_name_buffer();
+  xml_char_to_string(name, flatname);
   // TODO: kmlbase::Attributes would be a more appropriate type here.
-  StringVector flatatts;
-  xml_char_to_string_vec(atts, &flatatts);
-  static_cast<ExpatHandler*>(userData)->StartElement(flatname, flatatts);
+  StringVector* flatatts = expat_handler->get_atts_buffer();
+  flatatts->clear();
+  xml_char_to_string_vec(atts, flatatts);
+  expat_handler->StartElement(*flatname, *flatatts);
 }
 
 static void XMLCALL
 endElement(void *userData, const XML_Char *name) {
-  string flatname = xml_char_to_string(name);
-  static_cast<ExpatHandler*>(userData)->EndElement(flatname);
+  ExpatHandler* expat_handler = static_cast<ExpatHandler*>(userData);
+  string* flatname = expat_handler->get_name_buffer();
+  xml_char_to_string(name, flatname);
+  expat_handler->EndElement(*flatname);
 }
 
 static void XMLCALL
@@ -77,19 +82,11 @@ entityDeclHandler(void *userData, const XML_Char *entityName,
 }
 
 ExpatParser::ExpatParser(ExpatHandler* handler, bool namespace_aware)
-  : expat_handler_(handler) {
-  XML_Parser parser =
-    namespace_aware ? XML_ParserCreateNS(NULL, kExpatNsSeparator)
-                    : XML_ParserCreate(NULL);
-  expat_handler_->set_parser(parser);
-  XML_SetUserData(parser, expat_handler_);
-  XML_SetElementHandler(parser, startElement, endElement);
-  XML_SetCharacterDataHandler(parser, charData);
-  XML_SetEntityDeclHandler(parser, entityDeclHandler);
-  if (namespace_aware) {
-    XML_SetNamespaceDeclHandler(parser, startNamespace, endNamespace);
-  }
-  parser_ = parser;
+  : expat_handler_(handler),
+    namespace_aware_(namespace_aware) {
+  parser_ = namespace_aware ? XML_ParserCreateNS(NULL, kExpatNsSeparator)
+                            : XML_ParserCreate(NULL);
+  SetHandlers();
 }
 
 ExpatParser::~ExpatParser() {
@@ -103,6 +100,15 @@ bool ExpatParser::ParseString(const string& xml, ExpatHandler* handler,
   return parser._ParseString(xml, errors);
 }
 
+bool ExpatParser::Reset() {
+  // Expat keeps the namespace mode.
+  if (!XML_ParserReset(parser_, NULL)) {
+    return false;
+  }
+  SetHandlers();
+  return true;
+}
+
 void* ExpatParser::GetInternalBuffer(size_t len) {
   return static_cast<void*>(XML_GetBuffer(parser_, static_cast<int>(len)));
 }
@@ -140,6 +146,18 @@ bool ExpatParser::ParseInternalBuffer(size_t len, string* errors,
   return status == XML_STATUS_OK;
 }
 
+// Private.
+void ExpatParser::SetHandlers() {
+  expat_handler_->set_parser(parser_);
+  XML_SetUserData(parser_, expat_handler_);
+  XML_SetElementHandler(parser_, startElement, endElement);
+  XML_SetCharacterDataHandler(parser_, charData);
+  XML_SetEntityDeclHandler(parser_, entityDeclHandler);
+  if (namespace_aware_) {
+    XML_SetNamespaceDeclHandler(parser_, startNamespace, endNamespace);
+  }
+}
+
 // Private.
 bool ExpatParser::_ParseString(const string& xml, string* errors) {
   int xml_size = static_cast<int>(xml.size());
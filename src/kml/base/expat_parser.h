@@ -113,9 +113,25 @@ class ExpatParser {
   bool ParseBuffer(const string& input, string* errors,
                    bool is_final);
 
+  // Parses a complete XML document as ParseString() does but with this
+  // parser.  A parser is used for one document only unless Reset() is called
+  // between documents.
+  bool ParseDocument(const string& xml, string* errors) {
+    return _ParseString(xml, errors);
+  }
+
+  // This readies the parser for a new document keeping the memory expat
+  // allocated for the last one.  This is far cheaper than creating a new
+  // parser for each of many small documents.  This returns false if expat
+  // could not be reset in which case the parser must not be used further.
+  bool Reset();
+
  private:
   ExpatHandler* expat_handler_;
   XML_Parser parser_;
+  bool namespace_aware_;
+  // Sets the handler and the expat callbacks.  Expat forgets these on reset.
+  void SetHandlers();
   // Used by the static ParseString public method.
   bool _ParseString(const string& xml, string* errors);
   void ReportError(XML_Parser parser, string* errors);
@@ -230,6 +230,36 @@ TEST_F(ExpatParserTest, TestEntitiesStopParser) {
   ASSERT_EQ(string("<Placemark>"), handler_.get_xml());
 }
 
+// Verify that one parser parses several documents when reset between them.
+TEST_F(ExpatParserTest, TestReset) {
+  const string kTom("<Tom><dick>foo</dick></Tom>");
+  const string kHarry("<harry>bar</harry>");
+  ExpatParser parser(&handler_, false);
+  ASSERT_TRUE(parser.ParseDocument(kTom, &errors_));
+  // Without a reset the parser is done.
+  ASSERT_FALSE(parser.ParseDocument(kHarry, &errors_));
+  ASSERT_TRUE(parser.Reset());
+  ASSERT_TRUE(parser.ParseDocument(kHarry, &errors_));
+  ASSERT_EQ(kTom + kHarry, handler_.get_xml());
+
+  // A failed document does not affect the next.
+  ASSERT_TRUE(parser.Reset());
+  errors_.clear();
+  ASSERT_FALSE(parser.ParseDocument("<Tom><dick>", &errors_));
+  ASSERT_FALSE(errors_.empty());
+  ASSERT_TRUE(parser.Reset());
+  errors_.clear();
+  ASSERT_TRUE(parser.ParseDocument(kHarry, &errors_));
+  ASSERT_TRUE(errors_.empty());
+
+  // The handlers are restored after a reset: an ENTITY still stops a parse.
+  ASSERT_TRUE(parser.Reset());
+  ASSERT_FALSE(parser.ParseDocument(
+      "<!DOCTYPE t [<!ENTITY e \"x\">]><t>&e;</t>", &errors_));
+  ASSERT_TRUE(parser.Reset());
+  ASSERT_TRUE(parser.ParseDocument(kTom, &errors_));
+}
+
 TEST_F(ExpatParserTest, TestUnicode) {
   const string kUnicodeKml(
       "<Placemark>"
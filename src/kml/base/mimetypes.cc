@@ -26,13 +26,48 @@
 // This defines some common KML-related mimetype strings.
 
 #include "kml/base/mimetypes.h"
+#include <ctype.h>
 
 namespace kmlbase {
 
 const char* kAtomMimeType = "application/atom+xml";
 const char* kCsvMimeType = "text/csv";
+const char* kGifMimeType = "image/gif";
+const char* kJpegMimeType = "image/jpeg";
 const char* kKmlMimeType = "application/vnd.google-earth.kml+xml";
 const char* kKmzMimeType = "application/vnd.google-earth.kmz";
+const char* kPngMimeType = "image/png";
+
+const char* GetMimeTypeFromPath(const string& path) {
+  size_t dot = path.rfind('.');
+  if (dot == string::npos || path.find_first_of("/\\", dot) != string::npos) {
+    return NULL;
+  }
+  string extension;
+  for (size_t i = dot + 1; i < path.size(); ++i) {
+    extension.push_back(static_cast<char>(
+        tolower(static_cast<unsigned char>(path[i]))));
+  }
+  if (extension == "kml") {
+    return kKmlMimeType;
+  }
+  if (extension == "kmz") {
+    return kKmzMimeType;
+  }
+  if (extension == "png") {
+    return kPngMimeType;
+  }
+  if (extension == "jpg" || extension == "jpeg") {
+    return kJpegMimeType;
+  }
+  if (extension == "gif") {
+    return kGifMimeType;
+  }
+  if (extension == "csv") {
+    return kCsvMimeType;
+  }
+  return NULL;
+}
 
 }
 
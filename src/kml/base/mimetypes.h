@@ -28,12 +28,21 @@
 #ifndef KML_BASE_MIMETYPES_H__
 #define KML_BASE_MIMETYPES_H__
 
+#include "kml/base/util.h"
+
 namespace kmlbase {
 
 extern const char* kAtomMimeType;
 extern const char* kCsvMimeType;
+extern const char* kGifMimeType;
+extern const char* kJpegMimeType;
 extern const char* kKmlMimeType;
 extern const char* kKmzMimeType;
+extern const char* kPngMimeType;
+
+// Returns the mime type above matching the extension of path, compared
+// without regard to case, or NULL if there is none.
+const char* GetMimeTypeFromPath(const string& path);
 
 }  // end namespace kmlbase
 
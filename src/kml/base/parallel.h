@@ -0,0 +1,161 @@
+// Copyright 2008, Google Inc. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//  3. Neither the name of Google Inc. nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// This file declares a minimal portable facility for running independent
+// units of work concurrently, for coordinating them and for keeping state
+// per thread.  The implementation is platform specific: see
+// parallel_posix.cc (pthreads) and parallel_win32.cc.
+
+#ifndef KML_BASE_PARALLEL_H__
+#define KML_BASE_PARALLEL_H__
+
+#include <stddef.h>
+
+namespace kmlbase {
+
+// Returns the number of processors currently online.  This is always at
+// least 1.
+unsigned int GetProcessorCount();
+
+// A ParallelTask is a set of numbered, independent units of work.  Run() is
+// called concurrently from several threads, each time with a different index.
+class ParallelTask {
+ public:
+  virtual ~ParallelTask() {}
+  virtual void Run(size_t index) = 0;
+};
+
+// Calls task->Run(i) exactly once for each i in [0, count) using up to
+// num_threads threads, one of which is the calling thread.  Indices are
+// handed out in increasing order as threads become free.  A num_threads of 0
+// means GetProcessorCount().  This returns when every Run() has returned.
+// If additional threads cannot be created the remaining work is done on the
+// calling thread.
+void RunParallel(ParallelTask* task, size_t count, unsigned int num_threads);
+
+// A Mutex provides mutual exclusion between threads.  It is not recursive.
+// Use a MutexLock to hold it for a scope.
+class Mutex {
+ public:
+  Mutex();
+  ~Mutex();
+  void Lock();
+  void Unlock();
+
+ private:
+  friend class ConditionVariable;
+  struct Impl;
+  Impl* impl_;
+  // Not copyable.
+  Mutex(const Mutex&);
+  void operator=(const Mutex&);
+};
+
+// A MutexLock holds the given Mutex for its lifetime.
+class MutexLock {
+ public:
+  explicit MutexLock(Mutex* mutex) : mutex_(mutex) {
+    mutex_->Lock();
+  }
+  ~MutexLock() {
+    mutex_->Unlock();
+  }
+
+ private:
+  Mutex* mutex_;
+  // Not copyable.
+  MutexLock(const MutexLock&);
+  void operator=(const MutexLock&);
+};
+
+// A ConditionVariable lets threads wait for a change to state guarded by a
+// Mutex.  As usual a Wait() may return spuriously so the state must be
+// tested again in a loop.
+//
+// Intended usage:
+//   MutexLock lock(&mutex);
+//   while (!ready) {
+//     condition_variable.Wait(&mutex);
+//   }
+class ConditionVariable {
+ public:
+  ConditionVariable();
+  ~ConditionVariable();
+
+  // Releases the given Mutex, which the caller must hold, until woken and
+  // then takes it again.
+  void Wait(Mutex* mutex);
+
+  // Wakes all waiting threads.
+  void NotifyAll();
+
+ private:
+  struct Impl;
+  Impl* impl_;
+  // Not copyable.
+  ConditionVariable(const ConditionVariable&);
+  void operator=(const ConditionVariable&);
+};
+
+// A ThreadLocal holds a separate pointer for each thread which is NULL until
+// that thread calls set().  When a thread exits having set a non-NULL
+// pointer the given destroy function is called with it on that thread.
+// A ThreadLocal is meant to be created once and never destroyed: what
+// becomes of the pointers of the threads still running when it is destroyed
+// depends on the platform.
+//
+// Intended usage:
+//   static void DeleteCache(void* cache) {
+//     delete static_cast<Cache*>(cache);
+//   }
+//   static ThreadLocal* const kThreadCache = new ThreadLocal(DeleteCache);
+//   Cache* cache = static_cast<Cache*>(kThreadCache->get());
+//   if (!cache) {
+//     cache = new Cache;
+//     kThreadCache->set(cache);
+//   }
+class ThreadLocal {
+ public:
+  explicit ThreadLocal(void (*destroy)(void*));
+  ~ThreadLocal();
+
+  // Returns the calling thread's pointer.
+  void* get() const;
+
+  // Sets the calling thread's pointer.  Any previous pointer of this thread
+  // is not destroyed.
+  void set(void* pointer);
+
+ private:
+  struct Key;
+  Key* key_;
+  // Not copyable.
+  ThreadLocal(const ThreadLocal&);
+  void operator=(const ThreadLocal&);
+};
+
+}  // end namespace kmlbase
+
+#endif  // KML_BASE_PARALLEL_H__
@@ -0,0 +1,162 @@
+// Copyright 2008, Google Inc. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//  3. Neither the name of Google Inc. nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// This file contains the implementation of the parallel.h functions for
+// POSIX platforms.
+
+#include "kml/base/parallel.h"
+#include <pthread.h>
+#include <unistd.h>
+#include <vector>
+
+namespace kmlbase {
+
+unsigned int GetProcessorCount() {
+  long count = sysconf(_SC_NPROCESSORS_ONLN);
+  return count > 0 ? static_cast<unsigned int>(count) : 1;
+}
+
+// Internal to RunParallel.  The state shared by all threads working on one
+// ParallelTask.
+struct ParallelRun {
+  ParallelTask* task;
+  size_t count;
+  size_t next;
+  pthread_mutex_t mutex;
+};
+
+// Internal to RunParallel.  Each thread claims the next index until all
+// are taken.
+static void* RunParallelThread(void* arg) {
+  ParallelRun* run = static_cast<ParallelRun*>(arg);
+  while (true) {
+    pthread_mutex_lock(&run->mutex);
+    size_t index = run->next++;
+    pthread_mutex_unlock(&run->mutex);
+    if (index >= run->count) {
+      break;
+    }
+    run->task->Run(index);
+  }
+  return NULL;
+}
+
+void RunParallel(ParallelTask* task, size_t count, unsigned int num_threads) {
+  if (!task || count == 0) {
+    return;
+  }
+  if (num_threads == 0) {
+    num_threads = GetProcessorCount();
+  }
+  if (num_threads > count) {
+    num_threads = static_cast<unsigned int>(count);
+  }
+  ParallelRun run;
+  run.task = task;
+  run.count = count;
+  run.next = 0;
+  pthread_mutex_init(&run.mutex, NULL);
+  std::vector<pthread_t> threads;
+  for (unsigned int i = 1; i < num_threads; ++i) {
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, RunParallelThread, &run) != 0) {
+      break;
+    }
+    threads.push_back(thread);
+  }
+  RunParallelThread(&run);
+  for (size_t i = 0; i < threads.size(); ++i) {
+    pthread_join(threads[i], NULL);
+  }
+  pthread_mutex_destroy(&run.mutex);
+}
+
+struct Mutex::Impl {
+  pthread_mutex_t mutex;
+};
+
+Mutex::Mutex()
+  : impl_(new Impl) {
+  pthread_mutex_init(&impl_->mutex, NULL);
+}
+
+Mutex::~Mutex() {
+  pthread_mutex_destroy(&impl_->mutex);
+  delete impl_;
+}
+
+void Mutex::Lock() {
+  pthread_mutex_lock(&impl_->mutex);
+}
+
+void Mutex::Unlock() {
+  pthread_mutex_unlock(&impl_->mutex);
+}
+
+struct ConditionVariable::Impl {
+  pthread_cond_t cond;
+};
+
+ConditionVariable::ConditionVariable()
+  : impl_(new Impl) {
+  pthread_cond_init(&impl_->cond, NULL);
+}
+
+ConditionVariable::~ConditionVariable() {
+  pthread_cond_destroy(&impl_->cond);
+  delete impl_;
+}
+
+void ConditionVariable::Wait(Mutex* mutex) {
+  pthread_cond_wait(&impl_->cond, &mutex->impl_->mutex);
+}
+
+void ConditionVariable::NotifyAll() {
+  pthread_cond_broadcast(&impl_->cond);
+}
+
+struct ThreadLocal::Key {
+  pthread_key_t key;
+};
+
+ThreadLocal::ThreadLocal(void (*destroy)(void*))
+  : key_(new Key) {
+  pthread_key_create(&key_->key, destroy);
+}
+
+ThreadLocal::~ThreadLocal() {
+  pthread_key_delete(key_->key);
+  delete key_;
+}
+
+void* ThreadLocal::get() const {
+  return pthread_getspecific(key_->key);
+}
+
+void ThreadLocal::set(void* pointer) {
+  pthread_setspecific(key_->key, pointer);
+}
+
+}  // end namespace kmlbase
@@ -0,0 +1,190 @@
+// Copyright 2008, Google Inc. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//  3. Neither the name of Google Inc. nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// This file contains the unit tests for the RunParallel() function and the
+// Mutex, ConditionVariable and ThreadLocal classes.
+
+#include "kml/base/parallel.h"
+#include <vector>
+#include "gtest/gtest.h"
+
+namespace kmlbase {
+
+// This ParallelTask records how many times each index was run.  Each index
+// owns its own slot so no locking is needed.
+class CountingTask : public ParallelTask {
+ public:
+  CountingTask(size_t count) : runs_(count, 0) {}
+  virtual void Run(size_t index) {
+    ++runs_[index];
+  }
+  int get_runs(size_t index) const {
+    return runs_[index];
+  }
+ private:
+  std::vector<int> runs_;
+};
+
+TEST(ParallelTest, TestGetProcessorCount) {
+  ASSERT_LE(1U, GetProcessorCount());
+}
+
+TEST(ParallelTest, TestRunParallel) {
+  const unsigned int kThreads[] = { 0, 1, 2, 4, 16 };
+  const size_t kCount = 1000;
+  for (size_t t = 0; t < sizeof(kThreads)/sizeof(kThreads[0]); ++t) {
+    CountingTask task(kCount);
+    RunParallel(&task, kCount, kThreads[t]);
+    for (size_t i = 0; i < kCount; ++i) {
+      ASSERT_EQ(1, task.get_runs(i));
+    }
+  }
+}
+
+TEST(ParallelTest, TestMoreThreadsThanWork) {
+  CountingTask task(3);
+  RunParallel(&task, 3, 64);
+  ASSERT_EQ(1, task.get_runs(0));
+  ASSERT_EQ(1, task.get_runs(1));
+  ASSERT_EQ(1, task.get_runs(2));
+}
+
+TEST(ParallelTest, TestNoWork) {
+  CountingTask task(0);
+  RunParallel(&task, 0, 4);
+  RunParallel(NULL, 10, 4);
+}
+
+// This ParallelTask has each index wait for its turn so that the indices
+// finish in order.
+class TurnTakingTask : public ParallelTask {
+ public:
+  TurnTakingTask() : turn_(0) {}
+  virtual void Run(size_t index) {
+    MutexLock lock(&mutex_);
+    while (turn_ != index) {
+      turn_changed_.Wait(&mutex_);
+    }
+    order_.push_back(index);
+    ++turn_;
+    turn_changed_.NotifyAll();
+  }
+  const std::vector<size_t>& get_order() const {
+    return order_;
+  }
+
+ private:
+  Mutex mutex_;
+  ConditionVariable turn_changed_;
+  size_t turn_;
+  std::vector<size_t> order_;
+};
+
+TEST(ParallelTest, TestMutexAndConditionVariable) {
+  const size_t kCount = 200;
+  TurnTakingTask task;
+  RunParallel(&task, kCount, 8);
+  ASSERT_EQ(kCount, task.get_order().size());
+  for (size_t i = 0; i < kCount; ++i) {
+    ASSERT_EQ(i, task.get_order()[i]);
+  }
+}
+
+// One of these is made by each thread which runs a ThreadLocalTask.  Only
+// the owning thread writes to it.
+struct ThreadSlot {
+  bool destroyed;
+};
+
+static void MarkDestroyed(void* pointer) {
+  static_cast<ThreadSlot*>(pointer)->destroyed = true;
+}
+
+// This ParallelTask records the ThreadLocal pointer seen by each index
+// making one the first time a thread runs.
+class ThreadLocalTask : public ParallelTask {
+ public:
+  ThreadLocalTask(ThreadLocal* thread_local_slot, size_t count)
+    : thread_local_slot_(thread_local_slot), slots_(count) {}
+  ~ThreadLocalTask() {
+    for (size_t i = 0; i < slots_.size(); ++i) {
+      if (slots_[i].created) {
+        delete slots_[i].slot;
+      }
+    }
+  }
+  virtual void Run(size_t index) {
+    ThreadSlot* slot = static_cast<ThreadSlot*>(thread_local_slot_->get());
+    slots_[index].created = !slot;
+    if (!slot) {
+      slot = new ThreadSlot;
+      slot->destroyed = false;
+      thread_local_slot_->set(slot);
+    }
+    slots_[index].slot = slot;
+  }
+  ThreadSlot* get_slot(size_t index) const {
+    return slots_[index].slot;
+  }
+  bool created(size_t index) const {
+    return slots_[index].created;
+  }
+
+ private:
+  ThreadLocal* thread_local_slot_;
+  struct Result {
+    ThreadSlot* slot;
+    bool created;
+  };
+  std::vector<Result> slots_;
+};
+
+TEST(ParallelTest, TestThreadLocal) {
+  ThreadLocal thread_local_slot(MarkDestroyed);
+  ASSERT_TRUE(thread_local_slot.get() == NULL);
+  const size_t kCount = 100;
+  ThreadLocalTask task(&thread_local_slot, kCount);
+  RunParallel(&task, kCount, 4);
+  // If the calling thread ran any of the work it still has its pointer.
+  ThreadSlot* own_slot = static_cast<ThreadSlot*>(thread_local_slot.get());
+  if (own_slot) {
+    ASSERT_FALSE(own_slot->destroyed);
+  }
+  size_t created = 0;
+  for (size_t i = 0; i < kCount; ++i) {
+    ASSERT_TRUE(task.get_slot(i) != NULL);
+    if (task.created(i)) {
+      ++created;
+      // Each other thread's pointer was destroyed as the thread exited.
+      ASSERT_EQ(task.get_slot(i) != own_slot, task.get_slot(i)->destroyed);
+    }
+  }
+  ASSERT_LE(1U, created);
+  ASSERT_GE(4U, created);
+  thread_local_slot.set(NULL);
+  ASSERT_TRUE(thread_local_slot.get() == NULL);
+}
+
+}  // end namespace kmlbase
@@ -0,0 +1,188 @@
+// Copyright 2008, Google Inc. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//  3. Neither the name of Google Inc. nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// This file contains the implementation of the parallel.h functions for
+// the win32 platform.
+
+#include "kml/base/parallel.h"
+#include <windows.h>
+#include <process.h>
+#include <vector>
+
+namespace kmlbase {
+
+unsigned int GetProcessorCount() {
+  SYSTEM_INFO system_info;
+  GetSystemInfo(&system_info);
+  return system_info.dwNumberOfProcessors > 0 ?
+      static_cast<unsigned int>(system_info.dwNumberOfProcessors) : 1;
+}
+
+// Internal to RunParallel.  The state shared by all threads working on one
+// ParallelTask.
+struct ParallelRun {
+  ParallelTask* task;
+  size_t count;
+  volatile LONG next;
+};
+
+// Internal to RunParallel.  Each thread claims the next index until all
+// are taken.
+static unsigned __stdcall RunParallelThread(void* arg) {
+  ParallelRun* run = static_cast<ParallelRun*>(arg);
+  while (true) {
+    size_t index = static_cast<size_t>(InterlockedIncrement(&run->next) - 1);
+    if (index >= run->count) {
+      break;
+    }
+    run->task->Run(index);
+  }
+  return 0;
+}
+
+void RunParallel(ParallelTask* task, size_t count, unsigned int num_threads) {
+  if (!task || count == 0) {
+    return;
+  }
+  if (num_threads == 0) {
+    num_threads = GetProcessorCount();
+  }
+  if (num_threads > count) {
+    num_threads = static_cast<unsigned int>(count);
+  }
+  ParallelRun run;
+  run.task = task;
+  run.count = count;
+  run.next = 0;
+  std::vector<HANDLE> threads;
+  for (unsigned int i = 1; i < num_threads; ++i) {
+    uintptr_t thread = _beginthreadex(NULL, 0, RunParallelThread, &run, 0,
+                                      NULL);
+    if (thread == 0) {
+      break;
+    }
+    threads.push_back(reinterpret_cast<HANDLE>(thread));
+  }
+  RunParallelThread(&run);
+  for (size_t i = 0; i < threads.size(); ++i) {
+    WaitForSingleObject(threads[i], INFINITE);
+    CloseHandle(threads[i]);
+  }
+}
+
+struct Mutex::Impl {
+  CRITICAL_SECTION critical_section;
+};
+
+Mutex::Mutex()
+  : impl_(new Impl) {
+  InitializeCriticalSection(&impl_->critical_section);
+}
+
+Mutex::~Mutex() {
+  DeleteCriticalSection(&impl_->critical_section);
+  delete impl_;
+}
+
+void Mutex::Lock() {
+  EnterCriticalSection(&impl_->critical_section);
+}
+
+void Mutex::Unlock() {
+  LeaveCriticalSection(&impl_->critical_section);
+}
+
+struct ConditionVariable::Impl {
+  CONDITION_VARIABLE condition_variable;
+};
+
+ConditionVariable::ConditionVariable()
+  : impl_(new Impl) {
+  InitializeConditionVariable(&impl_->condition_variable);
+}
+
+ConditionVariable::~ConditionVariable() {
+  delete impl_;
+}
+
+void ConditionVariable::Wait(Mutex* mutex) {
+  SleepConditionVariableCS(&impl_->condition_variable,
+                           &mutex->impl_->critical_section, INFINITE);
+}
+
+void ConditionVariable::NotifyAll() {
+  WakeAllConditionVariable(&impl_->condition_variable);
+}
+
+struct ThreadLocal::Key {
+  DWORD index;
+  void (*destroy)(void*);
+};
+
+// Internal to ThreadLocal.  The fiber local storage callback is given only
+// the stored value so each thread stores its pointer along with the destroy
+// function.
+struct ThreadLocalSlot {
+  void (*destroy)(void*);
+  void* pointer;
+};
+
+static VOID WINAPI DestroyThreadLocalSlot(PVOID data) {
+  ThreadLocalSlot* slot = static_cast<ThreadLocalSlot*>(data);
+  if (slot->pointer) {
+    slot->destroy(slot->pointer);
+  }
+  delete slot;
+}
+
+ThreadLocal::ThreadLocal(void (*destroy)(void*))
+  : key_(new Key) {
+  key_->index = FlsAlloc(DestroyThreadLocalSlot);
+  key_->destroy = destroy;
+}
+
+ThreadLocal::~ThreadLocal() {
+  FlsFree(key_->index);
+  delete key_;
+}
+
+void* ThreadLocal::get() const {
+  ThreadLocalSlot* slot =
+      static_cast<ThreadLocalSlot*>(FlsGetValue(key_->index));
+  return slot ? slot->pointer : NULL;
+}
+
+void ThreadLocal::set(void* pointer) {
+  ThreadLocalSlot* slot =
+      static_cast<ThreadLocalSlot*>(FlsGetValue(key_->index));
+  if (!slot) {
+    slot = new ThreadLocalSlot;
+    slot->destroy = key_->destroy;
+    FlsSetValue(key_->index, slot);
+  }
+  slot->pointer = pointer;
+}
+
+}  // end namespace kmlbase
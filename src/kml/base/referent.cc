@@ -27,9 +27,25 @@
 // boost::intrusive_ptr.  See boost/intrusive_ptr.hpp for more information.
 
 #include "kml/base/referent.h"
+#ifdef WIN32
+#include <windows.h>
+#endif
 
 namespace kmlbase {
 
+bool Referent::thread_safe_ref_count_ = false;
+
+// static
+int Referent::AtomicAdd(int* value, int delta) {
+#ifdef WIN32
+  // A LONG is the same size as an int on all Windows platforms.
+  return InterlockedExchangeAdd(reinterpret_cast<volatile LONG*>(value),
+                                delta) + delta;
+#else
+  return __sync_add_and_fetch(value, delta);
+#endif
+}
+
 // This function is used from within boost::intrusive_ptr to increment the
 // reference count when a new intrusive_ptr to a Referent-derived object is
 // created.  This function is to be used only from within boost::intrusive_ptr.
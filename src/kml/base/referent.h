@@ -35,6 +35,15 @@
 namespace kmlbase {
 
 // This class implements the reference count used by boost::intrusive_ptr.
+//
+// By default the reference count is a plain int and a Referent-derived
+// object may be used from one thread at a time only.  After
+// set_thread_safe_ref_count(true) every reference count is changed
+// atomically such that boost::intrusive_ptrs to the same objects may be
+// copied and released from several threads at once, as when several threads
+// read one parsed KML DOM.  The setting is global and is to be made before
+// any other threads are started.  It costs an atomic instruction for each
+// add_ref() and release().
 class Referent {
  public:
   // The constructor only constructs the Referent object.  The reference
@@ -46,13 +55,17 @@ class Referent {
   // This method is used by intrusive_ptr_add_ref() to increment the reference
   // count of a given Referent-derived object.
   void add_ref() {
-    ++ref_count_;
+    if (thread_safe_ref_count_) {
+      AtomicAdd(&ref_count_, 1);
+    } else {
+      ++ref_count_;
+    }
   }
 
   // This method is used by intrusive_ptr_release() to decrement the reference
   // count of a given Referent-derived object.
   int release() {
-    return --ref_count_;
+    return thread_safe_ref_count_ ? AtomicAdd(&ref_count_, -1) : --ref_count_;
   }
 
   // This is for debugging purposes only.
@@ -60,7 +73,18 @@ class Referent {
     return ref_count_;
   }
 
+  // See the comment for the class above.  This is false by default.
+  static void set_thread_safe_ref_count(bool thread_safe_ref_count) {
+    thread_safe_ref_count_ = thread_safe_ref_count;
+  }
+  static bool get_thread_safe_ref_count() {
+    return thread_safe_ref_count_;
+  }
+
  private:
+  // Atomically adds delta to the value and returns the result.
+  static int AtomicAdd(int* value, int delta);
+  static bool thread_safe_ref_count_;
   int ref_count_;
 };
 
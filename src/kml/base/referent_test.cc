@@ -29,6 +29,7 @@
 #include "kml/base/referent.h"
 #include <vector>
 #include "boost/intrusive_ptr.hpp"
+#include "kml/base/parallel.h"
 #include "gtest/gtest.h"
 
 namespace kmlbase {
@@ -223,4 +224,31 @@ TEST_F(ReferentTest, TestGetChild) {
   // The object is released when child goes out of scope.
 }
 
+// This ParallelTask takes and drops many references to one object.
+class CopyPointerTask : public ParallelTask {
+ public:
+  CopyPointerTask(const boost::intrusive_ptr<Referent>& referent)
+    : referent_(referent) {}
+  virtual void Run(size_t index) {
+    std::vector<boost::intrusive_ptr<Referent> > copies(1000, referent_);
+  }
+ private:
+  const boost::intrusive_ptr<Referent> referent_;
+};
+
+// This verifies that the reference count is exact when pointers to one
+// object are copied and released from several threads at once.
+TEST_F(ReferentTest, TestThreadSafeRefCount) {
+  ASSERT_FALSE(Referent::get_thread_safe_ref_count());
+  Referent::set_thread_safe_ref_count(true);
+  {
+    boost::intrusive_ptr<Referent> referent(derived_);
+    CopyPointerTask task(referent);
+    RunParallel(&task, 100, 8);
+    ASSERT_EQ(3, derived_->get_ref_count());
+  }
+  Referent::set_thread_safe_ref_count(false);
+  ASSERT_EQ(1, derived_->get_ref_count());
+}
+
 }  // end namespace kmlbase
@@ -0,0 +1,323 @@
+// Copyright 2008, Google Inc. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//  3. Neither the name of Google Inc. nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// This file contains the declaration and implementation of the StringHashMap
+// class template, a hash table keyed by string with the commonly used subset
+// of the std::map interface.  Iteration order is unspecified.
+
+#ifndef KML_BASE_STRING_HASH_MAP_H__
+#define KML_BASE_STRING_HASH_MAP_H__
+
+#include <stddef.h>
+#include <utility>
+#include <vector>
+#include "kml/base/util.h"
+
+namespace kmlbase {
+
+// This returns the 32-bit FNV-1a hash of the given bytes.
+inline size_t HashString(const char* data, size_t size) {
+  uint32_t hash = 2166136261U;
+  for (size_t i = 0; i < size; ++i) {
+    hash ^= static_cast<unsigned char>(data[i]);
+    hash *= 16777619U;
+  }
+  return hash;
+}
+
+inline size_t HashString(const string& s) {
+  return HashString(s.data(), s.size());
+}
+
+// A StringHashMap chains entries in power-of-two sized buckets.  Each entry
+// holds its key once along with the key's hash which is compared before the
+// key itself and is reused when the table grows.  Each lookup or insert,
+// including operator[], hashes the key once and walks a single chain.
+// Iteration is in no particular order.  References to entries remain valid
+// until the entry is erased or the map is cleared, but any insert, including
+// operator[] of a new key, may grow the table and so invalidate iterators.
+template <typename T>
+class StringHashMap {
+ private:
+  struct Node {
+    Node(const string& key, const T& value, size_t hash_, Node* next_)
+      : entry(key, value), hash(hash_), next(next_) {}
+    std::pair<const string, T> entry;
+    size_t hash;
+    Node* next;
+  };
+  typedef std::vector<Node*> BucketVector;
+
+ public:
+  typedef string key_type;
+  typedef T mapped_type;
+  typedef std::pair<const string, T> value_type;
+
+  template <typename V>
+  class Iterator {
+   public:
+    Iterator() : node_(NULL), bucket_(NULL), end_(NULL) {}
+    Iterator(Node* node, Node* const* bucket, Node* const* end)
+      : node_(node), bucket_(bucket), end_(end) {}
+    // This permits conversion from iterator to const_iterator.
+    template <typename U>
+    Iterator(const Iterator<U>& other)
+      : node_(other.node_), bucket_(other.bucket_), end_(other.end_) {}
+
+    V& operator*() const {
+      return node_->entry;
+    }
+    V* operator->() const {
+      return &node_->entry;
+    }
+    Iterator& operator++() {
+      node_ = node_->next;
+      while (!node_ && ++bucket_ != end_) {
+        node_ = *bucket_;
+      }
+      return *this;
+    }
+    Iterator operator++(int) {
+      Iterator old(*this);
+      ++*this;
+      return old;
+    }
+    bool operator==(const Iterator& other) const {
+      return node_ == other.node_;
+    }
+    bool operator!=(const Iterator& other) const {
+      return node_ != other.node_;
+    }
+
+   private:
+    template <typename U> friend class Iterator;
+    Node* node_;
+    Node* const* bucket_;
+    Node* const* end_;
+  };
+  typedef Iterator<value_type> iterator;
+  typedef Iterator<const value_type> const_iterator;
+
+  StringHashMap() : size_(0) {}
+
+  StringHashMap(const StringHashMap& other) : size_(0) {
+    CopyFrom(other);
+  }
+
+  ~StringHashMap() {
+    clear();
+  }
+
+  StringHashMap& operator=(const StringHashMap& other) {
+    if (this != &other) {
+      clear();
+      CopyFrom(other);
+    }
+    return *this;
+  }
+
+  size_t size() const {
+    return size_;
+  }
+
+  bool empty() const {
+    return size_ == 0;
+  }
+
+  size_t bucket_count() const {
+    return buckets_.size();
+  }
+
+  // This sizes the table for at least count entries without growing.
+  void reserve(size_t count) {
+    size_t bucket_count = static_cast<size_t>(kMinBuckets);
+    while (bucket_count < count) {
+      bucket_count *= 2;
+    }
+    if (bucket_count > buckets_.size()) {
+      Rehash(bucket_count);
+    }
+  }
+
+  void clear() {
+    for (size_t i = 0; i < buckets_.size(); ++i) {
+      Node* node = buckets_[i];
+      while (node) {
+        Node* next = node->next;
+        delete node;
+        node = next;
+      }
+    }
+    BucketVector().swap(buckets_);
+    size_ = 0;
+  }
+
+  void swap(StringHashMap& other) {
+    buckets_.swap(other.buckets_);
+    std::swap(size_, other.size_);
+  }
+
+  iterator begin() {
+    return BeginIterator<iterator>();
+  }
+  const_iterator begin() const {
+    return BeginIterator<const_iterator>();
+  }
+  iterator end() {
+    return iterator();
+  }
+  const_iterator end() const {
+    return const_iterator();
+  }
+
+  iterator find(const string& key) {
+    return MakeIterator<iterator>(FindNode(key, HashString(key)));
+  }
+  const_iterator find(const string& key) const {
+    return MakeIterator<const_iterator>(FindNode(key, HashString(key)));
+  }
+
+  size_t count(const string& key) const {
+    return FindNode(key, HashString(key)) ? 1 : 0;
+  }
+
+  // This inserts a copy of the given entry if its key is not already in the
+  // map.  The returned bool is true if the entry was inserted and the
+  // iterator refers to the entry with the given key in either case.
+  std::pair<iterator, bool> insert(const value_type& entry) {
+    bool inserted;
+    Node* node = FindOrInsert(entry.first, entry.second, &inserted);
+    return std::make_pair(MakeIterator<iterator>(node), inserted);
+  }
+
+  // This returns the value for the given key, first inserting a default
+  // value if the key is not in the map.
+  T& operator[](const string& key) {
+    bool inserted;
+    return FindOrInsert(key, T(), &inserted)->entry.second;
+  }
+
+  // This removes the entry with the given key and returns the number of
+  // entries removed.
+  size_t erase(const string& key) {
+    if (buckets_.empty()) {
+      return 0;
+    }
+    const size_t hash = HashString(key);
+    Node** link = &buckets_[hash & (buckets_.size() - 1)];
+    for (; *link; link = &(*link)->next) {
+      if ((*link)->hash == hash && (*link)->entry.first == key) {
+        Node* node = *link;
+        *link = node->next;
+        delete node;
+        --size_;
+        return 1;
+      }
+    }
+    return 0;
+  }
+
+ private:
+  enum { kMinBuckets = 16 };
+
+  // Returns an iterator to the given node, or the end iterator if NULL.
+  template <typename I>
+  I MakeIterator(const Node* node) const {
+    if (!node) {
+      return I();
+    }
+    Node* const* bucket = &buckets_[0] + (node->hash & (buckets_.size() - 1));
+    return I(const_cast<Node*>(node), bucket, &buckets_[0] + buckets_.size());
+  }
+
+  // Returns an iterator to the first node.
+  template <typename I>
+  I BeginIterator() const {
+    for (size_t i = 0; i < buckets_.size(); ++i) {
+      if (buckets_[i]) {
+        return MakeIterator<I>(buckets_[i]);
+      }
+    }
+    return I();
+  }
+
+  Node* FindNode(const string& key, size_t hash) const {
+    if (buckets_.empty()) {
+      return NULL;
+    }
+    Node* node = buckets_[hash & (buckets_.size() - 1)];
+    while (node && (node->hash != hash || node->entry.first != key)) {
+      node = node->next;
+    }
+    return node;
+  }
+
+  Node* FindOrInsert(const string& key, const T& value, bool* inserted) {
+    const size_t hash = HashString(key);
+    if (Node* node = FindNode(key, hash)) {
+      *inserted = false;
+      return node;
+    }
+    if (size_ >= buckets_.size()) {
+      Rehash(buckets_.empty() ? static_cast<size_t>(kMinBuckets)
+                              : buckets_.size() * 2);
+    }
+    Node*& head = buckets_[hash & (buckets_.size() - 1)];
+    head = new Node(key, value, hash, head);
+    ++size_;
+    *inserted = true;
+    return head;
+  }
+
+  void Rehash(size_t bucket_count) {
+    BucketVector buckets(bucket_count, static_cast<Node*>(NULL));
+    for (size_t i = 0; i < buckets_.size(); ++i) {
+      Node* node = buckets_[i];
+      while (node) {
+        Node* next = node->next;
+        Node*& head = buckets[node->hash & (bucket_count - 1)];
+        node->next = head;
+        head = node;
+        node = next;
+      }
+    }
+    buckets_.swap(buckets);
+  }
+
+  void CopyFrom(const StringHashMap& other) {
+    reserve(other.size());
+    for (const_iterator iter = other.begin(); iter != other.end(); ++iter) {
+      bool inserted;
+      FindOrInsert(iter->first, iter->second, &inserted);
+    }
+  }
+
+  BucketVector buckets_;
+  size_t size_;
+};
+
+}  // end namespace kmlbase
+
+#endif  // KML_BASE_STRING_HASH_MAP_H__
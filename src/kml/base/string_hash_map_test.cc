@@ -0,0 +1,158 @@
+// Copyright 2008, Google Inc. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//  3. Neither the name of Google Inc. nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// This file contains the unit tests for the StringHashMap class template.
+
+#include "kml/base/string_hash_map.h"
+#include <map>
+#include <sstream>
+#include "gtest/gtest.h"
+
+namespace kmlbase {
+
+typedef StringHashMap<int> IntMap;
+
+static string MakeKey(int i) {
+  std::stringstream key;
+  key << "id-" << i;
+  return key.str();
+}
+
+TEST(StringHashMapTest, TestHashString) {
+  // Known FNV-1a values.
+  ASSERT_EQ(static_cast<size_t>(2166136261U), HashString(""));
+  ASSERT_EQ(static_cast<size_t>(0xe40c292cU), HashString("a"));
+  ASSERT_EQ(HashString(string("foobar")), HashString("foobar", 6));
+}
+
+TEST(StringHashMapTest, TestEmpty) {
+  IntMap map;
+  ASSERT_TRUE(map.empty());
+  ASSERT_EQ(static_cast<size_t>(0), map.size());
+  ASSERT_TRUE(map.begin() == map.end());
+  ASSERT_TRUE(map.find("x") == map.end());
+  ASSERT_EQ(static_cast<size_t>(0), map.count("x"));
+  ASSERT_EQ(static_cast<size_t>(0), map.erase("x"));
+  const IntMap& const_map = map;
+  ASSERT_TRUE(const_map.begin() == const_map.end());
+  ASSERT_TRUE(const_map.find("x") == const_map.end());
+}
+
+TEST(StringHashMapTest, TestInsertFindErase) {
+  const int kCount = 10000;
+  IntMap map;
+  for (int i = 0; i < kCount; ++i) {
+    map[MakeKey(i)] = i;
+  }
+  ASSERT_EQ(static_cast<size_t>(kCount), map.size());
+  for (int i = 0; i < kCount; ++i) {
+    IntMap::const_iterator iter = map.find(MakeKey(i));
+    ASSERT_TRUE(iter != map.end());
+    ASSERT_EQ(MakeKey(i), iter->first);
+    ASSERT_EQ(i, iter->second);
+  }
+  ASSERT_TRUE(map.find("id-") == map.end());
+
+  // Iteration visits each entry exactly once.
+  std::map<string, int> visited;
+  for (IntMap::iterator iter = map.begin(); iter != map.end(); ++iter) {
+    ASSERT_TRUE(visited.insert(*iter).second);
+  }
+  ASSERT_EQ(static_cast<size_t>(kCount), visited.size());
+
+  for (int i = 0; i < kCount; i += 2) {
+    ASSERT_EQ(static_cast<size_t>(1), map.erase(MakeKey(i)));
+    ASSERT_EQ(static_cast<size_t>(0), map.erase(MakeKey(i)));
+  }
+  ASSERT_EQ(static_cast<size_t>(kCount / 2), map.size());
+  for (int i = 0; i < kCount; ++i) {
+    ASSERT_EQ(static_cast<size_t>(i % 2), map.count(MakeKey(i)));
+  }
+  size_t iterated = 0;
+  for (IntMap::const_iterator iter = map.begin(); iter != map.end(); iter++) {
+    ASSERT_EQ(1, iter->second % 2);
+    ++iterated;
+  }
+  ASSERT_EQ(map.size(), iterated);
+
+  map.clear();
+  ASSERT_TRUE(map.empty());
+  ASSERT_TRUE(map.begin() == map.end());
+}
+
+TEST(StringHashMapTest, TestInsert) {
+  IntMap map;
+  std::pair<IntMap::iterator, bool> result =
+      map.insert(IntMap::value_type("a", 1));
+  ASSERT_TRUE(result.second);
+  ASSERT_EQ(string("a"), result.first->first);
+  ASSERT_EQ(1, result.first->second);
+  // An existing entry is not replaced but is returned.
+  result = map.insert(IntMap::value_type("a", 2));
+  ASSERT_FALSE(result.second);
+  ASSERT_EQ(1, result.first->second);
+  result.first->second = 3;
+  ASSERT_EQ(3, map["a"]);
+  ASSERT_EQ(static_cast<size_t>(1), map.size());
+  // operator[] default-constructs a missing value.
+  ASSERT_EQ(0, map["b"]);
+  ASSERT_EQ(static_cast<size_t>(2), map.size());
+}
+
+TEST(StringHashMapTest, TestReserve) {
+  IntMap map;
+  map.reserve(1000);
+  const size_t bucket_count = map.bucket_count();
+  ASSERT_LE(static_cast<size_t>(1000), bucket_count);
+  for (int i = 0; i < 1000; ++i) {
+    map[MakeKey(i)] = i;
+  }
+  ASSERT_EQ(bucket_count, map.bucket_count());
+  // Reserving less never shrinks.
+  map.reserve(10);
+  ASSERT_EQ(bucket_count, map.bucket_count());
+}
+
+TEST(StringHashMapTest, TestCopyAndSwap) {
+  IntMap map;
+  for (int i = 0; i < 100; ++i) {
+    map[MakeKey(i)] = i;
+  }
+  IntMap copy(map);
+  map["id-0"] = -1;
+  ASSERT_EQ(static_cast<size_t>(100), copy.size());
+  ASSERT_EQ(0, copy["id-0"]);
+  IntMap assigned;
+  assigned["x"] = 1;
+  assigned = copy;
+  ASSERT_EQ(static_cast<size_t>(100), assigned.size());
+  ASSERT_EQ(static_cast<size_t>(0), assigned.count("x"));
+  IntMap other;
+  other.swap(assigned);
+  ASSERT_TRUE(assigned.empty());
+  ASSERT_EQ(99, other["id-99"]);
+}
+
+}  // end namespace kmlbase
@@ -0,0 +1,68 @@
+// Copyright 2008, Google Inc. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//  3. Neither the name of Google Inc. nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// This file contains the implementation of the InternedString and StringPool
+// classes.
+
+#include "kml/base/string_pool.h"
+
+namespace kmlbase {
+
+InternedString::InternedString(const string& value) {
+  if (!value.empty()) {
+    rep_ = new Rep(value);
+  }
+}
+
+// A StringPool holds a reference to each of its values so a value still in
+// a pool is never changed in place.
+string& InternedString::GetMutable() {
+  if (!rep_ || rep_->get_ref_count() > 1) {
+    rep_ = new Rep(get());
+  }
+  return rep_->get_mutable();
+}
+
+// static
+const string& InternedString::EmptyString() {
+  static const string empty_string;
+  return empty_string;
+}
+
+InternedString StringPool::Intern(const string& value) {
+  if (value.empty()) {
+    return InternedString();
+  }
+  size_t size = pool_.size();
+  InternedString& interned = pool_[value];
+  if (pool_.size() == size) {
+    ++hit_count_;
+  } else {
+    interned = InternedString(value);
+  }
+  return interned;
+}
+
+}  // end namespace kmlbase
@@ -0,0 +1,136 @@
+// Copyright 2008, Google Inc. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//  3. Neither the name of Google Inc. nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// This file contains the declaration of the InternedString and StringPool
+// classes.  An InternedString is an immutable, reference counted string
+// value which is cheap to copy.  A StringPool hands out one InternedString
+// per distinct value such that all holders of a repeated value share one
+// copy of its characters.
+
+#ifndef KML_BASE_STRING_POOL_H__
+#define KML_BASE_STRING_POOL_H__
+
+#include <stddef.h>
+#include "boost/intrusive_ptr.hpp"
+#include "kml/base/referent.h"
+#include "kml/base/string_hash_map.h"
+#include "kml/base/util.h"
+
+namespace kmlbase {
+
+// An InternedString holds a pointer to a shared immutable string.  A default
+// constructed InternedString, or one made from an empty string, holds no
+// storage at all.  Copying an InternedString only copies the pointer.
+// InternedStrings do not depend on the StringPool which created them: a
+// pool may be destroyed while its strings are still in use.
+class InternedString {
+ public:
+  InternedString() {}
+  // This creates an InternedString which shares storage with no other.
+  explicit InternedString(const string& value);
+
+  const string& get() const {
+    return rep_ ? rep_->get() : EmptyString();
+  }
+  bool empty() const {
+    return !rep_ || rep_->get().empty();
+  }
+  void clear() {
+    rep_ = NULL;
+  }
+  // This returns the value for change in place.  If the storage is shared
+  // with another InternedString or a StringPool (or there is none) the
+  // InternedString is first given storage of its own holding a copy of its
+  // value such that no other holder ever sees the change.  Storage already
+  // its own is changed in place so repeated calls return the same reference.
+  // The reference is good until this InternedString is next assigned,
+  // cleared or destroyed.  Do not copy the InternedString while still
+  // changing the value through the reference.
+  string& GetMutable();
+  // Two InternedStrings share storage if and only if they were created by
+  // the same StringPool from equal values, or if one is a copy of the other.
+  bool shares_storage_with(const InternedString& other) const {
+    return rep_ == other.rep_;
+  }
+
+ private:
+  friend class StringPool;
+  class Rep : public Referent {
+   public:
+    explicit Rep(const string& value) : value_(value) {}
+    const string& get() const {
+      return value_;
+    }
+    string& get_mutable() {
+      return value_;
+    }
+   private:
+    string value_;
+  };
+  static const string& EmptyString();
+  boost::intrusive_ptr<Rep> rep_;
+};
+
+// A StringPool interns strings.  Intern() returns the same InternedString
+// for each call with an equal value.  A StringPool is not thread safe.
+//
+// Intended usage:
+//   StringPool pool;
+//   InternedString a = pool.Intern("#style");
+//   InternedString b = pool.Intern("#style");
+//   a.shares_storage_with(b);  // true
+class StringPool {
+ public:
+  StringPool() : hit_count_(0) {}
+
+  InternedString Intern(const string& value);
+
+  // This returns the number of distinct values in the pool.
+  size_t size() const {
+    return pool_.size();
+  }
+
+  // This returns the number of calls to Intern() which found the value
+  // already in the pool.
+  size_t get_hit_count() const {
+    return hit_count_;
+  }
+
+  // This forgets all values.  InternedStrings already handed out are
+  // unaffected.
+  void clear() {
+    pool_.clear();
+    hit_count_ = 0;
+  }
+
+ private:
+  StringHashMap<InternedString> pool_;
+  size_t hit_count_;
+  LIBKML_DISALLOW_EVIL_CONSTRUCTORS(StringPool);
+};
+
+}  // end namespace kmlbase
+
+#endif  // KML_BASE_STRING_POOL_H__
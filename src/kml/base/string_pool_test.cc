@@ -0,0 +1,131 @@
+// Copyright 2008, Google Inc. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//  3. Neither the name of Google Inc. nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// This file contains the unit tests for the InternedString and StringPool
+// classes.
+
+#include "kml/base/string_pool.h"
+#include "boost/scoped_ptr.hpp"
+#include "gtest/gtest.h"
+
+namespace kmlbase {
+
+TEST(InternedStringTest, TestDefault) {
+  InternedString interned;
+  ASSERT_TRUE(interned.empty());
+  ASSERT_EQ(string(), interned.get());
+  ASSERT_TRUE(interned.shares_storage_with(InternedString("")));
+}
+
+TEST(InternedStringTest, TestUnpooled) {
+  InternedString a("#style");
+  InternedString b("#style");
+  ASSERT_FALSE(a.empty());
+  ASSERT_EQ(string("#style"), a.get());
+  ASSERT_EQ(a.get(), b.get());
+  ASSERT_FALSE(a.shares_storage_with(b));
+  InternedString c(a);
+  ASSERT_TRUE(c.shares_storage_with(a));
+  ASSERT_EQ(a.get().data(), c.get().data());
+  c.clear();
+  ASSERT_TRUE(c.empty());
+  ASSERT_EQ(string("#style"), a.get());
+}
+
+TEST(InternedStringTest, TestGetMutable) {
+  InternedString a("#style");
+  InternedString b(a);
+  b.GetMutable().append("2");
+  ASSERT_EQ(string("#style"), a.get());
+  ASSERT_EQ(string("#style2"), b.get());
+  ASSERT_FALSE(b.shares_storage_with(a));
+  b.GetMutable().clear();
+  ASSERT_TRUE(b.empty());
+  InternedString c;
+  c.GetMutable() = "#c";
+  ASSERT_FALSE(c.empty());
+  ASSERT_EQ(string("#c"), c.get());
+
+  // Storage of its own is changed in place.
+  string& first = c.GetMutable();
+  string& second = c.GetMutable();
+  ASSERT_EQ(&first, &second);
+  first.append("d");
+  ASSERT_EQ(string("#cd"), c.get());
+}
+
+TEST(StringPoolTest, TestIntern) {
+  StringPool pool;
+  ASSERT_EQ(static_cast<size_t>(0), pool.size());
+  InternedString a = pool.Intern("population");
+  InternedString b = pool.Intern("population");
+  InternedString c = pool.Intern("area");
+  ASSERT_EQ(string("population"), a.get());
+  ASSERT_EQ(string("area"), c.get());
+  ASSERT_TRUE(a.shares_storage_with(b));
+  ASSERT_EQ(a.get().data(), b.get().data());
+  ASSERT_FALSE(a.shares_storage_with(c));
+  ASSERT_EQ(static_cast<size_t>(2), pool.size());
+  ASSERT_EQ(static_cast<size_t>(1), pool.get_hit_count());
+}
+
+TEST(StringPoolTest, TestInternEmpty) {
+  StringPool pool;
+  ASSERT_TRUE(pool.Intern("").empty());
+  ASSERT_EQ(static_cast<size_t>(0), pool.size());
+  ASSERT_EQ(static_cast<size_t>(0), pool.get_hit_count());
+}
+
+TEST(StringPoolTest, TestClear) {
+  StringPool pool;
+  InternedString a = pool.Intern("#style");
+  pool.clear();
+  ASSERT_EQ(static_cast<size_t>(0), pool.size());
+  ASSERT_EQ(string("#style"), a.get());
+  ASSERT_FALSE(a.shares_storage_with(pool.Intern("#style")));
+}
+
+TEST(StringPoolTest, TestOutlivesPool) {
+  boost::scoped_ptr<StringPool> pool(new StringPool);
+  InternedString a = pool->Intern("#style");
+  InternedString b = pool->Intern("#style");
+  pool.reset();
+  ASSERT_EQ(string("#style"), a.get());
+  ASSERT_TRUE(a.shares_storage_with(b));
+}
+
+TEST(StringPoolTest, TestGetMutable) {
+  // A change in place of a pooled value is seen by neither the pool nor any
+  // other holder of the value.
+  StringPool pool;
+  InternedString a = pool.Intern("#style");
+  InternedString b = pool.Intern("#style");
+  a.GetMutable() = "#changed";
+  ASSERT_EQ(string("#changed"), a.get());
+  ASSERT_EQ(string("#style"), b.get());
+  ASSERT_TRUE(b.shares_storage_with(pool.Intern("#style")));
+}
+
+}  // end namespace kmlbase
@@ -44,29 +44,41 @@ typedef std::vector< std::pair<string, string> > StringPairVector;
 void b2a_hex(uint32_t i, char* out);
 
 // This permits a class containing a StringMap to export a way to iterate the
-// internal container without exposing it directly.  In the future the STL
-// map presently used internally may be replaced with a hash map, for example.
+// internal container without exposing it directly.  A class may instead
+// hold its name-value pairs in a contiguous array, in which case it
+// iterates the range [begin, end) of that array.
 class StringMapIterator {
  public:
   StringMapIterator(const StringMap& map)
-    : map_(map), iter_(map.begin()) {
+    : map_(&map), iter_(map.begin()), pair_(NULL), pair_end_(NULL) {
+  }
+
+  StringMapIterator(const StringPairVector::value_type* begin,
+                    const StringPairVector::value_type* end)
+    : map_(NULL), pair_(begin), pair_end_(end) {
   }
 
   StringPair Data() const {
-    return *iter_;
+    return map_ ? *iter_ : StringPair(pair_->first, pair_->second);
   }
 
   bool AtEnd() const {
-    return iter_ == map_.end();
+    return map_ ? iter_ == map_->end() : pair_ == pair_end_;
   }
 
   void Advance() {
-    ++iter_;
+    if (map_) {
+      ++iter_;
+    } else {
+      ++pair_;
+    }
   }
 
  private:
-  const StringMap& map_;
+  const StringMap* map_;
   StringMap::const_iterator iter_;
+  const StringPairVector::value_type* pair_;
+  const StringPairVector::value_type* pair_end_;
 };
 
 // Walks through the input string, replacing all keys in StringMap
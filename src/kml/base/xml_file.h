@@ -28,8 +28,8 @@
 #ifndef KML_BASE_XML_FILE_H__
 #define KML_BASE_XML_FILE_H__
 
-#include <map>
 #include "boost/intrusive_ptr.hpp"
+#include "kml/base/string_hash_map.h"
 #include "kml/base/xml_element.h"
 #include "kml/base/referent.h"
 #include "kml/base/util.h"
@@ -37,7 +37,7 @@
 namespace kmlbase {
 
 // TODO: use a typedef (or type) for XmlId
-typedef std::map<string, XmlElementPtr> XmlElementIdMap;
+typedef StringHashMap<XmlElementPtr> XmlElementIdMap;
 
 // This class represents an XML file (in XML standards this is known as a
 // "document", however we avoid that term due to the use of "<Document>" as
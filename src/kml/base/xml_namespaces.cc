@@ -71,4 +71,30 @@ bool FindXmlNamespaceAndPrefix(XmlnsId xmlns_id,
   return false;
 }
 
+bool FindXmlnsIdByPrefix(const string& prefix, XmlnsId* xmlns_id) {
+  const size_t num_namespaces = sizeof(XmlNamespaces)/sizeof(XmlNamespaces[0]);
+  for (size_t i = 1; i < num_namespaces; ++i) {  // Skip XMLNS_NONE.
+    if (prefix == XmlNamespaces[i].prefix_) {
+      if (xmlns_id) {
+        *xmlns_id = XmlNamespaces[i].xmlns_id_;
+      }
+      return true;
+    }
+  }
+  return false;
+}
+
+bool FindXmlnsIdByNamespace(const string& xml_namespace, XmlnsId* xmlns_id) {
+  const size_t num_namespaces = sizeof(XmlNamespaces)/sizeof(XmlNamespaces[0]);
+  for (size_t i = 1; i < num_namespaces; ++i) {  // Skip XMLNS_NONE.
+    if (xml_namespace == XmlNamespaces[i].xml_namespace_) {
+      if (xmlns_id) {
+        *xmlns_id = XmlNamespaces[i].xmlns_id_;
+      }
+      return true;
+    }
+  }
+  return false;
+}
+
 }  // end namespace kmlbase
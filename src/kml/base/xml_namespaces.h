@@ -74,6 +74,12 @@ struct XmlNamespace {
 bool FindXmlNamespaceAndPrefix(XmlnsId xmlns_id, string* prefix,
                                string* xml_namespace);
 
+// These functions return the libkml-specific id for the given typical prefix
+// or full namespace name.  The return value indicates whether the prefix or
+// namespace is known to libkml.  The xmlns_id pointer can be NULL.
+bool FindXmlnsIdByPrefix(const string& prefix, XmlnsId* xmlns_id);
+bool FindXmlnsIdByNamespace(const string& xml_namespace, XmlnsId* xmlns_id);
+
 }  // end namespace kmlbase
 
 #endif  // KML_BASE_XML_NAMESPACES_H__
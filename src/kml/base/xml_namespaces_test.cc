@@ -47,4 +47,17 @@ TEST(XmlNamespacesTest, TestFindXmlNamespaceAndPrefix) {
                                          NULL));
 }
 
+TEST(XmlNamespacesTest, TestFindXmlnsId) {
+  XmlnsId xmlns_id = XMLNS_NONE;
+  ASSERT_TRUE(FindXmlnsIdByPrefix("gx", &xmlns_id));
+  ASSERT_EQ(XMLNS_GX22, xmlns_id);
+  ASSERT_TRUE(FindXmlnsIdByNamespace("http://www.w3.org/2005/Atom",
+                                     &xmlns_id));
+  ASSERT_EQ(XMLNS_ATOM, xmlns_id);
+  ASSERT_TRUE(FindXmlnsIdByNamespace("http://www.opengis.net/kml/2.2", NULL));
+  ASSERT_FALSE(FindXmlnsIdByPrefix("", NULL));
+  ASSERT_FALSE(FindXmlnsIdByPrefix("no-such-prefix", NULL));
+  ASSERT_FALSE(FindXmlnsIdByNamespace("http://example.com/ns", NULL));
+}
+
 }  // end namespace kmlbase
@@ -27,8 +27,8 @@
 
 #include "kml/base/zip_file.h"
 #include "kml/base/file.h"
+#include "kml/base/zip_writer.h"
 #include "minizip/unzip.h"
-#include "minizip/zip.h"
 
 namespace kmlbase {
 
@@ -36,21 +36,6 @@ namespace kmlbase {
 // to attempt to handle by default. (2 GB, as per minizip/unzip.h.)
 static const unsigned long kMaxUncompressedZipSize = ZIP_MAX_UNCOMPRESSED_SIZE;
 
-// This class hides the use of minizip from the interface.
-class MinizipFile {
- public:
-  MinizipFile(zipFile zipfile) : zipfile_(zipfile) {}
-  ~MinizipFile() {
-    if (zipfile_) {
-      zipClose(zipfile_, 0);
-    }
-  }
-  zipFile get_zipfile() { return zipfile_; }
- private:
-  zipFile zipfile_;
-  LIBKML_DISALLOW_EVIL_CONSTRUCTORS(MinizipFile);
-};
-
 // Static.
 ZipFile* ZipFile::OpenFromString(const string& zip_data) {
   return IsZipData(zip_data) ? new ZipFile(zip_data) : NULL;
@@ -70,20 +55,16 @@ ZipFile* ZipFile::OpenFromFile(const char* file_path) {
 
 // Static.
 ZipFile* ZipFile::Create(const char* file_path) {
-  zipFile zipfile = zipOpen(file_path, 0);
-  if (!zipfile) {
-    return NULL;
-  }
-  MinizipFile* minizipfile = new MinizipFile(zipfile);
-  if (!minizipfile) {
+  ZipWriter* zip_writer = ZipWriter::Create(file_path);
+  if (!zip_writer) {
     return NULL;
   }
-  return new ZipFile(minizipfile);
+  return new ZipFile(zip_writer);
 }
 
 // Private. Class constructed with static methods.
 ZipFile::ZipFile(const string& data)
-  : minizip_file_(NULL), data_(data),
+  : zip_writer_(NULL), data_(data),
     max_uncompressed_file_size_(kMaxUncompressedZipSize) {
   // Fill the table of contents for this zipfile.
   zlib_filefunc_def api;
@@ -94,7 +75,7 @@ ZipFile::ZipFile(const string& data)
     if (zfile) {
       unz_file_info finfo;
       do {
-        static char buf[1024];
+        char buf[1024];
         if (libkml_unzGetCurrentFileInfo(zfile, &finfo, buf, sizeof(buf),
               0, 0, 0, 0) == UNZ_OK) {
           zipfile_toc_.push_back(buf);
@@ -106,12 +87,12 @@ ZipFile::ZipFile(const string& data)
 }
 
 // Private. Class constructed with static methods.
-ZipFile::ZipFile(MinizipFile* minizip_file)
-  : minizip_file_(minizip_file),
+ZipFile::ZipFile(ZipWriter* zip_writer)
+  : zip_writer_(zip_writer),
     max_uncompressed_file_size_(kMaxUncompressedZipSize) {}
 
 ZipFile::~ZipFile() {
-  // Scoped ptr takes care of minizip_file_.
+  // Scoped ptr takes care of zip_writer_.
 }
 
 // Static.
@@ -213,25 +194,58 @@ bool ZipFile::GetEntry(const string& path_in_zip,
   return false;
 }
 
-bool ZipFile::AddEntry(const string& data,
-                       const string& path_in_zip) {
-  // The path must be relative to and below the archive.
-  if (path_in_zip.substr(0, 1).find_first_of("/\\") != string::npos ||
-      path_in_zip.substr(0, 2) == "..") {
-    return false;
+ZipEntryReader* ZipFile::OpenEntry(const string& path_in_zip) const {
+  if (!IsInToc(path_in_zip)) {
+    return NULL;
   }
-  if (!minizip_file_) {
-    return false;
+  zlib_filefunc_def api;
+  voidpf mem_stream = mem_simple_create_file(
+      &api, const_cast<void*>(static_cast<const void*>(data_.data())),
+      data_.size());
+  if (!mem_stream) {
+    return NULL;
+  }
+  unzFile unzfile = libkml_unzAttach(mem_stream, &api);
+  if (!unzfile) {
+    return NULL;
+  }
+  if (libkml_unzLocateFile(unzfile, path_in_zip.c_str(), 0) != UNZ_OK ||
+      libkml_unzOpenCurrentFile(unzfile) != UNZ_OK) {
+    libkml_unzClose(unzfile);
+    return NULL;
+  }
+  return new ZipEntryReader(unzfile);
+}
+
+ZipEntryReader::ZipEntryReader(void* unzfile)
+  : unzfile_(unzfile), done_(false) {}
+
+ZipEntryReader::~ZipEntryReader() {
+  // This also closes the current file if it is still open.
+  libkml_unzClose(static_cast<unzFile>(unzfile_));
+}
+
+int ZipEntryReader::Read(void* buf, size_t size) {
+  if (done_) {
+    return 0;
+  }
+  unzFile unzfile = static_cast<unzFile>(unzfile_);
+  int nread = libkml_unzReadCurrentFile(unzfile, buf,
+                                        static_cast<unsigned int>(size));
+  if (nread == 0) {
+    // Closing the entry checks its CRC.
+    done_ = true;
+    return libkml_unzCloseCurrentFile(unzfile) == UNZ_OK ? 0 : -1;
   }
-  zipFile zipfile = minizip_file_->get_zipfile();
-  if (!zipfile) {
+  return nread < 0 ? -1 : nread;
+}
+
+bool ZipFile::AddEntry(const string& data,
+                       const string& path_in_zip) {
+  if (!zip_writer_) {
     return false;
   }
-  zipOpenNewFileInZip(zipfile, path_in_zip.c_str(), 0, 0, 0, 0, 0, 0,
-                      Z_DEFLATED, Z_DEFAULT_COMPRESSION);
-  zipWriteInFileInZip(zipfile, static_cast<const void*>(data.data()),
-                      static_cast<unsigned int>(data.size()));
-  return zipCloseFileInZip(zipfile) == ZIP_OK;
+  return zip_writer_->AddEntry(data, path_in_zip);
 }
 
 }  // end namespace kmlbase
@@ -34,9 +34,29 @@
 
 namespace kmlbase {
 
-// Forward-declare the internal MinizipFile class that hides our current use
-// of minizip.
-class MinizipFile;
+class ZipWriter;
+
+// A ZipEntryReader inflates one entry of a ZipFile a piece at a time, so the
+// whole uncompressed entry need never be in memory. It reads the data of the
+// ZipFile it was opened from, which must outlive it. Unlike GetEntry this is
+// not limited by the ZipFile's max_uncompressed_file_size.
+class ZipEntryReader {
+ public:
+  ~ZipEntryReader();
+
+  // Inflates up to size bytes of the entry into buf. Returns the number of
+  // bytes inflated, 0 once the whole entry has been read and its CRC has been
+  // checked, or -1 on any error.
+  int Read(void* buf, size_t size);
+
+ private:
+  friend class ZipFile;
+  // unzfile is an unzFile positioned at the open entry.
+  ZipEntryReader(void* unzfile);
+  void* unzfile_;
+  bool done_;
+  LIBKML_DISALLOW_EVIL_CONSTRUCTORS(ZipEntryReader);
+};
 
 // This class represents a ZIP file. Obviously the intent within this project
 // is for use with KMZ files, but this class has no particular KML or KMZ
@@ -52,7 +72,9 @@ class ZipFile {
   static ZipFile* OpenFromFile(const char* file_path);
 
   // Create a ZIP file suitable for writing. Will return NULL on any internal
-  // error or a failure to create a file at file_path.
+  // error or a failure to create a file at file_path. Entries are written by
+  // a ZipWriter (see get_zip_writer) and the archive is complete when the
+  // ZipFile is destroyed.
   static ZipFile* Create(const char* file_path);
 
   ~ZipFile();
@@ -93,24 +115,35 @@ class ZipFile {
   // the data of path_in_zip are read into it.
   bool GetEntry(const string& path_in_zip, string* output) const;
 
+  // Returns a ZipEntryReader of path_in_zip, or NULL if it is not in the ZIP
+  // file or cannot be opened. The caller owns the returned object.
+  ZipEntryReader* OpenEntry(const string& path_in_zip) const;
+
   // Returns the raw bytes of this ZipFile.
   const string& get_data() const { return data_; }
 
-  // Writes data to path_in_zip. The path must be relative to the root of the
-  // archive. e.g. AddEntry(data, "somedir/file.png"). Specifically, paths that
-  // start with a '/' or '..' will be rejected and false is returned. False is
-  // also returned on any internal ZIP file error. The ZipFile instance must
-  // have been created with ZipFile::Create. If it wasn't false is returned.
+  // Queues data to be written to path_in_zip. The path must be relative to
+  // the root of the archive. e.g. AddEntry(data, "somedir/file.png").
+  // Specifically, paths that start with a '/' or '..' will be rejected and
+  // false is returned. False is also returned if the ZipFile instance was not
+  // created with ZipFile::Create. The entry is compressed and written later
+  // by the ZipWriter, so an internal ZIP file error is not reported here but
+  // by the writer's Flush or Close (see get_zip_writer).
   // Note that a second call to AddEntry with new data to the same path is
   // essentially a NOP. True will be returned, but the data is unchanged.
   bool AddEntry(const string& data, const string& path_in_zip);
 
+  // Returns the ZipWriter of a ZipFile made by Create, or NULL for a ZipFile
+  // opened for reading. Use this to set compression levels and threads or to
+  // add entries straight from files.
+  ZipWriter* get_zip_writer() { return zip_writer_.get(); }
+
  private:
   // The constructor used to open a ZIP file in-memory, suitable for reading.
   ZipFile(const string& data);
   // The constructor used in creation of a ZIP file suitable for writing.
-  ZipFile(MinizipFile* minizip_file);
-  boost::scoped_ptr<MinizipFile> minizip_file_;
+  ZipFile(ZipWriter* zip_writer);
+  boost::scoped_ptr<ZipWriter> zip_writer_;
   string data_;
   StringVector zipfile_toc_;
   unsigned long max_uncompressed_file_size_;
@@ -29,6 +29,7 @@
 #include "boost/scoped_ptr.hpp"
 #include "kml/base/file.h"
 #include "kml/base/tempfile.h"
+#include "kml/base/zip_writer.h"
 #include "gtest/gtest.h"
 #include "minizip/zip.h"
 
@@ -187,6 +188,54 @@ TEST_F(ZipFileTest, TestGetEntry) {
   ASSERT_FALSE(zip_file_->GetEntry("bar", NULL));
 }
 
+TEST_F(ZipFileTest, TestOpenEntry) {
+  const string kGoodKmz = string(DATADIR) + "/kmz/doc.kmz";
+  zip_file_.reset(ZipFile::OpenFromFile(kGoodKmz.c_str()));
+  ASSERT_TRUE(zip_file_);
+  ASSERT_FALSE(zip_file_->OpenEntry("nosuchfile.kml"));
+  boost::scoped_ptr<ZipEntryReader> reader(zip_file_->OpenEntry("doc.kml"));
+  ASSERT_TRUE(reader.get());
+  // Reading in small pieces yields the same as GetEntry.
+  string entry;
+  char buf[7];
+  int nread;
+  while ((nread = reader->Read(buf, sizeof(buf))) > 0) {
+    ASSERT_GE(static_cast<int>(sizeof(buf)), nread);
+    entry.append(buf, nread);
+  }
+  ASSERT_EQ(0, nread);
+  ASSERT_EQ(0, reader->Read(buf, sizeof(buf)));
+  string expected;
+  ASSERT_TRUE(zip_file_->GetEntry("doc.kml", &expected));
+  ASSERT_EQ(expected, entry);
+}
+
+TEST_F(ZipFileTest, TestOpenEntryIgnoresMaxUncompressedSize) {
+  TempFilePtr tempfile = TempFile::CreateTempFile();
+  ASSERT_TRUE(tempfile != NULL);
+  const string kData(100000, 'x');
+  {
+    boost::scoped_ptr<ZipWriter> zip_writer(
+        ZipWriter::Create(tempfile->name().c_str()));
+    ASSERT_TRUE(zip_writer.get());
+    ASSERT_TRUE(zip_writer->AddEntry(kData, "big.txt"));
+  }
+  zip_file_.reset(ZipFile::OpenFromFile(tempfile->name().c_str()));
+  ASSERT_TRUE(zip_file_);
+  zip_file_->set_max_uncompressed_file_size(1000);
+  ASSERT_FALSE(zip_file_->GetEntry("big.txt", NULL));
+  boost::scoped_ptr<ZipEntryReader> reader(zip_file_->OpenEntry("big.txt"));
+  ASSERT_TRUE(reader.get());
+  string entry;
+  char buf[4096];
+  int nread;
+  while ((nread = reader->Read(buf, sizeof(buf))) > 0) {
+    entry.append(buf, nread);
+  }
+  ASSERT_EQ(0, nread);
+  ASSERT_EQ(kData, entry);
+}
+
 TEST_F(ZipFileTest, TestGetKmzData) {
   const string kGoodKmz = string(DATADIR) + "/kmz/doc.kmz";
   string kmz_data;
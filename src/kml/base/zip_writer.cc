@@ -0,0 +1,371 @@
+// Copyright 2008, Google Inc. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//  3. Neither the name of Google Inc. nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// This file contains the implementation of the ZipWriter class.
+
+#include "kml/base/zip_writer.h"
+#ifdef WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+#include <stdio.h>
+#include "kml/base/file.h"
+#include "kml/base/mimetypes.h"
+#include "kml/base/parallel.h"
+#include "minizip/zip.h"
+#include "zlib.h"
+
+namespace kmlbase {
+
+const int ZipWriter::kStore;
+const int ZipWriter::kDefaultLevel;
+
+static const size_t kDefaultMaxBufferedSize = 32 * 1024 * 1024;
+static const size_t kDefaultMaxBatchSize = 64;
+
+// This class hides the use of minizip from the interface. If the zipFile
+// writes to a file descriptor fd_ is the descriptor the minizip I/O
+// functions below operate on.
+class MinizipFile {
+ public:
+  MinizipFile(zipFile zipfile) : zipfile_(zipfile), fd_(-1) {}
+  MinizipFile() : zipfile_(NULL), fd_(-1) {}
+  ~MinizipFile() {
+    Close();
+  }
+  bool Close() {
+    bool status = true;
+    if (zipfile_) {
+      status = zipClose(zipfile_, 0) == ZIP_OK;
+      zipfile_ = NULL;
+    }
+    return status;
+  }
+  void set_zipfile(zipFile zipfile) { zipfile_ = zipfile; }
+  zipFile get_zipfile() { return zipfile_; }
+  int* get_fd() { return &fd_; }
+ private:
+  zipFile zipfile_;
+  int fd_;
+  LIBKML_DISALLOW_EVIL_CONSTRUCTORS(MinizipFile);
+};
+
+// These are the minizip I/O functions for a ZIP archive written to a file
+// descriptor. Both opaque and stream point to the int descriptor.
+static voidpf ZCALLBACK FdOpen(voidpf opaque, const char* filename,
+                               int mode) {
+  return opaque;
+}
+
+static uLong ZCALLBACK FdRead(voidpf opaque, voidpf stream, void* buf,
+                              uLong size) {
+  int nread = read(*static_cast<int*>(stream), buf, size);
+  return nread < 0 ? 0 : static_cast<uLong>(nread);
+}
+
+static uLong ZCALLBACK FdWrite(voidpf opaque, voidpf stream, const void* buf,
+                               uLong size) {
+  const char* data = static_cast<const char*>(buf);
+  uLong written = 0;
+  while (written < size) {
+    int nwritten = write(*static_cast<int*>(stream), data + written,
+                         size - written);
+    if (nwritten <= 0) {
+      break;
+    }
+    written += nwritten;
+  }
+  return written;
+}
+
+static long ZCALLBACK FdTell(voidpf opaque, voidpf stream) {
+  return lseek(*static_cast<int*>(stream), 0, SEEK_CUR);
+}
+
+static long ZCALLBACK FdSeek(voidpf opaque, voidpf stream, uLong offset,
+                             int origin) {
+  int whence;
+  switch (origin) {
+    case ZLIB_FILEFUNC_SEEK_CUR:
+      whence = SEEK_CUR;
+      break;
+    case ZLIB_FILEFUNC_SEEK_END:
+      whence = SEEK_END;
+      break;
+    case ZLIB_FILEFUNC_SEEK_SET:
+      whence = SEEK_SET;
+      break;
+    default:
+      return -1;
+  }
+  return lseek(*static_cast<int*>(stream), offset, whence) < 0 ? -1 : 0;
+}
+
+static int ZCALLBACK FdClose(voidpf opaque, voidpf stream) {
+  return 0;  // The descriptor belongs to the caller.
+}
+
+static int ZCALLBACK FdTestError(voidpf opaque, voidpf stream) {
+  return 0;
+}
+
+// An entry queued for the next batch. An entry from AddFileEntry has a
+// file_path and no data until it is read.
+struct ZipWriter::Entry {
+  string path_in_zip;
+  string file_path;
+  string data;
+  int level;
+  // These are set when the entry is compressed.
+  string compressed;
+  uLong crc;
+  bool ok;
+};
+
+// Deflates data into output as a raw deflate stream (no zlib header) as
+// stored in a ZIP archive.
+static bool Deflate(const string& data, int level, string* output) {
+  z_stream stream;
+  stream.zalloc = Z_NULL;
+  stream.zfree = Z_NULL;
+  stream.opaque = Z_NULL;
+  if (deflateInit2(&stream, level, Z_DEFLATED, -MAX_WBITS, 8,
+                   Z_DEFAULT_STRATEGY) != Z_OK) {
+    return false;
+  }
+  output->resize(deflateBound(&stream, static_cast<uLong>(data.size())));
+  stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+  stream.avail_in = static_cast<uInt>(data.size());
+  stream.next_out = reinterpret_cast<Bytef*>(&(*output)[0]);
+  stream.avail_out = static_cast<uInt>(output->size());
+  int status = deflate(&stream, Z_FINISH);
+  output->resize(stream.total_out);
+  deflateEnd(&stream);
+  return status == Z_STREAM_END;
+}
+
+// Reads and compresses one entry of a batch. This touches nothing but the
+// entry so entries may be compressed concurrently.
+class CompressTask : public ParallelTask {
+ public:
+  CompressTask(const std::vector<ZipWriter::Entry*>& batch)
+    : batch_(batch) {}
+
+  virtual void Run(size_t index) {
+    ZipWriter::Entry* entry = batch_[index];
+    entry->ok = false;
+    if (!entry->file_path.empty() &&
+        !File::ReadFileToString(entry->file_path, &entry->data)) {
+      return;
+    }
+    const Bytef* bytes = reinterpret_cast<const Bytef*>(entry->data.data());
+    const uInt size = static_cast<uInt>(entry->data.size());
+    entry->crc = crc32(crc32(0L, Z_NULL, 0), bytes, size);
+    if (entry->level != ZipWriter::kStore) {
+      if (!Deflate(entry->data, entry->level, &entry->compressed)) {
+        return;
+      }
+      // Store whatever deflate cannot shrink.
+      if (entry->compressed.size() >= entry->data.size()) {
+        entry->level = ZipWriter::kStore;
+        entry->compressed.clear();
+      }
+    }
+    entry->ok = true;
+  }
+
+ private:
+  const std::vector<ZipWriter::Entry*>& batch_;
+};
+
+// Static.
+ZipWriter* ZipWriter::Create(const char* file_path) {
+  zipFile zipfile = zipOpen(file_path, 0);
+  if (!zipfile) {
+    return NULL;
+  }
+  return new ZipWriter(new MinizipFile(zipfile));
+}
+
+// Static.
+ZipWriter* ZipWriter::CreateFromFd(int fd) {
+  if (fd < 0) {
+    return NULL;
+  }
+  MinizipFile* minizip_file = new MinizipFile;
+  *minizip_file->get_fd() = fd;
+  zlib_filefunc_def api;
+  api.zopen_file = FdOpen;
+  api.zread_file = FdRead;
+  api.zwrite_file = FdWrite;
+  api.ztell_file = FdTell;
+  api.zseek_file = FdSeek;
+  api.zclose_file = FdClose;
+  api.zerror_file = FdTestError;
+  api.opaque = minizip_file->get_fd();
+  zipFile zipfile = zipOpen2(NULL, APPEND_STATUS_CREATE, NULL, &api);
+  if (!zipfile) {
+    delete minizip_file;
+    return NULL;
+  }
+  minizip_file->set_zipfile(zipfile);
+  return new ZipWriter(minizip_file);
+}
+
+// Private. Class constructed with static methods.
+ZipWriter::ZipWriter(MinizipFile* minizip_file)
+  : minizip_file_(minizip_file),
+    buffered_size_(0),
+    error_count_(0),
+    entry_count_(0),
+    num_threads_(0),
+    max_buffered_size_(kDefaultMaxBufferedSize),
+    max_batch_size_(kDefaultMaxBatchSize),
+    default_level_(kDefaultLevel) {
+  // These formats are compressed already.
+  mimetype_levels_[kGifMimeType] = kStore;
+  mimetype_levels_[kJpegMimeType] = kStore;
+  mimetype_levels_[kKmzMimeType] = kStore;
+  mimetype_levels_[kPngMimeType] = kStore;
+}
+
+ZipWriter::~ZipWriter() {
+  Close();
+}
+
+int ZipWriter::GetLevel(const string& path_in_zip) const {
+  if (const char* mimetype = GetMimeTypeFromPath(path_in_zip)) {
+    std::map<string, int>::const_iterator iter =
+        mimetype_levels_.find(mimetype);
+    if (iter != mimetype_levels_.end()) {
+      return iter->second;
+    }
+  }
+  return default_level_;
+}
+
+bool ZipWriter::AddEntry(const string& data, const string& path_in_zip) {
+  return AddEntryWithLevel(data, path_in_zip, GetLevel(path_in_zip));
+}
+
+// The path must be relative to and below the archive.
+static bool IsValidPathInZip(const string& path_in_zip) {
+  return path_in_zip.substr(0, 1).find_first_of("/\\") == string::npos &&
+         path_in_zip.substr(0, 2) != "..";
+}
+
+bool ZipWriter::AddEntryWithLevel(const string& data,
+                                  const string& path_in_zip, int level) {
+  if (!minizip_file_ || !IsValidPathInZip(path_in_zip)) {
+    return false;
+  }
+  Entry* entry = new Entry;
+  entry->path_in_zip = path_in_zip;
+  entry->data = data;
+  entry->level = level;
+  batch_.push_back(entry);
+  buffered_size_ += data.size();
+  if (buffered_size_ >= max_buffered_size_ ||
+      batch_.size() >= max_batch_size_) {
+    WriteBatch();
+  }
+  return true;
+}
+
+bool ZipWriter::AddFileEntry(const string& file_path,
+                             const string& path_in_zip) {
+  if (!minizip_file_ || file_path.empty() || !IsValidPathInZip(path_in_zip)) {
+    return false;
+  }
+  Entry* entry = new Entry;
+  entry->path_in_zip = path_in_zip;
+  entry->file_path = file_path;
+  entry->level = GetLevel(path_in_zip);
+  batch_.push_back(entry);
+  if (batch_.size() >= max_batch_size_) {
+    WriteBatch();
+  }
+  return true;
+}
+
+// Compresses the batch concurrently and then writes it in order.
+void ZipWriter::WriteBatch() {
+  if (batch_.empty()) {
+    return;
+  }
+  CompressTask compress_task(batch_);
+  RunParallel(&compress_task, batch_.size(), num_threads_);
+
+  zipFile zipfile = minizip_file_->get_zipfile();
+  for (size_t i = 0; i < batch_.size(); ++i) {
+    Entry* entry = batch_[i];
+    bool ok = entry->ok;
+    if (ok) {
+      const bool store = entry->level == kStore;
+      const string& bytes = store ? entry->data : entry->compressed;
+      ok = zipOpenNewFileInZip2(zipfile, entry->path_in_zip.c_str(), NULL,
+                                NULL, 0, NULL, 0, NULL,
+                                store ? 0 : Z_DEFLATED, entry->level,
+                                1) == ZIP_OK;
+      if (ok) {
+        ok = zipWriteInFileInZip(zipfile, bytes.data(),
+                                 static_cast<unsigned int>(bytes.size()))
+            == ZIP_OK;
+        ok = zipCloseFileInZipRaw(zipfile, entry->data.size(),
+                                  entry->crc) == ZIP_OK && ok;
+      }
+    }
+    if (ok) {
+      ++entry_count_;
+    } else {
+      ++error_count_;
+    }
+    delete entry;
+  }
+  batch_.clear();
+  buffered_size_ = 0;
+}
+
+size_t ZipWriter::Flush() {
+  if (minizip_file_) {
+    WriteBatch();
+  }
+  size_t error_count = error_count_;
+  error_count_ = 0;
+  return error_count;
+}
+
+bool ZipWriter::Close() {
+  if (!minizip_file_) {
+    return true;
+  }
+  const bool flushed = Flush() == 0;
+  const bool closed = minizip_file_->Close();
+  minizip_file_.reset();
+  return flushed && closed;
+}
+
+}  // end namespace kmlbase
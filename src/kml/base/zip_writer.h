@@ -0,0 +1,172 @@
+// Copyright 2008, Google Inc. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//  3. Neither the name of Google Inc. nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// This file contains the declaration of the ZipWriter class.
+
+#ifndef KML_BASE_ZIP_WRITER_H__
+#define KML_BASE_ZIP_WRITER_H__
+
+#include <map>
+#include <vector>
+#include "boost/scoped_ptr.hpp"
+#include "kml/base/util.h"
+
+namespace kmlbase {
+
+// Forward-declare the internal MinizipFile class that hides our current use
+// of minizip.
+class MinizipFile;
+class CompressTask;
+
+// A ZipWriter creates a ZIP archive. Entries are queued by AddEntry and
+// AddFileEntry and compressed in batches: a batch is deflated concurrently on
+// up to get_num_threads() threads and then written to the archive by the
+// calling thread in exactly the order the entries were added. The output is
+// thus the same for any number of threads. A batch is written as soon as it
+// holds get_max_buffered_size() bytes of queued data or get_max_batch_size()
+// entries, and on Flush and Close.
+//
+// Each entry has a compression level: kStore writes the entry as is, and 1
+// through 9 are the usual deflate levels from fastest to smallest. The level
+// is chosen by the mime type of the entry's path (see GetLevel). By default
+// PNG, JPEG and GIF images and nested KMZ archives are stored because they are
+// already compressed, and everything else uses kDefaultLevel.
+class ZipWriter {
+ public:
+  static const int kStore = 0;
+  static const int kDefaultLevel = -1;
+
+  // Creates a ZIP file at file_path. Returns NULL if the file could not be
+  // created.
+  static ZipWriter* Create(const char* file_path);
+
+  // Creates a ZIP archive written to the open file descriptor fd, which must
+  // be writable and seekable: the size and CRC of each entry are patched into
+  // its local header after its data is written. The archive starts at the
+  // current offset of fd. The descriptor is not closed by the ZipWriter.
+  // Returns NULL if fd is negative.
+  static ZipWriter* CreateFromFd(int fd);
+
+  // Close()s the archive.
+  ~ZipWriter();
+
+  // The number of threads used to compress a batch. 0 (the default) means
+  // one per processor.
+  void set_num_threads(unsigned int num_threads) {
+    num_threads_ = num_threads;
+  }
+  unsigned int get_num_threads() const {
+    return num_threads_;
+  }
+
+  // The number of bytes of queued entry data at which a batch is written.
+  // The default is 32 MB. Entries added with AddFileEntry are not read until
+  // their batch is compressed and so do not count towards this.
+  void set_max_buffered_size(size_t max_buffered_size) {
+    max_buffered_size_ = max_buffered_size;
+  }
+  size_t get_max_buffered_size() const {
+    return max_buffered_size_;
+  }
+
+  // The number of queued entries at which a batch is written. The default is
+  // 64. This bounds the number of files AddFileEntry holds in memory at once.
+  void set_max_batch_size(size_t max_batch_size) {
+    max_batch_size_ = max_batch_size;
+  }
+  size_t get_max_batch_size() const {
+    return max_batch_size_;
+  }
+
+  // The level of entries whose path has no per-mimetype level.
+  void set_default_level(int level) {
+    default_level_ = level;
+  }
+  int get_default_level() const {
+    return default_level_;
+  }
+
+  // Sets the level of entries whose path has the given mime type as
+  // returned by GetMimeTypeFromPath in kml/base/mimetypes.h.
+  void set_mimetype_level(const string& mimetype, int level) {
+    mimetype_levels_[mimetype] = level;
+  }
+
+  // Returns the level used for an entry at path_in_zip.
+  int GetLevel(const string& path_in_zip) const;
+
+  // Queues data to be written to path_in_zip at the level for that path.
+  // The path must be relative to the root of the archive: paths that start
+  // with a '/' or '..' are rejected and false is returned. False is also
+  // returned after Close. Errors in compressing or writing the entry are
+  // reported by the Flush that writes it.
+  bool AddEntry(const string& data, const string& path_in_zip);
+
+  // As AddEntry, with an explicit level.
+  bool AddEntryWithLevel(const string& data, const string& path_in_zip,
+                         int level);
+
+  // Queues the contents of the file at file_path to be written to
+  // path_in_zip. The file is read when its batch is compressed; if it cannot
+  // be read the entry is left out of the archive and counted as an error.
+  bool AddFileEntry(const string& file_path, const string& path_in_zip);
+
+  // Compresses and writes all queued entries. Returns the number of entries
+  // which could not be read, compressed or written by this and any earlier
+  // automatic flush since the last call to Flush.
+  size_t Flush();
+
+  // Flushes the queued entries and writes the central directory of the
+  // archive. Returns false if any entry since the last Flush or the archive
+  // itself could not be written. Any later call to Close returns true and
+  // does nothing.
+  bool Close();
+
+  // Returns the number of entries written so far.
+  size_t get_entry_count() const {
+    return entry_count_;
+  }
+
+ private:
+  friend class CompressTask;
+  struct Entry;
+  ZipWriter(MinizipFile* minizip_file);
+  void WriteBatch();
+  boost::scoped_ptr<MinizipFile> minizip_file_;
+  std::vector<Entry*> batch_;
+  size_t buffered_size_;
+  size_t error_count_;
+  size_t entry_count_;
+  unsigned int num_threads_;
+  size_t max_buffered_size_;
+  size_t max_batch_size_;
+  int default_level_;
+  std::map<string, int> mimetype_levels_;
+  LIBKML_DISALLOW_EVIL_CONSTRUCTORS(ZipWriter);
+};
+
+}  // end namespace kmlbase
+
+#endif  // KML_BASE_ZIP_WRITER_H__
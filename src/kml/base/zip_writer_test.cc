@@ -0,0 +1,250 @@
+// Copyright 2008, Google Inc. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//  3. Neither the name of Google Inc. nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// This file contains the unit tests for the ZipWriter class.
+
+#include "kml/base/zip_writer.h"
+#include <fcntl.h>
+#ifdef WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+#include "boost/scoped_ptr.hpp"
+#include "kml/base/file.h"
+#include "kml/base/mimetypes.h"
+#include "kml/base/string_util.h"
+#include "kml/base/tempfile.h"
+#include "kml/base/zip_file.h"
+#include "gtest/gtest.h"
+
+namespace kmlbase {
+
+class ZipWriterTest : public testing::Test {
+ protected:
+  virtual void SetUp() {
+    tempfile_ = TempFile::CreateTempFile();
+    ASSERT_TRUE(tempfile_ != NULL);
+  }
+
+  // Returns a highly compressible string of the given size.
+  static string MakeData(size_t size, char c) {
+    string data;
+    for (size_t i = 0; i < size; ++i) {
+      data.push_back(static_cast<char>(c + i % 7));
+    }
+    return data;
+  }
+
+  // Writes kEntryCount entries with the given writer settings and returns
+  // the bytes of the archive.
+  string WriteArchive(unsigned int num_threads, size_t max_batch_size) {
+    {
+      boost::scoped_ptr<ZipWriter> zip_writer(
+          ZipWriter::Create(tempfile_->name().c_str()));
+      EXPECT_TRUE(zip_writer.get());
+      zip_writer->set_num_threads(num_threads);
+      zip_writer->set_max_batch_size(max_batch_size);
+      for (size_t i = 0; i < kEntryCount; ++i) {
+        string path = "dir/" + ToString(i) + ".kml";
+        EXPECT_TRUE(zip_writer->AddEntry(MakeData(1000 + i, 'a'), path));
+      }
+      EXPECT_TRUE(zip_writer->Close());
+      EXPECT_EQ(kEntryCount, zip_writer->get_entry_count());
+    }
+    string data;
+    EXPECT_TRUE(File::ReadFileToString(tempfile_->name(), &data));
+    return data;
+  }
+
+  static const size_t kEntryCount = 10;
+  TempFilePtr tempfile_;
+};
+
+const size_t ZipWriterTest::kEntryCount;
+
+TEST_F(ZipWriterTest, TestCreate) {
+  ASSERT_FALSE(ZipWriter::Create("/nosuchpath/here.zip"));
+  ASSERT_FALSE(ZipWriter::CreateFromFd(-1));
+}
+
+TEST_F(ZipWriterTest, TestGetMimeTypeFromPath) {
+  ASSERT_EQ(kPngMimeType, GetMimeTypeFromPath("files/a.png"));
+  ASSERT_EQ(kJpegMimeType, GetMimeTypeFromPath("b.JPG"));
+  ASSERT_EQ(kJpegMimeType, GetMimeTypeFromPath("c.jpeg"));
+  ASSERT_EQ(kGifMimeType, GetMimeTypeFromPath("d.gif"));
+  ASSERT_EQ(kKmlMimeType, GetMimeTypeFromPath("doc.kml"));
+  ASSERT_EQ(kKmzMimeType, GetMimeTypeFromPath("e.kmz"));
+  ASSERT_TRUE(GetMimeTypeFromPath("noextension") == NULL);
+  ASSERT_TRUE(GetMimeTypeFromPath("dir.png/file") == NULL);
+  ASSERT_TRUE(GetMimeTypeFromPath("model.dae") == NULL);
+}
+
+TEST_F(ZipWriterTest, TestGetLevel) {
+  boost::scoped_ptr<ZipWriter> zip_writer(
+      ZipWriter::Create(tempfile_->name().c_str()));
+  ASSERT_TRUE(zip_writer.get());
+  ASSERT_EQ(ZipWriter::kDefaultLevel, zip_writer->GetLevel("doc.kml"));
+  ASSERT_EQ(ZipWriter::kStore, zip_writer->GetLevel("files/a.png"));
+  ASSERT_EQ(ZipWriter::kStore, zip_writer->GetLevel("b.jpg"));
+  ASSERT_EQ(ZipWriter::kStore, zip_writer->GetLevel("c.gif"));
+  ASSERT_EQ(ZipWriter::kStore, zip_writer->GetLevel("d.kmz"));
+  zip_writer->set_default_level(9);
+  zip_writer->set_mimetype_level(kPngMimeType, 1);
+  ASSERT_EQ(9, zip_writer->GetLevel("doc.kml"));
+  ASSERT_EQ(9, zip_writer->GetLevel("readme"));
+  ASSERT_EQ(1, zip_writer->GetLevel("files/a.png"));
+}
+
+TEST_F(ZipWriterTest, TestAddEntry) {
+  const string kKml = MakeData(5000, 'a');
+  const string kPng = "\x89PNG" + MakeData(1000, 'A');
+  {
+    boost::scoped_ptr<ZipWriter> zip_writer(
+        ZipWriter::Create(tempfile_->name().c_str()));
+    ASSERT_TRUE(zip_writer.get());
+    ASSERT_TRUE(zip_writer->AddEntry(kKml, "doc.kml"));
+    ASSERT_TRUE(zip_writer->AddEntry(kPng, "files/a.png"));
+    ASSERT_TRUE(zip_writer->AddEntryWithLevel(kKml, "stored.kml",
+                                              ZipWriter::kStore));
+    ASSERT_FALSE(zip_writer->AddEntry(kKml, "../invalid.kml"));
+    ASSERT_FALSE(zip_writer->AddEntry(kKml, "/also/invalid.kml"));
+    ASSERT_EQ(static_cast<size_t>(0), zip_writer->Flush());
+    ASSERT_EQ(static_cast<size_t>(3), zip_writer->get_entry_count());
+    ASSERT_TRUE(zip_writer->Close());
+    // Nothing may be added once the archive is closed.
+    ASSERT_FALSE(zip_writer->AddEntry(kKml, "late.kml"));
+    ASSERT_TRUE(zip_writer->Close());
+  }
+  string zip_data;
+  ASSERT_TRUE(File::ReadFileToString(tempfile_->name(), &zip_data));
+  // The image and the entry written at kStore appear as is in the archive
+  // and the deflated doc.kml does not.
+  ASSERT_NE(string::npos, zip_data.find(kPng));
+  ASSERT_NE(string::npos, zip_data.find(kKml));
+  ASSERT_EQ(zip_data.find(kKml), zip_data.rfind(kKml));
+  // The archive is smaller than the stored entries plus one deflated KML.
+  ASSERT_GT(kKml.size() * 2 + kPng.size(), zip_data.size());
+
+  boost::scoped_ptr<ZipFile> zip_file(ZipFile::OpenFromString(zip_data));
+  ASSERT_TRUE(zip_file.get());
+  StringVector toc;
+  ASSERT_TRUE(zip_file->GetToc(&toc));
+  ASSERT_EQ(static_cast<size_t>(3), toc.size());
+  ASSERT_EQ(string("doc.kml"), toc[0]);
+  ASSERT_EQ(string("files/a.png"), toc[1]);
+  ASSERT_EQ(string("stored.kml"), toc[2]);
+  string entry;
+  ASSERT_TRUE(zip_file->GetEntry("doc.kml", &entry));
+  ASSERT_EQ(kKml, entry);
+  entry.clear();
+  ASSERT_TRUE(zip_file->GetEntry("files/a.png", &entry));
+  ASSERT_EQ(kPng, entry);
+  entry.clear();
+  ASSERT_TRUE(zip_file->GetEntry("stored.kml", &entry));
+  ASSERT_EQ(kKml, entry);
+}
+
+TEST_F(ZipWriterTest, TestAddFileEntry) {
+  TempFilePtr source = TempFile::CreateTempFile();
+  ASSERT_TRUE(source != NULL);
+  const string kData = MakeData(3000, 'x');
+  ASSERT_TRUE(File::WriteStringToFile(kData, source->name()));
+  {
+    boost::scoped_ptr<ZipWriter> zip_writer(
+        ZipWriter::Create(tempfile_->name().c_str()));
+    ASSERT_TRUE(zip_writer.get());
+    ASSERT_TRUE(zip_writer->AddFileEntry(source->name(), "a.kml"));
+    ASSERT_TRUE(zip_writer->AddFileEntry("/no/such/file", "b.kml"));
+    ASSERT_TRUE(zip_writer->AddFileEntry(source->name(), "c.kml"));
+    ASSERT_FALSE(zip_writer->AddFileEntry("", "d.kml"));
+    // The missing file is left out and counted once.
+    ASSERT_EQ(static_cast<size_t>(1), zip_writer->Flush());
+    ASSERT_EQ(static_cast<size_t>(0), zip_writer->Flush());
+    ASSERT_EQ(static_cast<size_t>(2), zip_writer->get_entry_count());
+  }
+  boost::scoped_ptr<ZipFile> zip_file(
+      ZipFile::OpenFromFile(tempfile_->name().c_str()));
+  ASSERT_TRUE(zip_file.get());
+  StringVector toc;
+  ASSERT_TRUE(zip_file->GetToc(&toc));
+  ASSERT_EQ(static_cast<size_t>(2), toc.size());
+  ASSERT_EQ(string("a.kml"), toc[0]);
+  ASSERT_EQ(string("c.kml"), toc[1]);
+  string entry;
+  ASSERT_TRUE(zip_file->GetEntry("c.kml", &entry));
+  ASSERT_EQ(kData, entry);
+}
+
+TEST_F(ZipWriterTest, TestBatches) {
+  boost::scoped_ptr<ZipWriter> zip_writer(
+      ZipWriter::Create(tempfile_->name().c_str()));
+  ASSERT_TRUE(zip_writer.get());
+  zip_writer->set_max_batch_size(3);
+  zip_writer->set_max_buffered_size(10000);
+  ASSERT_TRUE(zip_writer->AddEntry("a", "a.kml"));
+  ASSERT_TRUE(zip_writer->AddEntry("b", "b.kml"));
+  ASSERT_EQ(static_cast<size_t>(0), zip_writer->get_entry_count());
+  // The third entry fills the batch.
+  ASSERT_TRUE(zip_writer->AddEntry("c", "c.kml"));
+  ASSERT_EQ(static_cast<size_t>(3), zip_writer->get_entry_count());
+  // So does enough data.
+  ASSERT_TRUE(zip_writer->AddEntry(MakeData(10000, 'a'), "d.kml"));
+  ASSERT_EQ(static_cast<size_t>(4), zip_writer->get_entry_count());
+}
+
+TEST_F(ZipWriterTest, TestOutputIsIndependentOfThreads) {
+  const string kSerial = WriteArchive(1, 64);
+  ASSERT_FALSE(kSerial.empty());
+  ASSERT_EQ(kSerial, WriteArchive(4, 64));
+  ASSERT_EQ(kSerial, WriteArchive(4, 3));
+  ASSERT_EQ(kSerial, WriteArchive(0, 1));
+}
+
+TEST_F(ZipWriterTest, TestCreateFromFd) {
+  const string kKml = MakeData(2000, 'k');
+  int fd = open(tempfile_->name().c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+  ASSERT_LE(0, fd);
+  {
+    boost::scoped_ptr<ZipWriter> zip_writer(ZipWriter::CreateFromFd(fd));
+    ASSERT_TRUE(zip_writer.get());
+    ASSERT_TRUE(zip_writer->AddEntry(kKml, "doc.kml"));
+    ASSERT_TRUE(zip_writer->AddEntry("\x89PNG", "a.png"));
+    ASSERT_TRUE(zip_writer->Close());
+  }
+  // The descriptor is left open.
+  ASSERT_EQ(0, close(fd));
+  boost::scoped_ptr<ZipFile> zip_file(
+      ZipFile::OpenFromFile(tempfile_->name().c_str()));
+  ASSERT_TRUE(zip_file.get());
+  string entry;
+  ASSERT_TRUE(zip_file->GetEntry("doc.kml", &entry));
+  ASSERT_EQ(kKml, entry);
+  entry.clear();
+  ASSERT_TRUE(zip_file->GetEntry("a.png", &entry));
+  ASSERT_EQ(string("\x89PNG"), entry);
+}
+
+}  // end namespace kmlbase
@@ -117,6 +117,7 @@ CameraPtr CreateCamera(double latitude, double longitude, double altitude,
 CoordinatesPtr CreateCoordinatesCircle(double lat, double lng,
                                        double radius, size_t segments) {
   CoordinatesPtr coords = KmlFactory::GetFactory()->CreateCoordinates();
+  coords->reserve(segments);
   for (size_t i = 0; i < segments; ++i) {
     coords->add_vec3(kmlbase::LatLngOnRadialFromPoint(lat, lng, radius, i));
   }
@@ -286,29 +287,31 @@ void SimplifyCoordinates(const CoordinatesPtr& src,
   if (!src || !dest) {
     return;
   }
+  const std::vector<Vec3>& src_array = src->get_coordinates_array();
+  dest->reserve(dest->get_coordinates_array_size() + src_array.size());
   // Remember the last coordinate.
   Vec3 last_vec;
-  for (size_t i = 0; i < src->get_coordinates_array_size(); ++i) {
+  for (size_t i = 0; i < src_array.size(); ++i) {
+    const Vec3& this_vec = src_array[i];
     // If this is the first tuple, just append it to the result vec.
     if (i == 0) {
-      dest->add_vec3(src->get_coordinates_array_at(i));
-      last_vec = src->get_coordinates_array_at(i);
+      last_vec = this_vec;
+      dest->add_vec3(last_vec);
       continue;
     }
     // If the distance between the position of the last point and the current
     // point is greater than merge_tolerance, do not append it to the vector.
     if (merge_tolerance > 0.0) {
-      Vec3 this_vec = src->get_coordinates_array_at(i);
       if (merge_tolerance >= kmlbase::DistanceBetweenPoints3d(
             last_vec.get_latitude(), last_vec.get_longitude(),
             last_vec.get_altitude(), this_vec.get_latitude(),
             this_vec.get_longitude(), this_vec.get_altitude())) {
-        last_vec = src->get_coordinates_array_at(i);
+        last_vec = this_vec;
         continue;
       }
     }
-    last_vec = src->get_coordinates_array_at(i);
-    dest->add_vec3(src->get_coordinates_array_at(i));
+    last_vec = this_vec;
+    dest->add_vec3(last_vec);
   }
 }
 
@@ -0,0 +1,485 @@
+// Copyright 2008, Google Inc. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//  3. Neither the name of Google Inc. nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// This file contains the implementation of the GpxTrackReader class and the
+// GPX to <gx:Track> conversion functions.
+
+#include "kml/convenience/gpx_track_reader.h"
+#include <stdlib.h>
+#include <fstream>
+#include <sstream>
+#include "kml/base/expat_handler.h"
+#include "kml/base/parallel.h"
+#include "kml/dom/xsd.h"
+
+using kmldom::GxTrackPtr;
+using kmldom::KmlFactory;
+using kmldom::PlacemarkPtr;
+
+namespace kmlconvenience {
+
+// The size of each read of a GPX file.
+static const size_t kChunkSize = 65536;
+
+// The GPX elements the reader looks at.
+enum GpxElement {
+  GPX_OTHER,
+  GPX_TRK,
+  GPX_TRKSEG,
+  GPX_TRKPT,
+  GPX_ELE,
+  GPX_TIME,
+  GPX_NAME
+};
+
+// This is true if the given name is the given ASCII string.
+static bool Equals(const XML_Char* name, const char* str) {
+  for (; *name && *str; ++name, ++str) {
+    if (*name != static_cast<XML_Char>(*str)) {
+      return false;
+    }
+  }
+  return *name == 0 && *str == 0;
+}
+
+// This returns the name less any namespace prefix.
+static const XML_Char* LocalName(const XML_Char* name) {
+  const XML_Char* local = name;
+  for (const XML_Char* p = name; *p; ++p) {
+    if (*p == ':') {
+      local = p + 1;
+    }
+  }
+  return local;
+}
+
+static GpxElement GetGpxElement(const XML_Char* name) {
+  const XML_Char* local = LocalName(name);
+  switch (local[0]) {
+    case 't':
+      if (Equals(local, "trkpt")) {
+        return GPX_TRKPT;
+      }
+      if (Equals(local, "time")) {
+        return GPX_TIME;
+      }
+      if (Equals(local, "trkseg")) {
+        return GPX_TRKSEG;
+      }
+      if (Equals(local, "trk")) {
+        return GPX_TRK;
+      }
+      break;
+    case 'e':
+      if (Equals(local, "ele")) {
+        return GPX_ELE;
+      }
+      break;
+    case 'n':
+      if (Equals(local, "name")) {
+        return GPX_NAME;
+      }
+      break;
+  }
+  return GPX_OTHER;
+}
+
+// This parses the given number into a double.  False is returned if it does
+// not start with a number.  The chars are either XML_Char's of an attribute
+// or the chars of the gathered character data.
+template<typename Char>
+static bool ParseDouble(const Char* value, double* number) {
+  // A number needs far fewer chars than this.
+  char buf[64];
+  size_t i = 0;
+  for (; value[i] && i < sizeof(buf) - 1; ++i) {
+    buf[i] = static_cast<char>(value[i]);
+  }
+  buf[i] = '\0';
+  char* endp;
+  *number = strtod(buf, &endp);
+  return endp != buf;
+}
+
+// A GPX file has no need of entities so any entity declaration stops the
+// parse just as kmlbase::ExpatParser does.
+static void ReportError(XML_Parser parser, string* errors) {
+  if (!errors) {
+    return;
+  }
+  std::stringstream strstream;
+  strstream << XML_ErrorString(XML_GetErrorCode(parser))
+            << " on line " << XML_GetCurrentLineNumber(parser)
+            << " at offset " << XML_GetCurrentColumnNumber(parser);
+  *errors = strstream.str();
+}
+
+static void XMLCALL StopOnEntityDecl(void* user_data,
+                                     const XML_Char* entity_name,
+                                     int is_parameter_entity,
+                                     const XML_Char* value, int value_length,
+                                     const XML_Char* base,
+                                     const XML_Char* system_id,
+                                     const XML_Char* public_id,
+                                     const XML_Char* notation_name) {
+  XML_StopParser(static_cast<XML_Parser>(user_data), XML_FALSE);
+}
+
+GpxTrackReader::GpxTrackReader(GpxTrackHandler* gpx_track_handler,
+                               size_t max_track_size)
+  : gpx_track_handler_(gpx_track_handler),
+    max_track_size_(max_track_size),
+    parser_(XML_ParserCreate(NULL)),
+    in_trk_(false),
+    in_trkpt_(false),
+    has_point_(false),
+    has_ele_(false),
+    track_has_ele_(true),
+    longitude_(0),
+    latitude_(0),
+    altitude_(0),
+    gather_char_data_(false),
+    point_count_(0) {
+  XML_SetUserData(parser_, this);
+  XML_SetElementHandler(parser_, StartElement, EndElement);
+  XML_SetCharacterDataHandler(parser_, CharData);
+  XML_SetEntityDeclHandler(parser_, StopOnEntityDecl);
+  // The entity handler is given the parser, not this.
+  XML_UseParserAsHandlerArg(parser_);
+}
+
+GpxTrackReader::~GpxTrackReader() {
+  XML_ParserFree(parser_);
+}
+
+bool GpxTrackReader::Parse(const char* data, size_t size, bool is_final,
+                           string* errors) {
+  if (XML_Parse(parser_, data, static_cast<int>(size), is_final) ==
+      XML_STATUS_OK) {
+    if (is_final) {
+      FlushTrack();
+    }
+    return true;
+  }
+  ReportError(parser_, errors);
+  return false;
+}
+
+bool GpxTrackReader::ReadFile(const string& filename, string* errors) {
+  std::ifstream input_file(filename.c_str(),
+                           std::ios_base::in | std::ios_base::binary);
+  if (!input_file.is_open() || !input_file.good()) {
+    if (errors) {
+      *errors = "could not open " + filename;
+    }
+    return false;
+  }
+  while (true) {
+    char* buffer = static_cast<char*>(
+        XML_GetBuffer(parser_, static_cast<int>(kChunkSize)));
+    if (!buffer) {
+      if (errors) {
+        *errors = "could not allocate memory";
+      }
+      return false;
+    }
+    input_file.read(buffer, kChunkSize);
+    const std::streamsize size = input_file.gcount();
+    const bool is_final = !input_file.good();
+    if (XML_ParseBuffer(parser_, static_cast<int>(size), is_final) !=
+        XML_STATUS_OK) {
+      ReportError(parser_, errors);
+      return false;
+    }
+    if (is_final) {
+      FlushTrack();
+      return true;
+    }
+  }
+}
+
+// static
+void XMLCALL GpxTrackReader::StartElement(void* user_data,
+                                          const XML_Char* name,
+                                          const XML_Char** atts) {
+  GpxTrackReader* reader =
+      static_cast<GpxTrackReader*>(XML_GetUserData(
+          static_cast<XML_Parser>(user_data)));
+  switch (GetGpxElement(name)) {
+    case GPX_TRK:
+      reader->in_trk_ = true;
+      reader->track_name_.clear();
+      break;
+    case GPX_TRKSEG:
+      reader->FlushTrack();
+      break;
+    case GPX_TRKPT:
+      reader->StartTrkPt(atts);
+      break;
+    case GPX_ELE:
+    case GPX_TIME:
+      reader->gather_char_data_ = reader->in_trkpt_;
+      reader->char_data_.clear();
+      break;
+    case GPX_NAME:
+      reader->gather_char_data_ = reader->in_trk_ && !reader->in_trkpt_;
+      reader->char_data_.clear();
+      break;
+    default:
+      break;
+  }
+}
+
+// static
+void XMLCALL GpxTrackReader::EndElement(void* user_data,
+                                        const XML_Char* name) {
+  GpxTrackReader* reader =
+      static_cast<GpxTrackReader*>(XML_GetUserData(
+          static_cast<XML_Parser>(user_data)));
+  const GpxElement gpx_element = GetGpxElement(name);
+  if (reader->gather_char_data_) {
+    switch (gpx_element) {
+      case GPX_ELE:
+        reader->has_ele_ = ParseDouble(reader->char_data_.c_str(),
+                                       &reader->altitude_);
+        break;
+      case GPX_TIME:
+        // This reuses the capacity of time_ rather than allocating.
+        reader->time_.assign(reader->char_data_);
+        break;
+      case GPX_NAME:
+        reader->track_name_.assign(reader->char_data_);
+        break;
+      default:
+        return;  // Still within the <ele>, <time> or <name>.
+    }
+    reader->gather_char_data_ = false;
+    return;
+  }
+  switch (gpx_element) {
+    case GPX_TRK:
+      reader->FlushTrack();
+      reader->in_trk_ = false;
+      break;
+    case GPX_TRKSEG:
+      reader->FlushTrack();
+      break;
+    case GPX_TRKPT:
+      reader->EndTrkPt();
+      break;
+    default:
+      break;
+  }
+}
+
+// static
+void XMLCALL GpxTrackReader::CharData(void* user_data, const XML_Char* data,
+                                      int length) {
+  GpxTrackReader* reader =
+      static_cast<GpxTrackReader*>(XML_GetUserData(
+          static_cast<XML_Parser>(user_data)));
+  if (reader->gather_char_data_) {
+    for (int i = 0; i < length; ++i) {
+      kmlbase::xmlchar_to_utf8(data + i, &reader->char_data_);
+    }
+  }
+}
+
+// <trkpt lat="-33.911973070" lon="18.422974152">
+void GpxTrackReader::StartTrkPt(const XML_Char** atts) {
+  bool has_latitude = false;
+  bool has_longitude = false;
+  for (; atts && atts[0]; atts += 2) {
+    const XML_Char* name = LocalName(atts[0]);
+    if (Equals(name, "lat")) {
+      has_latitude = ParseDouble(atts[1], &latitude_);
+    } else if (Equals(name, "lon")) {
+      has_longitude = ParseDouble(atts[1], &longitude_);
+    }
+  }
+  in_trkpt_ = true;
+  has_point_ = has_latitude && has_longitude;
+  has_ele_ = false;
+  altitude_ = 0;
+  time_.clear();
+}
+
+// </trkpt>
+void GpxTrackReader::EndTrkPt() {
+  in_trkpt_ = false;
+  if (!has_point_) {
+    return;
+  }
+  if (!gx_track_) {
+    gx_track_ = KmlFactory::GetFactory()->CreateGxTrack();
+    track_has_ele_ = true;
+  }
+  gx_track_->add_when(time_);
+  // The altitude 0 of a <trkpt> with no <ele> is not sea level so such a
+  // track is left clamped to the ground.
+  gx_track_->add_gx_coord(longitude_, latitude_, altitude_);
+  track_has_ele_ = track_has_ele_ && has_ele_;
+  ++point_count_;
+  if (max_track_size_ && gx_track_->get_when_array_size() >= max_track_size_) {
+    FlushTrack();
+  }
+}
+
+void GpxTrackReader::FlushTrack() {
+  if (!gx_track_) {
+    return;
+  }
+  if (track_has_ele_) {
+    // GPX <ele> is meters above mean sea level.
+    gx_track_->set_altitudemode(kmldom::ALTITUDEMODE_ABSOLUTE);
+  }
+  // The handler now holds the only reference.
+  GxTrackPtr gx_track = gx_track_;
+  gx_track_ = NULL;
+  if (gpx_track_handler_) {
+    gpx_track_handler_->HandleTrack(track_name_, gx_track);
+  }
+}
+
+// This writes each track as a <Placemark> as soon as it is read.
+class KmlTrackWriter : public GpxTrackHandler {
+ public:
+  KmlTrackWriter(std::ostream* output)
+    : output_(output) {
+  }
+
+  void Begin() {
+    *output_ << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+             << "<kml xmlns=\"http://www.opengis.net/kml/2.2\""
+             << " xmlns:gx=\"http://www.google.com/kml/ext/2.2\">\n"
+             << "<Document>\n";
+  }
+
+  virtual void HandleTrack(const string& track_name,
+                           const GxTrackPtr& gx_track) {
+    PlacemarkPtr placemark = KmlFactory::GetFactory()->CreatePlacemark();
+    if (!track_name.empty()) {
+      placemark->set_name(track_name);
+    }
+    placemark->set_geometry(gx_track);
+    kmldom::SerializeToOstream(placemark, true, output_);
+  }
+
+  void End() {
+    *output_ << "</Document>\n</kml>\n";
+  }
+
+ private:
+  std::ostream* output_;
+};
+
+bool ConvertGpxToKml(const string& gpx_filename, const string& kml_filename,
+                     size_t max_track_size, string* errors) {
+  std::ofstream output_file(kml_filename.c_str(),
+                            std::ios_base::out | std::ios_base::binary);
+  if (!output_file.is_open() || !output_file.good()) {
+    if (errors) {
+      *errors = "could not open " + kml_filename;
+    }
+    return false;
+  }
+  KmlTrackWriter kml_track_writer(&output_file);
+  kml_track_writer.Begin();
+  GpxTrackReader gpx_track_reader(&kml_track_writer, max_track_size);
+  if (!gpx_track_reader.ReadFile(gpx_filename, errors)) {
+    return false;
+  }
+  kml_track_writer.End();
+  output_file.close();
+  if (!output_file) {
+    if (errors) {
+      *errors = "could not write " + kml_filename;
+    }
+    return false;
+  }
+  return true;
+}
+
+// Each Run() converts one file and writes only its own status and error.
+class ConvertGpxTask : public kmlbase::ParallelTask {
+ public:
+  ConvertGpxTask(const std::vector<string>& gpx_filenames,
+                 const std::vector<string>& kml_filenames,
+                 size_t max_track_size)
+    : gpx_filenames_(gpx_filenames),
+      kml_filenames_(kml_filenames),
+      max_track_size_(max_track_size),
+      status_(gpx_filenames.size(), 0),
+      errors_(gpx_filenames.size()) {
+  }
+
+  virtual void Run(size_t index) {
+    status_[index] = ConvertGpxToKml(gpx_filenames_[index],
+                                     kml_filenames_[index], max_track_size_,
+                                     &errors_[index]);
+  }
+
+  size_t get_converted_count() const {
+    size_t count = 0;
+    for (size_t i = 0; i < status_.size(); ++i) {
+      count += status_[i] ? 1 : 0;
+    }
+    return count;
+  }
+
+  std::vector<string>* mutable_errors() {
+    return &errors_;
+  }
+
+ private:
+  const std::vector<string>& gpx_filenames_;
+  const std::vector<string>& kml_filenames_;
+  const size_t max_track_size_;
+  // Note this is not a std::vector<bool> whose elements share storage.
+  std::vector<char> status_;
+  std::vector<string> errors_;
+};
+
+size_t ConvertGpxFilesToKml(const std::vector<string>& gpx_filenames,
+                            const std::vector<string>& kml_filenames,
+                            size_t max_track_size, unsigned int num_threads,
+                            std::vector<string>* errors) {
+  if (gpx_filenames.size() != kml_filenames.size()) {
+    return 0;
+  }
+  // Create the lazily created singletons before any thread needs them.
+  KmlFactory::GetFactory();
+  kmldom::Xsd::GetSchema();
+
+  ConvertGpxTask convert_gpx_task(gpx_filenames, kml_filenames,
+                                  max_track_size);
+  kmlbase::RunParallel(&convert_gpx_task, gpx_filenames.size(), num_threads);
+  if (errors) {
+    errors->swap(*convert_gpx_task.mutable_errors());
+  }
+  return convert_gpx_task.get_converted_count();
+}
+
+}  // end namespace kmlconvenience
@@ -0,0 +1,138 @@
+// Copyright 2008, Google Inc. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//  3. Neither the name of Google Inc. nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// This file contains the declaration of the GpxTrackReader class and the
+// GPX to <gx:Track> conversion functions built on it.
+
+#ifndef KML_CONVENIENCE_GPX_TRACK_READER_H__
+#define KML_CONVENIENCE_GPX_TRACK_READER_H__
+
+#include <vector>
+#include "expat.h"
+#include "kml/base/util.h"
+#include "kml/dom.h"
+
+namespace kmlconvenience {
+
+// A GpxTrackHandler is given each <gx:Track> a GpxTrackReader makes.
+class GpxTrackHandler {
+ public:
+  virtual ~GpxTrackHandler() {}
+
+  // This is called as soon as each track is complete.  The track_name is
+  // the <name> of the enclosing <trk> if it had one.  The handler owns the
+  // gx_track from this point: the reader keeps no reference to it.
+  virtual void HandleTrack(const string& track_name,
+                           const kmldom::GxTrackPtr& gx_track) = 0;
+};
+
+// A GpxTrackReader streams a GPX file and makes a <gx:Track> of each
+// <trkseg>.  The lat and lon attributes and the <ele> and <time> of each
+// <trkpt> are decoded straight into the columns of the track being built.
+// Nothing is allocated per point once the columns have grown.  Each track
+// goes to the GpxTrackHandler at its </trkseg>, so the memory held is that
+// of the one track being built.  A max_track_size bounds that too: a longer
+// <trkseg> is handed over in tracks of at most that many points.  A <trkpt>
+// with no <time> has an empty <when>.  A track is absolute only if every
+// <trkpt> in it has an <ele>, else it has no altitudeMode and so is clamped
+// to the ground.  All other GPX elements are ignored.
+// Usage:
+//   class MyTrackHandler : public GpxTrackHandler { ... };
+//   MyTrackHandler my_track_handler;
+//   GpxTrackReader gpx_track_reader(&my_track_handler, 0);
+//   if (!gpx_track_reader.ReadFile("track.gpx", &errors)) { ... }
+class GpxTrackReader {
+ public:
+  // A max_track_size of 0 means a whole <trkseg> is always one track.
+  GpxTrackReader(GpxTrackHandler* gpx_track_handler, size_t max_track_size);
+  ~GpxTrackReader();
+
+  // This parses the next size bytes of the GPX file.  The chunks need not
+  // break at element boundaries.  Set is_final on the last chunk.  False is
+  // returned on any XML error which is described in errors if supplied.
+  bool Parse(const char* data, size_t size, bool is_final, string* errors);
+
+  // This parses the whole of the given GPX file reading it a chunk at a
+  // time.
+  bool ReadFile(const string& filename, string* errors);
+
+  // The number of points read so far: <trkpt>'s with a lat and a lon.
+  size_t get_point_count() const {
+    return point_count_;
+  }
+
+ private:
+  static void XMLCALL StartElement(void* user_data, const XML_Char* name,
+                                   const XML_Char** atts);
+  static void XMLCALL EndElement(void* user_data, const XML_Char* name);
+  static void XMLCALL CharData(void* user_data, const XML_Char* data,
+                               int length);
+  void StartTrkPt(const XML_Char** atts);
+  void EndTrkPt();
+  void FlushTrack();
+
+  GpxTrackHandler* gpx_track_handler_;
+  const size_t max_track_size_;
+  XML_Parser parser_;
+  kmldom::GxTrackPtr gx_track_;
+  string track_name_;
+  bool in_trk_;
+  bool in_trkpt_;
+  bool has_point_;
+  bool has_ele_;
+  // True until a <trkpt> of the track being built has no <ele>.
+  bool track_has_ele_;
+  double longitude_;
+  double latitude_;
+  double altitude_;
+  // The <time>, <ele> or <trk>'s <name> being read, reused for each.
+  bool gather_char_data_;
+  string char_data_;
+  string time_;
+  size_t point_count_;
+  LIBKML_DISALLOW_EVIL_CONSTRUCTORS(GpxTrackReader);
+};
+
+// This converts the given GPX file to a KML file of a <Document> holding a
+// <Placemark> of each <gx:Track> as read by GpxTrackReader.  The KML file is
+// written as each track completes so neither file is held in memory.  False
+// is returned if either file cannot be opened or the GPX is not well formed
+// in which case errors describes the problem if supplied.
+bool ConvertGpxToKml(const string& gpx_filename, const string& kml_filename,
+                     size_t max_track_size, string* errors);
+
+// This runs ConvertGpxToKml() over each pair of GPX and KML files on up to
+// num_threads threads.  A num_threads of 0 means one per processor.  The
+// return value is the number of files converted.  If an errors vector is
+// supplied it is set to one string for each file, empty if that file was
+// converted.
+size_t ConvertGpxFilesToKml(const std::vector<string>& gpx_filenames,
+                            const std::vector<string>& kml_filenames,
+                            size_t max_track_size, unsigned int num_threads,
+                            std::vector<string>* errors);
+
+}  // end namespace kmlconvenience
+
+#endif  // KML_CONVENIENCE_GPX_TRACK_READER_H__
@@ -0,0 +1,248 @@
+// Copyright 2008, Google Inc. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//  3. Neither the name of Google Inc. nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// This file contains the unit tests for the GpxTrackReader class and the
+// GPX to KML conversion functions.
+
+#include "kml/convenience/gpx_track_reader.h"
+#include "boost/scoped_ptr.hpp"
+#include "kml/base/file.h"
+#include "kml/base/tempfile.h"
+#include "kml/engine/kml_file.h"
+#include "gtest/gtest.h"
+
+// The following define is a convenience for testing inside Google.
+#ifdef GOOGLE_INTERNAL
+#include "kml/base/google_internal_test.h"
+#endif
+
+#ifndef DATADIR
+#error *** DATADIR must be defined! ***
+#endif
+
+using kmldom::GxTrackPtr;
+
+namespace kmlconvenience {
+
+// This saves each track handed to it.
+class TestGpxTrackHandler : public GpxTrackHandler {
+ public:
+  virtual void HandleTrack(const string& track_name,
+                           const GxTrackPtr& gx_track) {
+    names_.push_back(track_name);
+    tracks_.push_back(gx_track);
+  }
+
+  std::vector<string> names_;
+  std::vector<GxTrackPtr> tracks_;
+};
+
+class GpxTrackReaderTest : public testing::Test {
+ protected:
+  bool ParseGpx(const string& gpx, size_t max_track_size) {
+    GpxTrackReader gpx_track_reader(&handler_, max_track_size);
+    return gpx_track_reader.Parse(gpx.data(), gpx.size(), true, &errors_);
+  }
+
+  TestGpxTrackHandler handler_;
+  string errors_;
+};
+
+static const char kTwoSegments[] =
+  "<gpx xmlns=\"http://www.topografix.com/GPX/1/1\">"
+  "<metadata><name>not a track</name><time>2008-10-11T18:27:47Z</time>"
+  "</metadata>"
+  "<trk><name>Morning</name>"
+  "<trkseg>"
+  "<trkpt lat=\"39.25\" lon=\"-106.5\"><ele>3012.5</ele>"
+  "<time>2007-09-16T19:22:00Z</time><name>a waypoint name</name></trkpt>"
+  "<trkpt lat=\"39.5\" lon=\"-106.25\"><ele>3011.5</ele>"
+  "<time>2007-09-16T19:22:03Z</time></trkpt>"
+  "</trkseg>"
+  "<trkseg>"
+  "<trkpt lat=\"40\" lon=\"-105\"></trkpt>"
+  "<trkpt lon=\"-105\"><time>2007-09-16T19:22:09Z</time></trkpt>"
+  "</trkseg>"
+  "</trk>"
+  "</gpx>";
+
+// Verify that each <trkseg> becomes a <gx:Track> of its <trkpt>'s.
+TEST_F(GpxTrackReaderTest, TestTrackPerSegment) {
+  ASSERT_TRUE(ParseGpx(kTwoSegments, 0));
+  ASSERT_EQ(static_cast<size_t>(2), handler_.tracks_.size());
+  ASSERT_EQ(string("Morning"), handler_.names_[0]);
+  ASSERT_EQ(string("Morning"), handler_.names_[1]);
+
+  const GxTrackPtr& first = handler_.tracks_[0];
+  ASSERT_EQ(static_cast<size_t>(2), first->get_when_array_size());
+  ASSERT_EQ(static_cast<size_t>(2), first->get_gx_coord_array_size());
+  ASSERT_EQ(1189970520, first->get_when_time_at(0));
+  ASSERT_EQ(1189970523, first->get_when_time_at(1));
+  ASSERT_EQ(-106.5, first->get_gx_coord_longitudes()[0]);
+  ASSERT_EQ(39.5, first->get_gx_coord_latitudes()[1]);
+  ASSERT_EQ(3011.5, first->get_gx_coord_altitudes()[1]);
+  ASSERT_EQ(kmldom::ALTITUDEMODE_ABSOLUTE, first->get_altitudemode());
+
+  // A <trkpt> with no lon is skipped and one with no <time> or <ele> has an
+  // empty <when> and altitude 0.
+  const GxTrackPtr& second = handler_.tracks_[1];
+  ASSERT_EQ(static_cast<size_t>(1), second->get_when_array_size());
+  ASSERT_EQ(string(), second->get_when_array_at(0));
+  ASSERT_FALSE(second->has_when_time_at(0));
+  ASSERT_EQ(0.0, second->get_gx_coord_altitudes()[0]);
+  ASSERT_FALSE(second->has_altitudemode());
+}
+
+// Verify that a track is absolute only if each of its points has an <ele>.
+TEST_F(GpxTrackReaderTest, TestMissingEle) {
+  ASSERT_TRUE(ParseGpx(
+      "<gpx><trk>"
+      "<trkseg>"
+      "<trkpt lat=\"39\" lon=\"-106\"><ele>3012.5</ele></trkpt>"
+      "<trkpt lat=\"40\" lon=\"-105\"></trkpt>"
+      "</trkseg>"
+      "<trkseg>"
+      "<trkpt lat=\"39\" lon=\"-106\"></trkpt>"
+      "<trkpt lat=\"40\" lon=\"-105\"><ele>3011.5</ele></trkpt>"
+      "</trkseg>"
+      "<trkseg>"
+      "<trkpt lat=\"39\" lon=\"-106\"><ele>0</ele></trkpt>"
+      "</trkseg>"
+      "</trk></gpx>", 0));
+  ASSERT_EQ(static_cast<size_t>(3), handler_.tracks_.size());
+  ASSERT_FALSE(handler_.tracks_[0]->has_altitudemode());
+  ASSERT_EQ(0.0, handler_.tracks_[0]->get_gx_coord_altitudes()[1]);
+  ASSERT_FALSE(handler_.tracks_[1]->has_altitudemode());
+  ASSERT_EQ(kmldom::ALTITUDEMODE_ABSOLUTE,
+            handler_.tracks_[2]->get_altitudemode());
+
+  // Each track split by a max_track_size is judged on its own points.
+  handler_.tracks_.clear();
+  handler_.names_.clear();
+  ASSERT_TRUE(ParseGpx(
+      "<gpx><trk><trkseg>"
+      "<trkpt lat=\"39\" lon=\"-106\"><ele>3012.5</ele></trkpt>"
+      "<trkpt lat=\"40\" lon=\"-105\"></trkpt>"
+      "</trkseg></trk></gpx>", 1));
+  ASSERT_EQ(static_cast<size_t>(2), handler_.tracks_.size());
+  ASSERT_EQ(kmldom::ALTITUDEMODE_ABSOLUTE,
+            handler_.tracks_[0]->get_altitudemode());
+  ASSERT_FALSE(handler_.tracks_[1]->has_altitudemode());
+}
+
+// Verify that a max_track_size splits a long <trkseg>.
+TEST_F(GpxTrackReaderTest, TestMaxTrackSize) {
+  ASSERT_TRUE(ParseGpx(kTwoSegments, 1));
+  ASSERT_EQ(static_cast<size_t>(3), handler_.tracks_.size());
+  for (size_t i = 0; i < handler_.tracks_.size(); ++i) {
+    ASSERT_EQ(static_cast<size_t>(1),
+              handler_.tracks_[i]->get_gx_coord_array_size());
+  }
+}
+
+// Verify that the chunks may split anywhere.
+TEST_F(GpxTrackReaderTest, TestChunks) {
+  const string gpx(kTwoSegments);
+  GpxTrackReader gpx_track_reader(&handler_, 0);
+  for (size_t i = 0; i < gpx.size(); i += 7) {
+    const size_t size = std::min(static_cast<size_t>(7), gpx.size() - i);
+    ASSERT_TRUE(gpx_track_reader.Parse(gpx.data() + i, size,
+                                       i + size == gpx.size(), &errors_));
+  }
+  ASSERT_EQ(static_cast<size_t>(3), gpx_track_reader.get_point_count());
+  ASSERT_EQ(static_cast<size_t>(2), handler_.tracks_.size());
+  ASSERT_EQ(1189970523, handler_.tracks_[0]->get_when_time_at(1));
+}
+
+TEST_F(GpxTrackReaderTest, TestBadXml) {
+  ASSERT_FALSE(ParseGpx("<gpx><trk>", 0));
+  ASSERT_FALSE(errors_.empty());
+  errors_.clear();
+  ASSERT_FALSE(ParseGpx("<!DOCTYPE gpx [ <!ENTITY a \"b\"> ]><gpx/>", 0));
+  ASSERT_FALSE(errors_.empty());
+}
+
+// Verify the reader on a real-world GPX file.
+TEST_F(GpxTrackReaderTest, TestReadFile) {
+  GpxTrackReader gpx_track_reader(&handler_, 0);
+  ASSERT_TRUE(gpx_track_reader.ReadFile(string(DATADIR) + "/gpx/trkpts.gpx",
+                                        &errors_));
+  ASSERT_EQ(static_cast<size_t>(143), gpx_track_reader.get_point_count());
+  ASSERT_EQ(static_cast<size_t>(2), handler_.tracks_.size());
+  ASSERT_EQ(string("ACTIVE LOG #2"), handler_.names_[0]);
+  ASSERT_EQ(string("ACTIVE LOG #3"), handler_.names_[1]);
+  ASSERT_EQ(static_cast<size_t>(104),
+            handler_.tracks_[0]->get_when_array_size());
+  ASSERT_EQ(static_cast<size_t>(39),
+            handler_.tracks_[1]->get_when_array_size());
+  const GxTrackPtr& first = handler_.tracks_[0];
+  ASSERT_EQ(string("2007-09-16T19:22:00Z"), first->get_when_array_at(0));
+  ASSERT_EQ(39.235658487, first->get_gx_coord_latitudes()[0]);
+  ASSERT_EQ(-106.315917922, first->get_gx_coord_longitudes()[0]);
+  ASSERT_EQ(3012.428223, first->get_gx_coord_altitudes()[0]);
+
+  GpxTrackReader missing_file_reader(&handler_, 0);
+  ASSERT_FALSE(missing_file_reader.ReadFile(string(DATADIR) + "/nope.gpx",
+                                            &errors_));
+}
+
+// Verify that the converted KML parses back to the same tracks.
+TEST_F(GpxTrackReaderTest, TestConvertGpxFilesToKml) {
+  kmlbase::TempFilePtr first = kmlbase::TempFile::CreateTempFile();
+  kmlbase::TempFilePtr second = kmlbase::TempFile::CreateTempFile();
+  ASSERT_TRUE(first && second);
+  std::vector<string> gpx_filenames;
+  std::vector<string> kml_filenames;
+  gpx_filenames.push_back(string(DATADIR) + "/gpx/trkpts.gpx");
+  kml_filenames.push_back(first->name());
+  gpx_filenames.push_back(string(DATADIR) + "/gpx/nope.gpx");
+  kml_filenames.push_back(second->name());
+  std::vector<string> errors;
+  ASSERT_EQ(static_cast<size_t>(1),
+            ConvertGpxFilesToKml(gpx_filenames, kml_filenames, 0, 2,
+                                 &errors));
+  ASSERT_EQ(static_cast<size_t>(2), errors.size());
+  ASSERT_TRUE(errors[0].empty());
+  ASSERT_FALSE(errors[1].empty());
+
+  string kml;
+  ASSERT_TRUE(kmlbase::File::ReadFileToString(first->name(), &kml));
+  kmlengine::KmlFilePtr kml_file =
+      kmlengine::KmlFile::CreateFromParse(kml, &errors_);
+  ASSERT_TRUE(kml_file) << errors_;
+  const kmldom::DocumentPtr document =
+      kmldom::AsDocument(kmldom::AsKml(kml_file->get_root())->get_feature());
+  ASSERT_TRUE(document);
+  ASSERT_EQ(static_cast<size_t>(2), document->get_feature_array_size());
+  const kmldom::PlacemarkPtr placemark =
+      kmldom::AsPlacemark(document->get_feature_array_at(1));
+  ASSERT_EQ(string("ACTIVE LOG #3"), placemark->get_name());
+  const GxTrackPtr gx_track = kmldom::AsGxTrack(placemark->get_geometry());
+  ASSERT_TRUE(gx_track);
+  ASSERT_EQ(static_cast<size_t>(39), gx_track->get_gx_coord_array_size());
+  ASSERT_EQ(kmldom::ALTITUDEMODE_ABSOLUTE, gx_track->get_altitudemode());
+}
+
+}  // end namespace kmlconvenience
@@ -28,9 +28,8 @@
 #ifndef KML_CONVENIENCE_GPX_TRK_PT_HANDLER_H__
 #define KML_CONVENIENCE_GPX_TRK_PT_HANDLER_H__
 
-#include <cstring>  // strcmp
-#include "boost/scoped_ptr.hpp"
-#include "kml/base/attributes.h"
+#include <stdlib.h>  // strtod
+#include <vector>
 #include "kml/base/expat_handler.h"
 #include "kml/base/vec3.h"
 
@@ -47,24 +46,31 @@ namespace kmlconvenience {
 // HandlePoint().
 class GpxTrkPtHandler : public kmlbase::ExpatHandler {
  public:
+  GpxTrkPtHandler()
+    : has_point_(false),
+      gather_char_data_(false) {
+  }
 
   // ExpatHandler::StartElement()
   virtual void StartElement(const string& name,
                             const std::vector <string>& atts) {
     if (name.compare("trkpt") == 0) {
       // <trkpt lat="-33.911973070" lon="18.422974152">
-      // If both lat and lon exist and are sane doubles create a Vec3 for
-      // the point.
-      boost::scoped_ptr<kmlbase::Attributes> attributes(
-          kmlbase::Attributes::Create(atts));
-      if (attributes.get()) {
-        double latitude;
-        double longitude;
-        if (attributes->GetDouble("lat", &latitude) &&
-            attributes->GetDouble("lon", &longitude)) {
-          vec3_.reset(new kmlbase::Vec3(longitude, latitude));
+      // If both lat and lon exist and are sane doubles this is a point.
+      // The attributes are read in place to save creating an Attributes.
+      bool has_latitude = false;
+      bool has_longitude = false;
+      double latitude = 0;
+      double longitude = 0;
+      for (size_t i = 0; i + 1 < atts.size(); i += 2) {
+        if (atts[i].compare("lat") == 0) {
+          has_latitude = ParseDouble(atts[i + 1], &latitude);
+        } else if (atts[i].compare("lon") == 0) {
+          has_longitude = ParseDouble(atts[i + 1], &longitude);
         }
       }
+      has_point_ = has_latitude && has_longitude;
+      vec3_ = kmlbase::Vec3(longitude, latitude);
       time_.clear();
     } else if (name.compare("time") == 0  ||
                name.compare("ele") == 0) {
@@ -79,18 +85,21 @@ class GpxTrkPtHandler : public kmlbase::ExpatHandler {
   virtual void EndElement(const string& name) {
     if (name.compare("trkpt") == 0) {
       // </trkpt>
-      // If a Vec3 was created for this element call the handler.
-      if (vec3_.get()) {
-        HandlePoint(*vec3_, time_);
+      // If this <trkpt> had a point call the handler.
+      if (has_point_) {
+        HandlePoint(vec3_, time_);
       }
+      has_point_ = false;
     } else if (name.compare("time") == 0) {
       // <time>2008-10-11T14:55:41Z</time>
       time_ = char_data_;
+      gather_char_data_ = false;
     } else if (name.compare("ele") == 0) {
       // <ele>4.943848</ele>
-      if (vec3_.get()) {
-        vec3_->set_altitude(strtod(char_data_.c_str(), NULL));
+      if (has_point_) {
+        vec3_.set_altitude(strtod(char_data_.c_str(), NULL));
       }
+      gather_char_data_ = false;
     }
   }
 
@@ -102,13 +111,21 @@ class GpxTrkPtHandler : public kmlbase::ExpatHandler {
   }
 
   // This is called for each <trkpt>.  This default implemenation does nothing.
+  // See GpxTrackReader in gpx_track_reader.h for reading whole tracks.
   virtual void HandlePoint(const kmlbase::Vec3& where,
                            const string& when) {
   };
 
  private:
-  // A fresh Vec3 is created for each <trkpt>.
-  boost::scoped_ptr<kmlbase::Vec3> vec3_;
+  static bool ParseDouble(const string& str, double* value) {
+    char* endp;
+    *value = strtod(str.c_str(), &endp);
+    return endp != str.c_str();
+  }
+
+  // The one Vec3 is reused for each <trkpt>.
+  kmlbase::Vec3 vec3_;
+  bool has_point_;
   string time_;
   bool gather_char_data_;
   string char_data_;
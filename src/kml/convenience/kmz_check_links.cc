@@ -27,6 +27,9 @@
 
 #include "kml/convenience/kmz_check_links.h"
 #include <vector>
+#include "boost/scoped_ptr.hpp"
+#include "kml/base/parallel.h"
+#include "kml/base/zip_file.h"
 #include "kml/engine/get_links.h"
 #include "kml/engine/href.h"
 #include "kml/engine/kmz_file.h"
@@ -38,13 +41,14 @@ using std::vector;
 namespace kmlconvenience {
 
 bool KmzCheckLinks(const KmzFile& kmzfile, vector<string>* missing_links) {
-  string kml;
-  if (!kmzfile.ReadKml(&kml)) {
+  boost::scoped_ptr<kmlbase::ZipEntryReader> kml_reader(
+      kmzfile.OpenKml(NULL));
+  if (!kml_reader.get()) {
     return false;
   }
 
   kmlengine::href_vector_t href_vector;
-  if (!kmlengine::GetLinks(kml, &href_vector)) {
+  if (!kmlengine::GetLinksFromZipEntry(kml_reader.get(), &href_vector)) {
     return false;  // Parse error.
   }
 
@@ -52,8 +56,7 @@ bool KmzCheckLinks(const KmzFile& kmzfile, vector<string>* missing_links) {
   for (size_t i = 0; i < href_vector.size(); ++i) {
     Href href(href_vector[i]);
     if (href.IsRelative()) {
-      string content;
-      if (!kmzfile.ReadFile(href.get_path().c_str(), &content)) {
+      if (!kmzfile.HasFile(href.get_path().c_str())) {
         if (missing_links) {
           missing_links->push_back(href_vector[i]);
         }
@@ -64,4 +67,52 @@ bool KmzCheckLinks(const KmzFile& kmzfile, vector<string>* missing_links) {
   return ret;
 }
 
+// Each Run() checks one file and writes only its own status and missing
+// files.
+class KmzCheckLinksTask : public kmlbase::ParallelTask {
+ public:
+  KmzCheckLinksTask(const vector<string>& kmz_filenames)
+    : kmz_filenames_(kmz_filenames),
+      status_(kmz_filenames.size(), 0),
+      missing_files_(kmz_filenames.size()) {
+  }
+
+  virtual void Run(size_t index) {
+    boost::scoped_ptr<KmzFile> kmz_file(
+        KmzFile::OpenFromFile(kmz_filenames_[index].c_str()));
+    status_[index] = kmz_file.get() &&
+        KmzCheckLinks(*kmz_file, &missing_files_[index]);
+  }
+
+  size_t get_passed_count() const {
+    size_t count = 0;
+    for (size_t i = 0; i < status_.size(); ++i) {
+      count += status_[i] ? 1 : 0;
+    }
+    return count;
+  }
+
+  vector<vector<string> >* mutable_missing_files() {
+    return &missing_files_;
+  }
+
+ private:
+  const vector<string>& kmz_filenames_;
+  // Note this is not a std::vector<bool> whose elements share storage.
+  vector<char> status_;
+  vector<vector<string> > missing_files_;
+};
+
+size_t KmzCheckLinksInFiles(const vector<string>& kmz_filenames,
+                            unsigned int num_threads,
+                            vector<vector<string> >* missing_files) {
+  KmzCheckLinksTask kmz_check_links_task(kmz_filenames);
+  kmlbase::RunParallel(&kmz_check_links_task, kmz_filenames.size(),
+                       num_threads);
+  if (missing_files) {
+    missing_files->swap(*kmz_check_links_task.mutable_missing_files());
+  }
+  return kmz_check_links_task.get_passed_count();
+}
+
 }  // end namespace kmlconvenience
@@ -30,8 +30,21 @@ namespace kmlconvenience {
 
 // This returns true iff the KmzFile's relative links within the KMZ exist.
 // This returns false if there is no KML in the KmzFile.  If a missing_files
-// vector is supplied the names of all missing files are saved there.
+// vector is supplied the names of all missing files are saved there.  The
+// KML is scanned for links as it is inflated and no DOM is built.  Each
+// link is looked up in the table of contents of the KMZ: the files it names
+// are not inflated and so may exist but be unreadable.
 bool KmzCheckLinks(const kmlengine::KmzFile& kmzfile,
                    std::vector<string>* missing_files);
 
+// This runs KmzCheckLinks() over each of the given KMZ files on up to
+// num_threads threads.  A num_threads of 0 means one per processor.  The
+// return value is the number of files whose links all exist.  If a
+// missing_files vector is supplied it is set to one vector for each file
+// holding the missing files of that file.  A file that cannot be opened or
+// has no KML fails with no missing files.
+size_t KmzCheckLinksInFiles(const std::vector<string>& kmz_filenames,
+                            unsigned int num_threads,
+                            std::vector<std::vector<string> >* missing_files);
+
 }  // end namespace kmlconvenience
@@ -97,4 +97,44 @@ TEST_F(KmzCheckLinksTest, TestNull) {
   ASSERT_FALSE(KmzCheckLinks(*kmz_file_, NULL));
 }
 
+// Verify that KmzCheckLinks() looks up the links without reading the files.
+TEST_F(KmzCheckLinksTest, TestTocOnly) {
+  const string kPhotoLink = string(DATADIR) + "/kmz/zermatt-photo.kmz";
+  kmz_file_.reset(KmzFile::OpenFromFile(kPhotoLink.c_str()));
+  ASSERT_TRUE(kmz_file_);
+  // No file of the KMZ can now be read, but all are still there.
+  kmz_file_->set_max_uncompressed_file_size(1);
+  ASSERT_FALSE(kmz_file_->ReadFile("files/zermatt.jpg", NULL));
+  ASSERT_TRUE(KmzCheckLinks(*kmz_file_, NULL));
+}
+
+// Verify that KmzCheckLinksInFiles() checks each file as KmzCheckLinks()
+// would for any number of threads.
+TEST_F(KmzCheckLinksTest, TestKmzCheckLinksInFiles) {
+  vector<string> kmz_filenames;
+  kmz_filenames.push_back(string(DATADIR) + "/kmz/doc.kmz");
+  kmz_filenames.push_back(string(DATADIR) + "/kmz/zermatt-photo-bad.kmz");
+  kmz_filenames.push_back(string(DATADIR) + "/kmz/nokml.kmz");
+  kmz_filenames.push_back(string(DATADIR) + "/kmz/no-such-file.kmz");
+  kmz_filenames.push_back(string(DATADIR) + "/kmz/zermatt-photo.kmz");
+  const unsigned int kThreads[] = { 0, 1, 2, 8 };
+  for (size_t i = 0; i < sizeof(kThreads)/sizeof(kThreads[0]); ++i) {
+    vector<vector<string> > missing_files;
+    ASSERT_EQ(static_cast<size_t>(2),
+              KmzCheckLinksInFiles(kmz_filenames, kThreads[i],
+                                   &missing_files));
+    ASSERT_EQ(kmz_filenames.size(), missing_files.size());
+    ASSERT_TRUE(missing_files[0].empty());
+    ASSERT_EQ(static_cast<size_t>(1), missing_files[1].size());
+    ASSERT_EQ(string("files/zermatt.jpg"), missing_files[1][0]);
+    ASSERT_TRUE(missing_files[2].empty());
+    ASSERT_TRUE(missing_files[3].empty());
+    ASSERT_TRUE(missing_files[4].empty());
+  }
+  ASSERT_EQ(static_cast<size_t>(2),
+            KmzCheckLinksInFiles(kmz_filenames, 2, NULL));
+  ASSERT_EQ(static_cast<size_t>(0),
+            KmzCheckLinksInFiles(vector<string>(), 2, NULL));
+}
+
 }  // end namespace kmlconvenience
@@ -35,7 +35,10 @@
 #include "kml/dom/kml_ptr.h"
 #include "kml/dom/kmldom.h"
 #include "kml/dom/kml22.h"
+#include "kml/dom/parse_filter.h"
+#include "kml/dom/parse_profile.h"
 #include "kml/dom/parser_observer.h"
 #include "kml/dom/parser.h"
+#include "kml/dom/parser_session.h"
 
 #endif  // KML_DOM_H__
@@ -52,10 +52,12 @@ class AbstractLatLonBox : public Object {
     return has_north_;
   }
   void set_north(double north) {
+    MarkDirty();
     north_ = north;
     has_north_ = true;
   }
   void clear_north() {
+    MarkDirty();
     north_ = 180.0;
     has_north_ = false;
   }
@@ -68,10 +70,12 @@ class AbstractLatLonBox : public Object {
     return has_south_;
   }
   void set_south(double south) {
+    MarkDirty();
     south_ = south;
     has_south_ = true;
   }
   void clear_south() {
+    MarkDirty();
     south_ = -180.0;
     has_south_ = false;
   }
@@ -84,10 +88,12 @@ class AbstractLatLonBox : public Object {
     return has_east_;
   }
   void set_east(double south) {
+    MarkDirty();
     east_ = south;
     has_east_ = true;
   }
   void clear_east() {
+    MarkDirty();
     east_ = 180.0;
     has_east_ = false;
   }
@@ -100,10 +106,12 @@ class AbstractLatLonBox : public Object {
     return has_west_;
   }
   void set_west(double south) {
+    MarkDirty();
     west_ = south;
     has_west_ = true;
   }
   void clear_west() {
+    MarkDirty();
     west_ = -180.0;
     has_west_ = false;
   }
@@ -82,10 +82,12 @@ class AbstractViewCommon : public AbstractView {
     return has_longitude_;
   }
   void set_longitude(double longitude) {
+    MarkDirty();
     longitude_ = longitude;
     has_longitude_ = true;
   }
   void clear_longitude() {
+    MarkDirty();
     longitude_ = 0.0;
     has_longitude_ = false;
   }
@@ -98,10 +100,12 @@ class AbstractViewCommon : public AbstractView {
     return has_latitude_;
   }
   void set_latitude(double latitude) {
+    MarkDirty();
     latitude_ = latitude;
     has_latitude_ = true;
   }
   void clear_latitude() {
+    MarkDirty();
     latitude_ = 0.0;
     has_latitude_ = false;
   }
@@ -114,10 +118,12 @@ class AbstractViewCommon : public AbstractView {
     return has_altitude_;
   }
   void set_altitude(double altitude) {
+    MarkDirty();
     altitude_ = altitude;
     has_altitude_ = true;
   }
   void clear_altitude() {
+    MarkDirty();
     altitude_ = 0.0;
     has_altitude_ = false;
   }
@@ -130,10 +136,12 @@ class AbstractViewCommon : public AbstractView {
     return has_heading_;
   }
   void set_heading(double heading) {
+    MarkDirty();
     heading_ = heading;
     has_heading_ = true;
   }
   void clear_heading() {
+    MarkDirty();
     heading_ = 0.0;
     has_heading_ = false;
   }
@@ -146,10 +154,12 @@ class AbstractViewCommon : public AbstractView {
     return has_tilt_;
   }
   void set_tilt(double tilt) {
+    MarkDirty();
     tilt_ = tilt;
     has_tilt_ = true;
   }
   void clear_tilt() {
+    MarkDirty();
     tilt_ = 0.0;
     has_tilt_ = false;
   }
@@ -162,10 +172,12 @@ class AbstractViewCommon : public AbstractView {
     return has_altitudemode_;
   }
   void set_altitudemode(int altitudemode) {
+    MarkDirty();
     altitudemode_ = altitudemode;
     has_altitudemode_ = true;
   }
   void clear_altitudemode() {
+    MarkDirty();
     altitudemode_ = ALTITUDEMODE_CLAMPTOGROUND;
     has_altitudemode_ = false;
   }
@@ -180,10 +192,12 @@ class AbstractViewCommon : public AbstractView {
     return has_gx_altitudemode_;
   }
   void set_gx_altitudemode(int gx_altitudemode) {
+    MarkDirty();
     gx_altitudemode_ = gx_altitudemode;
     has_gx_altitudemode_ = true;
   }
   void clear_gx_altitudemode() {
+    MarkDirty();
     gx_altitudemode_ = GX_ALTITUDEMODE_CLAMPTOSEAFLOOR;
     has_gx_altitudemode_ = false;
   }
@@ -231,10 +245,12 @@ class LookAt : public AbstractViewCommon {
     return has_range_;
   }
   void set_range(double range) {
+    MarkDirty();
     range_ = range;
     has_range_ = true;
   }
   void clear_range() {
+    MarkDirty();
     range_ = 0.0;
     has_range_ = false;
   }
@@ -271,10 +287,12 @@ class Camera : public AbstractViewCommon {
     return has_roll_;
   }
   void set_roll(double roll) {
+    MarkDirty();
     roll_ = roll;
     has_roll_ = true;
   }
   void clear_roll() {
+    MarkDirty();
     roll_ = 0.0;
     has_roll_ = false;
   }
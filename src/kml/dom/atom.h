@@ -42,10 +42,12 @@ class AtomAuthor : public BasicElement<Type_AtomAuthor> {
   const string& get_name() const { return name_; }
   bool has_name() const { return has_name_; }
   void set_name(const string& value) {
+    MarkDirty();
     name_ = value;
     has_name_ = true;
   }
   void clear_name() {
+    MarkDirty();
     name_.clear();
     has_name_ = false;
   }
@@ -54,10 +56,12 @@ class AtomAuthor : public BasicElement<Type_AtomAuthor> {
   const string& get_uri() const { return uri_; }
   bool has_uri() const { return has_uri_; }
   void set_uri(const string& value) {
+    MarkDirty();
     uri_ = value;
     has_uri_ = true;
   }
   void clear_uri() {
+    MarkDirty();
     uri_.clear();
     has_uri_ = false;
   }
@@ -66,10 +70,12 @@ class AtomAuthor : public BasicElement<Type_AtomAuthor> {
   const string& get_email() const { return email_; }
   bool has_email() const { return has_email_; }
   void set_email(const string& value) {
+    MarkDirty();
     email_ = value;
     has_email_ = true;
   }
   void clear_email() {
+    MarkDirty();
     email_.clear();
     has_email_ = false;
   }
@@ -97,10 +103,12 @@ class AtomCommon : public Element {
   const string& get_id() const { return id_; }
   bool has_id() const { return has_id_; }
   void set_id(const string& value) {
+    MarkDirty();
     id_ = value;
     has_id_ = true;
   }
   void clear_id() {
+    MarkDirty();
     id_.clear();
     has_id_ = false;
   }
@@ -109,10 +117,12 @@ class AtomCommon : public Element {
   const string& get_title() const { return title_; }
   bool has_title() const { return has_title_; }
   void set_title(const string& value) {
+    MarkDirty();
     title_ = value;
     has_title_ = true;
   }
   void clear_title() {
+    MarkDirty();
     title_.clear();
     has_title_ = false;
   }
@@ -121,10 +131,12 @@ class AtomCommon : public Element {
   const string& get_updated() const { return updated_; }
   bool has_updated() const { return has_updated_; }
   void set_updated(const string& value) {
+    MarkDirty();
     updated_ = value;
     has_updated_ = true;
   }
   void clear_updated() {
+    MarkDirty();
     updated_.clear();
     has_updated_ = false;
   }
@@ -177,10 +189,12 @@ class AtomCategory : public BasicElement<Type_AtomCategory> {
   const string& get_term() const { return term_; }
   bool has_term() const { return has_term_; }
   void set_term(const string& value) {
+    MarkDirty();
     term_ = value;
     has_term_ = true;
   }
   void clear_term() {
+    MarkDirty();
     term_.clear();
     has_term_ = false;
   }
@@ -189,10 +203,12 @@ class AtomCategory : public BasicElement<Type_AtomCategory> {
   const string& get_scheme() const { return scheme_; }
   bool has_scheme() const { return has_scheme_; }
   void set_scheme(const string& value) {
+    MarkDirty();
     scheme_ = value;
     has_scheme_ = true;
   }
   void clear_scheme() {
+    MarkDirty();
     scheme_.clear();
     has_scheme_ = false;
   }
@@ -201,10 +217,12 @@ class AtomCategory : public BasicElement<Type_AtomCategory> {
   const string& get_label() const { return label_; }
   bool has_label() const { return has_label_; }
   void set_label(const string& value) {
+    MarkDirty();
     label_ = value;
     has_label_ = true;
   }
   void clear_label() {
+    MarkDirty();
     label_.clear();
     has_label_ = false;
   }
@@ -237,10 +255,12 @@ class AtomContent : public BasicElement<Type_AtomContent> {
   const string& get_src() const { return src_; }
   bool has_src() const { return has_src_; }
   void set_src(const string& value) {
+    MarkDirty();
     src_ = value;
     has_src_ = true;
   }
   void clear_src() {
+    MarkDirty();
     src_.clear();
     has_src_ = false;
   }
@@ -249,10 +269,12 @@ class AtomContent : public BasicElement<Type_AtomContent> {
   const string& get_type() const { return type_; }
   bool has_type() const { return has_type_; }
   void set_type(const string& value) {
+    MarkDirty();
     type_ = value;
     has_type_ = true;
   }
   void clear_type() {
+    MarkDirty();
     type_.clear();
     has_type_ = false;
   }
@@ -290,10 +312,12 @@ class AtomEntry : public AtomCommon {
   const string& get_summary() const { return summary_; }
   bool has_summary() const { return has_summary_; }
   void set_summary(const string& value) {
+    MarkDirty();
     summary_ = value;
     has_summary_ = true;
   }
   void clear_summary() {
+    MarkDirty();
     summary_.clear();
     has_summary_ = false;
   }
@@ -364,10 +388,12 @@ class AtomLink : public BasicElement<Type_AtomLink> {
   const string& get_href() const { return href_; }
   bool has_href() const { return has_href_; }
   void set_href(const string& value) {
+    MarkDirty();
     href_ = value;
     has_href_ = true;
   }
   void clear_href() {
+    MarkDirty();
     href_.clear();
     has_href_ = false;
   }
@@ -376,10 +402,12 @@ class AtomLink : public BasicElement<Type_AtomLink> {
   const string& get_rel() const { return rel_; }
   bool has_rel() const { return has_rel_; }
   void set_rel(const string& value) {
+    MarkDirty();
     rel_ = value;
     has_rel_ = true;
   }
   void clear_rel() {
+    MarkDirty();
     rel_.clear();
     has_rel_ = false;
   }
@@ -388,10 +416,12 @@ class AtomLink : public BasicElement<Type_AtomLink> {
   const string& get_type() const { return type_; }
   bool has_type() const { return has_type_; }
   void set_type(const string& value) {
+    MarkDirty();
     type_ = value;
     has_type_ = true;
   }
   void clear_type() {
+    MarkDirty();
     type_.clear();
     has_type_ = false;
   }
@@ -400,10 +430,12 @@ class AtomLink : public BasicElement<Type_AtomLink> {
   const string& get_hreflang() const { return hreflang_; }
   bool has_hreflang() const { return has_hreflang_; }
   void set_hreflang(const string& value) {
+    MarkDirty();
     hreflang_ = value;
     has_hreflang_ = true;
   }
   void clear_hreflang() {
+    MarkDirty();
     hreflang_.clear();
     has_hreflang_ = false;
   }
@@ -412,10 +444,12 @@ class AtomLink : public BasicElement<Type_AtomLink> {
   const string& get_title() const { return title_; }
   bool has_title() const { return has_title_; }
   void set_title(const string& value) {
+    MarkDirty();
     title_ = value;
     has_title_ = true;
   }
   void clear_title() {
+    MarkDirty();
     title_.clear();
     has_title_ = false;
   }
@@ -424,10 +458,12 @@ class AtomLink : public BasicElement<Type_AtomLink> {
   int get_length() const { return length_; }
   bool has_length() const { return has_length_; }
   void set_length(const int value) {
+    MarkDirty();
     length_ = value;
     has_length_ = true;
   }
   void clear_length() {
+    MarkDirty();
     length_ = 0;
     has_length_ = false;
   }
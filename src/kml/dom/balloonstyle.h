@@ -52,10 +52,12 @@ class BalloonStyle : public SubStyle {
     return has_bgcolor_;
   }
   void set_bgcolor(const kmlbase::Color32& bgcolor) {
+    MarkDirty();
     bgcolor_ = bgcolor;
     has_bgcolor_ = true;
   }
   void clear_bgcolor() {
+    MarkDirty();
     bgcolor_ = kmlbase::Color32(0xffffffff);
     has_bgcolor_ = false;
   }
@@ -68,10 +70,12 @@ class BalloonStyle : public SubStyle {
     return has_textcolor_;
   }
   void set_textcolor(const kmlbase::Color32& textcolor) {
+    MarkDirty();
     textcolor_ = textcolor;
     has_textcolor_ = true;
   }
   void clear_textcolor() {
+    MarkDirty();
     textcolor_ = kmlbase::Color32(0xff000000);
     has_textcolor_ = false;
   }
@@ -84,10 +88,12 @@ class BalloonStyle : public SubStyle {
     return has_text_;
   }
   void set_text(const string& text) {
+    MarkDirty();
     text_ = text;
     has_text_ = true;
   }
   void clear_text() {
+    MarkDirty();
     text_.clear();
     has_text_ = false;
   }
@@ -100,10 +106,12 @@ class BalloonStyle : public SubStyle {
     return has_displaymode_;
   }
   void set_displaymode(int displaymode) {
+    MarkDirty();
     displaymode_ = displaymode;
     has_displaymode_ = true;
   }
   void clear_displaymode() {
+    MarkDirty();
     displaymode_ = DISPLAYMODE_DEFAULT;
     has_displaymode_ = false;
   }
@@ -53,10 +53,12 @@ class ColorStyle : public SubStyle {
     return has_color_;
   }
   void set_color(const kmlbase::Color32& color) {
+    MarkDirty();
     color_ = color;
     has_color_ = true;
   }
   void clear_color() {
+    MarkDirty();
     color_ = kmlbase::Color32(0xffffffff);
     has_color_ = false;
   }
@@ -69,10 +71,12 @@ class ColorStyle : public SubStyle {
     return has_colormode_;
   }
   void set_colormode(int colormode) {
+    MarkDirty();
     colormode_ = colormode;
     has_colormode_ = true;
   }
   void clear_colormode() {
+    MarkDirty();
     colormode_ = COLORMODE_NORMAL;
     has_colormode_ = false;
   }
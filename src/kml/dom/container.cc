@@ -26,6 +26,7 @@
 // This file contains the implementation of the abstract Container element.
 
 #include "kml/dom/container.h"
+#include <algorithm>
 #include "kml/dom/feature.h"
 #include "kml/dom/kml_cast.h"
 #include "kml/dom/kml_ptr.h"
@@ -70,6 +71,7 @@ FeaturePtr Container::DeleteFeatureById(const string& id) {
     FeaturePtr feature = *iter;
     if (feature->has_id() && id == feature->get_id()) {
   // TODO: if Container is in a KmlFile remove Feature from object map
+      MarkDirty();
       feature_array_.erase(iter);
       return feature;
     }
@@ -78,9 +80,35 @@ FeaturePtr Container::DeleteFeatureById(const string& id) {
 }
 
 FeaturePtr Container::DeleteFeatureAt(size_t i) {
+  MarkDirty();
   return Element::DeleteFromArrayAt(&feature_array_, i);
 }
 
+size_t Container::DeleteFeatures(const std::vector<FeaturePtr>& features) {
+  std::vector<const Feature*> doomed;
+  doomed.reserve(features.size());
+  for (size_t i = 0; i < features.size(); ++i) {
+    doomed.push_back(features[i].get());
+  }
+  std::sort(doomed.begin(), doomed.end());
+  size_t kept = 0;
+  for (size_t i = 0; i < feature_array_.size(); ++i) {
+    if (!std::binary_search(doomed.begin(), doomed.end(),
+                            feature_array_[i].get())) {
+      if (kept != i) {
+        feature_array_[kept] = feature_array_[i];
+      }
+      ++kept;
+    }
+  }
+  const size_t deleted = feature_array_.size() - kept;
+  if (deleted > 0) {
+    MarkDirty();
+  }
+  feature_array_.resize(kept);
+  return deleted;
+}
+
 void Container::AcceptChildren(VisitorDriver* driver) {
   Feature::AcceptChildren(driver);
   Element::AcceptRepeated<FeaturePtr>(&feature_array_, driver);
@@ -75,6 +75,12 @@ class Container : public Feature {
   // comments about DeleteFeature*().
   FeaturePtr DeleteFeatureAt(size_t index);
 
+  // Delete each of the given Features found in the Container in a single
+  // pass over the Container's Features.  The order of the remaining Features
+  // is preserved.  This returns the number of Features deleted.  See above
+  // for general comments about DeleteFeature*().
+  size_t DeleteFeatures(const std::vector<FeaturePtr>& features);
+
   // Visitor API methods, see visitor.h.
   virtual void AcceptChildren(VisitorDriver* driver);
 
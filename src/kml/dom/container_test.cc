@@ -138,6 +138,35 @@ TEST_F(ContainerTest, TestDeleteFeatureByIdMany) {
   // TODO: Verify deleted features are dis-parented.
 }
 
+TEST_F(ContainerTest, TestDeleteFeatures) {
+  const size_t kNumFeatures(100);
+  std::vector<FeaturePtr> features;
+  for (size_t i = 0; i < kNumFeatures; ++i) {
+    features.push_back(CreateFeature(i));
+    container_->add_feature(features.back());
+  }
+  // Delete every third Feature, a Feature not in the Container and one
+  // Feature twice.
+  std::vector<FeaturePtr> doomed;
+  for (size_t i = 0; i < kNumFeatures; i += 3) {
+    doomed.push_back(features[i]);
+  }
+  doomed.push_back(CreateFeature(kNumFeatures));
+  doomed.push_back(features[0]);
+  ASSERT_EQ(static_cast<size_t>(34), container_->DeleteFeatures(doomed));
+  ASSERT_EQ(static_cast<size_t>(66), container_->get_feature_array_size());
+  // The remaining Features are in their original order.
+  size_t j = 0;
+  for (size_t i = 0; i < kNumFeatures; ++i) {
+    if (i % 3 != 0) {
+      ASSERT_EQ(features[i], container_->get_feature_array_at(j++));
+    }
+  }
+  ASSERT_EQ(static_cast<size_t>(0), container_->DeleteFeatures(doomed));
+  ASSERT_EQ(static_cast<size_t>(0),
+            container_->DeleteFeatures(std::vector<FeaturePtr>()));
+}
+
 TEST_F(ContainerTest, TestDeleteFeatureAt) {
   const size_t kNumFeatures(123);
   for (size_t i = 0; i < kNumFeatures; ++i) {
@@ -60,6 +60,7 @@ class Document : public Container {
   }
 
   SchemaPtr DeleteSchemaAt(size_t index) {
+    MarkDirty();
     return Element::DeleteFromArrayAt(&schema_array_, index);
   }
 
@@ -77,6 +78,7 @@ class Document : public Container {
   }
 
   StyleSelectorPtr DeleteStyleSelectorAt(size_t index) {
+    MarkDirty();
     return Element::DeleteFromArrayAt(&styleselector_array_, index);
   }
 
@@ -50,17 +50,32 @@ Element::~Element() {
 }
 
 // Anything reaching this level is an known (KML) element found in an illegal
-// position during parse. We will store it for later serialiation.
+// position during parse. We will store it for later serialiation.  The
+// element becomes a child of this one unless it already has a parent (as
+// the Feature AtomUtil puts in an <atom:content> does).  An element is never
+// made a misplaced child of itself.
 void Element::AddElement(const ElementPtr& element) {
+  if (!element || element.get() == this) {
+    return;
+  }
+  MarkDirty();
+  element->SetParent(this);
   unknown_legal_elements_array_.push_back(element);
 }
 
 // Anything that reaches this level of the hierarchy is an unknown (non-KML)
 // element found during parse.
 void Element::AddUnknownElement(const string& s) {
+  MarkDirty();
   unknown_elements_array_.push_back(s);
 }
 
+void Element::TakeUnknownElement(string* s) {
+  MarkDirty();
+  unknown_elements_array_.push_back(string());
+  unknown_elements_array_.back().swap(*s);
+}
+
 // Serialize at this level is expected to handle only the unknown elements
 // we discovered during parse.
 void Element::SerializeUnknown(Serializer& serializer) const {
@@ -87,6 +102,7 @@ void Element::SerializeUnknown(Serializer& serializer) const {
 // Handling of unknown attributes found during parse.  Split out
 // xmlns attributes.  Take ownership of the passed attributes object.
 void Element::AddUnknownAttributes(Attributes* attributes) {
+  MarkDirty();
   if (attributes) {
     // Split out any attribute of the form xmlns:PREFIX=.
     if (Attributes* xmlns = attributes->SplitByPrefix("xmlns")) {
@@ -106,6 +122,8 @@ void Element::AddUnknownAttributes(Attributes* attributes) {
       // "xmlns" can never be an xml namespace prefix.
       xmlns_->SetValue("xmlns", xmlns);
     }
+    // A StringPool used during parse does not outlive the parse.
+    attributes->set_string_pool(NULL);
     // Anything left is saved as fully unknown.
     if (attributes->GetSize() == 0) {
       delete attributes;  // Nothing left so delete it.
@@ -139,6 +157,17 @@ void Element::SerializeAttributes(Attributes* attributes) const {
   }
 }
 
+// Private.  By construction an Element with no source range has no ancestor
+// with one so the walk up stops at the first Element with no range.
+void Element::ClearSourceRanges() {
+  Element* element = this;
+  while (element && !element->source_range_.empty()) {
+    element->source_range_.clear();
+    element = static_cast<Element*>(
+        const_cast<kmlbase::XmlElement*>(element->XmlElement::GetParent()));
+  }
+}
+
 ElementPtr Element::GetParent() const {
   return AsElement(const_cast<XmlElement*>(XmlElement::GetParent()));
 }
@@ -168,7 +197,7 @@ void Element::Accept(Visitor* visitor) {
 }
 
 Field::Field(KmlDomType type_id)
-  : Element(type_id), xsd_(*Xsd::GetSchema()) {
+  : Element(type_id), xsd_(*Xsd::GetSchema()), string_pool_(NULL) {
 }
 
 void Field::Serialize(Serializer& serializer) const {
@@ -223,4 +252,14 @@ bool Field::SetString(string* val) {
   return ret;
 }
 
+bool Field::SetInternedString(kmlbase::InternedString* val) {
+  bool ret = false;
+  if (val) {
+    *val = string_pool_ ? string_pool_->Intern(get_char_data())
+                        : kmlbase::InternedString(get_char_data());
+    ret = true;
+  }
+  return ret;
+}
+
 }  // namespace kmldom
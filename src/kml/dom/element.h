@@ -39,7 +39,9 @@
 #include "boost/scoped_ptr.hpp"
 #include "kml/dom/kml22.h"
 #include "kml/dom/kml_ptr.h"
+#include "kml/dom/source_slice.h"
 #include "kml/dom/visitor_driver.h"
+#include "kml/base/string_pool.h"
 #include "kml/base/util.h"
 #include "kml/base/xml_element.h"
 
@@ -108,6 +110,9 @@ class Element : public kmlbase::XmlElement {
 
   // Each fully unknown element (and its children) is saved in raw XML form.
   void AddUnknownElement(const string& s);
+  // This is AddUnknownElement() but takes over the contents of the given
+  // string rather than copying them.  The given string is left empty.
+  void TakeUnknownElement(string* s);
 
   // Called by concrete elements to serialize unknown and/or misplaced
   // elements discovered at parse time.
@@ -162,6 +167,33 @@ class Element : public kmlbase::XmlElement {
   virtual bool SetInt(int* val) { return false; }
   virtual bool SetEnum(int* val) { return false; }
   virtual bool SetString(string* val) { return false; }
+  virtual bool SetInternedString(kmlbase::InternedString* val) {
+    return false;
+  }
+
+  // An Element parsed with Parser::ParseSource() holds the range of the
+  // KML it was parsed from until it or any Element below it is changed.  An
+  // XmlSerializer given the same SourceBuffer copies such an unchanged
+  // Element from the source instead of serializing it.  The range is empty
+  // for an Element which was not parsed this way or which has been changed.
+  const SourceSlice& get_source_range() const {
+    return source_range_;
+  }
+  void set_source_range(const SourceSlice& source_range) {
+    source_range_ = source_range;
+  }
+
+  // This drops the source range of this Element and of each of its
+  // ancestors.  Each setter, clear_, add_ and Delete method of an Element
+  // calls this as does adding a child, an unknown element or unknown
+  // attributes.  A change made to an Element in any other way (such as a
+  // direct AddElement() of a simple element field) must be followed by a
+  // call to this if the Element is to be serialized with its source.
+  void MarkDirty() {
+    if (!source_range_.empty()) {
+      ClearSourceRanges();
+    }
+  }
 
   // Accepts the visitor for this element (this must be overridden for each
   // element type).
@@ -185,6 +217,7 @@ class Element : public kmlbase::XmlElement {
   // methods in a concrete element.
   template <class T>
   bool SetComplexChild(const T& child, T* field) {
+    MarkDirty();
     if (child == NULL) {
       // TODO: remove child and children from ID maps...
       *field = NULL;  // Assign removes reference and possibly deletes Element.
@@ -201,6 +234,7 @@ class Element : public kmlbase::XmlElement {
   bool AddComplexChild(const T& child, std::vector<T>* vec) {
     // NULL child ignored.
     if (child && child->SetParent(this)) {
+      MarkDirty();
       vec->push_back(child);
       return true;
     }
@@ -231,8 +265,10 @@ class Element : public kmlbase::XmlElement {
   }
 
  private:
+  void ClearSourceRanges();
   KmlDomType type_id_;
   string char_data_;
+  SourceSlice source_range_;
   // A vector of strings to contain unknown non-KML elements discovered during
   // parse.
   std::vector<string> unknown_elements_array_;
@@ -315,8 +351,19 @@ class Field : public Element {
   // supplied false is returned, else true is returned and the val is set.
   bool SetString(string* val);
 
+  // As SetString(), but the character data is interned in the StringPool
+  // set with set_string_pool() if there is one.
+  bool SetInternedString(kmlbase::InternedString* val);
+
+  // The StringPool used by SetInternedString().  The pool is not owned by
+  // the Field.  The default is no pool.
+  void set_string_pool(kmlbase::StringPool* string_pool) {
+    string_pool_ = string_pool;
+  }
+
  private:
   const Xsd& xsd_;
+  kmlbase::StringPool* string_pool_;
   LIBKML_DISALLOW_EVIL_CONSTRUCTORS(Field);
 };
 
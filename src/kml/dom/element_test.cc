@@ -174,6 +174,16 @@ TEST_F(ElementTest, TestAddGetUnknowns) {
       Type_open, element_->get_misplaced_elements_array_at(1)->Type());
 }
 
+TEST_F(ElementTest, TestTakeUnknownElement) {
+  const string kUnknown("<unknown>zzz<Foo/></unknown>");
+  string unknown(kUnknown);
+  element_->TakeUnknownElement(&unknown);
+  ASSERT_TRUE(unknown.empty());
+  ASSERT_EQ(static_cast<size_t>(1),
+            element_->get_unknown_elements_array_size());
+  ASSERT_EQ(kUnknown, element_->get_unknown_elements_array_at(0));
+}
+
 // This tests the SetComplexChild() method.
 TEST_F(ElementTest, TestSetComplexChild) {
   // set_child() calls SetComplexChild.
@@ -681,6 +691,29 @@ TEST(FieldTest, TestSetString) {
   ASSERT_EQ(string(kMyName), name);
 }
 
+// This tests Field's SetInternedString() method.
+TEST(FieldTest, TestSetInternedString) {
+  KmlFactory* factory = KmlFactory::GetFactory();
+  FieldPtr field = factory->CreateFieldById(Type_styleUrl);
+  ASSERT_FALSE(field->SetInternedString(NULL));
+
+  field->set_char_data("#style");
+  kmlbase::InternedString first;
+  ASSERT_TRUE(field->SetInternedString(&first));
+  ASSERT_EQ(string("#style"), first.get());
+  kmlbase::InternedString second;
+  ASSERT_TRUE(field->SetInternedString(&second));
+  ASSERT_FALSE(first.shares_storage_with(second));
+
+  kmlbase::StringPool string_pool;
+  field->set_string_pool(&string_pool);
+  ASSERT_TRUE(field->SetInternedString(&first));
+  ASSERT_TRUE(field->SetInternedString(&second));
+  ASSERT_EQ(string("#style"), second.get());
+  ASSERT_TRUE(first.shares_storage_with(second));
+  ASSERT_EQ(static_cast<size_t>(1), string_pool.size());
+}
+
 // This tests Field's Serialize() method.
 TEST(FieldTest, TestSerialize) {
   const string kContent("stuff in little snippet");
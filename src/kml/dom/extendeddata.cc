@@ -60,7 +60,7 @@ void SimpleData::ParseAttributes(Attributes* attributes) {
 void SimpleData::SerializeAttributes(Attributes* attributes) const {
   Element::SerializeAttributes(attributes);
   if (has_name_) {
-    attributes->SetValue(kSimpleDataName, name_);
+    attributes->SetValue(kSimpleDataName, get_name());
   }
 }
 
@@ -109,7 +109,7 @@ void GxSimpleArrayData::ParseAttributes(Attributes* attributes) {
 void GxSimpleArrayData::SerializeAttributes(Attributes* attributes) const {
   Element::SerializeAttributes(attributes);
   if (has_name_) {
-    attributes->SetValue(kGxSimpleArrayDataName, name_);
+    attributes->SetValue(kGxSimpleArrayDataName, get_name());
   }
 }
 
@@ -159,7 +159,7 @@ void SchemaData::ParseAttributes(Attributes* attributes) {
 void SchemaData::SerializeAttributes(Attributes* attributes) const {
   Object::SerializeAttributes(attributes);
   if (has_schemaurl_) {
-    attributes->SetValue(kSchemaUrl, schemaurl_);
+    attributes->SetValue(kSchemaUrl, get_schemaurl());
   }
 }
 
@@ -220,7 +220,7 @@ void Data::ParseAttributes(Attributes* attributes) {
 void Data::SerializeAttributes(Attributes* attributes) const {
   Object::SerializeAttributes(attributes);
   if (has_name_) {
-    attributes->SetValue(kDataName, name_);
+    attributes->SetValue(kDataName, get_name());
   }
 }
 
@@ -51,13 +51,20 @@ class SimpleData : public BasicElement<Type_SimpleData> {
   virtual ~SimpleData();
 
   // name=
-  const string& get_name() const { return name_; }
+  const string& get_name() const { return name_.get(); }
   bool has_name() const { return has_name_; }
   void set_name(const string& value) {
+    MarkDirty();
+    name_ = kmlbase::InternedString(value);
+    has_name_ = true;
+  }
+  void set_name(const kmlbase::InternedString& value) {
+    MarkDirty();
     name_ = value;
     has_name_ = true;
   }
   void clear_name() {
+    MarkDirty();
     name_.clear();
     has_name_ = false;
   }
@@ -66,10 +73,12 @@ class SimpleData : public BasicElement<Type_SimpleData> {
   const string& get_text() const { return text_; }
   bool has_text() const { return has_text_; }
   void set_text(const string& value) {
+    MarkDirty();
     text_ = value;
     has_text_ = true;
   }
   void clear_text() {
+    MarkDirty();
     text_.clear();
     has_text_ = false;
   }
@@ -86,7 +95,7 @@ class SimpleData : public BasicElement<Type_SimpleData> {
   friend class Serializer;
   virtual void Serialize(Serializer& serializer) const;
   virtual void SerializeAttributes(kmlbase::Attributes* attributes) const;
-  string name_;
+  kmlbase::InternedString name_;
   bool has_name_;
   string text_;
   bool has_text_;
@@ -99,19 +108,27 @@ class GxSimpleArrayData : public BasicElement<Type_GxSimpleArrayData> {
   virtual ~GxSimpleArrayData();
 
   // name=
-  const string& get_name() const { return name_; }
+  const string& get_name() const { return name_.get(); }
   bool has_name() const { return has_name_; }
   void set_name(const string& value) {
+    MarkDirty();
+    name_ = kmlbase::InternedString(value);
+    has_name_ = true;
+  }
+  void set_name(const kmlbase::InternedString& value) {
+    MarkDirty();
     name_ = value;
     has_name_ = true;
   }
   void clear_name() {
+    MarkDirty();
     name_.clear();
     has_name_ = false;
   }
 
   // <gx:value>
   void add_gx_value(const string& value) {
+    MarkDirty();
     gx_value_array_.push_back(value);
   }
 
@@ -135,7 +152,7 @@ class GxSimpleArrayData : public BasicElement<Type_GxSimpleArrayData> {
   friend class Serializer;
   virtual void Serialize(Serializer& serializer) const;
   virtual void SerializeAttributes(kmlbase::Attributes* attributes) const;
-  string name_;
+  kmlbase::InternedString name_;
   bool has_name_;
   std::vector<string> gx_value_array_;
   LIBKML_DISALLOW_EVIL_CONSTRUCTORS(GxSimpleArrayData);
@@ -152,13 +169,20 @@ class SchemaData : public Object {
   static KmlDomType ElementType() { return Type_SchemaData; }
 
   // schemaUrl=
-  const string& get_schemaurl() const { return schemaurl_; }
+  const string& get_schemaurl() const { return schemaurl_.get(); }
   bool has_schemaurl() const { return has_schemaurl_; }
   void set_schemaurl(const string& value) {
+    MarkDirty();
+    schemaurl_ = kmlbase::InternedString(value);
+    has_schemaurl_ = true;
+  }
+  void set_schemaurl(const kmlbase::InternedString& value) {
+    MarkDirty();
     schemaurl_ = value;
     has_schemaurl_ = true;
   }
   void clear_schemaurl() {
+    MarkDirty();
     schemaurl_.clear();
     has_schemaurl_ = false;
   }
@@ -203,7 +227,7 @@ class SchemaData : public Object {
   friend class Serializer;
   virtual void Serialize(Serializer& serializer) const;
   virtual void SerializeAttributes(kmlbase::Attributes* attributes) const;
-  string schemaurl_;
+  kmlbase::InternedString schemaurl_;
   bool has_schemaurl_;
   std::vector<SimpleDataPtr> simpledata_array_;
   std::vector<GxSimpleArrayDataPtr> gx_simplearraydata_array_;
@@ -221,13 +245,20 @@ class Data : public Object {
   static KmlDomType ElementType() { return Type_Data; }
 
   // name=
-  const string& get_name() const { return name_; }
+  const string& get_name() const { return name_.get(); }
   bool has_name() const { return has_name_; }
   void set_name(const string& value) {
+    MarkDirty();
+    name_ = kmlbase::InternedString(value);
+    has_name_ = true;
+  }
+  void set_name(const kmlbase::InternedString& value) {
+    MarkDirty();
     name_ = value;
     has_name_ = true;
   }
   void clear_name() {
+    MarkDirty();
     name_.clear();
     has_name_ = false;
   }
@@ -236,10 +267,12 @@ class Data : public Object {
   const string& get_displayname() const { return displayname_; }
   bool has_displayname() const { return has_displayname_; }
   void set_displayname(const string& value) {
+    MarkDirty();
     displayname_ = value;
     has_displayname_ = true;
   }
   void clear_displayname() {
+    MarkDirty();
     displayname_.clear();
     has_displayname_ = false;
   }
@@ -248,10 +281,12 @@ class Data : public Object {
   const string& get_value() const { return value_; }
   bool has_value() const { return has_value_; }
   void set_value(const string& value) {
+    MarkDirty();
     value_ = value;
     has_value_ = true;
   }
   void clear_value() {
+    MarkDirty();
     value_.clear();
     has_value_ = false;
   }
@@ -269,7 +304,7 @@ class Data : public Object {
   friend class Serializer;
   virtual void Serialize(Serializer& serializer) const;
   virtual void SerializeAttributes(kmlbase::Attributes* attributes) const;
-  string name_;
+  kmlbase::InternedString name_;
   bool has_name_;
   string displayname_;
   bool has_displayname_;
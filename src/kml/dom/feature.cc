@@ -107,7 +107,7 @@ void Feature::AddElement(const ElementPtr& element) {
       has_description_ = element->SetString(&description_);
       break;
     case Type_styleUrl:
-      has_styleurl_ = element->SetString(&styleurl_);
+      has_styleurl_ = element->SetInternedString(&styleurl_);
       break;
     case Type_Region:
       set_region(AsRegion(element));
@@ -167,7 +167,7 @@ void Feature::SerializeBeforeStyleSelector(Serializer& serializer) const {
     serializer.SaveElementGroup(get_timeprimitive(), Type_TimePrimitive);
   }
   if (has_styleurl()) {
-    serializer.SaveFieldById(Type_styleUrl, styleurl_);
+    serializer.SaveFieldById(Type_styleUrl, get_styleurl());
   }
 }
 
@@ -59,10 +59,12 @@ class Feature : public Object {
   const string& get_name() const { return name_; }
   bool has_name() const { return has_name_; }
   void set_name(const string& value) {
+    MarkDirty();
     name_ = value;
     has_name_ = true;
   }
   void clear_name() {
+    MarkDirty();
     name_.clear();
     has_name_ = false;
   }
@@ -71,10 +73,12 @@ class Feature : public Object {
   bool get_visibility() const { return visibility_; }
   bool has_visibility() const { return has_visibility_; }
   void set_visibility(bool value) {
+    MarkDirty();
     visibility_ = value;
     has_visibility_ = true;
   }
   void clear_visibility() {
+    MarkDirty();
     visibility_ = true;  // Default <visibility> is true.
     has_visibility_ = false;
   }
@@ -83,10 +87,12 @@ class Feature : public Object {
   bool get_open() const { return open_; }
   bool has_open() const { return has_open_; }
   void set_open(bool value) {
+    MarkDirty();
     open_ = value;
     has_open_ = true;
   }
   void clear_open() {
+    MarkDirty();
     open_ = false;
     has_open_ = false;
   }
@@ -115,10 +121,12 @@ class Feature : public Object {
   const string& get_address() const { return address_; }
   bool has_address() const { return has_address_; }
   void set_address(const string& value) {
+    MarkDirty();
     address_ = value;
     has_address_ = true;
   }
   void clear_address() {
+    MarkDirty();
     address_.clear();
     has_address_ = false;
   }
@@ -139,10 +147,12 @@ class Feature : public Object {
   const string& get_phonenumber() const { return phonenumber_; }
   bool has_phonenumber() const { return has_phonenumber_; }
   void set_phonenumber(const string& value) {
+    MarkDirty();
     phonenumber_ = value;
     has_phonenumber_ = true;
   }
   void clear_phonenumber() {
+    MarkDirty();
     phonenumber_.clear();
     has_phonenumber_ = false;
   }
@@ -162,10 +172,12 @@ class Feature : public Object {
   const string& get_description() const { return description_; }
   bool has_description() const { return has_description_; }
   void set_description(const string& value) {
+    MarkDirty();
     description_ = value;
     has_description_ = true;
   }
   void clear_description() {
+    MarkDirty();
     description_.clear();
     has_description_ = false;
   }
@@ -191,14 +203,27 @@ class Feature : public Object {
   }
 
   // <styleUrl>
-  const string& get_styleurl() const { return styleurl_; }
-  string& styleurl() { return styleurl_; }
+  const string& get_styleurl() const { return styleurl_.get(); }
+  // This returns the <styleUrl> for change in place.  The value is first
+  // copied out of any StringPool it was interned in (see
+  // kmlbase::InternedString::GetMutable()) so prefer set_styleurl().
+  string& styleurl() {
+    MarkDirty();
+    return styleurl_.GetMutable();
+  }
   bool has_styleurl() const { return has_styleurl_; }
   void set_styleurl(const string& value) {
+    MarkDirty();
+    styleurl_ = kmlbase::InternedString(value);
+    has_styleurl_ = true;
+  }
+  void set_styleurl(const kmlbase::InternedString& value) {
+    MarkDirty();
     styleurl_ = value;
     has_styleurl_ = true;
   }
   void clear_styleurl() {
+    MarkDirty();
     styleurl_.clear();
     has_styleurl_ = false;
   }
@@ -240,10 +265,12 @@ class Feature : public Object {
   bool get_gx_balloonvisibility() const { return gx_balloonvisibility_; }
   bool has_gx_balloonvisibility() const { return has_gx_balloonvisibility_; }
   void set_gx_balloonvisibility(bool value) {
+    MarkDirty();
     gx_balloonvisibility_ = value;
     has_gx_balloonvisibility_ = true;
   }
   void clear_gx_balloonvisibility() {
+    MarkDirty();
     gx_balloonvisibility_ = false;
     has_gx_balloonvisibility_ = false;
   }
@@ -278,7 +305,7 @@ class Feature : public Object {
   bool has_description_;
   AbstractViewPtr abstractview_;
   TimePrimitivePtr timeprimitive_;
-  string styleurl_;
+  kmlbase::InternedString styleurl_;
   bool has_styleurl_;
   StyleSelectorPtr styleselector_;
   RegionPtr region_;
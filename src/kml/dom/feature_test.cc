@@ -243,6 +243,26 @@ TEST_F(FeatureTest, TestSetGetHasClear) {
   ASSERT_FALSE(feature_->get_gx_balloonvisibility());
 }
 
+// Verify the <styleUrl> may be changed in place.
+TEST_F(FeatureTest, TestStyleUrlInPlace) {
+  kmlbase::StringPool string_pool;
+  const kmlbase::InternedString styleurl = string_pool.Intern("#a");
+  feature_->set_styleurl(styleurl);
+  feature_->styleurl().append("b");
+  ASSERT_EQ(string("#ab"), feature_->get_styleurl());
+  ASSERT_TRUE(feature_->has_styleurl());
+  // The interned value is not changed.
+  ASSERT_EQ(string("#a"), styleurl.get());
+  ASSERT_EQ(string("#a"), string_pool.Intern("#a").get());
+  // Once copied out of the pool the value is changed in place.
+  string& styleurl_ref = feature_->styleurl();
+  ASSERT_EQ(&styleurl_ref, &feature_->styleurl());
+  styleurl_ref.append("c");
+  ASSERT_EQ(string("#abc"), feature_->get_styleurl());
+  feature_->styleurl().clear();
+  ASSERT_EQ(string(""), feature_->get_styleurl());
+}
+
 // Verify <snippet> and <Metadata> are recognized in the small, and not in the
 // large, but are still preserved.  This verifies the AddElement() and
 // Serialize() methods.
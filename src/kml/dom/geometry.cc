@@ -29,8 +29,11 @@
 
 #include "kml/dom/geometry.h"
 #include <ctype.h>
+#include <algorithm>
+#include <stdio.h>
 #include <stdlib.h>
 #include "kml/base/attributes.h"
+#include "kml/base/date_time.h"
 #include "kml/base/xml_namespaces.h"
 #include "kml/dom/element.h"
 #include "kml/dom/kml22.h"
@@ -145,6 +148,41 @@ void Coordinates::Parse(const string& char_data) {
 }
 
 // Coordinates essentially parses itself.
+void Coordinates::AddTuples(const double* tuples, size_t size,
+                            size_t dimension) {
+  if (dimension != 2 && dimension != 3) {
+    return;
+  }
+  MarkDirty();
+  const size_t count = size / dimension;
+  coordinates_array_.reserve(coordinates_array_.size() + count);
+  for (size_t i = 0; i < count; ++i, tuples += dimension) {
+    if (dimension == 3) {
+      coordinates_array_.push_back(
+          kmlbase::Vec3(tuples[0], tuples[1], tuples[2]));
+    } else {
+      coordinates_array_.push_back(kmlbase::Vec3(tuples[0], tuples[1]));
+    }
+  }
+}
+
+size_t Coordinates::GetTuples(double* tuples, size_t size,
+                              size_t dimension) const {
+  if (dimension != 2 && dimension != 3) {
+    return 0;
+  }
+  const size_t count = std::min(size / dimension, coordinates_array_.size());
+  for (size_t i = 0; i < count; ++i, tuples += dimension) {
+    const kmlbase::Vec3& vec3 = coordinates_array_[i];
+    tuples[0] = vec3.get_longitude();
+    tuples[1] = vec3.get_latitude();
+    if (dimension == 3) {
+      tuples[2] = vec3.get_altitude();
+    }
+  }
+  return count;
+}
+
 void Coordinates::AddElement(const ElementPtr& element) {
   Parse(get_char_data());
 }
@@ -454,19 +492,102 @@ GxTrack::GxTrack() {
 
 GxTrack::~GxTrack() {}
 
+void GxTrack::reserve(size_t size) {
+  when_times_.reserve(size);
+  gx_coord_longitudes_.reserve(size);
+  gx_coord_latitudes_.reserve(size);
+  gx_coord_altitudes_.reserve(size);
+  gx_angles_headings_.reserve(size);
+  gx_angles_tilts_.reserve(size);
+  gx_angles_rolls_.reserve(size);
+}
+
+void GxTrack::AddGxCoordTuples(const double* tuples, size_t size,
+                               size_t dimension) {
+  if (dimension != 2 && dimension != 3) {
+    return;
+  }
+  MarkDirty();
+  const size_t count = size / dimension;
+  const size_t new_size = gx_coord_longitudes_.size() + count;
+  gx_coord_longitudes_.reserve(new_size);
+  gx_coord_latitudes_.reserve(new_size);
+  gx_coord_altitudes_.reserve(new_size);
+  for (size_t i = 0; i < count; ++i, tuples += dimension) {
+    gx_coord_longitudes_.push_back(tuples[0]);
+    gx_coord_latitudes_.push_back(tuples[1]);
+    gx_coord_altitudes_.push_back(dimension == 3 ? tuples[2] : 0.0);
+  }
+}
+
+size_t GxTrack::GetGxCoordTuples(double* tuples, size_t size,
+                                 size_t dimension) const {
+  if (dimension != 2 && dimension != 3) {
+    return 0;
+  }
+  const size_t count = std::min(size / dimension, gx_coord_longitudes_.size());
+  for (size_t i = 0; i < count; ++i, tuples += dimension) {
+    tuples[0] = gx_coord_longitudes_[i];
+    tuples[1] = gx_coord_latitudes_[i];
+    if (dimension == 3) {
+      tuples[2] = gx_coord_altitudes_[i];
+    }
+  }
+  return count;
+}
+
+// A whole second in UTC is held as its time alone and is serialized in the
+// form FormatXsdDateTime() writes.  Anything else keeps its text.
+void GxTrack::add_when(const string& when) {
+  MarkDirty();
+  kmlbase::DateTime date_time;
+  const bool parsed =
+      kmlbase::DateTime::Parse(when.data(), when.size(), &date_time);
+  if (!parsed ||
+      date_time.get_precision() != kmlbase::DateTime::PRECISION_SECOND ||
+      !date_time.has_offset() || date_time.get_offset_minutes() != 0 ||
+      date_time.get_nanoseconds() != 0) {
+    when_texts_[when_times_.size()] = when;
+  }
+  when_times_.push_back(parsed ? date_time.get_seconds() : 0);
+}
+
+string GxTrack::get_when_array_at(size_t index) const {
+  std::map<size_t, string>::const_iterator iter = when_texts_.find(index);
+  if (iter != when_texts_.end()) {
+    return iter->second;
+  }
+  char buf[kmlbase::DateTime::kXsdDateTimeSize];
+  return string(buf, kmlbase::DateTime::FormatXsdDateTime(when_times_[index],
+                                                          buf));
+}
+
+bool GxTrack::has_when_time_at(size_t index) const {
+  std::map<size_t, string>::const_iterator iter = when_texts_.find(index);
+  if (iter == when_texts_.end()) {
+    return index < when_times_.size();
+  }
+  kmlbase::DateTime date_time;
+  return kmlbase::DateTime::Parse(iter->second.data(), iter->second.size(),
+                                  &date_time);
+}
+
 void GxTrack::AddElement(const ElementPtr& element) {
   if (!element) {
     return;
   }
+  double tuple[3];
   switch (element->Type()) {
     case Type_when:
       add_when(element->get_char_data());
       break;
     case Type_GxAngles:
-      Parse(element->get_char_data(), &gx_angles_array_);
+      ParseTuple(element->get_char_data(), tuple);
+      add_gx_angles(tuple[0], tuple[1], tuple[2]);
       break;
     case Type_GxCoord:
-      Parse(element->get_char_data(), &gx_coord_array_);
+      ParseTuple(element->get_char_data(), tuple);
+      add_gx_coord(tuple[0], tuple[1], tuple[2]);
       break;
     case Type_Model:
       set_model(AsModel(element));
@@ -479,6 +600,16 @@ void GxTrack::AddElement(const ElementPtr& element) {
   }
 }
 
+// This saves the 3 values as a space separated simple element just as
+// Serializer::SaveSimpleVec3() does but without a stringstream per value.
+static void SaveTuple(Serializer& serializer, int type_id, double first,
+                      double second, double third) {
+  // Each %.15g is at most 22 chars.
+  char buf[80];
+  const int size = sprintf(buf, "%.15g %.15g %.15g", first, second, third);
+  serializer.SaveStringFieldById(type_id, string(buf, size));
+}
+
 void GxTrack::Serialize(Serializer& serializer) const {
   ElementSerializer element_serializer(*this, serializer);
   Geometry::Serialize(serializer);
@@ -488,15 +619,26 @@ void GxTrack::Serialize(Serializer& serializer) const {
   if (has_gx_altitudemode()) {
     serializer.SaveEnum(Type_GxAltitudeMode, get_gx_altitudemode());
   }
-  for (size_t i = 0; i < when_array_.size(); i++) {
-    serializer.SaveStringFieldById(Type_when, when_array_[i]);
+  std::map<size_t, string>::const_iterator when_text = when_texts_.begin();
+  char buf[kmlbase::DateTime::kXsdDateTimeSize];
+  for (size_t i = 0; i < when_times_.size(); i++) {
+    if (when_text != when_texts_.end() && when_text->first == i) {
+      serializer.SaveStringFieldById(Type_when, when_text->second);
+      ++when_text;
+    } else {
+      serializer.SaveStringFieldById(
+          Type_when,
+          string(buf, kmlbase::DateTime::FormatXsdDateTime(when_times_[i],
+                                                           buf)));
+    }
   }
-  const Attributes dummy;
-  for (size_t i = 0; i < gx_coord_array_.size(); i++) {
-    serializer.SaveSimpleVec3(Type_GxCoord, gx_coord_array_.at(i), " ");
+  for (size_t i = 0; i < gx_coord_longitudes_.size(); i++) {
+    SaveTuple(serializer, Type_GxCoord, gx_coord_longitudes_[i],
+              gx_coord_latitudes_[i], gx_coord_altitudes_[i]);
   }
-  for (size_t i = 0; i < gx_angles_array_.size(); i++) {
-    serializer.SaveSimpleVec3(Type_GxAngles, gx_angles_array_.at(i), " ");
+  for (size_t i = 0; i < gx_angles_headings_.size(); i++) {
+    SaveTuple(serializer, Type_GxAngles, gx_angles_headings_[i],
+              gx_angles_tilts_[i], gx_angles_rolls_[i]);
   }
   if (has_model()) {
     serializer.SaveElement(get_model());
@@ -520,19 +662,21 @@ void GxTrack::AcceptChildren(VisitorDriver* driver) {
   }
 }
 
-void GxTrack::Parse(const string& char_data, std::vector<Vec3>* out) {
-  if (!out) {
-    return;
-  }
-  // TODO: this is a little heavy. Optimization along the lines of
-  // Coordinates::Parse may be required.
-  std::vector<string> s;
-  kmlbase::SplitStringUsing(char_data, " ", &s);
-  kmlbase::Vec3 vec;
-  for (size_t i = 0; i < s.size(); i++) {
-    vec.set(i, strtod(s[i].c_str(), NULL));
+// This parses the space separated values of a <gx:coord> or <gx:angles>
+// into the 3 doubles of tuple.  Any run of whitespace separates values.  A
+// missing value is 0 and values past the third are ignored.
+void GxTrack::ParseTuple(const string& char_data, double* tuple) {
+  tuple[0] = tuple[1] = tuple[2] = 0.0;
+  const char* cstr = char_data.c_str();
+  for (int i = 0; i < 3; ++i) {
+    char* endp;
+    const double value = strtod(cstr, &endp);  // strtod() eats whitespace.
+    if (endp == cstr) {
+      break;
+    }
+    tuple[i] = value;
+    cstr = endp;
   }
-  out->push_back(vec);
 }
 
 GxMultiTrack::GxMultiTrack()
@@ -72,6 +72,7 @@
 #ifndef KML_DOM_GEOMETRY_H__
 #define KML_DOM_GEOMETRY_H__
 
+#include <map>
 #include <vector>
 #include "kml/base/util.h"
 #include "kml/base/vec3.h"
@@ -94,14 +95,17 @@ class Coordinates : public BasicElement<Type_coordinates> {
 
   // The main KML-specific API
   void add_latlngalt(double latitude, double longitude, double altitude) {
+    MarkDirty();
     coordinates_array_.push_back(kmlbase::Vec3(longitude, latitude, altitude));
   }
 
   void add_latlng(double latitude, double longitude) {
+    MarkDirty();
     coordinates_array_.push_back(kmlbase::Vec3(longitude, latitude));
   }
 
   void add_vec3(const kmlbase::Vec3& vec3) {
+    MarkDirty();
     coordinates_array_.push_back(vec3);
   }
 
@@ -109,10 +113,32 @@ class Coordinates : public BasicElement<Type_coordinates> {
     return coordinates_array_.size();
   }
 
-  const kmlbase::Vec3 get_coordinates_array_at(size_t index) const {
+  const kmlbase::Vec3& get_coordinates_array_at(size_t index) const {
     return coordinates_array_[index];
   }
 
+  // The coordinates are held contiguously.  This gives the whole array for
+  // bulk use without copying.
+  const std::vector<kmlbase::Vec3>& get_coordinates_array() const {
+    return coordinates_array_;
+  }
+
+  // This reserves room for the given number of coordinates.
+  void reserve(size_t size) {
+    coordinates_array_.reserve(size);
+  }
+
+  // This appends the coordinates from size values packed as tuples of the
+  // given dimension: longitude,latitude (2) or longitude,latitude,altitude
+  // (3).  Any partial tuple at the end is ignored as is any other dimension.
+  void AddTuples(const double* tuples, size_t size, size_t dimension);
+
+  // This writes the coordinates as tuples of the given dimension (2 or 3)
+  // to the size values at tuples.  A coordinate with no altitude has an
+  // altitude of 0.  This returns the number of coordinates written which is
+  // less than get_coordinates_array_size() only if size is too small.
+  size_t GetTuples(double* tuples, size_t size, size_t dimension) const;
+
   // Internal methods used in parser.  Public for unittest purposes.
   // See .cc for more details.
   void Parse(const string& char_data);
@@ -120,6 +146,7 @@ class Coordinates : public BasicElement<Type_coordinates> {
 
   // This clears the internal coordinates array.
   void Clear() {
+    MarkDirty();
     coordinates_array_.clear();
   }
 
@@ -170,10 +197,12 @@ class AltitudeGeometryCommon : public Geometry {
   int get_altitudemode() const { return altitudemode_; }
   bool has_altitudemode() const { return has_altitudemode_; }
   void set_altitudemode(int value) {
+    MarkDirty();
     altitudemode_ = value;
     has_altitudemode_ = true;
   }
   void clear_altitudemode() {
+    MarkDirty();
     altitudemode_ = ALTITUDEMODE_CLAMPTOGROUND;
     has_altitudemode_ = false;
   }
@@ -182,10 +211,12 @@ class AltitudeGeometryCommon : public Geometry {
   int get_gx_altitudemode() const { return gx_altitudemode_; }
   bool has_gx_altitudemode() const { return has_gx_altitudemode_; }
   void set_gx_altitudemode(int value) {
+    MarkDirty();
     gx_altitudemode_ = value;
     has_gx_altitudemode_ = true;
   }
   void clear_gx_altitudemode() {
+    MarkDirty();
     gx_altitudemode_ = GX_ALTITUDEMODE_CLAMPTOSEAFLOOR;
     has_gx_altitudemode_ = false;
   }
@@ -210,10 +241,12 @@ class ExtrudeGeometryCommon : public AltitudeGeometryCommon {
   bool get_extrude() const { return extrude_; }
   bool has_extrude() const { return has_extrude_; }
   void set_extrude(bool value) {
+    MarkDirty();
     extrude_ = value;
     has_extrude_ = true;
   }
   void clear_extrude() {
+    MarkDirty();
     extrude_ = false;
     has_extrude_ = false;
   }
@@ -290,10 +323,12 @@ class LineCommon : public CoordinatesGeometryCommon {
   bool get_tessellate() const { return tessellate_; }
   bool has_tessellate() const { return has_tessellate_; }
   void set_tessellate(bool value) {
+    MarkDirty();
     tessellate_ = value;
     has_tessellate_ = true;
   }
   void clear_tessellate() {
+    MarkDirty();
     tessellate_ = false;
     has_tessellate_ = false;
   }
@@ -427,10 +462,12 @@ class Polygon : public ExtrudeGeometryCommon {
   bool get_tessellate() const { return tessellate_; }
   bool has_tessellate() const { return has_tessellate_; }
   void set_tessellate(bool value) {
+    MarkDirty();
     tessellate_ = value;
     has_tessellate_ = true;
   }
   void clear_tessellate() {
+    MarkDirty();
     tessellate_ = false;
     has_tessellate_ = false;
   }
@@ -526,37 +563,98 @@ class GxTrack : public AltitudeGeometryCommon {
     return type == ElementType() || Geometry::IsA(type);
   }
 
+  // The points of a track are held in columns: one of times, three of
+  // coordinates and three of angles.  The column accessors give the whole
+  // column for bulk use.  The *_array_at accessors build the value of one
+  // point from the columns.
+
+  // This reserves room in each column for the given number of points.
+  void reserve(size_t size);
+
   // <when>
-  size_t get_when_array_size() {
-    return when_array_.size();
+  // Each <when> is held as seconds since the POSIX epoch in UTC.  The text
+  // of a <when> is also kept if it cannot be rebuilt from those seconds: a
+  // fraction of a second, a time zone other than UTC, a date with no time,
+  // or text that does not parse as a time at all.  A <when> that does not
+  // parse has a time of 0.
+  size_t get_when_array_size() const {
+    return when_times_.size();
+  }
+  void add_when(const string& when);
+  string get_when_array_at(size_t index) const;
+  void add_when_time(int64_t when) {
+    MarkDirty();
+    when_times_.push_back(when);
   }
-  void add_when(const string& when) {
-    when_array_.push_back(when);
+  int64_t get_when_time_at(size_t index) const {
+    return when_times_[index];
   }
-  const string& get_when_array_at(size_t index) const {
-    return when_array_[index];
+  // This is false if the <when> at the given index did not parse.
+  bool has_when_time_at(size_t index) const;
+  const std::vector<int64_t>& get_when_times() const {
+    return when_times_;
   }
 
   // <gx:coord>
-  size_t get_gx_coord_array_size() {
-    return gx_coord_array_.size();
+  size_t get_gx_coord_array_size() const {
+    return gx_coord_longitudes_.size();
   }
   void add_gx_coord(const kmlbase::Vec3& gx_coord) {
-    gx_coord_array_.push_back(gx_coord);
+    add_gx_coord(gx_coord.get_longitude(), gx_coord.get_latitude(),
+                 gx_coord.get_altitude());
   }
-  const kmlbase::Vec3& get_gx_coord_array_at(size_t index) const {
-    return gx_coord_array_[index];
+  void add_gx_coord(double longitude, double latitude, double altitude) {
+    MarkDirty();
+    gx_coord_longitudes_.push_back(longitude);
+    gx_coord_latitudes_.push_back(latitude);
+    gx_coord_altitudes_.push_back(altitude);
   }
+  kmlbase::Vec3 get_gx_coord_array_at(size_t index) const {
+    return kmlbase::Vec3(gx_coord_longitudes_[index],
+                         gx_coord_latitudes_[index],
+                         gx_coord_altitudes_[index]);
+  }
+  const std::vector<double>& get_gx_coord_longitudes() const {
+    return gx_coord_longitudes_;
+  }
+  const std::vector<double>& get_gx_coord_latitudes() const {
+    return gx_coord_latitudes_;
+  }
+  const std::vector<double>& get_gx_coord_altitudes() const {
+    return gx_coord_altitudes_;
+  }
+  // As Coordinates::AddTuples() and GetTuples() for the <gx:coord>s of the
+  // track.  A <gx:coord> always has an altitude.
+  void AddGxCoordTuples(const double* tuples, size_t size, size_t dimension);
+  size_t GetGxCoordTuples(double* tuples, size_t size,
+                          size_t dimension) const;
 
   // <gx:angles>
-  size_t get_gx_angles_array_size() {
-    return gx_angles_array_.size();
+  size_t get_gx_angles_array_size() const {
+    return gx_angles_headings_.size();
   }
   void add_gx_angles(const kmlbase::Vec3& gx_angles) {
-    gx_angles_array_.push_back(gx_angles);
+    add_gx_angles(gx_angles.get_heading(), gx_angles.get_pitch(),
+                  gx_angles.get_roll());
+  }
+  void add_gx_angles(double heading, double tilt, double roll) {
+    MarkDirty();
+    gx_angles_headings_.push_back(heading);
+    gx_angles_tilts_.push_back(tilt);
+    gx_angles_rolls_.push_back(roll);
+  }
+  kmlbase::Vec3 get_gx_angles_array_at(size_t index) const {
+    return kmlbase::Vec3(gx_angles_headings_[index], gx_angles_tilts_[index],
+                         gx_angles_rolls_[index]);
+  }
+  const std::vector<double>& get_gx_angles_headings() const {
+    return gx_angles_headings_;
+  }
+  const std::vector<double>& get_gx_angles_tilts() const {
+    return gx_angles_tilts_;
   }
-  const kmlbase::Vec3& get_gx_angles_array_at(size_t index) const {
-    return gx_angles_array_[index];
+  const std::vector<double>& get_gx_angles_rolls() const {
+    return gx_angles_rolls_;
   }
 
   // <Model>
@@ -583,7 +681,7 @@ class GxTrack : public AltitudeGeometryCommon {
 
   // Internal methods used in parser.  Public for unittest purposes.
   // See .cc for more details.
-  void Parse(const string& char_data, std::vector<kmlbase::Vec3>* out);
+  static void ParseTuple(const string& char_data, double* tuple);
 
  private:
   friend class KmlFactory;
@@ -592,9 +690,15 @@ class GxTrack : public AltitudeGeometryCommon {
   virtual void AddElement(const ElementPtr& element);
   friend class Serializer;
   virtual void Serialize(Serializer& serializer) const;
-  std::vector<string> when_array_;
-  std::vector<kmlbase::Vec3> gx_coord_array_;
-  std::vector<kmlbase::Vec3> gx_angles_array_;
+  std::vector<int64_t> when_times_;
+  // The text of each <when> that is not simply its time, by index.
+  std::map<size_t, string> when_texts_;
+  std::vector<double> gx_coord_longitudes_;
+  std::vector<double> gx_coord_latitudes_;
+  std::vector<double> gx_coord_altitudes_;
+  std::vector<double> gx_angles_headings_;
+  std::vector<double> gx_angles_tilts_;
+  std::vector<double> gx_angles_rolls_;
   ModelPtr model_;
   ExtendedDataPtr  extendeddata_;
   LIBKML_DISALLOW_EVIL_CONSTRUCTORS(GxTrack);
@@ -613,10 +717,12 @@ class GxMultiTrack : public Geometry {
   bool get_gx_interpolate() const { return gx_interpolate_; }
   bool has_gx_interpolate() const { return has_gx_interpolate_; }
   void set_gx_interpolate(bool value) {
+    MarkDirty();
     gx_interpolate_ = value;
     has_gx_interpolate_ = true;
   }
   void clear_gx_interpolate() {
+    MarkDirty();
     gx_interpolate_ = false;  // Default <gx:interpolate> is false.
     has_gx_interpolate_ = false;
   }
@@ -673,10 +779,12 @@ class Location : public Object {
     return has_longitude_;
   }
   void set_longitude(double longitude) {
+    MarkDirty();
     longitude_ = longitude;
     has_longitude_ = true;
   }
   void clear_longitude() {
+    MarkDirty();
     longitude_ = 0.0;
     has_longitude_ = false;
   }
@@ -689,10 +797,12 @@ class Location : public Object {
     return has_latitude_;
   }
   void set_latitude(double latitude) {
+    MarkDirty();
     latitude_ = latitude;
     has_latitude_ = true;
   }
   void clear_latitude() {
+    MarkDirty();
     latitude_ = 0.0;
     has_latitude_ = false;
   }
@@ -705,10 +815,12 @@ class Location : public Object {
     return has_altitude_;
   }
   void set_altitude(double altitude) {
+    MarkDirty();
     altitude_ = altitude;
     has_altitude_ = true;
   }
   void clear_altitude() {
+    MarkDirty();
     altitude_ = 0.0;
     has_altitude_ = false;
   }
@@ -749,10 +861,12 @@ class Orientation : public Object {
     return has_heading_;
   }
   void set_heading(double heading) {
+    MarkDirty();
     heading_ = heading;
     has_heading_ = true;
   }
   void clear_heading() {
+    MarkDirty();
     heading_ = 0.0;
     has_heading_ = false;
   }
@@ -765,10 +879,12 @@ class Orientation : public Object {
     return has_tilt_;
   }
   void set_tilt(double tilt) {
+    MarkDirty();
     tilt_ = tilt;
     has_tilt_ = true;
   }
   void clear_tilt() {
+    MarkDirty();
     tilt_ = 0.0;
     has_tilt_ = false;
   }
@@ -781,10 +897,12 @@ class Orientation : public Object {
     return has_roll_;
   }
   void set_roll(double roll) {
+    MarkDirty();
     roll_ = roll;
     has_roll_ = true;
   }
   void clear_roll() {
+    MarkDirty();
     roll_ = 0.0;
     has_roll_ = false;
   }
@@ -825,10 +943,12 @@ class Scale : public Object {
     return has_x_;
   }
   void set_x(double x) {
+    MarkDirty();
     x_ = x;
     has_x_ = true;
   }
   void clear_x() {
+    MarkDirty();
     x_ = 1.0;
     has_x_ = false;
   }
@@ -841,10 +961,12 @@ class Scale : public Object {
     return has_y_;
   }
   void set_y(double y) {
+    MarkDirty();
     y_ = y;
     has_y_ = true;
   }
   void clear_y() {
+    MarkDirty();
     y_ = 1.0;
     has_y_ = false;
   }
@@ -857,10 +979,12 @@ class Scale : public Object {
     return has_z_;
   }
   void set_z(double z) {
+    MarkDirty();
     z_ = z;
     has_z_ = true;
   }
   void clear_z() {
+    MarkDirty();
     z_ = 1.0;
     has_z_ = false;
   }
@@ -901,10 +1025,12 @@ class Alias : public Object {
     return has_targethref_;
   }
   void set_targethref(const string& targethref) {
+    MarkDirty();
     targethref_ = targethref;
     has_targethref_ = true;
   }
   void clear_targethref() {
+    MarkDirty();
     targethref_.clear();
     has_targethref_ = false;
   }
@@ -917,10 +1043,12 @@ class Alias : public Object {
     return has_sourcehref_;
   }
   void set_sourcehref(const string& sourcehref) {
+    MarkDirty();
     sourcehref_ = sourcehref;
     has_sourcehref_ = true;
   }
   void clear_sourcehref() {
+    MarkDirty();
     sourcehref_.clear();
     has_sourcehref_ = false;
   }
@@ -1032,6 +1160,7 @@ class Model : public AltitudeGeometryCommon {
     SetComplexChild(resourcemap, &resourcemap_);
   }
   void clear_resourcemap() {
+    MarkDirty();
     resourcemap_ = NULL;
   }
 
@@ -294,6 +294,33 @@ TEST_F(CoordinatesTest, TestClear) {
   ASSERT_EQ(static_cast<size_t>(0), coordinates_->get_coordinates_array_size());
 }
 
+TEST_F(CoordinatesTest, TestTuples) {
+  const double kTuples3[] = { 1.1, 2.2, 3.3, 4.4, 5.5, 6.6, 7.7 };
+  coordinates_->reserve(4);
+  coordinates_->AddTuples(kTuples3, 7, 3);  // The partial tuple is ignored.
+  const double kTuples2[] = { 8.8, 9.9 };
+  coordinates_->AddTuples(kTuples2, 2, 2);
+  coordinates_->AddTuples(kTuples2, 2, 4);  // Not a dimension.
+  const std::vector<kmlbase::Vec3>& array =
+      coordinates_->get_coordinates_array();
+  ASSERT_EQ(static_cast<size_t>(3), array.size());
+  ASSERT_TRUE(kmlbase::Vec3(1.1, 2.2, 3.3) == array[0]);
+  ASSERT_TRUE(kmlbase::Vec3(4.4, 5.5, 6.6) == array[1]);
+  ASSERT_TRUE(kmlbase::Vec3(8.8, 9.9) == array[2]);
+  ASSERT_FALSE(array[2].has_altitude());
+  ASSERT_EQ(&array[2], &coordinates_->get_coordinates_array_at(2));
+
+  double out[9];
+  ASSERT_EQ(static_cast<size_t>(3), coordinates_->GetTuples(out, 9, 3));
+  ASSERT_EQ(4.4, out[3]);
+  ASSERT_EQ(6.6, out[5]);
+  ASSERT_EQ(0.0, out[8]);  // No altitude.
+  ASSERT_EQ(static_cast<size_t>(2), coordinates_->GetTuples(out, 5, 2));
+  ASSERT_EQ(4.4, out[2]);
+  ASSERT_EQ(5.5, out[3]);
+  ASSERT_EQ(static_cast<size_t>(0), coordinates_->GetTuples(out, 9, 1));
+}
+
 // This typedef is a convenience for use with the CoordinatesSerializerStub.
 typedef std::vector<kmlbase::Vec3> Vec3Vector;
 
@@ -1182,6 +1209,106 @@ TEST_F(GxTrackTest, TestSerialize) {
   ASSERT_EQ(kExpected, SerializeRaw(gx_track_));
 }
 
+// Verify the columns hold each point added through the Vec3 and string API.
+TEST_F(GxTrackTest, TestColumns) {
+  gx_track_->reserve(2);
+  gx_track_->add_when("2010-02-07T19:57:44Z");
+  gx_track_->add_when_time(1265572665);
+  gx_track_->add_gx_coord(Vec3(-122.1, 37.2, 100.3));
+  gx_track_->add_gx_coord(-122.4, 37.5, 100.6);
+  gx_track_->add_gx_angles(Vec3(-1.1, 7.2, 10.3));
+  gx_track_->add_gx_angles(-1.4, 7.5, 10.6);
+
+  const std::vector<int64_t>& whens = gx_track_->get_when_times();
+  ASSERT_EQ(static_cast<size_t>(2), whens.size());
+  ASSERT_EQ(1265572664, whens[0]);
+  ASSERT_EQ(1265572665, gx_track_->get_when_time_at(1));
+  ASSERT_EQ(string("2010-02-07T19:57:45Z"), gx_track_->get_when_array_at(1));
+  ASSERT_TRUE(gx_track_->has_when_time_at(0));
+  ASSERT_TRUE(gx_track_->has_when_time_at(1));
+
+  ASSERT_EQ(-122.1, gx_track_->get_gx_coord_longitudes()[0]);
+  ASSERT_EQ(37.5, gx_track_->get_gx_coord_latitudes()[1]);
+  ASSERT_EQ(100.3, gx_track_->get_gx_coord_altitudes()[0]);
+  ASSERT_EQ(-1.4, gx_track_->get_gx_angles_headings()[1]);
+  ASSERT_EQ(7.2, gx_track_->get_gx_angles_tilts()[0]);
+  ASSERT_EQ(10.6, gx_track_->get_gx_angles_rolls()[1]);
+}
+
+TEST_F(GxTrackTest, TestGxCoordTuples) {
+  const double kTuples[] = { -122.1, 37.2, 100.3, -122.4, 37.5, 100.6 };
+  gx_track_->AddGxCoordTuples(kTuples, 6, 3);
+  gx_track_->AddGxCoordTuples(kTuples, 2, 2);
+  ASSERT_EQ(static_cast<size_t>(3), gx_track_->get_gx_coord_array_size());
+  ASSERT_EQ(37.5, gx_track_->get_gx_coord_latitudes()[1]);
+  ASSERT_EQ(-122.1, gx_track_->get_gx_coord_longitudes()[2]);
+  ASSERT_EQ(0.0, gx_track_->get_gx_coord_altitudes()[2]);
+  double out[6];
+  ASSERT_EQ(static_cast<size_t>(2), gx_track_->GetGxCoordTuples(out, 6, 3));
+  for (size_t i = 0; i < 6; ++i) {
+    ASSERT_EQ(kTuples[i], out[i]);
+  }
+}
+
+// Verify that a <when> which is not a whole second in UTC keeps its text.
+TEST_F(GxTrackTest, TestWhenText) {
+  const char* kWhens[] = {
+    "2010-02-07T19:57:44.5Z", "2010-02-07T11:57:44-08:00",
+    "2010-02-07T19:57:44", "2010-02-07", "not a time"
+  };
+  const size_t kCount = sizeof(kWhens) / sizeof(kWhens[0]);
+  for (size_t i = 0; i < kCount; ++i) {
+    gx_track_->add_when(kWhens[i]);
+  }
+  // A zero fraction or a zero offset needs no text.
+  gx_track_->add_when("2010-02-07T19:57:44.000Z");
+  gx_track_->add_when("2010-02-07T19:57:44+00:00");
+  ASSERT_EQ(kCount + 2, gx_track_->get_when_array_size());
+  for (size_t i = 0; i < kCount; ++i) {
+    ASSERT_EQ(string(kWhens[i]), gx_track_->get_when_array_at(i));
+  }
+  ASSERT_EQ(string("2010-02-07T19:57:44Z"),
+            gx_track_->get_when_array_at(kCount));
+  ASSERT_EQ(string("2010-02-07T19:57:44Z"),
+            gx_track_->get_when_array_at(kCount + 1));
+  ASSERT_EQ(1265572664, gx_track_->get_when_time_at(0));
+  ASSERT_EQ(1265572664, gx_track_->get_when_time_at(1));
+  ASSERT_EQ(1265500800, gx_track_->get_when_time_at(3));
+  ASSERT_TRUE(gx_track_->has_when_time_at(3));
+  ASSERT_FALSE(gx_track_->has_when_time_at(4));
+  ASSERT_EQ(0, gx_track_->get_when_time_at(4));
+  ASSERT_FALSE(gx_track_->has_when_time_at(kCount + 2));
+
+  const string kExpected(
+    "<gx:Track>"
+    "<when>2010-02-07T19:57:44.5Z</when>"
+    "<when>2010-02-07T11:57:44-08:00</when>"
+    "<when>2010-02-07T19:57:44</when>"
+    "<when>2010-02-07</when>"
+    "<when>not a time</when>"
+    "<when>2010-02-07T19:57:44Z</when>"
+    "<when>2010-02-07T19:57:44Z</when>"
+    "</gx:Track>"
+  );
+  ASSERT_EQ(kExpected, SerializeRaw(gx_track_));
+}
+
+TEST_F(GxTrackTest, TestParseTuple) {
+  double tuple[3];
+  GxTrack::ParseTuple("-122.1 37.2 100.3", tuple);
+  ASSERT_EQ(-122.1, tuple[0]);
+  ASSERT_EQ(37.2, tuple[1]);
+  ASSERT_EQ(100.3, tuple[2]);
+  GxTrack::ParseTuple("\n  -122.1\t 37.2  \n", tuple);
+  ASSERT_EQ(-122.1, tuple[0]);
+  ASSERT_EQ(37.2, tuple[1]);
+  ASSERT_EQ(0.0, tuple[2]);
+  GxTrack::ParseTuple("1 2 3 4", tuple);
+  ASSERT_EQ(3.0, tuple[2]);
+  GxTrack::ParseTuple("", tuple);
+  ASSERT_EQ(0.0, tuple[0]);
+}
+
 // Test gx:MultiTrack.
 class GxMultiTrackTest: public testing::Test {
  protected:
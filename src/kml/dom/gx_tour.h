@@ -145,10 +145,12 @@ class GxTourPrimitiveCommon : public GxTourPrimitive {
     return has_gx_duration_;
   }
   void set_gx_duration(double gx_duration) {
+    MarkDirty();
     gx_duration_ = gx_duration;
     has_gx_duration_ = true;
   }
   void clear_gx_duration() {
+    MarkDirty();
     gx_duration_ = 0.0;
     has_gx_duration_ = false;
   }
@@ -222,10 +224,12 @@ class GxFlyTo : public GxTourPrimitiveCommon {
   int get_gx_flytomode() const { return gx_flytomode_; }
   bool has_gx_flytomode() const { return has_gx_flytomode_; }
   void set_gx_flytomode(int value) {
+    MarkDirty();
     gx_flytomode_ = value;
     has_gx_flytomode_ = true;
   }
   void clear_gx_flytomode() {
+    MarkDirty();
     gx_flytomode_ = kmldom::GX_FLYTOMODE_BOUNCE;
     has_gx_flytomode_ = false;
   }
@@ -300,10 +304,12 @@ class GxSoundCue : public GxTourPrimitive {
     return has_href_;
   }
   void set_href(const string& href) {
+    MarkDirty();
     href_ = href;
     has_href_ = true;
   }
   void clear_href() {
+    MarkDirty();
     href_.clear();
     has_href_ = false;
   }
@@ -343,10 +349,12 @@ class GxTourControl : public GxTourPrimitive {
     return has_gx_playmode_;
   }
   void set_gx_playmode(int value) {
+    MarkDirty();
     gx_playmode_ = value;
     has_gx_playmode_ = true;
   }
   void clear_gx_playmode() {
+    MarkDirty();
     gx_playmode_ = GX_PLAYMODE_PAUSE;
     has_gx_playmode_ = false;
   }
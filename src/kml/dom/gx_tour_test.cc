@@ -195,6 +195,10 @@ TEST_F(GxPlaylistTest, TestParse) {
         gx_playlist->get_gx_tourprimitive_array_at(0)));
   ASSERT_TRUE(AsGxFlyTo(gx_playlist->get_gx_tourprimitive_array_at(1)));
   ASSERT_TRUE(AsGxWait(gx_playlist->get_gx_tourprimitive_array_at(2)));
+  for (size_t i = 0; i < 3; ++i) {
+    ASSERT_EQ(gx_playlist,
+              gx_playlist->get_gx_tourprimitive_array_at(i)->GetParent());
+  }
 }
 
 TEST_F(GxPlaylistTest, TestSerialize) {
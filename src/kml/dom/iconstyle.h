@@ -55,10 +55,12 @@ class IconStyle : public ColorStyle {
     return has_scale_;
   }
   void set_scale(double scale) {
+    MarkDirty();
     scale_ = scale;
     has_scale_ = true;
   }
   void clear_scale() {
+    MarkDirty();
     scale_ = 1.0;
     has_scale_ = false;
   }
@@ -71,10 +73,12 @@ class IconStyle : public ColorStyle {
     return has_heading_;
   }
   void set_heading(double heading) {
+    MarkDirty();
     heading_ = heading;
     has_heading_ = true;
   }
   void clear_heading() {
+    MarkDirty();
     heading_ = 0.0;
     has_heading_ = false;
   }
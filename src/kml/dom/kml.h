@@ -50,10 +50,12 @@ class Kml : public BasicElement<Type_kml> {
   const string& get_hint() { return hint_; }
   bool has_hint() const { return has_hint_; }
   void set_hint(const string& hint) {
+    MarkDirty();
     hint_ = hint;
     has_hint_ = true;
   }
   void clear_hint() {
+    MarkDirty();
     hint_.clear();
     has_hint_ = false;
   }
@@ -41,6 +41,10 @@ KmlFactory* KmlFactory::GetFactory() {
   return factory_;
 }
 
+// The factory is created during static initialization, before any thread of
+// the program can call GetFactory(), such that GetFactory() never races.
+static const KmlFactory* const kFactory = KmlFactory::GetFactory();
+
 ElementPtr KmlFactory::CreateElementById(KmlDomType id) const {
   switch (id) {
   case Type_Alias: return CreateAlias();
@@ -32,7 +32,9 @@
 
 namespace kmldom {
 
-// A singleton factory class.
+// A singleton factory class.  The factory is created during static
+// initialization hence GetFactory() and the factory functions may be called
+// from any thread.
 class KmlFactory {
  public:
   static KmlFactory* GetFactory();
@@ -37,7 +37,8 @@ namespace kmldom {
 
 // Parse the KML in the given memory buffer.  On success this returns an
 // Element* to the root of the KML.  On failure 0 is returned and a human
-// readable error string is stored to errors if such is supplied.
+// readable error string is stored to errors if such is supplied.  Each
+// thread reuses one ParserSession for its calls (see parser_session.h).
 ElementPtr Parse(const string& xml, string* errors);
 
 // As Parse(), but invokes the underlying XML parser's namespace-aware mode.
@@ -33,6 +33,7 @@
 // 4a) call AddChild() for each ParserObserver.
 
 #include "kml/dom/kml_handler.h"
+#include <algorithm>
 #include "boost/scoped_ptr.hpp"
 #include "kml/base/attributes.h"
 #include "kml/dom/element.h"
@@ -55,13 +56,36 @@ kMaxNestingDepth = LIBKML_MAX_NESTING_DEPTH;
 
 namespace kmldom {
 
+// Marks a Field in KmlHandler::element_begins_.
+static const size_t kNoSourceRange = static_cast<size_t>(-1);
+
 KmlHandler::KmlHandler(parser_observer_vector_t& observers)
   : kml_factory_(*KmlFactory::GetFactory()),
     skip_depth_(0),
+    filter_depth_(0),
     in_description_(0),
     nesting_depth_(0),
     in_old_schema_placemark_(false),
-    observers_(observers) {
+    observers_(observers),
+    fragment_(NULL),
+    string_pool_(NULL),
+    parse_profile_(NULL),
+    parse_filter_(NULL) {
+}
+
+KmlHandler::KmlHandler(parser_observer_vector_t& observers,
+                       KmlFragment* fragment, unsigned int nesting_depth)
+  : kml_factory_(*KmlFactory::GetFactory()),
+    skip_depth_(0),
+    filter_depth_(0),
+    in_description_(0),
+    nesting_depth_(nesting_depth),
+    in_old_schema_placemark_(false),
+    observers_(observers),
+    fragment_(fragment),
+    string_pool_(NULL),
+    parse_profile_(NULL),
+    parse_filter_(NULL) {
 }
 
 KmlHandler::~KmlHandler() {
@@ -71,11 +95,25 @@ KmlHandler::~KmlHandler() {
 
 void KmlHandler::StartElement(const string& name,
                               const StringVector& attrs) {
+  // Nothing inside an unknown element needs its type.
+  StartElementById(name,
+                   skip_depth_ > 0 ? Type_Unknown : static_cast<KmlDomType>(
+                       Xsd::GetSchema()->ElementId(name)),
+                   attrs);
+}
+
+void KmlHandler::StartElementById(const string& name, KmlDomType type_id,
+                                  const StringVector& attrs) {
   // Check that we're not nested beyond the max permissible depth.
   if (++nesting_depth_ > kMaxNestingDepth) {
     XML_StopParser(get_parser(), XML_TRUE);
     return;
   }
+  // Nothing within an element left out by the ParseFilter is looked at.
+  if (filter_depth_ > 0) {
+    ++filter_depth_;
+    return;
+  }
   // 3 possibilities:
   // 1) complex element: create an Element.
   // 2) simple element: create a Field
@@ -95,6 +133,11 @@ void KmlHandler::StartElement(const string& name,
     // We're already inside an unknown element. Stringify the next element and
     // its attributes, increment the skip counter again, and return
     // immediately.
+    if (parse_profile_) {
+      parse_profile_->AddElement(Type_Unknown);
+    }
+    ParseProfileInterval interval(parse_profile_, Type_Unknown,
+                                  ParseProfile::PHASE_ADD_ELEMENT);
     InsertUnknownStartElement(name, attrs);
     skip_depth_++;
     return;
@@ -113,6 +156,20 @@ void KmlHandler::StartElement(const string& name,
     FindOldSchemaParentName(attrs, &old_schema_name_);
   }
 
+  // If we're parsing old Schema usage, we force the creation of a Placemark.
+  if (!old_schema_name_.empty() && name == old_schema_name_) {
+    // Treat this as a Placemark.
+    type_id = Type_Placemark;
+  }
+
+  // An element left out by the ParseFilter is skipped until its end tag.
+  if (parse_filter_ && !stack_.empty() &&
+      !parse_filter_->KeepsChild(stack_.top(), type_id)) {
+    filter_depth_ = 1;
+    ClearElementBegins();
+    return;
+  }
+
   // Push a string onto the stack we'll use to manage the gathering of
   // character data.
   string element_char_data;
@@ -120,35 +177,43 @@ void KmlHandler::StartElement(const string& name,
 
   ElementPtr element;
 
-  KmlDomType type_id =
-    static_cast<KmlDomType>(Xsd::GetSchema()->ElementId(name));
-
-  // If we're parsing old Schema usage, we force the creation of a Placemark.
-  if (!old_schema_name_.empty() && name == old_schema_name_) {
-    // Treat this as a Placemark.
-    type_id = Type_Placemark;
-  }
-
   XsdType xsd_type = Xsd::GetSchema()->ElementType(type_id);
-  if ((xsd_type == XSD_COMPLEX_TYPE) &&
-      (element = kml_factory_.CreateElementById(type_id))) {
+  if (xsd_type == XSD_COMPLEX_TYPE) {
+    ParseProfileInterval interval(parse_profile_, type_id,
+                                  ParseProfile::PHASE_CREATE);
+    element = kml_factory_.CreateElementById(type_id);
 
     // Icon as a child of IconStyle is really IconStyleIcon
-    if (element->Type() == Type_Icon) {
+    if (element && element->Type() == Type_Icon) {
       // If there is a parent and it is IconStyle...
       if (!stack_.empty() && stack_.top()->Type() == Type_IconStyle) {
         // ... delete the Icon and create an IconStyleIcon instead.
         element = kml_factory_.CreateElementById(Type_IconStyleIcon);
       }
     }
-
+  }
+  if (element) {
     // We parse attributes only if StartElement received any.
     if (!attrs.empty()) {
-      // Element::ParseAttributes takes ownership of the created Attributes.
-      element->ParseAttributes(Attributes::Create(attrs));
+      ParseProfileInterval interval(parse_profile_, element->Type(),
+                                    ParseProfile::PHASE_ATTRIBUTES);
+      // Most attributes are just an Object's id and/or targetId which are
+      // set directly with no intermediate Attributes.
+      Object* object = element->IsA(Type_Object) ?
+          static_cast<Object*>(element.get()) : NULL;
+      if (!object || !object->ParseIdAttributes(attrs)) {
+        // Element::ParseAttributes takes ownership of the created Attributes.
+        Attributes* attributes = Attributes::Create(attrs);
+        attributes->set_string_pool(string_pool_);
+        element->ParseAttributes(attributes);
+      }
     }
   } else if (xsd_type == XSD_SIMPLE_TYPE) {
-    element = kml_factory_.CreateFieldById(type_id);
+    ParseProfileInterval interval(parse_profile_, type_id,
+                                  ParseProfile::PHASE_CREATE);
+    Field* field = kml_factory_.CreateFieldById(type_id);
+    field->set_string_pool(string_pool_);
+    element = field;
   } else if (xsd_type == XSD_UNKNOWN && !old_schema_name_.empty()) {
     // We might be parsing one of the children of the old schema usage.
     in_old_schema_placemark_ = ParseOldSchemaChild(name, simplefield_name_vec_,
@@ -169,12 +234,24 @@ void KmlHandler::StartElement(const string& name,
     // The transition point from known to unknown KML. We treat everything
     // from this point as a string until EndElement has decremented the
     // skip_depth_ counter to 0.
+    if (parse_profile_) {
+      parse_profile_->AddElement(Type_Unknown);
+    }
+    ParseProfileInterval interval(parse_profile_, Type_Unknown,
+                                  ParseProfile::PHASE_ADD_ELEMENT);
     InsertUnknownStartElement(name, attrs);
     skip_depth_++;
     return;
   }
   // This is a known element.  Push onto parse stack and gather content.
   stack_.push(element);
+  if (source_buffer_ && !fragment_) {
+    element_begins_.push_back(xsd_type == XSD_COMPLEX_TYPE ?
+                              GetByteIndex() : kNoSourceRange);
+  }
+  if (parse_profile_) {
+    parse_profile_->AddElement(element->Type());
+  }
 
   // We need to permit parsing of un-CDATA'd markup inside <description>
   // elements. We bump the skip counter here as if we'd encountered an unknown
@@ -186,6 +263,11 @@ void KmlHandler::StartElement(const string& name,
     in_description_++;
   }
 
+  // The stand-in parent of a fragment is not seen by any ParserObserver.
+  if (fragment_ && stack_.size() == 1) {
+    return;
+  }
+
   // Call the NewElement() method of each ParserObserver.  The whole parse
   // terminates if and when any observer's NewElement() returns false.
   if (!CallNewElementObservers(observers_, element)) {
@@ -196,6 +278,8 @@ void KmlHandler::StartElement(const string& name,
 // private
 bool KmlHandler::CallNewElementObservers(
     const parser_observer_vector_t& observers, const ElementPtr& element) {
+  ParseProfileInterval interval(parse_profile_, element->Type(),
+                                ParseProfile::PHASE_OBSERVERS);
   for (size_t i = 0; i < observers_.size(); ++i) {
     if (!observers_[i]->NewElement(element)) {
       return false;
@@ -206,6 +290,10 @@ bool KmlHandler::CallNewElementObservers(
 
 void KmlHandler::EndElement(const string& name) {
   --nesting_depth_;
+  if (filter_depth_ > 0) {
+    --filter_depth_;
+    return;
+  }
   // See the comment towards the end of StartElement about handling "raw" HTML
   // inside <description> elements. Here we are checking to see if (1) we're
   // inside a closing </description> element and (2) if we're at the end of any
@@ -217,12 +305,22 @@ void KmlHandler::EndElement(const string& name) {
   if (skip_depth_ > 0) {
     // We're inside an unknown element. Build the closing tag, decrement
     // the skip counter and then check if we're back to known KML.
+    ParseProfileInterval interval(parse_profile_, Type_Unknown,
+                                  ParseProfile::PHASE_ADD_ELEMENT);
     InsertUnknownEndElement(name);
     if (--skip_depth_ == 0) {
-      // The next element will be known KML. Push the gathered char_data_ up
+      // The next element will be known KML. Hand the gathered char_data_ up
       // to Element as a string for serializiation later on.
       char_data_.top().append("\n");
-      stack_.top()->AddUnknownElement(char_data_.top());
+      if (parse_profile_) {
+        parse_profile_->AddCharData(Type_Unknown, char_data_.top().size());
+      }
+      if (fragment_ && stack_.size() == 1) {
+        fragment_->unknown_elements_.push_back(string());
+        fragment_->unknown_elements_.back().swap(char_data_.top());
+      } else {
+        stack_.top()->TakeUnknownElement(&char_data_.top());
+      }
       char_data_.pop();
     }
     return;
@@ -251,17 +349,32 @@ void KmlHandler::EndElement(const string& name) {
   // The top of the stack is the begin of the element ending here.
   ElementPtr child = stack_.top();
 
-  string child_char_data_ = char_data_.top();
-  char_data_.pop();
+  if (parse_profile_) {
+    parse_profile_->AddCharData(child->Type(), char_data_.top().size());
+  }
+  {
+    ParseProfileInterval interval(parse_profile_, child->Type(),
+                                  ParseProfile::PHASE_ADD_ELEMENT);
+    child->set_char_data(char_data_.top());
+    char_data_.pop();
 
-  child->set_char_data(child_char_data_);
+    if (child->Type() == Type_coordinates ||
+        child->Type() == Type_Snippet ||
+        child->Type() == Type_linkSnippet ||
+        child->Type() == Type_SimpleData) {
+      // These are effectively complex elements, but with character data.
+      child->AddElement(child);  // "Parse yourself"
+    }
+  }
 
-  if (child->Type() == Type_coordinates ||
-      child->Type() == Type_Snippet ||
-      child->Type() == Type_linkSnippet ||
-      child->Type() == Type_SimpleData) {
-    // These are effectively complex elements, but with character data.
-    child->AddElement(child);  // "Parse yourself"
+  // The range is set once the element has parsed its own character data.
+  if (!element_begins_.empty()) {
+    size_t begin = element_begins_.back();
+    element_begins_.pop_back();
+    if (begin != kNoSourceRange && old_schema_name_.empty()) {
+      child->set_source_range(
+          SourceSlice(source_buffer_, begin, GetByteEnd() - begin));
+    }
   }
 
   // Check if we're parsing old-style Schema KML. If we are, and if this
@@ -288,7 +401,22 @@ void KmlHandler::EndElement(const string& name) {
     // or 3) unknown is passed onwards to its parent and possibly ultimately
     // to the unknown element list in Element.
     stack_.pop();
-    if (CallEndElementObservers(observers_, stack_.top(), child)) {
+    if (fragment_ && stack_.size() == 1) {
+      // A child of the stand-in parent is saved for AppendFragment().
+      fragment_->AddEvent(KmlFragment::EVENT_SIBLING, NULL, child);
+      return;
+    }
+    // A Feature the ParseFilter does not keep is dropped as if an observer
+    // had refused it.
+    bool keep = true;
+    if (parse_filter_ && child->IsA(Type_Feature) &&
+        !parse_filter_->KeepsFeature(AsFeature(child))) {
+      keep = false;
+      ClearElementBegins();
+    }
+    if (keep && CallEndElementObservers(observers_, stack_.top(), child)) {
+      ParseProfileInterval interval(parse_profile_, child->Type(),
+                                    ParseProfile::PHASE_ADD_ELEMENT);
       stack_.top()->AddElement(child);
     }
     if (!CallAddChildObservers(observers_, stack_.top(), child)) {
@@ -297,9 +425,16 @@ void KmlHandler::EndElement(const string& name) {
   }
 }
 
+// private
+void KmlHandler::ClearElementBegins() {
+  std::fill(element_begins_.begin(), element_begins_.end(), kNoSourceRange);
+}
+
 bool KmlHandler::CallEndElementObservers(
     const parser_observer_vector_t& observers, const ElementPtr& parent,
     const ElementPtr& child) {
+  ParseProfileInterval interval(parse_profile_, child->Type(),
+                                ParseProfile::PHASE_OBSERVERS);
   for (size_t i = 0; i < observers_.size(); ++i) {
     if (!observers_[i]->EndElement(parent, child)) {
       return false;
@@ -312,6 +447,8 @@ bool KmlHandler::CallEndElementObservers(
 bool KmlHandler::CallAddChildObservers(
     const parser_observer_vector_t& observers, const ElementPtr& parent,
     const ElementPtr& child) {
+  ParseProfileInterval interval(parse_profile_, child->Type(),
+                                ParseProfile::PHASE_OBSERVERS);
   for (size_t i = 0; i < observers_.size(); ++i) {
     if (!observers_[i]->AddChild(parent, child)) {
       return false;
@@ -320,6 +457,73 @@ bool KmlHandler::CallAddChildObservers(
   return true;
 }
 
+bool KmlHandler::AppendFragment(const KmlFragment& fragment) {
+  if (stack_.empty() || skip_depth_ > 0) {
+    return false;
+  }
+  const ElementPtr& parent = stack_.top();
+  std::vector<KmlFragment::Event>::const_iterator iter =
+      fragment.events_.begin();
+  for (; iter != fragment.events_.end(); ++iter) {
+    switch (iter->kind) {
+      case KmlFragment::EVENT_NEW_ELEMENT:
+        if (!CallNewElementObservers(observers_, iter->child)) {
+          return false;
+        }
+        break;
+      case KmlFragment::EVENT_END_ELEMENT:
+        // The child was already added to its parent within the fragment.
+        CallEndElementObservers(observers_, iter->parent, iter->child);
+        break;
+      case KmlFragment::EVENT_ADD_CHILD:
+        if (!CallAddChildObservers(observers_, iter->parent, iter->child)) {
+          return false;
+        }
+        break;
+      case KmlFragment::EVENT_SIBLING:
+        if (CallEndElementObservers(observers_, parent, iter->child)) {
+          ParseProfileInterval interval(parse_profile_, iter->child->Type(),
+                                        ParseProfile::PHASE_ADD_ELEMENT);
+          parent->AddElement(iter->child);
+        }
+        if (!CallAddChildObservers(observers_, parent, iter->child)) {
+          return false;
+        }
+        break;
+    }
+  }
+  for (size_t i = 0; i < fragment.unknown_elements_.size(); ++i) {
+    parent->AddUnknownElement(fragment.unknown_elements_[i]);
+  }
+  return true;
+}
+
+bool KmlFragment::NewElement(const ElementPtr& element) {
+  AddEvent(EVENT_NEW_ELEMENT, NULL, element);
+  return true;
+}
+
+bool KmlFragment::EndElement(const ElementPtr& parent,
+                             const ElementPtr& child) {
+  AddEvent(EVENT_END_ELEMENT, parent, child);
+  return true;
+}
+
+bool KmlFragment::AddChild(const ElementPtr& parent, const ElementPtr& child) {
+  AddEvent(EVENT_ADD_CHILD, parent, child);
+  return true;
+}
+
+// Private.
+void KmlFragment::AddEvent(EventKind kind, const ElementPtr& parent,
+                           const ElementPtr& child) {
+  events_.push_back(Event());
+  Event& event = events_.back();
+  event.kind = kind;
+  event.parent = parent;
+  event.child = child;
+}
+
 // Note the handling of char data w.r.t. unknown elements. If we are within
 // a known element that cannot contain char data, setting it in EndElement is
 // a no-op. For known elements within unknown elements, everything is treated
@@ -328,6 +532,9 @@ bool KmlHandler::CallAddChildObservers(
 // <Placemark><Point><coordinates/></Point></Placemark>
 // <X><Point>foo<coordinates/>bar</Point></P> remains as-is.
 void KmlHandler::CharData(const string& s) {
+  if (filter_depth_ > 0) {
+    return;
+  }
   char_data_.top().append(s);
 }
 
@@ -345,28 +552,44 @@ ElementPtr KmlHandler::PopRoot() {
   return NULL;
 }
 
+void KmlHandler::Reset() {
+  while (!stack_.empty()) {
+    stack_.pop();
+  }
+  while (!char_data_.empty()) {
+    char_data_.pop();
+  }
+  element_begins_.clear();
+  skip_depth_ = 0;
+  filter_depth_ = 0;
+  in_description_ = 0;
+  nesting_depth_ = 0;
+  in_old_schema_placemark_ = false;
+  old_schema_name_.clear();
+  simplefield_name_vec_.clear();
+  simpledata_vec_.clear();
+}
+
+// Private.
+size_t KmlHandler::GetByteIndex() {
+  XML_Index index = XML_GetCurrentByteIndex(get_parser());
+  return index < 0 ? 0 : static_cast<size_t>(index);
+}
+
+// Private.
+size_t KmlHandler::GetByteEnd() {
+  return GetByteIndex() + XML_GetCurrentByteCount(get_parser());
+}
+
 // Private.
 void KmlHandler::InsertUnknownStartElement(const string& name,
                                            const StringVector& atts) {
-  string& top = char_data_.top();
-  top.append("<");
-  top.append(name);
-  for (size_t i = 0; i < atts.size(); i += 2)  {
-    top.append(" ");
-    top.append(atts.at(i));
-    top.append("=\"");
-    top.append(atts.at(i+1));
-    top.append("\"");
-  }
-  top.append(">");
+  AppendUnknownStartTag(name, atts, &char_data_.top());
 }
 
 // Private.
 void KmlHandler::InsertUnknownEndElement(const string& name) {
-  string& top = char_data_.top();
-  top.append("</");
-  top.append(name);
-  top.append(">");
+  AppendUnknownEndTag(name, &char_data_.top());
 }
 
 // Static, private.
@@ -75,20 +75,72 @@
 #define KML_DOM_KML_HANDLER_H__
 
 #include <stack>
+#include <vector>
 #include "kml/base/expat_handler.h"
 #include "kml/dom/element.h"
 #include "kml/dom/kml_ptr.h"
+#include "kml/dom/parse_filter.h"
+#include "kml/dom/parse_profile.h"
 #include "kml/dom/parser_observer.h"
 
 namespace kmldom {
 
 class KmlFactory;
 
+// A KmlFragment is the result of parsing a run of sibling elements on their
+// own, as Parser::ParseParallel() does for each chunk of a large document.
+// The siblings are parsed inside a copy of their parent's start and end tags
+// by a KmlHandler constructed with this fragment.  Rather than being added
+// to that stand-in parent the siblings are saved here in document order
+// along with any unknown siblings.  A KmlFragment is also a ParserObserver:
+// when passed to the KmlHandler as its observer it records each call so that
+// KmlHandler::AppendFragment() can later replay the calls in order to the
+// real observers.
+class KmlFragment : public ParserObserver {
+ public:
+  KmlFragment() {}
+
+  // ParserObserver methods.  These record the call and return true.
+  virtual bool NewElement(const ElementPtr& element);
+  virtual bool EndElement(const ElementPtr& parent, const ElementPtr& child);
+  virtual bool AddChild(const ElementPtr& parent, const ElementPtr& child);
+
+  // Releases all elements and recorded calls.
+  void clear() {
+    events_.clear();
+    unknown_elements_.clear();
+  }
+
+ private:
+  friend class KmlHandler;
+  enum EventKind {
+    EVENT_NEW_ELEMENT,
+    EVENT_END_ELEMENT,
+    EVENT_ADD_CHILD,
+    EVENT_SIBLING  // A complete sibling to add to the real parent.
+  };
+  struct Event {
+    EventKind kind;
+    ElementPtr parent;
+    ElementPtr child;
+  };
+  void AddEvent(EventKind kind, const ElementPtr& parent,
+                const ElementPtr& child);
+  std::vector<Event> events_;
+  std::vector<string> unknown_elements_;
+  LIBKML_DISALLOW_EVIL_CONSTRUCTORS(KmlFragment);
+};
+
 // This class implements the expat handlers for parsing KML.  This class is
 // handed to expat in the ExpatParser() function.
 class KmlHandler : public kmlbase::ExpatHandler {
 public:
   KmlHandler(parser_observer_vector_t& observers);
+  // This creates a KmlHandler which parses a stand-in parent element and
+  // saves its children to the given KmlFragment.  The nesting_depth is the
+  // number of ancestors of the real parent in the full document.
+  KmlHandler(parser_observer_vector_t& observers, KmlFragment* fragment,
+             unsigned int nesting_depth);
   ~KmlHandler();
 
   // ExpatHandler methods
@@ -102,6 +154,61 @@ public:
   // after a successful parse.
   ElementPtr PopRoot();
 
+  // This readies the handler for another document.  Any Elements of the
+  // last document still on the stack are released.  The capacity of the
+  // stacks and buffers is kept as are the observers, string pool, profile,
+  // filter and source buffer settings.  This is not for a handler parsing a
+  // KmlFragment.
+  void Reset();
+
+  // This adds the children saved in the given KmlFragment to the Element on
+  // the top of the stack calling this handler's ParserObservers exactly as if
+  // the fragment's markup had been parsed in place.  Observer calls recorded
+  // within the fragment are replayed in order.  Since the fragment is already
+  // built a replayed EndElement() returning false cannot prevent a child from
+  // being added, but it is honored for the fragment's top-level children.
+  // This returns false if any ParserObserver terminates the parse.
+  bool AppendFragment(const KmlFragment& fragment);
+
+  // Repeated values of the string fields and attributes which are held as a
+  // kmlbase::InternedString (such as <styleUrl> and <Data name="...">) are
+  // interned in the given StringPool.  The pool is not owned by the handler
+  // and must outlive the parse.  The default is no pool.
+  void set_string_pool(kmlbase::StringPool* string_pool) {
+    string_pool_ = string_pool;
+  }
+
+  // The time spent on each type of element is gathered in the given
+  // ParseProfile.  The profile is not owned by the handler.  The default is
+  // no profile which costs no more than a test for NULL for each phase of
+  // each element.
+  void set_parse_profile(ParseProfile* parse_profile) {
+    parse_profile_ = parse_profile;
+  }
+
+  // If the handler is given the SourceBuffer holding the very text being
+  // parsed each complex Element is given its range of the buffer (see
+  // Element::set_source_range()) unless it ends after an old style <Schema>
+  // as that is rewritten.  The buffer is not used when parsing a fragment.
+  // The default is no buffer.
+  void set_source_buffer(const SourceBufferPtr& source_buffer) {
+    source_buffer_ = source_buffer;
+  }
+
+  // Only the parts of the KML kept by the given ParseFilter are parsed.
+  // The filter is not owned by the handler and must outlive the parse.  The
+  // default is no filter.
+  void set_parse_filter(const ParseFilter* parse_filter) {
+    parse_filter_ = parse_filter;
+  }
+
+protected:
+  // This is StartElement() for an element whose type is already known, as
+  // when a namespace-aware handler finds it from the namespace and local
+  // name.  Type_Unknown is used for an unknown element.
+  void StartElementById(const string& name, KmlDomType type_id,
+                        const kmlbase::StringVector& atts);
+
 private:
   const KmlFactory& kml_factory_;
   std::stack<ElementPtr> stack_;
@@ -113,7 +220,16 @@ private:
                                  const kmlbase::StringVector& atts);
   void InsertUnknownEndElement(const string& name);
   unsigned int skip_depth_;
+  // The depth within an element left out by the parse_filter_.
+  unsigned int filter_depth_;
   unsigned int in_description_;
+  // The source of a parse which sets the source ranges of the Elements.
+  SourceBufferPtr source_buffer_;
+  // The offset of the start tag of each Element on the stack_, or
+  // kNoSourceRange for a Field.
+  std::vector<size_t> element_begins_;
+  size_t GetByteIndex();
+  size_t GetByteEnd();
   unsigned int nesting_depth_;
   // TODO: these next four are for the purpose of handling old-style <Schema>
   // usage. Instead of creating these by default, we could move them into
@@ -172,6 +288,14 @@ private:
       const std::vector<SimpleDataPtr> simpledata_vec);
 
   const parser_observer_vector_t& observers_;
+  // NULL unless this handler is parsing a fragment.
+  KmlFragment* fragment_;
+  kmlbase::StringPool* string_pool_;
+  ParseProfile* parse_profile_;
+  const ParseFilter* parse_filter_;
+  // Drops the source ranges of the Elements on the stack_ as they no longer
+  // match their content.
+  void ClearElementBegins();
   LIBKML_DISALLOW_EVIL_CONSTRUCTORS(KmlHandler);
 };
 
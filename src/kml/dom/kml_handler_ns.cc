@@ -29,6 +29,7 @@
 #include "kml/dom/kml_handler_ns.h"
 #include "kml/dom/parser.h"  // for kXmlnsSeparator.
 #include <string.h>  // For strchr().
+#include "kml/dom/xsd.h"
 
 namespace kmldom {
 
@@ -37,7 +38,8 @@ namespace kmldom {
 static const char kXmlnsSeparator = '|';
 
 KmlHandlerNS::KmlHandlerNS(parser_observer_vector_t& observers)
-  : KmlHandler(observers) {
+  : KmlHandler(observers),
+    qualify_unknown_names_(false) {
 }
 
 KmlHandlerNS::~KmlHandlerNS() {
@@ -45,17 +47,13 @@ KmlHandlerNS::~KmlHandlerNS() {
 
 void KmlHandlerNS::StartElement(const string& name,
                                 const kmlbase::StringVector& atts) {
-  // Expat guarantees that there will be delimited uri-name string here.
-
-  size_t token = name.find_last_of(kXmlnsSeparator) + 1;
-  KmlHandler::StartElement(name.substr(token), atts);
+  KmlDomType type_id;
+  const string& element_name = ResolveName(name, &type_id);
+  StartElementById(element_name, type_id, atts);
 }
 
 void KmlHandlerNS::EndElement(const string& name) {
-  // Expat guarantees that there will be delimited uri-name string here.
-
-  size_t token = name.find_last_of(kXmlnsSeparator) + 1;
-  KmlHandler::EndElement(name.substr(token));
+  KmlHandler::EndElement(ResolveName(name, NULL));
 }
 
 void KmlHandlerNS::CharData(const string& s) {
@@ -64,12 +62,70 @@ void KmlHandlerNS::CharData(const string& s) {
 
 void KmlHandlerNS::StartNamespace(const string& prefix,
                                   const string& uri) {
-  // TODO: save the uri:prefix mappings.
-  // TODO: enforce the rule that the ONLY default namespace is KML's?
-  // TODO: enforce that there must be a 1:1 uri:prefix mapping per file?
+  // Only the namespace matters as expat resolves the prefixes.
+  FindXmlnsId(uri, uri.size());
 }
 
 void KmlHandlerNS::EndNamespace(const string& prefix) {
 }
 
+// private
+const string& KmlHandlerNS::ResolveName(const string& name,
+                                        KmlDomType* type_id) {
+  // Expat omits the separator for an element in no namespace.
+  size_t separator = name.find_last_of(kXmlnsSeparator);
+  kmlbase::XmlnsId xmlns_id = kmlbase::XMLNS_KML22;
+  size_t token = 0;
+  if (separator != string::npos) {
+    xmlns_id = FindXmlnsId(name, separator);
+    token = separator + 1;
+  }
+  if (type_id) {
+    *type_id = xmlns_id == kmlbase::XMLNS_NONE ? Type_Unknown :
+        static_cast<KmlDomType>(Xsd::GetSchema()->ElementId(
+            xmlns_id, name.data() + token, name.size() - token));
+  }
+  if (qualify_unknown_names_ && xmlns_id != kmlbase::XMLNS_KML22) {
+    if (xmlns_id != kmlbase::XMLNS_ATOM) {
+      return name;
+    }
+    local_name_.assign("atom:");
+    local_name_.append(name, token, string::npos);
+    return local_name_;
+  }
+  local_name_.assign(name, token, string::npos);
+  return local_name_;
+}
+
+// These are the namespaces of the older KML versions which are parsed as
+// KML 2.2 (as is the KML 2.2 namespace itself).
+static const char* kOldKmlNamespaces[] = {
+  "http://earth.google.com/kml/2.0",
+  "http://earth.google.com/kml/2.1",
+  "http://earth.google.com/kml/2.2",
+  NULL
+};
+
+// private
+kmlbase::XmlnsId KmlHandlerNS::FindXmlnsId(const string& name, size_t size) {
+  for (size_t i = 0; i < xmlns_ids_.size(); ++i) {
+    if (xmlns_ids_[i].first.size() == size &&
+        name.compare(0, size, xmlns_ids_[i].first) == 0) {
+      return xmlns_ids_[i].second;
+    }
+  }
+  const string xml_namespace(name, 0, size);
+  kmlbase::XmlnsId xmlns_id = kmlbase::XMLNS_NONE;
+  if (!kmlbase::FindXmlnsIdByNamespace(xml_namespace, &xmlns_id)) {
+    for (const char** old = kOldKmlNamespaces; *old; ++old) {
+      if (xml_namespace == *old) {
+        xmlns_id = kmlbase::XMLNS_KML22;
+        break;
+      }
+    }
+  }
+  xmlns_ids_.push_back(std::make_pair(xml_namespace, xmlns_id));
+  return xmlns_id;
+}
+
 }  // end namespace kmldom
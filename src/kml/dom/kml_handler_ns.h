@@ -32,8 +32,11 @@
 
 #include <stack>
 #include <string>
+#include <utility>
+#include <vector>
 #include "kml_handler.h"
 #include "kml/base/expat_handler.h"
+#include "kml/base/xml_namespaces.h"
 #include "kml/dom/element.h"
 #include "kml/dom/kml_ptr.h"
 #include "kml/dom/parser_observer.h"
@@ -43,6 +46,11 @@ namespace kmldom {
 class KmlFactory;
 
 // This subclass of KmlHandler is used with Expat's namespace-aware parsing.
+// Each element is found from its namespace and local name such that, for
+// example, "gx:Track" is known no matter what prefix the file uses for the
+// gx namespace.  Elements with no namespace or in any KML namespace are
+// looked up as KML 2.2.  The element name KmlHandler uses in the tags of
+// unknown elements is the local name.
 class KmlHandlerNS : public KmlHandler {
  public:
   KmlHandlerNS(parser_observer_vector_t& observers);
@@ -57,8 +65,30 @@ class KmlHandlerNS : public KmlHandler {
                               const string &uri);
   virtual void EndNamespace(const string &prefix);
 
+  // With this set an unknown element in the Atom namespace is named
+  // "atom:local-name" and one in any namespace other than KML or Atom keeps
+  // the full "uri|local-name" from expat.  This is how ParseAtom() names
+  // unknown elements such as the GData extensions AtomUtil looks for.  The
+  // default is false.
+  void set_qualify_unknown_names(bool qualify_unknown_names) {
+    qualify_unknown_names_ = qualify_unknown_names;
+  }
+
  private:
-  // TODO: A map of namespace URIs to their prefixes found during the parse.
+  // This finds the type of the element with the given "uri|local-name" if
+  // type_id is not NULL and returns the name KmlHandler uses for it.
+  const string& ResolveName(const string& name, KmlDomType* type_id);
+
+  // This returns the XmlnsId used to look up elements of the namespace
+  // which is the size chars at the start of name.  Each namespace is found
+  // once, typically by StartNamespace(), and saved in xmlns_ids_.
+  kmlbase::XmlnsId FindXmlnsId(const string& name, size_t size);
+
+  typedef std::vector<std::pair<string, kmlbase::XmlnsId> > xmlns_id_vector_t;
+  xmlns_id_vector_t xmlns_ids_;
+  // This is reused for the name of each element returned by ResolveName().
+  string local_name_;
+  bool qualify_unknown_names_;
   LIBKML_DISALLOW_EVIL_CONSTRUCTORS(KmlHandlerNS);
 };
 
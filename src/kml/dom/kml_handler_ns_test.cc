@@ -187,13 +187,16 @@ TEST_F(KmlHandlerNSTest, TestNamespaceParsing) {
   ASSERT_TRUE(root);
 
   // TODO: ultimately the parse is preserved 1:1. Currently the parse will
-  // drop the xmlns attrs and the element prefixes so this is a test of an
-  // incomplete implementation.
+  // drop the xmlns attrs and the prefixes of unknown elements (the gx
+  // namespace here is not the real one) so this is a test of an incomplete
+  // implementation.
   const string kExpectedSerializedKml =
     "<kml>\n"
     "  <Folder>\n"
     "    <name>a KML folder</name>\n"
-    "    <author><name>an atom author name</name></author>\n"
+    "    <atom:author>\n"
+    "      <atom:name>an atom author name</atom:name>\n"
+    "    </atom:author>\n"
     "    <Tour><name>an extension tour name</name></Tour>\n"
     "  </Folder>\n"
     "</kml>\n";
@@ -201,4 +204,41 @@ TEST_F(KmlHandlerNSTest, TestNamespaceParsing) {
   ASSERT_EQ(kExpectedSerializedKml, SerializePretty(root));
 }
 
+// Verify that elements are found by namespace and not by prefix.
+TEST_F(KmlHandlerNSTest, TestQualifiedNames) {
+  // The gx namespace under another prefix is still gx.
+  kml_handler_ns_->StartNamespace("ext", "http://www.google.com/kml/ext/2.2");
+  kml_handler_ns_->StartElement("http://www.google.com/kml/ext/2.2|Track",
+                                atts_);
+  kml_handler_ns_->EndElement("http://www.google.com/kml/ext/2.2|Track");
+  ElementPtr root = kml_handler_ns_->PopRoot();
+  ASSERT_TRUE(root);
+  ASSERT_EQ(Type_GxTrack, root->Type());
+
+  // A KML name in some other namespace is not KML.
+  kml_handler_ns_->StartElement("http://www.opengis.net/kml/2.2|Document",
+                                atts_);
+  kml_handler_ns_->StartElement("http://example.com/ns|name", atts_);
+  kml_handler_ns_->EndElement("http://example.com/ns|name");
+  kml_handler_ns_->EndElement("http://www.opengis.net/kml/2.2|Document");
+  root = kml_handler_ns_->PopRoot();
+  ASSERT_TRUE(root);
+  ASSERT_EQ(Type_Document, root->Type());
+  ASSERT_FALSE(AsDocument(root)->has_name());
+  ASSERT_EQ(static_cast<size_t>(1), root->get_unknown_elements_array_size());
+}
+
+// Verify that the older KML namespaces and no namespace at all are KML.
+TEST_F(KmlHandlerNSTest, TestKmlNamespaces) {
+  Parser parser;
+  ElementPtr root = parser.ParseNS(
+      "<Placemark xmlns=\"http://earth.google.com/kml/2.1\">"
+      "<name>a</name></Placemark>", NULL);
+  ASSERT_TRUE(AsPlacemark(root));
+  ASSERT_EQ(string("a"), AsPlacemark(root)->get_name());
+  root = parser.ParseNS("<Placemark><name>b</name></Placemark>", NULL);
+  ASSERT_TRUE(AsPlacemark(root));
+  ASSERT_EQ(string("b"), AsPlacemark(root)->get_name());
+}
+
 }  // end namespace kmldom
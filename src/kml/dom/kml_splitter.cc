@@ -0,0 +1,295 @@
+// Copyright 2008, Google Inc. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//  3. Neither the name of Google Inc. nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// This file contains the implementation of the internal SplitKml() function.
+
+#include "kml/dom/kml_splitter.h"
+#include <cstring>
+
+namespace kmldom {
+
+namespace {
+
+typedef std::vector<std::pair<string, string> > AttributeVector;
+
+// The parts of a start tag SplitKml() cares about.
+struct StartTag {
+  string name;
+  AttributeVector xmlns_attributes;
+  bool has_parent_attribute;
+  bool is_empty;  // <name/>
+  size_t end;  // Just past the closing '>'.
+};
+
+}  // end anonymous namespace
+
+static bool IsSpace(char c) {
+  return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+static bool StartsWith(const char* data, size_t size, size_t pos,
+                       const char* prefix) {
+  size_t len = strlen(prefix);
+  return pos + len <= size && memcmp(data + pos, prefix, len) == 0;
+}
+
+// Returns the offset just past the first terminator found at or after pos,
+// or string::npos if there is none.
+static size_t SkipPast(const string& kml, size_t pos, const char* terminator) {
+  size_t found = kml.find(terminator, pos);
+  return found == string::npos ? found : found + strlen(terminator);
+}
+
+static bool IsXmlnsAttribute(const string& name) {
+  return name.compare(0, 5, "xmlns") == 0 &&
+      (name.size() == 5 || name[5] == ':');
+}
+
+// Saves the given namespace declarations.  A declaration repeated on a nested
+// element replaces the outer one.
+static void SaveXmlnsAttributes(const AttributeVector& attributes,
+                                AttributeVector* in_scope) {
+  for (size_t i = 0; i < attributes.size(); ++i) {
+    size_t j = 0;
+    while (j < in_scope->size() &&
+           (*in_scope)[j].first != attributes[i].first) {
+      ++j;
+    }
+    if (j == in_scope->size()) {
+      in_scope->push_back(attributes[i]);
+    } else {
+      (*in_scope)[j].second = attributes[i].second;
+    }
+  }
+}
+
+// Formats the attributes as they would appear in a start tag.
+static void FormatAttributes(const AttributeVector& attributes,
+                             string* output) {
+  for (size_t i = 0; i < attributes.size(); ++i) {
+    const string& value = attributes[i].second;
+    const char quote = value.find('"') == string::npos ? '"' : '\'';
+    output->append(" ");
+    output->append(attributes[i].first);
+    output->push_back('=');
+    output->push_back(quote);
+    output->append(value);
+    output->push_back(quote);
+  }
+}
+
+// Scans the start tag at kml[pos] == '<'.  Returns false if the tag is not
+// terminated or its attributes are malformed.
+static bool ScanStartTag(const string& kml, size_t pos, StartTag* tag) {
+  const size_t size = kml.size();
+  size_t i = pos + 1;
+  while (i < size && !IsSpace(kml[i]) && kml[i] != '/' && kml[i] != '>') {
+    ++i;
+  }
+  tag->name.assign(kml, pos + 1, i - pos - 1);
+  tag->xmlns_attributes.clear();
+  tag->has_parent_attribute = false;
+  tag->is_empty = false;
+  while (true) {
+    while (i < size && IsSpace(kml[i])) {
+      ++i;
+    }
+    if (i >= size) {
+      return false;
+    }
+    if (kml[i] == '>') {
+      tag->end = i + 1;
+      return !tag->name.empty();
+    }
+    if (kml[i] == '/') {
+      if (i + 1 >= size || kml[i + 1] != '>') {
+        return false;
+      }
+      tag->is_empty = true;
+      tag->end = i + 2;
+      return !tag->name.empty();
+    }
+    size_t name_begin = i;
+    while (i < size && !IsSpace(kml[i]) && kml[i] != '=' && kml[i] != '>') {
+      ++i;
+    }
+    string name(kml, name_begin, i - name_begin);
+    while (i < size && IsSpace(kml[i])) {
+      ++i;
+    }
+    if (i >= size || kml[i] != '=') {
+      return false;
+    }
+    ++i;
+    while (i < size && IsSpace(kml[i])) {
+      ++i;
+    }
+    if (i >= size || (kml[i] != '"' && kml[i] != '\'')) {
+      return false;
+    }
+    size_t value_end = kml.find(kml[i], i + 1);
+    if (value_end == string::npos) {
+      return false;
+    }
+    if (name == "parent") {
+      tag->has_parent_attribute = true;
+    }
+    if (IsXmlnsAttribute(name)) {
+      tag->xmlns_attributes.push_back(
+          std::make_pair(name, kml.substr(i + 1, value_end - i - 1)));
+    }
+    i = value_end + 1;
+  }
+}
+
+static bool IsContainerName(const string& name) {
+  return name == "Document" || name == "Folder";
+}
+
+bool SplitKml(const string& kml, size_t min_chunk_size, KmlSplit* split) {
+  if (!split) {
+    return false;
+  }
+  const char* data = kml.data();
+  const size_t size = kml.size();
+  size_t pos = 0;
+  if (StartsWith(data, size, pos, "\xEF\xBB\xBF")) {
+    pos = 3;
+  }
+  if (StartsWith(data, size, pos, "<?xml")) {
+    if ((pos = SkipPast(kml, pos, "?>")) == string::npos) {
+      return false;
+    }
+  }
+  split->header_end = pos;
+  split->xmlns_attributes.clear();
+  split->chunks.clear();
+  AttributeVector xmlns_in_scope;
+
+  unsigned int depth = 0;  // The number of open elements.
+  bool root_is_kml = false;
+  bool in_container = false;
+  size_t chunk_begin = string::npos;
+  size_t chunk_end = 0;
+  StartTag tag;
+  while (pos < size) {
+    if (data[pos] != '<') {
+      const char* next = static_cast<const char*>(
+          memchr(data + pos, '<', size - pos));
+      const size_t text_end = next ? next - data : size;
+      if (in_container && depth == split->container_depth + 1) {
+        for (; pos < text_end; ++pos) {
+          if (!IsSpace(data[pos])) {
+            return false;
+          }
+        }
+      }
+      pos = text_end;
+      continue;
+    }
+    if (StartsWith(data, size, pos, "<!--")) {
+      pos = SkipPast(kml, pos + 4, "-->");
+    } else if (StartsWith(data, size, pos, "<?")) {
+      pos = SkipPast(kml, pos + 2, "?>");
+    } else if (StartsWith(data, size, pos, "<![CDATA[")) {
+      if (in_container && depth == split->container_depth + 1) {
+        return false;
+      }
+      pos = SkipPast(kml, pos + 9, "]]>");
+    } else if (StartsWith(data, size, pos, "<!")) {
+      return false;  // A DOCTYPE may declare entities.
+    } else if (StartsWith(data, size, pos, "</")) {
+      const size_t tag_begin = pos;
+      if (depth == 0 || (pos = SkipPast(kml, pos, ">")) == string::npos) {
+        return false;
+      }
+      --depth;
+      if (in_container) {
+        if (depth == split->container_depth) {
+          split->suffix_begin = tag_begin;
+          if (chunk_begin != string::npos) {
+            split->chunks.push_back(std::make_pair(chunk_begin, chunk_end));
+          }
+          return split->chunks.size() >= 2;
+        }
+        if (depth == split->container_depth + 1) {
+          chunk_end = pos;
+        }
+      }
+    } else {
+      if (!ScanStartTag(kml, pos, &tag)) {
+        return false;
+      }
+      if (tag.name == "Schema" && tag.has_parent_attribute) {
+        return false;
+      }
+      if (!in_container) {
+        if (IsContainerName(tag.name) &&
+            (depth == 0 || (depth == 1 && root_is_kml))) {
+          if (tag.is_empty) {
+            return false;
+          }
+          in_container = true;
+          split->container_depth = depth;
+          split->container_name = tag.name;
+          split->prefix_end = tag.end;
+          SaveXmlnsAttributes(tag.xmlns_attributes, &xmlns_in_scope);
+          FormatAttributes(xmlns_in_scope, &split->xmlns_attributes);
+        } else if (depth == 0) {
+          if (tag.name != "kml") {
+            return false;
+          }
+          root_is_kml = true;
+          SaveXmlnsAttributes(tag.xmlns_attributes, &xmlns_in_scope);
+        }
+      } else if (depth == split->container_depth + 1) {
+        // This is a child of the container.  Close the current chunk if it
+        // is big enough and start the next chunk here if need be.
+        if (chunk_begin != string::npos &&
+            chunk_end - chunk_begin >= min_chunk_size) {
+          split->chunks.push_back(std::make_pair(chunk_begin, chunk_end));
+          chunk_begin = string::npos;
+        }
+        if (chunk_begin == string::npos) {
+          chunk_begin = pos;
+        }
+      }
+      pos = tag.end;
+      if (tag.is_empty) {
+        if (in_container && depth == split->container_depth + 1) {
+          chunk_end = pos;
+        }
+      } else {
+        ++depth;
+      }
+    }
+    if (pos == string::npos) {
+      return false;
+    }
+  }
+  return false;
+}
+
+}  // end namespace kmldom
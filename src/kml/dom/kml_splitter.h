@@ -0,0 +1,75 @@
+// Copyright 2008, Google Inc. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//  3. Neither the name of Google Inc. nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// This file contains the declaration of the internal SplitKml() function
+// used by Parser::ParseParallel() to divide a large document into pieces
+// which can be parsed independently.
+
+#ifndef KML_DOM_KML_SPLITTER_H__
+#define KML_DOM_KML_SPLITTER_H__
+
+#include <utility>
+#include <vector>
+#include "kml/base/util.h"
+
+namespace kmldom {
+
+// A KmlSplit describes a document as a prefix, a series of chunks and a
+// suffix.  The prefix runs from the start of the document through the start
+// tag of the top-level container: the root <Document> or <Folder>, or the
+// first such child of a root <kml>.  The suffix runs from the container's
+// end tag to the end of the document.  Each chunk is a run of complete
+// elements which are direct children of the container.  Anything between
+// the chunks is whitespace, comments or processing instructions.
+struct KmlSplit {
+  KmlSplit()
+    : header_end(0), prefix_end(0), suffix_begin(0), container_depth(0) {}
+  // The end of the byte order mark and <?xml ... ?> declaration, if any.
+  size_t header_end;
+  size_t prefix_end;
+  size_t suffix_begin;
+  // The number of ancestors of the container.
+  unsigned int container_depth;
+  string container_name;
+  // The xmlns attributes in scope within the container, each formatted as
+  // ' xmlns:prefix="uri"'.
+  string xmlns_attributes;
+  // The [begin, end) byte offset of each chunk.
+  std::vector<std::pair<size_t, size_t> > chunks;
+};
+
+// This scans the given KML for the structure described above, grouping the
+// children of the container into chunks of at least min_chunk_size bytes.
+// This is a quick lexical scan, not a validating parse.  It returns false if
+// the document has no such container, if the container has fewer than two
+// chunks, or if the document uses anything which would make parsing the
+// chunks on their own differ from parsing the whole document: a DOCTYPE,
+// character data directly within the container, or the old-style
+// <Schema parent="Placemark"> usage described in kml_handler.h.
+bool SplitKml(const string& kml, size_t min_chunk_size, KmlSplit* split);
+
+}  // end namespace kmldom
+
+#endif  // KML_DOM_KML_SPLITTER_H__
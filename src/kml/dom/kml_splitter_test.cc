@@ -0,0 +1,129 @@
+// Copyright 2008, Google Inc. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//  3. Neither the name of Google Inc. nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// This file contains the unit tests for the internal SplitKml() function.
+
+#include "kml/dom/kml_splitter.h"
+#include "gtest/gtest.h"
+
+namespace kmldom {
+
+// Returns the markup of the given chunk.
+static string GetChunk(const string& kml, const KmlSplit& split, size_t i) {
+  return kml.substr(split.chunks[i].first,
+                    split.chunks[i].second - split.chunks[i].first);
+}
+
+TEST(KmlSplitterTest, TestSplitKml) {
+  const string kKml(
+      "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n"
+      "<kml xmlns=\"http://www.opengis.net/kml/2.2\""
+      " xmlns:gx='http://www.google.com/kml/ext/2.2'>\n"
+      "<Document id=\"d\">\n"
+      "  <name>x &amp; y</name>\n"
+      "  <!-- a <comment> -->\n"
+      "  <Placemark id=\"a\" title='1 > 0'><name>a</name></Placemark>\n"
+      "  <Placemark id=\"b\"/>\n"
+      "  <Folder><Placemark><![CDATA[</Folder>]]></Placemark></Folder>\n"
+      "</Document>\n"
+      "</kml>\n");
+  KmlSplit split;
+  ASSERT_TRUE(SplitKml(kKml, 0, &split));
+  ASSERT_EQ(kKml.find("\n<kml"), split.header_end);
+  ASSERT_EQ(kKml.find("\n  <name>"), split.prefix_end);
+  ASSERT_EQ(kKml.find("</Document>"), split.suffix_begin);
+  ASSERT_EQ(static_cast<unsigned int>(1), split.container_depth);
+  ASSERT_EQ(string("Document"), split.container_name);
+  ASSERT_EQ(string(" xmlns=\"http://www.opengis.net/kml/2.2\""
+                   " xmlns:gx=\"http://www.google.com/kml/ext/2.2\""),
+            split.xmlns_attributes);
+  ASSERT_EQ(static_cast<size_t>(4), split.chunks.size());
+  ASSERT_EQ(string("<name>x &amp; y</name>"), GetChunk(kKml, split, 0));
+  ASSERT_EQ(string("<Placemark id=\"a\" title='1 > 0'>"
+                   "<name>a</name></Placemark>"), GetChunk(kKml, split, 1));
+  ASSERT_EQ(string("<Placemark id=\"b\"/>"), GetChunk(kKml, split, 2));
+  ASSERT_EQ(string("<Folder><Placemark><![CDATA[</Folder>]]>"
+                   "</Placemark></Folder>"), GetChunk(kKml, split, 3));
+}
+
+TEST(KmlSplitterTest, TestMinChunkSize) {
+  const string kKml(
+      "<Folder xmlns='x'><a/><b/>\n<c/><d/><e/></Folder>");
+  KmlSplit split;
+  ASSERT_TRUE(SplitKml(kKml, 9, &split));
+  ASSERT_EQ(static_cast<unsigned int>(0), split.container_depth);
+  ASSERT_EQ(string("Folder"), split.container_name);
+  ASSERT_EQ(string(" xmlns=\"x\""), split.xmlns_attributes);
+  ASSERT_EQ(static_cast<size_t>(2), split.chunks.size());
+  ASSERT_EQ(string("<a/><b/>\n<c/>"), GetChunk(kKml, split, 0));
+  ASSERT_EQ(string("<d/><e/>"), GetChunk(kKml, split, 1));
+
+  // Everything fits in one chunk so there is nothing to split.
+  ASSERT_FALSE(SplitKml(kKml, kKml.size(), &split));
+}
+
+TEST(KmlSplitterTest, TestNestedXmlnsOverride) {
+  const string kKml(
+      "<kml xmlns='a' xmlns:gx='b'><Document xmlns='c'>"
+      "<Placemark/><Placemark/></Document></kml>");
+  KmlSplit split;
+  ASSERT_TRUE(SplitKml(kKml, 0, &split));
+  ASSERT_EQ(string(" xmlns=\"c\" xmlns:gx=\"b\""), split.xmlns_attributes);
+}
+
+TEST(KmlSplitterTest, TestUnsplittable) {
+  const char* kUnsplittable[] = {
+    // No Document or Folder.
+    "<kml><Placemark/><Placemark/></kml>",
+    // The container is not a child of the root <kml>.
+    "<kml><NetworkLink><Folder><a/><b/></Folder></NetworkLink></kml>",
+    // An unknown root.
+    "<gml><Folder><a/><b/></Folder></gml>",
+    // Only one child.
+    "<Document><Placemark/></Document>",
+    // Character data in the container.
+    "<Document><a/>text<b/></Document>",
+    "<Document><a/><![CDATA[text]]><b/></Document>",
+    // A DOCTYPE.
+    "<!DOCTYPE kml [<!ENTITY e 'x'>]><Document><a/><b/></Document>",
+    // Old-style Schema usage.
+    "<Document><Schema parent='Placemark' name='S'/><S/></Document>",
+    // Truncated and malformed markup.
+    "<Document><a/><b/>",
+    "<Document><a/><b x/></Document>",
+    "<Document><a/><b x='1></Document>",
+    "<Document><a/><!-- <b/></Document>",
+    "</Document><a/><b/>",
+    "",
+  };
+  for (size_t i = 0; i < sizeof(kUnsplittable)/sizeof(kUnsplittable[0]);
+       ++i) {
+    KmlSplit split;
+    ASSERT_FALSE(SplitKml(kUnsplittable[i], 0, &split)) << kUnsplittable[i];
+  }
+  ASSERT_FALSE(SplitKml("<Document><a/><b/></Document>", 0, NULL));
+}
+
+}  // end namespace kmldom
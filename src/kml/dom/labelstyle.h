@@ -50,10 +50,12 @@ class LabelStyle : public ColorStyle {
     return has_scale_;
   }
   void set_scale(double scale) {
+    MarkDirty();
     scale_ = scale;
     has_scale_ = true;
   }
   void clear_scale() {
+    MarkDirty();
     scale_ = 1.0;
     has_scale_ = false;
   }
@@ -51,10 +51,12 @@ class LineStyle : public ColorStyle {
     return has_width_;
   }
   void set_width(double width) {
+    MarkDirty();
     width_ = width;
     has_width_ = true;
   }
   void clear_width() {
+    MarkDirty();
     width_ = 1.0;
     has_width_ = false;
   }
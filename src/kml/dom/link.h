@@ -54,10 +54,12 @@ class BasicLink : public Object {
     return has_href_;
   }
   void set_href(const string& href) {
+    MarkDirty();
     href_ = href;
     has_href_ = true;
   }
   void clear_href() {
+    MarkDirty();
     href_.clear();
     has_href_ = false;
   }
@@ -91,10 +93,12 @@ class AbstractLink : public BasicLink {
     return has_refreshmode_;
   }
   void set_refreshmode(const int refreshmode) {
+    MarkDirty();
     refreshmode_ = refreshmode;
     has_refreshmode_ = true;
   }
   void clear_refreshmode() {
+    MarkDirty();
     refreshmode_ = REFRESHMODE_ONCHANGE;
     has_refreshmode_ = false;
   }
@@ -107,10 +111,12 @@ class AbstractLink : public BasicLink {
     return has_refreshinterval_;
   }
   void set_refreshinterval(const double refreshinterval) {
+    MarkDirty();
     refreshinterval_ = refreshinterval;
     has_refreshinterval_ = true;
   }
   void clear_refreshinterval() {
+    MarkDirty();
     refreshinterval_ = 4.0;
     has_refreshinterval_ = false;
   }
@@ -123,10 +129,12 @@ class AbstractLink : public BasicLink {
     return has_viewrefreshmode_;
   }
   void set_viewrefreshmode(const int viewrefreshmode) {
+    MarkDirty();
     viewrefreshmode_ = viewrefreshmode;
     has_viewrefreshmode_ = true;
   }
   void clear_viewrefreshmode() {
+    MarkDirty();
     viewrefreshmode_ = VIEWREFRESHMODE_NEVER;
     has_viewrefreshmode_ = false;
   }
@@ -139,10 +147,12 @@ class AbstractLink : public BasicLink {
     return has_viewrefreshtime_;
   }
   void set_viewrefreshtime(const double viewrefreshtime) {
+    MarkDirty();
     viewrefreshtime_ = viewrefreshtime;
     has_viewrefreshtime_ = true;
   }
   void clear_viewrefreshtime() {
+    MarkDirty();
     viewrefreshtime_ = 4.0;
     has_viewrefreshtime_ = false;
   }
@@ -155,10 +165,12 @@ class AbstractLink : public BasicLink {
     return has_viewboundscale_;
   }
   void set_viewboundscale(const double viewboundscale) {
+    MarkDirty();
     viewboundscale_ = viewboundscale;
     has_viewboundscale_ = true;
   }
   void clear_viewboundscale() {
+    MarkDirty();
     viewboundscale_ = 1.0;
     has_viewboundscale_ = false;
   }
@@ -171,10 +183,12 @@ class AbstractLink : public BasicLink {
     return has_viewformat_;
   }
   void set_viewformat(const string& viewformat) {
+    MarkDirty();
     viewformat_ = viewformat;
     has_viewformat_ = true;
   }
   void clear_viewformat() {
+    MarkDirty();
     viewformat_.clear();
     has_viewformat_ = false;
   }
@@ -187,10 +201,12 @@ class AbstractLink : public BasicLink {
     return has_httpquery_;
   }
   void set_httpquery(const string& httpquery) {
+    MarkDirty();
     httpquery_ = httpquery;
     has_httpquery_ = true;
   }
   void clear_httpquery() {
+    MarkDirty();
     httpquery_.clear();
     has_httpquery_ = false;
   }
@@ -295,10 +311,12 @@ class IconStyleIcon : public BasicLink {
     return has_gx_x_;
   }
   void set_gx_x(const double x) {
+    MarkDirty();
     gx_x_ = x;
     has_gx_x_= true;
   }
   void clear_gx_x() {
+    MarkDirty();
     gx_x_= 0.0;
     has_gx_x_ = false;
   }
@@ -311,10 +329,12 @@ class IconStyleIcon : public BasicLink {
     return has_gx_y_;
   }
   void set_gx_y(const double y) {
+    MarkDirty();
     gx_y_ = y;
     has_gx_y_= true;
   }
   void clear_gx_y() {
+    MarkDirty();
     gx_y_= 0.0;
     has_gx_y_ = false;
   }
@@ -327,10 +347,12 @@ class IconStyleIcon : public BasicLink {
     return has_gx_w_;
   }
   void set_gx_w(const double w) {
+    MarkDirty();
     gx_w_ = w;
     has_gx_w_= true;
   }
   void clear_gx_w() {
+    MarkDirty();
     gx_w_= 0.0;
     has_gx_w_ = false;
   }
@@ -343,10 +365,12 @@ class IconStyleIcon : public BasicLink {
     return has_gx_h_;
   }
   void set_gx_h(const double h) {
+    MarkDirty();
     gx_h_ = h;
     has_gx_h_= true;
   }
   void clear_gx_h() {
+    MarkDirty();
     gx_h_= 0.0;
     has_gx_h_ = false;
   }
@@ -74,12 +74,14 @@ class ItemIcon : public Object {
     return has_state_;
   }
   void add_state(int state) {
+    MarkDirty();
     state_array_.push_back(state);
     has_state_ = true;
   }
   // Note that clear_state will empty ALL stored state enums and thus does
   // not return the element to its default value of <state>open</state>.
   void clear_state() {
+    MarkDirty();
     state_array_.clear();
     has_state_ = false;
   }
@@ -92,10 +94,12 @@ class ItemIcon : public Object {
     return has_href_;
   }
   void set_href(const string& href) {
+    MarkDirty();
     href_ = href;
     has_href_ = true;
   }
   void clear_href() {
+    MarkDirty();
     href_.clear();
     has_href_ = false;
   }
@@ -134,10 +138,12 @@ class ListStyle : public SubStyle {
     return has_listitemtype_;
   }
   void set_listitemtype(int listitemtype) {
+    MarkDirty();
     listitemtype_ = listitemtype;
     has_listitemtype_ = true;
   }
   void clear_listitemtype() {
+    MarkDirty();
     listitemtype_ = LISTITEMTYPE_CHECK;
     has_listitemtype_ = false;
   }
@@ -150,10 +156,12 @@ class ListStyle : public SubStyle {
     return has_bgcolor_;
   }
   void set_bgcolor(const kmlbase::Color32& bgcolor) {
+    MarkDirty();
     bgcolor_ = bgcolor;
     has_bgcolor_ = true;
   }
   void clear_bgcolor() {
+    MarkDirty();
     bgcolor_ = kmlbase::Color32(0xffffffff);
     has_bgcolor_ = false;
   }
@@ -179,10 +187,12 @@ class ListStyle : public SubStyle {
     return has_maxsnippetlines_;
   }
   void set_maxsnippetlines(int maxsnippetlines) {
+    MarkDirty();
     maxsnippetlines_ = maxsnippetlines;
     has_maxsnippetlines_ = true;
   }
   void clear_maxsnippetlines() {
+    MarkDirty();
     maxsnippetlines_ = 2;
     has_maxsnippetlines_ = false;
   }
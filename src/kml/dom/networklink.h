@@ -52,10 +52,12 @@ class NetworkLink : public Feature {
   bool get_refreshvisibility() const { return refreshvisibility_; }
   bool has_refreshvisibility() const { return has_refreshvisibility_; }
   void set_refreshvisibility(bool value) {
+    MarkDirty();
     refreshvisibility_ = value;
     has_refreshvisibility_ = true;
   }
   void clear_refreshvisibility() {
+    MarkDirty();
     refreshvisibility_ = false;
     has_refreshvisibility_ = false;
   }
@@ -64,10 +66,12 @@ class NetworkLink : public Feature {
   bool get_flytoview() const { return flytoview_; }
   bool has_flytoview() const { return has_flytoview_; }
   void set_flytoview(bool value) {
+    MarkDirty();
     flytoview_ = value;
     has_flytoview_ = true;
   }
   void clear_flytoview() {
+    MarkDirty();
     flytoview_ = false;
     has_flytoview_ = false;
   }
@@ -178,10 +178,12 @@ class Update : public BasicElement<Type_Update> {
   const string& get_targethref() const { return targethref_; }
   bool has_targethref() const { return has_targethref_; }
   void set_targethref(const string& targethref) {
+    MarkDirty();
     targethref_ = targethref;
     has_targethref_ = true;
   }
   void clear_targethref() {
+    MarkDirty();
     targethref_.clear();
     has_targethref_ = false;
   }
@@ -226,10 +228,12 @@ class NetworkLinkControl : public BasicElement<Type_NetworkLinkControl> {
   double get_minrefreshperiod() const { return minrefreshperiod_; }
   bool has_minrefreshperiod() const { return has_minrefreshperiod_; }
   void set_minrefreshperiod(double value) {
+    MarkDirty();
     minrefreshperiod_ = value;
     has_minrefreshperiod_ = true;
   }
   void clear_minrefreshperiod() {
+    MarkDirty();
     minrefreshperiod_ = 0.0;
     has_minrefreshperiod_ = false;
   }
@@ -238,10 +242,12 @@ class NetworkLinkControl : public BasicElement<Type_NetworkLinkControl> {
   double get_maxsessionlength() const { return maxsessionlength_; }
   bool has_maxsessionlength() const { return has_maxsessionlength_; }
   void set_maxsessionlength(double value) {
+    MarkDirty();
     maxsessionlength_ = value;
     has_maxsessionlength_ = true;
   }
   void clear_maxsessionlength() {
+    MarkDirty();
     maxsessionlength_ = 0.0;
     has_maxsessionlength_ = false;
   }
@@ -250,10 +256,12 @@ class NetworkLinkControl : public BasicElement<Type_NetworkLinkControl> {
   const string& get_cookie() const { return cookie_; }
   bool has_cookie() const { return has_cookie_; }
   void set_cookie(const string& cookie) {
+    MarkDirty();
     cookie_ = cookie;
     has_cookie_ = true;
   }
   void clear_cookie() {
+    MarkDirty();
     cookie_.clear();
     has_cookie_ = false;
   }
@@ -262,10 +270,12 @@ class NetworkLinkControl : public BasicElement<Type_NetworkLinkControl> {
   const string& get_message() const { return message_; }
   bool has_message() const { return has_message_; }
   void set_message(const string& message) {
+    MarkDirty();
     message_ = message;
     has_message_ = true;
   }
   void clear_message() {
+    MarkDirty();
     message_.clear();
     has_message_ = false;
   }
@@ -274,10 +284,12 @@ class NetworkLinkControl : public BasicElement<Type_NetworkLinkControl> {
   const string& get_linkname() const { return linkname_; }
   bool has_linkname() const { return has_linkname_; }
   void set_linkname(const string& linkname) {
+    MarkDirty();
     linkname_ = linkname;
     has_linkname_ = true;
   }
   void clear_linkname() {
+    MarkDirty();
     linkname_.clear();
     has_linkname_ = false;
   }
@@ -286,10 +298,12 @@ class NetworkLinkControl : public BasicElement<Type_NetworkLinkControl> {
   const string& get_linkdescription() const { return linkdescription_; }
   bool has_linkdescription() const { return has_linkdescription_; }
   void set_linkdescription(const string& linkdescription) {
+    MarkDirty();
     linkdescription_ = linkdescription;
     has_linkdescription_ = true;
   }
   void clear_linkdescription() {
+    MarkDirty();
     linkdescription_.clear();
     has_linkdescription_ = false;
   }
@@ -308,10 +322,12 @@ class NetworkLinkControl : public BasicElement<Type_NetworkLinkControl> {
   const string& get_expires() const { return expires_; }
   bool has_expires() const { return has_expires_; }
   void set_expires(const string& expires) {
+    MarkDirty();
     expires_ = expires;
     has_expires_ = true;
   }
   void clear_expires() {
+    MarkDirty();
     expires_.clear();
     has_expires_ = false;
   }
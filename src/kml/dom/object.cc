@@ -59,6 +59,27 @@ void Object::ParseAttributes(Attributes* attributes) {
   AddUnknownAttributes(attributes);
 }
 
+bool Object::ParseIdAttributes(const kmlbase::StringVector& attrs) {
+  if (attrs.size() % 2 != 0) {
+    return false;
+  }
+  for (size_t i = 0; i < attrs.size(); i += 2) {
+    if (attrs[i] != kId && attrs[i] != kTargetId) {
+      return false;
+    }
+  }
+  for (size_t i = 0; i < attrs.size(); i += 2) {
+    if (attrs[i] == kId) {
+      id_ = attrs[i + 1];
+      has_id_ = true;
+    } else {
+      targetid_ = attrs[i + 1];
+      has_targetid_ = true;
+    }
+  }
+  return true;
+}
+
 void Object::SerializeAttributes(Attributes* attributes) const {
   Element::SerializeAttributes(attributes);
   // If the id or targetId have been explictly set via API calls, we overwrite
@@ -30,6 +30,7 @@
 
 #include "kml/dom/element.h"
 #include "kml/dom/kml22.h"
+#include "kml/base/string_util.h"
 #include "kml/base/util.h"
 
 namespace kmlbase {
@@ -51,10 +52,12 @@ class Object : public Element {
   const string& get_id() const { return id_; }
   bool has_id() const { return has_id_; }
   void set_id(const string& value) {
+    MarkDirty();
     id_ = value;
     has_id_ = true;
   }
   void clear_id() {
+    MarkDirty();
     id_.clear();
     has_id_ = false;
   }
@@ -62,14 +65,22 @@ class Object : public Element {
   const string& get_targetid() const { return targetid_; }
   bool has_targetid() const { return has_targetid_; }
   void set_targetid(const string& targetid) {
+    MarkDirty();
     targetid_ = targetid;
     has_targetid_ = true;
   }
   void clear_targetid() {
+    MarkDirty();
     targetid_.clear();
     has_targetid_ = false;
   }
 
+  // This sets id and targetId straight from the name-value list of the
+  // element's start tag, as from expat's startElement.  If there is any
+  // other attribute nothing is set and false is returned in which case
+  // the caller should use ParseAttributes().
+  bool ParseIdAttributes(const kmlbase::StringVector& attrs);
+
  protected:
   // Object is abstract, derived class access only.
   Object();
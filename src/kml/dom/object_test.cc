@@ -26,6 +26,7 @@
 // This file contains the unit tests for the abstract Object element.
 
 #include "kml/dom/object.h"
+#include "kml/base/attributes.h"
 #include "kml/dom/kml_funcs.h"
 #include "kml/dom/kml_cast.h"
 #include "kml/dom/kml_ptr.h"
@@ -101,4 +102,37 @@ TEST_F(ObjectTest, TestParse) {
   ASSERT_EQ(kTargetId, placemark->get_targetid());
 }
 
+TEST_F(ObjectTest, TestParseIdAttributes) {
+  kmlbase::StringVector attrs;
+  attrs.push_back("targetId");
+  attrs.push_back("bar");
+  attrs.push_back("id");
+  attrs.push_back("foo");
+  ASSERT_TRUE(object_->ParseIdAttributes(attrs));
+  ASSERT_EQ(string("foo"), object_->get_id());
+  ASSERT_EQ(string("bar"), object_->get_targetid());
+  ASSERT_FALSE(object_->GetUnknownAttributes());
+
+  // Anything else is left to ParseAttributes().
+  object_.reset(new TestObject());
+  attrs.push_back("name");
+  attrs.push_back("baz");
+  ASSERT_FALSE(object_->ParseIdAttributes(attrs));
+  ASSERT_FALSE(object_->has_id());
+  ASSERT_FALSE(object_->has_targetid());
+}
+
+TEST_F(ObjectTest, TestParseUnknownAttribute) {
+  ElementPtr root = Parse("<Placemark id=\"a\" foo=\"b\" />", NULL);
+  const PlacemarkPtr placemark = AsPlacemark(root);
+  ASSERT_TRUE(placemark);
+  ASSERT_EQ(string("a"), placemark->get_id());
+  ASSERT_FALSE(placemark->has_targetid());
+  ASSERT_TRUE(placemark->GetUnknownAttributes());
+  string val;
+  ASSERT_TRUE(placemark->GetUnknownAttributes()->FindValue("foo", &val));
+  ASSERT_EQ(string("b"), val);
+  ASSERT_FALSE(placemark->GetUnknownAttributes()->FindValue("id", NULL));
+}
+
 }  // end namespace kmldom
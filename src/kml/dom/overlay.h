@@ -65,10 +65,12 @@ class Overlay : public Feature {
     return has_color_;
   }
   void set_color(const kmlbase::Color32& color) {
+    MarkDirty();
     color_ = color;
     has_color_ = true;
   }
   void clear_color() {
+    MarkDirty();
     color_ = kmlbase::Color32(0xffffffff);
     has_color_ = false;
   }
@@ -81,10 +83,12 @@ class Overlay : public Feature {
     return has_draworder_;
   }
   void set_draworder(int draworder) {
+    MarkDirty();
     draworder_ = draworder;
     has_draworder_ = true;
   }
   void clear_draworder() {
+    MarkDirty();
     draworder_ = 0;
     has_draworder_ = false;
   }
@@ -134,10 +138,12 @@ class LatLonBox : public AbstractLatLonBox {
     return has_rotation_;
   }
   void set_rotation(double rotation) {
+    MarkDirty();
     rotation_ = rotation;
     has_rotation_ = true;
   }
   void clear_rotation() {
+    MarkDirty();
     rotation_ = 0.0;
     has_rotation_ = false;
   }
@@ -212,10 +218,12 @@ class GroundOverlay : public Overlay {
     return has_altitude_;
   }
   void set_altitude(double altitude) {
+    MarkDirty();
     altitude_ = altitude;
     has_altitude_ = true;
   }
   void clear_altitude() {
+    MarkDirty();
     altitude_ = 0.0;
     has_altitude_ = false;
   }
@@ -228,10 +236,12 @@ class GroundOverlay : public Overlay {
     return has_altitudemode_;
   }
   void set_altitudemode(int altitudemode) {
+    MarkDirty();
     altitudemode_ = altitudemode;
     has_altitudemode_ = true;
   }
   void clear_altitudemode() {
+    MarkDirty();
     altitudemode_ = ALTITUDEMODE_CLAMPTOGROUND;
     has_altitudemode_ = false;
   }
@@ -244,10 +254,12 @@ class GroundOverlay : public Overlay {
     return has_gx_altitudemode_;
   }
   void set_gx_altitudemode(int gx_altitudemode) {
+    MarkDirty();
     gx_altitudemode_ = gx_altitudemode;
     has_gx_altitudemode_ = true;
   }
   void clear_gx_altitudemode() {
+    MarkDirty();
     gx_altitudemode_ = GX_ALTITUDEMODE_CLAMPTOSEAFLOOR;
     has_gx_altitudemode_ = false;
   }
@@ -425,10 +437,12 @@ class ScreenOverlay : public Overlay {
     return has_rotation_;
   }
   void set_rotation(double rotation) {
+    MarkDirty();
     rotation_ = rotation;
     has_rotation_ = true;
   }
   void clear_rotation() {
+    MarkDirty();
     rotation_ = 0.0;
     has_rotation_ = false;
   }
@@ -470,10 +484,12 @@ class ViewVolume : public Object {
     return has_leftfov_;
   }
   void set_leftfov(double leftfov) {
+    MarkDirty();
     leftfov_ = leftfov;
     has_leftfov_ = true;
   }
   void clear_leftfov() {
+    MarkDirty();
     leftfov_ = 0.0;
     has_leftfov_ = false;
   }
@@ -486,10 +502,12 @@ class ViewVolume : public Object {
     return has_rightfov_;
   }
   void set_rightfov(double rightfov) {
+    MarkDirty();
     rightfov_ = rightfov;
     has_rightfov_ = true;
   }
   void clear_rightfov() {
+    MarkDirty();
     rightfov_ = 0.0;
     has_rightfov_ = false;
   }
@@ -502,10 +520,12 @@ class ViewVolume : public Object {
     return has_bottomfov_;
   }
   void set_bottomfov(double altitude) {
+    MarkDirty();
     bottomfov_ = altitude;
     has_bottomfov_ = true;
   }
   void clear_bottomfov() {
+    MarkDirty();
     bottomfov_ = 0.0;
     has_bottomfov_ = false;
   }
@@ -518,10 +538,12 @@ class ViewVolume : public Object {
     return has_topfov_;
   }
   void set_topfov(double topfov) {
+    MarkDirty();
     topfov_ = topfov;
     has_topfov_ = true;
   }
   void clear_topfov() {
+    MarkDirty();
     topfov_ = 0.0;
     has_topfov_ = false;
   }
@@ -534,10 +556,12 @@ class ViewVolume : public Object {
     return has_near_;
   }
   void set_near(double val) {
+    MarkDirty();
     near_ = val;
     has_near_ = true;
   }
   void clear_near() {
+    MarkDirty();
     near_ = 0.0;
     has_near_ = false;
   }
@@ -582,10 +606,12 @@ class ImagePyramid : public Object {
     return has_tilesize_;
   }
   void set_tilesize(int tilesize) {
+    MarkDirty();
     tilesize_ = tilesize;
     has_tilesize_ = true;
   }
   void clear_tilesize() {
+    MarkDirty();
     tilesize_ = 256;
     has_tilesize_ = false;
   }
@@ -598,10 +624,12 @@ class ImagePyramid : public Object {
     return has_maxwidth_;
   }
   void set_maxwidth(int maxwidth) {
+    MarkDirty();
     maxwidth_ = maxwidth;
     has_maxwidth_ = true;
   }
   void clear_maxwidth() {
+    MarkDirty();
     maxwidth_ = 0;
     has_maxwidth_ = false;
   }
@@ -614,10 +642,12 @@ class ImagePyramid : public Object {
     return has_maxheight_;
   }
   void set_maxheight(int altitude) {
+    MarkDirty();
     maxheight_ = altitude;
     has_maxheight_ = true;
   }
   void clear_maxheight() {
+    MarkDirty();
     maxheight_ = 0;
     has_maxheight_ = false;
   }
@@ -630,10 +660,12 @@ class ImagePyramid : public Object {
     return has_gridorigin_;
   }
   void set_gridorigin(int gridorigin) {
+    MarkDirty();
     gridorigin_ = gridorigin;
     has_gridorigin_ = true;
   }
   void clear_gridorigin() {
+    MarkDirty();
     gridorigin_ = GRIDORIGIN_LOWERLEFT;
     has_gridorigin_ = false;
   }
@@ -676,10 +708,12 @@ class PhotoOverlay : public Overlay {
     return has_rotation_;
   }
   void set_rotation(double rotation) {
+    MarkDirty();
     rotation_ = rotation;
     has_rotation_ = true;
   }
   void clear_rotation() {
+    MarkDirty();
     rotation_ = 0.0;
     has_rotation_ = false;
   }
@@ -722,10 +756,12 @@ class PhotoOverlay : public Overlay {
     return has_shape_;
   }
   void set_shape(int shape) {
+    MarkDirty();
     shape_ = shape;
     has_shape_ = true;
   }
   void clear_shape() {
+    MarkDirty();
     shape_ = SHAPE_RECTANGLE;
     has_shape_ = false;
   }
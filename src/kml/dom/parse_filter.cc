@@ -0,0 +1,96 @@
+// Copyright 2008, Google Inc. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//  3. Neither the name of Google Inc. nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// This file contains the implementation of the ParseFilter class.
+
+#include "kml/dom/parse_filter.h"
+#include "kml/dom/element.h"
+#include "kml/dom/kml_factory.h"
+
+namespace kmldom {
+
+ParseFilter::ParseFilter()
+  : skipped_(Type_Invalid + 1, false) {
+}
+
+void ParseFilter::SkipElement(KmlDomType type_id) {
+  AddType(type_id, &skipped_);
+}
+
+void ParseFilter::KeepChild(KmlDomType parent_type_id,
+                            KmlDomType child_type_id) {
+  size_t i = 0;
+  while (i < kept_children_.size() &&
+         kept_children_[i].parent_type_id != parent_type_id) {
+    ++i;
+  }
+  if (i == kept_children_.size()) {
+    kept_children_.push_back(KeptChildren());
+    kept_children_.back().parent_type_id = parent_type_id;
+    kept_children_.back().children.resize(Type_Invalid + 1, false);
+  }
+  AddType(child_type_id, &kept_children_[i].children);
+}
+
+bool ParseFilter::KeepsChild(const ElementPtr& parent,
+                             KmlDomType type_id) const {
+  if (type_id < 0 || type_id >= Type_Invalid) {
+    type_id = Type_Unknown;
+  }
+  if (skipped_[type_id]) {
+    return false;
+  }
+  // Kept if no list of kept children applies to the parent or if any does
+  // keep the child.
+  bool kept = true;
+  for (size_t i = 0; i < kept_children_.size(); ++i) {
+    if (parent->IsA(kept_children_[i].parent_type_id)) {
+      if (kept_children_[i].children[type_id]) {
+        return true;
+      }
+      kept = false;
+    }
+  }
+  return kept;
+}
+
+// Private.  Which types derive from a given type is only known to the
+// Elements themselves so one of each complex type is made to ask.
+void ParseFilter::AddType(KmlDomType type_id, std::vector<bool>* types) {
+  if (type_id < 0 || type_id >= Type_Invalid) {
+    return;
+  }
+  (*types)[type_id] = true;
+  const KmlFactory& kml_factory = *KmlFactory::GetFactory();
+  for (int i = 0; i < Type_Invalid; ++i) {
+    ElementPtr element =
+        kml_factory.CreateElementById(static_cast<KmlDomType>(i));
+    if (element && element->IsA(type_id)) {
+      (*types)[i] = true;
+    }
+  }
+}
+
+}  // end namespace kmldom
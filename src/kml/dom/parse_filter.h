@@ -0,0 +1,106 @@
+// Copyright 2008, Google Inc. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//  3. Neither the name of Google Inc. nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// This file contains the declaration of the ParseFilter class with which a
+// parse skips the parts of the KML which are not wanted.
+
+#ifndef KML_DOM_PARSE_FILTER_H__
+#define KML_DOM_PARSE_FILTER_H__
+
+#include <vector>
+#include "kml/dom/kml22.h"
+#include "kml/dom/kml_ptr.h"
+#include "kml/base/util.h"
+
+namespace kmldom {
+
+// A ParseFilter is handed to Parser::set_parse_filter() to declare which
+// parts of the KML are to be parsed.  An element which is filtered out is
+// skipped along with all its content: no Element is created for it or for
+// anything within it, no ParserObserver sees it, and its character data is
+// not gathered.  Unknown elements are treated as being of Type_Unknown.
+// The root element is never filtered out.
+//
+// KeepsFeature() is called for each Feature when it ends.  A Feature for
+// which it returns false is not added to its parent just as if a
+// ParserObserver's EndElement() had returned false.  The default keeps all
+// Features.  A derived class may filter Features by their content, for
+// example by location (see kmlengine::BboxParseFilter).
+//
+// A ParseFilter is not changed by a parse and may be used by several parses
+// at once once it is set up.
+//
+// Intended usage:
+//   // Placemarks with just their name and geometry.
+//   ParseFilter parse_filter;
+//   parse_filter.SkipElement(Type_StyleSelector);
+//   parse_filter.KeepChild(Type_Placemark, Type_name);
+//   parse_filter.KeepChild(Type_Placemark, Type_Geometry);
+//   Parser parser;
+//   parser.set_parse_filter(&parse_filter);
+//   ElementPtr root = parser.Parse(kml, &errors);
+class ParseFilter {
+ public:
+  ParseFilter();
+  virtual ~ParseFilter() {}
+
+  // Each element of the given type or of a type derived from it is skipped.
+  void SkipElement(KmlDomType type_id);
+
+  // Once any child is kept for a type of parent, an element of that type or
+  // of a type derived from it keeps only the children of the types kept for
+  // it.  A child is kept if it is of any of those types or of a type derived
+  // from one.  For example KeepChild(Type_Feature, Type_name) and
+  // KeepChild(Type_Placemark, Type_Geometry) keep the <name> and any
+  // Geometry of a Placemark and only the <name> of every other Feature.
+  void KeepChild(KmlDomType parent_type_id, KmlDomType child_type_id);
+
+  // This returns true if a child of the given type is parsed within the
+  // given parent.  This is called by the parser.
+  bool KeepsChild(const ElementPtr& parent, KmlDomType type_id) const;
+
+  // This returns true if the given Feature is to be added to its parent.
+  // This is called by the parser once the Feature is complete.
+  virtual bool KeepsFeature(const FeaturePtr& feature) const {
+    return true;
+  }
+
+ private:
+  // Marks type_id and each type derived from it in types.
+  static void AddType(KmlDomType type_id, std::vector<bool>* types);
+  // Indexed by type id.
+  std::vector<bool> skipped_;
+  // The children kept for each parent type given to KeepChild().
+  struct KeptChildren {
+    KmlDomType parent_type_id;
+    std::vector<bool> children;
+  };
+  std::vector<KeptChildren> kept_children_;
+  LIBKML_DISALLOW_EVIL_CONSTRUCTORS(ParseFilter);
+};
+
+}  // end namespace kmldom
+
+#endif  // KML_DOM_PARSE_FILTER_H__
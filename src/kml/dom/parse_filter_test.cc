@@ -0,0 +1,219 @@
+// Copyright 2008, Google Inc. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//  3. Neither the name of Google Inc. nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// This file contains the unit tests for the ParseFilter class.
+
+#include "kml/dom/parse_filter.h"
+#include "kml/dom/kml_cast.h"
+#include "kml/dom/kml_factory.h"
+#include "kml/dom/kml_funcs.h"
+#include "kml/dom/parser.h"
+#include "kml/dom/parser_observer.h"
+#include "kml/dom/xml_serializer.h"
+#include "gtest/gtest.h"
+
+namespace kmldom {
+
+static const char kKml[] =
+    "<Document>"
+    "<Style id=\"s\"><IconStyle><scale>2</scale></IconStyle></Style>"
+    "<StyleMap id=\"m\"/>"
+    "<Placemark id=\"p0\"><name>abc</name>"
+    "<description>x<b>y</b></description>"
+    "<ExtendedData><Data name=\"d\"><value>v</value></Data></ExtendedData>"
+    "<foo>bar</foo>"
+    "<Point><coordinates>1,2</coordinates></Point></Placemark>"
+    "<Placemark id=\"p1\"><name>defg</name></Placemark>"
+    "</Document>";
+
+class ParseFilterTest : public testing::Test {
+ protected:
+  ElementPtr Parse(const string& kml) {
+    Parser parser;
+    parser.set_parse_filter(&parse_filter_);
+    return parser.Parse(kml, NULL);
+  }
+
+  ParseFilter parse_filter_;
+};
+
+TEST_F(ParseFilterTest, TestDefault) {
+  // By default everything is kept.
+  ElementPtr placemark = KmlFactory::GetFactory()->CreatePlacemark();
+  ASSERT_TRUE(parse_filter_.KeepsChild(placemark, Type_name));
+  ASSERT_TRUE(parse_filter_.KeepsChild(placemark, Type_Point));
+  ASSERT_TRUE(parse_filter_.KeepsChild(placemark, Type_Unknown));
+  ASSERT_TRUE(parse_filter_.KeepsFeature(AsFeature(placemark)));
+  ASSERT_EQ(SerializeRaw(Parse(kKml)), SerializeRaw(kmldom::Parse(kKml, NULL)));
+}
+
+TEST_F(ParseFilterTest, TestSkipElement) {
+  // Skipping an abstract type skips each type derived from it.
+  parse_filter_.SkipElement(Type_StyleSelector);
+  parse_filter_.SkipElement(Type_description);
+  ElementPtr document = KmlFactory::GetFactory()->CreateDocument();
+  ASSERT_FALSE(parse_filter_.KeepsChild(document, Type_Style));
+  ASSERT_FALSE(parse_filter_.KeepsChild(document, Type_StyleMap));
+  ASSERT_FALSE(parse_filter_.KeepsChild(document, Type_description));
+  ASSERT_TRUE(parse_filter_.KeepsChild(document, Type_Placemark));
+  ASSERT_TRUE(parse_filter_.KeepsChild(document, Type_name));
+
+  DocumentPtr parsed = AsDocument(Parse(kKml));
+  ASSERT_TRUE(parsed);
+  ASSERT_EQ(static_cast<size_t>(0), parsed->get_styleselector_array_size());
+  ASSERT_EQ(static_cast<size_t>(2), parsed->get_feature_array_size());
+  PlacemarkPtr placemark = AsPlacemark(parsed->get_feature_array_at(0));
+  ASSERT_EQ(string("p0"), placemark->get_id());
+  ASSERT_EQ(string("abc"), placemark->get_name());
+  ASSERT_FALSE(placemark->has_description());
+  ASSERT_TRUE(placemark->has_extendeddata());
+  ASSERT_TRUE(placemark->has_geometry());
+}
+
+TEST_F(ParseFilterTest, TestKeepChild) {
+  // A Placemark keeps its name and geometry and every other Feature just
+  // its name.
+  parse_filter_.KeepChild(Type_Feature, Type_name);
+  parse_filter_.KeepChild(Type_Placemark, Type_Geometry);
+  ElementPtr placemark = KmlFactory::GetFactory()->CreatePlacemark();
+  ElementPtr folder = KmlFactory::GetFactory()->CreateFolder();
+  ASSERT_TRUE(parse_filter_.KeepsChild(placemark, Type_name));
+  ASSERT_TRUE(parse_filter_.KeepsChild(placemark, Type_Point));
+  ASSERT_TRUE(parse_filter_.KeepsChild(placemark, Type_MultiGeometry));
+  ASSERT_FALSE(parse_filter_.KeepsChild(placemark, Type_description));
+  ASSERT_FALSE(parse_filter_.KeepsChild(placemark, Type_Unknown));
+  ASSERT_TRUE(parse_filter_.KeepsChild(folder, Type_name));
+  ASSERT_FALSE(parse_filter_.KeepsChild(folder, Type_Point));
+  ASSERT_FALSE(parse_filter_.KeepsChild(folder, Type_Placemark));
+  // Types which are not a parent of a kept child keep all their children.
+  ElementPtr point = KmlFactory::GetFactory()->CreatePoint();
+  ASSERT_TRUE(parse_filter_.KeepsChild(point, Type_coordinates));
+  ASSERT_TRUE(parse_filter_.KeepsChild(point, Type_extrude));
+}
+
+TEST_F(ParseFilterTest, TestProjection) {
+  // The root is never filtered out.
+  parse_filter_.KeepChild(Type_Document, Type_Placemark);
+  parse_filter_.KeepChild(Type_Placemark, Type_name);
+  parse_filter_.KeepChild(Type_Placemark, Type_Geometry);
+  ASSERT_EQ(string("<Document>"
+                   "<Placemark id=\"p0\"><name>abc</name>"
+                   "<Point><coordinates>1,2,0\n</coordinates></Point>"
+                   "</Placemark>"
+                   "<Placemark id=\"p1\"><name>defg</name></Placemark>"
+                   "</Document>"),
+            SerializeRaw(Parse(kKml)));
+  // A skipped root is still parsed.
+  ParseFilter skip_document;
+  skip_document.SkipElement(Type_Document);
+  Parser parser;
+  parser.set_parse_filter(&skip_document);
+  ASSERT_TRUE(AsDocument(parser.Parse(kKml, NULL)));
+}
+
+// This records the type of each Element created in the parse.
+class TypeLoggingParserObserver : public ParserObserver {
+ public:
+  virtual bool NewElement(const ElementPtr& element) {
+    types_.push_back(element->Type());
+    return true;
+  }
+  bool Saw(KmlDomType type_id) const {
+    for (size_t i = 0; i < types_.size(); ++i) {
+      if (types_[i] == type_id) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+ private:
+  std::vector<KmlDomType> types_;
+};
+
+TEST_F(ParseFilterTest, TestObserversSeeNoSkippedElement) {
+  parse_filter_.SkipElement(Type_ExtendedData);
+  parse_filter_.SkipElement(Type_Style);
+  TypeLoggingParserObserver observer;
+  Parser parser;
+  parser.set_parse_filter(&parse_filter_);
+  parser.AddObserver(&observer);
+  ASSERT_TRUE(parser.Parse(kKml, NULL));
+  ASSERT_TRUE(observer.Saw(Type_Placemark));
+  ASSERT_TRUE(observer.Saw(Type_StyleMap));
+  ASSERT_FALSE(observer.Saw(Type_ExtendedData));
+  ASSERT_FALSE(observer.Saw(Type_Data));
+  ASSERT_FALSE(observer.Saw(Type_Style));
+  ASSERT_FALSE(observer.Saw(Type_IconStyle));
+}
+
+TEST_F(ParseFilterTest, TestKeepSource) {
+  // An Element with skipped content is not copied from the source.
+  parse_filter_.SkipElement(Type_description);
+  Parser parser;
+  parser.set_parse_filter(&parse_filter_);
+  string kml(kKml);
+  SourceBufferPtr source_buffer(new SourceBuffer(&kml));
+  DocumentPtr document = AsDocument(parser.ParseSource(source_buffer, NULL));
+  ASSERT_TRUE(document);
+  ASSERT_TRUE(document->get_source_range().empty());
+  ASSERT_TRUE(document->get_feature_array_at(0)->get_source_range().empty());
+  ASSERT_FALSE(document->get_feature_array_at(1)->get_source_range().empty());
+  ASSERT_FALSE(document->get_styleselector_array_at(0)->
+               get_source_range().empty());
+  string xml;
+  StringAdapter string_adapter(&xml);
+  XmlSerializer<StringAdapter>::Serialize(document, "", "", &string_adapter,
+                                          source_buffer);
+  ASSERT_EQ(string::npos, xml.find("description"));
+  ASSERT_NE(string::npos, xml.find("<Placemark id=\"p1\">"));
+}
+
+// This keeps only the Features with a name.
+class NamedFeatureParseFilter : public ParseFilter {
+ public:
+  virtual bool KeepsFeature(const FeaturePtr& feature) const {
+    return feature->has_name();
+  }
+};
+
+TEST_F(ParseFilterTest, TestKeepsFeature) {
+  const string kFolders(
+      "<Folder><name>f</name>"
+      "<Placemark id=\"a\"/>"
+      "<Folder id=\"b\"><Placemark id=\"c\"><name>c</name></Placemark>"
+      "</Folder>"
+      "<Placemark id=\"d\"><name>d</name></Placemark>"
+      "</Folder>");
+  NamedFeatureParseFilter named_feature_parse_filter;
+  Parser parser;
+  parser.set_parse_filter(&named_feature_parse_filter);
+  ASSERT_EQ(string("<Folder><name>f</name>"
+                   "<Placemark id=\"d\"><name>d</name></Placemark>"
+                   "</Folder>"),
+            SerializeRaw(parser.Parse(kFolders, NULL)));
+}
+
+}  // end namespace kmldom
@@ -0,0 +1,133 @@
+// Copyright 2008, Google Inc. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//  3. Neither the name of Google Inc. nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// This file contains the implementation of the ParseProfile class.
+
+#include "kml/dom/parse_profile.h"
+#include <sstream>
+#include "kml/base/time_util.h"
+#include "kml/dom/xsd.h"
+
+namespace kmldom {
+
+ParseProfile::ParseProfile()
+  : element_profiles_(Type_Invalid + 1),
+    allocation_counter_(NULL) {
+}
+
+const ElementProfile& ParseProfile::get_element_profile(
+    KmlDomType type_id) const {
+  return element_profiles_[type_id < Type_Invalid ? type_id : Type_Unknown];
+}
+
+ElementProfile ParseProfile::GetTotal() const {
+  ElementProfile total;
+  for (size_t i = 0; i < element_profiles_.size(); ++i) {
+    const ElementProfile& element_profile = element_profiles_[i];
+    total.element_count += element_profile.element_count;
+    total.char_data_bytes += element_profile.char_data_bytes;
+    total.create_time += element_profile.create_time;
+    total.attributes_time += element_profile.attributes_time;
+    total.add_element_time += element_profile.add_element_time;
+    total.observers_time += element_profile.observers_time;
+    total.allocation_count += element_profile.allocation_count;
+  }
+  return total;
+}
+
+void ParseProfile::Clear() {
+  element_profiles_.assign(element_profiles_.size(), ElementProfile());
+}
+
+static void SerializeElementProfile(const string& name,
+                                    const ElementProfile& element_profile,
+                                    std::ostream* output) {
+  *output << name << ','
+          << element_profile.element_count << ','
+          << element_profile.char_data_bytes << ','
+          << element_profile.create_time * 1000000 << ','
+          << element_profile.attributes_time * 1000000 << ','
+          << element_profile.add_element_time * 1000000 << ','
+          << element_profile.observers_time * 1000000 << ','
+          << element_profile.allocation_count << '\n';
+}
+
+void ParseProfile::Serialize(string* output) const {
+  if (!output) {
+    return;
+  }
+  std::ostringstream report;
+  report.setf(std::ios::fixed);
+  report.precision(0);
+  report << "element,count,char_data_bytes,create_usec,attributes_usec,"
+         << "add_element_usec,observers_usec,allocations\n";
+  const Xsd& xsd = *Xsd::GetSchema();
+  for (size_t i = 0; i < element_profiles_.size(); ++i) {
+    if (element_profiles_[i].element_count > 0) {
+      SerializeElementProfile(i == Type_Unknown ? "unknown" :
+                                  xsd.ElementName(static_cast<int>(i)),
+                              element_profiles_[i], &report);
+    }
+  }
+  SerializeElementProfile("total", GetTotal(), &report);
+  output->append(report.str());
+}
+
+void ParseProfile::StartInterval(double* start_time,
+                                 size_t* start_allocations) const {
+  *start_allocations = allocation_counter_ ? allocation_counter_() : 0;
+  *start_time = kmlbase::GetMicroTime();
+}
+
+void ParseProfile::EndInterval(KmlDomType type_id, Phase phase,
+                               double start_time, size_t start_allocations) {
+  const double elapsed = kmlbase::GetMicroTime() - start_time;
+  ElementProfile* element_profile = GetElementProfile(type_id);
+  switch (phase) {
+    case PHASE_CREATE:
+      element_profile->create_time += elapsed;
+      break;
+    case PHASE_ATTRIBUTES:
+      element_profile->attributes_time += elapsed;
+      break;
+    case PHASE_ADD_ELEMENT:
+      element_profile->add_element_time += elapsed;
+      break;
+    case PHASE_OBSERVERS:
+      element_profile->observers_time += elapsed;
+      break;
+  }
+  if (allocation_counter_) {
+    element_profile->allocation_count +=
+        allocation_counter_() - start_allocations;
+  }
+}
+
+// private
+ElementProfile* ParseProfile::GetElementProfile(KmlDomType type_id) {
+  return &element_profiles_[type_id < Type_Invalid ? type_id : Type_Unknown];
+}
+
+}  // end namespace kmldom
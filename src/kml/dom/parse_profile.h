@@ -0,0 +1,166 @@
+// Copyright 2008, Google Inc. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//  3. Neither the name of Google Inc. nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// This file contains the declaration of the ParseProfile class which
+// records where the time of a parse goes for each type of element.
+
+#ifndef KML_DOM_PARSE_PROFILE_H__
+#define KML_DOM_PARSE_PROFILE_H__
+
+#include <stddef.h>
+#include <vector>
+#include "kml/dom/kml22.h"
+#include "kml/base/util.h"
+
+namespace kmldom {
+
+// The statistics a ParseProfile gathers for one type of element.  All times
+// are in seconds.
+struct ElementProfile {
+  ElementProfile()
+    : element_count(0), char_data_bytes(0), create_time(0),
+      attributes_time(0), add_element_time(0), observers_time(0),
+      allocation_count(0) {}
+  // The number of elements of this type.
+  size_t element_count;
+  // The size of the character data of these elements.
+  size_t char_data_bytes;
+  // Time in KmlFactory creating these elements.
+  double create_time;
+  // Time in Element::ParseAttributes().
+  double attributes_time;
+  // Time in Element::AddElement() adding these elements to their parents.
+  // This includes <coordinates> and the like parsing their own character
+  // data.
+  double add_element_time;
+  // Time in the ParserObservers called for these elements.
+  double observers_time;
+  // The number of allocations during the above.  This is always 0 unless
+  // ParseProfile::set_allocation_counter() is used.
+  size_t allocation_count;
+};
+
+// A ParseProfile is handed to Parser::set_parse_profile() to gather an
+// ElementProfile for each type of element.  Unknown (non-KML) elements and
+// markup within <description> are gathered under Type_Unknown.  Their time
+// is that spent saving them as text and their character data is that text.
+//
+// Each time is the sum of many short intervals measured with
+// kmlbase::GetMicroTime().  Each interval is rounded to the clock's
+// resolution but the rounding evens out over the large number of elements
+// which makes a profile worth looking at.
+//
+// Intended usage:
+//   ParseProfile parse_profile;
+//   Parser parser;
+//   parser.set_parse_profile(&parse_profile);
+//   ElementPtr root = parser.Parse(kml, &errors);
+//   string report;
+//   parse_profile.Serialize(&report);
+class ParseProfile {
+ public:
+  // The parts of the parse an interval is charged to.
+  enum Phase {
+    PHASE_CREATE,
+    PHASE_ATTRIBUTES,
+    PHASE_ADD_ELEMENT,
+    PHASE_OBSERVERS
+  };
+
+  // A function which returns the number of allocations made so far.  A
+  // program which counts allocations in its operator new can supply one.
+  typedef size_t (*AllocationCounter)();
+
+  ParseProfile();
+
+  void set_allocation_counter(AllocationCounter allocation_counter) {
+    allocation_counter_ = allocation_counter;
+  }
+
+  // This returns the profile of the given type of element.
+  const ElementProfile& get_element_profile(KmlDomType type_id) const;
+
+  // This returns the sum of the profiles of all types of elements.
+  ElementProfile GetTotal() const;
+
+  // This forgets all gathered statistics.
+  void Clear();
+
+  // This appends a CSV report to the given string.  The first line names
+  // the columns: element, count, char_data_bytes, create_usec,
+  // attributes_usec, add_element_usec, observers_usec, allocations.  There
+  // is one line for each type of element seen in the parse in order of type
+  // id and a last line named "total".
+  void Serialize(string* output) const;
+
+  // These are called by the parser.
+  void AddElement(KmlDomType type_id) {
+    ++GetElementProfile(type_id)->element_count;
+  }
+  void AddCharData(KmlDomType type_id, size_t size) {
+    GetElementProfile(type_id)->char_data_bytes += size;
+  }
+  void StartInterval(double* start_time, size_t* start_allocations) const;
+  void EndInterval(KmlDomType type_id, Phase phase, double start_time,
+                   size_t start_allocations);
+
+ private:
+  ElementProfile* GetElementProfile(KmlDomType type_id);
+  std::vector<ElementProfile> element_profiles_;
+  AllocationCounter allocation_counter_;
+  LIBKML_DISALLOW_EVIL_CONSTRUCTORS(ParseProfile);
+};
+
+// This charges the time and allocations of its scope to the given type of
+// element and phase of the given ParseProfile.  It does nothing if the
+// ParseProfile is NULL.
+class ParseProfileInterval {
+ public:
+  ParseProfileInterval(ParseProfile* parse_profile, KmlDomType type_id,
+                       ParseProfile::Phase phase)
+    : parse_profile_(parse_profile), type_id_(type_id), phase_(phase) {
+    if (parse_profile_) {
+      parse_profile_->StartInterval(&start_time_, &start_allocations_);
+    }
+  }
+  ~ParseProfileInterval() {
+    if (parse_profile_) {
+      parse_profile_->EndInterval(type_id_, phase_, start_time_,
+                                  start_allocations_);
+    }
+  }
+
+ private:
+  ParseProfile* parse_profile_;
+  KmlDomType type_id_;
+  ParseProfile::Phase phase_;
+  double start_time_;
+  size_t start_allocations_;
+  LIBKML_DISALLOW_EVIL_CONSTRUCTORS(ParseProfileInterval);
+};
+
+}  // end namespace kmldom
+
+#endif  // KML_DOM_PARSE_PROFILE_H__
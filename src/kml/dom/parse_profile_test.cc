@@ -0,0 +1,157 @@
+// Copyright 2008, Google Inc. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//  3. Neither the name of Google Inc. nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// This file contains the unit tests for the ParseProfile class.
+
+#include "kml/dom/parse_profile.h"
+#include <sstream>
+#include "kml/dom/kml_cast.h"
+#include "kml/dom/parser.h"
+#include "kml/dom/parser_observer.h"
+#include "gtest/gtest.h"
+
+namespace kmldom {
+
+static const char kKml[] =
+    "<Document>"
+    "<Placemark id=\"p0\"><name>abc</name>"
+    "<description>x<b>y</b></description>"
+    "<Point><coordinates>1,2</coordinates></Point></Placemark>"
+    "<Placemark id=\"p1\"><name>defg</name><foo>bar</foo></Placemark>"
+    "</Document>";
+
+// Each call counts as one allocation.
+static size_t call_count = 0;
+static size_t CountCalls() {
+  return call_count++;
+}
+
+TEST(ParseProfileTest, TestEmpty) {
+  ParseProfile parse_profile;
+  ASSERT_EQ(static_cast<size_t>(0),
+            parse_profile.get_element_profile(Type_Placemark).element_count);
+  ASSERT_EQ(static_cast<size_t>(0), parse_profile.GetTotal().element_count);
+  string report;
+  parse_profile.Serialize(&report);
+  ASSERT_EQ(string("element,count,char_data_bytes,create_usec,"
+                   "attributes_usec,add_element_usec,observers_usec,"
+                   "allocations\n"
+                   "total,0,0,0,0,0,0,0\n"), report);
+  parse_profile.Serialize(NULL);  // Silently ignored.
+}
+
+TEST(ParseProfileTest, TestParse) {
+  ParseProfile parse_profile;
+  Parser parser;
+  parser.set_parse_profile(&parse_profile);
+  string errors;
+  ASSERT_TRUE(parser.Parse(kKml, &errors));
+  ASSERT_TRUE(errors.empty());
+
+  ASSERT_EQ(static_cast<size_t>(1),
+            parse_profile.get_element_profile(Type_Document).element_count);
+  const ElementProfile& placemark =
+      parse_profile.get_element_profile(Type_Placemark);
+  ASSERT_EQ(static_cast<size_t>(2), placemark.element_count);
+  ASSERT_LE(0, placemark.create_time);
+  ASSERT_LE(0, placemark.attributes_time);
+  ASSERT_LE(0, placemark.add_element_time);
+  ASSERT_LE(0, placemark.observers_time);
+  ASSERT_EQ(static_cast<size_t>(0), placemark.allocation_count);
+  const ElementProfile& name = parse_profile.get_element_profile(Type_name);
+  ASSERT_EQ(static_cast<size_t>(2), name.element_count);
+  ASSERT_EQ(static_cast<size_t>(7), name.char_data_bytes);
+  ASSERT_EQ(static_cast<size_t>(3),
+            parse_profile.get_element_profile(Type_coordinates)
+                .char_data_bytes);
+  // The description's markup is part of its character data.
+  ASSERT_EQ(static_cast<size_t>(9),
+            parse_profile.get_element_profile(Type_description)
+                .char_data_bytes);
+  // <b> within <description> and <foo> are unknown.  Only the latter is
+  // saved as unknown text.
+  const ElementProfile& unknown =
+      parse_profile.get_element_profile(Type_Unknown);
+  ASSERT_EQ(static_cast<size_t>(2), unknown.element_count);
+  ASSERT_EQ(string("<foo>bar</foo>\n").size(), unknown.char_data_bytes);
+  ASSERT_EQ(&unknown, &parse_profile.get_element_profile(Type_Invalid));
+
+  const ElementProfile total = parse_profile.GetTotal();
+  ASSERT_EQ(static_cast<size_t>(10), total.element_count);
+
+  string report;
+  parse_profile.Serialize(&report);
+  std::istringstream lines(report);
+  string line;
+  size_t line_count = 0;
+  while (std::getline(lines, line)) {
+    ++line_count;
+  }
+  // The header, 7 types of element and the total.
+  ASSERT_EQ(static_cast<size_t>(9), line_count);
+  ASSERT_NE(string::npos, report.find("\nunknown,2,15,"));
+  ASSERT_NE(string::npos, report.find("\nPlacemark,2,0,"));
+  ASSERT_NE(string::npos, report.find("\ntotal,10,"));
+
+  parse_profile.Clear();
+  ASSERT_EQ(static_cast<size_t>(0), parse_profile.GetTotal().element_count);
+}
+
+TEST(ParseProfileTest, TestAllocationCounter) {
+  ParseProfile parse_profile;
+  parse_profile.set_allocation_counter(CountCalls);
+  Parser parser;
+  parser.set_parse_profile(&parse_profile);
+  ParserObserver parser_observer;
+  parser.AddObserver(&parser_observer);
+  ASSERT_TRUE(parser.Parse(kKml, NULL));
+  // Each Placemark is charged one "allocation" for each of create,
+  // attributes, the three observer calls, taking its character data and
+  // being added to its parent.
+  ASSERT_EQ(static_cast<size_t>(14),
+            parse_profile.get_element_profile(Type_Placemark)
+                .allocation_count);
+}
+
+TEST(ParseProfileTest, TestParseParallel) {
+  // A profiled parse is done serially.
+  std::stringstream kml;
+  kml << "<Document>";
+  for (int i = 0; i < 10000; ++i) {
+    kml << "<Placemark><name>" << i << "</name></Placemark>";
+  }
+  kml << "</Document>";
+  ParseProfile parse_profile;
+  Parser parser;
+  parser.set_parse_profile(&parse_profile);
+  ElementPtr root = parser.ParseParallel(kml.str(), 4, NULL);
+  ASSERT_TRUE(AsDocument(root));
+  ASSERT_EQ(static_cast<size_t>(10000),
+            parse_profile.get_element_profile(Type_Placemark).element_count);
+  ASSERT_EQ(static_cast<size_t>(10000),
+            parse_profile.get_element_profile(Type_name).element_count);
+}
+
+}  // end namespace kmldom
@@ -28,17 +28,20 @@
 // of the ExpatParser() function.
 
 #include "kml/dom/kml_funcs.h"
+#include <algorithm>
 #include <cstring>
 #include <sstream>
-#include "kml/base/attributes.h"
 #include "kml/base/expat_parser.h"
-#include "kml/base/expat_handler_ns.h"
-#include "kml/base/xmlns.h"
+#include "kml/base/parallel.h"
+#include "kml/base/zip_file.h"
 #include "kml/dom/element.h"
 #include "kml/dom/kml_handler.h"
 #include "kml/dom/kml_handler_ns.h"
+#include "kml/dom/kml_splitter.h"
 #include "kml/dom/parser.h"
 #include "kml/dom/parser_observer.h"
+#include "kml/dom/parser_session.h"
+#include "kml/dom/source_slice.h"
 
 namespace kmldom {
 
@@ -52,18 +55,79 @@ void Parser::AddObserver(ParserObserver* parser_observer) {
 // public and SWIG.
 ElementPtr Parser::Parse(const string& kml, string* errors) {
   KmlHandler kml_handler(observers_);
-  kmlbase::ExpatParser parser(&kml_handler, false);
+  kml_handler.set_string_pool(string_pool_);
+  kml_handler.set_parse_profile(parse_profile_);
+  kml_handler.set_parse_filter(parse_filter_);
   if (kmlbase::ExpatParser::ParseString(kml, &kml_handler, errors, false)) {
     return kml_handler.PopRoot();
   }
   return NULL;
 }
 
+ElementPtr Parser::ParseSource(const SourceBufferPtr& source_buffer,
+                               string* errors) {
+  if (!source_buffer) {
+    return NULL;
+  }
+  KmlHandler kml_handler(observers_);
+  kml_handler.set_string_pool(string_pool_);
+  kml_handler.set_parse_profile(parse_profile_);
+  kml_handler.set_parse_filter(parse_filter_);
+  if (source_buffer->IsSliceable()) {
+    kml_handler.set_source_buffer(source_buffer);
+  }
+  if (kmlbase::ExpatParser::ParseString(source_buffer->get_data(),
+                                        &kml_handler, errors, false)) {
+    return kml_handler.PopRoot();
+  }
+  return NULL;
+}
+
+// The size of each piece of a ZIP archive entry inflated by ParseZipEntry.
+static const size_t kZipEntryBufferSize = 64 * 1024;
+
+ElementPtr Parser::ParseZipEntry(kmlbase::ZipEntryReader* zip_entry_reader,
+                                 string* errors) {
+  if (!zip_entry_reader) {
+    return NULL;
+  }
+  KmlHandler kml_handler(observers_);
+  kml_handler.set_string_pool(string_pool_);
+  kml_handler.set_parse_profile(parse_profile_);
+  kml_handler.set_parse_filter(parse_filter_);
+  kmlbase::ExpatParser parser(&kml_handler, false);
+  for (;;) {
+    void* buf = parser.GetInternalBuffer(kZipEntryBufferSize);
+    if (!buf) {
+      if (errors) {
+        *errors = "memory error";
+      }
+      return NULL;
+    }
+    int nread = zip_entry_reader->Read(buf, kZipEntryBufferSize);
+    if (nread < 0) {
+      if (errors) {
+        *errors = "ZIP entry read error";
+      }
+      return NULL;
+    }
+    if (!parser.ParseInternalBuffer(static_cast<size_t>(nread), errors,
+                                    nread == 0)) {
+      return NULL;
+    }
+    if (nread == 0) {
+      return kml_handler.PopRoot();
+    }
+  }
+}
 
 // As Parser::Parse(), but invokes the underlying XML parser's namespace-aware
 // mode.
 ElementPtr Parser::ParseNS(const string& kml, string* errors) {
   KmlHandlerNS kml_handler(observers_);
+  kml_handler.set_string_pool(string_pool_);
+  kml_handler.set_parse_profile(parse_profile_);
+  kml_handler.set_parse_filter(parse_filter_);
   if (kmlbase::ExpatParser::ParseString(kml, &kml_handler, errors, true)) {
     return kml_handler.PopRoot();
   }
@@ -73,34 +137,173 @@ ElementPtr Parser::ParseNS(const string& kml, string* errors) {
 // This is obviously a bit of a special case.  If libkml always used full
 // namespace-aware parsing we'd not need this.
 ElementPtr Parser::ParseAtom(const string& atom, string* errors) {
-  // Create a garden variety KML parser with "short-hand" namespace prefixes
-  // for Atom.
-  KmlHandler kml_handler(observers_);
-  kmlbase::Attributes attributes;
-  // Create a namespace aware expat handler which converts the Atom namespace
-  // elements to the "short-hand" namespace prefixing used in KmlHandler.
+  KmlHandlerNS kml_handler(observers_);
+  kml_handler.set_string_pool(string_pool_);
+  kml_handler.set_parse_profile(parse_profile_);
+  kml_handler.set_parse_filter(parse_filter_);
   // Here's the overall flow:
   // 1) instance file has <feed xmlns="http://www.w3.org/2005/Atom">...
   // 2) namespace-enabled expat turns this into:
   //    <http://www.w3.org/2005/Atom|feed>
-  // 3) ExpatHandlerNns turns this to <atom:feed>
-  // 4) KmlHandler knows that <atom:feed> is kmldom::AtomFeed
-  attributes.SetValue("xmlns", "http://www.opengis.net/kml/2.2");
-  attributes.SetValue("xmlns:atom", "http://www.w3.org/2005/Atom");
-  boost::scoped_ptr<kmlbase::Xmlns> xmlns(kmlbase::Xmlns::Create(attributes));
-  kmlbase::ExpatHandlerNs expat_handler_ns(&kml_handler, xmlns.get());
-  if (kmlbase::ExpatParser::ParseString(atom, &expat_handler_ns, errors,
-                                        true)) {
+  // 3) KmlHandlerNS finds "feed" in the Atom namespace is kmldom::AtomFeed
+  // KML elements in the feed are found likewise in the KML namespace.
+  kml_handler.set_qualify_unknown_names(true);
+  if (kmlbase::ExpatParser::ParseString(atom, &kml_handler, errors, true)) {
     return kml_handler.PopRoot();
   }
   return NULL;
 }
 
+// Chunks of a parallel parse are at least this big to keep the per-chunk
+// overhead small.
+static const size_t kMinParallelChunkSize = 64 * 1024;
+
+// A parallel parse aims for this many chunks per thread to balance the load.
+static const size_t kChunksPerThread = 4;
+
+// Input is handed to expat in pieces of at most this size.
+static const size_t kParseBufferSize = 1024 * 1024;
+
+// Sends size bytes starting at data to the given parser.
+static bool ParseBytes(kmlbase::ExpatParser* parser, const char* data,
+                       size_t size, bool is_final, string* errors) {
+  do {
+    const size_t length = std::min(size, kParseBufferSize);
+    void* buffer = parser->GetInternalBuffer(length);
+    if (!buffer) {
+      if (errors) {
+        *errors = "could not allocate memory";
+      }
+      return false;
+    }
+    memcpy(buffer, data, length);
+    data += length;
+    size -= length;
+    if (!parser->ParseInternalBuffer(length, errors, is_final && size == 0)) {
+      return false;
+    }
+  } while (size > 0);
+  return true;
+}
+
+// This ParallelTask parses each chunk of a KmlSplit into a KmlFragment.
+class ParseChunkTask : public kmlbase::ParallelTask {
+ public:
+  ParseChunkTask(const string& kml, const KmlSplit& split,
+                 bool record_observer_calls)
+    : kml_(kml),
+      split_(split),
+      record_observer_calls_(record_observer_calls),
+      fragments_(split.chunks.size()),
+      status_(split.chunks.size(), false) {
+    open_tag_ = kml.substr(0, split.header_end) + "<" + split.container_name +
+        split.xmlns_attributes + ">";
+    close_tag_ = "</" + split.container_name + ">";
+    for (size_t i = 0; i < fragments_.size(); ++i) {
+      fragments_[i] = new KmlFragment;
+    }
+  }
+
+  ~ParseChunkTask() {
+    for (size_t i = 0; i < fragments_.size(); ++i) {
+      delete fragments_[i];
+    }
+  }
+
+  virtual void Run(size_t index) {
+    parser_observer_vector_t observers;
+    if (record_observer_calls_) {
+      observers.push_back(fragments_[index]);
+    }
+    KmlHandler kml_handler(observers, fragments_[index],
+                           split_.container_depth);
+    kmlbase::ExpatParser parser(&kml_handler, false);
+    const std::pair<size_t, size_t>& chunk = split_.chunks[index];
+    status_[index] =
+        ParseBytes(&parser, open_tag_.data(), open_tag_.size(), false, NULL) &&
+        ParseBytes(&parser, kml_.data() + chunk.first,
+                   chunk.second - chunk.first, false, NULL) &&
+        ParseBytes(&parser, close_tag_.data(), close_tag_.size(), true, NULL);
+  }
+
+  // Returns true if every chunk parsed without error.
+  bool succeeded() const {
+    return std::find(status_.begin(), status_.end(), false) == status_.end();
+  }
+
+  KmlFragment* get_fragment(size_t index) const {
+    return fragments_[index];
+  }
+
+ private:
+  const string& kml_;
+  const KmlSplit& split_;
+  const bool record_observer_calls_;
+  string open_tag_;
+  string close_tag_;
+  std::vector<KmlFragment*> fragments_;
+  // Each thread writes only its own chunk's status.  Note this is not a
+  // std::vector<bool> whose elements share storage.
+  std::vector<char> status_;
+};
+
+ElementPtr Parser::ParseParallel(const string& kml, unsigned int num_threads,
+                                 string* errors) {
+  if (num_threads == 0) {
+    num_threads = kmlbase::GetProcessorCount();
+  }
+  KmlSplit split;
+  const size_t min_chunk_size = std::max(
+      kMinParallelChunkSize, kml.size() / (num_threads * kChunksPerThread));
+  if (num_threads < 2 || parse_profile_ || parse_filter_ ||
+      !SplitKml(kml, min_chunk_size, &split)) {
+    return Parse(kml, errors);
+  }
+
+  ParseChunkTask parse_chunk_task(kml, split, !observers_.empty());
+  kmlbase::RunParallel(&parse_chunk_task, split.chunks.size(), num_threads);
+
+  // Check the rest of the document before any ParserObserver is called.
+  // Any error is reported by a serial parse with exact line numbers.
+  {
+    parser_observer_vector_t no_observers;
+    KmlHandler kml_handler(no_observers);
+    kmlbase::ExpatParser parser(&kml_handler, false);
+    if (!parse_chunk_task.succeeded() ||
+        !ParseBytes(&parser, kml.data(), split.prefix_end, false, NULL) ||
+        !ParseBytes(&parser, kml.data() + split.suffix_begin,
+                    kml.size() - split.suffix_begin, true, NULL) ||
+        !kml_handler.PopRoot()) {
+      return Parse(kml, errors);
+    }
+  }
+
+  // Now parse the prefix, append each chunk in order and parse the suffix.
+  // This can only fail if a ParserObserver terminates the parse which Parse()
+  // reports as follows.
+  KmlHandler kml_handler(observers_);
+  kml_handler.set_string_pool(string_pool_);
+  kmlbase::ExpatParser parser(&kml_handler, false);
+  bool status = ParseBytes(&parser, kml.data(), split.prefix_end, false, NULL);
+  for (size_t i = 0; status && i < split.chunks.size(); ++i) {
+    KmlFragment* fragment = parse_chunk_task.get_fragment(i);
+    status = kml_handler.AppendFragment(*fragment);
+    fragment->clear();
+  }
+  if (status && ParseBytes(&parser, kml.data() + split.suffix_begin,
+                           kml.size() - split.suffix_begin, true, NULL)) {
+    return kml_handler.PopRoot();
+  }
+  if (errors) {
+    *errors = "Invalid root element";
+  }
+  return NULL;
+}
+
 // This is the implementation of the public API to parse KML from a memory
 // buffer.
 ElementPtr Parse(const string& kml, string* errors) {
-  Parser parser;
-  return parser.Parse(kml, errors);
+  return GetThreadParserSession()->Parse(kml, errors);
 }
 
 // As Parse(), but invokes the underlying XML parser's namespace-aware mode.
@@ -31,10 +31,19 @@
 #include <vector>
 #include "kml/dom/kml_ptr.h"
 #include "kml/dom/parser_observer.h"
+#include "kml/dom/source_slice.h"
 #include "kml/base/util.h"
 
+namespace kmlbase {
+class StringPool;
+class ZipEntryReader;
+}
+
 namespace kmldom {
 
+class ParseFilter;
+class ParseProfile;
+
 // The internal Parser class implements the public Parse API.
 // CDATA tags are dropped (by expat) upon parse and internally we carry
 // around the resultant representation. There are thus no methods within
@@ -52,13 +61,31 @@ namespace kmldom {
 //   ElementPtr root = parser.Parse(kml, &errors);
 class Parser {
  public:
-  Parser() {}
+  Parser()
+    : string_pool_(NULL), parse_profile_(NULL), parse_filter_(NULL) {}
   // This method calls the parser with the given KML string.  If there are
   // any errors NULL is returned and if error's is non-NULL a human readable
   // diagnostic is stored there.  If there are no parse errors the root
   // element is returned.  Note that any ParseObserver can terminate the parse.
   ElementPtr Parse(const string& kml, string *errors);
 
+  // As Parse(), but the KML is that of the given SourceBuffer and each
+  // complex Element is given its range of it (see
+  // Element::get_source_range()).  Give the same SourceBuffer to an
+  // XmlSerializer to copy the unchanged Elements from it.  The SourceBuffer
+  // lives as long as any Element with a range of it.  KML in an encoding
+  // other than UTF-8 or with a <!DOCTYPE> is parsed as by Parse() and its
+  // Elements are given no range.  There is no parallel form of this parse.
+  ElementPtr ParseSource(const SourceBufferPtr& source_buffer,
+                         string* errors);
+
+  // As Parse(), but the KML is inflated from the given ZIP archive entry a
+  // piece at a time straight into the XML parser's buffer. The uncompressed
+  // KML is thus never held in memory as a whole. A read error of the entry
+  // fails the parse.
+  ElementPtr ParseZipEntry(kmlbase::ZipEntryReader* zip_entry_reader,
+                           string* errors);
+
   // As Parse(), but invokes the underlying XML parser's namespace-aware mode.
   ElementPtr ParseNS(const string& kml, string *errors);
 
@@ -66,11 +93,52 @@ class Parser {
   // with special recognition of the Atom namespace.  See kml_funcs.h.
   ElementPtr ParseAtom(const string& atom, string *errors);
 
+  // As Parse(), but the direct children of the top-level <Document> or
+  // <Folder> are parsed concurrently on up to num_threads threads (0 means
+  // one per processor) and then added to their parent in document order.
+  // Each ParserObserver is called from the calling thread in the same order
+  // as Parse() would call it.  The one difference is that an EndElement()
+  // returning false only prevents the adding of a direct child of the
+  // top-level container.  A StringPool set with set_string_pool() is only
+  // used for the parts of the document outside the concurrently parsed
+  // children.  A parse with a ParseProfile or a ParseFilter is never done
+  // concurrently.  KML which cannot be split (see kml_splitter.h) or which
+  // has errors is handed to Parse().
+  ElementPtr ParseParallel(const string& kml, unsigned int num_threads,
+                           string* errors);
+
   // This method registers the given ParserObserver-based class.  Each
   // NewElement() and AddChild() method is called in the order added.
   void AddObserver(ParserObserver* parser_observer);
+
+  // Values of the InternedString fields and attributes of the parsed
+  // Elements are interned in the given StringPool such that each repeated
+  // value is stored once.  See kml_handler.h.  The pool is not owned by the
+  // Parser and may be destroyed once the parse is done.  The default is no
+  // pool.
+  void set_string_pool(kmlbase::StringPool* string_pool) {
+    string_pool_ = string_pool;
+  }
+
+  // The time spent on each type of element is gathered in the given
+  // ParseProfile.  See parse_profile.h.  The profile is not owned by the
+  // Parser.  The default is no profile.
+  void set_parse_profile(ParseProfile* parse_profile) {
+    parse_profile_ = parse_profile;
+  }
+
+  // Only the parts of the KML kept by the given ParseFilter are parsed.  See
+  // parse_filter.h.  Elements left out by the filter are never created.
+  // The filter is not owned by the Parser.  The default is no filter.
+  void set_parse_filter(const ParseFilter* parse_filter) {
+    parse_filter_ = parse_filter;
+  }
+
  private:
   parser_observer_vector_t observers_;
+  kmlbase::StringPool* string_pool_;
+  ParseProfile* parse_profile_;
+  const ParseFilter* parse_filter_;
   LIBKML_DISALLOW_EVIL_CONSTRUCTORS(Parser);
 };
 
@@ -0,0 +1,90 @@
+// Copyright 2008, Google Inc. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//  3. Neither the name of Google Inc. nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// This file contains the implementation of the ParserSession class.
+
+#include "kml/dom/parser_session.h"
+#include "kml/base/expat_parser.h"
+#include "kml/base/parallel.h"
+#include "kml/dom/kml_handler.h"
+
+namespace kmldom {
+
+ParserSession::ParserSession()
+  : kml_handler_(new KmlHandler(observers_)),
+    expat_parser_(new kmlbase::ExpatParser(kml_handler_.get(), false)) {
+}
+
+ParserSession::~ParserSession() {
+  // The expat parser refers to the handler.
+  expat_parser_.reset();
+}
+
+ElementPtr ParserSession::Parse(const string& kml, string* errors) {
+  ElementPtr root;
+  if (expat_parser_->ParseDocument(kml, errors)) {
+    root = kml_handler_->PopRoot();
+  }
+  // Ready for the next document now to release this one's Elements.
+  kml_handler_->Reset();
+  if (!expat_parser_->Reset()) {
+    // Expat failed to reset so start over with a fresh parser.
+    expat_parser_.reset(new kmlbase::ExpatParser(kml_handler_.get(), false));
+  }
+  return root;
+}
+
+void ParserSession::AddObserver(ParserObserver* parser_observer) {
+  observers_.push_back(parser_observer);
+}
+
+void ParserSession::set_string_pool(kmlbase::StringPool* string_pool) {
+  kml_handler_->set_string_pool(string_pool);
+}
+
+void ParserSession::set_parse_filter(const ParseFilter* parse_filter) {
+  kml_handler_->set_parse_filter(parse_filter);
+}
+
+static void DeleteParserSession(void* parser_session) {
+  delete static_cast<ParserSession*>(parser_session);
+}
+
+// This is created during static initialization and never destroyed as a
+// thread may exit after static destruction.
+static kmlbase::ThreadLocal* const kThreadParserSession =
+    new kmlbase::ThreadLocal(DeleteParserSession);
+
+ParserSession* GetThreadParserSession() {
+  ParserSession* parser_session =
+      static_cast<ParserSession*>(kThreadParserSession->get());
+  if (!parser_session) {
+    parser_session = new ParserSession;
+    kThreadParserSession->set(parser_session);
+  }
+  return parser_session;
+}
+
+}  // end namespace kmldom
@@ -0,0 +1,93 @@
+// Copyright 2008, Google Inc. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//  3. Neither the name of Google Inc. nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// This file contains the declaration of the ParserSession class.
+
+#ifndef KML_DOM_PARSER_SESSION_H__
+#define KML_DOM_PARSER_SESSION_H__
+
+#include <vector>
+#include "boost/scoped_ptr.hpp"
+#include "kml/dom/kml_ptr.h"
+#include "kml/dom/parser_observer.h"
+#include "kml/base/util.h"
+
+namespace kmlbase {
+class ExpatParser;
+class StringPool;
+}
+
+namespace kmldom {
+
+class KmlHandler;
+class ParseFilter;
+
+// A ParserSession parses one KML document after another as Parser::Parse()
+// does but keeps its expat parser, handler stacks and scratch buffers from
+// one document to the next.  Parser::Parse() sets all of these up anew for
+// each call which, for small documents such as NetworkLinkControl responses,
+// costs more than the parse itself.  A ParserSession is not thread-safe:
+// use one per thread.  The public kmldom::Parse() function uses one such
+// session for each thread.  ParserSession::Parse() must not be called from
+// within a ParserObserver of the same session.
+//
+// Intended usage:
+//   ParserSession parser_session;
+//   parser_session.AddObserver(...);
+//   while (GetNextKml(&kml)) {
+//     ElementPtr root = parser_session.Parse(kml, &errors);
+//     ...
+//   }
+class ParserSession {
+ public:
+  ParserSession();
+  ~ParserSession();
+
+  // As Parser::Parse().
+  ElementPtr Parse(const string& kml, string* errors);
+
+  // As the Parser methods of the same names these apply to each following
+  // call to Parse().
+  void AddObserver(ParserObserver* parser_observer);
+  void set_string_pool(kmlbase::StringPool* string_pool);
+  void set_parse_filter(const ParseFilter* parse_filter);
+
+ private:
+  // The handler holds a reference to this.
+  parser_observer_vector_t observers_;
+  boost::scoped_ptr<KmlHandler> kml_handler_;
+  boost::scoped_ptr<kmlbase::ExpatParser> expat_parser_;
+  LIBKML_DISALLOW_EVIL_CONSTRUCTORS(ParserSession);
+};
+
+// This returns the ParserSession of the calling thread which is created on
+// first use and deleted when the thread exits.  The session is shared by
+// all callers on the thread and is thus for parses with no observers, pool
+// or filter.  This is the session used by kmldom::Parse().
+ParserSession* GetThreadParserSession();
+
+}  // end namespace kmldom
+
+#endif  // KML_DOM_PARSER_SESSION_H__
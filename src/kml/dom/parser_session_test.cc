@@ -0,0 +1,165 @@
+// Copyright 2008, Google Inc. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//  3. Neither the name of Google Inc. nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// This file contains the unit tests for the ParserSession class.
+
+#include "kml/dom/parser_session.h"
+#include <vector>
+#include "kml/base/parallel.h"
+#include "kml/dom/kml_cast.h"
+#include "kml/dom/kml_funcs.h"
+#include "kml/dom/parse_filter.h"
+#include "kml/dom/parser.h"
+#include "gtest/gtest.h"
+
+namespace kmldom {
+
+static const char* const kKml[] = {
+  "<kml><NetworkLinkControl><minRefreshPeriod>5</minRefreshPeriod>"
+  "<cookie>a=b</cookie></NetworkLinkControl></kml>",
+  "<Placemark id=\"p\"><name>x</name>"
+  "<Point><coordinates>1,2</coordinates></Point></Placemark>",
+  "<Document><Folder><Placemark/></Folder><foo>bar</foo></Document>"
+};
+
+TEST(ParserSessionTest, TestParse) {
+  // Each of several documents parses as with a new Parser.
+  ParserSession parser_session;
+  for (int round = 0; round < 2; ++round) {
+    for (size_t i = 0; i < sizeof(kKml) / sizeof(kKml[0]); ++i) {
+      Parser parser;
+      string errors;
+      ElementPtr root = parser_session.Parse(kKml[i], &errors);
+      ASSERT_TRUE(root);
+      ASSERT_TRUE(errors.empty());
+      ASSERT_EQ(SerializeRaw(parser.Parse(kKml[i], NULL)), SerializeRaw(root));
+    }
+  }
+}
+
+TEST(ParserSessionTest, TestErrors) {
+  // A document with an error leaves nothing behind for the next.
+  ParserSession parser_session;
+  string errors;
+  ASSERT_FALSE(parser_session.Parse("<Document><Placemark>", &errors));
+  ASSERT_FALSE(errors.empty());
+  ElementPtr root = parser_session.Parse(kKml[1], NULL);
+  ASSERT_TRUE(AsPlacemark(root));
+  ASSERT_FALSE(parser_session.Parse("", NULL));
+  ASSERT_FALSE(parser_session.Parse("<!DOCTYPE t [<!ENTITY e \"x\">]><t/>",
+                                    NULL));
+  ASSERT_EQ(SerializeRaw(Parse(kKml[2], NULL)),
+            SerializeRaw(parser_session.Parse(kKml[2], NULL)));
+}
+
+TEST(ParserSessionTest, TestOldSchemaIsPerDocument) {
+  // An old style <Schema> applies only to the document it is in.
+  const string kOldSchema(
+      "<Document>"
+      "<Schema parent=\"Placemark\" name=\"S\">"
+      "<SimpleField type=\"string\" name=\"F\"/></Schema>"
+      "<S><F>f</F></S>"
+      "</Document>");
+  ParserSession parser_session;
+  DocumentPtr document = AsDocument(parser_session.Parse(kOldSchema, NULL));
+  ASSERT_TRUE(document);
+  ASSERT_TRUE(AsPlacemark(document->get_feature_array_at(0)));
+  document = AsDocument(parser_session.Parse("<Document><S/></Document>",
+                                             NULL));
+  ASSERT_TRUE(document);
+  ASSERT_EQ(static_cast<size_t>(0), document->get_feature_array_size());
+  ASSERT_EQ(static_cast<size_t>(1),
+            document->get_unknown_elements_array_size());
+}
+
+// This counts the Elements created.
+class CountingParserObserver : public ParserObserver {
+ public:
+  CountingParserObserver() : count_(0) {}
+  virtual bool NewElement(const ElementPtr& element) {
+    ++count_;
+    return true;
+  }
+  int get_count() const {
+    return count_;
+  }
+
+ private:
+  int count_;
+};
+
+TEST(ParserSessionTest, TestObserverAndFilter) {
+  CountingParserObserver observer;
+  ParseFilter parse_filter;
+  parse_filter.SkipElement(Type_Geometry);
+  ParserSession parser_session;
+  parser_session.AddObserver(&observer);
+  parser_session.set_parse_filter(&parse_filter);
+  PlacemarkPtr placemark = AsPlacemark(parser_session.Parse(kKml[1], NULL));
+  ASSERT_TRUE(placemark);
+  ASSERT_FALSE(placemark->has_geometry());
+  // The <Placemark> and its <name>.
+  ASSERT_EQ(2, observer.get_count());
+  ASSERT_TRUE(parser_session.Parse(kKml[1], NULL));
+  ASSERT_EQ(4, observer.get_count());
+}
+
+// Each Run() parses with the thread's ParserSession.
+class ThreadParseTask : public kmlbase::ParallelTask {
+ public:
+  explicit ThreadParseTask(size_t count)
+    : sessions_(count), kml_(count) {}
+  virtual void Run(size_t index) {
+    sessions_[index] = GetThreadParserSession();
+    kml_[index] = SerializeRaw(Parse(kKml[index % 3], NULL));
+  }
+  ParserSession* get_session(size_t index) const {
+    return sessions_[index];
+  }
+  const string& get_kml(size_t index) const {
+    return kml_[index];
+  }
+
+ private:
+  std::vector<ParserSession*> sessions_;
+  std::vector<string> kml_;
+};
+
+TEST(ParserSessionTest, TestGetThreadParserSession) {
+  ParserSession* parser_session = GetThreadParserSession();
+  ASSERT_TRUE(parser_session);
+  ASSERT_EQ(parser_session, GetThreadParserSession());
+
+  const size_t kCount = 64;
+  ThreadParseTask task(kCount);
+  kmlbase::RunParallel(&task, kCount, 4);
+  for (size_t i = 0; i < kCount; ++i) {
+    ASSERT_EQ(SerializeRaw(Parse(kKml[i % 3], NULL)), task.get_kml(i));
+    // The work done on this thread used this thread's session.
+    ASSERT_TRUE(task.get_session(i));
+  }
+}
+
+}  // end namespace kmldom
@@ -27,9 +27,16 @@
 // various internals of the KmlHandler class.
 
 #include "kml/dom/kml_funcs.h"
+#include <sstream>
+#include "boost/scoped_ptr.hpp"
+#include "kml/base/tempfile.h"
+#include "kml/base/zip_file.h"
+#include "kml/base/zip_writer.h"
 #include "kml/dom/element.h"
 #include "kml/dom/kml.h"
 #include "kml/dom/kml_cast.h"
+#include "kml/dom/parser.h"
+#include "kml/dom/parser_observer.h"
 #include "gtest/gtest.h"
 
 namespace kmldom {
@@ -191,4 +198,283 @@ TEST(ParserTest, TestBasicParseAtomWithKml) {
   ASSERT_EQ(string("pm0"), placemark->get_id());
 }
 
+// Unknown Atom elements are prefixed as "atom:" and other unknown elements
+// keep their full namespace.
+TEST(ParserTest, TestParseAtomUnknownNames) {
+  ElementPtr root = ParseAtom(
+    "<feed xmlns='http://www.w3.org/2005/Atom'"
+    " xmlns:gd='http://schemas.google.com/g/2005'>"
+    "<generator>x</generator>"
+    "<gd:resourceId>y</gd:resourceId>"
+    "</feed>", NULL);
+  kmldom::AtomFeedPtr feed = kmldom::AsAtomFeed(root);
+  ASSERT_TRUE(feed.get());
+  ASSERT_EQ(static_cast<size_t>(2), feed->get_unknown_elements_array_size());
+  ASSERT_EQ(string("<atom:generator>x</atom:generator>\n"),
+            feed->get_unknown_elements_array_at(0));
+  ASSERT_EQ(string("<http://schemas.google.com/g/2005|resourceId>y"
+                   "</http://schemas.google.com/g/2005|resourceId>\n"),
+            feed->get_unknown_elements_array_at(1));
+}
+
+// This ParserObserver logs each call it receives.  If drop_type is set an
+// EndElement() for a child of that type returns false.
+class LoggingParserObserver : public ParserObserver {
+ public:
+  LoggingParserObserver(KmlDomType drop_type)
+    : drop_type_(drop_type) {}
+
+  virtual bool NewElement(const ElementPtr& element) {
+    log_ << "N" << element->Type() << GetId(element) << ";";
+    return true;
+  }
+
+  virtual bool EndElement(const ElementPtr& parent, const ElementPtr& child) {
+    log_ << "E" << parent->Type() << "," << child->Type() << ";";
+    return child->Type() != drop_type_;
+  }
+
+  virtual bool AddChild(const ElementPtr& parent, const ElementPtr& child) {
+    log_ << "A" << parent->Type() << "," << child->Type() << GetId(child)
+         << ";";
+    return true;
+  }
+
+  string get_log() const {
+    return log_.str();
+  }
+
+ private:
+  static string GetId(const ElementPtr& element) {
+    ObjectPtr object = AsObject(element);
+    return object ? object->get_id() : "";
+  }
+  KmlDomType drop_type_;
+  std::stringstream log_;
+};
+
+// Returns a Document big enough to be split into several chunks.
+static string CreateLargeKml() {
+  std::stringstream kml;
+  kml << "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n"
+      << "<kml xmlns=\"http://www.opengis.net/kml/2.2\"\n"
+      << " xmlns:gx=\"http://www.google.com/kml/ext/2.2\">\n"
+      << "<NetworkLinkControl><minRefreshPeriod>1</minRefreshPeriod>"
+      << "</NetworkLinkControl>\n"
+      << "<Document id=\"d\">\n<name>big</name>\n"
+      << "<Style id=\"s\"><IconStyle><Icon><href>i.png</href></Icon>"
+      << "</IconStyle></Style>\n";
+  for (int i = 0; i < 4000; ++i) {
+    kml << "<Placemark id=\"p" << i << "\"><name>" << i << "</name>"
+        << "<description>a <b>raw</b> &amp; <![CDATA[<i>x</i>]]></description>"
+        << "<styleUrl>#s</styleUrl><unknown a=\"b\">u</unknown>"
+        << "<gx:balloonVisibility>1</gx:balloonVisibility>"
+        << "<Point><coordinates>" << i % 180 << ",1,2</coordinates></Point>"
+        << "</Placemark>\n";
+    if (i % 500 == 0) {
+      kml << "<unknownSibling>" << i << "</unknownSibling>\n"
+          << "<!-- comment " << i << " -->\n"
+          << "<NetworkLink id=\"n" << i << "\"><Link><href>l.kml</href>"
+          << "</Link></NetworkLink>\n";
+    }
+  }
+  kml << "</Document>\n</kml>\n";
+  return kml.str();
+}
+
+TEST(ParserTest, TestParseParallel) {
+  const string kKml(CreateLargeKml());
+  string errors;
+  LoggingParserObserver serial_observer(Type_Unknown);
+  Parser serial_parser;
+  serial_parser.AddObserver(&serial_observer);
+  ElementPtr serial_root = serial_parser.Parse(kKml, &errors);
+  ASSERT_TRUE(serial_root);
+  ASSERT_TRUE(errors.empty());
+  const string kExpected(SerializePretty(serial_root));
+
+  const unsigned int kThreads[] = { 0, 1, 2, 3, 8 };
+  for (size_t i = 0; i < sizeof(kThreads)/sizeof(kThreads[0]); ++i) {
+    LoggingParserObserver observer(Type_Unknown);
+    Parser parser;
+    parser.AddObserver(&observer);
+    ElementPtr root = parser.ParseParallel(kKml, kThreads[i], &errors);
+    ASSERT_TRUE(root);
+    ASSERT_TRUE(errors.empty());
+    ASSERT_EQ(kExpected, SerializePretty(root));
+    ASSERT_EQ(serial_observer.get_log(), observer.get_log());
+  }
+
+  // Without observers.
+  Parser parser;
+  ASSERT_EQ(kExpected, SerializePretty(parser.ParseParallel(kKml, 4, NULL)));
+}
+
+TEST(ParserTest, TestParseParallelEndElementVeto) {
+  // An EndElement() veto applies to the children of the Document.
+  const string kKml(CreateLargeKml());
+  LoggingParserObserver serial_observer(Type_Placemark);
+  Parser serial_parser;
+  serial_parser.AddObserver(&serial_observer);
+  ElementPtr serial_root = serial_parser.Parse(kKml, NULL);
+  ASSERT_TRUE(serial_root);
+
+  LoggingParserObserver observer(Type_Placemark);
+  Parser parser;
+  parser.AddObserver(&observer);
+  ElementPtr root = parser.ParseParallel(kKml, 4, NULL);
+  ASSERT_TRUE(root);
+  ASSERT_EQ(SerializePretty(serial_root), SerializePretty(root));
+  ASSERT_EQ(serial_observer.get_log(), observer.get_log());
+  DocumentPtr document = AsDocument(AsKml(root)->get_feature());
+  ASSERT_EQ(static_cast<size_t>(8), document->get_feature_array_size());
+}
+
+// This ParserObserver terminates the parse at the Nth NewElement().
+class StoppingParserObserver : public ParserObserver {
+ public:
+  StoppingParserObserver(int count) : count_(count) {}
+  virtual bool NewElement(const ElementPtr& element) {
+    return --count_ > 0;
+  }
+ private:
+  int count_;
+};
+
+TEST(ParserTest, TestParseParallelObserverStop) {
+  const string kKml(CreateLargeKml());
+  const int kCounts[] = { 1, 2, 3, 1000, 20000 };
+  for (size_t i = 0; i < sizeof(kCounts)/sizeof(kCounts[0]); ++i) {
+    string serial_errors;
+    StoppingParserObserver serial_observer(kCounts[i]);
+    Parser serial_parser;
+    serial_parser.AddObserver(&serial_observer);
+    ASSERT_FALSE(serial_parser.Parse(kKml, &serial_errors));
+
+    string errors;
+    StoppingParserObserver observer(kCounts[i]);
+    Parser parser;
+    parser.AddObserver(&observer);
+    ASSERT_FALSE(parser.ParseParallel(kKml, 4, &errors));
+    ASSERT_EQ(serial_errors, errors);
+  }
+}
+
+TEST(ParserTest, TestParseParallelErrors) {
+  // Errors anywhere are reported just as Parse() reports them.
+  string kml(CreateLargeKml());
+  const size_t kOffsets[] = {
+    kml.find("<name>big"), kml.find("<Placemark id=\"p2000\">"),
+    kml.find("</Document>"), kml.size()
+  };
+  for (size_t i = 0; i < sizeof(kOffsets)/sizeof(kOffsets[0]); ++i) {
+    string bad_kml(kml);
+    bad_kml.insert(kOffsets[i], "<a>&</a>");
+    string serial_errors;
+    ASSERT_FALSE(Parse(bad_kml, &serial_errors));
+    string errors;
+    Parser parser;
+    ASSERT_FALSE(parser.ParseParallel(bad_kml, 4, &errors));
+    ASSERT_EQ(serial_errors, errors);
+  }
+}
+
+TEST(ParserTest, TestStringPool) {
+  const string kKml(
+      "<Document>"
+      "<Placemark><styleUrl>#s</styleUrl><ExtendedData>"
+      "<Data name=\"d\"><value>1</value></Data>"
+      "<SchemaData schemaUrl=\"#t\"><SimpleData name=\"e\">2</SimpleData>"
+      "</SchemaData></ExtendedData></Placemark>"
+      "<Placemark><styleUrl>#s</styleUrl><ExtendedData>"
+      "<Data name=\"d\"><value>3</value></Data>"
+      "<SchemaData schemaUrl=\"#t\"><SimpleData name=\"e\">4</SimpleData>"
+      "</SchemaData></ExtendedData></Placemark>"
+      "</Document>");
+  kmlbase::StringPool string_pool;
+  Parser parser;
+  parser.set_string_pool(&string_pool);
+  string errors;
+  DocumentPtr document = AsDocument(parser.Parse(kKml, &errors));
+  ASSERT_TRUE(document);
+  ASSERT_EQ(static_cast<size_t>(2), document->get_feature_array_size());
+  // Each distinct value is interned once.
+  ASSERT_EQ(static_cast<size_t>(4), string_pool.size());
+  ASSERT_EQ(static_cast<size_t>(4), string_pool.get_hit_count());
+  PlacemarkPtr p0 = AsPlacemark(document->get_feature_array_at(0));
+  PlacemarkPtr p1 = AsPlacemark(document->get_feature_array_at(1));
+  ASSERT_EQ(string("#s"), p1->get_styleurl());
+  ASSERT_EQ(p0->get_styleurl().data(), p1->get_styleurl().data());
+  DataPtr d0 = p0->get_extendeddata()->get_data_array_at(0);
+  DataPtr d1 = p1->get_extendeddata()->get_data_array_at(0);
+  ASSERT_EQ(string("d"), d1->get_name());
+  ASSERT_EQ(d0->get_name().data(), d1->get_name().data());
+  ASSERT_EQ(string("3"), d1->get_value());
+  SchemaDataPtr s0 = p0->get_extendeddata()->get_schemadata_array_at(0);
+  SchemaDataPtr s1 = p1->get_extendeddata()->get_schemadata_array_at(0);
+  ASSERT_EQ(string("#t"), s1->get_schemaurl());
+  ASSERT_EQ(s0->get_schemaurl().data(), s1->get_schemaurl().data());
+  ASSERT_EQ(string("e"), s1->get_simpledata_array_at(0)->get_name());
+  ASSERT_EQ(s0->get_simpledata_array_at(0)->get_name().data(),
+            s1->get_simpledata_array_at(0)->get_name().data());
+
+  // Serialization is unaffected by interning.
+  ASSERT_EQ(SerializeRaw(Parse(kKml, NULL)), SerializeRaw(document));
+
+  // Without a pool nothing is shared.
+  document = AsDocument(Parse(kKml, &errors));
+  ASSERT_NE(
+      AsPlacemark(document->get_feature_array_at(0))->get_styleurl().data(),
+      AsPlacemark(document->get_feature_array_at(1))->get_styleurl().data());
+}
+
+TEST(ParserTest, TestParseZipEntry) {
+  // Enough Placemarks to need several pieces of the inflated entry.
+  string kml("<Folder>");
+  for (int i = 0; i < 5000; ++i) {
+    kml.append("<Placemark><name>placemark</name></Placemark>");
+  }
+  kml.append("</Folder>");
+  kmlbase::TempFilePtr tempfile = kmlbase::TempFile::CreateTempFile();
+  ASSERT_TRUE(tempfile != NULL);
+  {
+    boost::scoped_ptr<kmlbase::ZipWriter> zip_writer(
+        kmlbase::ZipWriter::Create(tempfile->name().c_str()));
+    ASSERT_TRUE(zip_writer.get());
+    ASSERT_TRUE(zip_writer->AddEntry(kml, "doc.kml"));
+    ASSERT_TRUE(zip_writer->AddEntry("<Placemark>", "bad.kml"));
+  }
+  boost::scoped_ptr<kmlbase::ZipFile> zip_file(
+      kmlbase::ZipFile::OpenFromFile(tempfile->name().c_str()));
+  ASSERT_TRUE(zip_file.get());
+
+  Parser parser;
+  string errors;
+  boost::scoped_ptr<kmlbase::ZipEntryReader> reader(
+      zip_file->OpenEntry("doc.kml"));
+  ElementPtr root = parser.ParseZipEntry(reader.get(), &errors);
+  ASSERT_TRUE(errors.empty());
+  ASSERT_TRUE(AsFolder(root));
+  ASSERT_EQ(static_cast<size_t>(5000),
+            AsFolder(root)->get_feature_array_size());
+
+  reader.reset(zip_file->OpenEntry("bad.kml"));
+  ASSERT_FALSE(parser.ParseZipEntry(reader.get(), &errors));
+  ASSERT_FALSE(errors.empty());
+  ASSERT_FALSE(parser.ParseZipEntry(NULL, &errors));
+}
+
+TEST(ParserTest, TestParseParallelSmallInput) {
+  // Small input is simply parsed serially.
+  Parser parser;
+  string errors;
+  ElementPtr root = parser.ParseParallel(
+      "<Document><Placemark/><Placemark/></Document>", 4, &errors);
+  ASSERT_TRUE(AsDocument(root));
+  ASSERT_EQ(static_cast<size_t>(2),
+            AsDocument(root)->get_feature_array_size());
+  ASSERT_FALSE(parser.ParseParallel("junk", 4, &errors));
+  ASSERT_FALSE(errors.empty());
+}
+
 }  // end namespace kmldom
@@ -51,10 +51,12 @@ class PolyStyle : public ColorStyle {
     return has_fill_;
   }
   void set_fill(bool fill) {
+    MarkDirty();
     fill_ = fill;
     has_fill_ = true;
   }
   void clear_fill() {
+    MarkDirty();
     fill_ = true;
     has_fill_ = false;
   }
@@ -67,10 +69,12 @@ class PolyStyle : public ColorStyle {
     return has_outline_;
   }
   void set_outline(bool outline) {
+    MarkDirty();
     outline_ = outline;
     has_outline_ = true;
   }
   void clear_outline() {
+    MarkDirty();
     outline_ = true;
     has_outline_ = false;
   }
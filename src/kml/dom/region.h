@@ -57,10 +57,12 @@ class LatLonAltBox : public AbstractLatLonBox {
     return has_minaltitude_;
   }
   void set_minaltitude(double minaltitude) {
+    MarkDirty();
     minaltitude_ = minaltitude;
     has_minaltitude_ = true;
   }
   void clear_minaltitude() {
+    MarkDirty();
     minaltitude_ = 0.0;
     has_minaltitude_ = false;
   }
@@ -73,10 +75,12 @@ class LatLonAltBox : public AbstractLatLonBox {
     return has_maxaltitude_;
   }
   void set_maxaltitude(double maxaltitude) {
+    MarkDirty();
     maxaltitude_ = maxaltitude;
     has_maxaltitude_ = true;
   }
   void clear_maxaltitude() {
+    MarkDirty();
     maxaltitude_ = 0.0;
     has_maxaltitude_ = false;
   }
@@ -89,10 +93,12 @@ class LatLonAltBox : public AbstractLatLonBox {
     return has_altitudemode_;
   }
   void set_altitudemode(int altitudemode) {
+    MarkDirty();
     altitudemode_ = altitudemode;
     has_altitudemode_ = true;
   }
   void clear_altitudemode() {
+    MarkDirty();
     altitudemode_ = ALTITUDEMODE_CLAMPTOGROUND;
     has_altitudemode_ = false;
   }
@@ -105,10 +111,12 @@ class LatLonAltBox : public AbstractLatLonBox {
     return has_gx_altitudemode_;
   }
   void set_gx_altitudemode(int gx_altitudemode) {
+    MarkDirty();
     gx_altitudemode_ = gx_altitudemode;
     has_gx_altitudemode_ = true;
   }
   void clear_gx_altitudemode() {
+    MarkDirty();
     gx_altitudemode_ = GX_ALTITUDEMODE_CLAMPTOSEAFLOOR;
     has_gx_altitudemode_ = false;
   }
@@ -151,10 +159,12 @@ class Lod : public Object {
     return has_minlodpixels_;
   }
   void set_minlodpixels(double minlodpixels) {
+    MarkDirty();
     minlodpixels_ = minlodpixels;
     has_minlodpixels_ = true;
   }
   void clear_minlodpixels() {
+    MarkDirty();
     minlodpixels_ = 0.0;
     has_minlodpixels_ = false;
   }
@@ -167,10 +177,12 @@ class Lod : public Object {
     return has_maxlodpixels_;
   }
   void set_maxlodpixels(double minlodpixels) {
+    MarkDirty();
     maxlodpixels_ = minlodpixels;
     has_maxlodpixels_ = true;
   }
   void clear_maxlodpixels() {
+    MarkDirty();
     maxlodpixels_ = -1.0;
     has_maxlodpixels_ = false;
   }
@@ -183,10 +195,12 @@ class Lod : public Object {
     return has_minfadeextent_;
   }
   void set_minfadeextent(double minlodpixels) {
+    MarkDirty();
     minfadeextent_ = minlodpixels;
     has_minfadeextent_ = true;
   }
   void clear_minfadeextent() {
+    MarkDirty();
     minfadeextent_ = 0.0;
     has_minfadeextent_ = false;
   }
@@ -199,10 +213,12 @@ class Lod : public Object {
     return has_maxfadeextent_;
   }
   void set_maxfadeextent(double maxlodpixels) {
+    MarkDirty();
     maxfadeextent_ = maxlodpixels;
     has_maxfadeextent_ = true;
   }
   void clear_maxfadeextent() {
+    MarkDirty();
     maxfadeextent_ = 0.0;
     has_maxfadeextent_ = false;
   }
@@ -49,10 +49,12 @@ class SimpleField : public BasicElement<Type_SimpleField> {
   const string& get_type() const { return type_; }
   bool has_type() const { return has_type_; }
   void set_type(const string& value) {
+    MarkDirty();
     type_ = value;
     has_type_ = true;
   }
   void clear_type() {
+    MarkDirty();
     type_.clear();
     has_type_ = false;
   }
@@ -60,10 +62,12 @@ class SimpleField : public BasicElement<Type_SimpleField> {
   const string& get_name() const { return name_; }
   bool has_name() const { return has_name_; }
   void set_name(const string& value) {
+    MarkDirty();
     name_ = value;
     has_name_ = true;
   }
   void clear_name() {
+    MarkDirty();
     name_.clear();
     has_name_ = false;
   }
@@ -71,10 +75,12 @@ class SimpleField : public BasicElement<Type_SimpleField> {
   const string& get_displayname() const { return displayname_; }
   bool has_displayname() const { return has_displayname_; }
   void set_displayname(const string& value) {
+    MarkDirty();
     displayname_ = value;
     has_displayname_ = true;
   }
   void clear_displayname() {
+    MarkDirty();
     displayname_.clear();
     has_displayname_ = false;
   }
@@ -135,10 +141,12 @@ class Schema : public Object {
   const string& get_name() const { return name_; }
   bool has_name() const { return has_name_; }
   void set_name(const string& value) {
+    MarkDirty();
     name_ = value;
     has_name_ = true;
   }
   void clear_name() {
+    MarkDirty();
     name_.clear();
     has_name_ = false;
   }
@@ -52,10 +52,12 @@ class SnippetCommon : public Element {
   const string& get_text() const { return text_; }
   bool has_text() const { return has_text_; }
   void set_text(const string& value) {
+    MarkDirty();
     text_ = value;
     has_text_ = true;
   }
   void clear_text() {
+    MarkDirty();
     text_.clear();
     has_text_ = false;
   }
@@ -64,10 +66,12 @@ class SnippetCommon : public Element {
   int get_maxlines() const { return maxlines_; }
   bool has_maxlines() const { return has_maxlines_; }
   void set_maxlines(int value) {
+    MarkDirty();
     maxlines_ = value;
     has_maxlines_ = true;
   }
   void clear_maxlines() {
+    MarkDirty();
     maxlines_ = 2;
     has_maxlines_ = false;
   }
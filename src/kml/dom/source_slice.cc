@@ -0,0 +1,110 @@
+// Copyright 2008, Google Inc. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//  3. Neither the name of Google Inc. nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// This file contains the implementation of the SourceBuffer and SourceSlice
+// classes.
+
+#include "kml/dom/source_slice.h"
+#include <ctype.h>
+
+namespace kmldom {
+
+bool SourceBuffer::IsSliceable() const {
+  if (data_.size() >= 2 &&
+      ((data_[0] == '\xfe' && data_[1] == '\xff') ||
+       (data_[0] == '\xff' && data_[1] == '\xfe'))) {
+    return false;  // UTF-16.
+  }
+  size_t start = data_.compare(0, 3, "\xef\xbb\xbf") == 0 ? 3 : 0;
+  if (HasDoctype(start)) {
+    return false;
+  }
+  if (data_.compare(start, 5, "<?xml") != 0) {
+    return true;
+  }
+  size_t end = data_.find("?>", start);
+  size_t encoding = data_.find("encoding", start);
+  if (end == string::npos || encoding == string::npos || encoding > end) {
+    return true;
+  }
+  size_t quote = data_.find_first_of("\"'", encoding);
+  if (quote == string::npos || quote > end) {
+    return true;
+  }
+  size_t close = data_.find(data_[quote], quote + 1);
+  if (close == string::npos || close > end) {
+    return true;
+  }
+  string name;
+  for (size_t i = quote + 1; i < close; ++i) {
+    name.push_back(static_cast<char>(
+        tolower(static_cast<unsigned char>(data_[i]))));
+  }
+  return name == "utf-8" || name == "us-ascii";
+}
+
+// Private.  Looks for a <!DOCTYPE> among the comments and processing
+// instructions before the root element.
+bool SourceBuffer::HasDoctype(size_t start) const {
+  size_t pos = data_.find('<', start);
+  while (pos != string::npos && pos + 1 < data_.size()) {
+    if (data_.compare(pos, 9, "<!DOCTYPE") == 0) {
+      return true;
+    }
+    size_t end;
+    if (data_.compare(pos, 4, "<!--") == 0) {
+      end = data_.find("-->", pos);
+    } else if (data_[pos + 1] == '?') {
+      end = data_.find("?>", pos);
+    } else {
+      return false;  // The root element.
+    }
+    pos = end == string::npos ? end : data_.find('<', end);
+  }
+  return false;
+}
+
+void AppendUnknownStartTag(const string& name,
+                           const kmlbase::StringVector& atts,
+                           string* markup) {
+  markup->append("<");
+  markup->append(name);
+  for (size_t i = 0; i + 1 < atts.size(); i += 2) {
+    markup->append(" ");
+    markup->append(atts[i]);
+    markup->append("=\"");
+    markup->append(atts[i + 1]);
+    markup->append("\"");
+  }
+  markup->append(">");
+}
+
+void AppendUnknownEndTag(const string& name, string* markup) {
+  markup->append("</");
+  markup->append(name);
+  markup->append(">");
+}
+
+}  // end namespace kmldom
@@ -0,0 +1,117 @@
+// Copyright 2008, Google Inc. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//  3. Neither the name of Google Inc. nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// This file contains the declaration of the SourceBuffer and SourceSlice
+// classes with which a parse may keep the byte range of the KML text of each
+// parsed Element.  See Parser::ParseSource().
+
+#ifndef KML_DOM_SOURCE_SLICE_H__
+#define KML_DOM_SOURCE_SLICE_H__
+
+#include "boost/intrusive_ptr.hpp"
+#include "kml/base/referent.h"
+#include "kml/base/string_util.h"
+#include "kml/base/util.h"
+
+namespace kmldom {
+
+// A SourceBuffer holds the KML text of a parse.  It is shared by the
+// SourceSlices made by the parse and is freed with the last of them.  The
+// text is never changed.
+class SourceBuffer : public kmlbase::Referent {
+ public:
+  // The SourceBuffer takes over the contents of the given string which is
+  // left empty.  The text is not copied.
+  explicit SourceBuffer(string* data) {
+    if (data) {
+      data_.swap(*data);
+    }
+  }
+
+  const string& get_data() const {
+    return data_;
+  }
+
+  // Returns true if a slice of the text can be copied as is into serialized
+  // KML.  This requires the text to be UTF-8 (or to have no XML declaration
+  // naming an encoding) and to have no document type declaration as that may
+  // declare entities used within the slices.
+  bool IsSliceable() const;
+
+ private:
+  bool HasDoctype(size_t start) const;
+  string data_;
+  LIBKML_DISALLOW_EVIL_CONSTRUCTORS(SourceBuffer);
+};
+
+typedef boost::intrusive_ptr<SourceBuffer> SourceBufferPtr;
+
+// A SourceSlice is a byte range of a SourceBuffer holding the whole of a
+// parsed Element (see Element::get_source_range()).
+class SourceSlice {
+ public:
+  SourceSlice() : offset_(0), size_(0) {}
+  SourceSlice(const SourceBufferPtr& source_buffer, size_t offset,
+              size_t size)
+    : source_buffer_(source_buffer), offset_(offset), size_(size) {}
+
+  const SourceBufferPtr& get_source_buffer() const {
+    return source_buffer_;
+  }
+  size_t get_offset() const {
+    return offset_;
+  }
+  size_t get_size() const {
+    return size_;
+  }
+
+  // Returns true if this refers to no SourceBuffer.
+  bool empty() const {
+    return !source_buffer_;
+  }
+
+  // Releases the SourceBuffer.
+  void clear() {
+    source_buffer_ = NULL;
+    offset_ = 0;
+    size_ = 0;
+  }
+
+ private:
+  SourceBufferPtr source_buffer_;
+  size_t offset_;
+  size_t size_;
+};
+
+// These append the markup kept for the start and end tags of an element
+// within an unknown element or a <description>.  See KmlHandler.
+void AppendUnknownStartTag(const string& name,
+                           const kmlbase::StringVector& atts,
+                           string* markup);
+void AppendUnknownEndTag(const string& name, string* markup);
+
+}  // end namespace kmldom
+
+#endif  // KML_DOM_SOURCE_SLICE_H__
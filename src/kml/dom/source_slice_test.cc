@@ -0,0 +1,157 @@
+// Copyright 2008, Google Inc. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//  3. Neither the name of Google Inc. nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// This file contains the unit tests for the SourceBuffer and SourceSlice
+// classes and of parsing with Parser::ParseSource().
+
+#include "kml/dom/source_slice.h"
+#include "kml/dom/kml_cast.h"
+#include "kml/dom/kml_funcs.h"
+#include "kml/dom/parser.h"
+#include "gtest/gtest.h"
+
+namespace kmldom {
+
+// Parses kml with Parse() and with ParseSource() and checks that both
+// serialize the same.  Returns the root parsed with ParseSource().
+static ElementPtr ParseBothWays(const string& kml) {
+  Parser parser;
+  ElementPtr parsed = parser.Parse(kml, NULL);
+  string source(kml);
+  ElementPtr sourced = parser.ParseSource(
+      SourceBufferPtr(new SourceBuffer(&source)), NULL);
+  EXPECT_TRUE(parsed);
+  EXPECT_TRUE(sourced);
+  if (parsed && sourced) {
+    EXPECT_EQ(SerializePretty(parsed), SerializePretty(sourced));
+  }
+  return sourced;
+}
+
+// Returns true if the given KML can be copied into serialized KML as is.
+static bool IsSliceable(const string& kml) {
+  string data(kml);
+  return SourceBuffer(&data).IsSliceable();
+}
+
+TEST(SourceSliceTest, TestEmpty) {
+  SourceSlice source_slice;
+  ASSERT_TRUE(source_slice.empty());
+  ASSERT_EQ(static_cast<size_t>(0), source_slice.get_offset());
+  ASSERT_EQ(static_cast<size_t>(0), source_slice.get_size());
+}
+
+TEST(SourceSliceTest, TestSourceBufferTakesData) {
+  const string kKml("<kml><Placemark><name>p</name></Placemark></kml>");
+  string data(kKml);
+  const char* chars = data.data();
+  SourceBufferPtr source_buffer(new SourceBuffer(&data));
+  ASSERT_TRUE(data.empty());
+  ASSERT_EQ(kKml, source_buffer->get_data());
+  // The text was handed over rather than copied.
+  ASSERT_EQ(chars, source_buffer->get_data().data());
+  ASSERT_TRUE(SourceBuffer(NULL).get_data().empty());
+}
+
+TEST(SourceSliceTest, TestSlice) {
+  string data("<a><b/></a>");
+  SourceBufferPtr source_buffer(new SourceBuffer(&data));
+  SourceSlice source_slice(source_buffer, 3, 4);
+  ASSERT_FALSE(source_slice.empty());
+  ASSERT_EQ(source_buffer, source_slice.get_source_buffer());
+  ASSERT_EQ(static_cast<size_t>(3), source_slice.get_offset());
+  ASSERT_EQ(static_cast<size_t>(4), source_slice.get_size());
+  source_slice.clear();
+  ASSERT_TRUE(source_slice.empty());
+}
+
+TEST(SourceSliceTest, TestIsSliceable) {
+  ASSERT_TRUE(IsSliceable("<kml/>"));
+  ASSERT_TRUE(IsSliceable("\xef\xbb\xbf<kml/>"));
+  ASSERT_TRUE(IsSliceable("<?xml version=\"1.0\"?><kml/>"));
+  ASSERT_TRUE(IsSliceable("<?xml version=\"1.0\" encoding='UTF-8'?><kml/>"));
+  ASSERT_FALSE(IsSliceable(
+      "<?xml version=\"1.0\" encoding=\"iso-8859-1\"?><kml/>"));
+  ASSERT_FALSE(IsSliceable(string("\xff\xfe<\0k\0m\0l\0/\0>\0", 14)));
+  ASSERT_FALSE(IsSliceable(
+      "<?xml version=\"1.0\"?><!-- c --><!DOCTYPE kml [<!ENTITY e \"x\">]>"
+      "<kml/>"));
+  ASSERT_TRUE(IsSliceable("<kml><!DOCTYPE/></kml>"));
+}
+
+TEST(SourceSliceTest, TestParseSource) {
+  const string kKml(
+      "<kml>"
+      "<Placemark><foo a=\"b\">x<bar/>&amp;<Point/></foo><name>n</name>"
+      "<description><![CDATA[<b>d</b>]]></description></Placemark>"
+      "</kml>");
+  KmlPtr kml = AsKml(ParseBothWays(kKml));
+  ASSERT_TRUE(kml);
+  ASSERT_EQ(static_cast<size_t>(0), kml->get_source_range().get_offset());
+  ASSERT_EQ(kKml.size(), kml->get_source_range().get_size());
+  PlacemarkPtr placemark = AsPlacemark(kml->get_feature());
+  ASSERT_TRUE(placemark);
+  ASSERT_FALSE(placemark->get_source_range().empty());
+  ASSERT_EQ(string("n"), placemark->get_name());
+  ASSERT_EQ(string("<b>d</b>"), placemark->get_description());
+  ASSERT_EQ(static_cast<size_t>(1),
+            placemark->get_unknown_elements_array_size());
+  ASSERT_EQ(string("<foo a=\"b\">x<bar></bar>&<Point></Point></foo>\n"),
+            placemark->get_unknown_elements_array_at(0));
+}
+
+TEST(SourceSliceTest, TestParseNotSliceable) {
+  // KML in another encoding is parsed as by Parse() and given no ranges.
+  PlacemarkPtr placemark = AsPlacemark(ParseBothWays(
+      "<?xml version=\"1.0\" encoding=\"iso-8859-1\"?>"
+      "<Placemark><description>\xe9</description><foo>\xe9</foo></Placemark>"));
+  ASSERT_TRUE(placemark);
+  ASSERT_TRUE(placemark->get_source_range().empty());
+  ASSERT_EQ(string("\xc3\xa9"), placemark->get_description());
+  ASSERT_EQ(string("<foo>\xc3\xa9</foo>\n"),
+            placemark->get_unknown_elements_array_at(0));
+}
+
+TEST(SourceSliceTest, TestParseSourceNull) {
+  Parser parser;
+  ASSERT_FALSE(parser.ParseSource(NULL, NULL));
+}
+
+TEST(SourceSliceTest, TestSourceOutlivesParse) {
+  PlacemarkPtr placemark;
+  {
+    string kml("<Placemark><name>p</name></Placemark>");
+    Parser parser;
+    placemark = AsPlacemark(parser.ParseSource(
+        SourceBufferPtr(new SourceBuffer(&kml)), NULL));
+  }
+  ASSERT_TRUE(placemark);
+  const SourceSlice& source_range = placemark->get_source_range();
+  ASSERT_FALSE(source_range.empty());
+  ASSERT_EQ(string("<Placemark><name>p</name></Placemark>"),
+            source_range.get_source_buffer()->get_data());
+}
+
+}  // end namespace kmldom
@@ -53,7 +53,7 @@ void Pair::AddElement(const ElementPtr& element) {
       has_key_ = element->SetEnum(&key_);
       break;
     case Type_styleUrl:
-      has_styleurl_ = element->SetString(&styleurl_);
+      has_styleurl_ = element->SetInternedString(&styleurl_);
       break;
     default:
       Object::AddElement(element);
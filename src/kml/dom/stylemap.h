@@ -57,26 +57,35 @@ class Pair : public Object {
     return has_key_;
   }
   void set_key(int key) {
+    MarkDirty();
     key_ = key;
     has_key_ = true;
   }
   void clear_key() {
+    MarkDirty();
     key_ = STYLESTATE_NORMAL;
     has_key_ = false;
   }
 
   // <styleUrl>
   const string& get_styleurl() const {
-    return styleurl_;
+    return styleurl_.get();
   }
   bool has_styleurl() const {
     return has_styleurl_;
   }
   void set_styleurl(const string& styleurl) {
+    MarkDirty();
+    styleurl_ = kmlbase::InternedString(styleurl);
+    has_styleurl_ = true;
+  }
+  void set_styleurl(const kmlbase::InternedString& styleurl) {
+    MarkDirty();
     styleurl_ = styleurl;
     has_styleurl_ = true;
   }
   void clear_styleurl() {
+    MarkDirty();
     styleurl_.clear();
     has_styleurl_ = false;
   }
@@ -104,7 +113,7 @@ class Pair : public Object {
   virtual void Serialize(Serializer& serializer) const;
   int key_;
   bool has_key_;
-  string styleurl_;
+  kmlbase::InternedString styleurl_;
   bool has_styleurl_;
   StyleSelectorPtr styleselector_;
   LIBKML_DISALLOW_EVIL_CONSTRUCTORS(Pair);
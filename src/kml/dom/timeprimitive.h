@@ -71,10 +71,12 @@ class TimeSpan : public TimePrimitive {
   const string& get_begin() const { return begin_; }
   bool has_begin() const { return has_begin_; }
   void set_begin(const string& value) {
+    MarkDirty();
     begin_ = value;
     has_begin_ = true;
   }
   void clear_begin() {
+    MarkDirty();
     begin_.clear();
     has_begin_ = false;
   }
@@ -83,10 +85,12 @@ class TimeSpan : public TimePrimitive {
   const string& get_end() const { return end_; }
   bool has_end() const { return has_end_; }
   void set_end(const string& value) {
+    MarkDirty();
     end_ = value;
     has_end_ = true;
   }
   void clear_end() {
+    MarkDirty();
     end_.clear();
     has_end_ = false;
   }
@@ -123,10 +127,12 @@ class TimeStamp : public TimePrimitive {
   const string& get_when() const { return when_; }
   bool has_when() const { return has_when_; }
   void set_when(const string& value) {
+    MarkDirty();
     when_ = value;
     has_when_ = true;
   }
   void clear_when() {
+    MarkDirty();
     when_.clear();
     has_when_ = false;
   }
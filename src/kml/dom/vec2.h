@@ -54,10 +54,12 @@ class Vec2 : public Element {
   double get_x() const { return x_; }
   bool has_x() const { return has_x_; }
   void set_x(double value) {
+    MarkDirty();
     x_ = value;
     has_x_ = true;
   }
   void clear_x() {
+    MarkDirty();
     x_ = 1.0;
     has_x_ = false;
   }
@@ -65,10 +67,12 @@ class Vec2 : public Element {
   double get_y() const { return y_; }
   bool has_y() const { return has_y_; }
   void set_y(double value) {
+    MarkDirty();
     y_ = value;
     has_y_ = true;
   }
   void clear_y() {
+    MarkDirty();
     y_ = 1.0;
     has_y_ = false;
   }
@@ -76,10 +80,12 @@ class Vec2 : public Element {
   int get_xunits() const { return xunits_; }
   bool has_xunits() const { return has_xunits_; }
   void set_xunits(int value) {
+    MarkDirty();
     xunits_ = value;
     has_xunits_ = true;
   }
   void clear_xunits() {
+    MarkDirty();
     xunits_ = false;
     has_xunits_ = false;
   }
@@ -87,10 +93,12 @@ class Vec2 : public Element {
   int get_yunits() const { return yunits_; }
   bool has_yunits() const { return has_yunits_; }
   void set_yunits(int value) {
+    MarkDirty();
     yunits_ = value;
     has_yunits_ = true;
   }
   void clear_yunits() {
+    MarkDirty();
     yunits_ = false;
     has_yunits_ = false;
   }
@@ -92,10 +92,12 @@ class XalAdministrativeArea : public BasicElement<Type_XalAdministrativeArea> {
     return has_administrativeareaname_;
   }
   void set_administrativeareaname(const string& value) {
+    MarkDirty();
     administrativeareaname_ = value;
     has_administrativeareaname_ = true;
   }
   void clear_administrativeareaname() {
+    MarkDirty();
     administrativeareaname_.clear();
     has_administrativeareaname_ = false;
   }
@@ -143,10 +145,12 @@ class XalCountry : public BasicElement<Type_XalCountry> {
   const string& get_countrynamecode() const { return countrynamecode_; }
   bool has_countrynamecode() const { return has_countrynamecode_; }
   void set_countrynamecode(const string& value) {
+    MarkDirty();
     countrynamecode_ = value;
     has_countrynamecode_ = true;
   }
   void clear_countrynamecode() {
+    MarkDirty();
     countrynamecode_.clear();
     has_countrynamecode_ = false;
   }
@@ -188,10 +192,12 @@ class XalLocality : public BasicElement<Type_XalLocality> {
     return has_localityname_;
   }
   void set_localityname(const string& value) {
+    MarkDirty();
     localityname_ = value;
     has_localityname_ = true;
   }
   void clear_localityname() {
+    MarkDirty();
     localityname_.clear();
     has_localityname_ = false;
   }
@@ -238,10 +244,12 @@ class XalPostalCode : public BasicElement<Type_XalPostalCode> {
     return has_postalcodenumber_;
   }
   void set_postalcodenumber(const string& value) {
+    MarkDirty();
     postalcodenumber_ = value;
     has_postalcodenumber_ = true;
   }
   void clear_postalcodenumber() {
+    MarkDirty();
     postalcodenumber_.clear();
     has_postalcodenumber_ = false;
   }
@@ -271,10 +279,12 @@ class XalSubAdministrativeArea :
     return has_subadministrativeareaname_;
   }
   void set_subadministrativeareaname(const string& value) {
+    MarkDirty();
     subadministrativeareaname_ = value;
     has_subadministrativeareaname_ = true;
   }
   void clear_subadministrativeareaname() {
+    MarkDirty();
     subadministrativeareaname_.clear();
     has_subadministrativeareaname_ = false;
   }
@@ -312,10 +322,12 @@ class XalThoroughfare : public BasicElement<Type_XalThoroughfare> {
     return has_thoroughfarename_;
   }
   void set_thoroughfarename(const string& value) {
+    MarkDirty();
     thoroughfarename_ = value;
     has_thoroughfarename_ = true;
   }
   void clear_thoroughfarename() {
+    MarkDirty();
     thoroughfarename_.clear();
     has_thoroughfarename_ = false;
   }
@@ -328,10 +340,12 @@ class XalThoroughfare : public BasicElement<Type_XalThoroughfare> {
     return has_thoroughfarenumber_;
   }
   void set_thoroughfarenumber(const string& value) {
+    MarkDirty();
     thoroughfarenumber_ = value;
     has_thoroughfarenumber_ = true;
   }
   void clear_thoroughfarenumber() {
+    MarkDirty();
     thoroughfarenumber_.clear();
     has_thoroughfarenumber_ = false;
   }
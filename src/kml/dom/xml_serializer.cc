@@ -29,6 +29,7 @@
 #include "kml/dom/xml_serializer.h"
 #include "kml/dom/kml_funcs.h"
 #include <cstring>
+#include <ostream>
 #include <stack>
 #include <sstream>
 #include "kml/base/attributes.h"
@@ -68,6 +69,12 @@ string SerializeRaw(const ElementPtr& root) {
   return xml;
 }
 
+void SerializeToOstream(const ElementPtr& root, bool pretty,
+                        std::ostream* xml) {
+  XmlSerializer<std::ostream>::Serialize(root, pretty ? "\n" : "",
+                                         pretty ? "  " : "", xml);
+}
+
 string GetElementName(const ElementPtr& element) {
   return element ?  Xsd::GetSchema()->ElementName(element->Type()) : string("");
 }
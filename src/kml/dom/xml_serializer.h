@@ -36,6 +36,7 @@
 #include "kml/base/attributes.h"
 #include "kml/base/vec3.h"
 #include "kml/dom/serializer.h"
+#include "kml/dom/source_slice.h"
 #include "kml/dom/xsd.h"
 #include "kml/dom.h"
 
@@ -70,13 +71,21 @@ class StringAdapter {
 template<class T>
 class XmlSerializer : public Serializer {
  public:
+  // If a source_buffer is given each Element below the root which is
+  // unchanged since it was parsed from that buffer is copied from it.  See
+  // set_source_buffer().  If root_xmlns is given it is added to the xmlns
+  // attributes of the root.  See set_root_xmlns().
   static void Serialize(const ElementPtr& root, const char* newline,
-                        const char* indent, T* output) {
+                        const char* indent, T* output,
+                        const SourceBufferPtr& source_buffer = NULL,
+                        const kmlbase::Attributes* root_xmlns = NULL) {
    if (!root || !newline || !indent || !output) {
      return;
    }
    boost::scoped_ptr<XmlSerializer> xml_ostream_serializer(
        new XmlSerializer(newline, indent, output));
+   xml_ostream_serializer->set_source_buffer(source_buffer);
+   xml_ostream_serializer->set_root_xmlns(root_xmlns);
    root->Serialize(*xml_ostream_serializer);
  }
 
@@ -89,11 +98,47 @@ class XmlSerializer : public Serializer {
     : newline_(newline),
       indent_(indent),
       output_(output),
-      start_pending_(false) {
+      start_pending_(false),
+      root_xmlns_(NULL) {
   }
 
   virtual ~XmlSerializer() {}
 
+  // Each complex Element saved with SaveElement() whose source range (see
+  // Element::get_source_range()) is in the given SourceBuffer is copied
+  // verbatim from the buffer rather than serialized.  Only the Elements
+  // changed since the parse (and their ancestors) are thus serialized.  The
+  // copy is indented as the first line of the Element but is otherwise as
+  // it appears in the source.  The default is no buffer.
+  void set_source_buffer(const SourceBufferPtr& source_buffer) {
+    source_buffer_ = source_buffer;
+  }
+
+  // The start tag of the root Element is written with the given xmlns
+  // attributes as if Element::MergeXmlns() had been called on the root, but
+  // without changing the root.  The keys are as those of
+  // Element::GetXmlns().  The Attributes are not owned and must outlive the
+  // serialization.  The default is NULL.
+  void set_root_xmlns(const kmlbase::Attributes* root_xmlns) {
+    root_xmlns_ = root_xmlns;
+  }
+
+  // Emit a complex element.
+  virtual void SaveElement(const ElementPtr& element) {
+    if (source_buffer_ && element) {
+      const SourceSlice& source_range = element->get_source_range();
+      if (source_range.get_source_buffer() == source_buffer_) {
+        EmitStart(false);
+        Indent();
+        output_->write(source_buffer_->get_data().data() +
+                       source_range.get_offset(), source_range.get_size());
+        Newline();
+        return;
+      }
+    }
+    Serializer::SaveElement(element);
+  }
+
   // Emit the start tag of the given element: <Placemark id="pm123">.
   virtual void BeginById(int type_id, const kmlbase::Attributes& attributes) {
     // Here we just record the element we're starting and its attributes if
@@ -101,11 +146,13 @@ class XmlSerializer : public Serializer {
     // it is known if this is a nil element or not.
     EmitStart(false);
     Indent();
-    tag_stack_.push(type_id);  // So we know what tag to use in End().
-    if (attributes.GetSize() > 0) {
+    if (root_xmlns_ && tag_stack_.empty()) {
+      SaveRootAttributes(attributes);
+    } else if (attributes.GetSize() > 0) {
       // TODO: Attributes::SerializeToBase would be handy.
       attributes.Serialize(&serialized_attributes_);
     }
+    tag_stack_.push(type_id);  // So we know what tag to use in End().
     start_pending_ = true;
   }
 
@@ -198,6 +245,21 @@ class XmlSerializer : public Serializer {
   }
 
  private:
+  // Saves the attributes of the root with those of root_xmlns_ added as
+  // Element::SerializeAttributes() saves the xmlns attributes.
+  void SaveRootAttributes(const kmlbase::Attributes& attributes) {
+    boost::scoped_ptr<kmlbase::Attributes> root_attributes(
+        attributes.Clone());
+    kmlbase::StringMapIterator iter = root_xmlns_->CreateIterator();
+    for (; !iter.AtEnd(); iter.Advance()) {
+      const string& prefix = iter.Data().first;
+      root_attributes->SetValue(
+          prefix == "xmlns" ? prefix : string("xmlns:") + prefix,
+          iter.Data().second);
+    }
+    root_attributes->Serialize(&serialized_attributes_);
+  }
+
   // Emit a line break.
   void Newline() {
     if (!newline_.empty()) {
@@ -239,6 +301,8 @@ class XmlSerializer : public Serializer {
   std::stack<int> tag_stack_;
   bool start_pending_;
   string serialized_attributes_;
+  SourceBufferPtr source_buffer_;
+  const kmlbase::Attributes* root_xmlns_;
 };
 
 }  // end namespace kmldom
@@ -33,6 +33,7 @@
 #include "kml/dom/kml_factory.h"
 #include "kml/dom/kml_funcs.h"
 #include "kml/dom/kmldom.h"
+#include "kml/dom/parser.h"
 #include "gtest/gtest.h"
 
 using kmlbase::ToString;
@@ -233,6 +234,20 @@ TEST_F(XmlSerializerTest, TestSerializeRawNilWithAttrs) {
                        SerializeRaw(placemark_));
 }
 
+// This tests that SerializeToOstream() matches the string serializers.
+TEST_F(XmlSerializerTest, TestSerializeToOstream) {
+  placemark_->set_name("hello");
+  std::ostringstream pretty;
+  SerializeToOstream(placemark_, true, &pretty);
+  ASSERT_EQ(SerializePretty(placemark_), pretty.str());
+  std::ostringstream raw;
+  SerializeToOstream(placemark_, false, &raw);
+  ASSERT_EQ(SerializeRaw(placemark_), raw.str());
+  SerializeToOstream(NULL, false, &raw);
+  SerializeToOstream(placemark_, false, NULL);
+  ASSERT_EQ(SerializeRaw(placemark_), raw.str());
+}
+
 TEST_F(XmlSerializerTest, TestSerializeUnknowns) {
   // Unrecognised elements:
   const string unknown1("<unknown>zzz<Foo/></unknown>");
@@ -307,4 +322,48 @@ TEST_F(XmlSerializerTest, TestGetElementName) {
             GetElementName(KmlFactory::GetFactory()->CreateGxTour()));
 }
 
+TEST_F(XmlSerializerTest, TestSourceBuffer) {
+  const string kKml(
+      "<Folder><name>f</name>"
+      "<Placemark><name>a</name><Point><coordinates>1.0,2</coordinates>"
+      "</Point></Placemark>"
+      "<Placemark><name>b</name></Placemark></Folder>");
+  string kml(kKml);
+  SourceBufferPtr source_buffer(new SourceBuffer(&kml));
+  ASSERT_TRUE(kml.empty());
+  ASSERT_EQ(kKml, source_buffer->get_data());
+  Parser parser;
+  FolderPtr folder = AsFolder(parser.ParseSource(source_buffer, NULL));
+  ASSERT_TRUE(folder);
+  const SourceSlice& source_range = folder->get_source_range();
+  ASSERT_EQ(static_cast<size_t>(0), source_range.get_offset());
+  ASSERT_EQ(kKml.size(), source_range.get_size());
+
+  // Each child of the root is copied from the source.
+  string xml;
+  StringAdapter string_adapter(&xml);
+  XmlSerializer<StringAdapter>::Serialize(folder, "", "", &string_adapter,
+                                          source_buffer);
+  ASSERT_EQ(kKml, xml);
+
+  // A change drops the source range of the Element and its ancestors only.
+  PlacemarkPtr placemark = AsPlacemark(folder->get_feature_array_at(0));
+  AsPoint(placemark->get_geometry())->set_extrude(true);
+  ASSERT_TRUE(placemark->get_source_range().empty());
+  ASSERT_TRUE(folder->get_source_range().empty());
+  ASSERT_FALSE(folder->get_feature_array_at(1)->get_source_range().empty());
+  ASSERT_FALSE(AsPoint(placemark->get_geometry())->get_coordinates()
+               ->get_source_range().empty());
+  xml.clear();
+  XmlSerializer<StringAdapter>::Serialize(folder, "", "", &string_adapter,
+                                          source_buffer);
+  ASSERT_EQ(string("<Folder><name>f</name>"
+                   "<Placemark><name>a</name><Point><extrude>1</extrude>"
+                   "<coordinates>1.0,2</coordinates></Point></Placemark>"
+                   "<Placemark><name>b</name></Placemark></Folder>"), xml);
+
+  // Without the buffer all is serialized.
+  ASSERT_EQ(string::npos, SerializeRaw(folder).find("1.0,2"));
+}
+
 }  // end namespace kmldom
@@ -26,6 +26,8 @@
 // This file implements the internal Xsd class specifically for KML 2.2.
 
 #include "kml/dom/xsd.h"
+#include <string.h>
+#include <algorithm>
 #include "kml/dom/kml22.h"
 #include "kml/dom/kml22.cc"
 
@@ -40,10 +42,49 @@ Xsd* Xsd::GetSchema() {
   return schema_;
 }
 
+// The schema is created during static initialization, before any thread of
+// the program can call GetSchema(), such that GetSchema() never races.
+static const Xsd* const kSchema = Xsd::GetSchema();
+
+// The order of Xsd::qualified_name_to_id.  Comparing the sizes first keeps
+// most comparisons from looking at the characters at all.
+static bool QualifiedNameLess(const XsdQualifiedName& a,
+                              const XsdQualifiedName& b) {
+  if (a.xmlns_id_ != b.xmlns_id_) {
+    return a.xmlns_id_ < b.xmlns_id_;
+  }
+  if (a.size_ != b.size_) {
+    return a.size_ < b.size_;
+  }
+  return memcmp(a.local_name_, b.local_name_, a.size_) < 0;
+}
+
 Xsd::Xsd() {
   for (int i = 0; i < Type_Invalid; ++i) {
     tag_to_id[kKml22Elements[i].element_name_] = i;
   }
+  // Each "prefix:name" is "name" in the namespace of the prefix, and anything
+  // with no prefix is in the KML namespace.
+  for (tag_id_map_t::const_iterator iter = tag_to_id.begin();
+       iter != tag_to_id.end(); ++iter) {
+    XsdQualifiedName qualified_name;
+    qualified_name.xmlns_id_ = kmlbase::XMLNS_KML22;
+    qualified_name.local_name_ = iter->first.c_str();
+    qualified_name.size_ = iter->first.size();
+    qualified_name.id_ = iter->second;
+    const size_t colon = iter->first.find(':');
+    if (colon != string::npos) {
+      if (!kmlbase::FindXmlnsIdByPrefix(iter->first.substr(0, colon),
+                                        &qualified_name.xmlns_id_)) {
+        continue;
+      }
+      qualified_name.local_name_ += colon + 1;
+      qualified_name.size_ -= colon + 1;
+    }
+    qualified_name_to_id.push_back(qualified_name);
+  }
+  std::sort(qualified_name_to_id.begin(), qualified_name_to_id.end(),
+            QualifiedNameLess);
 }
 
 int Xsd::ElementId(const string& element_name) const {
@@ -54,6 +95,22 @@ int Xsd::ElementId(const string& element_name) const {
   return iter->second;
 }
 
+int Xsd::ElementId(kmlbase::XmlnsId xmlns_id, const char* local_name,
+                   size_t size) const {
+  XsdQualifiedName key;
+  key.xmlns_id_ = xmlns_id;
+  key.local_name_ = local_name;
+  key.size_ = size;
+  key.id_ = Type_Unknown;
+  std::vector<XsdQualifiedName>::const_iterator iter =
+      std::lower_bound(qualified_name_to_id.begin(),
+                       qualified_name_to_id.end(), key, QualifiedNameLess);
+  if (iter == qualified_name_to_id.end() || QualifiedNameLess(key, *iter)) {
+    return Type_Unknown;
+  }
+  return iter->id_;
+}
+
 static bool is_valid(int id) {
   return id > Type_Unknown && id < Type_Invalid;
 }
@@ -32,7 +32,9 @@
 #define KML_XSD_XSD_H__
 
 #include <map>
+#include <vector>
 #include "kml/base/util.h"
+#include "kml/base/xml_namespaces.h"
 
 namespace kmldom {
 
@@ -76,15 +78,31 @@ struct XsdSimpleTypeEnum {
 
 typedef std::map<string,int> tag_id_map_t;
 
+// This is an element name split into its namespace and the local name within
+// that namespace.  For example "gx:Track" is "Track" in XMLNS_GX22 and
+// "Placemark" is "Placemark" in XMLNS_KML22.  The local name is not owned.
+struct XsdQualifiedName {
+  kmlbase::XmlnsId xmlns_id_;
+  const char* local_name_;
+  size_t size_;
+  int id_;
+};
+
 // This a 0.1 C++ version of the information in the KML XSD.
 // At present it is just the list of elements.  Each element has a name,
-// libkml-specific id, and type info (simple vs complex).
+// libkml-specific id, and type info (simple vs complex).  The schema is
+// created during static initialization and is never changed hence it may be
+// used from any thread.
 class Xsd {
  public:
   static Xsd* GetSchema();
 
   // Essentially the API to the global <element>'s
   int ElementId(const string& name) const;
+  // As ElementId() for the given local name within the given namespace.  The
+  // local name is the size chars at local_name which need not be terminated.
+  int ElementId(kmlbase::XmlnsId xmlns_id, const char* local_name,
+                size_t size) const;
   XsdType ElementType(int id) const;
   string ElementName(int id) const;
 
@@ -99,6 +117,8 @@ class Xsd {
 
   tag_id_map_t tag_to_id;
   std::map<int,XsdElement> id_to_string;
+  // Sorted by namespace, then local name size, then local name.
+  std::vector<XsdQualifiedName> qualified_name_to_id;
 };
 
 }  // end namespace kmldom
@@ -115,6 +115,29 @@ TEST_F(XsdTest, TestUglyElement) {
   ASSERT_EQ(string(""), Xsd::GetSchema()->ElementName(0));
 }
 
+// Verify ElementId() for a local name within a namespace.
+TEST_F(XsdTest, TestQualifiedElement) {
+  const Xsd* xsd = Xsd::GetSchema();
+  ASSERT_EQ(static_cast<int>(Type_Placemark),
+            xsd->ElementId(kmlbase::XMLNS_KML22, "Placemark", 9));
+  ASSERT_EQ(static_cast<int>(Type_GxTrack),
+            xsd->ElementId(kmlbase::XMLNS_GX22, "Track", 5));
+  ASSERT_EQ(static_cast<int>(Type_AtomFeed),
+            xsd->ElementId(kmlbase::XMLNS_ATOM, "feed", 4));
+  // The local name need not be terminated.
+  ASSERT_EQ(static_cast<int>(Type_name),
+            xsd->ElementId(kmlbase::XMLNS_KML22, "namexyz", 4));
+  // A name known in one namespace is not known in another.
+  ASSERT_EQ(static_cast<int>(Type_Unknown),
+            xsd->ElementId(kmlbase::XMLNS_KML22, "Track", 5));
+  ASSERT_EQ(static_cast<int>(Type_Unknown),
+            xsd->ElementId(kmlbase::XMLNS_GX22, "Placemark", 9));
+  ASSERT_EQ(static_cast<int>(Type_Unknown),
+            xsd->ElementId(kmlbase::XMLNS_NONE, "name", 4));
+  ASSERT_EQ(static_cast<int>(Type_Unknown),
+            xsd->ElementId(kmlbase::XMLNS_KML22, "", 0));
+}
+
 // Verify that a known enum val has the proper id and vice versa.
 // Tests the EnumId() and EnumValue() for known good values.
 TEST_F(XsdTest, TestGoodEnum) {
@@ -30,6 +30,7 @@
 #define KML_ENGINE_H__
 
 #include "kml/engine/bbox.h"
+#include "kml/engine/bbox_parse_filter.h"
 #include "kml/engine/clone.h"
 #include "kml/engine/engine_types.h"
 #include "kml/engine/entity_mapper.h"
@@ -42,7 +43,10 @@
 #include "kml/engine/href.h"
 #include "kml/engine/id_mapper.h"
 #include "kml/engine/kml_cache.h"
+#include "kml/engine/kml_diff.h"
 #include "kml/engine/kml_file.h"
+#include "kml/engine/kml_file_loader.h"
+#include "kml/engine/kml_snapshot.h"
 #include "kml/engine/kml_stream.h"
 #include "kml/engine/kml_uri.h"
 #include "kml/engine/kmz_file.h"
@@ -51,10 +55,12 @@
 #include "kml/engine/merge.h"
 #include "kml/engine/object_id_parser_observer.h"
 #include "kml/engine/shared_style_parser_observer.h"
+#include "kml/engine/style_deduplicator.h"
 #include "kml/engine/style_inliner.h"
 #include "kml/engine/style_merger.h"
 #include "kml/engine/style_resolver.h"
 #include "kml/engine/style_splitter.h"
+#include "kml/engine/time_index.h"
 #include "kml/engine/update.h"
 
 #endif  // KML_ENGINE_H__
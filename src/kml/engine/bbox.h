@@ -99,6 +99,13 @@ class Bbox {
     return north >= north_ && south <= south_ && east >= east_ && west <= west_;
   }
 
+  // This returns true if this Bbox and the given Bbox have any point in
+  // common.
+  bool IntersectsBbox(const Bbox& b) const {
+    return north_ >= b.get_south() && south_ <= b.get_north() &&
+           east_ >= b.get_west() && west_ <= b.get_east();
+  }
+
   // This returns true if the bbox contains the given latitude,longitude.
   bool Contains(double latitude, double longitude) const {
     return north_ >= latitude && south_ <= latitude &&
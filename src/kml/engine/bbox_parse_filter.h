@@ -0,0 +1,61 @@
+// Copyright 2008, Google Inc. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//  3. Neither the name of Google Inc. nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// This file contains the declaration of the BboxParseFilter class.
+
+#ifndef KML_ENGINE_BBOX_PARSE_FILTER_H__
+#define KML_ENGINE_BBOX_PARSE_FILTER_H__
+
+#include "kml/dom/parse_filter.h"
+#include "kml/engine/bbox.h"
+
+namespace kmlengine {
+
+// A BboxParseFilter is a kmldom::ParseFilter which also drops each Feature
+// lying wholly outside the given Bbox as the Feature ends.  The location of
+// a Feature is as found by GetFeatureBounds().  Containers and Features
+// without a location, such as a NetworkLink or a Placemark with no Geometry,
+// are kept.  The elements to skip may be set as for any ParseFilter.
+//
+// Intended usage:
+//   BboxParseFilter parse_filter(Bbox(north, south, east, west));
+//   parse_filter.SkipElement(kmldom::Type_description);
+//   KmlFileOptions options;
+//   options.parse_filter = &parse_filter;
+//   KmlFilePtr kml_file = KmlFile::CreateFromParse(kml, options, &errors);
+class BboxParseFilter : public kmldom::ParseFilter {
+ public:
+  explicit BboxParseFilter(const Bbox& bbox)
+    : bbox_(bbox) {}
+
+  virtual bool KeepsFeature(const kmldom::FeaturePtr& feature) const;
+
+ private:
+  const Bbox bbox_;
+};
+
+}  // end namespace kmlengine
+
+#endif  // KML_ENGINE_BBOX_PARSE_FILTER_H__
@@ -0,0 +1,95 @@
+// Copyright 2008, Google Inc. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//  3. Neither the name of Google Inc. nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// This file contains the unit tests for the BboxParseFilter class.
+
+#include "kml/engine/bbox_parse_filter.h"
+#include "boost/scoped_ptr.hpp"
+#include "kml/dom.h"
+#include "gtest/gtest.h"
+
+using kmldom::DocumentPtr;
+using kmldom::KmlFactory;
+using kmldom::PlacemarkPtr;
+
+namespace kmlengine {
+
+static const char kKml[] =
+    "<Document>"
+    "<Placemark id=\"in\"><Point><coordinates>1,1</coordinates></Point>"
+    "</Placemark>"
+    "<Placemark id=\"out\"><Point><coordinates>50,50</coordinates></Point>"
+    "</Placemark>"
+    "<Placemark id=\"across\"><LineString>"
+    "<coordinates>-20,0 20,0</coordinates></LineString></Placemark>"
+    "<Placemark id=\"nowhere\"><name>no geometry</name></Placemark>"
+    "<Folder id=\"f\"><Placemark id=\"out2\">"
+    "<Point><coordinates>-50,-50</coordinates></Point></Placemark>"
+    "</Folder>"
+    "</Document>";
+
+class BboxParseFilterTest : public testing::Test {
+ protected:
+  virtual void SetUp() {
+    bbox_parse_filter_.reset(new BboxParseFilter(Bbox(10, -10, 10, -10)));
+  }
+
+  boost::scoped_ptr<BboxParseFilter> bbox_parse_filter_;
+};
+
+TEST_F(BboxParseFilterTest, TestKeepsFeature) {
+  KmlFactory* factory = KmlFactory::GetFactory();
+  PlacemarkPtr placemark = factory->CreatePlacemark();
+  kmldom::PointPtr point = factory->CreatePoint();
+  point->set_coordinates(factory->CreateCoordinates());
+  point->get_coordinates()->add_latlng(1, 1);
+  placemark->set_geometry(point);
+  ASSERT_TRUE(bbox_parse_filter_->KeepsFeature(placemark));
+  point->get_coordinates()->Clear();
+  point->get_coordinates()->add_latlng(20, 1);
+  ASSERT_FALSE(bbox_parse_filter_->KeepsFeature(placemark));
+  // A Feature without a location is kept.
+  ASSERT_TRUE(bbox_parse_filter_->KeepsFeature(factory->CreatePlacemark()));
+  ASSERT_TRUE(bbox_parse_filter_->KeepsFeature(factory->CreateNetworkLink()));
+  // A Container is always kept.
+  ASSERT_TRUE(bbox_parse_filter_->KeepsFeature(factory->CreateFolder()));
+}
+
+TEST_F(BboxParseFilterTest, TestParse) {
+  kmldom::Parser parser;
+  parser.set_parse_filter(bbox_parse_filter_.get());
+  DocumentPtr document = kmldom::AsDocument(parser.Parse(kKml, NULL));
+  ASSERT_TRUE(document);
+  ASSERT_EQ(static_cast<size_t>(4), document->get_feature_array_size());
+  ASSERT_EQ(string("in"), document->get_feature_array_at(0)->get_id());
+  ASSERT_EQ(string("across"), document->get_feature_array_at(1)->get_id());
+  ASSERT_EQ(string("nowhere"), document->get_feature_array_at(2)->get_id());
+  kmldom::FolderPtr folder =
+      kmldom::AsFolder(document->get_feature_array_at(3));
+  ASSERT_EQ(string("f"), folder->get_id());
+  ASSERT_EQ(static_cast<size_t>(0), folder->get_feature_array_size());
+}
+
+}  // end namespace kmlengine
@@ -225,4 +225,17 @@ TEST_F(BboxTest, TestContainedByBox) {
   ASSERT_FALSE(b.ContainedByBbox(r));
 }
 
+TEST_F(BboxTest, TestIntersectsBbox) {
+  Bbox a(10, 0, 10, 0);
+  ASSERT_TRUE(a.IntersectsBbox(a));
+  ASSERT_TRUE(a.IntersectsBbox(Bbox(5, 4, 5, 4)));
+  ASSERT_TRUE(a.IntersectsBbox(Bbox(20, 5, 20, 5)));
+  ASSERT_TRUE(a.IntersectsBbox(Bbox(20, 10, 20, 10)));  // Shares a corner.
+  ASSERT_TRUE(Bbox(5, 4, 5, 4).IntersectsBbox(a));
+  ASSERT_FALSE(a.IntersectsBbox(Bbox(20, 11, 5, 4)));
+  ASSERT_FALSE(a.IntersectsBbox(Bbox(5, 4, -1, -5)));
+  // An empty Bbox intersects nothing.
+  ASSERT_FALSE(a.IntersectsBbox(Bbox()));
+}
+
 }  // end namespace kmlengine
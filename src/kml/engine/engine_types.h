@@ -28,8 +28,8 @@
 #ifndef KML_ENGINE_ENGINE_TYPES_H__
 #define KML_ENGINE_ENGINE_TYPES_H__
 
-#include <map>
 #include <vector>
+#include "kml/base/string_hash_map.h"
 #include "kml/dom.h"
 
 namespace kmlengine {
@@ -38,16 +38,17 @@ namespace kmlengine {
 typedef std::vector<kmldom::ElementPtr> ElementVector;
 
 // The SharedStyleParserObserver class uses this data structure to map the XML
-// id to a kmldom::StyleSelectorPtr.
-typedef std::map<string, kmldom::StyleSelectorPtr> SharedStyleMap;
+// id to a kmldom::StyleSelectorPtr.  Note that the iteration order of these
+// hash maps is unspecified.
+typedef kmlbase::StringHashMap<kmldom::StyleSelectorPtr> SharedStyleMap;
 
 // The ObjectIdParserObserver class uses this data structure to map the XML
 // id to a kmldom::ObjectPtr.
-typedef std::map<string, kmldom::ObjectPtr> ObjectIdMap;
+typedef kmlbase::StringHashMap<kmldom::ObjectPtr> ObjectIdMap;
 
 // The SchemaParserObserver class uses this data structure to map the <Schema>
 // name= to a kmldom::SchemaPtr.
-typedef std::map<string, kmldom::SchemaPtr> SchemaNameMap;
+typedef kmlbase::StringHashMap<kmldom::SchemaPtr> SchemaNameMap;
 
 }  // end namespace kmlengine
 
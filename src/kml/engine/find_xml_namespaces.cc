@@ -48,6 +48,12 @@ class XmlNamespaceFinder : public Serializer {
   virtual void SaveElement(const ElementPtr& element) {
     xmlns_id_set_->insert(element->get_xmlns());
 
+    // An Element unchanged since it was parsed is serialized as a copy of
+    // its source which already declares the namespaces used within it.
+    if (!element->get_source_range().empty()) {
+      return;
+    }
+
     // Call Serializer to recurse.
     Serializer::SaveElement(element);
   }
@@ -74,16 +80,23 @@ void FindXmlNamespaces(const ElementPtr& element,
   }
 }
 
-void FindAndInsertXmlNamespaces(ElementPtr element) {
-  if (element) {
-    Attributes xmlns;
-    FindXmlNamespaces(element, &xmlns);
+void FindRootXmlNamespaces(const ElementPtr& element,
+                           Attributes* xmlns_attributes) {
+  if (element && xmlns_attributes) {
+    FindXmlNamespaces(element, xmlns_attributes);
     // We (kmlengine in libkml) never prefix KML 2.2 elements.
     string kml_namespace;
-    if (xmlns.CutValue("kml", &kml_namespace)) {
+    if (xmlns_attributes->CutValue("kml", &kml_namespace)) {
       // This makes KML the default namespace
-      xmlns.SetValue("xmlns", kml_namespace);
+      xmlns_attributes->SetValue("xmlns", kml_namespace);
     }
+  }
+}
+
+void FindAndInsertXmlNamespaces(ElementPtr element) {
+  if (element) {
+    Attributes xmlns;
+    FindRootXmlNamespaces(element, &xmlns);
     element->MergeXmlns(xmlns);
   }
 }
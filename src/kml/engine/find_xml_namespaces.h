@@ -44,6 +44,12 @@ namespace kmlengine {
 void FindXmlNamespaces(const kmldom::ElementPtr& element,
                        kmlbase::Attributes* xmlns_attributes);
 
+// This calls FindXmlNamespaces() and saves the resulting xmlns
+// prefix/namespace pairs as FindAndInsertXmlNamespaces() inserts them, but
+// without changing the element.
+void FindRootXmlNamespaces(const kmldom::ElementPtr& element,
+                           kmlbase::Attributes* xmlns_attributes);
+
 // This calls FindXmlNamespaces() and inserts the resulting xmlns
 // prefix/namespace pairs.  The KML namespace is special cased as the default
 // namespace (xmlns="...") if any KML elements are present.  All other
@@ -117,6 +117,23 @@ TEST(FindXmlNamepacesTest, TestBasicFindAndInsertXmlNamespaces) {
   ASSERT_EQ(static_cast<size_t>(1), xmlns_attributes.GetSize());
 }
 
+TEST(FindXmlNamepacesTest, TestFindRootXmlNamespaces) {
+  KmlFactory* factory = KmlFactory::GetFactory();
+  kmldom::KmlPtr kml = factory->CreateKml();
+  kmldom::DocumentPtr document = factory->CreateDocument();
+  document->add_feature(factory->CreateGxTour());
+  kml->set_feature(document);
+  Attributes xmlns_attributes;
+  FindRootXmlNamespaces(kml, &xmlns_attributes);
+  ASSERT_EQ(static_cast<size_t>(2), xmlns_attributes.GetSize());
+  string xml_namespace;
+  ASSERT_TRUE(xmlns_attributes.GetValue("xmlns", &xml_namespace));
+  ASSERT_EQ(string("http://www.opengis.net/kml/2.2"), xml_namespace);
+  ASSERT_TRUE(xmlns_attributes.GetValue("gx", &xml_namespace));
+  // The element itself is unchanged.
+  ASSERT_FALSE(kml->GetXmlns());
+}
+
 // TODO: every KML 2.2 element should do set_xmlns(XMLNS_KML22) which should
 // really be an arg to the Element ctor...
 #if 0
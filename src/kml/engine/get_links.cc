@@ -24,24 +24,179 @@
 // ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "kml/engine/get_links.h"
-#include "kml/dom/parser.h"
-#include "kml/dom/parser_observer.h"
+#include "kml/base/expat_parser.h"
+#include "kml/base/zip_file.h"
+#include "kml/dom/xsd.h"
 // TODO: deprecate use of kmlengine::Href. kml_url.h and/or kmlbase::UriParser
 // should be used instead.
 #include "kml/engine/href.h"
 
-using kmldom::Parser;
+using kmldom::Xsd;
 
 namespace kmlengine {
 
+// As in KmlHandler, deeper nesting is an error.
+static const unsigned int kMaxNestingDepth = 100;
+
+// The size of each piece of a ZIP archive entry inflated by
+// GetLinksFromZipEntry.
+static const size_t kZipEntryBufferSize = 64 * 1024;
+
+static bool IsLinkType(int type_id) {
+  return type_id == kmldom::Type_href || type_id == kmldom::Type_targetHref ||
+      type_id == kmldom::Type_styleUrl;
+}
+
+// Sets value to that of the attribute of the given name in the name-value
+// pairs from expat.  Returns false if there is no such attribute.
+static bool FindAttribute(const kmlbase::StringVector& atts,
+                          const char* name, string* value) {
+  for (size_t i = 0; i + 1 < atts.size(); i += 2) {
+    if (atts[i] == name) {
+      *value = atts[i + 1];
+      return true;
+    }
+  }
+  return false;
+}
+
+LinkScanner::LinkScanner(href_vector_t* href_vector)
+  : href_vector_(href_vector),
+    has_schema_url_(false),
+    has_root_(false),
+    skip_depth_(0),
+    in_description_(0),
+    nesting_depth_(0) {
+}
+
+void LinkScanner::StartElement(const string& name,
+                               const kmlbase::StringVector& atts) {
+  if (++nesting_depth_ > kMaxNestingDepth) {
+    XML_StopParser(get_parser(), XML_TRUE);
+    return;
+  }
+  if (in_description_ > 0 && name == "description") {
+    ++in_description_;
+  }
+  if (skip_depth_ > 0) {
+    ++skip_depth_;
+    return;
+  }
+  string old_schema_parent;
+  if (name == "Schema" && FindAttribute(atts, "parent", &old_schema_parent)) {
+    FindAttribute(atts, "name", &old_schema_name_);
+  }
+  int type_id = Xsd::GetSchema()->ElementId(name);
+  if (!old_schema_name_.empty() && name == old_schema_name_) {
+    type_id = kmldom::Type_Placemark;
+  }
+  const kmldom::XsdType xsd_type = Xsd::GetSchema()->ElementType(type_id);
+  if (xsd_type != kmldom::XSD_COMPLEX_TYPE &&
+      xsd_type != kmldom::XSD_SIMPLE_TYPE) {
+    if (stack_.empty()) {
+      // The root element is not known.
+      XML_StopParser(get_parser(), XML_TRUE);
+      return;
+    }
+    ++skip_depth_;
+    return;
+  }
+  stack_.push_back(type_id);
+  has_root_ = true;
+  if (IsLinkType(type_id)) {
+    char_data_.push_back(string());
+  } else if (type_id == kmldom::Type_SchemaData) {
+    has_schema_url_ = FindAttribute(atts, "schemaUrl", &schema_url_);
+  } else if (type_id == kmldom::Type_description) {
+    // Markup inside <description> is its character data.
+    ++skip_depth_;
+    ++in_description_;
+  }
+}
+
+void LinkScanner::EndElement(const string& name) {
+  --nesting_depth_;
+  if (name == "description" && in_description_ > 0 &&
+      --in_description_ == 0) {
+    --skip_depth_;
+  }
+  if (skip_depth_ > 0) {
+    --skip_depth_;
+    return;
+  }
+  if (stack_.empty()) {
+    return;
+  }
+  const int type_id = stack_.back();
+  stack_.pop_back();
+  string char_data;
+  if (IsLinkType(type_id)) {
+    char_data.swap(char_data_.back());
+    char_data_.pop_back();
+  }
+  // The root is not the child of anything.
+  if (stack_.empty()) {
+    return;
+  }
+  switch (type_id) {
+    default:
+      break;
+    case kmldom::Type_href:
+    case kmldom::Type_styleUrl:
+      href_vector_->push_back(char_data);
+      break;
+    case kmldom::Type_targetHref:
+      if (stack_.back() == kmldom::Type_Alias) {
+        href_vector_->push_back(char_data);
+      }
+      break;
+    case kmldom::Type_SchemaData:
+      if (has_schema_url_) {
+        href_vector_->push_back(schema_url_);
+      }
+      break;
+  }
+}
+
+void LinkScanner::CharData(const string& s) {
+  if (skip_depth_ == 0 && !stack_.empty() && IsLinkType(stack_.back())) {
+    char_data_.back().append(s);
+  }
+}
+
 bool GetLinks(const string& kml, href_vector_t* href_vector) {
   if (!href_vector) {
     return false;
   }
-  GetLinksParserObserver get_links(href_vector);
-  Parser parser;
-  parser.AddObserver(&get_links);
-  return parser.Parse(kml, NULL) != NULL;
+  LinkScanner link_scanner(href_vector);
+  return kmlbase::ExpatParser::ParseString(kml, &link_scanner, NULL, false) &&
+      link_scanner.has_root();
+}
+
+bool GetLinksFromZipEntry(kmlbase::ZipEntryReader* zip_entry_reader,
+                          href_vector_t* href_vector) {
+  if (!zip_entry_reader || !href_vector) {
+    return false;
+  }
+  LinkScanner link_scanner(href_vector);
+  kmlbase::ExpatParser parser(&link_scanner, false);
+  for (;;) {
+    void* buf = parser.GetInternalBuffer(kZipEntryBufferSize);
+    if (!buf) {
+      return false;
+    }
+    int nread = zip_entry_reader->Read(buf, kZipEntryBufferSize);
+    if (nread < 0) {
+      return false;
+    }
+    if (!parser.ParseInternalBuffer(static_cast<size_t>(nread), NULL,
+                                    nread == 0)) {
+      return false;
+    }
+    if (nread == 0) {
+      return link_scanner.has_root();
+    }
+  }
 }
 
 bool GetRelativeLinks(const string& kml, href_vector_t* href_vector) {
@@ -23,16 +23,22 @@
 // OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
 // ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
-// This file contains the declaration of the GetLinks() function and the
-// definition of the GetLinksParserObserver.
+// This file contains the declaration of the GetLinks() function, the
+// definition of the GetLinksParserObserver and the declaration of the
+// LinkScanner.
 
 #ifndef KML_ENGINE_GET_LINKS_H__
 #define KML_ENGINE_GET_LINKS_H__
 
 #include <vector>
+#include "kml/base/expat_handler.h"
 #include "kml/dom.h"
 #include "kml/dom/parser_observer.h"
 
+namespace kmlbase {
+class ZipEntryReader;
+}
+
 namespace kmlengine {
 
 typedef std::vector<string> href_vector_t;
@@ -79,11 +85,57 @@ class GetLinksParserObserver : public kmldom::ParserObserver {
   href_vector_t* href_vector_;
 };
 
+// This ExpatHandler saves to the passed vector the same links in the same
+// order as GetLinksParserObserver but straight from the XML events of the
+// parse.  No Element is created: only the type of each open KML element and
+// the character data of each open href, targetHref and styleUrl is kept.
+// Unknown elements and the content of <description> are skipped as the
+// KmlHandler skips them.  The parse is stopped if the root element is not
+// KML.  GetLinks() and GetLinksFromZipEntry() are the usual way to use this.
+class LinkScanner : public kmlbase::ExpatHandler {
+ public:
+  LinkScanner(href_vector_t* href_vector);
+
+  virtual void StartElement(const string& name,
+                            const kmlbase::StringVector& atts);
+  virtual void EndElement(const string& name);
+  virtual void CharData(const string& s);
+
+  // Returns true once the root element is known to be KML.
+  bool has_root() const {
+    return has_root_;
+  }
+
+ private:
+  href_vector_t* href_vector_;
+  // The type of each open KML element.
+  std::vector<int> stack_;
+  // The character data of each open href, targetHref or styleUrl.
+  std::vector<string> char_data_;
+  // The schemaUrl of the open <SchemaData>, if it has one.
+  string schema_url_;
+  bool has_schema_url_;
+  bool has_root_;
+  int skip_depth_;
+  int in_description_;
+  unsigned int nesting_depth_;
+  // The name of the Placemark substitute of old <Schema parent> usage.
+  string old_schema_name_;
+};
+
 // This function saves to the vector all href's found in the given KML.
 // This returns false if the vector is NULL or on any parse error. This does
-// not search the balloon text for links.
+// not search the balloon text for links.  The KML is scanned by a LinkScanner
+// and no DOM is built.
 bool GetLinks(const string& kml, href_vector_t* href_vector);
 
+// As GetLinks, but the KML is inflated a piece at a time from the given
+// ZipEntryReader (see KmzFile::OpenKml()) so the whole KML is never in
+// memory.  This returns false if either argument is NULL or on any read or
+// parse error.
+bool GetLinksFromZipEntry(kmlbase::ZipEntryReader* zip_entry_reader,
+                          href_vector_t* href_vector);
+
 // As GetLinks, but considers only those href's that are relative (local) to
 // the given KML. This does not search the balloon text for links.
 bool GetRelativeLinks(const string& kml, href_vector_t* href_vector);
@@ -26,7 +26,11 @@
 // This file contains the unit tests for the GetLinks function.
 
 #include "kml/engine/get_links.h"
+#include "boost/scoped_ptr.hpp"
 #include "kml/base/file.h"
+#include "kml/base/zip_file.h"
+#include "kml/dom/parser.h"
+#include "kml/engine/kmz_file.h"
 #include "gtest/gtest.h"
 
 // The following define is a convenience for testing inside Google.
@@ -106,4 +110,102 @@ TEST_F(GetLinksTest, TestGetRelativeLinks) {
   ASSERT_EQ(static_cast<size_t>(7), href_vector.size());
 }
 
+// Returns the links GetLinksParserObserver finds in a full parse of the KML
+// and whether the parse succeeded.
+static bool GetLinksWithParser(const string& kml, href_vector_t* href_vector) {
+  GetLinksParserObserver get_links(href_vector);
+  kmldom::Parser parser;
+  parser.AddObserver(&get_links);
+  return parser.Parse(kml, NULL) != NULL;
+}
+
+// Verify that the LinkScanner finds just what the ParserObserver on a full
+// parse finds.
+TEST_F(GetLinksTest, TestMatchesParserObserver) {
+  const char* kKml[] = {
+    "",
+    "<kml/>",
+    "<NoSuchElement><href>a</href></NoSuchElement>",
+    "<Placemark><styleUrl>#s</styleUrl>",
+    "<Placemark><styleUrl>&amp;a&lt;<![CDATA[b]]></styleUrl></Placemark>",
+    "<href>root.kml</href>",
+    // Nothing in unknown elements or the markup of a description counts.
+    "<Document><unknown><href>u</href><Link><href>v</href></Link></unknown>"
+    "<Placemark><description><a href='x'>x</a><href>d</href>"
+    "<description><href>dd</href></description><href>ddd</href>"
+    "</description><styleUrl>#after</styleUrl></Placemark></Document>",
+    // Only an Alias has a targetHref link.
+    "<Document><NetworkLinkControl/><Update><targetHref>t</targetHref>"
+    "</Update><Model><ResourceMap><Alias><targetHref>a.jpg</targetHref>"
+    "<sourceHref>b.jpg</sourceHref></Alias></ResourceMap></Model></Document>",
+    // A SchemaData link comes after those of its children.
+    "<Placemark><ExtendedData><SchemaData schemaUrl='#s'>"
+    "<SimpleData name='n'>v</SimpleData></SchemaData>"
+    "<SchemaData><SimpleData name='n'>w</SimpleData></SchemaData>"
+    "</ExtendedData><Model><Link><href>m.dae</href></Link></Model>"
+    "</Placemark>",
+    // Old <Schema parent> usage makes the named element a Placemark.
+    "<Document><Schema parent='Placemark' name='S_park'>"
+    "<SimpleField type='string' name='P'/></Schema>"
+    "<S_park><styleUrl>#park</styleUrl><P>p</P></S_park></Document>",
+    // A link may hold whitespace.
+    "<IconStyle><Icon><href>\n  icon.png \n</href></Icon></IconStyle>",
+    "<Document><Placemark><styleUrl>#s</styleUrl></Document></Placemark>"
+  };
+  for (size_t i = 0; i < sizeof(kKml)/sizeof(kKml[0]); ++i) {
+    href_vector_t expected;
+    const bool expected_status = GetLinksWithParser(kKml[i], &expected);
+    href_vector_t href_vector;
+    ASSERT_EQ(expected_status, GetLinks(kKml[i], &href_vector)) << kKml[i];
+    ASSERT_TRUE(expected == href_vector) << kKml[i];
+  }
+
+  // As above for deeply nested KML.
+  string deep;
+  for (int i = 0; i < 101; ++i) {
+    deep.append("<Folder>");
+  }
+  href_vector_t href_vector;
+  ASSERT_FALSE(GetLinks(deep + "<styleUrl>#s</styleUrl>", &href_vector));
+  ASSERT_FALSE(GetLinksWithParser(deep + "<styleUrl>#s</styleUrl>",
+                                  &href_vector));
+
+  // As above for some real files.
+  const char* kFiles[] = {
+    "/links/alllinks.kml", "/kmz/camels.kml", "/kmz/doc.kml",
+    "/kmz/outside.kml"
+  };
+  for (size_t i = 0; i < sizeof(kFiles)/sizeof(kFiles[0]); ++i) {
+    string kml;
+    ASSERT_TRUE(kmlbase::File::ReadFileToString(string(DATADIR) + kFiles[i],
+                                                &kml));
+    href_vector_t expected;
+    ASSERT_TRUE(GetLinksWithParser(kml, &expected));
+    href_vector_t href_vector;
+    ASSERT_TRUE(GetLinks(kml, &href_vector));
+    ASSERT_TRUE(expected == href_vector) << kFiles[i];
+  }
+}
+
+TEST_F(GetLinksTest, TestGetLinksFromZipEntry) {
+  const string kKmz = string(DATADIR) + "/kmz/zermatt-photo.kmz";
+  boost::scoped_ptr<KmzFile> kmz_file(KmzFile::OpenFromFile(kKmz.c_str()));
+  ASSERT_TRUE(kmz_file.get());
+  string kml;
+  ASSERT_TRUE(kmz_file->ReadKml(&kml));
+  href_vector_t expected;
+  ASSERT_TRUE(GetLinks(kml, &expected));
+  ASSERT_FALSE(expected.empty());
+
+  boost::scoped_ptr<kmlbase::ZipEntryReader> reader(kmz_file->OpenKml(NULL));
+  ASSERT_TRUE(reader.get());
+  href_vector_t href_vector;
+  ASSERT_TRUE(GetLinksFromZipEntry(reader.get(), &href_vector));
+  ASSERT_TRUE(expected == href_vector);
+
+  ASSERT_FALSE(GetLinksFromZipEntry(NULL, &href_vector));
+  reader.reset(kmz_file->OpenKml(NULL));
+  ASSERT_FALSE(GetLinksFromZipEntry(reader.get(), NULL));
+}
+
 }  // end namespace kmlengine
@@ -42,16 +42,16 @@ namespace kmlengine {
 void IdMapper::SaveElement(const ElementPtr& element) {
   if (ObjectPtr object = AsObject(element)) {
     if (object->has_id()) {
-      const string& id = object->get_id();
-      ObjectIdMap::const_iterator iter = object_id_map_->find(id);
-      if (iter != object_id_map_->end()) {
+      const size_t size = object_id_map_->size();
+      ObjectPtr& mapped = (*object_id_map_)[object->get_id()];
+      if (object_id_map_->size() == size) {
         // Save this as a dupe if a vector was supplied.
         if (dup_id_vector_) {
-          dup_id_vector_->push_back(iter->second);
+          dup_id_vector_->push_back(mapped);
         }
       }
       // This matches the semantics of ObjectIdParserObserver.
-      (*object_id_map_)[id] = object;  // "Last one wins"
+      mapped = object;  // "Last one wins"
     }
   }
   // Call Serializer to recurse.
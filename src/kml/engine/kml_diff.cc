@@ -0,0 +1,580 @@
+// Copyright 2008, Google Inc. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//  3. Neither the name of Google Inc. nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// This file contains the implementation of the DiffKmlFiles() function and
+// its internal helper classes.
+
+#include "kml/engine/kml_diff.h"
+#include <map>
+#include <set>
+#include <vector>
+#include "kml/base/attributes.h"
+#include "kml/base/color32.h"
+#include "kml/base/string_hash_map.h"
+#include "kml/base/vec3.h"
+#include "kml/dom/serializer.h"
+#include "kml/engine/clone.h"
+#include "kml/engine/engine_types.h"
+#include "kml/engine/find.h"
+#include "kml/engine/merge.h"
+
+using kmlbase::Attributes;
+using kmlbase::HashString;
+using kmldom::AsContainer;
+using kmldom::AsFeature;
+using kmldom::AsKml;
+using kmldom::AsObject;
+using kmldom::ChangePtr;
+using kmldom::ContainerPtr;
+using kmldom::CreatePtr;
+using kmldom::DeletePtr;
+using kmldom::Element;
+using kmldom::ElementPtr;
+using kmldom::FeaturePtr;
+using kmldom::KmlDomType;
+using kmldom::KmlFactory;
+using kmldom::KmlPtr;
+using kmldom::ObjectPtr;
+using kmldom::Serializer;
+using kmldom::UpdatePtr;
+
+namespace kmlengine {
+
+// Combine the value into the running hash.
+static size_t CombineHash(size_t hash, size_t value) {
+  return hash ^ (value + 0x9e3779b9 + (hash << 6) + (hash >> 2));
+}
+
+class ElementHasher;
+
+// This Serializer-specialization computes the hash of one element from its
+// type, attributes, simple element children and character data and the hash
+// of each of its complex children as computed by the ElementHasher.
+class HashSerializer : public Serializer {
+ public:
+  HashSerializer(ElementHasher* element_hasher, bool skip_features)
+    : element_hasher_(element_hasher),
+      skip_features_(skip_features),
+      hash_(0) {
+  }
+
+  virtual ~HashSerializer() {}
+
+  virtual void BeginById(int type_id, const Attributes& attributes) {
+    hash_ = CombineHash(hash_, type_id);
+    if (attributes.GetSize() != 0) {
+      string serialized;
+      attributes.Serialize(&serialized);
+      hash_ = CombineHash(hash_, HashString(serialized));
+    }
+  }
+
+  virtual void SaveElement(const ElementPtr& element);
+
+  virtual void SaveStringFieldById(int type_id, string value) {
+    hash_ = CombineHash(hash_, type_id);
+    hash_ = CombineHash(hash_, HashString(value));
+  }
+
+  virtual void SaveContent(const string& content, bool maybe_quote) {
+    hash_ = CombineHash(hash_, HashString(content));
+  }
+
+  virtual void SaveVec3(const kmlbase::Vec3& vec3) {
+    const double lla[3] = {
+      vec3.get_longitude(), vec3.get_latitude(), vec3.get_altitude()
+    };
+    hash_ = CombineHash(hash_, HashString(reinterpret_cast<const char*>(lla),
+                                          sizeof(lla)));
+  }
+
+  virtual void SaveColor(int type_id, const kmlbase::Color32& color) {
+    hash_ = CombineHash(hash_, type_id);
+    hash_ = CombineHash(hash_, color.get_color_abgr());
+  }
+
+  size_t get_hash() const {
+    return hash_;
+  }
+
+ private:
+  ElementHasher* element_hasher_;
+  const bool skip_features_;
+  size_t hash_;
+};
+
+// The ElementHasher hashes the entire content of an element.  The hash of each
+// Feature is saved such that hashing a Container and then each of its
+// Features costs no more than hashing the Container.  Only elements which
+// outlive the ElementHasher should be passed to Hash() or Equal().  Equal
+// hashes do not prove the elements equal so Equal() and EqualShallow()
+// confirm them by comparing the serialized elements: a hash collision costs
+// a serialization but never hides a difference.
+class ElementHasher {
+ public:
+  // Returns true if the two elements have the same content.
+  bool Equal(const ElementPtr& a, const ElementPtr& b) {
+    return Hash(a) == Hash(b) &&
+           kmldom::SerializeRaw(a) == kmldom::SerializeRaw(b);
+  }
+
+  // Returns true if the two elements have the same content other than their
+  // Feature children.
+  bool EqualShallow(const ElementPtr& a, const ElementPtr& b);
+
+  size_t Hash(const ElementPtr& element) {
+    if (!AsFeature(element)) {
+      return Compute(element, false);
+    }
+    FeatureHashMap::const_iterator find = feature_hash_map_.find(element.get());
+    if (find != feature_hash_map_.end()) {
+      return find->second;
+    }
+    const size_t hash = Compute(element, false);
+    feature_hash_map_[element.get()] = hash;
+    return hash;
+  }
+
+  // This hashes the element with none of its Feature children.  Nothing is
+  // saved so this may be used on short-lived elements.
+  size_t HashShallow(const ElementPtr& element) {
+    return Compute(element, true);
+  }
+
+ private:
+  size_t Compute(const ElementPtr& element, bool skip_features) {
+    HashSerializer hash_serializer(this, skip_features);
+    element->Serialize(hash_serializer);
+    return hash_serializer.get_hash();
+  }
+
+  typedef std::map<const Element*, size_t> FeatureHashMap;
+  FeatureHashMap feature_hash_map_;
+};
+
+void HashSerializer::SaveElement(const ElementPtr& element) {
+  if (element && !(skip_features_ && AsFeature(element))) {
+    hash_ = CombineHash(hash_, element_hasher_->Hash(element));
+  }
+}
+
+// This Serializer-specialization collects the simple element children and the
+// complex element children of one element.
+class ChildCollector : public Serializer {
+ public:
+  typedef std::map<int, kmlbase::StringVector> FieldMap;
+
+  virtual ~ChildCollector() {}
+
+  virtual void SaveElement(const ElementPtr& element) {
+    if (element) {
+      child_array_.push_back(element);
+    }
+  }
+
+  virtual void SaveStringFieldById(int type_id, string value) {
+    field_map_[type_id].push_back(value);
+  }
+
+  virtual void SaveColor(int type_id, const kmlbase::Color32& color) {
+    SaveFieldById(type_id, color.to_string_abgr());
+  }
+
+  const FieldMap& get_field_map() const {
+    return field_map_;
+  }
+
+  const ElementVector& get_child_array() const {
+    return child_array_;
+  }
+
+ private:
+  FieldMap field_map_;
+  ElementVector child_array_;
+};
+
+// Create a copy of the element with none of its Feature children.  The copy of
+// each other complex child is of the substitute for that child if one is in
+// the map.
+typedef std::map<const Element*, ElementPtr> SubstituteMap;
+static ElementPtr CloneShallow(const ElementPtr& element,
+                               const SubstituteMap& substitute_map) {
+  ElementPtr clone = KmlFactory::GetFactory()->CreateElementById(
+      element->Type());
+  MergeFields(element, clone);
+  ElementVector children;
+  GetChildElements(element, false, &children);
+  for (size_t i = 0; i < children.size(); ++i) {
+    if (!AsFeature(children[i])) {
+      SubstituteMap::const_iterator find =
+          substitute_map.find(children[i].get());
+      clone->AddElement(Clone(find != substitute_map.end() ? find->second
+                                                           : children[i]));
+    }
+  }
+  for (size_t i = 0; i < element->get_unknown_elements_array_size(); ++i) {
+    clone->AddUnknownElement(element->get_unknown_elements_array_at(i));
+  }
+  return clone;
+}
+
+bool ElementHasher::EqualShallow(const ElementPtr& a, const ElementPtr& b) {
+  if (HashShallow(a) != HashShallow(b)) {
+    return false;
+  }
+  const SubstituteMap no_substitutes;
+  return kmldom::SerializeRaw(CloneShallow(a, no_substitutes)) ==
+         kmldom::SerializeRaw(CloneShallow(b, no_substitutes));
+}
+
+// The KmlDiffer walks an old and new KmlFile in parallel and collects the
+// <Delete>, <Change> and <Create> operations which transform the old into
+// the new.  Each <Change> is checked by applying it to a copy of its target
+// exactly as UpdateProcessor would such that no <Change> is emitted whose
+// result differs from the new KmlFile.
+class KmlDiffer {
+ public:
+  KmlDiffer(const KmlFile& old_kml_file, const KmlFile& new_kml_file)
+    : old_kml_file_(old_kml_file),
+      new_kml_file_(new_kml_file),
+      delete_(KmlFactory::GetFactory()->CreateDelete()),
+      change_(KmlFactory::GetFactory()->CreateChange()) {
+  }
+
+  // This returns false if the difference between the two root elements
+  // cannot be expressed as an <Update>.
+  bool DiffRoots();
+
+  UpdatePtr CreateUpdate() const;
+
+ private:
+  bool DiffObjects(const ObjectPtr& old_object, const ObjectPtr& new_object);
+  bool DiffFeatures(const ContainerPtr& old_container,
+                    const ContainerPtr& new_container);
+  ObjectPtr CreateChangeSource(const ObjectPtr& old_object,
+                               const ObjectPtr& new_object,
+                               const std::set<const Element*>& matched_set,
+                               bool minimal);
+  bool CheckChange(const ObjectPtr& source, const ObjectPtr& old_object,
+                   const SubstituteMap& substitute_map,
+                   const ObjectPtr& new_object);
+
+  const KmlFile& old_kml_file_;
+  const KmlFile& new_kml_file_;
+  ElementHasher element_hasher_;
+  DeletePtr delete_;
+  ChangePtr change_;
+  std::vector<CreatePtr> create_array_;
+};
+
+// This returns the Object in the KmlFile with the same id and type as the
+// given Object if it is a child of the given parent.
+static ObjectPtr FindMatch(const KmlFile& kml_file, const ObjectPtr& object,
+                           const ElementPtr& parent) {
+  ObjectPtr match = kml_file.GetObjectById(object->get_id());
+  if (match && match->Type() == object->Type() &&
+      match->GetParent().get() == parent.get()) {
+    return match;
+  }
+  return NULL;
+}
+
+bool KmlDiffer::DiffRoots() {
+  const ElementPtr& old_root = old_kml_file_.get_root();
+  const ElementPtr& new_root = new_kml_file_.get_root();
+  if (!old_root || !new_root) {
+    return false;
+  }
+  FeaturePtr old_feature;
+  FeaturePtr new_feature;
+  KmlPtr old_kml = AsKml(old_root);
+  KmlPtr new_kml = AsKml(new_root);
+  if (old_kml && new_kml) {
+    // Nothing outside the root Feature can be updated.
+    if (!element_hasher_.EqualShallow(old_kml, new_kml)) {
+      return false;
+    }
+    old_feature = old_kml->get_feature();
+    new_feature = new_kml->get_feature();
+  } else {
+    old_feature = AsFeature(old_root);
+    new_feature = AsFeature(new_root);
+    if (!old_feature || !new_feature) {
+      return element_hasher_.Equal(old_root, new_root);
+    }
+  }
+  if (!old_feature || !new_feature) {
+    return !old_feature && !new_feature;
+  }
+  if (element_hasher_.Equal(old_feature, new_feature)) {
+    return true;
+  }
+  if (!old_feature->has_id() || old_feature->get_id() != new_feature->get_id()
+      || old_feature->Type() != new_feature->Type()) {
+    return false;
+  }
+  return DiffObjects(old_feature, new_feature);
+}
+
+// The two Objects have the same id and type.  Any operations on the Features
+// and id'ed children within the Objects are collected before the <Change> of
+// the Object itself such that the <Change> of the Object is checked against
+// the children as they will be when it is applied.
+bool KmlDiffer::DiffObjects(const ObjectPtr& old_object,
+                            const ObjectPtr& new_object) {
+  if (element_hasher_.Equal(old_object, new_object)) {
+    return true;
+  }
+  if (ContainerPtr old_container = AsContainer(old_object)) {
+    if (!DiffFeatures(old_container, AsContainer(new_object))) {
+      return false;
+    }
+  }
+  // Complex children with an id in both versions are diffed in their own
+  // right and appear in their new form in the copy used to check the
+  // <Change> of this Object.
+  SubstituteMap substitute_map;
+  std::set<const Element*> matched_set;
+  ElementVector new_children;
+  GetChildElements(new_object, false, &new_children);
+  for (size_t i = 0; i < new_children.size(); ++i) {
+    ObjectPtr new_child = AsObject(new_children[i]);
+    if (!new_child || AsFeature(new_child) || !new_child->has_id()) {
+      continue;
+    }
+    if (ObjectPtr old_child = FindMatch(old_kml_file_, new_child,
+                                        old_object)) {
+      if (!DiffObjects(old_child, new_child)) {
+        return false;
+      }
+      substitute_map[old_child.get()] = new_child;
+      matched_set.insert(new_child.get());
+    }
+  }
+  if (element_hasher_.EqualShallow(CloneShallow(old_object, substitute_map),
+                                  new_object)) {
+    return true;
+  }
+  // Try a <Change> of only those fields and children which differ and then
+  // a <Change> of everything.
+  ObjectPtr source = CreateChangeSource(old_object, new_object, matched_set,
+                                        true);
+  if (!CheckChange(source, old_object, substitute_map, new_object)) {
+    source = CreateChangeSource(old_object, new_object, matched_set, false);
+    if (!CheckChange(source, old_object, substitute_map, new_object)) {
+      return false;
+    }
+  }
+  change_->add_object(source);
+  return true;
+}
+
+// The <Delete>'s are gathered here directly.  The surviving Features of the
+// old Container must appear in the same order in the new Container and all
+// new Features must follow them given that <Create> appends.  A Feature with
+// no id cannot be targeted and must be unchanged.
+bool KmlDiffer::DiffFeatures(const ContainerPtr& old_container,
+                             const ContainerPtr& new_container) {
+  KmlFactory* kml_factory = KmlFactory::GetFactory();
+  std::vector<FeaturePtr> kept;
+  for (size_t i = 0; i < old_container->get_feature_array_size(); ++i) {
+    const FeaturePtr& old_feature = old_container->get_feature_array_at(i);
+    if (!old_feature->has_id() ||
+        FindMatch(new_kml_file_, old_feature, new_container)) {
+      kept.push_back(old_feature);
+    } else {
+      FeaturePtr target = AsFeature(kml_factory->CreateElementById(
+          old_feature->Type()));
+      target->set_targetid(old_feature->get_id());
+      delete_->add_feature(target);
+    }
+  }
+  size_t k = 0;
+  ContainerPtr create_container;
+  for (size_t i = 0; i < new_container->get_feature_array_size(); ++i) {
+    const FeaturePtr& new_feature = new_container->get_feature_array_at(i);
+    FeaturePtr old_feature;
+    if (new_feature->has_id()) {
+      old_feature = AsFeature(FindMatch(old_kml_file_, new_feature,
+                                        old_container));
+    }
+    if (old_feature) {
+      if (create_container || k == kept.size() || kept[k] != old_feature) {
+        return false;
+      }
+      ++k;
+      if (!DiffObjects(old_feature, new_feature)) {
+        return false;
+      }
+    } else if (!new_feature->has_id() && !create_container &&
+               k < kept.size() && !kept[k]->has_id() &&
+               element_hasher_.Equal(kept[k], new_feature)) {
+      ++k;
+    } else {
+      if (k != kept.size()) {
+        return false;
+      }
+      if (!create_container) {
+        create_container = AsContainer(kml_factory->CreateElementById(
+            old_container->Type()));
+        create_container->set_targetid(old_container->get_id());
+        CreatePtr create = kml_factory->CreateCreate();
+        create->add_container(create_container);
+        create_array_.push_back(create);
+      }
+      create_container->add_feature(AsFeature(Clone(new_feature)));
+    }
+  }
+  return k == kept.size();
+}
+
+// The source of a <Change> has the targetId of the Object and no id.  The
+// children of the new Object which are diffed in their own right are not
+// included.  If minimal is true only the attributes, fields and complex
+// children which differ from the old Object are included.
+ObjectPtr KmlDiffer::CreateChangeSource(
+    const ObjectPtr& old_object, const ObjectPtr& new_object,
+    const std::set<const Element*>& matched_set, bool minimal) {
+  // The attribute and child methods are public only on Element.
+  const ElementPtr source =
+      KmlFactory::GetFactory()->CreateElementById(new_object->Type());
+  const ElementPtr old_element(old_object);
+  const ElementPtr new_element(new_object);
+  Attributes old_attributes;
+  old_element->SerializeAttributes(&old_attributes);
+  Attributes new_attributes;
+  new_element->SerializeAttributes(&new_attributes);
+  string old_serialized;
+  old_attributes.Serialize(&old_serialized);
+  string new_serialized;
+  new_attributes.Serialize(&new_serialized);
+  if (!minimal || old_serialized != new_serialized) {
+    Attributes* attributes = new_attributes.Clone();
+    string id;
+    attributes->CutValue("id", &id);
+    source->ParseAttributes(attributes);
+  }
+  AsObject(source)->set_targetid(new_object->get_id());
+
+  ChildCollector old_collector;
+  old_object->Serialize(old_collector);
+  ChildCollector new_collector;
+  new_object->Serialize(new_collector);
+
+  const ChildCollector::FieldMap& old_field_map = old_collector.get_field_map();
+  const ChildCollector::FieldMap& new_field_map = new_collector.get_field_map();
+  ChildCollector::FieldMap::const_iterator iter;
+  for (iter = new_field_map.begin(); iter != new_field_map.end(); ++iter) {
+    ChildCollector::FieldMap::const_iterator find =
+        old_field_map.find(iter->first);
+    if (minimal && find != old_field_map.end() &&
+        find->second == iter->second) {
+      continue;
+    }
+    for (size_t i = 0; i < iter->second.size(); ++i) {
+      ElementPtr field = KmlFactory::GetFactory()->CreateFieldById(
+          static_cast<KmlDomType>(iter->first));
+      field->set_char_data(iter->second[i]);
+      source->AddElement(field);
+    }
+  }
+
+  // A complex child is unchanged if the old Object has an identical child of
+  // the same type at the same position among the children of that type.
+  std::map<int, ElementVector> old_child_map;
+  const ElementVector& old_children = old_collector.get_child_array();
+  for (size_t i = 0; i < old_children.size(); ++i) {
+    old_child_map[old_children[i]->Type()].push_back(old_children[i]);
+  }
+  std::map<int, size_t> position_map;
+  const ElementVector& new_children = new_collector.get_child_array();
+  for (size_t i = 0; i < new_children.size(); ++i) {
+    const ElementPtr& new_child = new_children[i];
+    if (AsFeature(new_child)) {
+      continue;
+    }
+    const size_t position = position_map[new_child->Type()]++;
+    if (matched_set.find(new_child.get()) != matched_set.end()) {
+      continue;
+    }
+    if (minimal) {
+      const ElementVector& same_type = old_child_map[new_child->Type()];
+      if (position < same_type.size() &&
+          element_hasher_.Equal(same_type[position], new_child)) {
+        continue;
+      }
+    }
+    source->AddElement(Clone(new_child));
+  }
+  if (!minimal) {
+    for (size_t i = 0; i < new_object->get_unknown_elements_array_size();
+         ++i) {
+      source->AddUnknownElement(new_object->get_unknown_elements_array_at(i));
+    }
+  }
+  return AsObject(source);
+}
+
+// This applies the <Change> to a copy of the old Object in the same manner
+// as UpdateProcessor and compares the result to the new Object.
+bool KmlDiffer::CheckChange(const ObjectPtr& source,
+                            const ObjectPtr& old_object,
+                            const SubstituteMap& substitute_map,
+                            const ObjectPtr& new_object) {
+  ObjectPtr target = AsObject(CloneShallow(old_object, substitute_map));
+  MergeElements(source, target);
+  target->set_id(old_object->get_id());
+  target->clear_targetid();
+  return element_hasher_.EqualShallow(target, new_object);
+}
+
+UpdatePtr KmlDiffer::CreateUpdate() const {
+  UpdatePtr update = KmlFactory::GetFactory()->CreateUpdate();
+  update->set_targethref(old_kml_file_.get_url());
+  if (delete_->get_feature_array_size() > 0) {
+    update->add_updateoperation(delete_);
+  }
+  if (change_->get_object_array_size() > 0) {
+    update->add_updateoperation(change_);
+  }
+  for (size_t i = 0; i < create_array_.size(); ++i) {
+    update->add_updateoperation(create_array_[i]);
+  }
+  return update;
+}
+
+UpdatePtr DiffKmlFiles(const KmlFilePtr& old_kml_file,
+                       const KmlFilePtr& new_kml_file) {
+  if (!old_kml_file || !new_kml_file) {
+    return NULL;
+  }
+  KmlDiffer kml_differ(*old_kml_file, *new_kml_file);
+  if (!kml_differ.DiffRoots()) {
+    return NULL;
+  }
+  return kml_differ.CreateUpdate();
+}
+
+}  // end namespace kmlengine
@@ -0,0 +1,55 @@
+// Copyright 2008, Google Inc. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//  3. Neither the name of Google Inc. nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// This file contains the declaration of the DiffKmlFiles() function which
+// computes the <Update> that transforms one version of a KML file into
+// another.
+
+#ifndef KML_ENGINE_KML_DIFF_H__
+#define KML_ENGINE_KML_DIFF_H__
+
+#include "kml/dom.h"
+#include "kml/engine/kml_file.h"
+
+namespace kmlengine {
+
+// This returns an <Update> which when applied to old_kml_file with
+// ProcessUpdate() makes it identical to new_kml_file.  The <targetHref> is set
+// to the url of old_kml_file.  The two files are matched Object by Object
+// using the id= of each Object and unchanged subtrees are detected by hash
+// such that the time taken is roughly linear in the size of the files.  The
+// <Update> holds at most one <Delete> and one <Change> followed by one
+// <Create> for each Container into which new Features are added, and is
+// empty if the files are the same.  NULL is returned if either file is NULL
+// or if the differences cannot be expressed as an <Update>: for example a
+// Feature with no id= changed, the root Feature was replaced, or Features
+// were reordered within a Container.  In that case the caller should serve
+// new_kml_file in its entirety.
+kmldom::UpdatePtr DiffKmlFiles(const KmlFilePtr& old_kml_file,
+                               const KmlFilePtr& new_kml_file);
+
+}  // end namespace kmlengine
+
+#endif  // KML_ENGINE_KML_DIFF_H__
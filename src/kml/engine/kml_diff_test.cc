@@ -0,0 +1,278 @@
+// Copyright 2008, Google Inc. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//  3. Neither the name of Google Inc. nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// This file contains the unit tests for the DiffKmlFiles() function.
+
+#include "kml/engine/kml_diff.h"
+#include "gtest/gtest.h"
+#include "kml/base/string_util.h"
+#include "kml/dom.h"
+#include "kml/engine/kml_file.h"
+#include "kml/engine/update.h"
+
+using kmldom::AsChange;
+using kmldom::AsCreate;
+using kmldom::AsDelete;
+using kmldom::ChangePtr;
+using kmldom::UpdatePtr;
+
+namespace kmlengine {
+
+class KmlDiffTest : public testing::Test {
+ protected:
+  // This diffs the two KML strings and applies the <Update> to the old KML
+  // after a round trip through XML.  The result must be identical to the new
+  // KML and diffing the two again must produce an empty <Update>.  NULL is
+  // returned if the difference cannot be expressed as an <Update>.
+  UpdatePtr DiffAndApply(const string& old_kml, const string& new_kml) {
+    KmlFilePtr old_kml_file = KmlFile::CreateFromString(old_kml);
+    KmlFilePtr new_kml_file = KmlFile::CreateFromString(new_kml);
+    EXPECT_TRUE(old_kml_file);
+    EXPECT_TRUE(new_kml_file);
+    UpdatePtr update = DiffKmlFiles(old_kml_file, new_kml_file);
+    if (!update) {
+      return NULL;
+    }
+    UpdatePtr parsed_update =
+        kmldom::AsUpdate(kmldom::ParseKml(kmldom::SerializePretty(update)));
+    EXPECT_TRUE(parsed_update);
+    ProcessUpdate(parsed_update, old_kml_file);
+    string old_xml;
+    old_kml_file->SerializeToString(&old_xml);
+    string new_xml;
+    new_kml_file->SerializeToString(&new_xml);
+    EXPECT_EQ(new_xml, old_xml);
+    UpdatePtr empty_update = DiffKmlFiles(old_kml_file, new_kml_file);
+    EXPECT_TRUE(empty_update);
+    if (empty_update) {
+      EXPECT_EQ(static_cast<size_t>(0),
+                empty_update->get_updateoperation_array_size());
+    }
+    return update;
+  }
+};
+
+TEST_F(KmlDiffTest, TestNull) {
+  ASSERT_FALSE(DiffKmlFiles(NULL, NULL));
+  KmlFilePtr kml_file = KmlFile::CreateFromString("<kml/>");
+  ASSERT_FALSE(DiffKmlFiles(kml_file, NULL));
+  ASSERT_FALSE(DiffKmlFiles(NULL, kml_file));
+}
+
+TEST_F(KmlDiffTest, TestSame) {
+  const string kKml(
+      "<kml><Document id=\"d\">"
+      "<Style id=\"s\"><LineStyle><width>2</width></LineStyle></Style>"
+      "<Placemark id=\"p\"><name>p</name><Point><coordinates>1,2,3"
+      "</coordinates></Point></Placemark>"
+      "<Placemark><name>no id</name></Placemark>"
+      "</Document></kml>");
+  UpdatePtr update = DiffAndApply(kKml, kKml);
+  ASSERT_TRUE(update);
+  ASSERT_EQ(static_cast<size_t>(0), update->get_updateoperation_array_size());
+}
+
+TEST_F(KmlDiffTest, TestTargetHref) {
+  KmlFilePtr old_kml_file = KmlFile::CreateFromStringWithUrl(
+      "<kml/>", "http://example.com/a.kml", NULL);
+  ASSERT_TRUE(old_kml_file);
+  KmlFilePtr new_kml_file = KmlFile::CreateFromString("<kml/>");
+  UpdatePtr update = DiffKmlFiles(old_kml_file, new_kml_file);
+  ASSERT_TRUE(update);
+  ASSERT_EQ(string("http://example.com/a.kml"), update->get_targethref());
+}
+
+// A <Change> holds only the fields which changed.
+TEST_F(KmlDiffTest, TestChangeField) {
+  UpdatePtr update = DiffAndApply(
+      "<Folder id=\"f\">"
+      "<Placemark id=\"a\"><name>a</name><visibility>0</visibility></Placemark>"
+      "<Placemark id=\"b\"><name>b</name><visibility>0</visibility></Placemark>"
+      "</Folder>",
+      "<Folder id=\"f\">"
+      "<Placemark id=\"a\"><name>a</name><visibility>0</visibility></Placemark>"
+      "<Placemark id=\"b\"><name>B</name><visibility>0</visibility></Placemark>"
+      "</Folder>");
+  ASSERT_TRUE(update);
+  ASSERT_EQ(static_cast<size_t>(1), update->get_updateoperation_array_size());
+  ChangePtr change = AsChange(update->get_updateoperation_array_at(0));
+  ASSERT_TRUE(change);
+  ASSERT_EQ(static_cast<size_t>(1), change->get_object_array_size());
+  kmldom::PlacemarkPtr placemark =
+      kmldom::AsPlacemark(change->get_object_array_at(0));
+  ASSERT_TRUE(placemark);
+  ASSERT_EQ(string("b"), placemark->get_targetid());
+  ASSERT_FALSE(placemark->has_id());
+  ASSERT_EQ(string("B"), placemark->get_name());
+  ASSERT_FALSE(placemark->has_visibility());
+}
+
+TEST_F(KmlDiffTest, TestChangeGeometry) {
+  UpdatePtr update = DiffAndApply(
+      "<Placemark id=\"p\"><name>p</name>"
+      "<Point><coordinates>1,2,3</coordinates></Point></Placemark>",
+      "<Placemark id=\"p\"><name>p</name>"
+      "<Point><coordinates>4,5,6</coordinates></Point></Placemark>");
+  ASSERT_TRUE(update);
+  ASSERT_EQ(static_cast<size_t>(1), update->get_updateoperation_array_size());
+  ChangePtr change = AsChange(update->get_updateoperation_array_at(0));
+  ASSERT_TRUE(change);
+  kmldom::PlacemarkPtr placemark =
+      kmldom::AsPlacemark(change->get_object_array_at(0));
+  ASSERT_TRUE(placemark);
+  ASSERT_FALSE(placemark->has_name());
+  ASSERT_TRUE(placemark->has_geometry());
+}
+
+TEST_F(KmlDiffTest, TestDeleteAndCreate) {
+  UpdatePtr update = DiffAndApply(
+      "<kml><Document id=\"d\">"
+      "<Placemark id=\"a\"/><Placemark id=\"b\"/><Placemark id=\"c\"/>"
+      "</Document></kml>",
+      "<kml><Document id=\"d\">"
+      "<Placemark id=\"a\"/><Placemark id=\"c\"/>"
+      "<Placemark id=\"e\"><name>e</name></Placemark><Folder/>"
+      "</Document></kml>");
+  ASSERT_TRUE(update);
+  ASSERT_EQ(static_cast<size_t>(2), update->get_updateoperation_array_size());
+  kmldom::DeletePtr deleet = AsDelete(update->get_updateoperation_array_at(0));
+  ASSERT_TRUE(deleet);
+  ASSERT_EQ(static_cast<size_t>(1), deleet->get_feature_array_size());
+  ASSERT_EQ(string("b"), deleet->get_feature_array_at(0)->get_targetid());
+  kmldom::CreatePtr create = AsCreate(update->get_updateoperation_array_at(1));
+  ASSERT_TRUE(create);
+  ASSERT_EQ(static_cast<size_t>(1), create->get_container_array_size());
+  ASSERT_EQ(string("d"), create->get_container_array_at(0)->get_targetid());
+  ASSERT_EQ(static_cast<size_t>(2),
+            create->get_container_array_at(0)->get_feature_array_size());
+}
+
+// A Feature moved from one Folder to another is deleted and created.
+TEST_F(KmlDiffTest, TestMoveFeature) {
+  UpdatePtr update = DiffAndApply(
+      "<Document id=\"d\">"
+      "<Folder id=\"f\"><Placemark id=\"p\"><name>p</name></Placemark>"
+      "</Folder>"
+      "<Folder id=\"g\"><Placemark id=\"q\"/></Folder>"
+      "</Document>",
+      "<Document id=\"d\">"
+      "<Folder id=\"f\"/>"
+      "<Folder id=\"g\"><Placemark id=\"q\"/>"
+      "<Placemark id=\"p\"><name>moved</name></Placemark></Folder>"
+      "</Document>");
+  ASSERT_TRUE(update);
+  ASSERT_EQ(static_cast<size_t>(2), update->get_updateoperation_array_size());
+}
+
+// Shared styles are each changed by id.
+TEST_F(KmlDiffTest, TestChangeSharedStyle) {
+  UpdatePtr update = DiffAndApply(
+      "<Document id=\"d\"><name>old</name>"
+      "<Style id=\"a\"><LineStyle><width>1</width></LineStyle></Style>"
+      "<Style id=\"b\"><LineStyle><width>2</width></LineStyle></Style>"
+      "<Placemark id=\"p\"><styleUrl>#a</styleUrl></Placemark>"
+      "</Document>",
+      "<Document id=\"d\"><name>new</name>"
+      "<Style id=\"a\"><LineStyle><width>1</width></LineStyle></Style>"
+      "<Style id=\"b\"><LineStyle><width>5</width></LineStyle></Style>"
+      "<Placemark id=\"p\"><styleUrl>#b</styleUrl></Placemark>"
+      "</Document>");
+  ASSERT_TRUE(update);
+  ASSERT_EQ(static_cast<size_t>(1), update->get_updateoperation_array_size());
+  ChangePtr change = AsChange(update->get_updateoperation_array_at(0));
+  ASSERT_TRUE(change);
+  // The Placemark, the Style and the Document.
+  ASSERT_EQ(static_cast<size_t>(3), change->get_object_array_size());
+  ASSERT_EQ(string("p"), change->get_object_array_at(0)->get_targetid());
+  ASSERT_EQ(string("b"), change->get_object_array_at(1)->get_targetid());
+  ASSERT_EQ(string("d"), change->get_object_array_at(2)->get_targetid());
+}
+
+// These differences have no <Update>.
+TEST_F(KmlDiffTest, TestNotExpressible) {
+  // Reordered Features.
+  ASSERT_FALSE(DiffAndApply(
+      "<Folder id=\"f\"><Placemark id=\"a\"/><Placemark id=\"b\"/></Folder>",
+      "<Folder id=\"f\"><Placemark id=\"b\"/><Placemark id=\"a\"/></Folder>"));
+  // A new Feature before an existing Feature.
+  ASSERT_FALSE(DiffAndApply(
+      "<Folder id=\"f\"><Placemark id=\"a\"/></Folder>",
+      "<Folder id=\"f\"><Placemark id=\"b\"/><Placemark id=\"a\"/></Folder>"));
+  // A changed Feature with no id.
+  ASSERT_FALSE(DiffAndApply(
+      "<Folder id=\"f\"><Placemark><name>a</name></Placemark></Folder>",
+      "<Folder id=\"f\"><Placemark><name>b</name></Placemark></Folder>"));
+  // A removed field.
+  ASSERT_FALSE(DiffAndApply(
+      "<Placemark id=\"p\"><name>a</name></Placemark>",
+      "<Placemark id=\"p\"/>"));
+  // A different root Feature.
+  ASSERT_FALSE(DiffAndApply("<Placemark id=\"p\"/>",
+                            "<Placemark id=\"q\"/>"));
+  // A change outside the root Feature.
+  ASSERT_FALSE(DiffAndApply(
+      "<kml><Placemark id=\"p\"/></kml>",
+      "<kml hint=\"target=sky\"><Placemark id=\"p\"/></kml>"));
+}
+
+TEST_F(KmlDiffTest, TestManyFeatures) {
+  const int kNumFeatures = 2000;
+  string old_kml("<Document id=\"d\">");
+  string new_kml("<Document id=\"d\">");
+  for (int i = 0; i < kNumFeatures; ++i) {
+    const string id(kmlbase::ToString(i));
+    const string placemark("<Placemark id=\"" + id + "\"><name>" + id +
+                           "</name><Point><coordinates>" + id +
+                           ",1</coordinates></Point></Placemark>");
+    old_kml.append(placemark);
+    if (i % 11 == 0) {
+      continue;  // Deleted.
+    }
+    if (i % 7 == 0) {
+      new_kml.append("<Placemark id=\"" + id + "\"><name>new " + id +
+                     "</name><Point><coordinates>" + id +
+                     ",2</coordinates></Point></Placemark>");
+    } else {
+      new_kml.append(placemark);
+    }
+  }
+  for (int i = kNumFeatures; i < kNumFeatures + 50; ++i) {
+    new_kml.append("<Placemark id=\"" + kmlbase::ToString(i) +
+                   "\"/>");  // Created.
+  }
+  old_kml.append("</Document>");
+  new_kml.append("</Document>");
+  UpdatePtr update = DiffAndApply(old_kml, new_kml);
+  ASSERT_TRUE(update);
+  ASSERT_EQ(static_cast<size_t>(3), update->get_updateoperation_array_size());
+  ASSERT_EQ(static_cast<size_t>(182),
+            AsDelete(update->get_updateoperation_array_at(0))->
+                get_feature_array_size());
+  ASSERT_EQ(static_cast<size_t>(260),
+            AsChange(update->get_updateoperation_array_at(1))->
+                get_object_array_size());
+}
+
+}  // end namespace kmlengine
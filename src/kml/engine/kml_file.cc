@@ -27,10 +27,13 @@
 
 #include "kml/engine/kml_file.h"
 #include "kml/base/xml_namespaces.h"
+#include "kml/base/zip_file.h"
 #include "kml/engine/find_xml_namespaces.h"
 #include "kml/engine/id_mapper.h"
+#include "kml/engine/kml_snapshot.h"
 #include "kml/engine/kmz_file.h"
 #include "kml/dom.h"
+#include "kml/dom/serializer.h"
 #include "kml/dom/xml_serializer.h"
 
 using kmlbase::FindXmlNamespaceAndPrefix;
@@ -41,6 +44,11 @@ namespace kmlengine {
 static const char kDefaultXmlns[] = "http://www.opengis.net/kml/2.2";
 static const char kDefaultEncoding[] = "utf-8";
 
+// The ObjectIdMap is sized before the parse for one id in about this many
+// bytes of KML rather than grow during the parse.  This is about the size of
+// a small Placemark with an id.
+static const size_t kKmlBytesPerId = 256;
+
 // static
 KmlFile* KmlFile::CreateFromParse(const string& kml_or_kmz_data,
                                   string* errors) {
@@ -54,6 +62,69 @@ KmlFile* KmlFile::CreateFromParse(const string& kml_or_kmz_data,
   return NULL;
 }
 
+// static
+KmlFile* KmlFile::CreateFromParse(const string& kml_or_kmz_data,
+                                  const KmlFileOptions& options,
+                                  string* errors) {
+  return CreateWithOptions(kml_or_kmz_data, options, NULL, errors);
+}
+
+// static
+KmlFile* KmlFile::CreateFromSource(
+    const kmldom::SourceBufferPtr& source_buffer,
+    const KmlFileOptions& options, string* errors) {
+  if (!source_buffer) {
+    return NULL;
+  }
+  return CreateWithOptions(source_buffer->get_data(), options, source_buffer,
+                           errors);
+}
+
+// This returns why the given options cannot be used together, or NULL if
+// they can.  The Parser has no parallel form of an interning, filtered or
+// source keeping parse.
+static const char* GetOptionsError(const KmlFileOptions& options,
+                                   bool keep_source) {
+  if (options.intern_strings && options.string_pool) {
+    return "intern_strings cannot be combined with a string_pool";
+  }
+  if (options.parse_threads != 1 &&
+      (options.intern_strings || options.string_pool ||
+       options.parse_filter || keep_source)) {
+    return "a parallel parse cannot intern, filter or keep the source";
+  }
+  return NULL;
+}
+
+// private static
+KmlFile* KmlFile::CreateWithOptions(
+    const string& kml_or_kmz_data, const KmlFileOptions& options,
+    const kmldom::SourceBufferPtr& source_buffer, string* errors) {
+  if (const char* options_error = GetOptionsError(options,
+                                                   source_buffer.get())) {
+    if (errors) {
+      *errors = options_error;
+    }
+    return NULL;
+  }
+  KmlFile* kml_file = new KmlFile;
+  kml_file->parse_threads_ = options.parse_threads;
+  if (options.intern_strings) {
+    kml_file->string_pool_.reset(new kmlbase::StringPool);
+  }
+  kml_file->parse_string_pool_ = options.string_pool;
+  kml_file->parse_filter_ = options.parse_filter;
+  kml_file->source_buffer_ = source_buffer;
+  if (kml_file->_CreateFromParse(kml_or_kmz_data, errors)) {
+    // The pool and filter of the caller are only used during the parse.
+    kml_file->parse_string_pool_ = NULL;
+    kml_file->parse_filter_ = NULL;
+    return kml_file;
+  }
+  delete kml_file;
+  return NULL;
+}
+
 // static
 KmlFile* KmlFile::CreateFromStringWithUrl(const string& kml_data,
                                           const string& url,
@@ -82,12 +153,34 @@ bool KmlFile::_CreateFromParse(const string& kml_or_kmz_data,
 // status represents file handling errors.
 bool KmlFile::OpenAndParseKmz(const string& kmz_data,
                               string* errors) {
-  string kml_data;
   KmzFilePtr kmz_file = kmlengine::KmzFile::OpenFromString(kmz_data);
-  if (!kmz_file || !kmz_file->ReadKml(&kml_data)) {
+  if (!kmz_file) {
+    return false;
+  }
+  // A parallel parse splits the KML so it needs all of it at once.
+  if (parse_threads_ != 1) {
+    string kml_data;
+    if (!kmz_file->ReadKml(&kml_data)) {
       return false;
+    }
+    return ParseFromString(kml_data, errors);
   }
-  return ParseFromString(kml_data, errors);
+  // The KML inflated from the archive becomes the kept source in place of
+  // the KMZ data.
+  if (source_buffer_) {
+    string kml_data;
+    if (!kmz_file->ReadKml(&kml_data)) {
+      return false;
+    }
+    source_buffer_ = new kmldom::SourceBuffer(&kml_data);
+    return ParseFromString(source_buffer_->get_data(), errors);
+  }
+  boost::scoped_ptr<kmlbase::ZipEntryReader> zip_entry_reader(
+      kmz_file->OpenKml(NULL));
+  if (!zip_entry_reader.get()) {
+    return false;
+  }
+  return ParseFromZipEntry(zip_entry_reader.get(), errors);
 }
 
 // private
@@ -95,13 +188,33 @@ bool KmlFile::OpenAndParseKmz(const string& kmz_data,
 KmlFile::KmlFile()
   : encoding_(kDefaultEncoding),
     kml_cache_(NULL),
-    strict_parse_(false) {
+    strict_parse_(false),
+    parse_threads_(1),
+    parse_filter_(NULL),
+    parse_string_pool_(NULL) {
 }
 
 // private
 bool KmlFile::ParseFromString(const string& kml, string* errors) {
+  object_id_map_.reserve(kml.size() / kKmlBytesPerId);
+  return Parse(&kml, NULL, errors);
+}
+
+// private
+bool KmlFile::ParseFromZipEntry(kmlbase::ZipEntryReader* zip_entry_reader,
+                                string* errors) {
+  return Parse(NULL, zip_entry_reader, errors);
+}
+
+// private
+bool KmlFile::Parse(const string* kml,
+                    kmlbase::ZipEntryReader* zip_entry_reader,
+                    string* errors) {
   // Create a parser object.
   kmldom::Parser parser;
+  parser.set_string_pool(string_pool_ ? string_pool_.get()
+                                      : parse_string_pool_);
+  parser.set_parse_filter(parse_filter_);
 
   // Create a ParserObserver both to save the id's of all Objects as well as
   // check for duplicates if strict parsing has been enabled. If set, this
@@ -122,14 +235,57 @@ bool KmlFile::ParseFromString(const string& kml, string* errors) {
   parser.AddObserver(&get_link_parents);
 
   // Actually perform the parse.
-  if (kmldom::ElementPtr root = parser.Parse(kml, errors)) {
+  kmldom::ElementPtr root;
+  if (!kml) {
+    root = parser.ParseZipEntry(zip_entry_reader, errors);
+  } else if (source_buffer_) {
+    root = parser.ParseSource(source_buffer_, errors);
+  } else if (parse_threads_ == 1) {
+    root = parser.Parse(*kml, errors);
+  } else {
+    root = parser.ParseParallel(*kml, parse_threads_, errors);
+  }
+  if (root) {
     // TODO: set encoding, xmlns, etc from parse
     set_root(root);
+    if (parse_filter_) {
+      MapKeptElements();
+    }
     return true;
   }
   return false;
 }
 
+// static
+KmlFile* KmlFile::CreateFromSnapshot(const KmlSnapshot& snapshot,
+                                     string* errors) {
+  KmlFile* kml_file = new KmlFile;
+  kml_file->set_encoding(snapshot.get_encoding());
+
+  // The snapshot drives the same ParserObservers used in ParseFromString().
+  kml_file->object_id_map_.reserve(snapshot.get_id_count());
+  ObjectIdParserObserver object_id_parser_observer(&kml_file->object_id_map_,
+                                                   kml_file->strict_parse_);
+  SharedStyleParserObserver shared_style_parser_observer(
+      &kml_file->shared_style_map_, kml_file->strict_parse_);
+  GetLinkParentsParserObserver get_link_parents(
+      &kml_file->link_parent_vector_);
+  kmldom::parser_observer_vector_t observers;
+  observers.push_back(&object_id_parser_observer);
+  observers.push_back(&shared_style_parser_observer);
+  observers.push_back(&get_link_parents);
+
+  if (kmldom::ElementPtr root = snapshot.GetRoot(observers)) {
+    kml_file->set_root(root);
+    return kml_file;
+  }
+  if (errors) {
+    *errors = "corrupt KML snapshot";
+  }
+  delete kml_file;
+  return NULL;
+}
+
 // static
 KmlFile* KmlFile::CreateFromImportInternal(const kmldom::ElementPtr& element,
                                            bool strict) {
@@ -180,14 +336,18 @@ bool KmlFile::SerializeToOstream(std::ostream* xml_output) const {
   xml_output->write(xml_header.data(), xml_header.size());
 
   // Find all xml namespaces known to libkml used by all elements descending
-  // from the root and insert the appropriate xmlns attributes to the root
-  // element.  See kmlengine::FindAndInsertXmlNamespaces() for more info on
-  // how KML vs other namespaces are treated.
-  FindAndInsertXmlNamespaces(get_root());
+  // from the root and serialize the root with the appropriate xmlns
+  // attributes.  See kmlengine::FindAndInsertXmlNamespaces() for more info on
+  // how KML vs other namespaces are treated.  The root is not changed such
+  // that a KmlFile may be serialized from several threads at once.
+  kmlbase::Attributes xmlns;
+  FindRootXmlNamespaces(get_root(), &xmlns);
 
   // Append the serialization to the XML header.
   kmldom::XmlSerializer<std::ostream>::Serialize(get_root(), "\n",
-                                                         "  ", xml_output);
+                                                         "  ", xml_output,
+                                                         source_buffer_,
+                                                         &xmlns);
   return true;
 }
 
@@ -199,18 +359,105 @@ bool KmlFile::SerializeToString(string* xml_output) const {
   xml_output->append(xml_header.data(), xml_header.size());
 
   // Find all xml namespaces known to libkml used by all elements descending
-  // from the root and insert the appropriate xmlns attributes to the root
-  // element.  See kmlengine::FindAndInsertXmlNamespaces() for more info on
-  // how KML vs other namespaces are treated.
-  FindAndInsertXmlNamespaces(get_root());
+  // from the root and serialize the root with the appropriate xmlns
+  // attributes.  See kmlengine::FindAndInsertXmlNamespaces() for more info on
+  // how KML vs other namespaces are treated.  The root is not changed such
+  // that a KmlFile may be serialized from several threads at once.
+  kmlbase::Attributes xmlns;
+  FindRootXmlNamespaces(get_root(), &xmlns);
 
   // Append the serialization to the XML header.
   kmldom::StringAdapter string_adapter(xml_output);
   kmldom::XmlSerializer<kmldom::StringAdapter>::Serialize(
-      get_root(), "\n", "  ", &string_adapter);
+      get_root(), "\n", "  ", &string_adapter, source_buffer_, &xmlns);
   return true;
 }
 
+void KmlFile::MapObjectIds(const kmldom::ElementPtr& element) {
+  ObjectIdMap subtree_map;
+  MapIds(element, &subtree_map, NULL);
+  ObjectIdMap::const_iterator it;
+  for (it = subtree_map.begin(); it != subtree_map.end(); ++it) {
+    object_id_map_[it->first] = it->second;
+    if (kmldom::StyleSelectorPtr ss = kmldom::AsStyleSelector(it->second)) {
+      if (kmldom::AsDocument(ss->GetParent())) {
+        shared_style_map_[it->first] = ss;
+      }
+    }
+  }
+}
+
+// This walks a parsed hierarchy handing each element to the ParserObservers
+// as the parse did.
+class KeptElementObserver : public kmldom::Serializer {
+ public:
+  KeptElementObserver(const kmldom::parser_observer_vector_t& observers)
+    : observers_(observers) {
+  }
+
+  virtual void SaveElement(const kmldom::ElementPtr& element) {
+    const kmldom::ElementPtr parent = element->GetParent();
+    for (size_t i = 0; i < observers_.size(); ++i) {
+      observers_[i]->NewElement(element);
+      if (parent) {
+        observers_[i]->AddChild(parent, element);
+      }
+    }
+    // Call Serializer to recurse.
+    Serializer::SaveElement(element);
+  }
+
+ private:
+  const kmldom::parser_observer_vector_t& observers_;
+};
+
+// A Feature dropped by a ParseFilter was already seen by the ParserObservers
+// which saved the Objects and link parents within it.  Such a Feature is
+// freed so nothing within it can be inspected, and it may have displaced an
+// earlier Object of the same id which was kept.  The maps and the link parents
+// are thus made anew from the kept hierarchy.
+void KmlFile::MapKeptElements() {
+  object_id_map_.clear();
+  shared_style_map_.clear();
+  link_parent_vector_.clear();
+  ObjectIdParserObserver object_id_parser_observer(&object_id_map_, false);
+  SharedStyleParserObserver shared_style_parser_observer(&shared_style_map_,
+                                                         false);
+  GetLinkParentsParserObserver get_link_parents(&link_parent_vector_);
+  kmldom::parser_observer_vector_t observers;
+  observers.push_back(&object_id_parser_observer);
+  observers.push_back(&shared_style_parser_observer);
+  observers.push_back(&get_link_parents);
+  KeptElementObserver kept_element_observer(observers);
+  kept_element_observer.SaveElement(get_root());
+}
+
+void KmlFile::UnmapObjectIds(const kmldom::ElementPtr& element) {
+  ObjectIdMap subtree_map;
+  MapIds(element, &subtree_map, NULL);
+  ObjectIdMap::const_iterator it;
+  for (it = subtree_map.begin(); it != subtree_map.end(); ++it) {
+    ObjectIdMap::const_iterator find = object_id_map_.find(it->first);
+    if (find != object_id_map_.end() &&
+        find->second.get() == it->second.get()) {
+      object_id_map_.erase(it->first);
+    }
+    SharedStyleMap::const_iterator ss = shared_style_map_.find(it->first);
+    if (ss != shared_style_map_.end() &&
+        ss->second.get() == it->second.get()) {
+      shared_style_map_.erase(it->first);
+    }
+  }
+}
+
+const TimeIndex& KmlFile::GetTimeIndex() {
+  if (!time_index_.get()) {
+    time_index_.reset(new TimeIndex);
+    time_index_->AddFeatures(get_root());
+  }
+  return *time_index_;
+}
+
 kmldom::ObjectPtr KmlFile::GetObjectById(const string& id) const {
   ObjectIdMap::const_iterator find = object_id_map_.find(id);
   return find != object_id_map_.end() ? kmldom::AsObject(find->second) : NULL;
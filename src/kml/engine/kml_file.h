@@ -33,6 +33,7 @@
 #include "boost/scoped_ptr.hpp"
 #include "kml/base/attributes.h"
 #include "kml/base/referent.h"
+#include "kml/base/string_pool.h"
 #include "kml/base/xml_namespaces.h"
 #include "kml/base/util.h"
 #include "kml/base/xml_file.h"
@@ -41,26 +42,104 @@
 #include "kml/engine/get_link_parents.h"
 #include "kml/engine/object_id_parser_observer.h"
 #include "kml/engine/shared_style_parser_observer.h"
+#include "kml/engine/time_index.h"
+
+namespace kmlbase {
+class ZipEntryReader;
+}
 
 namespace kmlengine {
 
 class KmlCache;
+class KmlSnapshot;
+
+// The ways in which KmlFile::CreateFromParse() and KmlFile::CreateFromSource()
+// may parse.  The default is a serial parse of the whole file with no
+// interning, the same as that of the plain CreateFromParse().
+struct KmlFileOptions {
+  KmlFileOptions()
+    : parse_threads(1),
+      intern_strings(false),
+      string_pool(NULL),
+      parse_filter(NULL) {
+  }
+
+  // The KML is parsed on up to this many threads (0 means one per processor)
+  // using kmldom::Parser::ParseParallel().  The resulting KmlFile is the same
+  // as that of a serial parse.  The KML of a KMZ archive is read as a whole
+  // before a parallel parse.  A parallel parse can be combined with no other
+  // option and with no kept source.  The default is 1, a serial parse.
+  unsigned int parse_threads;
+
+  // If true the values of the fields and attributes held as a
+  // kmlbase::InternedString (such as <styleUrl>, <Data name="...">,
+  // <SimpleData name="..."> and <SchemaData schemaUrl="...">) are interned
+  // in a StringPool owned by the KmlFile.  Each distinct value is stored
+  // once no matter how often it is repeated in the file.  See
+  // KmlFile::get_string_pool().  The default is false.
+  bool intern_strings;
+
+  // If not NULL the values are interned as for intern_strings but in this
+  // StringPool rather than in one owned by the KmlFile.  Several KmlFiles
+  // parsed in turn with the same pool thus share their repeated values.  The
+  // pool is only used during the parse and KmlFile::get_string_pool()
+  // returns NULL.  This cannot be combined with intern_strings.  The default
+  // is NULL.
+  kmlbase::StringPool* string_pool;
+
+  // If not NULL only the parts of the KML kept by this ParseFilter are parsed
+  // (see kmldom::Parser::set_parse_filter()).  The Elements left out are
+  // never created and the Features the filter drops are in none of the maps
+  // of the KmlFile.  The filter is only used during the parse.  See also
+  // BboxParseFilter.  The default is NULL.
+  const kmldom::ParseFilter* parse_filter;
+};
 
 // The KmlFile class represents the instance of a KML file from a given URL.
 // A KmlFile manages an XML id domain and includes an internal map of all
 // id'ed Objects, shared styles, and name'ed Schemas and a list of all links.
 // KmlFile is a fundamental component of the KML Engine and is central in the
 // use of shared style resolution.
+//
+// A KmlFile may be shared by several threads which only read it once
+// kmlbase::Referent::set_thread_safe_ref_count(true) has been called.  These
+// threads may then at once walk the DOM through its const methods, call
+// GetObjectById(), GetSharedStyleById() and the other const methods here,
+// resolve styles with StyleResolver or StyleMerger (without a KmlCache to
+// fetch remote styles) and serialize the KmlFile or any of its Elements.
+// Nothing may change the KmlFile or its DOM meanwhile.  GetTimeIndex() is not
+// const and so is not safe to use from several threads at once.
 class KmlFile : public kmlbase::XmlFile {
  public:
   // This creates a KmlFile from a memory buffer of either KML or KMZ data.
-  // In the case of KMZ the KmzFile module's ReadKml() is used to read the
-  // KML data from the KMZ archive.  On any parse errors NULL is returned
+  // In the case of KMZ the KmzFile module's OpenKml() is used to inflate the
+  // KML data from the KMZ archive into the parser a piece at a time.  On any
+  // parse errors NULL is returned
   // and a human readable error message is saved in the supplied string.
   // The caller is responsible for deleting the KmlFile this creates.
   static KmlFile* CreateFromParse(const string& kml_or_kmz_data,
                                   string *errors);
 
+  // As CreateFromParse(), but the KML is parsed as set in the given options.
+  // If the options combine ways of parsing which cannot be combined NULL is
+  // returned and the reason is saved in errors.
+  static KmlFile* CreateFromParse(const string& kml_or_kmz_data,
+                                  const KmlFileOptions& options,
+                                  string* errors);
+
+  // As CreateFromParse(), but the KML or KMZ data is that of the given
+  // SourceBuffer which the KmlFile keeps (see kmldom::Parser::ParseSource()).
+  // Create the SourceBuffer from a string holding the data to hand that over
+  // without a copy.  SerializeToString() and SerializeToOstream() copy each
+  // Element left unchanged since the parse straight from the kept KML and
+  // serialize only the changed Elements and their ancestors.  This suits KML
+  // heavy with HTML descriptions or foreign markup which is mostly passed
+  // through untouched.  The KML of a KMZ archive is read as a whole into a
+  // SourceBuffer of its own.  The options may not ask for a parallel parse.
+  static KmlFile* CreateFromSource(
+      const kmldom::SourceBufferPtr& source_buffer,
+      const KmlFileOptions& options, string* errors);
+
   // This method is for use with NetCache CacheItem.
   static KmlFile* CreateFromString(const string& kml_or_kmz_data) {
     // Internal KML fetch/parse (styleUrl, etc) errors are quietly ignored.
@@ -73,6 +152,13 @@ class KmlFile : public kmlbase::XmlFile {
                                           const string& url,
                                           KmlCache* kml_cache);
 
+  // This creates a KmlFile from the given snapshot.  The result is the same as
+  // that of CreateFromParse() on the KML from which the snapshot was written.
+  // See kml_snapshot.h.  On any error NULL is returned and a human readable
+  // error message is saved in the supplied string.
+  static KmlFile* CreateFromSnapshot(const KmlSnapshot& snapshot,
+                                     string* errors);
+
   // This creates a KmlFile from the given element hierarchy.  This variant of
   // CreateFromImport fails on id duplicates.
   static KmlFile* CreateFromImport(const kmldom::ElementPtr& element);
@@ -91,6 +177,20 @@ class KmlFile : public kmlbase::XmlFile {
     return get_root();
   }
 
+  // This returns the StringPool of a KmlFile created with
+  // KmlFileOptions::intern_strings or NULL if it was created otherwise.
+  // Values interned here may be used with the InternedString setters of the
+  // Elements in this file, for example kmldom::Feature::set_styleurl().
+  kmlbase::StringPool* get_string_pool() const {
+    return string_pool_.get();
+  }
+
+  // This returns the TimeIndex of the Features in this KmlFile.  The index is
+  // built on first use and from then on is kept current by ProcessUpdate().
+  // Changes to the DOM made other than with ProcessUpdate() are not seen by
+  // the index.
+  const TimeIndex& GetTimeIndex();
+
   // This serializes the KML from the root.  The xmlns() value is added to
   // the root element, the set of namespace prefixes to namespaces is added,
   // and the encoding is set in a prepended XML header:
@@ -159,17 +259,42 @@ class KmlFile : public kmlbase::XmlFile {
   static KmlFile* CreateFromImportInternal(const kmldom::ElementPtr& element,
                                            bool disallow_duplicate_ids);
 
-  // This is an internal method used in the static Create methods.
+  // These are internal methods used in the static Create methods.
   bool ParseFromString(const string& kml, string* errors);
+  bool ParseFromZipEntry(kmlbase::ZipEntryReader* zip_entry_reader,
+                         string* errors);
+  // Parses kml, or if that is NULL the KML inflated by zip_entry_reader.
+  bool Parse(const string* kml, kmlbase::ZipEntryReader* zip_entry_reader,
+             string* errors);
 
   // Only static Create methods can set the KmlCache.
   void set_kml_cache(KmlCache* kml_cache) {
     kml_cache_ = kml_cache;
   }
+  // This is the helper function of CreateFromParse() and CreateFromSource()
+  // with options.  The source_buffer is NULL unless the source is kept.
+  static KmlFile* CreateWithOptions(
+      const string& kml_or_kmz_data, const KmlFileOptions& options,
+      const kmldom::SourceBufferPtr& source_buffer, string* errors);
   // These are helper functions for CreateFromParse().
   bool _CreateFromParse(const string& kml_or_kmz_data,
                         string* errors);
   bool OpenAndParseKmz(const string& kmz_data, string* errors);
+
+  // UpdateProcessor edits the DOM in place and uses these to keep the id and
+  // shared style maps consistent with the edits.
+  friend class UpdateProcessor;
+  // Add every id'ed Object in the given subtree to the id map and every
+  // shared StyleSelector to the shared style map.  An existing mapping for
+  // the same id is replaced.
+  void MapObjectIds(const kmldom::ElementPtr& element);
+  // Remove every id'ed Object in the given subtree from the id and shared
+  // style maps.  A mapping is removed only if it refers to the Object in the
+  // subtree.
+  void UnmapObjectIds(const kmldom::ElementPtr& element);
+  // Map the Objects, shared styles and link parents of the root alone, not
+  // those of the Features dropped by a ParseFilter.
+  void MapKeptElements();
   string encoding_;
   // TODO: use XmlElement's id map.
   ObjectIdMap object_id_map_;
@@ -177,6 +302,18 @@ class KmlFile : public kmlbase::XmlFile {
   ElementVector link_parent_vector_;
   KmlCache* kml_cache_;
   bool strict_parse_;
+  // The number of threads ParseFromString() may use.  1 is a serial parse.
+  unsigned int parse_threads_;
+  // Set only during a parse with KmlFileOptions::parse_filter.
+  const kmldom::ParseFilter* parse_filter_;
+  // Set only during a parse with KmlFileOptions::string_pool.
+  kmlbase::StringPool* parse_string_pool_;
+  // NULL unless created with CreateFromSource().
+  kmldom::SourceBufferPtr source_buffer_;
+  // NULL unless created with KmlFileOptions::intern_strings.
+  boost::scoped_ptr<kmlbase::StringPool> string_pool_;
+  // NULL until the first GetTimeIndex().
+  boost::scoped_ptr<TimeIndex> time_index_;
   LIBKML_DISALLOW_EVIL_CONSTRUCTORS(KmlFile);
 };
 
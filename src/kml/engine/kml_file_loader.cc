@@ -0,0 +1,249 @@
+// Copyright 2008, Google Inc. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//  3. Neither the name of Google Inc. nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// This file contains the implementation of the KmlFileLoader class.
+
+#include "kml/engine/kml_file_loader.h"
+#include "boost/scoped_ptr.hpp"
+#include "kml/base/file.h"
+#include "kml/base/parallel.h"
+#include "kml/base/referent.h"
+#include "kml/base/string_pool.h"
+
+using kmlbase::MutexLock;
+using kmlbase::StringPool;
+
+namespace kmlengine {
+
+static void DeleteStringPool(void* string_pool) {
+  delete static_cast<StringPool*>(string_pool);
+}
+
+// This ParallelTask loads the file of each index and hands the files to the
+// observer in order.  Whichever thread finishes the next file due hands on
+// it and any following files already loaded.
+class LoadFilesTask : public kmlbase::ParallelTask {
+ public:
+  LoadFilesTask(const std::vector<string>& paths,
+                KmlFileLoadObserver* observer, size_t max_pending_bytes,
+                kmlbase::ThreadLocal* string_pools)
+    : paths_(paths),
+      observer_(observer),
+      max_pending_bytes_(max_pending_bytes),
+      string_pools_(string_pools),
+      loaded_(paths.size()),
+      next_(0),
+      pending_bytes_(0),
+      handing_on_(false),
+      stopped_(false),
+      failed_(false) {
+  }
+
+  virtual void Run(size_t index) {
+    if (!WaitForRoom(index)) {
+      return;
+    }
+    string data;
+    string errors;
+    KmlFile* kml_file = NULL;
+    if (!kmlbase::File::ReadFileToString(paths_[index], &data)) {
+      errors = "could not read " + paths_[index];
+    } else {
+      AddPendingBytes(data.size());
+      if (string_pools_) {
+        KmlFileOptions options;
+        options.string_pool = GetStringPool();
+        kml_file = KmlFile::CreateFromParse(data, options, &errors);
+      } else {
+        kml_file = KmlFile::CreateFromParse(data, &errors);
+      }
+      if (!kml_file && errors.empty()) {
+        errors = "could not parse " + paths_[index];
+      }
+    }
+    Finish(index, kml_file, &errors, data.size());
+  }
+
+  // Returns true if every file was loaded and handed on.
+  bool succeeded() const {
+    return !stopped_ && !failed_ && next_ == loaded_.size();
+  }
+
+ private:
+  // A file loaded but not yet handed on.
+  struct LoadedFile {
+    LoadedFile() : done(false), bytes(0) {}
+    bool done;
+    KmlFilePtr kml_file;
+    string errors;
+    size_t bytes;
+  };
+
+  // This waits while the loaded files held amount to the cap unless the
+  // given file is the next due.  This returns false if the load stopped.
+  bool WaitForRoom(size_t index) {
+    MutexLock lock(&mutex_);
+    while (!stopped_ && max_pending_bytes_ > 0 &&
+           pending_bytes_ >= max_pending_bytes_ && index != next_) {
+      changed_.Wait(&mutex_);
+    }
+    return !stopped_;
+  }
+
+  void AddPendingBytes(size_t bytes) {
+    MutexLock lock(&mutex_);
+    pending_bytes_ += bytes;
+  }
+
+  StringPool* GetStringPool() {
+    StringPool* string_pool = static_cast<StringPool*>(string_pools_->get());
+    if (!string_pool) {
+      string_pool = new StringPool;
+      string_pools_->set(string_pool);
+    }
+    return string_pool;
+  }
+
+  // This saves the given file and, unless another thread is doing so, hands
+  // on each file due which is done.  The observer is called without the
+  // mutex held.  Each KmlFilePtr is only copied with the mutex held or by
+  // the one thread handing it on such that its count is never touched by
+  // two threads at once.
+  void Finish(size_t index, KmlFile* kml_file, string* errors,
+              size_t bytes) {
+    mutex_.Lock();
+    LoadedFile& loaded_file = loaded_[index];
+    loaded_file.kml_file = kml_file;
+    loaded_file.errors.swap(*errors);
+    loaded_file.bytes = bytes;
+    loaded_file.done = true;
+    if (handing_on_) {
+      mutex_.Unlock();
+      return;
+    }
+    handing_on_ = true;
+    while (!stopped_ && next_ < loaded_.size() && loaded_[next_].done) {
+      const size_t next = next_;
+      KmlFilePtr next_kml_file;
+      next_kml_file.swap(loaded_[next].kml_file);
+      string next_errors;
+      next_errors.swap(loaded_[next].errors);
+      mutex_.Unlock();
+      const bool keep_going = observer_->FileLoaded(next, paths_[next],
+                                                    next_kml_file,
+                                                    next_errors);
+      const bool failed = !next_kml_file;
+      next_kml_file = NULL;
+      mutex_.Lock();
+      pending_bytes_ -= loaded_[next].bytes;
+      ++next_;
+      failed_ = failed_ || failed;
+      stopped_ = !keep_going;
+      changed_.NotifyAll();
+    }
+    handing_on_ = false;
+    mutex_.Unlock();
+  }
+
+  const std::vector<string>& paths_;
+  KmlFileLoadObserver* observer_;
+  const size_t max_pending_bytes_;
+  // NULL unless interning.  Holds a StringPool per thread.
+  kmlbase::ThreadLocal* string_pools_;
+  // All below are guarded by mutex_.
+  kmlbase::Mutex mutex_;
+  kmlbase::ConditionVariable changed_;
+  std::vector<LoadedFile> loaded_;
+  // The index of the next file to hand on.
+  size_t next_;
+  size_t pending_bytes_;
+  // True while a thread is handing on files.
+  bool handing_on_;
+  bool stopped_;
+  bool failed_;
+};
+
+bool KmlFileLoader::Load(const std::vector<string>& paths,
+                         KmlFileLoadObserver* observer) const {
+  if (!observer) {
+    return false;
+  }
+  const unsigned int num_threads =
+      num_threads_ > 0 ? num_threads_ : kmlbase::GetProcessorCount();
+  // The global reference count setting is the application's to make.
+  boost::scoped_ptr<kmlbase::ThreadLocal> string_pools;
+  if (intern_strings_ &&
+      (num_threads == 1 || kmlbase::Referent::get_thread_safe_ref_count())) {
+    string_pools.reset(new kmlbase::ThreadLocal(DeleteStringPool));
+  }
+  LoadFilesTask load_files_task(paths, observer, max_pending_bytes_,
+                                string_pools.get());
+  kmlbase::RunParallel(&load_files_task, paths.size(), num_threads);
+  if (string_pools) {
+    // The pools of the other threads went with them.
+    DeleteStringPool(string_pools->get());
+    string_pools->set(NULL);
+  }
+  return load_files_task.succeeded();
+}
+
+// This saves each file and error string by index.
+class SavingLoadObserver : public KmlFileLoadObserver {
+ public:
+  SavingLoadObserver(std::vector<KmlFilePtr>* kml_files,
+                     std::vector<string>* errors)
+    : kml_files_(kml_files), errors_(errors) {}
+
+  virtual bool FileLoaded(size_t index, const string& path,
+                          const KmlFilePtr& kml_file, const string& errors) {
+    (*kml_files_)[index] = kml_file;
+    if (errors_) {
+      (*errors_)[index] = errors;
+    }
+    return true;
+  }
+
+ private:
+  std::vector<KmlFilePtr>* kml_files_;
+  std::vector<string>* errors_;
+};
+
+bool KmlFileLoader::LoadAll(const std::vector<string>& paths,
+                            std::vector<KmlFilePtr>* kml_files,
+                            std::vector<string>* errors) const {
+  if (!kml_files) {
+    return false;
+  }
+  kml_files->clear();
+  kml_files->resize(paths.size());
+  if (errors) {
+    errors->clear();
+    errors->resize(paths.size());
+  }
+  SavingLoadObserver saving_load_observer(kml_files, errors);
+  return Load(paths, &saving_load_observer);
+}
+
+}  // end namespace kmlengine
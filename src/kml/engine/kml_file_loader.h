@@ -0,0 +1,125 @@
+// Copyright 2008, Google Inc. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//  3. Neither the name of Google Inc. nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// This file contains the declaration of the KmlFileLoader class which loads
+// many KML and KMZ files concurrently.
+
+#ifndef KML_ENGINE_KML_FILE_LOADER_H__
+#define KML_ENGINE_KML_FILE_LOADER_H__
+
+#include <vector>
+#include "kml/base/util.h"
+#include "kml/engine/kml_file.h"
+
+namespace kmlengine {
+
+// A KmlFileLoadObserver is handed each file as KmlFileLoader::Load()
+// finishes it.
+class KmlFileLoadObserver {
+ public:
+  virtual ~KmlFileLoadObserver() {}
+
+  // This is called once for each path in the order of the paths whatever
+  // the order in which the files were loaded, so the index doubles as a
+  // count of the files done.  The kml_file is NULL if the file could not be
+  // read or parsed in which case errors says why.  Calls are never
+  // concurrent but each may come from any of the loading threads.  If this
+  // returns false the load stops: no further file is started and no further
+  // call is made.
+  virtual bool FileLoaded(size_t index, const string& path,
+                          const KmlFilePtr& kml_file,
+                          const string& errors) = 0;
+};
+
+// A KmlFileLoader reads, inflates and parses a list of KML and KMZ files
+// using KmlFile::CreateFromParse() on several threads.  Each thread takes
+// the next file not yet started as it becomes free.  The files are handed
+// to a KmlFileLoadObserver in the order given.  A file loaded ahead of those
+// before it is held until they are done.  The loader can cap the memory so
+// held: once the files waiting to be handed on amount to the cap no further
+// file is started other than the next one due.
+//
+// Intended usage:
+//   KmlFileLoader kml_file_loader;
+//   kml_file_loader.set_max_pending_bytes(256 * 1024 * 1024);
+//   std::vector<KmlFilePtr> kml_files;
+//   std::vector<string> errors;
+//   kml_file_loader.LoadAll(paths, &kml_files, &errors);
+class KmlFileLoader {
+ public:
+  KmlFileLoader()
+    : num_threads_(0),
+      max_pending_bytes_(0),
+      intern_strings_(false) {
+  }
+
+  // The number of threads to load on.  0, the default, means one per
+  // processor.
+  void set_num_threads(unsigned int num_threads) {
+    num_threads_ = num_threads;
+  }
+
+  // The cap on the size of the files loaded but not yet handed to the
+  // observer.  The size of a file is that of its KML or KMZ data as read
+  // (not that of its DOM) and the cap may be passed by the files already
+  // being loaded when it is reached.  0, the default, means no cap.
+  void set_max_pending_bytes(size_t max_pending_bytes) {
+    max_pending_bytes_ = max_pending_bytes;
+  }
+
+  // If true the values held as a kmlbase::InternedString are interned as
+  // with KmlFileOptions::string_pool.  Each loading thread interns
+  // into one StringPool of its own such that the files it loads share their
+  // repeated values without any locking.  As the files then share reference
+  // counted values with files still being loaded a load on more than one
+  // thread only interns if kmlbase::Referent::set_thread_safe_ref_count(true)
+  // was called before any other threads were started.  Otherwise the files
+  // are loaded without interning.  The default is false.
+  void set_intern_strings(bool intern_strings) {
+    intern_strings_ = intern_strings;
+  }
+
+  // This loads each of the given paths handing each file to the observer
+  // in turn.  This returns true if every file was loaded and handed on.
+  bool Load(const std::vector<string>& paths,
+            KmlFileLoadObserver* observer) const;
+
+  // As Load() but each KmlFile, NULL for a file which failed, and each
+  // error string, empty for a file which loaded, is saved by index.  The
+  // errors may be NULL.
+  bool LoadAll(const std::vector<string>& paths,
+               std::vector<KmlFilePtr>* kml_files,
+               std::vector<string>* errors) const;
+
+ private:
+  unsigned int num_threads_;
+  size_t max_pending_bytes_;
+  bool intern_strings_;
+  LIBKML_DISALLOW_EVIL_CONSTRUCTORS(KmlFileLoader);
+};
+
+}  // end namespace kmlengine
+
+#endif  // KML_ENGINE_KML_FILE_LOADER_H__
@@ -0,0 +1,203 @@
+// Copyright 2008, Google Inc. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//  3. Neither the name of Google Inc. nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// This file contains the unit tests for the KmlFileLoader class.
+
+#include "kml/engine/kml_file_loader.h"
+#include "kml/base/file.h"
+#include "kml/base/referent.h"
+#include "kml/dom.h"
+#include "gtest/gtest.h"
+
+#ifndef DATADIR
+#error *** DATADIR must be defined! ***
+#endif
+
+namespace kmlengine {
+
+static const char* const kFiles[] = {
+  "/kml/ge-point.kml",
+  "/kmz/doc.kmz",
+  "/style/allstyles.kml",
+  "/kml/no-such-file.kml",
+  "/kmz/dummy.png",
+  "/kml/golf-style.kml"
+};
+
+// This records the order in which the files are handed on.
+class OrderLoadObserver : public KmlFileLoadObserver {
+ public:
+  OrderLoadObserver() : stop_after_(static_cast<size_t>(-1)) {}
+  virtual bool FileLoaded(size_t index, const string& path,
+                          const KmlFilePtr& kml_file, const string& errors) {
+    indices_.push_back(index);
+    return index != stop_after_;
+  }
+  void set_stop_after(size_t stop_after) {
+    stop_after_ = stop_after;
+  }
+  const std::vector<size_t>& get_indices() const {
+    return indices_;
+  }
+
+ private:
+  size_t stop_after_;
+  std::vector<size_t> indices_;
+};
+
+class KmlFileLoaderTest : public testing::Test {
+ protected:
+  virtual void SetUp() {
+    for (size_t i = 0; i < sizeof(kFiles) / sizeof(kFiles[0]); ++i) {
+      paths_.push_back(string(DATADIR) + kFiles[i]);
+    }
+  }
+
+  // This returns the paths of the readable KML and KMZ files count times.
+  std::vector<string> GetGoodPaths(int count) const {
+    std::vector<string> good_paths;
+    for (int i = 0; i < count; ++i) {
+      good_paths.push_back(paths_[0]);
+      good_paths.push_back(paths_[1]);
+      good_paths.push_back(paths_[2]);
+      good_paths.push_back(paths_[5]);
+    }
+    return good_paths;
+  }
+
+  std::vector<string> paths_;
+  KmlFileLoader kml_file_loader_;
+};
+
+TEST_F(KmlFileLoaderTest, TestLoadAll) {
+  std::vector<KmlFilePtr> kml_files;
+  std::vector<string> errors;
+  kml_file_loader_.set_num_threads(4);
+  // A file which cannot be read or parsed fails the load as a whole.
+  ASSERT_FALSE(kml_file_loader_.LoadAll(paths_, &kml_files, &errors));
+  ASSERT_EQ(paths_.size(), kml_files.size());
+  ASSERT_EQ(paths_.size(), errors.size());
+  for (size_t i = 0; i < paths_.size(); ++i) {
+    string data;
+    ASSERT_TRUE(kmlbase::File::ReadFileToString(paths_[i], &data) ||
+                i == 3);
+    KmlFilePtr expected = KmlFile::CreateFromParse(data, NULL);
+    if (expected) {
+      ASSERT_TRUE(kml_files[i]);
+      ASSERT_TRUE(errors[i].empty());
+      ASSERT_EQ(kmldom::SerializePretty(expected->get_root()),
+                kmldom::SerializePretty(kml_files[i]->get_root()));
+    } else {
+      ASSERT_FALSE(kml_files[i]);
+      ASSERT_FALSE(errors[i].empty());
+    }
+  }
+  ASSERT_TRUE(kml_files[1]);  // The KMZ.
+  ASSERT_FALSE(kml_files[3]);
+  ASSERT_FALSE(kml_files[4]);
+
+  ASSERT_TRUE(kml_file_loader_.LoadAll(GetGoodPaths(3), &kml_files, NULL));
+  ASSERT_EQ(static_cast<size_t>(12), kml_files.size());
+
+  // Nothing to load.
+  ASSERT_TRUE(kml_file_loader_.LoadAll(std::vector<string>(), &kml_files,
+                                       &errors));
+  ASSERT_TRUE(kml_files.empty());
+  ASSERT_FALSE(kml_file_loader_.LoadAll(paths_, NULL, NULL));
+}
+
+TEST_F(KmlFileLoaderTest, TestOrder) {
+  // The files are handed on in order whichever thread loads them.
+  const std::vector<string> good_paths = GetGoodPaths(25);
+  const unsigned int kThreads[] = { 1, 2, 8 };
+  for (size_t t = 0; t < sizeof(kThreads) / sizeof(kThreads[0]); ++t) {
+    OrderLoadObserver order_load_observer;
+    kml_file_loader_.set_num_threads(kThreads[t]);
+    ASSERT_TRUE(kml_file_loader_.Load(good_paths, &order_load_observer));
+    const std::vector<size_t>& indices = order_load_observer.get_indices();
+    ASSERT_EQ(good_paths.size(), indices.size());
+    for (size_t i = 0; i < indices.size(); ++i) {
+      ASSERT_EQ(i, indices[i]);
+    }
+  }
+  ASSERT_FALSE(kml_file_loader_.Load(good_paths, NULL));
+}
+
+TEST_F(KmlFileLoaderTest, TestStop) {
+  OrderLoadObserver order_load_observer;
+  order_load_observer.set_stop_after(5);
+  kml_file_loader_.set_num_threads(4);
+  ASSERT_FALSE(kml_file_loader_.Load(GetGoodPaths(25),
+                                     &order_load_observer));
+  ASSERT_EQ(static_cast<size_t>(6), order_load_observer.get_indices().size());
+}
+
+TEST_F(KmlFileLoaderTest, TestMaxPendingBytes) {
+  // The smallest cap holds at most the next file due and those already
+  // started.
+  const std::vector<string> good_paths = GetGoodPaths(25);
+  OrderLoadObserver order_load_observer;
+  kml_file_loader_.set_num_threads(8);
+  kml_file_loader_.set_max_pending_bytes(1);
+  ASSERT_TRUE(kml_file_loader_.Load(good_paths, &order_load_observer));
+  ASSERT_EQ(good_paths.size(), order_load_observer.get_indices().size());
+}
+
+// This returns the Placemark of ge-point.kml.
+static kmldom::PlacemarkPtr GetPlacemark(const KmlFilePtr& kml_file) {
+  kmldom::KmlPtr kml = kmldom::AsKml(kml_file->get_root());
+  return kmldom::AsPlacemark(
+      kmldom::AsDocument(kml->get_feature())->get_feature_array_at(0));
+}
+
+TEST_F(KmlFileLoaderTest, TestInternStrings) {
+  // Files loaded on the same thread share their repeated values.
+  std::vector<string> two_paths(2, paths_[0]);
+  std::vector<KmlFilePtr> kml_files;
+  kml_file_loader_.set_num_threads(1);
+  kml_file_loader_.set_intern_strings(true);
+  ASSERT_TRUE(kml_file_loader_.LoadAll(two_paths, &kml_files, NULL));
+  kmldom::PlacemarkPtr p0 = GetPlacemark(kml_files[0]);
+  kmldom::PlacemarkPtr p1 = GetPlacemark(kml_files[1]);
+  ASSERT_EQ(string("#msn_ylw-pushpin"), p0->get_styleurl());
+  ASSERT_EQ(p0->get_styleurl().data(), p1->get_styleurl().data());
+
+  // Interning on several threads needs thread-safe reference counts which
+  // the loader never turns on itself.  Without them the files are loaded
+  // without interning.
+  ASSERT_FALSE(kmlbase::Referent::get_thread_safe_ref_count());
+  kml_file_loader_.set_num_threads(4);
+  ASSERT_TRUE(kml_file_loader_.LoadAll(GetGoodPaths(10), &kml_files, NULL));
+  ASSERT_FALSE(kmlbase::Referent::get_thread_safe_ref_count());
+  kml_files.clear();
+  kmlbase::Referent::set_thread_safe_ref_count(true);
+  const std::vector<string> good_paths = GetGoodPaths(10);
+  ASSERT_TRUE(kml_file_loader_.LoadAll(good_paths, &kml_files, NULL));
+  ASSERT_EQ(good_paths.size(), kml_files.size());
+  kml_files.clear();
+  kmlbase::Referent::set_thread_safe_ref_count(false);
+}
+
+}  // end namespace kmlengine
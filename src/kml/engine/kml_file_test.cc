@@ -29,10 +29,15 @@
 #include <sstream>
 #include "kml/base/file.h"
 #include "kml/base/net_cache.h"
+#include "kml/base/parallel.h"
+#include "kml/base/referent.h"
 #include "kml/base/tempfile.h"
 #include "gtest/gtest.h"
 #include "kml/dom.h"
+#include "kml/engine/bbox_parse_filter.h"
 #include "kml/engine/kml_cache.h"
+#include "kml/engine/style_resolver.h"
+#include "kml/engine/update.h"
 
 // The following define is a convenience for testing inside Google.
 #ifdef GOOGLE_INTERNAL
@@ -468,4 +473,529 @@ TEST_F(KmlFileTest, TestBasicSerializeToOstream) {
   ASSERT_EQ(kExpected, kActual);
 }
 
+TEST_F(KmlFileTest, TestCreateFromParseInterned) {
+  const string kKml(
+      "<kml><Document>"
+      "<Placemark id=\"p0\"><styleUrl>#s</styleUrl></Placemark>"
+      "<Placemark id=\"p1\"><styleUrl>#s</styleUrl></Placemark>"
+      "</Document></kml>");
+  KmlFileOptions options;
+  options.intern_strings = true;
+  string errors;
+  kml_file_ = KmlFile::CreateFromParse(kKml, options, &errors);
+  ASSERT_TRUE(kml_file_);
+  ASSERT_TRUE(errors.empty());
+  kmlbase::StringPool* string_pool = kml_file_->get_string_pool();
+  ASSERT_TRUE(string_pool);
+  ASSERT_EQ(static_cast<size_t>(1), string_pool->size());
+  PlacemarkPtr p0 = kmldom::AsPlacemark(kml_file_->GetObjectById("p0"));
+  PlacemarkPtr p1 = kmldom::AsPlacemark(kml_file_->GetObjectById("p1"));
+  ASSERT_EQ(string("#s"), p0->get_styleurl());
+  ASSERT_EQ(p0->get_styleurl().data(), p1->get_styleurl().data());
+
+  // The pool remains available for use with the InternedString setters.
+  p1->set_styleurl(string_pool->Intern("#s"));
+  ASSERT_EQ(p0->get_styleurl().data(), p1->get_styleurl().data());
+  ASSERT_EQ(static_cast<size_t>(1), string_pool->size());
+
+  string interned_kml;
+  ASSERT_TRUE(kml_file_->SerializeToString(&interned_kml));
+  KmlFilePtr kml_file = KmlFile::CreateFromParse(kKml, NULL);
+  ASSERT_FALSE(kml_file->get_string_pool());
+  string kml;
+  ASSERT_TRUE(kml_file->SerializeToString(&kml));
+  ASSERT_EQ(kml, interned_kml);
+
+  ASSERT_FALSE(KmlFile::CreateFromParse("junk", options, &errors));
+  ASSERT_FALSE(errors.empty());
+}
+
+TEST_F(KmlFileTest, TestCreateFromParseInStringPool) {
+  // Two files parsed with one pool share their repeated values.
+  const string kKml(
+      "<kml><Placemark id=\"p\"><styleUrl>#s</styleUrl></Placemark></kml>");
+  kmlbase::StringPool string_pool;
+  KmlFileOptions options;
+  options.string_pool = &string_pool;
+  kml_file_ = KmlFile::CreateFromParse(kKml, options, NULL);
+  ASSERT_TRUE(kml_file_);
+  KmlFilePtr kml_file = KmlFile::CreateFromParse(kKml, options, NULL);
+  ASSERT_TRUE(kml_file);
+  ASSERT_FALSE(kml_file->get_string_pool());
+  ASSERT_EQ(static_cast<size_t>(1), string_pool.size());
+  ASSERT_EQ(static_cast<size_t>(1), string_pool.get_hit_count());
+  PlacemarkPtr p0 = kmldom::AsPlacemark(kml_file_->GetObjectById("p"));
+  PlacemarkPtr p1 = kmldom::AsPlacemark(kml_file->GetObjectById("p"));
+  ASSERT_EQ(p0->get_styleurl().data(), p1->get_styleurl().data());
+}
+
+TEST_F(KmlFileTest, TestCreateFromParseParallel) {
+  // Build a Document big enough for a parallel parse to split.
+  std::stringstream kml;
+  kml << "<kml><Document>";
+  for (int i = 0; i < 5000; ++i) {
+    if (i % 100 == 0) {
+      kml << "<Style id=\"s" << i << "\"><IconStyle><Icon><href>" << i
+          << ".png</href></Icon></IconStyle></Style>"
+          << "<NetworkLink id=\"n" << i << "\"><Link><href>" << i
+          << ".kml</href></Link></NetworkLink>";
+    }
+    kml << "<Placemark id=\"p" << i << "\"><name>" << i << "</name>"
+        << "<styleUrl>#s" << i / 100 * 100 << "</styleUrl>"
+        << "<Point><coordinates>1,2</coordinates></Point></Placemark>";
+  }
+  kml << "</Document></kml>";
+  KmlFilePtr serial_file = KmlFile::CreateFromParse(kml.str(), NULL);
+  ASSERT_TRUE(serial_file);
+  string serial_kml;
+  ASSERT_TRUE(serial_file->SerializeToString(&serial_kml));
+
+  KmlFileOptions options;
+  options.parse_threads = 4;
+  string errors;
+  kml_file_ = KmlFile::CreateFromParse(kml.str(), options, &errors);
+  ASSERT_TRUE(kml_file_);
+  ASSERT_TRUE(errors.empty());
+  string parallel_kml;
+  ASSERT_TRUE(kml_file_->SerializeToString(&parallel_kml));
+  ASSERT_EQ(serial_kml, parallel_kml);
+
+  ASSERT_TRUE(kml_file_->GetObjectById("p4999"));
+  ASSERT_EQ(kmldom::Type_Placemark,
+            kml_file_->GetObjectById("p4999")->Type());
+  ASSERT_EQ(serial_file->get_shared_style_map().size(),
+            kml_file_->get_shared_style_map().size());
+  ASSERT_TRUE(kml_file_->GetSharedStyleById("s4900"));
+  const ElementVector& serial_link_parents =
+      serial_file->get_link_parent_vector();
+  const ElementVector& link_parents = kml_file_->get_link_parent_vector();
+  ASSERT_EQ(static_cast<size_t>(100), link_parents.size());
+  ASSERT_EQ(serial_link_parents.size(), link_parents.size());
+  // 50 IconStyles and 50 NetworkLinks in document order.
+  for (size_t i = 0; i < link_parents.size(); ++i) {
+    ASSERT_EQ(serial_link_parents[i]->Type(), link_parents[i]->Type());
+    ASSERT_EQ(i % 2 ? kmldom::Type_NetworkLink : kmldom::Type_IconStyle,
+              link_parents[i]->Type());
+    ASSERT_EQ(kmldom::AsObject(serial_link_parents[i])->get_id(),
+              kmldom::AsObject(link_parents[i])->get_id());
+  }
+  ASSERT_EQ(link_parents[99], kml_file_->GetObjectById("n4900"));
+}
+
+// Parses the serialization of kml_file and checks that it is the same as a
+// full serialization of kml_file's DOM.
+static void VerifySerializesAsDom(const KmlFilePtr& kml_file) {
+  string xml;
+  ASSERT_TRUE(kml_file->SerializeToString(&xml));
+  KmlFilePtr reparsed = KmlFile::CreateFromParse(xml, NULL);
+  ASSERT_TRUE(reparsed);
+  ASSERT_EQ(kmldom::SerializePretty(kml_file->get_root()),
+            kmldom::SerializePretty(reparsed->get_root()));
+}
+
+// Creates a KmlFile keeping a SourceBuffer of a copy of the given data.
+static KmlFile* CreateFromSourceString(const string& kml_or_kmz_data) {
+  string data(kml_or_kmz_data);
+  return KmlFile::CreateFromSource(
+      kmldom::SourceBufferPtr(new kmldom::SourceBuffer(&data)),
+      KmlFileOptions(), NULL);
+}
+
+static const char kKeepSourceKml[] =
+    "<kml xmlns=\"http://www.opengis.net/kml/2.2\">\n"
+    "<Document id=\"d\">\n"
+    "  <Placemark id=\"a\"><name>a</name>\n"
+    "    <Point><coordinates>1.50,2.0</coordinates></Point></Placemark>\n"
+    "  <Placemark id=\"b\"><name>b</name><foo>x</foo>"
+    "<description><![CDATA[<b>b</b>]]></description></Placemark>\n"
+    "  <Folder id=\"f\"><Placemark id=\"c\"><name>c</name>"
+    "<Point><coordinates>3,4</coordinates></Point></Placemark></Folder>\n"
+    "</Document></kml>";
+
+TEST_F(KmlFileTest, TestCreateFromSourceUnchanged) {
+  kml_file_ = CreateFromSourceString(kKeepSourceKml);
+  ASSERT_TRUE(kml_file_);
+  string xml;
+  ASSERT_TRUE(kml_file_->SerializeToString(&xml));
+  // The whole <Document> is copied as it appears in the source.
+  const string kml(kKeepSourceKml);
+  const size_t document = kml.find("<Document");
+  ASSERT_NE(string::npos,
+            xml.find(kml.substr(document, kml.rfind("</kml>") - document)));
+  VerifySerializesAsDom(kml_file_);
+}
+
+TEST_F(KmlFileTest, TestCreateFromSourceChanged) {
+  kml_file_ = CreateFromSourceString(kKeepSourceKml);
+  ASSERT_TRUE(kml_file_);
+  PlacemarkPtr c = kmldom::AsPlacemark(kml_file_->GetObjectById("c"));
+  ASSERT_TRUE(c);
+  c->set_name("changed");
+  string xml;
+  ASSERT_TRUE(kml_file_->SerializeToString(&xml));
+  ASSERT_NE(string::npos, xml.find("<name>changed</name>"));
+  // The Placemarks which did not change are still copied from the source.
+  ASSERT_NE(string::npos, xml.find("<coordinates>1.50,2.0</coordinates>"));
+  ASSERT_NE(string::npos, xml.find("<foo>x</foo>"));
+  VerifySerializesAsDom(kml_file_);
+
+  // A change to a child of a Placemark is seen.
+  PlacemarkPtr a = kmldom::AsPlacemark(kml_file_->GetObjectById("a"));
+  kmldom::PointPtr point = kmldom::AsPoint(a->get_geometry());
+  ASSERT_TRUE(point);
+  point->get_coordinates()->add_latlng(5, 6);
+  xml.clear();
+  ASSERT_TRUE(kml_file_->SerializeToString(&xml));
+  ASSERT_EQ(string::npos, xml.find("1.50,2.0"));
+  VerifySerializesAsDom(kml_file_);
+}
+
+static const char kKeepSourceTourKml[] =
+    "<kml xmlns=\"http://www.opengis.net/kml/2.2\"\n"
+    " xmlns:gx=\"http://www.google.com/kml/ext/2.2\">\n"
+    "<Document id=\"d\">\n"
+    "  <gx:Tour id=\"t\"><gx:Playlist id=\"p\">"
+    "<gx:Wait id=\"w\"><gx:duration>1.5</gx:duration></gx:Wait>"
+    "</gx:Playlist></gx:Tour>\n"
+    "</Document></kml>";
+
+TEST_F(KmlFileTest, TestCreateFromSourceAddTourPrimitive) {
+  kml_file_ = CreateFromSourceString(kKeepSourceTourKml);
+  ASSERT_TRUE(kml_file_);
+  kmldom::GxPlaylistPtr playlist =
+      kmldom::AsGxPlaylist(kml_file_->GetObjectById("p"));
+  ASSERT_TRUE(playlist);
+  kmldom::GxWaitPtr wait = KmlFactory::GetFactory()->CreateGxWait();
+  wait->set_id("added");
+  playlist->add_gx_tourprimitive(wait);
+  ASSERT_EQ(playlist, wait->GetParent());
+  string xml;
+  ASSERT_TRUE(kml_file_->SerializeToString(&xml));
+  ASSERT_NE(string::npos, xml.find("<gx:Wait id=\"added\""));
+  VerifySerializesAsDom(kml_file_);
+}
+
+TEST_F(KmlFileTest, TestCreateFromSourceChangeTourPrimitive) {
+  kml_file_ = CreateFromSourceString(kKeepSourceTourKml);
+  ASSERT_TRUE(kml_file_);
+  kmldom::GxWaitPtr wait = kmldom::AsGxWait(kml_file_->GetObjectById("w"));
+  ASSERT_TRUE(wait);
+  wait->set_gx_duration(42);
+  string xml;
+  ASSERT_TRUE(kml_file_->SerializeToString(&xml));
+  ASSERT_NE(string::npos, xml.find("<gx:duration>42</gx:duration>"));
+  ASSERT_EQ(string::npos, xml.find("1.5"));
+  VerifySerializesAsDom(kml_file_);
+}
+
+TEST_F(KmlFileTest, TestCreateFromSourceChangeMisplaced) {
+  // A <Point> is not a legal child of a <Folder> and is kept as a misplaced
+  // child of it.
+  kml_file_ = CreateFromSourceString(
+      "<kml xmlns=\"http://www.opengis.net/kml/2.2\">"
+      "<Folder id=\"f\"><Point id=\"p\">"
+      "<coordinates>1,2</coordinates></Point></Folder></kml>");
+  ASSERT_TRUE(kml_file_);
+  kmldom::PointPtr point = kmldom::AsPoint(kml_file_->GetObjectById("p"));
+  ASSERT_TRUE(point);
+  ASSERT_EQ(kml_file_->GetObjectById("f"), point->GetParent());
+  point->get_coordinates()->add_latlng(5, 6);
+  string xml;
+  ASSERT_TRUE(kml_file_->SerializeToString(&xml));
+  ASSERT_NE(string::npos, xml.find("6,5"));
+  VerifySerializesAsDom(kml_file_);
+}
+
+TEST_F(KmlFileTest, TestCreateFromSourceUpdate) {
+  kml_file_ = CreateFromSourceString(kKeepSourceKml);
+  ASSERT_TRUE(kml_file_);
+  KmlFilePtr update_file = KmlFile::CreateFromParse(
+      "<kml><NetworkLinkControl><Update><targetHref/>"
+      "<Change><Placemark targetId=\"b\"><name>B</name></Placemark></Change>"
+      "<Create><Folder targetId=\"f\"><Placemark id=\"e\"/></Folder></Create>"
+      "<Delete><Placemark targetId=\"a\"/></Delete>"
+      "</Update></NetworkLinkControl></kml>", NULL);
+  ASSERT_TRUE(update_file);
+  kmldom::KmlPtr kml = kmldom::AsKml(update_file->get_root());
+  ProcessUpdate(kml->get_networklinkcontrol()->get_update(), kml_file_);
+  string xml;
+  ASSERT_TRUE(kml_file_->SerializeToString(&xml));
+  ASSERT_NE(string::npos, xml.find("<name>B</name>"));
+  ASSERT_NE(string::npos, xml.find("id=\"e\""));
+  ASSERT_EQ(string::npos, xml.find("id=\"a\""));
+  VerifySerializesAsDom(kml_file_);
+}
+
+TEST_F(KmlFileTest, TestCreateFromSourceFile) {
+  const string kAllStyles = string(DATADIR) + "/style/allstyles.kml";
+  string kml;
+  ASSERT_TRUE(kmlbase::File::ReadFileToString(kAllStyles, &kml));
+  kml_file_ = CreateFromSourceString(kml);
+  ASSERT_TRUE(kml_file_);
+  VerifySerializesAsDom(kml_file_);
+  KmlFilePtr kml_file = KmlFile::CreateFromParse(kml, NULL);
+  ASSERT_TRUE(kml_file);
+  ASSERT_EQ(kmldom::SerializePretty(kml_file->get_root()),
+            kmldom::SerializePretty(kml_file_->get_root()));
+}
+
+TEST_F(KmlFileTest, TestCreateFromSourceKmz) {
+  const string kDocKmz = string(DATADIR) + "/kmz/doc.kmz";
+  string kmz_data;
+  ASSERT_TRUE(kmlbase::File::ReadFileToString(kDocKmz, &kmz_data));
+  kml_file_ = CreateFromSourceString(kmz_data);
+  ASSERT_TRUE(kml_file_);
+  // The source ranges are those of the KML inflated from the archive.
+  const kmldom::SourceSlice& source_range =
+      kml_file_->get_root()->get_source_range();
+  ASSERT_FALSE(source_range.empty());
+  string kml;
+  ASSERT_TRUE(KmzFile::OpenFromString(kmz_data)->ReadKml(&kml));
+  ASSERT_EQ(kml, source_range.get_source_buffer()->get_data());
+  KmlFilePtr kml_file = KmlFile::CreateFromParse(kmz_data, NULL);
+  ASSERT_TRUE(kml_file);
+  ASSERT_EQ(kmldom::SerializePretty(kml_file->get_root()),
+            kmldom::SerializePretty(kml_file_->get_root()));
+}
+
+TEST_F(KmlFileTest, TestCreateFromSourceNull) {
+  ASSERT_FALSE(KmlFile::CreateFromSource(NULL, KmlFileOptions(), NULL));
+}
+
+TEST_F(KmlFileTest, TestCreateFromParseFiltered) {
+  const string kKml(
+      "<kml><Document>"
+      "<Style id=\"s0\"/>"
+      "<Placemark id=\"near\"><styleUrl>#s0</styleUrl>"
+      "<description>d</description>"
+      "<Point><coordinates>1,1</coordinates></Point></Placemark>"
+      "<Placemark id=\"far\">"
+      "<Point><coordinates>100,50</coordinates></Point></Placemark>"
+      "<NetworkLink id=\"nl\"><Link><href>a.kml</href></Link>"
+      "</NetworkLink>"
+      "</Document></kml>");
+  BboxParseFilter parse_filter(Bbox(10, -10, 10, -10));
+  parse_filter.SkipElement(kmldom::Type_description);
+  KmlFileOptions options;
+  options.parse_filter = &parse_filter;
+  kml_file_ = KmlFile::CreateFromParse(kKml, options, NULL);
+  ASSERT_TRUE(kml_file_);
+  ASSERT_TRUE(kml_file_->GetObjectById("near"));
+  ASSERT_FALSE(kml_file_->GetObjectById("far"));
+  ASSERT_TRUE(kml_file_->GetObjectById("nl"));
+  ASSERT_TRUE(kml_file_->GetSharedStyleById("s0"));
+  ASSERT_EQ(static_cast<size_t>(1),
+            kml_file_->get_link_parent_vector().size());
+  PlacemarkPtr placemark =
+      kmldom::AsPlacemark(kml_file_->GetObjectById("near"));
+  ASSERT_FALSE(placemark->has_description());
+
+  // A Feature dropped by the filter takes its ids and links with it.
+  BboxParseFilter far_filter(Bbox(60, 40, 110, 90));
+  options.parse_filter = &far_filter;
+  kml_file_ = KmlFile::CreateFromParse(kKml, options, NULL);
+  ASSERT_TRUE(kml_file_);
+  ASSERT_FALSE(kml_file_->GetObjectById("near"));
+  ASSERT_TRUE(kml_file_->GetObjectById("far"));
+  ASSERT_TRUE(kml_file_->GetObjectById("nl"));
+  ASSERT_TRUE(kml_file_->GetObjectById("s0"));
+
+  // A parse error is reported as for CreateFromParse().
+  string errors;
+  ASSERT_FALSE(KmlFile::CreateFromParse("<kml><Placemark>", options,
+                                         &errors));
+  ASSERT_FALSE(errors.empty());
+}
+
+// This drops each Feature named "drop".
+class DropNamedParseFilter : public kmldom::ParseFilter {
+ public:
+  virtual bool KeepsFeature(const kmldom::FeaturePtr& feature) const {
+    return feature->get_name() != "drop";
+  }
+};
+
+TEST_F(KmlFileTest, TestCreateFromParseFilteredDuplicateIds) {
+  // The later of each pair of duplicate ids is dropped and the earlier one
+  // which was kept stays mapped.
+  const string kKml(
+      "<kml><Document>"
+      "<Style id=\"s\"><LineStyle><width>1</width></LineStyle></Style>"
+      "<Placemark id=\"p\"><name>keep</name></Placemark>"
+      "<Placemark id=\"q\"><name>keep</name></Placemark>"
+      "<Document><name>drop</name>"
+      "<Style id=\"s\"><LineStyle><width>2</width></LineStyle></Style>"
+      "<Placemark id=\"p\"/></Document>"
+      "<Placemark id=\"x\"><name>drop</name></Placemark>"
+      "</Document></kml>");
+  DropNamedParseFilter parse_filter;
+  KmlFileOptions options;
+  options.parse_filter = &parse_filter;
+  kml_file_ = KmlFile::CreateFromParse(kKml, options, NULL);
+  ASSERT_TRUE(kml_file_);
+  kmldom::KmlPtr kml = kmldom::AsKml(kml_file_->get_root());
+  ASSERT_TRUE(kml);
+  kmldom::DocumentPtr document = kmldom::AsDocument(kml->get_feature());
+  ASSERT_TRUE(document);
+  ASSERT_EQ(static_cast<size_t>(2), document->get_feature_array_size());
+  ASSERT_EQ(document->get_feature_array_at(0),
+            kml_file_->GetObjectById("p"));
+  ASSERT_EQ(document->get_feature_array_at(1),
+            kml_file_->GetObjectById("q"));
+  ASSERT_FALSE(kml_file_->GetObjectById("x"));
+  ASSERT_EQ(document->get_styleselector_array_at(0),
+            kml_file_->GetObjectById("s"));
+  ASSERT_EQ(document->get_styleselector_array_at(0),
+            kml_file_->GetSharedStyleById("s"));
+}
+
+TEST_F(KmlFileTest, TestCreateFromSourceWithOptions) {
+  // A kept source may be interned and filtered.
+  const string kKml(
+      "<kml><Document><Placemark id=\"p\"><styleUrl>#s</styleUrl>"
+      "<description>d</description></Placemark></Document></kml>");
+  kmldom::ParseFilter parse_filter;
+  parse_filter.SkipElement(kmldom::Type_description);
+  KmlFileOptions options;
+  options.intern_strings = true;
+  options.parse_filter = &parse_filter;
+  string kml(kKml);
+  kml_file_ = KmlFile::CreateFromSource(
+      kmldom::SourceBufferPtr(new kmldom::SourceBuffer(&kml)), options, NULL);
+  ASSERT_TRUE(kml_file_);
+  ASSERT_TRUE(kml_file_->get_string_pool());
+  PlacemarkPtr placemark = kmldom::AsPlacemark(kml_file_->GetObjectById("p"));
+  ASSERT_TRUE(placemark);
+  ASSERT_EQ(string("#s"), placemark->get_styleurl());
+  ASSERT_FALSE(placemark->has_description());
+  string xml;
+  ASSERT_TRUE(kml_file_->SerializeToString(&xml));
+  ASSERT_EQ(string::npos, xml.find("description"));
+}
+
+TEST_F(KmlFileTest, TestCreateWithUnsupportedOptions) {
+  const string kKml("<kml><Placemark id=\"p\"/></kml>");
+  kmlbase::StringPool string_pool;
+  kmldom::ParseFilter parse_filter;
+  string errors;
+
+  // Two pools to intern in.
+  KmlFileOptions options;
+  options.intern_strings = true;
+  options.string_pool = &string_pool;
+  ASSERT_FALSE(KmlFile::CreateFromParse(kKml, options, &errors));
+  ASSERT_FALSE(errors.empty());
+
+  // A parallel parse with any other option.
+  options = KmlFileOptions();
+  options.parse_threads = 2;
+  options.intern_strings = true;
+  errors.clear();
+  ASSERT_FALSE(KmlFile::CreateFromParse(kKml, options, &errors));
+  ASSERT_FALSE(errors.empty());
+  options.intern_strings = false;
+  options.string_pool = &string_pool;
+  errors.clear();
+  ASSERT_FALSE(KmlFile::CreateFromParse(kKml, options, &errors));
+  ASSERT_FALSE(errors.empty());
+  options.string_pool = NULL;
+  options.parse_filter = &parse_filter;
+  errors.clear();
+  ASSERT_FALSE(KmlFile::CreateFromParse(kKml, options, &errors));
+  ASSERT_FALSE(errors.empty());
+
+  // A parallel parse keeping the source.
+  options.parse_filter = NULL;
+  string kml(kKml);
+  errors.clear();
+  ASSERT_FALSE(KmlFile::CreateFromSource(
+      kmldom::SourceBufferPtr(new kmldom::SourceBuffer(&kml)), options,
+      &errors));
+  ASSERT_FALSE(errors.empty());
+
+  // A parallel parse alone is fine.
+  kml_file_ = KmlFile::CreateFromParse(kKml, options, NULL);
+  ASSERT_TRUE(kml_file_);
+  ASSERT_TRUE(kml_file_->GetObjectById("p"));
+}
+
+// This ParallelTask reads one KmlFile from several threads.  Each Run()
+// walks the Document, finds a Placemark by id, resolves its style and
+// serializes the lot.  The results are saved by index to compare with those
+// of a serial run.
+class ReadKmlFileTask : public kmlbase::ParallelTask {
+ public:
+  ReadKmlFileTask(const KmlFilePtr& kml_file, size_t count)
+    : kml_file_(kml_file), results_(count) {}
+
+  virtual void Run(size_t index) {
+    // Each thread copies and releases its own references to the shared DOM.
+    KmlFilePtr kml_file = kml_file_;
+    const kmldom::DocumentPtr document = kmldom::AsDocument(
+        kmldom::AsKml(kml_file->get_root())->get_feature());
+    string& result = results_[index];
+    for (size_t i = 0; i < document->get_feature_array_size(); ++i) {
+      result.append(document->get_feature_array_at(i)->get_name());
+    }
+    std::stringstream id;
+    id << "p" << index % document->get_feature_array_size();
+    PlacemarkPtr placemark =
+        kmldom::AsPlacemark(kml_file->GetObjectById(id.str()));
+    result.append(kmldom::SerializeRaw(placemark));
+    result.append(kmldom::SerializeRaw(CreateResolvedStyle(
+        placemark, kml_file, kmldom::STYLESTATE_HIGHLIGHT)));
+    string xml;
+    kml_file->SerializeToString(&xml);
+    result.append(xml);
+  }
+
+  const string& get_result(size_t index) const {
+    return results_[index];
+  }
+
+ private:
+  const KmlFilePtr kml_file_;
+  std::vector<string> results_;
+};
+
+TEST_F(KmlFileTest, TestReadFromThreads) {
+  std::stringstream kml;
+  kml << "<kml><Document>"
+      << "<Style id=\"n\"><IconStyle><scale>1</scale></IconStyle></Style>"
+      << "<Style id=\"h\"><IconStyle><scale>2</scale></IconStyle></Style>"
+      << "<StyleMap id=\"m\">"
+      << "<Pair><key>normal</key><styleUrl>#n</styleUrl></Pair>"
+      << "<Pair><key>highlight</key><styleUrl>#h</styleUrl></Pair>"
+      << "</StyleMap>";
+  for (int i = 0; i < 100; ++i) {
+    kml << "<Placemark id=\"p" << i << "\"><name>" << i << "</name>"
+        << "<styleUrl>#m</styleUrl><Style><LabelStyle><scale>" << i
+        << "</scale></LabelStyle></Style>"
+        << "<Point><coordinates>" << i << ",2</coordinates></Point>"
+        << "</Placemark>";
+  }
+  kml << "</Document></kml>";
+  kml_file_ = KmlFile::CreateFromParse(kml.str(), NULL);
+  ASSERT_TRUE(kml_file_);
+
+  const size_t kCount = 64;
+  ReadKmlFileTask serial_task(kml_file_, kCount);
+  kmlbase::RunParallel(&serial_task, kCount, 1);
+
+  kmlbase::Referent::set_thread_safe_ref_count(true);
+  ReadKmlFileTask task(kml_file_, kCount);
+  kmlbase::RunParallel(&task, kCount, 8);
+  kmlbase::Referent::set_thread_safe_ref_count(false);
+
+  for (size_t i = 0; i < kCount; ++i) {
+    ASSERT_EQ(serial_task.get_result(i), task.get_result(i));
+  }
+  // Serialization leaves the DOM as it was.
+  ASSERT_FALSE(kml_file_->get_root()->GetXmlns());
+
+  // Every reference taken by the threads was released: the KmlFile is held
+  // only by the test and the two tasks.
+  ASSERT_EQ(3, kml_file_->get_ref_count());
+}
+
 }  // end namespace kmlengine
@@ -0,0 +1,772 @@
+// Copyright 2008, Google Inc. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//  3. Neither the name of Google Inc. nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// This file contains the implementation of the KmlSnapshot and
+// KmlSnapshotSerializer classes.
+
+#include "kml/engine/kml_snapshot.h"
+#include <algorithm>
+#include <cstring>
+#ifndef WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#include "kml/base/attributes.h"
+#include "kml/base/color32.h"
+#include "kml/base/file.h"
+#include "kml/dom/kml_cast.h"
+#include "kml/dom/kml_factory.h"
+#include "kml/engine/kml_file.h"
+
+using kmlbase::Attributes;
+using kmlbase::Vec3;
+using kmldom::ElementPtr;
+using kmldom::KmlDomType;
+using kmldom::KmlFactory;
+using kmldom::parser_observer_vector_t;
+
+namespace kmlengine {
+
+// The snapshot layout is as follows.  All integers are in host byte order.
+//   header:
+//     char[4] magic, uint32 version, uint32 byte order mark,
+//     uint32 string count, uint32 encoding string index,
+//     uint32 id count, uint64 string offsets offset,
+//     uint64 string data offset, uint64 string data size,
+//     uint64 body offset, uint64 body size, uint64 id index offset
+//   string offsets: uint64[string count], each relative to string data
+//   string data: for each string uint32 size followed by the bytes
+//   body: a sequence of records, each starting with a uint8 record tag
+//   id index: sorted by id string, uint32 id string index, uint32 type id,
+//             uint32 flags, uint64 body offset
+static const char kMagic[4] = { 'K', 'M', 'L', 'S' };
+static const uint32_t kVersion = 2;
+static const uint32_t kByteOrderMark = 0x01020304;
+static const size_t kHeaderSize = 4 + 5 * 4 + 6 * 8;
+static const size_t kIdEntrySize = 3 * 4 + 8;
+
+// The id index entry flags.
+static const uint32_t kIdFlagSharedStyle = 1;
+
+// The body record tags.
+enum {
+  // uint32 type id, uint32 attribute count, uint32 key index,
+  // uint32 value index for each attribute.
+  kRecordBegin = 1,
+  // No payload.
+  kRecordEnd,
+  // uint32 type id, uint32 value index.
+  kRecordField,
+  // uint8 maybe_quote, uint32 content index.
+  kRecordContent,
+  // uint32 type id, uint32 AABBGGRR.
+  kRecordColor,
+  // uint64 count, double[count * 3] lon,lat,alt, uint8[count] has altitude.
+  kRecordCoordinates
+};
+
+// These are the elements the parser creates from their own character data.
+// See KmlHandler::EndElement().
+static bool ParsesOwnCharData(int type_id) {
+  return type_id == kmldom::Type_Snippet ||
+         type_id == kmldom::Type_linkSnippet ||
+         type_id == kmldom::Type_SimpleData;
+}
+
+KmlSnapshotSerializer::KmlSnapshotSerializer() {
+}
+
+// private
+const ElementPtr& KmlSnapshotSerializer::GetPrototype(int type_id) {
+  if (type_id < 0) {
+    type_id = kmldom::Type_Unknown;
+  }
+  if (static_cast<size_t>(type_id) >= prototypes_.size()) {
+    prototypes_.resize(type_id + 1);
+  }
+  if (!prototypes_[type_id]) {
+    prototypes_[type_id] = KmlFactory::GetFactory()->CreateElementById(
+        static_cast<KmlDomType>(type_id));
+  }
+  return prototypes_[type_id];
+}
+
+// private
+uint32_t KmlSnapshotSerializer::Intern(const string& s) {
+  std::map<string, uint32_t>::const_iterator find = string_map_.find(s);
+  if (find != string_map_.end()) {
+    return find->second;
+  }
+  uint32_t index = static_cast<uint32_t>(strings_.size());
+  strings_.push_back(s);
+  string_map_[s] = index;
+  return index;
+}
+
+void KmlSnapshotSerializer::PutUint8(uint8_t value) {
+  body_.push_back(static_cast<char>(value));
+}
+
+void KmlSnapshotSerializer::PutUint32(uint32_t value) {
+  body_.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void KmlSnapshotSerializer::PutUint64(uint64_t value) {
+  body_.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void KmlSnapshotSerializer::PutDouble(double value) {
+  body_.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void KmlSnapshotSerializer::BeginById(int type_id,
+                                      const Attributes& attributes) {
+  FlushVec3s();
+  const size_t offset = body_.size();
+  PutUint8(kRecordBegin);
+  PutUint32(static_cast<uint32_t>(type_id));
+  PutUint32(static_cast<uint32_t>(attributes.GetSize()));
+  string id;
+  kmlbase::StringMapIterator iter = attributes.CreateIterator();
+  for (; !iter.AtEnd(); iter.Advance()) {
+    PutUint32(Intern(iter.Data().first));
+    PutUint32(Intern(iter.Data().second));
+    if (iter.Data().first == "id") {
+      id = iter.Data().second;
+    }
+  }
+  // Only Objects have an id attribute.  An unknown attribute named "id" on a
+  // non-Object is not mapped by the ObjectIdParserObserver.
+  if (!id.empty() && kmldom::AsObject(GetPrototype(type_id))) {
+    IdEntry entry;
+    entry.id = Intern(id);
+    entry.type_id = static_cast<uint32_t>(type_id);
+    // A shared style is a StyleSelector child of a Document.
+    entry.flags = !open_.empty() &&
+                  open_.top() == kmldom::Type_Document &&
+                  kmldom::AsStyleSelector(GetPrototype(type_id)) ?
+                  kIdFlagSharedStyle : 0;
+    entry.offset = offset;
+    id_index_.push_back(entry);
+  }
+  open_.push(type_id);
+}
+
+void KmlSnapshotSerializer::End() {
+  FlushVec3s();
+  PutUint8(kRecordEnd);
+  if (!open_.empty()) {
+    open_.pop();
+  }
+}
+
+void KmlSnapshotSerializer::SaveStringFieldById(int type_id, string value) {
+  FlushVec3s();
+  PutUint8(kRecordField);
+  PutUint32(static_cast<uint32_t>(type_id));
+  PutUint32(Intern(value));
+}
+
+void KmlSnapshotSerializer::SaveContent(const string& content,
+                                        bool maybe_quote) {
+  FlushVec3s();
+  PutUint8(kRecordContent);
+  PutUint8(maybe_quote ? 1 : 0);
+  PutUint32(Intern(content));
+}
+
+void KmlSnapshotSerializer::SaveVec3(const Vec3& vec3) {
+  vec3s_.push_back(vec3);
+}
+
+void KmlSnapshotSerializer::SaveColor(int type_id,
+                                      const kmlbase::Color32& color) {
+  FlushVec3s();
+  PutUint8(kRecordColor);
+  PutUint32(static_cast<uint32_t>(type_id));
+  PutUint32(color.get_color_abgr());
+}
+
+void KmlSnapshotSerializer::EndElementArray(int type_id) {
+  FlushVec3s();
+}
+
+// Coordinates are gathered up and emitted as one contiguous record.
+void KmlSnapshotSerializer::FlushVec3s() {
+  if (vec3s_.empty()) {
+    return;
+  }
+  PutUint8(kRecordCoordinates);
+  PutUint64(vec3s_.size());
+  for (size_t i = 0; i < vec3s_.size(); ++i) {
+    PutDouble(vec3s_[i].get_longitude());
+    PutDouble(vec3s_[i].get_latitude());
+    PutDouble(vec3s_[i].get_altitude());
+  }
+  for (size_t i = 0; i < vec3s_.size(); ++i) {
+    PutUint8(vec3s_[i].has_altitude() ? 1 : 0);
+  }
+  vec3s_.clear();
+}
+
+// This orders IdEntries by their id string.
+class KmlSnapshotSerializer::IdEntryLess {
+ public:
+  IdEntryLess(const std::vector<string>& strings)
+    : strings_(strings) {}
+  bool operator()(const IdEntry& a, const IdEntry& b) const {
+    return strings_[a.id] < strings_[b.id];
+  }
+ private:
+  const std::vector<string>& strings_;
+};
+
+static void AppendUint32(uint32_t value, string* output) {
+  output->append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+static void AppendUint64(uint64_t value, string* output) {
+  output->append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void KmlSnapshotSerializer::Finish(const string& encoding, string* output) {
+  FlushVec3s();
+  const uint32_t encoding_index = Intern(encoding);
+
+  // Stable sort keeps duplicate ids in document order such that the last
+  // one wins in KmlSnapshot::FindId() as it does in the ObjectIdMap.
+  std::stable_sort(id_index_.begin(), id_index_.end(),
+                   IdEntryLess(strings_));
+
+  uint64_t string_data_size = 0;
+  for (size_t i = 0; i < strings_.size(); ++i) {
+    string_data_size += 4 + strings_[i].size();
+  }
+  const uint64_t string_offsets_offset = kHeaderSize;
+  const uint64_t string_data_offset =
+      string_offsets_offset + 8 * strings_.size();
+  const uint64_t body_offset = string_data_offset + string_data_size;
+  const uint64_t id_index_offset = body_offset + body_.size();
+
+  output->reserve(output->size() + id_index_offset +
+                  kIdEntrySize * id_index_.size());
+  output->append(kMagic, sizeof(kMagic));
+  AppendUint32(kVersion, output);
+  AppendUint32(kByteOrderMark, output);
+  AppendUint32(static_cast<uint32_t>(strings_.size()), output);
+  AppendUint32(encoding_index, output);
+  AppendUint32(static_cast<uint32_t>(id_index_.size()), output);
+  AppendUint64(string_offsets_offset, output);
+  AppendUint64(string_data_offset, output);
+  AppendUint64(string_data_size, output);
+  AppendUint64(body_offset, output);
+  AppendUint64(body_.size(), output);
+  AppendUint64(id_index_offset, output);
+  uint64_t string_offset = 0;
+  for (size_t i = 0; i < strings_.size(); ++i) {
+    AppendUint64(string_offset, output);
+    string_offset += 4 + strings_[i].size();
+  }
+  for (size_t i = 0; i < strings_.size(); ++i) {
+    AppendUint32(static_cast<uint32_t>(strings_[i].size()), output);
+    output->append(strings_[i]);
+  }
+  output->append(body_);
+  for (size_t i = 0; i < id_index_.size(); ++i) {
+    AppendUint32(id_index_[i].id, output);
+    AppendUint32(id_index_[i].type_id, output);
+    AppendUint32(id_index_[i].flags, output);
+    AppendUint64(id_index_[i].offset, output);
+  }
+}
+
+bool WriteKmlSnapshot(const KmlFile& kml_file, string* output) {
+  if (!output || !kml_file.get_root()) {
+    return false;
+  }
+  KmlSnapshotSerializer serializer;
+  kml_file.get_root()->Serialize(serializer);
+  serializer.Finish(kml_file.get_encoding(), output);
+  return true;
+}
+
+bool WriteKmlSnapshotToFile(const KmlFile& kml_file, const string& filename) {
+  string snapshot;
+  return WriteKmlSnapshot(kml_file, &snapshot) &&
+         kmlbase::File::WriteStringToFile(snapshot, filename);
+}
+
+// This is a bounds-checked reader over a region of the snapshot.  Each Read
+// method returns false if the read would go past the end of the region.
+namespace {
+class SnapshotReader {
+ public:
+  SnapshotReader(const char* begin, const char* end)
+    : p_(begin), end_(end) {}
+
+  template<typename T>
+  bool Read(T* value) {
+    if (static_cast<size_t>(end_ - p_) < sizeof(T)) {
+      return false;
+    }
+    memcpy(value, p_, sizeof(T));
+    p_ += sizeof(T);
+    return true;
+  }
+
+  bool Skip(size_t size) {
+    if (static_cast<size_t>(end_ - p_) < size) {
+      return false;
+    }
+    p_ += size;
+    return true;
+  }
+
+  const char* get_position() const {
+    return p_;
+  }
+
+  bool AtEnd() const {
+    return p_ == end_;
+  }
+
+ private:
+  const char* p_;
+  const char* end_;
+};
+}  // end anonymous namespace
+
+KmlSnapshot::KmlSnapshot()
+  : base_(NULL),
+    size_(0),
+    mapping_(NULL),
+    string_count_(0),
+    string_offsets_(NULL),
+    string_data_(NULL),
+    string_data_size_(0),
+    body_(NULL),
+    body_size_(0),
+    id_index_(NULL),
+    id_count_(0) {
+}
+
+KmlSnapshot::~KmlSnapshot() {
+#ifndef WIN32
+  if (mapping_) {
+    munmap(mapping_, size_);
+  }
+#endif
+}
+
+// static
+KmlSnapshot* KmlSnapshot::OpenFromFile(const string& filename,
+                                       string* errors) {
+  KmlSnapshot* snapshot = new KmlSnapshot;
+#ifdef WIN32
+  if (!kmlbase::File::ReadFileToString(filename, &snapshot->data_)) {
+    if (errors) {
+      *errors = "could not read " + filename;
+    }
+    delete snapshot;
+    return NULL;
+  }
+  snapshot->base_ = snapshot->data_.data();
+  snapshot->size_ = snapshot->data_.size();
+#else
+  int fd = open(filename.c_str(), O_RDONLY);
+  if (fd < 0) {
+    if (errors) {
+      *errors = "could not open " + filename;
+    }
+    delete snapshot;
+    return NULL;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size == 0) {
+    close(fd);
+    if (errors) {
+      *errors = "could not stat " + filename;
+    }
+    delete snapshot;
+    return NULL;
+  }
+  void* mapping = mmap(NULL, static_cast<size_t>(st.st_size), PROT_READ,
+                       MAP_SHARED, fd, 0);
+  close(fd);  // The mapping remains valid.
+  if (mapping == MAP_FAILED) {
+    if (errors) {
+      *errors = "could not map " + filename;
+    }
+    delete snapshot;
+    return NULL;
+  }
+  snapshot->mapping_ = mapping;
+  snapshot->base_ = static_cast<const char*>(mapping);
+  snapshot->size_ = static_cast<size_t>(st.st_size);
+#endif
+  if (snapshot->Init(errors)) {
+    return snapshot;
+  }
+  delete snapshot;
+  return NULL;
+}
+
+// static
+KmlSnapshot* KmlSnapshot::CreateFromString(const string& snapshot_data,
+                                           string* errors) {
+  KmlSnapshot* snapshot = new KmlSnapshot;
+  snapshot->data_ = snapshot_data;
+  snapshot->base_ = snapshot->data_.data();
+  snapshot->size_ = snapshot->data_.size();
+  if (snapshot->Init(errors)) {
+    return snapshot;
+  }
+  delete snapshot;
+  return NULL;
+}
+
+// This returns true if the size bytes at offset lie within a region of
+// region_size bytes.  Neither offset nor size is trusted so the two are never
+// added together.
+static bool InRange(uint64_t offset, uint64_t size, uint64_t region_size) {
+  return offset <= region_size && size <= region_size - offset;
+}
+
+// private
+bool KmlSnapshot::Init(string* errors) {
+  SnapshotReader reader(base_, base_ + size_);
+  char magic[4];
+  uint32_t version, byte_order_mark, encoding_index;
+  uint64_t string_offsets_offset, string_data_offset, body_offset,
+           id_index_offset;
+  if (!reader.Read(&magic) || memcmp(magic, kMagic, sizeof(kMagic)) != 0 ||
+      !reader.Read(&version) || version != kVersion ||
+      !reader.Read(&byte_order_mark) || byte_order_mark != kByteOrderMark ||
+      !reader.Read(&string_count_) || !reader.Read(&encoding_index) ||
+      !reader.Read(&id_count_) || !reader.Read(&string_offsets_offset) ||
+      !reader.Read(&string_data_offset) || !reader.Read(&string_data_size_) ||
+      !reader.Read(&body_offset) || !reader.Read(&body_size_) ||
+      !reader.Read(&id_index_offset)) {
+    if (errors) {
+      *errors = "not a KML snapshot";
+    }
+    return false;
+  }
+  // Each section must be within the snapshot.  The offsets and sizes are
+  // untrusted and are compared such that no sum of them can wrap.
+  if (!InRange(string_offsets_offset,
+               8 * static_cast<uint64_t>(string_count_), size_) ||
+      !InRange(string_data_offset, string_data_size_, size_) ||
+      !InRange(body_offset, body_size_, size_) ||
+      !InRange(id_index_offset,
+               kIdEntrySize * static_cast<uint64_t>(id_count_), size_)) {
+    if (errors) {
+      *errors = "truncated KML snapshot";
+    }
+    return false;
+  }
+  string_offsets_ = base_ + string_offsets_offset;
+  string_data_ = base_ + string_data_offset;
+  body_ = base_ + body_offset;
+  id_index_ = base_ + id_index_offset;
+  const char* encoding;
+  uint32_t encoding_size;
+  if (!GetString(encoding_index, &encoding, &encoding_size)) {
+    if (errors) {
+      *errors = "corrupt KML snapshot";
+    }
+    return false;
+  }
+  encoding_.assign(encoding, encoding_size);
+  return true;
+}
+
+// private
+bool KmlSnapshot::GetString(uint32_t index, const char** data,
+                            uint32_t* size) const {
+  if (index >= string_count_) {
+    return false;
+  }
+  uint64_t offset;
+  memcpy(&offset, string_offsets_ + 8 * static_cast<size_t>(index),
+         sizeof(offset));
+  if (!InRange(offset, 4, string_data_size_)) {
+    return false;
+  }
+  memcpy(size, string_data_ + offset, sizeof(*size));
+  if (!InRange(offset + 4, *size, string_data_size_)) {
+    return false;
+  }
+  *data = string_data_ + offset + 4;
+  return true;
+}
+
+// private
+bool KmlSnapshot::FindId(const string& id, uint64_t* offset,
+                         uint32_t* flags) const {
+  // Find the last entry whose id is not greater than the given id.
+  size_t lo = 0;
+  size_t hi = id_count_;
+  while (lo < hi) {
+    const size_t mid = lo + (hi - lo) / 2;
+    uint32_t string_index;
+    memcpy(&string_index, id_index_ + kIdEntrySize * mid,
+           sizeof(string_index));
+    const char* data;
+    uint32_t size;
+    if (!GetString(string_index, &data, &size)) {
+      return false;
+    }
+    if (id.compare(0, string::npos, data, size) < 0) {
+      hi = mid;
+    } else {
+      lo = mid + 1;
+    }
+  }
+  if (lo == 0) {
+    return false;
+  }
+  const char* entry = id_index_ + kIdEntrySize * (lo - 1);
+  uint32_t string_index;
+  memcpy(&string_index, entry, sizeof(string_index));
+  const char* data;
+  uint32_t size;
+  if (!GetString(string_index, &data, &size) ||
+      id.compare(0, string::npos, data, size) != 0) {
+    return false;
+  }
+  memcpy(flags, entry + 8, sizeof(*flags));
+  memcpy(offset, entry + 12, sizeof(*offset));
+  return true;
+}
+
+ElementPtr KmlSnapshot::GetRoot(
+    const parser_observer_vector_t& observers) const {
+  return Materialize(0, observers);
+}
+
+ElementPtr KmlSnapshot::GetRoot() const {
+  parser_observer_vector_t no_observers;
+  return Materialize(0, no_observers);
+}
+
+ElementPtr KmlSnapshot::GetElementById(const string& id) const {
+  uint64_t offset;
+  uint32_t flags;
+  if (!FindId(id, &offset, &flags)) {
+    return NULL;
+  }
+  parser_observer_vector_t no_observers;
+  return Materialize(offset, no_observers);
+}
+
+bool KmlSnapshot::IsSharedStyleId(const string& id) const {
+  uint64_t offset;
+  uint32_t flags;
+  return FindId(id, &offset, &flags) && (flags & kIdFlagSharedStyle);
+}
+
+// These mirror the observer calls in KmlHandler.
+static bool CallNewElementObservers(const parser_observer_vector_t& observers,
+                                    const ElementPtr& element) {
+  for (size_t i = 0; i < observers.size(); ++i) {
+    if (!observers[i]->NewElement(element)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static bool AddChildWithObservers(const parser_observer_vector_t& observers,
+                                  const ElementPtr& parent,
+                                  const ElementPtr& child) {
+  bool add = true;
+  for (size_t i = 0; i < observers.size(); ++i) {
+    if (!observers[i]->EndElement(parent, child)) {
+      add = false;
+      break;
+    }
+  }
+  if (add) {
+    parent->AddElement(child);
+  }
+  for (size_t i = 0; i < observers.size(); ++i) {
+    if (!observers[i]->AddChild(parent, child)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// private
+// This builds the subtree whose Begin record is at the given body offset.
+ElementPtr KmlSnapshot::Materialize(
+    uint64_t offset, const parser_observer_vector_t& observers) const {
+  if (offset >= body_size_) {
+    return NULL;
+  }
+  const KmlFactory* factory = KmlFactory::GetFactory();
+  std::vector<ElementPtr> stack;
+  SnapshotReader reader(body_ + offset, body_ + body_size_);
+  do {
+    uint8_t tag;
+    if (!reader.Read(&tag)) {
+      return NULL;
+    }
+    switch (tag) {
+      case kRecordBegin: {
+        uint32_t type_id, attribute_count;
+        if (!reader.Read(&type_id) || !reader.Read(&attribute_count)) {
+          return NULL;
+        }
+        ElementPtr element =
+            factory->CreateElementById(static_cast<KmlDomType>(type_id));
+        if (!element) {
+          return NULL;
+        }
+        if (attribute_count > 0) {
+          Attributes* attributes = new Attributes;
+          for (uint32_t i = 0; i < attribute_count; ++i) {
+            uint32_t key, value;
+            const char* key_data;
+            const char* value_data;
+            uint32_t key_size, value_size;
+            if (!reader.Read(&key) || !reader.Read(&value) ||
+                !GetString(key, &key_data, &key_size) ||
+                !GetString(value, &value_data, &value_size)) {
+              delete attributes;
+              return NULL;
+            }
+            attributes->SetValue(string(key_data, key_size),
+                                 string(value_data, value_size));
+          }
+          // Element::ParseAttributes takes ownership of the Attributes.
+          element->ParseAttributes(attributes);
+        }
+        stack.push_back(element);
+        if (!CallNewElementObservers(observers, element)) {
+          return NULL;
+        }
+        break;
+      }
+      case kRecordEnd: {
+        if (stack.empty()) {
+          return NULL;
+        }
+        ElementPtr child = stack.back();
+        stack.pop_back();
+        if (ParsesOwnCharData(child->Type())) {
+          child->AddElement(child);  // "Parse yourself"
+        }
+        if (!stack.empty() &&
+            !AddChildWithObservers(observers, stack.back(), child)) {
+          return NULL;
+        }
+        if (stack.empty()) {
+          return child;
+        }
+        break;
+      }
+      case kRecordField:
+      case kRecordColor: {
+        uint32_t type_id, value;
+        if (!reader.Read(&type_id) || !reader.Read(&value) || stack.empty()) {
+          return NULL;
+        }
+        ElementPtr field =
+            factory->CreateFieldById(static_cast<KmlDomType>(type_id));
+        if (tag == kRecordColor) {
+          field->set_char_data(kmlbase::Color32(value).to_string_abgr());
+        } else {
+          const char* data;
+          uint32_t size;
+          if (!GetString(value, &data, &size)) {
+            return NULL;
+          }
+          field->set_char_data(string(data, size));
+        }
+        if (!CallNewElementObservers(observers, field) ||
+            !AddChildWithObservers(observers, stack.back(), field)) {
+          return NULL;
+        }
+        break;
+      }
+      case kRecordContent: {
+        uint8_t maybe_quote;
+        uint32_t index;
+        const char* data;
+        uint32_t size;
+        if (!reader.Read(&maybe_quote) || !reader.Read(&index) ||
+            !GetString(index, &data, &size) || stack.empty()) {
+          return NULL;
+        }
+        if (maybe_quote) {
+          stack.back()->set_char_data(stack.back()->get_char_data() +
+                                      string(data, size));
+        } else {
+          stack.back()->AddUnknownElement(string(data, size));
+        }
+        break;
+      }
+      case kRecordCoordinates: {
+        uint64_t count;
+        if (!reader.Read(&count) || stack.empty() ||
+            count > body_size_ / (3 * sizeof(double) + 1)) {
+          return NULL;
+        }
+        kmldom::CoordinatesPtr coordinates =
+            kmldom::AsCoordinates(stack.back());
+        if (!coordinates) {
+          return NULL;
+        }
+        const char* vec3s = reader.get_position();
+        if (!reader.Skip(static_cast<size_t>(count) * 3 * sizeof(double))) {
+          return NULL;
+        }
+        const char* has_altitude = reader.get_position();
+        if (!reader.Skip(static_cast<size_t>(count))) {
+          return NULL;
+        }
+        for (size_t i = 0; i < count; ++i) {
+          double lla[3];
+          memcpy(lla, vec3s + i * sizeof(lla), sizeof(lla));
+          if (has_altitude[i]) {
+            coordinates->add_vec3(Vec3(lla[0], lla[1], lla[2]));
+          } else {
+            coordinates->add_vec3(Vec3(lla[0], lla[1]));
+          }
+        }
+        break;
+      }
+      default:
+        return NULL;
+    }
+  } while (!reader.AtEnd());
+  return NULL;  // Ran out of records before the subtree was closed.
+}
+
+}  // end namespace kmlengine
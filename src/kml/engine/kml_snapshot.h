@@ -0,0 +1,190 @@
+// Copyright 2008, Google Inc. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//  3. Neither the name of Google Inc. nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// This file contains the declaration of the KmlSnapshot class and the
+// KmlSnapshotSerializer class.  A KML snapshot is a compact binary image of
+// a parsed KML file intended to be written once and loaded many times far
+// faster than re-parsing the original KML.  The snapshot holds:
+//   - a string table holding each distinct string once,
+//   - the element tree as a sequence of records keyed by the kml22.h type
+//     ids with colors and coordinates stored in binary form,
+//   - a sorted index of all id'ed Objects to the offset of their subtree.
+// The file is accessed through mmap() such that the load cost is that of
+// materializing only the needed portion of the element tree.  A snapshot
+// does not preserve anything that would not survive a KML serialization.
+// The format is in host byte order and a snapshot is not portable between
+// hosts of different endianness.  Intended usage:
+//   // Once, after parsing the KML.
+//   kmlengine::KmlFilePtr kml_file = KmlFile::CreateFromParse(kml, &errors);
+//   kmlengine::WriteKmlSnapshotToFile(*kml_file, "big.kmlsnap");
+//   // Thereafter:
+//   boost::scoped_ptr<KmlSnapshot> snapshot(
+//       KmlSnapshot::OpenFromFile("big.kmlsnap", &errors));
+//   kmlengine::KmlFilePtr kml_file =
+//       KmlFile::CreateFromSnapshot(*snapshot, &errors);
+//   // Or fetch just one id'ed subtree without building the rest:
+//   kmldom::ElementPtr placemark = snapshot->GetElementById("pm123");
+
+#ifndef KML_ENGINE_KML_SNAPSHOT_H__
+#define KML_ENGINE_KML_SNAPSHOT_H__
+
+#include <map>
+#include <stack>
+#include <vector>
+#include "kml/base/util.h"
+#include "kml/base/vec3.h"
+#include "kml/dom.h"
+#include "kml/dom/parser_observer.h"
+#include "kml/dom/serializer.h"
+
+namespace kmlengine {
+
+class KmlFile;
+
+// This Serializer builds the binary snapshot of the element hierarchy it is
+// handed.  Use WriteKmlSnapshot() rather than this class directly.
+class KmlSnapshotSerializer : public kmldom::Serializer {
+ public:
+  KmlSnapshotSerializer();
+  virtual ~KmlSnapshotSerializer() {}
+
+  // Serializer methods.
+  virtual void BeginById(int type_id, const kmlbase::Attributes& attributes);
+  virtual void End();
+  virtual void SaveStringFieldById(int type_id, string value);
+  virtual void SaveContent(const string& content, bool maybe_quote);
+  virtual void SaveVec3(const kmlbase::Vec3& vec3);
+  virtual void SaveColor(int type_id, const kmlbase::Color32& color);
+  virtual void EndElementArray(int type_id);
+
+  // This appends the complete snapshot of everything serialized so far to
+  // the given string.  The encoding is saved for use by KmlFile.
+  void Finish(const string& encoding, string* output);
+
+ private:
+  // An entry in the id index.
+  struct IdEntry {
+    uint32_t id;
+    uint32_t type_id;
+    uint32_t flags;
+    uint64_t offset;
+  };
+  class IdEntryLess;
+  uint32_t Intern(const string& s);
+  const kmldom::ElementPtr& GetPrototype(int type_id);
+  void FlushVec3s();
+  void PutUint8(uint8_t value);
+  void PutUint32(uint32_t value);
+  void PutUint64(uint64_t value);
+  void PutDouble(double value);
+
+  string body_;
+  std::vector<string> strings_;
+  std::map<string, uint32_t> string_map_;
+  std::vector<IdEntry> id_index_;
+  // The type id of each open element.
+  std::stack<int> open_;
+  std::vector<kmlbase::Vec3> vec3s_;
+  // One instance of each element type seen, used to query the type hierarchy.
+  std::vector<kmldom::ElementPtr> prototypes_;
+  LIBKML_DISALLOW_EVIL_CONSTRUCTORS(KmlSnapshotSerializer);
+};
+
+// This appends the snapshot of the given KmlFile to the given string.  False
+// is returned if the KmlFile has no root or output is NULL.
+bool WriteKmlSnapshot(const KmlFile& kml_file, string* output);
+
+// This writes the snapshot of the given KmlFile to the given file.
+bool WriteKmlSnapshotToFile(const KmlFile& kml_file, const string& filename);
+
+// The KmlSnapshot class provides read access to a snapshot created by
+// WriteKmlSnapshot().  Each Get method builds new Elements from the snapshot
+// on each call: no Element is shared between calls.
+class KmlSnapshot {
+ public:
+  // This maps the given snapshot file into memory.  NULL is returned and
+  // errors is set if the file cannot be mapped or is not a valid snapshot.
+  static KmlSnapshot* OpenFromFile(const string& filename, string* errors);
+
+  // This creates a KmlSnapshot from a copy of the given snapshot data.
+  static KmlSnapshot* CreateFromString(const string& snapshot_data,
+                                       string* errors);
+
+  ~KmlSnapshot();
+
+  // This builds the complete element hierarchy.  Each given ParserObserver is
+  // called exactly as it would be during a parse of the equivalent KML.  NULL
+  // is returned if an observer terminates the build or the snapshot data is
+  // malformed.
+  kmldom::ElementPtr GetRoot(
+      const kmldom::parser_observer_vector_t& observers) const;
+  kmldom::ElementPtr GetRoot() const;
+
+  // This builds only the subtree of the Object with the given id.  NULL is
+  // returned if no Object has this id.  If the original KML had duplicate
+  // ids the last one in document order is used as is the case in KmlFile.
+  kmldom::ElementPtr GetElementById(const string& id) const;
+
+  // This returns true if the Object with the given id is a shared style.
+  bool IsSharedStyleId(const string& id) const;
+
+  // The number of id'ed Objects in the snapshot.
+  size_t get_id_count() const {
+    return id_count_;
+  }
+
+  const string& get_encoding() const {
+    return encoding_;
+  }
+
+ private:
+  KmlSnapshot();
+  bool Init(string* errors);
+  bool GetString(uint32_t index, const char** data, uint32_t* size) const;
+  bool FindId(const string& id, uint64_t* offset, uint32_t* flags) const;
+  kmldom::ElementPtr Materialize(
+      uint64_t offset, const kmldom::parser_observer_vector_t& observers)
+      const;
+
+  // The snapshot is either mapped or held in this string.
+  string data_;
+  const char* base_;
+  size_t size_;
+  void* mapping_;
+  uint32_t string_count_;
+  const char* string_offsets_;
+  const char* string_data_;
+  uint64_t string_data_size_;
+  const char* body_;
+  uint64_t body_size_;
+  const char* id_index_;
+  uint32_t id_count_;
+  string encoding_;
+  LIBKML_DISALLOW_EVIL_CONSTRUCTORS(KmlSnapshot);
+};
+
+}  // end namespace kmlengine
+
+#endif  // KML_ENGINE_KML_SNAPSHOT_H__
@@ -0,0 +1,294 @@
+// Copyright 2008, Google Inc. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//  3. Neither the name of Google Inc. nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// This file contains the unit tests for the KmlSnapshot class.
+
+#include "kml/engine/kml_snapshot.h"
+#include <cstring>
+#include "boost/scoped_ptr.hpp"
+#include "gtest/gtest.h"
+#include "kml/base/file.h"
+#include "kml/base/tempfile.h"
+#include "kml/dom.h"
+#include "kml/engine/kml_file.h"
+
+#ifndef DATADIR
+#error *** DATADIR must be defined! ***
+#endif
+
+using kmlbase::File;
+using kmldom::ElementPtr;
+using kmldom::PlacemarkPtr;
+
+namespace kmlengine {
+
+class KmlSnapshotTest : public testing::Test {
+ protected:
+  // This parses the given KML, writes a snapshot and creates a KmlFile from
+  // that snapshot.
+  KmlFile* RoundTrip(const string& kml) {
+    KmlFilePtr kml_file = KmlFile::CreateFromParse(kml, NULL);
+    if (!kml_file) {
+      return NULL;
+    }
+    string snapshot_data;
+    if (!WriteKmlSnapshot(*kml_file, &snapshot_data)) {
+      return NULL;
+    }
+    snapshot_.reset(KmlSnapshot::CreateFromString(snapshot_data, NULL));
+    if (!snapshot_.get()) {
+      return NULL;
+    }
+    return KmlFile::CreateFromSnapshot(*snapshot_, NULL);
+  }
+
+  // This verifies that the serialization of the snapshot is identical to
+  // that of the parse of the given file.
+  void VerifyLosslessRoundTrip(const string& filename) {
+    string kml;
+    ASSERT_TRUE(File::ReadFileToString(
+        File::JoinPaths(DATADIR, filename), &kml)) << filename;
+    KmlFilePtr parsed = KmlFile::CreateFromParse(kml, NULL);
+    ASSERT_TRUE(parsed) << filename;
+    KmlFilePtr loaded = RoundTrip(kml);
+    ASSERT_TRUE(loaded) << filename;
+    string expected;
+    ASSERT_TRUE(parsed->SerializeToString(&expected));
+    string actual;
+    ASSERT_TRUE(loaded->SerializeToString(&actual));
+    ASSERT_EQ(expected, actual) << filename;
+  }
+
+  boost::scoped_ptr<KmlSnapshot> snapshot_;
+};
+
+TEST_F(KmlSnapshotTest, TestLosslessRoundTrip) {
+  const char* kFiles[] = {
+    "kml/all-arrays.kml",
+    "kml/all-altitudemodes.kml",
+    "kml/all-unknown-attrs-input.kml",
+    "kml/all-unknown-input.kml",
+    "kml/kmlsamples.kml",
+    "kml/old_schema_example.kml",
+    "kml/schemadata.kml",
+    "kml/invalid_descriptions.kml",
+    "gx/all-gx.kml",
+    "style/allstyles.kml",
+    "style/style-with-unknown-elements.kml"
+  };
+  for (size_t i = 0; i < sizeof(kFiles)/sizeof(kFiles[0]); ++i) {
+    VerifyLosslessRoundTrip(kFiles[i]);
+  }
+}
+
+TEST_F(KmlSnapshotTest, TestCoordinatesAltitude) {
+  KmlFilePtr kml_file = RoundTrip(
+      "<Placemark><LineString><coordinates>1,2 3,4,5</coordinates>"
+      "</LineString></Placemark>");
+  ASSERT_TRUE(kml_file);
+  PlacemarkPtr placemark = kmldom::AsPlacemark(kml_file->get_root());
+  ASSERT_TRUE(placemark);
+  kmldom::LineStringPtr linestring =
+      kmldom::AsLineString(placemark->get_geometry());
+  ASSERT_TRUE(linestring);
+  kmldom::CoordinatesPtr coordinates = linestring->get_coordinates();
+  ASSERT_EQ(static_cast<size_t>(2), coordinates->get_coordinates_array_size());
+  ASSERT_FALSE(coordinates->get_coordinates_array_at(0).has_altitude());
+  ASSERT_EQ(1.0, coordinates->get_coordinates_array_at(0).get_longitude());
+  ASSERT_EQ(2.0, coordinates->get_coordinates_array_at(0).get_latitude());
+  ASSERT_TRUE(coordinates->get_coordinates_array_at(1).has_altitude());
+  ASSERT_EQ(5.0, coordinates->get_coordinates_array_at(1).get_altitude());
+}
+
+TEST_F(KmlSnapshotTest, TestMaps) {
+  KmlFilePtr kml_file = RoundTrip(
+      "<Document>"
+      "<Style id=\"s0\"/>"
+      "<Folder id=\"f0\">"
+      "<Style id=\"s1\"/>"
+      "<Placemark id=\"p0\"><styleUrl>#s0</styleUrl></Placemark>"
+      "<NetworkLink><Link><href>a.kml</href></Link></NetworkLink>"
+      "</Folder>"
+      "</Document>");
+  ASSERT_TRUE(kml_file);
+  ASSERT_TRUE(kmldom::AsFolder(kml_file->GetObjectById("f0")));
+  ASSERT_TRUE(kmldom::AsPlacemark(kml_file->GetObjectById("p0")));
+  ASSERT_TRUE(kml_file->GetSharedStyleById("s0"));
+  ASSERT_FALSE(kml_file->GetSharedStyleById("s1"));
+  ASSERT_EQ(static_cast<size_t>(1),
+            kml_file->get_link_parent_vector().size());
+
+  ASSERT_EQ(static_cast<size_t>(4), snapshot_->get_id_count());
+  ASSERT_TRUE(snapshot_->IsSharedStyleId("s0"));
+  ASSERT_FALSE(snapshot_->IsSharedStyleId("s1"));
+  ASSERT_FALSE(snapshot_->IsSharedStyleId("f0"));
+  ASSERT_FALSE(snapshot_->IsSharedStyleId("nope"));
+}
+
+TEST_F(KmlSnapshotTest, TestGetElementById) {
+  KmlFilePtr kml_file = RoundTrip(
+      "<Document id=\"d\">"
+      "<Placemark id=\"a\"><name>A</name></Placemark>"
+      "<Folder id=\"f\"><Placemark id=\"b\"><name>B</name>"
+      "<Point><coordinates>1,2,3</coordinates></Point>"
+      "</Placemark></Folder>"
+      "<Placemark id=\"b\"><name>last b</name></Placemark>"
+      "</Document>");
+  ASSERT_TRUE(kml_file);
+
+  PlacemarkPtr a = kmldom::AsPlacemark(snapshot_->GetElementById("a"));
+  ASSERT_TRUE(a);
+  ASSERT_EQ(string("A"), a->get_name());
+  ASSERT_FALSE(a->GetParent());
+
+  // The last of a duplicate id wins as in KmlFile.
+  PlacemarkPtr b = kmldom::AsPlacemark(snapshot_->GetElementById("b"));
+  ASSERT_TRUE(b);
+  ASSERT_EQ(string("last b"), b->get_name());
+  ASSERT_EQ(string("last b"),
+            kmldom::AsPlacemark(kml_file->GetObjectById("b"))->get_name());
+
+  // Each call creates a new subtree.
+  kmldom::FolderPtr f = kmldom::AsFolder(snapshot_->GetElementById("f"));
+  ASSERT_TRUE(f);
+  ASSERT_EQ(static_cast<size_t>(1), f->get_feature_array_size());
+  ASSERT_NE(f, kmldom::AsFolder(snapshot_->GetElementById("f")));
+  ASSERT_EQ(kmldom::SerializeRaw(kml_file->GetObjectById("f")),
+            kmldom::SerializeRaw(f));
+
+  ASSERT_TRUE(kmldom::AsDocument(snapshot_->GetElementById("d")));
+  ASSERT_FALSE(snapshot_->GetElementById("c"));
+  ASSERT_FALSE(snapshot_->GetElementById(""));
+}
+
+TEST_F(KmlSnapshotTest, TestEncoding) {
+  KmlFilePtr kml_file = KmlFile::CreateFromParse("<kml/>", NULL);
+  ASSERT_TRUE(kml_file);
+  kml_file->set_encoding("iso-8859-1");
+  string snapshot_data;
+  ASSERT_TRUE(WriteKmlSnapshot(*kml_file, &snapshot_data));
+  snapshot_.reset(KmlSnapshot::CreateFromString(snapshot_data, NULL));
+  ASSERT_TRUE(snapshot_.get());
+  ASSERT_EQ(string("iso-8859-1"), snapshot_->get_encoding());
+  kml_file = KmlFile::CreateFromSnapshot(*snapshot_, NULL);
+  ASSERT_TRUE(kml_file);
+  ASSERT_EQ(string("iso-8859-1"), kml_file->get_encoding());
+}
+
+TEST_F(KmlSnapshotTest, TestOpenFromFile) {
+  string kml;
+  ASSERT_TRUE(File::ReadFileToString(
+      File::JoinPaths(DATADIR, "kml/kmlsamples.kml"), &kml));
+  KmlFilePtr kml_file = KmlFile::CreateFromParse(kml, NULL);
+  ASSERT_TRUE(kml_file);
+  kmlbase::TempFilePtr tempfile = kmlbase::TempFile::CreateTempFile();
+  ASSERT_TRUE(tempfile);
+  ASSERT_TRUE(WriteKmlSnapshotToFile(*kml_file, tempfile->name()));
+  string errors;
+  snapshot_.reset(KmlSnapshot::OpenFromFile(tempfile->name(), &errors));
+  ASSERT_TRUE(snapshot_.get());
+  ASSERT_TRUE(errors.empty());
+  KmlFilePtr loaded = KmlFile::CreateFromSnapshot(*snapshot_, &errors);
+  ASSERT_TRUE(loaded);
+  string expected;
+  ASSERT_TRUE(kml_file->SerializeToString(&expected));
+  string actual;
+  ASSERT_TRUE(loaded->SerializeToString(&actual));
+  ASSERT_EQ(expected, actual);
+
+  ASSERT_FALSE(KmlSnapshot::OpenFromFile("no-such-file", &errors));
+  ASSERT_FALSE(errors.empty());
+}
+
+TEST_F(KmlSnapshotTest, TestBadSnapshot) {
+  string errors;
+  ASSERT_FALSE(KmlSnapshot::CreateFromString("", &errors));
+  ASSERT_FALSE(errors.empty());
+  ASSERT_FALSE(KmlSnapshot::CreateFromString(
+      "<kml><Placemark/></kml>", NULL));
+
+  KmlFilePtr kml_file = KmlFile::CreateFromParse(
+      "<Folder><Placemark id=\"p\"><name>x</name></Placemark></Folder>", NULL);
+  ASSERT_TRUE(kml_file);
+  string snapshot_data;
+  ASSERT_TRUE(WriteKmlSnapshot(*kml_file, &snapshot_data));
+
+  // Every truncation fails cleanly.
+  for (size_t size = 0; size < snapshot_data.size(); ++size) {
+    boost::scoped_ptr<KmlSnapshot> snapshot(
+        KmlSnapshot::CreateFromString(snapshot_data.substr(0, size), NULL));
+    ASSERT_FALSE(snapshot.get()) << size;
+  }
+
+  // Damage to the body fails cleanly.
+  for (size_t i = 0; i < snapshot_data.size(); ++i) {
+    string damaged = snapshot_data;
+    damaged[i] = static_cast<char>(0xff);
+    boost::scoped_ptr<KmlSnapshot> snapshot(
+        KmlSnapshot::CreateFromString(damaged, NULL));
+    if (snapshot.get()) {
+      snapshot->GetRoot();
+      snapshot->GetElementById("p");
+    }
+  }
+}
+
+// This overwrites the uint64 at the given offset in the snapshot data.
+static void PutUint64At(size_t offset, uint64_t value, string* data) {
+  memcpy(&(*data)[offset], &value, sizeof(value));
+}
+
+TEST_F(KmlSnapshotTest, TestCorruptHeader) {
+  KmlFilePtr kml_file = KmlFile::CreateFromParse(
+      "<Folder><Placemark id=\"p\"><name>x</name></Placemark></Folder>", NULL);
+  ASSERT_TRUE(kml_file);
+  string snapshot_data;
+  ASSERT_TRUE(WriteKmlSnapshot(*kml_file, &snapshot_data));
+  ASSERT_TRUE(KmlSnapshot::CreateFromString(snapshot_data, NULL));
+
+  // The header's body offset and body size are at 48 and 56.  A body offset
+  // and size whose sum wraps past 2^64 are rejected.
+  string corrupt = snapshot_data;
+  PutUint64At(48, static_cast<uint64_t>(-16), &corrupt);
+  PutUint64At(56, 32, &corrupt);
+  string errors;
+  boost::scoped_ptr<KmlSnapshot> snapshot(
+      KmlSnapshot::CreateFromString(corrupt, &errors));
+  ASSERT_FALSE(snapshot.get());
+  ASSERT_EQ(string("truncated KML snapshot"), errors);
+
+  // The string offsets begin at 72 just after the header.  A string offset
+  // which wraps when the string's size is added to it is rejected.
+  uint32_t encoding_index;
+  memcpy(&encoding_index, snapshot_data.data() + 16, sizeof(encoding_index));
+  corrupt = snapshot_data;
+  PutUint64At(72 + 8 * encoding_index, static_cast<uint64_t>(-2), &corrupt);
+  errors.clear();
+  snapshot.reset(KmlSnapshot::CreateFromString(corrupt, &errors));
+  ASSERT_FALSE(snapshot.get());
+  ASSERT_EQ(string("corrupt KML snapshot"), errors);
+}
+
+}  // end namespace kmlengine
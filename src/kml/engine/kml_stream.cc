@@ -26,21 +26,71 @@
 // This file contains the implementation of the KmlStream class.
 
 #include "kml/engine/kml_stream.h"
+#include "boost/scoped_ptr.hpp"
 #include "kml/base/expat_parser.h"
+#include "kml/base/zip_file.h"
 #include "kml/dom/kml_handler.h"
+#include "kml/dom/parser.h"
 #include "kml/dom/parser_observer.h"
+#include "kml/engine/kmz_file.h"
 
 using kmldom::ElementPtr;
 using kmldom::ParserObserver;
 
 namespace kmlengine {
 
+// This parses the default KML file of the KMZ archive whose first bytes are
+// in kmz_data and whose remaining bytes are in input.
+static ElementPtr ParseKmzFromIstream(string* kmz_data, std::istream* input,
+                                      string* errors,
+                                      ParserObserver* observer) {
+  const int kBufSize = 4096;
+  char buf[kBufSize];
+  while (input->good()) {
+    kmz_data->append(buf, input->read(buf, kBufSize).gcount());
+  }
+  KmzFilePtr kmz_file = KmzFile::OpenFromString(*kmz_data);
+  kmz_data->clear();
+  if (!kmz_file) {
+    if (errors) {
+      *errors = "bad KMZ";
+    }
+    return NULL;
+  }
+  boost::scoped_ptr<kmlbase::ZipEntryReader> zip_entry_reader(
+      kmz_file->OpenKml(NULL));
+  if (!zip_entry_reader.get()) {
+    if (errors) {
+      *errors = "no KML file in KMZ";
+    }
+    return NULL;
+  }
+  kmldom::Parser parser;
+  if (observer) {
+    parser.AddObserver(observer);
+  }
+  return parser.ParseZipEntry(zip_entry_reader.get(), errors);
+}
+
 KmlStream* KmlStream::ParseFromIstream(
     std::istream* input, string* errors, ParserObserver* observer) {
   if (!input) {
     return NULL;
   }
 
+  // Look at the first bytes to tell KMZ from KML.
+  char magic[4];
+  string head(magic, input->read(magic, sizeof(magic)).gcount());
+  if (KmzFile::IsKmz(head)) {
+    ElementPtr root = ParseKmzFromIstream(&head, input, errors, observer);
+    if (!root) {
+      return NULL;
+    }
+    KmlStream* kml_stream = new KmlStream;
+    kml_stream->set_root(root);
+    return kml_stream;
+  }
+
   // Initialize Kml parser.
   kmldom::parser_observer_vector_t observers;
   if (observer) {
@@ -48,8 +98,11 @@ KmlStream* KmlStream::ParseFromIstream(
   }
   kmldom::KmlHandler kml_handler(observers);
 
-  // Perform buffered parse
+  // Perform buffered parse, starting with the bytes read above.
   kmlbase::ExpatParser parser(&kml_handler, false);
+  if (!parser.ParseBuffer(head, errors, !input->good())) {
+    return NULL;  // Parse error
+  }
   const int kBufSize = 4096;
   while (input->good()) {
     if (void* buf = parser.GetInternalBuffer(kBufSize)) {
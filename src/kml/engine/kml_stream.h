@@ -48,7 +48,9 @@ class KmlStream : public kmlbase::XmlFile {
   // Create a KmlFile from KML/KMZ in the given C++ istream.  The entire
   // input is consumed.  On any parse or I/O failure NULL is returned and an
   // error message is set to the given error string if one is supplied.
-  // If a ParserObserver is supplied it is used during parse.
+  // If a ParserObserver is supplied it is used during parse.  KMZ input is
+  // held in memory as read but its default KML file is inflated into the
+  // parser a piece at a time (see KmzFile::OpenKml()).
   static KmlStream* ParseFromIstream(std::istream* input, string* errors,
                                      kmldom::ParserObserver* observer);
 
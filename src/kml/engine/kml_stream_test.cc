@@ -26,12 +26,17 @@
 // This file contains the unit tests for the KmlStream class.
 
 #include "kml/engine/kml_stream.h"
+#include <fstream>
 #include <istream>
 #include <sstream>
 #include "boost/scoped_ptr.hpp"
 #include "gtest/gtest.h"
 #include "kml/dom.h"
 
+#ifndef DATADIR
+#error *** DATADIR must be defined! ***
+#endif
+
 using kmldom::AsFolder;
 using kmldom::AsKml;
 using kmldom::AsPlacemark;
@@ -73,6 +78,27 @@ TEST(KmlStreamTest, TestBasicParseFromIstream) {
             point->get_coordinates()->get_coordinates_array_size());
 }
 
+TEST(KmlStreamTest, TestParseKmzFromIstream) {
+  // The first KML file in doc.kmz is a.kml.
+  const string kDocKmz = string(DATADIR) + "/kmz/doc.kmz";
+  std::ifstream input(kDocKmz.c_str(), std::ios_base::binary);
+  ASSERT_TRUE(input.good());
+  string errors;
+  boost::scoped_ptr<KmlStream>
+      kml_stream(KmlStream::ParseFromIstream(&input, &errors, NULL));
+  ASSERT_TRUE(kml_stream.get());
+  ASSERT_TRUE(errors.empty());
+  PlacemarkPtr placemark = AsPlacemark(kml_stream->get_root());
+  ASSERT_TRUE(placemark);
+  ASSERT_EQ(string("a.kml"), placemark->get_name());
+
+  // A truncated KMZ is an error.
+  std::istringstream truncated(string("PK\003\004garbage"));
+  kml_stream.reset(KmlStream::ParseFromIstream(&truncated, &errors, NULL));
+  ASSERT_FALSE(kml_stream.get());
+  ASSERT_FALSE(errors.empty());
+}
+
 TEST(KmlStreamTest, TestBadParseFromIstream) {
   const string kEmpty;
   std::istringstream kNothing(kEmpty);
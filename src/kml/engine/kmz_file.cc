@@ -32,6 +32,7 @@
 #include "kml/base/file.h"
 #include "kml/base/string_util.h"
 #include "kml/base/zip_file.h"
+#include "kml/base/zip_writer.h"
 #include "kml/engine/get_links.h"
 #include "kml/engine/href.h"
 #include "kml/engine/kml_uri.h"
@@ -39,6 +40,7 @@
 using kmlbase::File;
 using kmlbase::StringVector;
 using kmlbase::ZipFile;
+using kmlbase::ZipWriter;
 
 namespace kmlengine {
 
@@ -100,6 +102,19 @@ bool KmzFile::ReadKmlAndGetPath(string* output,
   return true;
 }
 
+kmlbase::ZipEntryReader* KmzFile::OpenKml(string* kml_path) const {
+  string default_kml;
+  if (!zip_file_->FindFirstOf(".kml", &default_kml)) {
+    return NULL;
+  }
+  kmlbase::ZipEntryReader* zip_entry_reader =
+      zip_file_->OpenEntry(default_kml);
+  if (zip_entry_reader && kml_path) {
+    *kml_path = default_kml;
+  }
+  return zip_entry_reader;
+}
+
 bool KmzFile::ReadKml(string* output) const {
   return ReadKmlAndGetPath(output, NULL);
 }
@@ -108,6 +123,10 @@ bool KmzFile::ReadFile(const char* path_in_kmz, string* output) const {
   return zip_file_->GetEntry(path_in_kmz, output);
 }
 
+bool KmzFile::HasFile(const char* subfile) const {
+  return zip_file_->IsInToc(subfile);
+}
+
 bool KmzFile::List(std::vector<string>* subfiles) {
   return zip_file_->GetToc(subfiles);
 }
@@ -129,13 +148,29 @@ KmzFile* KmzFile::Create(const char* kmz_filepath) {
   return new KmzFile(zipfile);
 }
 
+ZipWriter* KmzFile::get_zip_writer() {
+  return zip_file_->get_zip_writer();
+}
+
 bool KmzFile::AddFile(const string& data, const string& path_in_kmz) {
   return zip_file_->AddEntry(data, path_in_kmz);
 }
 
-// TODO: the implementation of this function really belongs in base/zip_file.
+size_t KmzFile::Close() {
+  ZipWriter* zip_writer = zip_file_->get_zip_writer();
+  if (!zip_writer) {
+    return 0;
+  }
+  size_t error_count = zip_writer->Flush();
+  if (!zip_writer->Close()) {
+    ++error_count;
+  }
+  return error_count;
+}
+
 size_t KmzFile::AddFileList(const string& base_url,
                             const StringVector& file_paths) {
+  ZipWriter* zip_writer = zip_file_->get_zip_writer();
   size_t error_count = 0;
   // We remember all stored resources so we can eliminate duplicates.
   std::set<string> stored_hrefs;
@@ -168,20 +203,19 @@ size_t KmzFile::AddFileList(const string& base_url,
     }
     stored_hrefs.insert(normalized_href);
 
-    // Try to read the file pointed to by base_url and the normalized href.
+    // Queue the file pointed to by base_url and the normalized href. The
+    // ZipWriter reads it when it compresses the batch.
     string relative_path = File::JoinPaths(base_url, normalized_href);
-    string file_data;
-    if (!kmlbase::File::ReadFileToString(relative_path, &file_data)) {
-      error_count++;
-      continue;
-    }
-
-    // Add the file to the KMZ archive.
-    if (!AddFile(file_data, normalized_href)) {
+    if (!zip_writer ||
+        !zip_writer->AddFileEntry(relative_path, normalized_href)) {
       error_count++;
       continue;
     }
   }
+  // Files which could not be read or written are counted by Flush.
+  if (zip_writer) {
+    error_count += zip_writer->Flush();
+  }
   return error_count;
 }
 
@@ -194,7 +228,7 @@ bool KmzFile::WriteKmz(const char* kmz_filepath, const string& kml) {
   if (!kmz->AddFile(kml, kDefaultKmlFilename)) {
     return false;
   }
-  return kmlbase::File::Exists(kmz_filepath);
+  return kmz->Close() == 0 && kmlbase::File::Exists(kmz_filepath);
 }
 
 // Static.
@@ -38,7 +38,9 @@
 // ZipFile hides the implementation details of the underlying zip library from
 // this interface.
 namespace kmlbase {
+class ZipEntryReader;
 class ZipFile;
+class ZipWriter;
 }
 
 namespace kmlengine {
@@ -92,12 +94,23 @@ class KmzFile : public kmlbase::Referent {
   // a KMZ archive be "doc.kml" this is not always the case.
   bool ReadKmlAndGetPath(string* output, string* kml_path) const;
 
+  // As ReadKmlAndGetPath(), but returns a ZipEntryReader which inflates the
+  // default KML file a piece at a time, or NULL if there is no KML file. The
+  // caller owns the returned object, which must not outlive this KmzFile.
+  // This is not limited by set_max_uncompressed_file_size.
+  kmlbase::ZipEntryReader* OpenKml(string* kml_path) const;
+
   // Read a specific file from a KMZ archive. Returns false if subfile was not
   // found, or if subfile could not be read. Note: subfile must be a full path
   // from the archive root. Relative references of "../../foo" are not handled.
   // The output string is not cleared before being written to.
   bool ReadFile(const char* subfile, string* output) const;
 
+  // Returns true if subfile is in the table of contents of the KMZ archive.
+  // Unlike ReadFile() nothing is inflated, so this does not say whether the
+  // subfile can be read.  The same path rules as ReadFile() apply.
+  bool HasFile(const char* subfile) const;
+
   // Fills a vector of strings of the files contained in the opened KMZ archive.
   // The vector is not cleared, only appended to. The string is the full path
   // name of the KML file from the archive root, with '/' as the separator.
@@ -110,14 +123,30 @@ class KmzFile : public kmlbase::Referent {
   // These are for the creation of KMZ files:
 
   // Creates an empty KmzFile at kmz_filepath on which AddFile may be called.
-  // Returns NULL if the file could not be created for writing.
+  // Returns NULL if the file could not be created for writing. The archive is
+  // complete when Close is called or the KmzFile is destroyed; only Close
+  // reports whether it was written.
   static KmzFile* Create(const char* kmz_filepath);
 
-  // Writes data to path_in_kmz. The path must be relative to the root of the
-  // archive. e.g. AddFile(data, "somedir/file.png"). If not, false is returned.
-  // False is also returned on any interal zipfile error.
+  // Returns the ZipWriter that compresses and writes the files of a KmzFile
+  // made by Create, or NULL if this KmzFile was opened for reading. Files are
+  // compressed on one thread per processor by default and images are stored
+  // uncompressed; see kml/base/zip_writer.h to change either.
+  kmlbase::ZipWriter* get_zip_writer();
+
+  // Queues data to be written to path_in_kmz. The path must be relative to
+  // the root of the archive. e.g. AddFile(data, "somedir/file.png"). If not,
+  // false is returned. Any internal zipfile error in compressing or writing
+  // the data is reported by AddFileList or Close.
   bool AddFile(const string& data, const string& path_in_kmz);
 
+  // Writes all queued files and completes the archive of a KmzFile made by
+  // Create. Returns the number of files which could not be written since
+  // the last AddFileList, plus one if the archive itself could not be
+  // completed. Returns 0 if this KmzFile was opened for reading or was
+  // already closed. No file may be added after Close.
+  size_t Close();
+
   // Adds a StringVector of hrefs to the KMZ file, resolved against a base
   // URL. The base URL is usually from kmz_file->get_url() and the hrefs
   // are most easily generated from GetRelativeLinks. All paths are normalized
@@ -125,7 +154,8 @@ class KmzFile : public kmlbase::Referent {
   // Returns the number of errors encountered during processing.
   // Errors may result from failure to normalize an href, an href that points
   // above the base url, or failure to read the resolved file prior to writing.
-  // Duplicate entries are ignored and not considered errors.
+  // Duplicate entries are ignored and not considered errors. The files are
+  // read and compressed concurrently and are all written before this returns.
   size_t AddFileList(const string& base_url,
                      const kmlbase::StringVector& file_paths);
 
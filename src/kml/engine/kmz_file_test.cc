@@ -30,6 +30,7 @@
 #include "boost/scoped_ptr.hpp"
 #include "kml/base/file.h"
 #include "kml/base/tempfile.h"
+#include "kml/base/zip_writer.h"
 #include "kml/engine/get_links.h"
 #include "gtest/gtest.h"
 
@@ -196,6 +197,19 @@ TEST_F(KmzTest, TestReadFile) {
   ASSERT_FALSE(kmz_file_->ReadFile("bar", NULL));
 }
 
+TEST_F(KmzTest, TestHasFile) {
+  const string kNokml = string(DATADIR) + "/kmz/nokml.kmz";
+  kmz_file_.reset(KmzFile::OpenFromFile(kNokml.c_str()));
+  ASSERT_TRUE(kmz_file_);
+  ASSERT_TRUE(kmz_file_->HasFile("foo/foo.txt"));
+  ASSERT_FALSE(kmz_file_->HasFile("foo/bar.txt"));
+  ASSERT_FALSE(kmz_file_->HasFile("foo"));
+  // HasFile() does not inflate the file so is not limited by its size.
+  kmz_file_->set_max_uncompressed_file_size(1);
+  ASSERT_FALSE(kmz_file_->ReadFile("foo/foo.txt", NULL));
+  ASSERT_TRUE(kmz_file_->HasFile("foo/foo.txt"));
+}
+
 TEST_F(KmzTest, TestIsKmz) {
   // Verify that a valid KMZ archive passes IsKmz().
   const string kGoodKmz= string(DATADIR) + "/kmz/doc.kmz";
@@ -347,6 +361,57 @@ TEST_F(KmzTest, TestAddFileList) {
   ASSERT_EQ(string("kmzfiles/dummy.kml"), list[1]);
 }
 
+TEST_F(KmzTest, TestAddFileListMissingFile) {
+  kmlbase::TempFilePtr tempfile = kmlbase::TempFile::CreateTempFile();
+  ASSERT_TRUE(tempfile != NULL);
+  {
+    KmzFilePtr kmz_file = KmzFile::Create(tempfile->name().c_str());
+    ASSERT_TRUE(kmz_file);
+    ASSERT_TRUE(kmz_file->get_zip_writer());
+    kmz_file->get_zip_writer()->set_num_threads(2);
+    kmlbase::StringVector file_paths;
+    file_paths.push_back("dummy.png");
+    file_paths.push_back("no-such-file.png");
+    file_paths.push_back("kmzfiles/dummy.kml");
+    // The file that cannot be read is the only error and is left out.
+    const string kBaseDir = File::JoinPaths(string(DATADIR), "kmz");
+    ASSERT_EQ(static_cast<size_t>(1),
+              kmz_file->AddFileList(kBaseDir, file_paths));
+  }
+  KmzFilePtr created(KmzFile::OpenFromFile(tempfile->name().c_str()));
+  ASSERT_TRUE(created);
+  // A KmzFile opened for reading has no writer.
+  ASSERT_TRUE(NULL == created->get_zip_writer());
+  kmlbase::StringVector list;
+  created->List(&list);
+  ASSERT_EQ(static_cast<size_t>(2), list.size());
+  ASSERT_EQ(string("dummy.png"), list[0]);
+  ASSERT_EQ(string("kmzfiles/dummy.kml"), list[1]);
+}
+
+TEST_F(KmzTest, TestClose) {
+  kmlbase::TempFilePtr tempfile = kmlbase::TempFile::CreateTempFile();
+  ASSERT_TRUE(tempfile != NULL);
+  KmzFilePtr kmz_file = KmzFile::Create(tempfile->name().c_str());
+  ASSERT_TRUE(kmz_file);
+  ASSERT_TRUE(kmz_file->AddFile("<kml/>", "doc.kml"));
+  // A file that cannot be read is counted when the archive is closed.
+  ASSERT_TRUE(kmz_file->get_zip_writer()->AddFileEntry(
+      File::JoinPaths(string(DATADIR), "no-such-file.png"), "x.png"));
+  ASSERT_EQ(static_cast<size_t>(1), kmz_file->Close());
+  // A second Close does nothing.
+  ASSERT_EQ(static_cast<size_t>(0), kmz_file->Close());
+  ASSERT_FALSE(kmz_file->AddFile("<kml/>", "more.kml"));
+
+  KmzFilePtr created(KmzFile::OpenFromFile(tempfile->name().c_str()));
+  ASSERT_TRUE(created);
+  ASSERT_EQ(static_cast<size_t>(0), created->Close());
+  kmlbase::StringVector list;
+  created->List(&list);
+  ASSERT_EQ(static_cast<size_t>(1), list.size());
+  ASSERT_EQ(string("doc.kml"), list[0]);
+}
+
 TEST_F(KmzTest, TestCreateFromElement) {
   kmlbase::TempFilePtr tempfile = kmlbase::TempFile::CreateTempFile();
   ASSERT_TRUE(tempfile != NULL);
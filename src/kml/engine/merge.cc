@@ -55,15 +55,19 @@ class FieldMerger : public Serializer {
 
   // Set the attributes in the target.
   virtual void BeginById(int type_id, const Attributes& attributes) {
+    // The common case in <Change> and style merging is a source with no
+    // attributes at all, in which case the target's attributes are unchanged.
     // ParseAttributes reflects the state of the passed attributes, so we
     // preserve the state of the element's attributes here ourselves and into
     // our private copy of the state merge the passed attributes and then
     // pass the result to ParseAttributes which sets/clears each attribute to
     // exactly reflect the state we create here.
-    Attributes target_attributes;
-    target_->SerializeAttributes(&target_attributes);
-    target_attributes.MergeAttributes(attributes);
-    target_->ParseAttributes(target_attributes.Clone());
+    if (attributes.GetSize() != 0) {
+      Attributes target_attributes;
+      target_->SerializeAttributes(&target_attributes);
+      target_attributes.MergeAttributes(attributes);
+      target_->ParseAttributes(target_attributes.Clone());
+    }
     // Merge on <coordinates> is consistent with setting any other simple
     // element: replace the content.  Since <coordinates> is not implemented
     // as a simple element and since the only "set" operations on <coordinates>
@@ -112,6 +116,9 @@ void MergeFields(const ElementPtr& source, ElementPtr target) {
   if (!source || !target || source == target) {
     return;
   }
+  // The fields are set with AddElement() which is not seen by the target's
+  // source range.
+  target->MarkDirty();
   FieldMerger field_merger(target);
   source->Serialize(field_merger);
 }
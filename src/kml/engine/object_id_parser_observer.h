@@ -58,12 +58,15 @@ class ObjectIdParserObserver : public kmldom::ParserObserver {
   virtual bool NewElement(const kmldom::ElementPtr& element) {
     if (kmldom::ObjectPtr object = kmldom::AsObject(element)) {
       if (object->has_id()) {
-        if (object_id_map_->find(object->get_id()) != object_id_map_->end()
-            && strict_parse_) {
+        // A single lookup both finds any existing mapping and makes room for
+        // a new one.
+        const size_t size = object_id_map_->size();
+        kmldom::ObjectPtr& mapped = (*object_id_map_)[object->get_id()];
+        if (strict_parse_ && object_id_map_->size() == size) {
           // TODO: create an error message
           return false;  // Duplicate id, fail parse.
         }
-        (*object_id_map_)[object->get_id()] = object;  // Last one wins.
+        mapped = object;  // Last one wins.
       }
     }
     // Not a duplicate id, or strict parsing not enabled, keep parsing.
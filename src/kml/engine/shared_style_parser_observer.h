@@ -60,15 +60,15 @@ class SharedStyleParserObserver : public kmldom::ParserObserver {
     // to terminate the parse.
     if (kmldom::DocumentPtr document = kmldom::AsDocument(parent)) {
       if (kmldom::StyleSelectorPtr ss = kmldom::AsStyleSelector(child)) {
-        if (ss->has_id()) {
-          if (strict_parse_ && shared_style_map_->find(ss->get_id()) !=
-                               shared_style_map_->end()) {
-            // TODO: provide means to send back an and error string with id
-            return false;  // Duplicate id, fail parse.
-          }
+        const size_t size = shared_style_map_->size();
+        kmldom::StyleSelectorPtr& mapped = (*shared_style_map_)[ss->get_id()];
+        if (ss->has_id() && strict_parse_ &&
+            shared_style_map_->size() == size) {
+          // TODO: provide means to send back an and error string with id
+          return false;  // Duplicate id, fail parse.
         }
         // No such mapping so save it, and "last one wins" on non-strict parse.
-        (*shared_style_map_)[ss->get_id()] = ss;
+        mapped = ss;
       }
     }
     return true;  // Not a duplicate id, keep parsing.
@@ -0,0 +1,223 @@
+// Copyright 2008, Google Inc. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//  3. Neither the name of Google Inc. nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// This file contains the implementation of the DeduplicateStyles function.
+
+#include "kml/engine/style_deduplicator.h"
+#include <map>
+#include <set>
+#include <utility>
+#include <vector>
+#include "boost/scoped_ptr.hpp"
+#include "kml/base/attributes.h"
+#include "kml/base/string_util.h"
+#include "kml/dom/xml_serializer.h"
+#include "kml/engine/clone.h"
+#include "kml/engine/engine_types.h"
+#include "kml/engine/feature_visitor.h"
+#include "kml/engine/id_mapper.h"
+
+using kmlbase::Attributes;
+using kmldom::DocumentPtr;
+using kmldom::FeaturePtr;
+using kmldom::StyleSelectorPtr;
+
+namespace kmlengine {
+
+// This XmlSerializer-specialization writes no id= attribute.
+class NoIdSerializer : public kmldom::XmlSerializer<kmldom::StringAdapter> {
+ public:
+  NoIdSerializer(kmldom::StringAdapter* output)
+    : kmldom::XmlSerializer<kmldom::StringAdapter>("", "", output) {
+  }
+
+  virtual void BeginById(int type_id, const Attributes& attributes) {
+    if (!attributes.FindValue("id", NULL)) {
+      kmldom::XmlSerializer<kmldom::StringAdapter>::BeginById(type_id,
+                                                             attributes);
+      return;
+    }
+    boost::scoped_ptr<Attributes> no_id(attributes.Clone());
+    string id;
+    no_id->CutValue("id", &id);
+    kmldom::XmlSerializer<kmldom::StringAdapter>::BeginById(type_id, *no_id);
+  }
+};
+
+// Returns the serialization of the StyleSelector without any id= within it.
+// The StyleSelector itself is not changed.
+static string GetStructuralKey(const StyleSelectorPtr& styleselector) {
+  string key;
+  kmldom::StringAdapter string_adapter(&key);
+  NoIdSerializer no_id_serializer(&string_adapter);
+  styleselector->Serialize(no_id_serializer);
+  return key;
+}
+
+// This FeatureVisitor finds the inline StyleSelector of each Feature which
+// may be shared and counts the StyleSelectors of each structural key.
+class InlineStyleCounter : public FeatureVisitor {
+ public:
+  typedef std::vector<std::pair<FeaturePtr, string> > InlineStyleVector;
+  typedef std::map<string, int> KeyCountMap;
+
+  virtual void VisitFeature(const FeaturePtr& feature) {
+    if (feature->IsA(kmldom::Type_Document) ||
+        !feature->has_styleselector() || feature->has_styleurl()) {
+      return;
+    }
+    const string key(GetStructuralKey(feature->get_styleselector()));
+    ++key_counts_[key];
+    inline_styles_.push_back(std::make_pair(feature, key));
+  }
+
+  const InlineStyleVector& get_inline_styles() const {
+    return inline_styles_;
+  }
+  int GetCount(const string& key) const {
+    KeyCountMap::const_iterator iter = key_counts_.find(key);
+    return iter == key_counts_.end() ? 0 : iter->second;
+  }
+
+ private:
+  // Each Feature with an inline StyleSelector and that StyleSelector's key.
+  InlineStyleVector inline_styles_;
+  KeyCountMap key_counts_;
+};
+
+// This shares StyleSelectors on the root <Document>.
+class StyleDeduplicator {
+ public:
+  StyleDeduplicator(const DocumentPtr& document,
+                    const ObjectIdMap& object_id_map,
+                    const std::set<string>& duplicate_ids)
+    : document_(document),
+      object_id_map_(object_id_map),
+      duplicate_ids_(duplicate_ids),
+      id_counter_(0) {
+    // The first of the existing shared StyleSelectors of a kind is used for
+    // all inline StyleSelectors of that kind.
+    for (size_t i = 0; i < document->get_styleselector_array_size(); ++i) {
+      const StyleSelectorPtr& shared = document->get_styleselector_array_at(i);
+      if (shared->has_id()) {
+        shared_ids_.insert(std::make_pair(GetStructuralKey(shared),
+                                          shared->get_id()));
+      }
+    }
+  }
+
+  // Returns true if there is a shared StyleSelector of the given key.
+  bool HasShared(const string& key) const {
+    return shared_ids_.find(key) != shared_ids_.end();
+  }
+
+  // Replaces the inline StyleSelector of the Feature with a <styleUrl> to the
+  // shared StyleSelector of the given key, first adding one like the inline
+  // StyleSelector to the root <Document> if there is none.
+  void ShareStyle(const FeaturePtr& feature, const string& key) {
+    std::map<string, string>::const_iterator iter = shared_ids_.find(key);
+    string style_id;
+    if (iter != shared_ids_.end()) {
+      style_id = iter->second;
+    } else {
+      const StyleSelectorPtr& styleselector = feature->get_styleselector();
+      style_id = GetSharedId(styleselector);
+      StyleSelectorPtr shared =
+          kmldom::AsStyleSelector(Clone(styleselector));
+      shared->set_id(style_id);
+      document_->add_styleselector(shared);
+      shared_ids_[key] = style_id;
+    }
+    feature->clear_styleselector();
+    feature->set_styleurl(string("#") + style_id);
+  }
+
+ private:
+  // Returns the id of the StyleSelector if no other Object has it, else an
+  // id no Object has.
+  string GetSharedId(const StyleSelectorPtr& styleselector) {
+    if (styleselector->has_id()) {
+      const string& id = styleselector->get_id();
+      ObjectIdMap::const_iterator iter = object_id_map_.find(id);
+      if (iter != object_id_map_.end() &&
+          iter->second.get() == styleselector.get() &&
+          duplicate_ids_.find(id) == duplicate_ids_.end()) {
+        return id;
+      }
+    }
+    for (;;) {
+      // xml:id cannot begin with a digit.
+      const string id(string("_") + kmlbase::ToString(id_counter_++));
+      if (object_id_map_.find(id) == object_id_map_.end() &&
+          used_ids_.insert(id).second) {
+        return id;
+      }
+    }
+  }
+
+  const DocumentPtr& document_;
+  const ObjectIdMap& object_id_map_;
+  const std::set<string>& duplicate_ids_;
+  // The generated ids.
+  std::set<string> used_ids_;
+  // The id of the shared StyleSelector of each structural key.
+  std::map<string, string> shared_ids_;
+  unsigned int id_counter_;
+};
+
+int DeduplicateStyles(const kmldom::ElementPtr& root) {
+  DocumentPtr document = kmldom::AsDocument(GetRootFeature(root));
+  if (!document) {
+    return 0;
+  }
+  InlineStyleCounter inline_style_counter;
+  VisitFeatureHierarchy(document, inline_style_counter);
+  const InlineStyleCounter::InlineStyleVector& inline_styles =
+      inline_style_counter.get_inline_styles();
+  if (inline_styles.empty()) {
+    return 0;
+  }
+  ObjectIdMap object_id_map;
+  ElementVector duplicates;
+  MapIds(root, &object_id_map, &duplicates);
+  std::set<string> duplicate_ids;
+  for (size_t i = 0; i < duplicates.size(); ++i) {
+    duplicate_ids.insert(kmldom::AsObject(duplicates[i])->get_id());
+  }
+  StyleDeduplicator style_deduplicator(document, object_id_map,
+                                       duplicate_ids);
+  int replaced_count = 0;
+  for (size_t i = 0; i < inline_styles.size(); ++i) {
+    const string& key = inline_styles[i].second;
+    if (inline_style_counter.GetCount(key) > 1 ||
+        style_deduplicator.HasShared(key)) {
+      style_deduplicator.ShareStyle(inline_styles[i].first, key);
+      ++replaced_count;
+    }
+  }
+  return replaced_count;
+}
+
+}  // end namespace kmlengine
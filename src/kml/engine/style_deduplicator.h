@@ -0,0 +1,63 @@
+// Copyright 2008, Google Inc. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//  3. Neither the name of Google Inc. nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// This file contains the declaration of the DeduplicateStyles function.
+
+#ifndef KML_ENGINE_STYLE_DEDUPLICATOR_H__
+#define KML_ENGINE_STYLE_DEDUPLICATOR_H__
+
+#include "kml/dom.h"
+
+namespace kmlengine {
+
+// This replaces the inline <Style> or <StyleMap> of each Feature by a
+// <styleUrl> to one shared StyleSelector on the root <Document> where that
+// inline StyleSelector is structurally identical to that of at least one
+// other Feature or to a shared StyleSelector already on the root <Document>.
+// An inline StyleSelector of which there is only one of its kind is left in
+// place.  Two StyleSelectors are identical if they serialize the same once
+// all id= attributes within them are cleared: colors, scales, hrefs,
+// substyles and Pairs must all match.  Each StyleSelector is serialized once
+// and counted by that key so the time taken is about linear in the size of
+// the styles.  An inline StyleSelector identical to a shared StyleSelector
+// already on the root <Document> uses that one.  Otherwise a copy of the
+// first of its kind is added to the root <Document>, keeping its own id if
+// that is unique in the KML or else given an id not used elsewhere.  No
+// existing shared StyleSelector is removed or renamed since other files may
+// refer to it.
+// As with SplitStyles() the following are left alone:
+// 1) a Feature not within the root <Document>'s hierarchy, such as within
+//    an <Update>
+// 2) a <Document>
+// 3) a Feature with both a <styleUrl> and an inline StyleSelector
+// The root is a <kml> with a <Document> or a <Document>.  This returns the
+// number of inline StyleSelectors replaced, or 0 if there is no <Document>.
+// Note that a KmlFile's shared style map is not updated: a KmlFile for the
+// result is best created from its serialization.
+int DeduplicateStyles(const kmldom::ElementPtr& root);
+
+}  // end namespace kmlengine
+
+#endif  // KML_ENGINE_STYLE_DEDUPLICATOR_H__
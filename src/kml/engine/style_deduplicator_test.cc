@@ -0,0 +1,292 @@
+// Copyright 2008, Google Inc. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//  3. Neither the name of Google Inc. nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// This file contains the unit tests for the DeduplicateStyles function.
+
+#include "kml/engine/style_deduplicator.h"
+#include "boost/scoped_ptr.hpp"
+#include "gtest/gtest.h"
+#include "kml/dom.h"
+#include "kml/engine/kml_file.h"
+#include "kml/engine/style_resolver.h"
+
+using kmldom::DocumentPtr;
+using kmldom::ElementPtr;
+using kmldom::FeaturePtr;
+using kmldom::FolderPtr;
+using kmldom::KmlPtr;
+using kmldom::PlacemarkPtr;
+using kmldom::StylePtr;
+
+namespace kmlengine {
+
+class StyleDeduplicatorTest : public testing::Test {
+ protected:
+  void Parse(const string& kml) {
+    root_ = kmldom::ParseKml(kml);
+    ASSERT_TRUE(root_);
+    document_ = kmldom::AsDocument(root_);
+    if (!document_) {
+      document_ = kmldom::AsDocument(kmldom::AsKml(root_)->get_feature());
+    }
+    ASSERT_TRUE(document_);
+  }
+
+  PlacemarkPtr GetPlacemark(size_t index) {
+    return kmldom::AsPlacemark(document_->get_feature_array_at(index));
+  }
+
+  // The resolved Style takes the id of the shared Style it came from.
+  static string SerializeResolvedStyle(const FeaturePtr& feature,
+                                       const KmlFilePtr& kml_file,
+                                       kmldom::StyleStateEnum style_state) {
+    StylePtr style = CreateResolvedStyle(feature, kml_file, style_state);
+    style->clear_id();
+    return kmldom::SerializePretty(style);
+  }
+
+  ElementPtr root_;
+  DocumentPtr document_;
+};
+
+TEST_F(StyleDeduplicatorTest, TestNoDocument) {
+  ASSERT_EQ(0, DeduplicateStyles(NULL));
+  ElementPtr placemark = kmldom::ParseKml(
+      "<Placemark><Style><IconStyle><scale>2</scale></IconStyle></Style>"
+      "</Placemark>");
+  ASSERT_EQ(0, DeduplicateStyles(placemark));
+  ASSERT_TRUE(kmldom::AsPlacemark(placemark)->has_styleselector());
+}
+
+TEST_F(StyleDeduplicatorTest, TestIdenticalStyles) {
+  // Styles differing only in id=, including that of a SubStyle.
+  Parse("<Document>"
+        "<Placemark><Style id=\"a\"><LineStyle id=\"x\"><width>2</width>"
+        "</LineStyle></Style></Placemark>"
+        "<Placemark><Style id=\"b\"><LineStyle><width>2</width>"
+        "</LineStyle></Style></Placemark>"
+        "<Placemark><Style><LineStyle><width>2</width>"
+        "</LineStyle></Style></Placemark>"
+        "</Document>");
+  ASSERT_EQ(3, DeduplicateStyles(root_));
+  // The shared Style keeps the id of the first of its kind.
+  ASSERT_EQ(static_cast<size_t>(1), document_->get_styleselector_array_size());
+  StylePtr style = kmldom::AsStyle(document_->get_styleselector_array_at(0));
+  ASSERT_EQ(string("a"), style->get_id());
+  ASSERT_EQ(string("x"), style->get_linestyle()->get_id());
+  ASSERT_DOUBLE_EQ(2.0, style->get_linestyle()->get_width());
+  for (size_t i = 0; i < 3; ++i) {
+    ASSERT_FALSE(GetPlacemark(i)->has_styleselector());
+    ASSERT_EQ(string("#a"), GetPlacemark(i)->get_styleurl());
+  }
+}
+
+TEST_F(StyleDeduplicatorTest, TestDifferentStyles) {
+  Parse("<Document>"
+        "<Placemark><Style><LineStyle><width>2</width>"
+        "</LineStyle></Style></Placemark>"
+        "<Placemark><Style><LineStyle><width>3</width>"
+        "</LineStyle></Style></Placemark>"
+        "<Placemark><Style><LineStyle><width>2</width>"
+        "</LineStyle></Style></Placemark>"
+        "</Document>");
+  ASSERT_EQ(2, DeduplicateStyles(root_));
+  ASSERT_EQ(static_cast<size_t>(1), document_->get_styleselector_array_size());
+  ASSERT_EQ(string("#_0"), GetPlacemark(0)->get_styleurl());
+  ASSERT_EQ(string("#_0"), GetPlacemark(2)->get_styleurl());
+  // The only Style of its kind stays inline.
+  ASSERT_FALSE(GetPlacemark(1)->has_styleurl());
+  ASSERT_TRUE(GetPlacemark(1)->has_styleselector());
+}
+
+TEST_F(StyleDeduplicatorTest, TestLoneInlineStyleUntouched) {
+  Parse("<Document>"
+        "<Style id=\"s\"><IconStyle/></Style>"
+        "<Placemark><Style id=\"i\"><LineStyle/></Style></Placemark>"
+        "</Document>");
+  const string kBefore(kmldom::SerializePretty(root_));
+  ASSERT_EQ(0, DeduplicateStyles(root_));
+  ASSERT_EQ(kBefore, kmldom::SerializePretty(root_));
+}
+
+TEST_F(StyleDeduplicatorTest, TestNoDuplicatesKeepsSource) {
+  // Finding no duplicates changes nothing in a KmlFile kept with its source
+  // so the file still serializes as it was parsed.
+  const string kKml(
+      "<kml xmlns=\"http://www.opengis.net/kml/2.2\">\n"
+      "<Document id=\"d\">\n"
+      "  <Style id=\"s\"><IconStyle id=\"is\"/></Style>\n"
+      "  <Placemark id=\"p\"><Style id=\"i\"><LineStyle id=\"ls\">"
+      "<width>2</width></LineStyle></Style></Placemark>\n"
+      "  <Placemark><Style><LineStyle><width>3</width></LineStyle></Style>"
+      "</Placemark>\n"
+      "</Document></kml>");
+  string kml(kKml);
+  KmlFilePtr kml_file = KmlFile::CreateFromSource(
+      kmldom::SourceBufferPtr(new kmldom::SourceBuffer(&kml)),
+      KmlFileOptions(), NULL);
+  ASSERT_TRUE(kml_file);
+  string before;
+  ASSERT_TRUE(kml_file->SerializeToString(&before));
+  ASSERT_EQ(0, DeduplicateStyles(kml_file->get_root()));
+  ASSERT_FALSE(kml_file->get_root()->get_source_range().empty());
+  string after;
+  ASSERT_TRUE(kml_file->SerializeToString(&after));
+  ASSERT_EQ(before, after);
+  const size_t document = kKml.find("<Document");
+  ASSERT_NE(string::npos,
+            after.find(kKml.substr(document, kKml.rfind("</kml>") - document)));
+}
+
+TEST_F(StyleDeduplicatorTest, TestStyleMaps) {
+  const string kStyleMap(
+      "<StyleMap>"
+      "<Pair><key>normal</key><styleUrl>#n</styleUrl></Pair>"
+      "<Pair><key>highlight</key><styleUrl>#h</styleUrl></Pair>"
+      "</StyleMap>");
+  Parse("<Document>"
+        "<Style id=\"n\"/><Style id=\"h\"><IconStyle/></Style>"
+        "<Placemark>" + kStyleMap + "</Placemark>"
+        "<Placemark>" + kStyleMap + "</Placemark>"
+        // A Style with the same content is not the same as a StyleMap.
+        "<Placemark><Style/></Placemark>"
+        "</Document>");
+  ASSERT_EQ(3, DeduplicateStyles(root_));
+  ASSERT_EQ(static_cast<size_t>(3), document_->get_styleselector_array_size());
+  ASSERT_TRUE(kmldom::AsStyleMap(document_->get_styleselector_array_at(2)));
+  ASSERT_EQ(string("#_0"), GetPlacemark(0)->get_styleurl());
+  ASSERT_EQ(string("#_0"), GetPlacemark(1)->get_styleurl());
+  // The empty inline Style is the same as the existing shared Style "n".
+  ASSERT_EQ(string("#n"), GetPlacemark(2)->get_styleurl());
+}
+
+TEST_F(StyleDeduplicatorTest, TestExistingSharedStyle) {
+  Parse("<kml><Document>"
+        "<Style id=\"s\"><PolyStyle><fill>0</fill></PolyStyle></Style>"
+        "<Style id=\"t\"><PolyStyle><fill>0</fill></PolyStyle></Style>"
+        "<Placemark><Style id=\"p\"><PolyStyle><fill>0</fill></PolyStyle>"
+        "</Style></Placemark>"
+        "</Document></kml>");
+  ASSERT_EQ(1, DeduplicateStyles(root_));
+  // Shared Styles are never removed even if identical.
+  ASSERT_EQ(static_cast<size_t>(2), document_->get_styleselector_array_size());
+  ASSERT_EQ(string("#s"), GetPlacemark(0)->get_styleurl());
+}
+
+TEST_F(StyleDeduplicatorTest, TestStyleUrlAndDocumentUntouched) {
+  Parse("<Document>"
+        "<Style><IconStyle/></Style>"
+        "<Placemark><styleUrl>#x</styleUrl><Style/></Placemark>"
+        "<Document><Style/></Document>"
+        "</Document>");
+  ASSERT_EQ(0, DeduplicateStyles(root_));
+  ASSERT_TRUE(GetPlacemark(0)->has_styleselector());
+  ASSERT_EQ(string("#x"), GetPlacemark(0)->get_styleurl());
+  // The Style of a Document is a shared Style of that Document.
+  DocumentPtr document =
+      kmldom::AsDocument(document_->get_feature_array_at(1));
+  ASSERT_EQ(static_cast<size_t>(1), document->get_styleselector_array_size());
+  ASSERT_EQ(static_cast<size_t>(1), document_->get_styleselector_array_size());
+}
+
+TEST_F(StyleDeduplicatorTest, TestIdCollision) {
+  // The first inline Style's id is used elsewhere as is "_0".
+  Parse("<Document>"
+        "<Placemark id=\"_0\"><Style id=\"dup\"/></Placemark>"
+        "<Placemark id=\"dup\"><Style/></Placemark>"
+        "</Document>");
+  ASSERT_EQ(2, DeduplicateStyles(root_));
+  ASSERT_EQ(static_cast<size_t>(1), document_->get_styleselector_array_size());
+  ASSERT_EQ(string("_1"), document_->get_styleselector_array_at(0)->get_id());
+  ASSERT_EQ(string("#_1"), GetPlacemark(0)->get_styleurl());
+  ASSERT_EQ(string("#_1"), GetPlacemark(1)->get_styleurl());
+}
+
+TEST_F(StyleDeduplicatorTest, TestNestedFolders) {
+  const string kStyle("<Style><LabelStyle><scale>0</scale></LabelStyle>"
+                      "</Style>");
+  Parse("<Document>"
+        "<Folder>" + kStyle +
+        "<Folder><Placemark>" + kStyle + "</Placemark></Folder>"
+        "</Folder>"
+        "<Placemark>" + kStyle + "</Placemark>"
+        "</Document>");
+  ASSERT_EQ(3, DeduplicateStyles(root_));
+  ASSERT_EQ(static_cast<size_t>(1), document_->get_styleselector_array_size());
+  FolderPtr folder = kmldom::AsFolder(document_->get_feature_array_at(0));
+  ASSERT_EQ(string("#_0"), folder->get_styleurl());
+  FolderPtr inner = kmldom::AsFolder(folder->get_feature_array_at(0));
+  ASSERT_EQ(string("#_0"),
+            inner->get_feature_array_at(0)->get_styleurl());
+  ASSERT_EQ(string("#_0"), GetPlacemark(1)->get_styleurl());
+}
+
+// Every Feature resolves to the same Style after deduplication as before.
+TEST_F(StyleDeduplicatorTest, TestResolvedStylesUnchanged) {
+  const string kKml(
+      "<kml><Document>"
+      "<Style id=\"n\"><IconStyle><scale>1.1</scale></IconStyle></Style>"
+      "<Style id=\"h\"><IconStyle><scale>1.5</scale></IconStyle></Style>"
+      "<Placemark><Style><IconStyle><color>ff0000ff</color></IconStyle>"
+      "<LineStyle><width>4</width></LineStyle></Style></Placemark>"
+      "<Placemark><Style id=\"y\"><IconStyle><color>ff0000ff</color>"
+      "</IconStyle><LineStyle><width>4</width></LineStyle></Style>"
+      "</Placemark>"
+      "<Placemark><StyleMap><Pair><key>normal</key><styleUrl>#n</styleUrl>"
+      "</Pair><Pair><key>highlight</key><styleUrl>#h</styleUrl></Pair>"
+      "</StyleMap></Placemark>"
+      "<Placemark><Style><IconStyle><color>ff00ff00</color></IconStyle>"
+      "</Style></Placemark>"
+      "</Document></kml>");
+  KmlFilePtr before(KmlFile::CreateFromParse(kKml, NULL));
+  ASSERT_TRUE(before);
+  Parse(kKml);
+  ASSERT_EQ(2, DeduplicateStyles(root_));
+  KmlFilePtr after(
+      KmlFile::CreateFromParse(kmldom::SerializePretty(root_), NULL));
+  ASSERT_TRUE(after);
+  DocumentPtr before_document = kmldom::AsDocument(
+      kmldom::AsKml(before->get_root())->get_feature());
+  DocumentPtr after_document = kmldom::AsDocument(
+      kmldom::AsKml(after->get_root())->get_feature());
+  ASSERT_EQ(static_cast<size_t>(3),
+            after_document->get_styleselector_array_size());
+  for (size_t i = 0; i < 4; ++i) {
+    const FeaturePtr before_feature = before_document->get_feature_array_at(i);
+    const FeaturePtr after_feature = after_document->get_feature_array_at(i);
+    ASSERT_EQ(
+        SerializeResolvedStyle(before_feature, before,
+                               kmldom::STYLESTATE_NORMAL),
+        SerializeResolvedStyle(after_feature, after,
+                               kmldom::STYLESTATE_NORMAL));
+    ASSERT_EQ(
+        SerializeResolvedStyle(before_feature, before,
+                               kmldom::STYLESTATE_HIGHLIGHT),
+        SerializeResolvedStyle(after_feature, after,
+                               kmldom::STYLESTATE_HIGHLIGHT));
+  }
+}
+
+}  // end namespace kmlengine
@@ -0,0 +1,426 @@
+// Copyright 2008, Google Inc. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//  3. Neither the name of Google Inc. nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// This file contains the implementation of the TimeIndex class.
+
+#include "kml/engine/time_index.h"
+#include <functional>
+#include <limits>
+#include "kml/base/date_time.h"
+
+using kmldom::AsContainer;
+using kmldom::AsFeature;
+using kmldom::AsGxMultiTrack;
+using kmldom::AsGxTrack;
+using kmldom::AsKml;
+using kmldom::AsMultiGeometry;
+using kmldom::AsPlacemark;
+using kmldom::ContainerPtr;
+using kmldom::ElementPtr;
+using kmldom::FeaturePtr;
+using kmldom::GeometryPtr;
+using kmldom::GxMultiTrackPtr;
+using kmldom::GxTrackPtr;
+using kmldom::KmlPtr;
+using kmldom::MultiGeometryPtr;
+using kmldom::PlacemarkPtr;
+using kmldom::TimePrimitivePtr;
+using kmldom::TimeSpan;
+using kmldom::TimeSpanPtr;
+using kmldom::TimeStamp;
+using kmldom::TimeStampPtr;
+
+namespace kmlengine {
+
+struct TimeIndex::Node {
+  Node(const Entry* entry_, uint32_t priority_)
+    : entry(entry_), priority(priority_), max_end(entry_->end),
+      left(NULL), right(NULL) {
+  }
+  const Entry* entry;
+  uint32_t priority;
+  // The latest end of any interval in this subtree.
+  int64_t max_end;
+  Node* left;
+  Node* right;
+};
+
+static bool ParseTime(const string& str, int64_t* time) {
+  kmlbase::DateTime date_time;
+  if (!kmlbase::DateTime::Parse(str.data(), str.size(), &date_time)) {
+    return false;
+  }
+  *time = date_time.get_seconds();
+  return true;
+}
+
+// This widens the interval to include the <when>'s of each <gx:Track> in the
+// geometry.  The found flag is set if any <when> is found.
+static bool AddTrackTimes(const GeometryPtr& geometry, bool* found,
+                          int64_t* begin, int64_t* end) {
+  if (GxTrackPtr gx_track = AsGxTrack(geometry)) {
+    const std::vector<int64_t>& whens = gx_track->get_when_times();
+    for (size_t i = 0; i < whens.size(); ++i) {
+      if (!gx_track->has_when_time_at(i)) {
+        return false;
+      }
+      const int64_t when = whens[i];
+      if (!*found || when < *begin) {
+        *begin = when;
+      }
+      if (!*found || when > *end) {
+        *end = when;
+      }
+      *found = true;
+    }
+  } else if (GxMultiTrackPtr gx_multitrack = AsGxMultiTrack(geometry)) {
+    for (size_t i = 0; i < gx_multitrack->get_gx_track_array_size(); ++i) {
+      if (!AddTrackTimes(gx_multitrack->get_gx_track_array_at(i), found,
+                         begin, end)) {
+        return false;
+      }
+    }
+  } else if (MultiGeometryPtr multigeometry = AsMultiGeometry(geometry)) {
+    for (size_t i = 0; i < multigeometry->get_geometry_array_size(); ++i) {
+      if (!AddTrackTimes(multigeometry->get_geometry_array_at(i), found,
+                         begin, end)) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+// static
+bool TimeIndex::GetFeatureInterval(const FeaturePtr& feature, int64_t* begin,
+                                   int64_t* end) {
+  if (!feature || !begin || !end) {
+    return false;
+  }
+  // Unlike AsTimeSpan() and AsTimeStamp() this also matches <gx:TimeSpan>
+  // and <gx:TimeStamp>.
+  const TimePrimitivePtr& timeprimitive = feature->get_timeprimitive();
+  if (timeprimitive && timeprimitive->IsA(kmldom::Type_TimeSpan)) {
+    TimeSpanPtr timespan = boost::static_pointer_cast<TimeSpan>(timeprimitive);
+    *begin = std::numeric_limits<int64_t>::min();
+    *end = std::numeric_limits<int64_t>::max();
+    if (timespan->has_begin() && !ParseTime(timespan->get_begin(), begin)) {
+      return false;
+    }
+    if (timespan->has_end() && !ParseTime(timespan->get_end(), end)) {
+      return false;
+    }
+    return *begin <= *end;
+  }
+  if (timeprimitive && timeprimitive->IsA(kmldom::Type_TimeStamp)) {
+    TimeStampPtr timestamp =
+        boost::static_pointer_cast<TimeStamp>(timeprimitive);
+    if (!timestamp->has_when() || !ParseTime(timestamp->get_when(), begin)) {
+      return false;
+    }
+    *end = *begin;
+    return true;
+  }
+  if (PlacemarkPtr placemark = AsPlacemark(feature)) {
+    bool found = false;
+    return AddTrackTimes(placemark->get_geometry(), &found, begin, end) &&
+           found;
+  }
+  return false;
+}
+
+TimeIndex::TimeIndex()
+  : root_(NULL),
+    seed_(1) {
+}
+
+TimeIndex::~TimeIndex() {
+  DeleteNodes(root_);
+}
+
+void TimeIndex::AddFeatures(const ElementPtr& root) {
+  if (KmlPtr kml = AsKml(root)) {
+    AddFeatures(kml->get_feature());
+  } else if (FeaturePtr feature = AsFeature(root)) {
+    IndexFeature(feature);
+    if (ContainerPtr container = AsContainer(feature)) {
+      for (size_t i = 0; i < container->get_feature_array_size(); ++i) {
+        AddFeatures(container->get_feature_array_at(i));
+      }
+    }
+  }
+}
+
+void TimeIndex::RemoveFeatures(const ElementPtr& root) {
+  if (KmlPtr kml = AsKml(root)) {
+    RemoveFeatures(kml->get_feature());
+  } else if (FeaturePtr feature = AsFeature(root)) {
+    RemoveFeature(feature);
+    if (ContainerPtr container = AsContainer(feature)) {
+      for (size_t i = 0; i < container->get_feature_array_size(); ++i) {
+        RemoveFeatures(container->get_feature_array_at(i));
+      }
+    }
+  }
+}
+
+bool TimeIndex::IndexFeature(const FeaturePtr& feature) {
+  int64_t begin;
+  int64_t end;
+  if (!GetFeatureInterval(feature, &begin, &end)) {
+    RemoveFeature(feature);
+    return false;
+  }
+  EntryMap::iterator find = entry_map_.find(feature.get());
+  if (find != entry_map_.end()) {
+    Entry* entry = &find->second;
+    if (entry->begin != begin || entry->end != end) {
+      Erase(entry);
+      entry->begin = begin;
+      entry->end = end;
+      Insert(entry);
+    }
+    return true;
+  }
+  Entry* entry = &entry_map_[feature.get()];
+  entry->feature = feature;
+  entry->begin = begin;
+  entry->end = end;
+  Insert(entry);
+  return true;
+}
+
+bool TimeIndex::RemoveFeature(const FeaturePtr& feature) {
+  EntryMap::iterator find = entry_map_.find(feature.get());
+  if (find == entry_map_.end()) {
+    return false;
+  }
+  Erase(&find->second);
+  entry_map_.erase(find);
+  return true;
+}
+
+bool TimeIndex::GetInterval(const FeaturePtr& feature, int64_t* begin,
+                            int64_t* end) const {
+  EntryMap::const_iterator find = entry_map_.find(feature.get());
+  if (find == entry_map_.end()) {
+    return false;
+  }
+  if (begin) {
+    *begin = find->second.begin;
+  }
+  if (end) {
+    *end = find->second.end;
+  }
+  return true;
+}
+
+void TimeIndex::FindInWindow(int64_t begin, int64_t end,
+                             FeatureVector* features) const {
+  if (features && begin <= end) {
+    FindNodes(root_, begin, end, features);
+  }
+}
+
+// When moving forward in time a Feature appears if its interval starts
+// after from and ends no earlier than to, and disappears if its interval
+// ends before to and starts no later than from.  Moving backward is the
+// mirror image.
+void TimeIndex::FindChanges(int64_t from, int64_t to, FeatureVector* appeared,
+                            FeatureVector* disappeared) const {
+  if (from == to) {
+    return;
+  }
+  const int64_t earlier = from < to ? from : to;
+  const int64_t later = from < to ? to : from;
+  FeatureVector* starting = from < to ? appeared : disappeared;
+  FeatureVector* ending = from < to ? disappeared : appeared;
+  if (starting) {
+    FindStarts(root_, earlier, later, later, starting);
+  }
+  if (ending) {
+    EndMap::const_iterator iter = end_map_.lower_bound(earlier);
+    for (; iter != end_map_.end() && iter->first < later; ++iter) {
+      if (iter->second->begin <= earlier) {
+        ending->push_back(iter->second->feature);
+      }
+    }
+  }
+}
+
+void TimeIndex::Insert(const Entry* entry) {
+  // A linear congruential generator is ample for treap priorities.
+  seed_ = seed_ * 1664525 + 1013904223;
+  root_ = InsertNode(root_, new Node(entry, seed_));
+  end_map_.insert(std::make_pair(entry->end, entry));
+}
+
+void TimeIndex::Erase(const Entry* entry) {
+  root_ = EraseNode(root_, entry);
+  std::pair<EndMap::iterator, EndMap::iterator> range =
+      end_map_.equal_range(entry->end);
+  for (EndMap::iterator iter = range.first; iter != range.second; ++iter) {
+    if (iter->second == entry) {
+      end_map_.erase(iter);
+      break;
+    }
+  }
+}
+
+// The treap is ordered by the start of each interval and then by the address
+// of the Entry such that each Entry has a unique place.
+// static
+bool TimeIndex::Precedes(const Entry* a, const Entry* b) {
+  if (a->begin != b->begin) {
+    return a->begin < b->begin;
+  }
+  return std::less<const Entry*>()(a, b);
+}
+
+// static
+void TimeIndex::UpdateNode(Node* node) {
+  node->max_end = node->entry->end;
+  if (node->left && node->left->max_end > node->max_end) {
+    node->max_end = node->left->max_end;
+  }
+  if (node->right && node->right->max_end > node->max_end) {
+    node->max_end = node->right->max_end;
+  }
+}
+
+// static
+TimeIndex::Node* TimeIndex::InsertNode(Node* root, Node* node) {
+  if (!root) {
+    return node;
+  }
+  if (Precedes(node->entry, root->entry)) {
+    root->left = InsertNode(root->left, node);
+    if (root->left->priority > root->priority) {
+      Node* left = root->left;
+      root->left = left->right;
+      left->right = root;
+      UpdateNode(root);
+      root = left;
+    }
+  } else {
+    root->right = InsertNode(root->right, node);
+    if (root->right->priority > root->priority) {
+      Node* right = root->right;
+      root->right = right->left;
+      right->left = root;
+      UpdateNode(root);
+      root = right;
+    }
+  }
+  UpdateNode(root);
+  return root;
+}
+
+// static
+TimeIndex::Node* TimeIndex::EraseNode(Node* root, const Entry* entry) {
+  if (!root) {
+    return NULL;
+  }
+  if (root->entry == entry) {
+    Node* merged = MergeNodes(root->left, root->right);
+    delete root;
+    return merged;
+  }
+  if (Precedes(entry, root->entry)) {
+    root->left = EraseNode(root->left, entry);
+  } else {
+    root->right = EraseNode(root->right, entry);
+  }
+  UpdateNode(root);
+  return root;
+}
+
+// Every node in left precedes every node in right.
+// static
+TimeIndex::Node* TimeIndex::MergeNodes(Node* left, Node* right) {
+  if (!left) {
+    return right;
+  }
+  if (!right) {
+    return left;
+  }
+  if (left->priority > right->priority) {
+    left->right = MergeNodes(left->right, right);
+    UpdateNode(left);
+    return left;
+  }
+  right->left = MergeNodes(left, right->left);
+  UpdateNode(right);
+  return right;
+}
+
+// static
+void TimeIndex::DeleteNodes(Node* node) {
+  if (node) {
+    DeleteNodes(node->left);
+    DeleteNodes(node->right);
+    delete node;
+  }
+}
+
+// Subtrees which end before the window are skipped, as is everything after a
+// node which starts after the window.
+// static
+void TimeIndex::FindNodes(const Node* node, int64_t begin, int64_t end,
+                          FeatureVector* features) {
+  if (!node || node->max_end < begin) {
+    return;
+  }
+  FindNodes(node->left, begin, end, features);
+  if (node->entry->begin > end) {
+    return;
+  }
+  if (node->entry->end >= begin) {
+    features->push_back(node->entry->feature);
+  }
+  FindNodes(node->right, begin, end, features);
+}
+
+// This finds each interval which starts in (after, until] and ends no
+// earlier than min_end.
+// static
+void TimeIndex::FindStarts(const Node* node, int64_t after, int64_t until,
+                           int64_t min_end, FeatureVector* features) {
+  if (!node || node->max_end < min_end) {
+    return;
+  }
+  if (node->entry->begin > after) {
+    FindStarts(node->left, after, until, min_end, features);
+  }
+  if (node->entry->begin > until) {
+    return;
+  }
+  if (node->entry->begin > after && node->entry->end >= min_end) {
+    features->push_back(node->entry->feature);
+  }
+  FindStarts(node->right, after, until, min_end, features);
+}
+
+}  // end namespace kmlengine
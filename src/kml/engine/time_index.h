@@ -0,0 +1,133 @@
+// Copyright 2008, Google Inc. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//  3. Neither the name of Google Inc. nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// This file contains the declaration of the TimeIndex class.
+
+#ifndef KML_ENGINE_TIME_INDEX_H__
+#define KML_ENGINE_TIME_INDEX_H__
+
+#include <map>
+#include <vector>
+#include "kml/base/util.h"
+#include "kml/dom.h"
+
+namespace kmlengine {
+
+typedef std::vector<kmldom::FeaturePtr> FeatureVector;
+
+// The TimeIndex holds the time interval of each Feature with a time in an
+// interval tree.  The time of a Feature is that of its <TimeStamp> or
+// <TimeSpan> (or <gx:TimeStamp> or <gx:TimeSpan>) or, if it has no time
+// primitive, the span of the <when>'s of each <gx:Track> in its geometry.
+// Times are POSIX seconds.  A <TimeStamp> is an interval of one instant and a
+// <TimeSpan> with no <begin> or <end> is open on that side.  Features with no
+// time, or with a time which does not parse, are not held in the index.
+// Building the index parses each time once.  Each query costs O(log n) plus
+// the number of Features found.  A Feature may be indexed, re-indexed and
+// removed at any time.  KmlFile::GetTimeIndex() provides a TimeIndex for a
+// KmlFile which ProcessUpdate() keeps current.
+class TimeIndex {
+ public:
+  TimeIndex();
+  ~TimeIndex();
+
+  // Index each Feature in the hierarchy rooted at the given element.
+  void AddFeatures(const kmldom::ElementPtr& root);
+
+  // Remove each Feature in the hierarchy rooted at the given element.
+  void RemoveFeatures(const kmldom::ElementPtr& root);
+
+  // Index the Feature, replacing any previous interval for this Feature.  If
+  // the Feature no longer has a time it is removed and false is returned.
+  bool IndexFeature(const kmldom::FeaturePtr& feature);
+
+  // Remove the Feature.  This returns false if the Feature was not indexed.
+  bool RemoveFeature(const kmldom::FeaturePtr& feature);
+
+  // The number of Features in the index.
+  size_t size() const {
+    return entry_map_.size();
+  }
+
+  // This returns the interval of the given Feature as held in the index.
+  bool GetInterval(const kmldom::FeaturePtr& feature, int64_t* begin,
+                   int64_t* end) const;
+
+  // Append each Feature whose interval overlaps the closed window [begin,
+  // end].  The Features are appended in order of the start of their interval.
+  void FindInWindow(int64_t begin, int64_t end, FeatureVector* features) const;
+
+  // Append each Feature whose interval includes the given time.
+  void FindAtTime(int64_t time, FeatureVector* features) const {
+    FindInWindow(time, time, features);
+  }
+
+  // This is for a time slider moved from one time to another.  Each Feature
+  // which is found at the to time but not the from time is appended to
+  // appeared and each Feature found at the from time but not the to time is
+  // appended to disappeared.  The cost is proportional to the number of
+  // intervals which start or end between the two times.  Either vector may
+  // be NULL.
+  void FindChanges(int64_t from, int64_t to, FeatureVector* appeared,
+                   FeatureVector* disappeared) const;
+
+  // This computes the interval of the given Feature as described above.
+  static bool GetFeatureInterval(const kmldom::FeaturePtr& feature,
+                                 int64_t* begin, int64_t* end);
+
+ private:
+  struct Entry {
+    kmldom::FeaturePtr feature;
+    int64_t begin;
+    int64_t end;
+  };
+  struct Node;
+  void Insert(const Entry* entry);
+  void Erase(const Entry* entry);
+  static bool Precedes(const Entry* a, const Entry* b);
+  static void UpdateNode(Node* node);
+  static Node* InsertNode(Node* root, Node* node);
+  static Node* EraseNode(Node* root, const Entry* entry);
+  static Node* MergeNodes(Node* left, Node* right);
+  static void DeleteNodes(Node* node);
+  static void FindNodes(const Node* node, int64_t begin, int64_t end,
+                        FeatureVector* features);
+  static void FindStarts(const Node* node, int64_t after, int64_t until,
+                         int64_t min_end, FeatureVector* features);
+  typedef std::map<const kmldom::Feature*, Entry> EntryMap;
+  EntryMap entry_map_;
+  // The root of a treap ordered by the start of each interval in which each
+  // node holds the latest end in its subtree.
+  Node* root_;
+  // All intervals ordered by their end.
+  typedef std::multimap<int64_t, const Entry*> EndMap;
+  EndMap end_map_;
+  uint32_t seed_;
+  LIBKML_DISALLOW_EVIL_CONSTRUCTORS(TimeIndex);
+};
+
+}  // end namespace kmlengine
+
+#endif  // KML_ENGINE_TIME_INDEX_H__
@@ -0,0 +1,277 @@
+// Copyright 2008, Google Inc. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//  3. Neither the name of Google Inc. nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// This file contains the unit tests for the TimeIndex class.
+
+#include "kml/engine/time_index.h"
+#include <stdlib.h>
+#include <time.h>
+#include <algorithm>
+#include "gtest/gtest.h"
+#include "kml/dom.h"
+#include "kml/engine/kml_file.h"
+#include "kml/engine/update.h"
+
+using kmldom::AsFeature;
+using kmldom::FeaturePtr;
+using kmldom::FolderPtr;
+using kmldom::KmlFactory;
+using kmldom::PlacemarkPtr;
+using kmldom::TimeSpanPtr;
+
+namespace kmlengine {
+
+// 2008-10-03T09:25:42Z
+static const int64_t kTime = 1223025942;
+
+static string FormatTime(int64_t time) {
+  time_t time_t_time = static_cast<time_t>(time);
+  struct tm tm;
+  gmtime_r(&time_t_time, &tm);
+  char buf[32];
+  strftime(buf, sizeof(buf), "%Y-%m-%dT%H:%M:%SZ", &tm);
+  return buf;
+}
+
+static FeaturePtr CreateFeature(const string& kml) {
+  return AsFeature(kmldom::ParseKml(kml));
+}
+
+static TimeSpanPtr CreateTimeSpan(int64_t begin, int64_t end) {
+  TimeSpanPtr timespan = KmlFactory::GetFactory()->CreateTimeSpan();
+  timespan->set_begin(FormatTime(begin));
+  timespan->set_end(FormatTime(end));
+  return timespan;
+}
+
+// Create a Placemark with a <TimeSpan> of the given times.
+static PlacemarkPtr CreateTimeSpanPlacemark(int64_t begin, int64_t end) {
+  PlacemarkPtr placemark = KmlFactory::GetFactory()->CreatePlacemark();
+  placemark->set_timeprimitive(CreateTimeSpan(begin, end));
+  return placemark;
+}
+
+TEST(TimeIndexTest, TestGetFeatureInterval) {
+  int64_t begin;
+  int64_t end;
+  ASSERT_FALSE(TimeIndex::GetFeatureInterval(NULL, &begin, &end));
+  ASSERT_FALSE(TimeIndex::GetFeatureInterval(
+      CreateFeature("<Placemark/>"), &begin, &end));
+  ASSERT_FALSE(TimeIndex::GetFeatureInterval(
+      CreateFeature("<Placemark><TimeStamp/></Placemark>"), &begin, &end));
+  ASSERT_FALSE(TimeIndex::GetFeatureInterval(
+      CreateFeature("<Placemark><TimeStamp><when>never</when></TimeStamp>"
+                    "</Placemark>"), &begin, &end));
+
+  ASSERT_TRUE(TimeIndex::GetFeatureInterval(
+      CreateFeature("<Placemark><TimeStamp><when>2008-10-03T09:25:42Z</when>"
+                    "</TimeStamp></Placemark>"), &begin, &end));
+  ASSERT_EQ(kTime, begin);
+  ASSERT_EQ(kTime, end);
+
+  ASSERT_TRUE(TimeIndex::GetFeatureInterval(
+      CreateFeature("<Folder><TimeSpan><begin>2008-10-03T09:25:42Z</begin>"
+                    "<end>2008-10-03T09:25:52Z</end></TimeSpan></Folder>"),
+      &begin, &end));
+  ASSERT_EQ(kTime, begin);
+  ASSERT_EQ(kTime + 10, end);
+
+  // An open <TimeSpan>.
+  ASSERT_TRUE(TimeIndex::GetFeatureInterval(
+      CreateFeature("<Placemark><TimeSpan><begin>2008-10-03T09:25:42Z"
+                    "</begin></TimeSpan></Placemark>"), &begin, &end));
+  ASSERT_EQ(kTime, begin);
+  ASSERT_EQ(std::numeric_limits<int64_t>::max(), end);
+  // A <TimeSpan> which ends before it begins.
+  ASSERT_FALSE(TimeIndex::GetFeatureInterval(
+      CreateFeature("<Folder><TimeSpan><begin>2008-10-03T09:25:42Z</begin>"
+                    "<end>2008-10-03T09:25:32Z</end></TimeSpan></Folder>"),
+      &begin, &end));
+
+  // <gx:TimeSpan>
+  ASSERT_TRUE(TimeIndex::GetFeatureInterval(
+      CreateFeature("<Placemark xmlns:gx=\"http://www.google.com/kml/ext/2.2\">"
+                    "<gx:TimeSpan><end>2008-10-03T09:25:42Z</end>"
+                    "</gx:TimeSpan></Placemark>"), &begin, &end));
+  ASSERT_EQ(std::numeric_limits<int64_t>::min(), begin);
+  ASSERT_EQ(kTime, end);
+
+  // The <when>'s of the <gx:Track>'s in a <gx:MultiTrack>.
+  ASSERT_TRUE(TimeIndex::GetFeatureInterval(
+      CreateFeature("<Placemark xmlns:gx=\"http://www.google.com/kml/ext/2.2\">"
+                    "<gx:MultiTrack>"
+                    "<gx:Track><when>2008-10-03T09:25:52Z</when>"
+                    "<when>2008-10-03T09:25:42Z</when></gx:Track>"
+                    "<gx:Track><when>2008-10-03T09:26:42Z</when></gx:Track>"
+                    "</gx:MultiTrack></Placemark>"), &begin, &end));
+  ASSERT_EQ(kTime, begin);
+  ASSERT_EQ(kTime + 60, end);
+}
+
+TEST(TimeIndexTest, TestIndexAndFind) {
+  TimeIndex time_index;
+  ASSERT_EQ(static_cast<size_t>(0), time_index.size());
+  FolderPtr folder = KmlFactory::GetFactory()->CreateFolder();
+  PlacemarkPtr a = CreateTimeSpanPlacemark(kTime, kTime + 10);
+  PlacemarkPtr b = CreateTimeSpanPlacemark(kTime + 5, kTime + 20);
+  PlacemarkPtr c = CreateTimeSpanPlacemark(kTime + 30, kTime + 40);
+  folder->add_feature(a);
+  folder->add_feature(b);
+  folder->add_feature(c);
+  folder->add_feature(KmlFactory::GetFactory()->CreatePlacemark());
+  time_index.AddFeatures(folder);
+  ASSERT_EQ(static_cast<size_t>(3), time_index.size());
+
+  FeatureVector features;
+  time_index.FindAtTime(kTime + 7, &features);
+  ASSERT_EQ(static_cast<size_t>(2), features.size());
+  ASSERT_EQ(a, features[0]);
+  ASSERT_EQ(b, features[1]);
+  features.clear();
+  time_index.FindInWindow(kTime + 15, kTime + 30, &features);
+  ASSERT_EQ(static_cast<size_t>(2), features.size());
+  ASSERT_EQ(b, features[0]);
+  ASSERT_EQ(c, features[1]);
+  features.clear();
+  time_index.FindInWindow(kTime + 41, kTime + 50, &features);
+  ASSERT_TRUE(features.empty());
+
+  // Re-index a Feature whose time changed.
+  a->set_timeprimitive(CreateTimeSpan(kTime + 35, kTime + 36));
+  ASSERT_TRUE(time_index.IndexFeature(a));
+  ASSERT_EQ(static_cast<size_t>(3), time_index.size());
+  int64_t begin;
+  int64_t end;
+  ASSERT_TRUE(time_index.GetInterval(a, &begin, &end));
+  ASSERT_EQ(kTime + 35, begin);
+  ASSERT_EQ(kTime + 36, end);
+  features.clear();
+  time_index.FindAtTime(kTime + 35, &features);
+  ASSERT_EQ(static_cast<size_t>(2), features.size());
+  ASSERT_EQ(c, features[0]);
+  ASSERT_EQ(a, features[1]);
+
+  ASSERT_TRUE(time_index.RemoveFeature(b));
+  ASSERT_FALSE(time_index.RemoveFeature(b));
+  ASSERT_FALSE(time_index.GetInterval(b, NULL, NULL));
+  time_index.RemoveFeatures(folder);
+  ASSERT_EQ(static_cast<size_t>(0), time_index.size());
+  features.clear();
+  time_index.FindInWindow(kTime, kTime + 100, &features);
+  ASSERT_TRUE(features.empty());
+}
+
+// This compares the queries to a linear scan of many random intervals.
+TEST(TimeIndexTest, TestQueriesMatchScan) {
+  srand(1);
+  const int kNumFeatures = 500;
+  const int kRange = 1000;
+  TimeIndex time_index;
+  std::vector<PlacemarkPtr> placemarks;
+  std::vector<std::pair<int64_t, int64_t> > intervals;
+  for (int i = 0; i < kNumFeatures; ++i) {
+    const int64_t begin = kTime + rand() % kRange;
+    const int64_t end = begin + rand() % (i % 10 == 0 ? kRange : 20);
+    placemarks.push_back(CreateTimeSpanPlacemark(begin, end));
+    intervals.push_back(std::make_pair(begin, end));
+    ASSERT_TRUE(time_index.IndexFeature(placemarks.back()));
+  }
+  for (int i = 0; i < 200; ++i) {
+    const int64_t a = kTime - 10 + rand() % (kRange + 20);
+    const int64_t b = kTime - 10 + rand() % (kRange + 20);
+    std::vector<FeaturePtr> expected_window;
+    std::vector<FeaturePtr> expected_appeared;
+    std::vector<FeaturePtr> expected_disappeared;
+    for (int j = 0; j < kNumFeatures; ++j) {
+      const bool at_a = intervals[j].first <= a && a <= intervals[j].second;
+      const bool at_b = intervals[j].first <= b && b <= intervals[j].second;
+      if (intervals[j].first <= std::max(a, b) &&
+          intervals[j].second >= std::min(a, b)) {
+        expected_window.push_back(placemarks[j]);
+      }
+      if (at_b && !at_a) {
+        expected_appeared.push_back(placemarks[j]);
+      }
+      if (at_a && !at_b) {
+        expected_disappeared.push_back(placemarks[j]);
+      }
+    }
+    FeatureVector window;
+    time_index.FindInWindow(std::min(a, b), std::max(a, b), &window);
+    FeatureVector appeared;
+    FeatureVector disappeared;
+    time_index.FindChanges(a, b, &appeared, &disappeared);
+    std::sort(expected_window.begin(), expected_window.end());
+    std::sort(window.begin(), window.end());
+    ASSERT_TRUE(expected_window == window);
+    std::sort(expected_appeared.begin(), expected_appeared.end());
+    std::sort(appeared.begin(), appeared.end());
+    ASSERT_TRUE(expected_appeared == appeared);
+    std::sort(expected_disappeared.begin(), expected_disappeared.end());
+    std::sort(disappeared.begin(), disappeared.end());
+    ASSERT_TRUE(expected_disappeared == disappeared);
+  }
+}
+
+// ProcessUpdate() keeps the TimeIndex of a KmlFile current.
+TEST(TimeIndexTest, TestKmlFileTimeIndex) {
+  KmlFilePtr kml_file = KmlFile::CreateFromString(
+      "<Document id=\"d\">"
+      "<Placemark id=\"a\"><TimeStamp id=\"ts\">"
+      "<when>2008-10-03T09:25:42Z</when></TimeStamp></Placemark>"
+      "<Placemark id=\"b\"><TimeStamp>"
+      "<when>2008-10-03T09:25:52Z</when></TimeStamp></Placemark>"
+      "</Document>");
+  ASSERT_TRUE(kml_file);
+  const TimeIndex& time_index = kml_file->GetTimeIndex();
+  ASSERT_EQ(static_cast<size_t>(2), time_index.size());
+  ASSERT_EQ(&time_index, &kml_file->GetTimeIndex());
+
+  ProcessUpdate(kmldom::AsUpdate(kmldom::ParseKml(
+      "<Update>"
+      "<Delete><Placemark targetId=\"b\"/></Delete>"
+      "<Change><TimeStamp targetId=\"ts\">"
+      "<when>2008-10-03T09:26:42Z</when></TimeStamp></Change>"
+      "<Create><Document targetId=\"d\">"
+      "<Placemark id=\"c\"><TimeStamp>"
+      "<when>2008-10-03T09:25:42Z</when></TimeStamp></Placemark>"
+      "</Document></Create>"
+      "</Update>")), kml_file);
+
+  ASSERT_EQ(static_cast<size_t>(2), time_index.size());
+  FeatureVector features;
+  time_index.FindAtTime(kTime, &features);
+  ASSERT_EQ(static_cast<size_t>(1), features.size());
+  ASSERT_EQ(kml_file->GetObjectById("c"), features[0]);
+  features.clear();
+  time_index.FindAtTime(kTime + 60, &features);
+  ASSERT_EQ(static_cast<size_t>(1), features.size());
+  ASSERT_EQ(kml_file->GetObjectById("a"), features[0]);
+  features.clear();
+  time_index.FindAtTime(kTime + 10, &features);
+  ASSERT_TRUE(features.empty());
+}
+
+}  // end namespace kmlengine
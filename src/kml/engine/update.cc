@@ -23,11 +23,6 @@
 // OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF 
 // ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
-// TODO: nothing here updates the id maps in KmlFile.  <Create> can add
-// an Object with an id (such as a shared style) and <Delete> always deletes
-// an Object with an id.  <Change> should probably be prevented from ever
-// changing an id.
-
 #include "kml/engine/update.h"
 #include "kml/base/string_util.h"
 #include "kml/engine/kml_file.h"
@@ -53,4 +48,17 @@ void ProcessUpdateWithIdMap(const UpdatePtr& update, const StringMap* id_map,
   }
 }
 
+void ProcessUpdates(const std::vector<UpdatePtr>& updates,
+                    KmlFilePtr kml_file) {
+  ProcessUpdatesWithIdMap(updates, NULL, kml_file);
+}
+
+void ProcessUpdatesWithIdMap(const std::vector<UpdatePtr>& updates,
+                             const StringMap* id_map, KmlFilePtr kml_file) {
+  if (kml_file) {  // UpdateProcessor handles NULL id_map.
+    UpdateProcessor update_processor(*kml_file, id_map);
+    update_processor.ProcessUpdates(updates);
+  }
+}
+
 }  // end namespace kmlengine
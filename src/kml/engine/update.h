@@ -26,6 +26,7 @@
 #ifndef KML_ENGINE_UPDATE_H__
 #define KML_ENGINE_UPDATE_H__
 
+#include <vector>
 #include "kml/dom.h"
 #include "kml/engine/kml_file.h"
 
@@ -33,7 +34,10 @@ namespace kmlengine {
 
 // This provides in-place (destructive) processing of the given update against
 // the given KmlFile.  In the case of NetworkLinkControl it is presumed the
-// caller has checked Update's targetHref against KmlFile's url.
+// caller has checked Update's targetHref against KmlFile's url.  The
+// KmlFile's id and shared style maps are kept consistent with the Objects
+// created and deleted by the update such that GetObjectById() and
+// GetSharedStyleById() reflect the updated KML, as does GetTimeIndex().
 void ProcessUpdate(const kmldom::UpdatePtr& update, KmlFilePtr kml_file);
 
 // This is the same as ProcessUpdate() except the caller provided StringMap is
@@ -48,6 +52,22 @@ void ProcessUpdateWithIdMap(const kmldom::UpdatePtr& update,
                             const kmlbase::StringMap* id_map,
                             KmlFilePtr kml_file);
 
+// This applies each of the given updates in order.  The result is the same as
+// calling ProcessUpdate() on each.  Removing a deleted Feature from its
+// Container costs a pass over that Container's Features (which are kept in
+// document order), and here all <Delete>'s from any one Container share one
+// such pass rather than taking one pass per ProcessUpdate().  Each <Change>
+// is merged field by field through its serialization exactly as in
+// ProcessUpdate().  NULL updates are ignored.
+void ProcessUpdates(const std::vector<kmldom::UpdatePtr>& updates,
+                    KmlFilePtr kml_file);
+
+// This is ProcessUpdates() with the targetId= mapping of
+// ProcessUpdateWithIdMap().
+void ProcessUpdatesWithIdMap(const std::vector<kmldom::UpdatePtr>& updates,
+                             const kmlbase::StringMap* id_map,
+                             KmlFilePtr kml_file);
+
 // Clone each Feature in the source_container and append to the target.
 void CopyFeatures(const kmldom::ContainerPtr& source_container,
                   kmldom::ContainerPtr target_container);
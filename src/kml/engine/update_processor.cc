@@ -25,14 +25,11 @@
 
 // This file contains the implementation of the internal UpdateProcessor class.
 
-// TODO: nothing here updates the id maps in KmlFile.  <Create> can add
-// an Object with an id (such as a shared style) and <Delete> always deletes
-// an Object with an id.  <Change> should probably be prevented from ever
-// changing an id.
-
 #include "kml/engine/update_processor.h"
 #include "kml/base/string_util.h"
 #include "kml/engine/clone.h"
+#include "kml/engine/engine_types.h"
+#include "kml/engine/find.h"
 #include "kml/engine/kml_file.h"
 #include "kml/engine/merge.h"
 #include "kml/engine/update.h"
@@ -44,19 +41,41 @@ using kmldom::AsCreate;
 using kmldom::AsDelete;
 using kmldom::AsFeature;
 using kmldom::AsKml;
+using kmldom::AsPlacemark;
+using kmldom::AsPoint;
+using kmldom::AsTimeStamp;
 using kmldom::ChangePtr;
 using kmldom::ContainerPtr;
+using kmldom::CoordinatesPtr;
 using kmldom::CreatePtr;
 using kmldom::DeletePtr;
+using kmldom::ElementPtr;
 using kmldom::FeaturePtr;
 using kmldom::KmlPtr;
 using kmldom::ObjectPtr;
+using kmldom::PlacemarkPtr;
+using kmldom::PointPtr;
+using kmldom::TimeStampPtr;
 using kmldom::UpdatePtr;
 using kmldom::UpdateOperationPtr;
 
 namespace kmlengine {
 
 void UpdateProcessor::ProcessUpdate(const UpdatePtr& update) {
+  ProcessOperations(update);
+  FlushDeletes();
+}
+
+void UpdateProcessor::ProcessUpdates(const std::vector<UpdatePtr>& updates) {
+  for (size_t i = 0; i < updates.size(); ++i) {
+    if (updates[i]) {
+      ProcessOperations(updates[i]);
+    }
+  }
+  FlushDeletes();
+}
+
+void UpdateProcessor::ProcessOperations(const UpdatePtr& update) {
   size_t size = update->get_updateoperation_array_size();
   for (size_t i = 0; i < size; ++i) {
     const UpdateOperationPtr& op = update->get_updateoperation_array_at(i);
@@ -65,7 +84,7 @@ void UpdateProcessor::ProcessUpdate(const UpdatePtr& update) {
     } else if (CreatePtr create = AsCreate(op)) {
       ProcessUpdateCreate(create);
     } else if (DeletePtr deleet = AsDelete(op)) {
-      ProcessUpdateDelete(deleet);
+      ProcessDelete(deleet);
     }
   }
 }
@@ -77,19 +96,159 @@ void UpdateProcessor::ProcessUpdateChange(const ChangePtr& change) {
     string targetid;
     if (GetTargetId(source_object, &targetid)) {
       if (ObjectPtr target_object = kml_file_.GetObjectById(targetid)) {
-        MergeElements(source_object, target_object);
-        // It's easier to just clear the target's targetId= attribute than
-        // to teach MergeElements() how to avoid copying targetId from
-        // source to target.  This does imply that targetId is treated as
-        // any other attribute and merged over on anything other than the
-        // root Object.  Ideally the targetId would not be _within_ the
-        // source Object at all, but such is the OGC KML 2.2 standard.
-        target_object->clear_targetid();
+        ChangeObject(source_object, target_object);
       }
     }
   }
 }
 
+// Returns true if the element holds no XML beyond its known attributes and
+// elements.
+static bool HasOnlyKnownXml(const ElementPtr& element) {
+  return !element->GetUnknownAttributes() &&
+         element->get_unknown_elements_array_size() == 0 &&
+         element->get_misplaced_elements_array_size() == 0;
+}
+
+// Sets the <name>, <description> and <styleUrl> of the source Placemark in
+// the target if the source has no other fields or children.
+static bool ChangePlacemark(const PlacemarkPtr& source,
+                            const PlacemarkPtr& target) {
+  if (source->has_visibility() || source->has_open() ||
+      source->has_atomauthor() || source->has_atomlink() ||
+      source->has_address() || source->has_xaladdressdetails() ||
+      source->has_phonenumber() || source->has_snippet() ||
+      source->has_abstractview() || source->has_timeprimitive() ||
+      source->has_styleselector() || source->has_region() ||
+      source->has_extendeddata() || source->has_gx_balloonvisibility() ||
+      source->has_geometry()) {
+    return false;
+  }
+  if (source->has_name()) {
+    target->set_name(source->get_name());
+  }
+  if (source->has_description()) {
+    target->set_description(source->get_description());
+  }
+  if (source->has_styleurl()) {
+    target->set_styleurl(source->get_styleurl());
+  }
+  return true;
+}
+
+// Replaces the <coordinates> of the target Point with those of the source if
+// the source has no other fields.
+static bool ChangePoint(const PointPtr& source, const PointPtr& target) {
+  if (source->has_extrude() || source->has_altitudemode() ||
+      source->has_gx_altitudemode()) {
+    return false;
+  }
+  if (const CoordinatesPtr& coordinates = source->get_coordinates()) {
+    if (!HasOnlyKnownXml(coordinates)) {
+      return false;
+    }
+    if (const CoordinatesPtr& target_coordinates =
+        target->get_coordinates()) {
+      target_coordinates->Clear();
+      target_coordinates->reserve(coordinates->get_coordinates_array_size());
+      for (size_t i = 0; i < coordinates->get_coordinates_array_size(); ++i) {
+        target_coordinates->add_vec3(coordinates->get_coordinates_array_at(i));
+      }
+    } else {
+      target->set_coordinates(kmldom::AsCoordinates(Clone(coordinates)));
+    }
+  }
+  return true;
+}
+
+// This sets the fields of the most frequently changed Objects directly in
+// the target.  Such a change adds, removes and replaces no Object and so
+// leaves the id maps alone.  This returns false for any other change which
+// is then left to MergeElements().
+static bool ChangeFields(const ObjectPtr& source, const ObjectPtr& target) {
+  if (source->Type() != target->Type() || source->has_id() ||
+      !HasOnlyKnownXml(source)) {
+    return false;
+  }
+  if (PlacemarkPtr placemark = AsPlacemark(source)) {
+    return ChangePlacemark(placemark, AsPlacemark(target));
+  }
+  if (PointPtr point = AsPoint(source)) {
+    return ChangePoint(point, AsPoint(target));
+  }
+  if (TimeStampPtr timestamp = AsTimeStamp(source)) {
+    if (timestamp->has_when()) {
+      AsTimeStamp(target)->set_when(timestamp->get_when());
+    }
+    return true;
+  }
+  return false;
+}
+
+void UpdateProcessor::ChangeObject(const ObjectPtr& source_object,
+                                   const ObjectPtr& target_object) {
+  // A Placemark, Point or TimeStamp holds no Container and so no pending
+  // deletions.
+  if (ChangeFields(source_object, target_object)) {
+    target_object->clear_targetid();
+    if (AsTimeStamp(target_object)) {
+      IndexChangedTime(target_object);
+    }
+    return;
+  }
+  // Any Features within the target still awaiting deletion are removed first
+  // such that the merge below sees the target as the <Delete>'s left it and
+  // the remap below does not map the deleted Features again.
+  FlushDeletesWithin(target_object);
+  // Merging complex children may replace id'ed Objects within the target so
+  // the target's subtree is remapped.  A merge of only simple fields leaves
+  // the id map alone.
+  ElementVector source_children;
+  const bool remap = GetChildElements(source_object, false,
+                                      &source_children) > 0;
+  TimeIndex* time_index = kml_file_.time_index_.get();
+  if (remap) {
+    kml_file_.UnmapObjectIds(target_object);
+    if (time_index) {
+      time_index->RemoveFeatures(target_object);
+    }
+  }
+  const string id = target_object->get_id();
+  MergeElements(source_object, target_object);
+  // <Change> never changes the id of its target.
+  if (target_object->get_id() != id) {
+    target_object->set_id(id);
+  }
+  // It's easier to just clear the target's targetId= attribute than
+  // to teach MergeElements() how to avoid copying targetId from
+  // source to target.  This does imply that targetId is treated as
+  // any other attribute and merged over on anything other than the
+  // root Object.  Ideally the targetId would not be _within_ the
+  // source Object at all, but such is the OGC KML 2.2 standard.
+  target_object->clear_targetid();
+  if (remap) {
+    kml_file_.MapObjectIds(target_object);
+    if (time_index) {
+      time_index->AddFeatures(target_object);
+    }
+  }
+  IndexChangedTime(target_object);
+}
+
+// A change to a time primitive or a <gx:Track> changes the time of the
+// Feature which holds it.
+void UpdateProcessor::IndexChangedTime(const ObjectPtr& object) {
+  if (TimeIndex* time_index = kml_file_.time_index_.get()) {
+    ElementPtr element = object;
+    while (element && !AsFeature(element)) {
+      element = element->GetParent();
+    }
+    if (FeaturePtr feature = AsFeature(element)) {
+      time_index->IndexFeature(feature);
+    }
+  }
+}
+
 void UpdateProcessor::ProcessUpdateCreate(const CreatePtr& create) {
   size_t container_count = create->get_container_array_size();
   for (size_t i = 0; i < container_count; ++i) {
@@ -98,13 +257,28 @@ void UpdateProcessor::ProcessUpdateCreate(const CreatePtr& create) {
     if (GetTargetId(source_container, &targetid)) {
       if (ContainerPtr target_container =
           AsContainer(kml_file_.GetObjectById(targetid))) {
+        const size_t first = target_container->get_feature_array_size();
         CopyFeatures(source_container, target_container);
+        const size_t size = target_container->get_feature_array_size();
+        TimeIndex* time_index = kml_file_.time_index_.get();
+        for (size_t j = first; j < size; ++j) {
+          const FeaturePtr& feature = target_container->get_feature_array_at(j);
+          kml_file_.MapObjectIds(feature);
+          if (time_index) {
+            time_index->AddFeatures(feature);
+          }
+        }
       }
     }
   }
 }
 
 void UpdateProcessor::ProcessUpdateDelete(const DeletePtr& deleet) {
+  ProcessDelete(deleet);
+  FlushDeletes();
+}
+
+void UpdateProcessor::ProcessDelete(const DeletePtr& deleet) {
   size_t feature_count = deleet->get_feature_array_size();
   for (size_t i = 0; i < feature_count; ++i) {
     const FeaturePtr& source_feature = deleet->get_feature_array_at(i);
@@ -115,12 +289,19 @@ void UpdateProcessor::ProcessUpdateDelete(const DeletePtr& deleet) {
   }
 }
 
+// The Feature is unmapped from the KmlFile here such that no subsequent
+// operation can find it, but its removal from its Container is deferred to
+// FlushDeletes() such that any number of deletions from one Container cost
+// a single pass over that Container's Features.
 FeaturePtr UpdateProcessor::DeleteFeatureById(const string& id) {
   if (FeaturePtr feature = AsFeature(kml_file_.GetObjectById(id))) {
     if (ContainerPtr container = AsContainer(feature->GetParent())) {
-      return container->DeleteFeatureById(id);
+      UnmapFeature(feature);
+      pending_deletes_[container].push_back(feature);
+      return feature;
     }
     if (KmlPtr kml = AsKml(feature->GetParent())) {
+      UnmapFeature(feature);
       kml->clear_feature();
       return feature;
     }
@@ -128,6 +309,38 @@ FeaturePtr UpdateProcessor::DeleteFeatureById(const string& id) {
   return NULL;
 }
 
+void UpdateProcessor::UnmapFeature(const FeaturePtr& feature) {
+  kml_file_.UnmapObjectIds(feature);
+  if (TimeIndex* time_index = kml_file_.time_index_.get()) {
+    time_index->RemoveFeatures(feature);
+  }
+}
+
+void UpdateProcessor::FlushDeletes() {
+  PendingDeleteMap::const_iterator iter;
+  for (iter = pending_deletes_.begin(); iter != pending_deletes_.end();
+       ++iter) {
+    iter->first->DeleteFeatures(iter->second);
+  }
+  pending_deletes_.clear();
+}
+
+void UpdateProcessor::FlushDeletesWithin(const ObjectPtr& object) {
+  PendingDeleteMap::iterator iter = pending_deletes_.begin();
+  while (iter != pending_deletes_.end()) {
+    ElementPtr element = iter->first;
+    while (element && element != object) {
+      element = element->GetParent();
+    }
+    if (element) {
+      iter->first->DeleteFeatures(iter->second);
+      pending_deletes_.erase(iter++);
+    } else {
+      ++iter;
+    }
+  }
+}
+
 // This is a key reason for this class: to remap the targetId against
 // the supplied id map (if one is supplied).
 bool UpdateProcessor::GetTargetId(const kmldom::ObjectPtr& object,
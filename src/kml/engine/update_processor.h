@@ -30,6 +30,8 @@
 #ifndef KML_ENGINE_UPDATE_PROCESSOR_H__
 #define KML_ENGINE_UPDATE_PROCESSOR_H__
 
+#include <map>
+#include <vector>
 #include "kml/base/string_util.h"
 #include "kml/dom/kml_ptr.h"
 
@@ -42,8 +44,10 @@ class UpdateProcessor {
   // Create an UpdateProcessor for a given KmlFile.  If an id_map is supplied
   // then all targetId='s in all Update operations are looked up there to find
   // the id=' used in the KmlFile.  The id='s found inside the KmlFile are never
-  // changed by this class.
-  UpdateProcessor(const KmlFile& kml_file, const kmlbase::StringMap* id_map)
+  // changed by this class.  The KmlFile's id and shared style maps and its
+  // TimeIndex, if built, are kept current as Objects are created, changed and
+  // deleted.
+  UpdateProcessor(KmlFile& kml_file, const kmlbase::StringMap* id_map)
     : kml_file_(kml_file),
       id_map_(id_map) {
   }
@@ -52,8 +56,17 @@ class UpdateProcessor {
   // UpdateProcessor.  The <targetHref> is NOT examined.
   void ProcessUpdate(const kmldom::UpdatePtr& update);
 
+  // Process each of the given <Update>'s in order.  This is equivalent to
+  // calling ProcessUpdate() on each, except that the Features deleted from any
+  // one Container are all removed in a single pass at the end of the batch.
+  void ProcessUpdates(const std::vector<kmldom::UpdatePtr>& updates);
+
   // Process the given <Change> against the KmlFile associated with this
-  // UpdateProcessor.
+  // UpdateProcessor.  A change of only the <name>, <description> or
+  // <styleUrl> of a Placemark, the <coordinates> of a Point or the <when> of
+  // a TimeStamp sets those fields directly in the target.  Any other changed
+  // Object is merged into its target with MergeElements() which sets each
+  // field by way of its string value.
   void ProcessUpdateChange(const kmldom::ChangePtr& change);
 
   // Process the given <Create> against the KmlFile associated with this
@@ -61,9 +74,17 @@ class UpdateProcessor {
   void ProcessUpdateCreate(const kmldom::CreatePtr& create);
 
   // Process the given <Delete> against the KmlFile associated with this
-  // UpdateProcessor.
+  // UpdateProcessor.  Removing the Features from their Containers costs a
+  // pass over each Container's Features: see FlushDeletes().
   void ProcessUpdateDelete(const kmldom::DeletePtr& deleet);
 
+  // Remove all Features deleted by the <Delete>'s processed so far.  A deleted
+  // Feature is unmapped from the KmlFile immediately, but is only removed
+  // from its parent Container here, in one pass over the Features of each
+  // Container with deletions.  The Features of a Container are held in
+  // document order so there is no constant time removal of one Feature.
+  void FlushDeletes();
+
   // This is a key reason for this class: to remap the targetId against
   // the supplied id map.  If the id_map this class was constructed with was
   // NULL then this simply returns the targetid.
@@ -71,9 +92,23 @@ class UpdateProcessor {
                    string* targetid) const;
 
  private:
+  void ProcessOperations(const kmldom::UpdatePtr& update);
+  void ProcessDelete(const kmldom::DeletePtr& deleet);
+  void ChangeObject(const kmldom::ObjectPtr& source_object,
+                    const kmldom::ObjectPtr& target_object);
+  // Reindex the time of the Feature holding the given Object.
+  void IndexChangedTime(const kmldom::ObjectPtr& object);
   kmldom::FeaturePtr DeleteFeatureById(const string& id);
-  const kmlengine::KmlFile& kml_file_;
+  void UnmapFeature(const kmldom::FeaturePtr& feature);
+  // Remove the pending deletions from the given Object and from all
+  // Containers within it.
+  void FlushDeletesWithin(const kmldom::ObjectPtr& object);
+  kmlengine::KmlFile& kml_file_;
   const kmlbase::StringMap* id_map_;
+  // The Features awaiting removal from each Container.
+  typedef std::map<kmldom::ContainerPtr, std::vector<kmldom::FeaturePtr> >
+      PendingDeleteMap;
+  PendingDeleteMap pending_deletes_;
 };
 
 }  // end namespace kmlengine
@@ -26,6 +26,7 @@
 // This file contains the unit test for the internal UpdateProcessor class.
 
 #include "kml/engine/update_processor.h"
+#include <vector>
 #include "boost/scoped_ptr.hpp"
 #include "gtest/gtest.h"
 #include "kml/base/string_util.h"
@@ -120,4 +121,246 @@ TEST_F(UpdateProcessorTest, TestProcessUpdateChangeWithMappedId) {
   ASSERT_EQ(string("new name"), placemark->get_name());
 }
 
+TEST_F(UpdateProcessorTest, TestProcessUpdateDeleteUnmapsIds) {
+  kml_file_.reset(KmlFile::CreateFromString(
+      "<Document id=\"d\">"
+      "  <Folder id=\"f\"><Placemark id=\"p\"/></Folder>"
+      "  <Placemark id=\"q\"/>"
+      "</Document>"));
+  ASSERT_TRUE(kml_file_.get());
+  update_processor_.reset(new UpdateProcessor(*kml_file_.get(), NULL));
+  kmldom::DeletePtr deleet = kmldom::AsDelete(kmldom::ParseKml(
+      "<Delete><Folder targetId=\"f\"/></Delete>"));
+  ASSERT_TRUE(deleet);
+
+  update_processor_->ProcessUpdateDelete(deleet);
+
+  kmldom::DocumentPtr document = kmldom::AsDocument(kml_file_->get_root());
+  ASSERT_EQ(static_cast<size_t>(1), document->get_feature_array_size());
+  ASSERT_EQ(string("q"), document->get_feature_array_at(0)->get_id());
+  // The deleted Folder and everything within it are no longer mapped.
+  ASSERT_FALSE(kml_file_->GetObjectById("f"));
+  ASSERT_FALSE(kml_file_->GetObjectById("p"));
+  ASSERT_TRUE(kml_file_->GetObjectById("q"));
+  ASSERT_TRUE(kml_file_->GetObjectById("d"));
+}
+
+TEST_F(UpdateProcessorTest, TestProcessUpdateCreateMapsIds) {
+  kml_file_.reset(KmlFile::CreateFromString("<Document id=\"d\"/>"));
+  ASSERT_TRUE(kml_file_.get());
+  update_processor_.reset(new UpdateProcessor(*kml_file_.get(), NULL));
+  kmldom::CreatePtr create = kmldom::AsCreate(kmldom::ParseKml(
+      "<Create>"
+      "  <Document targetId=\"d\">"
+      "    <Folder id=\"f\"><Placemark id=\"p\"/></Folder>"
+      "  </Document>"
+      "</Create>"));
+  ASSERT_TRUE(create);
+
+  update_processor_->ProcessUpdateCreate(create);
+
+  // The ids map to the created Objects within the KmlFile and not to those
+  // within the <Create>.
+  kmldom::DocumentPtr document = kmldom::AsDocument(kml_file_->get_root());
+  ASSERT_EQ(static_cast<size_t>(1), document->get_feature_array_size());
+  kmldom::FolderPtr folder =
+      kmldom::AsFolder(document->get_feature_array_at(0));
+  ASSERT_TRUE(folder);
+  ASSERT_EQ(folder, kml_file_->GetObjectById("f"));
+  ASSERT_EQ(folder->get_feature_array_at(0), kml_file_->GetObjectById("p"));
+}
+
+TEST_F(UpdateProcessorTest, TestProcessUpdateChangeMapsIds) {
+  kml_file_.reset(KmlFile::CreateFromString(
+      "<Document id=\"d\">"
+      "  <Placemark id=\"p\"><Point id=\"pt0\"/></Placemark>"
+      "</Document>"));
+  ASSERT_TRUE(kml_file_.get());
+  update_processor_.reset(new UpdateProcessor(*kml_file_.get(), NULL));
+  // A <Change> which adds a shared style, replaces the id of the Point and
+  // attempts to change the id of the Placemark.
+  kmldom::ChangePtr change = kmldom::AsChange(kmldom::ParseKml(
+      "<Change>"
+      "  <Document targetId=\"d\"><Style id=\"s\"/></Document>"
+      "  <Placemark targetId=\"p\" id=\"other\">"
+      "    <Point id=\"pt1\"/>"
+      "  </Placemark>"
+      "</Change>"));
+  ASSERT_TRUE(change);
+
+  update_processor_->ProcessUpdateChange(change);
+
+  kmldom::DocumentPtr document = kmldom::AsDocument(kml_file_->get_root());
+  ASSERT_EQ(static_cast<size_t>(1), document->get_styleselector_array_size());
+  ASSERT_EQ(document->get_styleselector_array_at(0),
+            kml_file_->GetSharedStyleById("s"));
+  ASSERT_EQ(document->get_styleselector_array_at(0),
+            kml_file_->GetObjectById("s"));
+  kmldom::PlacemarkPtr placemark =
+      kmldom::AsPlacemark(document->get_feature_array_at(0));
+  ASSERT_EQ(string("p"), placemark->get_id());
+  ASSERT_EQ(placemark, kml_file_->GetObjectById("p"));
+  ASSERT_FALSE(kml_file_->GetObjectById("other"));
+  ASSERT_EQ(string("pt1"), placemark->get_geometry()->get_id());
+  ASSERT_FALSE(kml_file_->GetObjectById("pt0"));
+  ASSERT_EQ(placemark->get_geometry(), kml_file_->GetObjectById("pt1"));
+}
+
+TEST_F(UpdateProcessorTest, TestProcessUpdateChangeAncestorOfDelete) {
+  kml_file_.reset(KmlFile::CreateFromString(
+      "<Document id=\"d\">"
+      "  <Folder id=\"f\"><Placemark id=\"p\"/><Placemark id=\"q\"/>"
+      "  </Folder>"
+      "</Document>"));
+  ASSERT_TRUE(kml_file_.get());
+  update_processor_.reset(new UpdateProcessor(*kml_file_.get(), NULL));
+  // The <Change> of the Document remaps the Document's subtree which must not
+  // map the deleted Placemark again.
+  kmldom::UpdatePtr update = kmldom::AsUpdate(kmldom::ParseKml(
+      "<Update>"
+      "  <Delete><Placemark targetId=\"p\"/></Delete>"
+      "  <Change><Document targetId=\"d\"><Region/></Document></Change>"
+      "</Update>"));
+  ASSERT_TRUE(update);
+
+  update_processor_->ProcessUpdate(update);
+
+  kmldom::DocumentPtr document = kmldom::AsDocument(kml_file_->get_root());
+  ASSERT_TRUE(document->has_region());
+  kmldom::FolderPtr folder =
+      kmldom::AsFolder(document->get_feature_array_at(0));
+  ASSERT_EQ(static_cast<size_t>(1), folder->get_feature_array_size());
+  ASSERT_EQ(string("q"), folder->get_feature_array_at(0)->get_id());
+  ASSERT_FALSE(kml_file_->GetObjectById("p"));
+  ASSERT_EQ(folder->get_feature_array_at(0), kml_file_->GetObjectById("q"));
+  ASSERT_EQ(folder, kml_file_->GetObjectById("f"));
+}
+
+TEST_F(UpdateProcessorTest, TestProcessUpdateChangeFields) {
+  kml_file_.reset(KmlFile::CreateFromString(
+      "<Document id=\"d\">"
+      "  <Placemark id=\"p\"><name>old</name><visibility>0</visibility>"
+      "    <TimeStamp id=\"t\"><when>2000</when></TimeStamp>"
+      "    <Point id=\"pt\"><coordinates>1,2,3 4,5,6</coordinates></Point>"
+      "  </Placemark>"
+      "  <Placemark id=\"q\"><Point id=\"qt\"/></Placemark>"
+      "</Document>"));
+  ASSERT_TRUE(kml_file_.get());
+  int64_t begin;
+  int64_t end;
+  const TimeIndex& time_index = kml_file_->GetTimeIndex();
+  update_processor_.reset(new UpdateProcessor(*kml_file_.get(), NULL));
+  kmldom::ChangePtr change = kmldom::AsChange(kmldom::ParseKml(
+      "<Change>"
+      "  <Placemark targetId=\"p\"><name>new</name>"
+      "    <description>d</description><styleUrl>#s</styleUrl>"
+      "  </Placemark>"
+      "  <TimeStamp targetId=\"t\"><when>2001</when></TimeStamp>"
+      "  <Point targetId=\"pt\"><coordinates>7,8</coordinates></Point>"
+      "  <Point targetId=\"qt\"><coordinates>9,10</coordinates></Point>"
+      "</Change>"));
+  ASSERT_TRUE(change);
+
+  update_processor_->ProcessUpdateChange(change);
+
+  kmldom::DocumentPtr document = kmldom::AsDocument(kml_file_->get_root());
+  kmldom::PlacemarkPtr p =
+      kmldom::AsPlacemark(document->get_feature_array_at(0));
+  ASSERT_EQ(p, kml_file_->GetObjectById("p"));
+  ASSERT_FALSE(p->has_targetid());
+  ASSERT_EQ(string("new"), p->get_name());
+  ASSERT_EQ(string("d"), p->get_description());
+  ASSERT_EQ(string("#s"), p->get_styleurl());
+  ASSERT_FALSE(p->get_visibility());
+  kmldom::TimeStampPtr timestamp = kmldom::AsTimeStamp(p->get_timeprimitive());
+  ASSERT_EQ(timestamp, kml_file_->GetObjectById("t"));
+  ASSERT_EQ(string("2001"), timestamp->get_when());
+  ASSERT_TRUE(time_index.GetInterval(p, &begin, &end));
+  ASSERT_EQ(static_cast<int64_t>(978307200), begin);
+  kmldom::PointPtr point = kmldom::AsPoint(p->get_geometry());
+  ASSERT_EQ(point, kml_file_->GetObjectById("pt"));
+  ASSERT_EQ(static_cast<size_t>(1),
+            point->get_coordinates()->get_coordinates_array_size());
+  ASSERT_DOUBLE_EQ(7,
+      point->get_coordinates()->get_coordinates_array_at(0).get_longitude());
+  ASSERT_DOUBLE_EQ(8,
+      point->get_coordinates()->get_coordinates_array_at(0).get_latitude());
+  kmldom::PlacemarkPtr q =
+      kmldom::AsPlacemark(document->get_feature_array_at(1));
+  point = kmldom::AsPoint(q->get_geometry());
+  ASSERT_EQ(point, kml_file_->GetObjectById("qt"));
+  ASSERT_EQ(static_cast<size_t>(1),
+            point->get_coordinates()->get_coordinates_array_size());
+  ASSERT_DOUBLE_EQ(9,
+      point->get_coordinates()->get_coordinates_array_at(0).get_longitude());
+  ASSERT_DOUBLE_EQ(10,
+      point->get_coordinates()->get_coordinates_array_at(0).get_latitude());
+}
+
+TEST_F(UpdateProcessorTest, TestProcessUpdateChangeOtherFields) {
+  kml_file_.reset(KmlFile::CreateFromString(
+      "<Folder id=\"f\">"
+      "  <Placemark id=\"p\"><name>old</name></Placemark>"
+      "  <Placemark id=\"q\"><Point id=\"qt\"/></Placemark>"
+      "</Folder>"));
+  ASSERT_TRUE(kml_file_.get());
+  update_processor_.reset(new UpdateProcessor(*kml_file_.get(), NULL));
+  // A field other than those set directly is merged along with the rest.
+  kmldom::ChangePtr change = kmldom::AsChange(kmldom::ParseKml(
+      "<Change>"
+      "  <Placemark targetId=\"p\"><name>new</name><open>1</open>"
+      "  </Placemark>"
+      "  <Point targetId=\"qt\"><extrude>1</extrude>"
+      "    <coordinates>1,2</coordinates></Point>"
+      "</Change>"));
+  ASSERT_TRUE(change);
+
+  update_processor_->ProcessUpdateChange(change);
+
+  kmldom::FolderPtr folder = kmldom::AsFolder(kml_file_->get_root());
+  kmldom::FeaturePtr p = folder->get_feature_array_at(0);
+  ASSERT_EQ(string("new"), p->get_name());
+  ASSERT_TRUE(p->get_open());
+  kmldom::PointPtr point = kmldom::AsPoint(kml_file_->GetObjectById("qt"));
+  ASSERT_TRUE(point->get_extrude());
+  ASSERT_EQ(static_cast<size_t>(1),
+            point->get_coordinates()->get_coordinates_array_size());
+}
+
+TEST_F(UpdateProcessorTest, TestProcessUpdates) {
+  kml_file_.reset(KmlFile::CreateFromString(
+      "<Folder id=\"f\">"
+      "  <Placemark id=\"a\"/><Placemark id=\"b\"/><Placemark id=\"c\"/>"
+      "</Folder>"));
+  ASSERT_TRUE(kml_file_.get());
+  update_processor_.reset(new UpdateProcessor(*kml_file_.get(), NULL));
+  std::vector<kmldom::UpdatePtr> updates;
+  // Delete "a" and "b", re-create "a" and then change it.  The change must
+  // see the re-created "a" and not the deleted one.
+  updates.push_back(kmldom::AsUpdate(kmldom::ParseKml(
+      "<Update>"
+      "  <Delete><Placemark targetId=\"a\"/></Delete>"
+      "  <Delete><Placemark targetId=\"b\"/></Delete>"
+      "</Update>")));
+  updates.push_back(kmldom::AsUpdate(kmldom::ParseKml(
+      "<Update>"
+      "  <Create><Folder targetId=\"f\"><Placemark id=\"a\"/></Folder>"
+      "  </Create>"
+      "  <Change><Placemark targetId=\"a\"><name>new</name></Placemark>"
+      "  </Change>"
+      "</Update>")));
+  updates.push_back(NULL);
+
+  update_processor_->ProcessUpdates(updates);
+
+  kmldom::FolderPtr folder = kmldom::AsFolder(kml_file_->get_root());
+  ASSERT_EQ(static_cast<size_t>(2), folder->get_feature_array_size());
+  ASSERT_EQ(string("c"), folder->get_feature_array_at(0)->get_id());
+  kmldom::FeaturePtr a = folder->get_feature_array_at(1);
+  ASSERT_EQ(string("a"), a->get_id());
+  ASSERT_EQ(string("new"), a->get_name());
+  ASSERT_EQ(a, kml_file_->GetObjectById("a"));
+  ASSERT_FALSE(kml_file_->GetObjectById("b"));
+}
+
 }  // namespace kmlengine
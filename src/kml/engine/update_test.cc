@@ -266,6 +266,53 @@ TEST(UpdateTest, TestManyDeletes) {
   }
 }
 
+// This is TestManyDeletes with all of the deletes applied as one batch.
+TEST(UpdateTest, TestProcessUpdates) {
+  KmlFactory* kml_factory = KmlFactory::GetFactory();
+  FolderPtr folder = kml_factory->CreateFolder();
+  const int kNumFeatures = 1237;
+  for (int i = 0; i < kNumFeatures; ++i) {
+    folder->add_feature(CreateFeature(i, true));  // Set id=
+  }
+  KmlFilePtr kml_file = KmlFile::CreateFromImport(folder);
+  ASSERT_TRUE(kml_file);
+  std::vector<UpdatePtr> updates;
+  // Delete all the even numbered Features.
+  for (int i = 0; i < kNumFeatures; i += 2) {
+    DeletePtr deleet = kml_factory->CreateDelete();
+    deleet->add_feature(CreateFeature(i, false));  // Set targetId=
+    UpdatePtr update = kml_factory->CreateUpdate();
+    update->add_updateoperation(deleet);
+    updates.push_back(update);
+  }
+  ProcessUpdates(updates, kml_file);
+  ASSERT_EQ(static_cast<size_t>(kNumFeatures / 2),
+            folder->get_feature_array_size());
+  for (int i = 0; i < kNumFeatures; ++i) {
+    const string id = "i" + kmlbase::ToString(i);
+    ASSERT_EQ(i % 2 == 1, kml_file->GetObjectById(id) != NULL);
+    if (i % 2 == 1) {
+      ASSERT_EQ(id, folder->get_feature_array_at(i / 2)->get_id());
+    }
+  }
+}
+
+TEST(UpdateTest, TestProcessUpdatesWithIdMap) {
+  KmlFilePtr kml_file(KmlFile::CreateFromString(
+      "<Folder><Placemark id=\"inner\"/></Folder>"));
+  ASSERT_TRUE(kml_file);
+  std::vector<UpdatePtr> updates;
+  updates.push_back(kmldom::AsUpdate(kmldom::ParseKml(
+      "<Update><Delete><Placemark targetId=\"outer\"/></Delete></Update>")));
+  kmlbase::StringMap id_map;
+  id_map["outer"] = "inner";
+  ProcessUpdatesWithIdMap(updates, &id_map, kml_file);
+  ASSERT_EQ(static_cast<size_t>(0),
+            kmldom::AsFolder(kml_file->get_root())->get_feature_array_size());
+  ASSERT_FALSE(kml_file->GetObjectById("inner"));
+  ProcessUpdates(updates, NULL);
+}
+
 // Update/Change on <coordinates> replaces the contents in the target from the
 // source.
 TEST(UpdateTest, TestChangeCoordinates) {
@@ -0,0 +1,88 @@
+// Copyright 2008, Google Inc. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//  3. Neither the name of Google Inc. nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// This file contains the implementation of the KmzRegionSink class.
+
+#include "kml/regionator/kmz_region_sink.h"
+#include "kml/base/zip_writer.h"
+
+namespace kmlregionator {
+
+static const char kDocKml[] = "doc.kml";
+static const char kTileDirectory[] = "tiles/";
+static const char kIndexFilename[] = "index.txt";
+
+// static
+KmzRegionSink* KmzRegionSink::Create(const char* kmz_path) {
+  kmlbase::ZipWriter* zip_writer = kmlbase::ZipWriter::Create(kmz_path);
+  if (!zip_writer) {
+    return NULL;
+  }
+  return new KmzRegionSink(zip_writer);
+}
+
+KmzRegionSink::KmzRegionSink(kmlbase::ZipWriter* zip_writer)
+    : zip_writer_(zip_writer) {
+}
+
+KmzRegionSink::~KmzRegionSink() {
+  End();
+}
+
+// static
+string KmzRegionSink::GetEntryPath(const string& filename) {
+  return kTileDirectory + filename;
+}
+
+bool KmzRegionSink::Begin(const string& root_filename) {
+  kmldom::KmlFactory* factory = kmldom::KmlFactory::GetFactory();
+  kmldom::LinkPtr link = factory->CreateLink();
+  link->set_href(GetEntryPath(root_filename));
+  kmldom::NetworkLinkPtr networklink = factory->CreateNetworkLink();
+  networklink->set_link(link);
+  kmldom::KmlPtr kml = factory->CreateKml();
+  kml->set_feature(networklink);
+  return zip_writer_->AddEntry(kmldom::SerializePretty(kml), kDocKml);
+}
+
+bool KmzRegionSink::SaveKml(const kmldom::RegionPtr& region,
+                            const kmldom::KmlPtr& kml,
+                            const string& filename) {
+  const string entry_path(GetEntryPath(filename));
+  if (!zip_writer_->AddEntry(kmldom::SerializePretty(kml), entry_path)) {
+    return false;
+  }
+  index_.append(region->get_id()).append(" ").append(entry_path).append("\n");
+  return true;
+}
+
+bool KmzRegionSink::End() {
+  if (!zip_writer_->AddEntry(index_, GetEntryPath(kIndexFilename))) {
+    return true;  // Already closed.
+  }
+  return zip_writer_->Close();
+}
+
+}  // end namespace kmlregionator
@@ -0,0 +1,100 @@
+// Copyright 2008, Google Inc. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//  3. Neither the name of Google Inc. nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// This file contains the declaration of the KmzRegionSink class which saves
+// a whole Region-based NetworkLink hierarchy into one KMZ archive.
+
+#ifndef KML_REGIONATOR_KMZ_REGION_SINK_H__
+#define KML_REGIONATOR_KMZ_REGION_SINK_H__
+
+#include "boost/scoped_ptr.hpp"
+#include "kml/base/util.h"
+#include "kml/regionator/region_sink.h"
+
+namespace kmlbase {
+class ZipWriter;
+}
+
+namespace kmlregionator {
+
+// A KmzRegionSink streams each KML file of a regionation into one KMZ
+// archive rather than a directory of files.  The archive holds:
+//   doc.kml          A NetworkLink to the root KML file.  This is the first
+//                    entry and thus the one a KMZ reader shows.
+//   tiles/<name>     Each KML file under the name the Regionator gave it.
+//                    All are in the one directory so the relative
+//                    NetworkLink hrefs between them resolve as they would on
+//                    disk.
+//   tiles/index.txt  One "<qid> <entry>" line per KML file so that a server
+//                    can go from a quadtree node to its entry with a single
+//                    map lookup instead of walking down from the root.
+// The files are compressed by a kmlbase::ZipWriter, which deflates each
+// batch of entries concurrently and writes them in order.  Only a batch is
+// held in memory at once.
+//   boost::scoped_ptr<KmzRegionSink> sink(KmzRegionSink::Create("out.kmz"));
+//   regionator.SetRegionSink(sink.get());
+//   if (!regionator.Regionate(NULL)) { ... }
+class KmzRegionSink : public RegionSink {
+ public:
+  // Creates a KmzRegionSink writing to a new KMZ at kmz_path.  Returns NULL
+  // if the file could not be created.
+  static KmzRegionSink* Create(const char* kmz_path);
+
+  // End()s the archive if that has not already been done.
+  virtual ~KmzRegionSink();
+
+  // The ZipWriter of the archive, for example to set the number of
+  // compressing threads before the regionation starts.
+  kmlbase::ZipWriter* get_zip_writer() {
+    return zip_writer_.get();
+  }
+
+  // RegionSink::Begin()
+  // This writes doc.kml.
+  virtual bool Begin(const string& root_filename);
+
+  // RegionSink::SaveKml()
+  // This queues the file as tiles/<filename> and adds it to the index.
+  virtual bool SaveKml(const kmldom::RegionPtr& region,
+                       const kmldom::KmlPtr& kml,
+                       const string& filename);
+
+  // RegionSink::End()
+  // This writes the index and closes the archive.
+  virtual bool End();
+
+  // Returns the path in the archive of the KML file saved as filename.
+  static string GetEntryPath(const string& filename);
+
+ private:
+  KmzRegionSink(kmlbase::ZipWriter* zip_writer);
+  boost::scoped_ptr<kmlbase::ZipWriter> zip_writer_;
+  string index_;
+  LIBKML_DISALLOW_EVIL_CONSTRUCTORS(KmzRegionSink);
+};
+
+}  // end namespace kmlregionator
+
+#endif  // KML_REGIONATOR_KMZ_REGION_SINK_H__
@@ -0,0 +1,175 @@
+// Copyright 2008, Google Inc. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//  3. Neither the name of Google Inc. nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// This file contains the unit tests for the KmzRegionSink class.
+
+#include "kml/regionator/kmz_region_sink.h"
+#include <vector>
+#include "boost/scoped_ptr.hpp"
+#include "kml/base/string_util.h"
+#include "kml/base/tempfile.h"
+#include "kml/base/zip_writer.h"
+#include "kml/convenience/convenience.h"
+#include "kml/engine/kmz_file.h"
+#include "kml/regionator/regionator.h"
+#include "kml/regionator/regionator_qid.h"
+#include "gtest/gtest.h"
+
+namespace kmlregionator {
+
+using kmldom::DocumentPtr;
+using kmldom::FeaturePtr;
+using kmldom::KmlPtr;
+using kmldom::NetworkLinkPtr;
+using kmldom::RegionPtr;
+
+// This RegionHandler has data down to the given depth and shows a Point
+// Placemark named for the qid in each Region.  SaveKml() is not used.
+class DepthRegionHandler : public RegionHandler {
+ public:
+  DepthRegionHandler(size_t depth) : depth_(depth) {}
+
+  virtual bool HasData(const RegionPtr& region) {
+    return Qid(region->get_id()).depth() <= depth_;
+  }
+
+  virtual FeaturePtr GetFeature(const RegionPtr& region) {
+    return kmlconvenience::CreatePointPlacemark(region->get_id(), 1, 1);
+  }
+
+  virtual void SaveKml(const KmlPtr& kml, const string& filename) {
+    ADD_FAILURE() << "RegionHandler::SaveKml() called for " << filename;
+  }
+
+ private:
+  size_t depth_;
+};
+
+class KmzRegionSinkTest : public testing::Test {
+ protected:
+  virtual void SetUp() {
+    tempfile_ = kmlbase::TempFile::CreateTempFile();
+    ASSERT_TRUE(tempfile_ != NULL);
+  }
+  kmlbase::TempFilePtr tempfile_;
+};
+
+TEST_F(KmzRegionSinkTest, TestCreateBadPath) {
+  ASSERT_FALSE(KmzRegionSink::Create("/no/such/dir/out.kmz"));
+}
+
+TEST_F(KmzRegionSinkTest, TestGetEntryPath) {
+  ASSERT_EQ(string("tiles/1.kml"), KmzRegionSink::GetEntryPath("1.kml"));
+}
+
+TEST_F(KmzRegionSinkTest, TestRegionate) {
+  boost::scoped_ptr<KmzRegionSink> sink(
+      KmzRegionSink::Create(tempfile_->name().c_str()));
+  ASSERT_TRUE(sink.get());
+  // Several batches compressed on several threads.
+  sink->get_zip_writer()->set_num_threads(4);
+  sink->get_zip_writer()->set_max_batch_size(7);
+  DepthRegionHandler depth3(3);
+  Regionator rtor(depth3, kmlconvenience::CreateRegion2d(10,0,10,0,128,-1));
+  rtor.SetRegionSink(sink.get());
+  ASSERT_TRUE(rtor.Regionate(NULL));
+
+  boost::scoped_ptr<kmlengine::KmzFile> kmz_file(
+      kmlengine::KmzFile::OpenFromFile(tempfile_->name().c_str()));
+  ASSERT_TRUE(kmz_file.get());
+  // doc.kml, 1 + 4 + 16 KML files and the index.
+  std::vector<string> toc;
+  ASSERT_TRUE(kmz_file->List(&toc));
+  ASSERT_EQ(static_cast<size_t>(23), toc.size());
+  ASSERT_EQ(string("doc.kml"), toc[0]);
+  ASSERT_EQ(string("tiles/index.txt"), toc[22]);
+
+  // The KML of the KMZ links to the root KML file.
+  string kml;
+  ASSERT_TRUE(kmz_file->ReadKml(&kml));
+  KmlPtr root = kmldom::AsKml(kmldom::Parse(kml, NULL));
+  ASSERT_TRUE(root);
+  NetworkLinkPtr networklink = kmldom::AsNetworkLink(root->get_feature());
+  ASSERT_TRUE(networklink);
+  ASSERT_EQ(string("tiles/1.kml"), networklink->get_link()->get_href());
+
+  // Each index line names an entry holding the Document for that qid and
+  // each NetworkLink href in that Document is a sibling entry.
+  string index;
+  ASSERT_TRUE(kmz_file->ReadFile("tiles/index.txt", &index));
+  std::vector<string> lines;
+  kmlbase::SplitStringUsing(index, "\n", &lines);
+  ASSERT_EQ(static_cast<size_t>(22), lines.size());
+  ASSERT_TRUE(lines[21].empty());
+  for (size_t i = 0; i < 21; ++i) {
+    std::vector<string> fields;
+    kmlbase::SplitStringUsing(lines[i], " ", &fields);
+    ASSERT_EQ(static_cast<size_t>(2), fields.size());
+    ASSERT_TRUE(kmz_file->ReadFile(fields[1].c_str(), &kml));
+    root = kmldom::AsKml(kmldom::Parse(kml, NULL));
+    ASSERT_TRUE(root);
+    DocumentPtr document = kmldom::AsDocument(root->get_feature());
+    ASSERT_TRUE(document);
+    ASSERT_EQ(fields[0], document->get_name());
+    for (size_t j = 0; j < document->get_feature_array_size(); ++j) {
+      networklink = kmldom::AsNetworkLink(document->get_feature_array_at(j));
+      if (networklink) {
+        const string entry(
+            KmzRegionSink::GetEntryPath(networklink->get_link()->get_href()));
+        ASSERT_TRUE(kmz_file->ReadFile(entry.c_str(), &kml));
+      }
+    }
+  }
+  // The root is saved last.
+  ASSERT_EQ(string("q0 tiles/1.kml"), lines[20]);
+
+  // Further End()s do nothing.
+  ASSERT_TRUE(sink->End());
+}
+
+TEST_F(KmzRegionSinkTest, TestRootFilename) {
+  boost::scoped_ptr<KmzRegionSink> sink(
+      KmzRegionSink::Create(tempfile_->name().c_str()));
+  ASSERT_TRUE(sink.get());
+  DepthRegionHandler depth1(1);
+  Regionator rtor(depth1, kmlconvenience::CreateRegion2d(10,0,10,0,128,-1));
+  rtor.SetRegionSink(sink.get());
+  rtor.SetRootFilename("top.kml");
+  ASSERT_TRUE(rtor.Regionate(NULL));
+  sink.reset();
+
+  boost::scoped_ptr<kmlengine::KmzFile> kmz_file(
+      kmlengine::KmzFile::OpenFromFile(tempfile_->name().c_str()));
+  ASSERT_TRUE(kmz_file.get());
+  string kml;
+  ASSERT_TRUE(kmz_file->ReadFile("tiles/top.kml", &kml));
+  ASSERT_TRUE(kmz_file->ReadKml(&kml));
+  ASSERT_NE(string::npos, kml.find("<href>tiles/top.kml</href>"));
+  string index;
+  ASSERT_TRUE(kmz_file->ReadFile("tiles/index.txt", &index));
+  ASSERT_EQ(string("q0 tiles/top.kml\n"), index);
+}
+
+}  // end namespace kmlregionator
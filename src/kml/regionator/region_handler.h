@@ -70,8 +70,8 @@ class RegionHandler {
   // Region along with the file name that the parent NetworkLink will use
   // to fetch the file.  It is implementation dependent just how the KML
   // is saved, but the exact name in the filename argument should be used
-  // with no modification.
-  // TODO: provide a flag to specify use of .kmz.
+  // with no modification.  This is not called if the Regionator has a
+  // RegionSink: see region_sink.h and KmzRegionSink for saving to a .kmz.
   virtual void SaveKml(const kmldom::KmlPtr& kml,
                        const string& filename) = 0;
 };
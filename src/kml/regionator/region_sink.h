@@ -0,0 +1,74 @@
+// Copyright 2008, Google Inc. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  1. Redistributions of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//  3. Neither the name of Google Inc. nor the names of its contributors may be
+//     used to endorse or promote products derived from this software without
+//     specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// This file contains the declaration of the RegionSink abstract base class.
+
+#ifndef KML_REGIONATOR_REGION_SINK_H__
+#define KML_REGIONATOR_REGION_SINK_H__
+
+#include "kml/dom.h"
+
+namespace kmlregionator {
+
+// A RegionSink takes the place of RegionHandler::SaveKml() when given to
+// Regionator::SetRegionSink().  The RegionHandler still decides which
+// Regions have data and what Features they show, but each completed KML
+// file goes to the sink, which is free to store it anywhere such as in a
+// single archive.  Usage:
+//   class MyRegionSink : public RegionSink {...};
+//   MyRegionSink my_region_sink;
+//   Regionator regionator(my_region_handler, root_region);
+//   regionator.SetRegionSink(&my_region_sink);
+//   regionator.Regionate(NULL);  // The sink ignores the output directory.
+class RegionSink {
+ public:
+  virtual ~RegionSink() {}
+
+  // This is called once before any KML file is saved with the name of the
+  // root KML file.  This returns false if the sink cannot be used.
+  virtual bool Begin(const string& root_filename) {
+    return true;
+  }
+
+  // This is called for each Region with data with the KML file for that
+  // Region and the relative name by which the NetworkLinks of its parent
+  // fetch it.  Since these names are relative the sink must keep all files
+  // side by side for the hierarchy to resolve.  As with the RegionHandler
+  // the Regions arrive children first and so the root comes last.  This
+  // returns false if the file could not be saved.
+  virtual bool SaveKml(const kmldom::RegionPtr& region,
+                       const kmldom::KmlPtr& kml,
+                       const string& filename) = 0;
+
+  // This is called once after the last KML file is saved.  This returns
+  // false if any file or the sink itself could not be completed.
+  virtual bool End() {
+    return true;
+  }
+};
+
+}  // end namespace kmlregionator
+
+#endif  // KML_REGIONATOR_REGION_SINK_H__
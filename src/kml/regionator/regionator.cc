@@ -49,7 +49,8 @@ namespace kmlregionator {
 // A Regionator instance is created from a class derived from RegionHandler
 // and descends over a Region hierarchy as specified.
 Regionator::Regionator(RegionHandler& rhandler, const RegionPtr& region)
-    : rhandler_(rhandler), region_count_(0), root_filename_(0) {
+    : rhandler_(rhandler), region_count_(0), root_filename_(0),
+      region_sink_(NULL), region_sink_ok_(true) {
   root_region_ = CloneRegion(region);
   root_region_->set_id(Qid::CreateRoot().str());
 }
@@ -70,6 +71,10 @@ string Regionator::RegionFilename(const RegionPtr& region) {
   return str.str() + ".kml";
 }
 
+const char* Regionator::RootFilename() const {
+  return root_filename_ ? root_filename_ : "1.kml";
+}
+
 // This is an internal method to recurse down to a child of the given Region.
 // This will save the child region to output vector if the child has data.
 void Regionator::Recurse(const RegionPtr& parent, quadrant_t quadrant,
@@ -111,7 +116,7 @@ bool Regionator::_Regionate(const RegionPtr& region) {
   // up: "A URI that refers to a parent document in a hierarchy of documents."
   // See: http://www.iana.org/assignments/link-relations/link-relations.xhtml
   document->set_atomlink(kmlconvenience::AtomUtil::CreateBasicLink(
-    root_filename_ ? root_filename_ : "1.kml",
+    RootFilename(),
     qid.IsRoot() ? "self" : "up",
     kmlbase::kKmlMimeType));
 
@@ -143,6 +148,12 @@ bool Regionator::_Regionate(const RegionPtr& region) {
   KmlPtr kml = kmldom::KmlFactory::GetFactory()->CreateKml();
   kml->set_feature(document);
   string filename(RegionFilename(region));
+  if (region_sink_) {
+    if (!region_sink_->SaveKml(region, kml, filename)) {
+      region_sink_ok_ = false;
+    }
+    return true;
+  }
   if (output_directory_) {
     filename = kmlbase::File::JoinPaths(output_directory_, filename);
   }
@@ -155,7 +166,18 @@ bool Regionator::_Regionate(const RegionPtr& region) {
 // in the constructor.
 bool Regionator::Regionate(const char* output_directory) {
   output_directory_ = const_cast<char*>(output_directory);
+  if (region_sink_) {
+    region_sink_ok_ = region_sink_->Begin(RootFilename());
+    if (!region_sink_ok_) {
+      return false;
+    }
+  }
   _Regionate(root_region_);
+  if (region_sink_) {
+    // End() the sink even if a file failed so that it can clean up.
+    const bool ended = region_sink_->End();
+    return ended && region_sink_ok_;
+  }
   return true;
 }
 
@@ -34,6 +34,7 @@
 #include <vector>
 #include "kml/dom.h"
 #include "kml/regionator/region_handler.h"
+#include "kml/regionator/region_sink.h"
 #include "kml/regionator/regionator_qid.h"
 
 namespace kmlregionator {
@@ -55,7 +56,9 @@ public:
   // KML file.  The root KML file has a rel="self" link.  See SetRootFilename
   // for the name of the root KML file.  Since data presented via Region-based
   // NetworkLinks used in this manner compounds it is of interest to "reach up"
-  // all the way to the root upon discovering any descendant node.
+  // all the way to the root upon discovering any descendant node.  With a
+  // RegionSink (see SetRegionSink) the output directory is not used and this
+  // returns false if the sink failed.
   bool Regionate(const char* output_directory);
 
   // This method "regionates" using the given RegionHandler and region.  The
@@ -81,6 +84,14 @@ public:
     natural_region_ = region;
   }
 
+  // By default each KML file is handed to RegionHandler::SaveKml().  With a
+  // RegionSink each goes to RegionSink::SaveKml() instead.  The sink is
+  // owned by the caller and must outlive Regionate().  NULL restores the
+  // default.
+  void SetRegionSink(RegionSink* region_sink) {
+    region_sink_ = region_sink;
+  }
+
 private:
   kmldom::RegionPtr root_region_;
   // This calls _Regionate() for the given child of the parent Region.
@@ -96,11 +107,15 @@ private:
   // This returns the relative filename for the given Region.  A parent KML
   // file NetworkLink will look for a child with this name.
   string RegionFilename(const kmldom::RegionPtr& region);
+  // This returns the filename of the root KML file.
+  const char* RootFilename() const;
   int region_count_;
   std::map<string,int> qid_map_;
   char* output_directory_;
   const char* root_filename_;
   kmldom::RegionPtr natural_region_;
+  RegionSink* region_sink_;
+  bool region_sink_ok_;
 };
 
 }  // end namespace kmlregionator
@@ -32,6 +32,7 @@
 #include "kml/dom.h"
 #include "kml/engine/location_util.h"
 #include "kml/regionator/region_handler.h"
+#include "kml/regionator/region_sink.h"
 #include "kml/regionator/regionator_qid.h"
 #include "kml/regionator/regionator_util.h"
 #include "gtest/gtest.h"
@@ -258,4 +259,76 @@ TEST_F(RegionatorTest, SetNaturalRegionTest) {
   ASSERT_DOUBLE_EQ(-86.032775, lookat->get_longitude());
 }
 
+// This RegionSink logs each call it receives and saves each KML file to a
+// map.  If fail_filename is set SaveKml() fails for that file.
+class LoggingRegionSink : public RegionSink {
+ public:
+  LoggingRegionSink(kml_file_map_t* kml_file_map, const string& fail_filename)
+    : kml_file_map_(kml_file_map), fail_filename_(fail_filename) {
+  }
+
+  // RegionSink::Begin()
+  virtual bool Begin(const string& root_filename) {
+    log_ += "B" + root_filename + ";";
+    return true;
+  }
+
+  // RegionSink::SaveKml()
+  virtual bool SaveKml(const RegionPtr& region, const KmlPtr& kml,
+                       const string& filename) {
+    log_ += "S" + region->get_id() + "," + filename + ";";
+    (*kml_file_map_)[filename] = kml;
+    return filename != fail_filename_;
+  }
+
+  // RegionSink::End()
+  virtual bool End() {
+    log_ += "E;";
+    return true;
+  }
+
+  const string& get_log() const {
+    return log_;
+  }
+
+ private:
+  kml_file_map_t* kml_file_map_;
+  const string fail_filename_;
+  string log_;
+};
+
+TEST_F(RegionatorTest, SetRegionSinkTest) {
+  // The sink rather than the RegionHandler gets every file and the output
+  // directory does not apply.
+  kml_file_map_t handler_map;
+  PointRegionHandler depth2(2, &handler_map);
+  Regionator rtor(depth2, kmlconvenience::CreateRegion2d(10,0,10,0,128,-1));
+  LoggingRegionSink sink(&kml_file_map_, "");
+  rtor.SetRegionSink(&sink);
+  rtor.SetRootFilename("root.kml");
+  ASSERT_TRUE(rtor.Regionate("some/dir"));
+  ASSERT_TRUE(handler_map.empty());
+  ASSERT_EQ(string("Broot.kml;"
+                   "Sq00,2.kml;Sq01,3.kml;Sq02,4.kml;Sq03,5.kml;"
+                   "Sq0,root.kml;E;"),
+            sink.get_log());
+  ASSERT_EQ(static_cast<size_t>(5), kml_file_map_.size());
+  DocumentPtr d = kmldom::AsDocument(kml_file_map_["2.kml"]->get_feature());
+  ASSERT_TRUE(d);
+  ASSERT_EQ(string("root.kml"), d->get_atomlink()->get_href());
+}
+
+TEST_F(RegionatorTest, RegionSinkFailureTest) {
+  // A failed file fails the regionation but the rest are still saved and
+  // the sink is still ended.
+  PointRegionHandler depth2(2, &kml_file_map_);
+  Regionator rtor(depth2, kmlconvenience::CreateRegion2d(10,0,10,0,128,-1));
+  kml_file_map_t sink_map;
+  LoggingRegionSink sink(&sink_map, "3.kml");
+  rtor.SetRegionSink(&sink);
+  ASSERT_FALSE(rtor.Regionate(NULL));
+  ASSERT_EQ(static_cast<size_t>(5), sink_map.size());
+  ASSERT_EQ(string("E;"), sink.get_log().substr(sink.get_log().size() - 2));
+}
+
 }  // end namespace kmlregionator
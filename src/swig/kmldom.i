@@ -50,6 +50,55 @@
 
 %include "typemaps.i"
 
+// The bulk coordinate methods take a (tuples, size) pair which is size C
+// doubles read or written in place.  In Python this is any object with the
+// buffer protocol holding C-contiguous doubles, such as a NumPy float64
+// array or an array.array('d').  In Java this is a direct DoubleBuffer, for
+// example ByteBuffer.allocateDirect(8 * n).order(ByteOrder.nativeOrder())
+// .asDoubleBuffer().  Either way there is no copy per coordinate.
+#ifdef SWIGPYTHON
+%define LIBKML_DOUBLE_BUFFER(CONST, FLAGS)
+%typemap(in) (CONST double* tuples, size_t size) (Py_buffer view) {
+  view.obj = NULL;
+  if (PyObject_GetBuffer($input, &view,
+                         PyBUF_C_CONTIGUOUS | PyBUF_FORMAT | FLAGS) != 0) {
+    SWIG_fail;
+  }
+  if (view.itemsize != sizeof(double) || strcmp(view.format, "d") != 0) {
+    PyErr_SetString(PyExc_TypeError, "expected a buffer of doubles");
+    SWIG_fail;
+  }
+  $1 = static_cast<double*>(view.buf);
+  $2 = static_cast<size_t>(view.len) / sizeof(double);
+}
+%typemap(freearg) (CONST double* tuples, size_t size) {
+  if (view$argnum.obj) {
+    PyBuffer_Release(&view$argnum);
+  }
+}
+%enddef
+LIBKML_DOUBLE_BUFFER(const, 0)
+LIBKML_DOUBLE_BUFFER(, PyBUF_WRITABLE)
+#elif SWIGJAVA
+%define LIBKML_DOUBLE_BUFFER(CONST)
+%typemap(jni) (CONST double* tuples, size_t size) "jobject"
+%typemap(jtype) (CONST double* tuples, size_t size) "java.nio.DoubleBuffer"
+%typemap(jstype) (CONST double* tuples, size_t size) "java.nio.DoubleBuffer"
+%typemap(javain) (CONST double* tuples, size_t size) "$javainput"
+%typemap(in) (CONST double* tuples, size_t size) {
+  $1 = static_cast<double*>(jenv->GetDirectBufferAddress($input));
+  if (!$1) {
+    SWIG_JavaThrowException(jenv, SWIG_JavaIllegalArgumentException,
+                            "expected a direct DoubleBuffer");
+    return $null;
+  }
+  $2 = static_cast<size_t>(jenv->GetDirectBufferCapacity($input));
+}
+%enddef
+LIBKML_DOUBLE_BUFFER(const)
+LIBKML_DOUBLE_BUFFER()
+#endif
+
 // Classes for abstract elements and internal convenience classes.
 SWIG_INTRUSIVE_PTR(Referent, kmlbase::Referent)
 SWIG_INTRUSIVE_PTR_DERIVED(XmlElement, kmlbase::Referent, kmlbase::XmlElement)
@@ -168,6 +217,7 @@ SWIG_INTRUSIVE_PTR_DERIVED(GxTimeSpan, kmldom::TimeSpan, kmldom::GxTimeSpan)
 SWIG_INTRUSIVE_PTR_DERIVED(GxTimeStamp, kmldom::TimeStamp,
                            kmldom::GxTimeStamp)
 SWIG_INTRUSIVE_PTR_DERIVED(GxTour, kmldom::Feature, kmldom::GxTour)
+SWIG_INTRUSIVE_PTR_DERIVED(GxTrack, kmldom::Geometry, kmldom::GxTrack)
 SWIG_INTRUSIVE_PTR_DERIVED(GxTourControl, kmldom::GxTourPrimitive,
                            kmldom::GxTourControl)
 SWIG_INTRUSIVE_PTR_DERIVED(GxWait, kmldom::GxTourPrimitive,
@@ -218,6 +268,11 @@ public:
   void add_latlngalt(double latitude, double longitude, double altitude);
   size_t get_coordinates_array_size();
   const kmlbase::Vec3 get_coordinates_array_at(unsigned int index);
+  void reserve(size_t size);
+  // Bulk access as lon,lat (dimension 2) or lon,lat,alt (3) tuples.
+  void AddTuples(const double* tuples, size_t size, size_t dimension);
+  size_t GetTuples(double* tuples, size_t size, size_t dimension);
+  void Clear();
 };
 
 // This is vec2Type in the KML 2.2 XSD.
@@ -334,6 +389,7 @@ public:
   GxTimeSpanPtr CreateGxTimeSpan() const;
   GxTimeStampPtr CreateGxTimeStamp() const;
   GxTourPtr CreateGxTour() const;
+  GxTrackPtr CreateGxTrack() const;
   GxTourControlPtr CreateGxTourControl() const;
   GxWaitPtr CreateGxWait() const;
 };
@@ -29,6 +29,7 @@
 This file contains unit tests for the KML DOM Python SWIG bindings.
 """
 
+import array
 import unittest
 import kmlbase
 import kmldom
@@ -429,6 +430,32 @@ class SimpleCoordinatesTestCase(unittest.TestCase):
     assert alt == vec1.get_altitude()
 
 
+class BulkCoordinatesTestCase(unittest.TestCase):
+  """ This tests the buffer methods on Coordinates and GxTrack """
+  def runTest(self):
+    factory = kmldom.KmlFactory_GetFactory()
+    coordinates = factory.CreateCoordinates()
+    coordinates.reserve(2)
+    coordinates.AddTuples(array.array('d', [1, 2, 3, 4, 5, 6]), 3)
+    assert 2 == coordinates.get_coordinates_array_size()
+    assert 5 == coordinates.get_coordinates_array_at(1).get_latitude()
+    out = array.array('d', [0] * 4)
+    assert 2 == coordinates.GetTuples(out, 2)
+    assert [1, 2, 4, 5] == list(out)
+    try:
+      coordinates.AddTuples(array.array('i', [1, 2]), 2)
+      assert False
+    except TypeError:
+      pass
+
+    gx_track = factory.CreateGxTrack()
+    gx_track.AddGxCoordTuples(array.array('d', [1, 2, 3]), 3)
+    assert 1 == gx_track.get_gx_coord_array_size()
+    out = array.array('d', [0] * 3)
+    assert 1 == gx_track.GetGxCoordTuples(out, 3)
+    assert [1, 2, 3] == list(out)
+
+
 class SimpleVec2TestCase(unittest.TestCase):
   """ This tests the methods on Vec2 (using HotSpot) """
   def runTest(self):
@@ -1590,6 +1617,7 @@ def suite():
   suite.addTest(SimpleAtomLinkTestCase('testDefault'))
   suite.addTest(SimpleAtomLinkTestCase('testSetClear'))
   suite.addTest(SimpleCoordinatesTestCase())
+  suite.addTest(BulkCoordinatesTestCase())
   suite.addTest(SimpleVec2TestCase())
   suite.addTest(SimpleObjectTestCase())
   suite.addTest(SimpleFeatureTestCase())
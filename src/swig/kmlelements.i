@@ -1675,6 +1675,31 @@ class GxTour : public Feature {
   void clear_gx_playlist();
 };
 
+// <gx:Track>
+%nodefaultctor GxTrack;
+class GxTrack : public Geometry {
+ public:
+  void reserve(size_t size);
+
+  // <when>
+  size_t get_when_array_size();
+  void add_when(const std::string& when);
+  std::string get_when_array_at(unsigned int index);
+
+  // <gx:coord>
+  size_t get_gx_coord_array_size();
+  void add_gx_coord(double longitude, double latitude, double altitude);
+  kmlbase::Vec3 get_gx_coord_array_at(unsigned int index);
+  // Bulk access as lon,lat (dimension 2) or lon,lat,alt (3) tuples.
+  void AddGxCoordTuples(const double* tuples, size_t size, size_t dimension);
+  size_t GetGxCoordTuples(double* tuples, size_t size, size_t dimension);
+
+  // <gx:angles>
+  size_t get_gx_angles_array_size();
+  void add_gx_angles(double heading, double tilt, double roll);
+  kmlbase::Vec3 get_gx_angles_array_at(unsigned int index);
+};
+
 // <gx:AnimatedUpdate>
 %nodefaultctor GxAnimatedUpdate;
 class GxAnimatedUpdate : public GxTourPrimitive {